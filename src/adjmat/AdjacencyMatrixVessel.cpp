@@ -121,6 +121,61 @@ void AdjacencyMatrixVessel::retrieveAdjacencyLists( std::vector<unsigned>& nneig
   }
 }
 
+void AdjacencyMatrixVessel::retrieveCSRAdjacencyList( std::vector<unsigned>& nlist_start, std::vector<unsigned>& nlist ) {
+  plumed_dbg_assert( undirectedGraph() );
+  unsigned nnodes=getNumberOfRows(); nlist_start.assign( nnodes+1, 0 );
+
+  // First pass: count the degree of every node
+  std::vector<double> myvals( getNumberOfComponents() );
+  std::vector<std::pair<unsigned,unsigned> > edges; edges.reserve( getNumberOfStoredValues() );
+  for(unsigned i=0; i<getNumberOfStoredValues(); ++i) {
+    retrieveSequentialValue( i, false, myvals );
+    if( myvals[0]<epsilon || myvals[1]<epsilon ) continue ;
+
+    unsigned j, k; getMatrixIndices( function->getPositionInFullTaskList(i), k, j );
+    edges.push_back( std::pair<unsigned,unsigned>(k,j) );
+    nlist_start[k+1]++; nlist_start[j+1]++;
+  }
+  for(unsigned i=0; i<nnodes; ++i) nlist_start[i+1]+=nlist_start[i];
+
+  // Second pass: scatter the edges, using the offsets as running fill counters
+  nlist.resize( nlist_start[nnodes] ); std::vector<unsigned> fill( nlist_start.begin(), nlist_start.begin()+nnodes );
+  for(unsigned i=0; i<edges.size(); ++i) {
+    unsigned k=edges[i].first, j=edges[i].second;
+    nlist[ fill[k] ]=j; fill[k]++;
+    nlist[ fill[j] ]=k; fill[j]++;
+  }
+}
+
+void AdjacencyMatrixVessel::retrieveCSRMatrix( std::vector<unsigned>& nlist_start, std::vector<unsigned>& nlist, std::vector<double>& weights ) {
+  plumed_dbg_assert( undirectedGraph() );
+  unsigned nnodes=getNumberOfRows(); nlist_start.assign( nnodes+1, 0 );
+
+  // First pass: count the degree of every node
+  std::vector<double> myvals( getNumberOfComponents() );
+  std::vector<std::pair<unsigned,unsigned> > edges; edges.reserve( getNumberOfStoredValues() );
+  std::vector<double> edge_weights; edge_weights.reserve( getNumberOfStoredValues() );
+  for(unsigned i=0; i<getNumberOfStoredValues(); ++i) {
+    retrieveSequentialValue( i, false, myvals );
+    if( myvals[0]<epsilon ) continue ;
+
+    unsigned j, k; getMatrixIndices( function->getPositionInFullTaskList(i), k, j );
+    edges.push_back( std::pair<unsigned,unsigned>(k,j) );
+    edge_weights.push_back( myvals[0]*myvals[1] );
+    nlist_start[k+1]++; nlist_start[j+1]++;
+  }
+  for(unsigned i=0; i<nnodes; ++i) nlist_start[i+1]+=nlist_start[i];
+
+  // Second pass: scatter the edges, using the offsets as running fill counters
+  nlist.resize( nlist_start[nnodes] ); weights.resize( nlist_start[nnodes] );
+  std::vector<unsigned> fill( nlist_start.begin(), nlist_start.begin()+nnodes );
+  for(unsigned i=0; i<edges.size(); ++i) {
+    unsigned k=edges[i].first, j=edges[i].second;
+    nlist[ fill[k] ]=j; weights[ fill[k] ]=edge_weights[i]; fill[k]++;
+    nlist[ fill[j] ]=k; weights[ fill[j] ]=edge_weights[i]; fill[j]++;
+  }
+}
+
 void AdjacencyMatrixVessel::retrieveEdgeList( unsigned& nedge, std::vector<std::pair<unsigned,unsigned> >& edge_list ) {
   plumed_dbg_assert( undirectedGraph() ); nedge=0;
   std::vector<double> myvals( getNumberOfComponents() );
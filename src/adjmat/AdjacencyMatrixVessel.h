@@ -58,6 +58,14 @@ public:
   void retrieveMatrix( DynamicList<unsigned>& myactive_elements, Matrix<double>& mymatrix );
 /// Get the neighbour list based on the adjacency matrix
   void retrieveAdjacencyLists( std::vector<unsigned>& nneigh, Matrix<unsigned>& adj_list );
+/// Get the neighbour list in compressed sparse row form: the neighbors of
+/// node i are nlist[ nlist_start[i] ] up to nlist[ nlist_start[i+1] ].  The
+/// vectors are sized exactly by the number of stored edges, so unlike
+/// retrieveAdjacencyLists this needs no preset maximum connectivity
+  void retrieveCSRAdjacencyList( std::vector<unsigned>& nlist_start, std::vector<unsigned>& nlist );
+/// As retrieveCSRAdjacencyList, but also returns the weight of every edge,
+/// so that the matrix can be applied to a vector without densifying it
+  void retrieveCSRMatrix( std::vector<unsigned>& nlist_start, std::vector<unsigned>& nlist, std::vector<double>& weights );
 /// Retrieve the list of edges in the adjacency matrix/graph
   void retrieveEdgeList( unsigned& nedge, std::vector<std::pair<unsigned,unsigned> >& edge_list );
 ///
@@ -84,6 +84,7 @@ void AlignedMatrixBase::setupConnector( const unsigned& id, const unsigned& i, c
 
 double AlignedMatrixBase::calculateWeight( const unsigned& taskCode, const double& weight, multicolvar::AtomValuePack& myatoms ) const {
   Vector distance = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  myatoms.cacheSeparation( distance );
   if( distance.modulo2()<switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) )-ncol_t ).get_dmax2() ) return 1.0;
   return 0.0;
 }
@@ -91,13 +92,14 @@ double AlignedMatrixBase::calculateWeight( const unsigned& taskCode, const doubl
 double AlignedMatrixBase::compute( const unsigned& tindex, multicolvar::AtomValuePack& myatoms ) const {
   unsigned ncomp=getSizeOfInputVectors(); Vector ddistance;
   std::vector<double> orient0(ncomp), orient1(ncomp), dorient0(ncomp), dorient1(ncomp);
-  Vector distance = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  Vector distance;
+  if( !myatoms.getCachedSeparation( distance ) ) distance=getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
   getInputData( 0, true, myatoms, orient0 ); getInputData( 1, true, myatoms, orient1 );
   double f_dot = computeVectorFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) )-ncol_t,
                                         distance, orient0, orient1, ddistance, dorient0, dorient1 );
 
   // Retrieve the weight of the connection
-  double dfunc, sw = switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) )-ncol_t ).calculate( distance.modulo(), dfunc );
+  double dfunc, sw = switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) )-ncol_t ).calculateSqr( distance.modulo2(), dfunc );
 
   if( !doNotCalculateDerivatives() ) {
     addAtomDerivatives( 1, 0, (-dfunc)*f_dot*distance - sw*ddistance, myatoms );
@@ -128,7 +128,7 @@ void ClusterDistribution::performTask( const unsigned& task_index, const unsigne
   if( myatoms.size()==1 && !nodeIsActive(myatoms[0]) ) return ;
 
   std::vector<double> vals( getNumberOfQuantities() );
-  MultiValue tvals( getNumberOfQuantities(), nderivatives );
+  TemporaryMultiValue ttvals( getNumberOfQuantities(), nderivatives ); MultiValue& tvals=*ttvals;
 
   // And this builds everything for this particular atom
   double vv, df, tval=0;
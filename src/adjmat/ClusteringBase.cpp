@@ -62,13 +62,26 @@ void ClusteringBase::calculate() {
   performClustering();
   // Order the clusters in the system by size (this returns ascending order )
   std::sort( cluster_sizes.begin(), cluster_sizes.end() );
+  // Bucket the atoms by sorted cluster, so that later per cluster queries
+  // do not each rescan the whole system.  rank maps a cluster label onto
+  // its position in the sorted order
+  std::vector<unsigned> rank( cluster_sizes.size() );
+  for(unsigned i=0; i<cluster_sizes.size(); ++i) rank[ cluster_sizes[i].second ]=i;
+  cluster_start.assign( cluster_sizes.size()+1, 0 );
+  for(unsigned i=0; i<which_cluster.size(); ++i) cluster_start[ rank[which_cluster[i]]+1 ]++;
+  for(unsigned i=0; i<cluster_sizes.size(); ++i) cluster_start[i+1]+=cluster_start[i];
+  cluster_members.resize( which_cluster.size() );
+  std::vector<unsigned> fill( cluster_start.begin(), cluster_start.begin()+cluster_sizes.size() );
+  for(unsigned i=0; i<which_cluster.size(); ++i) {
+    unsigned r=rank[which_cluster[i]];
+    cluster_members[ fill[r] ]=i; fill[r]++;
+  }
 }
 
 void ClusteringBase::retrieveAtomsInCluster( const unsigned& clust, std::vector<unsigned>& myatoms ) const {
-  unsigned n=0; myatoms.resize( cluster_sizes[cluster_sizes.size() - clust].first );
-  for(unsigned i=0; i<getNumberOfNodes(); ++i) {
-    if( which_cluster[i]==cluster_sizes[cluster_sizes.size() - clust].second ) { myatoms[n]=i; n++; }
-  }
+  unsigned n=cluster_sizes.size() - clust;
+  plumed_dbg_assert( cluster_start[n+1]-cluster_start[n]==cluster_sizes[n].first );
+  myatoms.assign( cluster_members.begin()+cluster_start[n], cluster_members.begin()+cluster_start[n+1] );
 }
 
 bool ClusteringBase::areConnected( const unsigned& iatom, const unsigned& jatom ) const {
@@ -36,6 +36,10 @@ protected:
   int number_of_cluster;
 /// Vector that identifies the cluster each atom belongs to
   std::vector<unsigned> which_cluster;
+/// Cluster members in compressed row form, bucketed by the sorted cluster
+/// order once per step so that retrieving the atoms in a cluster is a
+/// slice copy rather than a scan over every node
+  std::vector<unsigned> cluster_start, cluster_members;
 public:
 /// Create manual
   static void registerKeywords( Keywords& keys );
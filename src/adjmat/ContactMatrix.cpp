@@ -128,14 +128,16 @@ void ContactMatrix::setupConnector( const unsigned& id, const unsigned& i, const
 
 double ContactMatrix::calculateWeight( const unsigned& taskCode, const double& weight, multicolvar::AtomValuePack& myatoms ) const {
   Vector distance = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  myatoms.cacheSeparation( distance );
   if( distance.modulo2()<switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) ) - ncol_t ).get_dmax2() ) return 1.0;
   return 0.0;
 }
 
 double ContactMatrix::compute( const unsigned& tindex, multicolvar::AtomValuePack& myatoms ) const {
-  Vector distance = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  Vector distance;
+  if( !myatoms.getCachedSeparation( distance ) ) distance=getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
   double dfunc;
-  double sw = switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) ) - ncol_t ).calculate( distance.modulo(), dfunc );
+  double sw = switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) ) - ncol_t ).calculateSqr( distance.modulo2(), dfunc );
 
   if( !doNotCalculateDerivatives() ) {
     addAtomDerivatives( 1, 0, (-dfunc)*distance, myatoms );
@@ -72,16 +72,31 @@ private:
 #ifdef __PLUMED_HAS_BOOST_GRAPH
 /// The list of edges in the graph
   std::vector<std::pair<unsigned,unsigned> > edge_list;
-#else
-/// The number of neighbors each atom has
-  std::vector<unsigned> nneigh;
-/// The adjacency list
-  Matrix<unsigned> adj_list;
+#endif
+/// The start of each node's neighbors in the CSR adjacency list
+  std::vector<unsigned> nlist_start;
+/// The CSR adjacency list
+  std::vector<unsigned> nlist;
+#ifndef __PLUMED_HAS_BOOST_GRAPH
 /// The color that tells us whether a node has been visited
   std::vector<unsigned> color;
 /// The recursive function at the heart of this method
   int explore( const unsigned& index );
 #endif
+/// Are we repairing the previous step's components rather than reclustering
+  bool incremental;
+/// Do we have a valid previous step to repair from
+  bool have_prev;
+/// Last step's adjacency list and cluster labels
+  std::vector<unsigned> prev_nlist_start, prev_nlist, prev_labels;
+/// Union-find parent array used by the incremental update
+  std::vector<unsigned> djparent;
+/// Find the root of a node in the union-find forest, compressing the path
+  unsigned findRoot( unsigned index );
+/// Merge the components containing two nodes
+  void mergeRoots( const unsigned& inode, const unsigned& jnode );
+/// Repair the previous step's components instead of reclustering from scratch
+  void performIncrementalClustering();
 public:
 /// Create manual
   static void registerKeywords( Keywords& keys );
@@ -95,6 +110,9 @@ PLUMED_REGISTER_ACTION(DFSClustering,"DFSCLUSTERING")
 
 void DFSClustering::registerKeywords( Keywords& keys ) {
   ClusteringBase::registerKeywords( keys );
+  keys.addFlag("INCREMENTAL",false,"reuse the previous step's connected components and repair only those whose "
+               "edges changed.  This is worthwhile when only a small fraction of the contacts "
+               "change between strides, as in nucleation trajectories");
   keys.add("compulsory","MAXCONNECT","0","maximum number of connections that can be formed by any given node in the graph. "
            "By default this is set equal to zero and the number of connections is set equal to the number "
            "of nodes.  You only really need to set this if you are working with a very large system and "
@@ -103,20 +121,25 @@ void DFSClustering::registerKeywords( Keywords& keys ) {
 
 DFSClustering::DFSClustering(const ActionOptions&ao):
   Action(ao),
-  ClusteringBase(ao)
+  ClusteringBase(ao),
+  incremental(false),
+  have_prev(false)
 {
+  parseFlag("INCREMENTAL",incremental);
+  if( incremental ) log.printf("  reusing previous step's components and repairing only those whose edges changed\n");
   unsigned maxconnections; parse("MAXCONNECT",maxconnections);
 #ifdef __PLUMED_HAS_BOOST_GRAPH
   if( maxconnections>0 ) edge_list.resize( getNumberOfNodes()*maxconnections );
   else edge_list.resize(0.5*getNumberOfNodes()*(getNumberOfNodes()-1));
 #else
-  nneigh.resize( getNumberOfNodes() ); color.resize(getNumberOfNodes());
-  if( maxconnections>0 ) adj_list.resize(getNumberOfNodes(),maxconnections);
-  else adj_list.resize(getNumberOfNodes(),getNumberOfNodes());
+  // the CSR adjacency list is sized by the number of stored edges when it is
+  // retrieved, so no preset maximum connectivity is needed here
+  color.resize(getNumberOfNodes());
 #endif
 }
 
 void DFSClustering::performClustering() {
+  if( incremental ) { performIncrementalClustering(); return; }
 #ifdef __PLUMED_HAS_BOOST_GRAPH
   // Get the list of edges
   unsigned nedges=0; getAdjacencyVessel()->retrieveEdgeList( nedges, edge_list );
@@ -130,8 +153,8 @@ void DFSClustering::performClustering() {
   // And work out the size of each cluster
   for(unsigned i=0; i<which_cluster.size(); ++i) cluster_sizes[which_cluster[i]].first++;
 #else
-  // Get the adjacency matrix
-  getAdjacencyVessel()->retrieveAdjacencyLists( nneigh, adj_list );
+  // Get the adjacency matrix in compressed sparse row form
+  getAdjacencyVessel()->retrieveCSRAdjacencyList( nlist_start, nlist );
 
   // Perform clustering
   number_of_cluster=-1; color.assign(color.size(),0);
@@ -141,12 +164,75 @@ void DFSClustering::performClustering() {
 #endif
 }
 
+unsigned DFSClustering::findRoot( unsigned index ) {
+  while( djparent[index]!=index ) { djparent[index]=djparent[djparent[index]]; index=djparent[index]; }
+  return index;
+}
+
+void DFSClustering::mergeRoots( const unsigned& inode, const unsigned& jnode ) {
+  unsigned iroot=findRoot(inode), jroot=findRoot(jnode);
+  if( iroot!=jroot ) djparent[jroot]=iroot;
+}
+
+void DFSClustering::performIncrementalClustering() {
+  getAdjacencyVessel()->retrieveCSRAdjacencyList( nlist_start, nlist );
+  unsigned nnodes=getNumberOfNodes();
+
+  // A node is dirty if its neighbors changed since the previous step; a
+  // component is dirty if it contains a dirty node.  On the first step (or
+  // if the graph size changed) everything is dirty and this is a full build
+  bool full=( !have_prev || prev_labels.size()!=nnodes );
+  std::vector<bool> dirty;
+  if( !full ) {
+    dirty.assign( cluster_sizes.size(), false );
+    for(unsigned i=0; i<nnodes; ++i) {
+      unsigned st=nlist_start[i], pst=prev_nlist_start[i];
+      if( nlist_start[i+1]-st!=prev_nlist_start[i+1]-pst ) { dirty[ prev_labels[i] ]=true; continue; }
+      for(unsigned k=0; k<nlist_start[i+1]-st; ++k) {
+        if( nlist[st+k]!=prev_nlist[pst+k] ) { dirty[ prev_labels[i] ]=true; break; }
+      }
+    }
+  }
+
+  // Rebuild the union-find forest: clean components are stitched back
+  // together from the previous labels without touching their edges, and
+  // only the edges of nodes in dirty components are walked.  A surviving
+  // edge between two clean nodes always joined the same component on the
+  // previous step, so skipping it is safe
+  djparent.resize( nnodes );
+  for(unsigned i=0; i<nnodes; ++i) djparent[i]=i;
+  if( !full ) {
+    std::vector<int> first( cluster_sizes.size(), -1 );
+    for(unsigned i=0; i<nnodes; ++i) {
+      unsigned l=prev_labels[i];
+      if( dirty[l] ) continue;
+      if( first[l]<0 ) first[l]=i;
+      else mergeRoots( first[l], i );
+    }
+  }
+  for(unsigned i=0; i<nnodes; ++i) {
+    if( !full && !dirty[ prev_labels[i] ] ) continue;
+    for(unsigned k=nlist_start[i]; k<nlist_start[i+1]; ++k) mergeRoots( i, nlist[k] );
+  }
+
+  // Assign compact cluster labels in node order, as explore() would
+  number_of_cluster=-1; std::vector<int> rootlab( nnodes, -1 );
+  for(unsigned i=0; i<nnodes; ++i) {
+    unsigned iroot=findRoot(i);
+    if( rootlab[iroot]<0 ) { number_of_cluster++; rootlab[iroot]=number_of_cluster; }
+    which_cluster[i]=rootlab[iroot]; cluster_sizes[ rootlab[iroot] ].first++;
+  }
+
+  // Stash this step's graph and labels for the next repair
+  prev_nlist_start=nlist_start; prev_nlist=nlist; prev_labels=which_cluster; have_prev=true;
+}
+
 #ifndef __PLUMED_HAS_BOOST_GRAPH
 int DFSClustering::explore( const unsigned& index ) {
 
   color[index]=1;
-  for(unsigned i=0; i<nneigh[index]; ++i) {
-    unsigned j=adj_list(index,i);
+  for(unsigned i=nlist_start[index]; i<nlist_start[index+1]; ++i) {
+    unsigned j=nlist[i];
     if( color[j]==0 ) color[j]=explore(j);
   }
 
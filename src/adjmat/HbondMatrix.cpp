@@ -183,14 +183,16 @@ double HBondMatrix::calculateWeight( const unsigned& taskCode, const double& wei
   if( myatoms.getIndex(0)==myatoms.getIndex(1) ) return 0.0;
 
   Vector distance = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  myatoms.cacheSeparation( distance );
   if( distance.modulo2()<distanceOOSwitch( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) ) ).get_dmax2() ) return 1.0;
   return 0.0;
 }
 
 double HBondMatrix::compute( const unsigned& tindex, multicolvar::AtomValuePack& myatoms ) const {
-  Vector ood = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) ); double ood_l = ood.modulo(); // acceptor - donor
+  Vector ood; // acceptor - donor
+  if( !myatoms.getCachedSeparation( ood ) ) ood=getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
   double ood_df, ood_sw=distanceOOSwitch( getBaseColvarNumber( myatoms.getIndex(0) ),
-                                          getBaseColvarNumber( myatoms.getIndex(1) ) ).calculate( ood_l, ood_df );
+                                          getBaseColvarNumber( myatoms.getIndex(1) ) ).calculateSqr( ood.modulo2(), ood_df );
 
   // Get the base colvar numbers
   unsigned ano, dno = getBaseColvarNumber( myatoms.getIndex(0) );
@@ -209,9 +211,9 @@ double HBondMatrix::compute( const unsigned& tindex, multicolvar::AtomValuePack&
 
 double HBondMatrix::calculateForThree( const unsigned& iat, const unsigned& ano, const unsigned& dno, const Vector& ood,
                                        const double& ood_df, const double& ood_sw, multicolvar::AtomValuePack& myatoms ) const {
-  Vector ohd=getSeparation( myatoms.getPosition(0), myatoms.getPosition(iat) ); double ohd_l=ohd.modulo();
+  Vector ohd=getSeparation( myatoms.getPosition(0), myatoms.getPosition(iat) );
   double ohd_df, ohd_sw=distanceOHSwitch( getBaseColvarNumber( myatoms.getIndex(0) ),
-                                          getBaseColvarNumber( myatoms.getIndex(1) ) ).calculate( ohd_l, ohd_df );
+                                          getBaseColvarNumber( myatoms.getIndex(1) ) ).calculateSqr( ohd.modulo2(), ohd_df );
 
   Angle a; Vector ood_adf, ohd_adf; double angle=a.compute( ood, ohd, ood_adf, ohd_adf );
   double angle_df, angle_sw=angleSwitch( getBaseColvarNumber( myatoms.getIndex(0) ),
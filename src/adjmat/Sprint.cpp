@@ -94,6 +94,14 @@ private:
   Matrix<double> thematrix;
 /// Matrix that stores eigenvectors
   Matrix<double> eigenvecs;
+/// Sparse matrix in compressed row form, used by the power iteration
+  std::vector<unsigned> nlist_start, nlist;
+  std::vector<double> nweights;
+/// Principal eigenvector of the previous step, used as the warm start
+  std::vector<double> prev_eig;
+/// Compute the maximum eigenvalue and fill maxeig by power iteration on
+/// the sparse matrix; returns false if the iteration did not converge
+  bool sparseLambdaMax( double& lambda );
 public:
 /// Create manual
   static void registerKeywords( Keywords& keys );
@@ -148,19 +156,62 @@ Sprint::Sprint(const ActionOptions&ao):
   for(unsigned i=0; i<ntriangle; ++i) active_elements.addIndexToList( i );
 }
 
+bool Sprint::sparseLambdaMax( double& lambda ) {
+  getAdjacencyVessel()->retrieveCSRMatrix( nlist_start, nlist, nweights );
+  if( nlist.size()==0 ) return false;
+  unsigned n = getNumberOfNodes();
+  if( prev_eig.size()!=n ) prev_eig.assign( n, 1.0/sqrtn );
+  std::vector<double> y( n );
+  for(unsigned iter=0; iter<500; ++iter) {
+    // y = A x with x normalized
+    for(unsigned i=0; i<n; ++i) {
+      double s=0.;
+      for(unsigned k=nlist_start[i]; k<nlist_start[i+1]; ++k) s+=nweights[k]*prev_eig[ nlist[k] ];
+      y[i]=s;
+    }
+    // Rayleigh quotient and residual; ||y-lambda*x||^2 = ||y||^2 - lambda^2
+    double ynorm2=0., rq=0.;
+    for(unsigned i=0; i<n; ++i) { ynorm2+=y[i]*y[i]; rq+=prev_eig[i]*y[i]; }
+    if( !(ynorm2>epsilon) ) return false;
+    double ynorm=sqrt(ynorm2), resid2=ynorm2-rq*rq;
+    for(unsigned i=0; i<n; ++i) prev_eig[i]=y[i]/ynorm;
+    if( resid2<1.0e-20*ynorm2 ) {
+      lambda=rq;
+      // Must make all components of principle eigenvector +ve
+      for(unsigned j=0; j<n; ++j) {
+        prev_eig[j]=fabs(prev_eig[j]);
+        maxeig[j].first=prev_eig[j]; maxeig[j].second=j;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 void Sprint::calculate() {
-  // Get the adjacency matrix
-  getAdjacencyVessel()->retrieveMatrix( active_elements, thematrix );
-  // Diagonalize it
-  diagMat( thematrix, eigvals, eigenvecs );
-  // Get the maximum eigevalue
-  double lambda = eigvals[ getNumberOfNodes()-1 ];
-  // Get the corresponding eigenvector
-  for(unsigned j=0; j<maxeig.size(); ++j) {
-    maxeig[j].first = fabs( eigenvecs( getNumberOfNodes()-1, j ) );
-    maxeig[j].second = j;
-    // Must make all components of principle eigenvector +ve
-    eigenvecs( getNumberOfNodes()-1, j ) = maxeig[j].first;
+  double lambda = 0;
+  // Without derivatives only the maximum eigenvalue and its eigenvector are
+  // needed, and these come out of a power iteration on the sparse matrix,
+  // warm started from the previous step, at a fraction of the cost of the
+  // full diagonalization.  The derivatives below need the whole spectrum,
+  // so when they are on we take the dense path regardless
+  if( !doNotCalculateDerivatives() || !sparseLambdaMax( lambda ) ) {
+    // Get the adjacency matrix
+    getAdjacencyVessel()->retrieveMatrix( active_elements, thematrix );
+    // Diagonalize it
+    diagMat( thematrix, eigvals, eigenvecs );
+    // Get the maximum eigevalue
+    lambda = eigvals[ getNumberOfNodes()-1 ];
+    // Get the corresponding eigenvector
+    if( prev_eig.size()!=maxeig.size() ) prev_eig.resize( maxeig.size() );
+    for(unsigned j=0; j<maxeig.size(); ++j) {
+      maxeig[j].first = fabs( eigenvecs( getNumberOfNodes()-1, j ) );
+      maxeig[j].second = j;
+      // Must make all components of principle eigenvector +ve
+      eigenvecs( getNumberOfNodes()-1, j ) = maxeig[j].first;
+      // Keep the eigenvector as the warm start for later sparse steps
+      prev_eig[j] = maxeig[j].first;
+    }
   }
 
   // Reorder each block of eigevectors
@@ -176,6 +227,7 @@ void Sprint::calculate() {
   for(int icomp=0; icomp<getNumberOfComponents(); ++icomp) {
     getPntrToComponent(icomp)->set( sqrtn*lambda*maxeig[icomp].first );
   }
+  if( doNotCalculateDerivatives() ) return;
 
   // Parallelism
   unsigned rank, stride;
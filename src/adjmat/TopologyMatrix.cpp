@@ -189,6 +189,7 @@ void TopologyMatrix::setupConnector( const unsigned& id, const unsigned& i, cons
 
 double TopologyMatrix::calculateWeight( const unsigned& taskCode, const double& weight, multicolvar::AtomValuePack& myatoms ) const {
   Vector distance = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  myatoms.cacheSeparation( distance );
   if( distance.modulo2()<switchingFunction( getBaseColvarNumber( myatoms.getIndex(0) ), getBaseColvarNumber( myatoms.getIndex(1) ) ).get_dmax2() ) return 1.0;
   return 0.0;
 }
@@ -199,7 +200,9 @@ double TopologyMatrix::compute( const unsigned& tindex, multicolvar::AtomValuePa
   // Initialise to zero density on all bins
   for(unsigned bin=0; bin<maxbins; ++bin) myatoms.setValue(bin+1,0);
   // Calculate whether or not atoms 1 and 2 are within cutoff (can use delta here as pbc are done in atom setup)
-  Vector d1 = getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) ); double d1_len = d1.modulo();
+  Vector d1;
+  if( !myatoms.getCachedSeparation( d1 ) ) d1=getSeparation( myatoms.getPosition(0), myatoms.getPosition(1) );
+  double d1_len = d1.modulo();
   d1 = d1 / d1_len;  // Convert vector into director
   AtomNumber a1 = myatoms.getAbsoluteIndex( 0 );
   AtomNumber a2 = myatoms.getAbsoluteIndex( 1 );
@@ -64,6 +64,11 @@ private:
   std::string fmt;
   std::vector< std::vector<double> > lowerlimits;
   std::vector< std::vector<double> > upperlimits;
+/// Per-argument envelope of all the basin boxes: a configuration outside
+/// the envelope on any argument cannot be inside any basin, which lets the
+/// common no-basin case exit after a few comparisons
+  std::vector<double> envelopelow;
+  std::vector<double> envelopehigh;
   unsigned nbasins;
   unsigned basin;
   bool doNotStop;
@@ -95,6 +100,7 @@ Committor::Committor(const ActionOptions&ao):
   ActionPilot(ao),
   ActionWithArguments(ao),
   fmt("%f"),
+  nbasins(0),
   basin(0),
   doNotStop(false)
 {
@@ -137,28 +143,36 @@ Committor::Committor(const ActionOptions&ao):
     if(doNotStop) log.printf(" COMMITOR will keep track of the visited basins without stopping the simulations\n");
   }
 
+  envelopelow.assign( getNumberOfArguments(), 0.0 );
+  envelopehigh.assign( getNumberOfArguments(), 0.0 );
+  for(unsigned i=0; i<getNumberOfArguments(); ++i) {
+    for(unsigned b=0; b<nbasins; b++) {
+      if( b==0 || lowerlimits[b][i]<envelopelow[i] ) envelopelow[i]=lowerlimits[b][i];
+      if( b==0 || upperlimits[b][i]>envelopehigh[i] ) envelopehigh[i]=upperlimits[b][i];
+    }
+  }
+
   for(unsigned i=0; i<getNumberOfArguments(); ++i) ofile.setupPrintValue( getPntrToArgument(i) );
 }
 
 void Committor::calculate() {
-  std::vector<unsigned> inbasin;
-  inbasin.assign (nbasins,1);
-
-  // check if current configuration belongs to a basin
-  for(unsigned b=0; b<nbasins; ++b) {
-    for(unsigned i=0; i<getNumberOfArguments(); ++i) {
-      if(getArgument(i)>lowerlimits[b][i]&&getArgument(i)<upperlimits[b][i]) {
-        inbasin[b]*=1;
-      } else {
-        inbasin[b]*=0;
-      }
-    }
+  // the common case is a configuration far away from every basin: reject it
+  // against the precomputed envelope of all the basin boxes before scanning
+  // the boxes one by one
+  for(unsigned i=0; i<getNumberOfArguments(); ++i) {
+    double a=getArgument(i);
+    if( !(a>envelopelow[i] && a<envelopehigh[i]) ) { basin=0; return; }
   }
 
   // check in which basin we are if any and if this is the same or a new one
   bool inonebasin = false;
   for(unsigned b=0; b<nbasins; ++b) {
-    if(inbasin[b]==1) {
+    bool inthisbasin=true;
+    for(unsigned i=0; i<getNumberOfArguments(); ++i) {
+      double a=getArgument(i);
+      if( !(a>lowerlimits[b][i] && a<upperlimits[b][i]) ) { inthisbasin=false; break; }
+    }
+    if(inthisbasin) {
       if(basin!=(b+1)) {
         basin = b+1;
         ofile.fmtField(" %f");
@@ -24,6 +24,7 @@
 #include "core/ActionRegister.h"
 #include "reference/MetricRegister.h"
 #include "reference/ReferenceConfiguration.h"
+#include <memory>
 
 //+PLUMEDOC ANALYSIS EUCLIDEAN_DISSIMILARITIES
 /*
@@ -42,6 +43,10 @@ private:
   PDB mypdb;
   std::string mtype;
   Matrix<double> dissimilarities;
+/// Per-frame reference configurations, created once on first use.  This keeps
+/// the memory cost linear in the number of frames while removing the pair of
+/// expensive reference creations that every dissimilarity used to pay for
+  std::vector<std::unique_ptr<ReferenceConfiguration> > myrefs;
 public:
   static void registerKeywords( Keywords& keys );
   explicit EuclideanDissimilarityMatrix( const ActionOptions& ao );
@@ -118,6 +123,8 @@ void EuclideanDissimilarityMatrix::performAnalysis() {
   if( !usingLowMem() ) {
     dissimilarities.resize( getNumberOfDataPoints(), getNumberOfDataPoints() ); dissimilarities=0;
   }
+  // Invalidate the per-frame references: the stored data may have changed
+  myrefs.clear(); myrefs.resize( getNumberOfDataPoints() );
 }
 
 std::string EuclideanDissimilarityMatrix::getDissimilarityInstruction() const {
@@ -130,13 +137,17 @@ double EuclideanDissimilarityMatrix::getDissimilarity( const unsigned& iframe, c
     if( dissimilarities(iframe,jframe)>0. ) { return dissimilarities(iframe,jframe); }
   }
   if( iframe!=jframe ) {
-    double dd;
-    getStoredData( iframe, true ).transferDataToPDB( mypdb );
-    auto myref1=metricRegister().create<ReferenceConfiguration>(mtype, mypdb);
-    getStoredData( jframe, true ).transferDataToPDB( mypdb );
-    auto myref2=metricRegister().create<ReferenceConfiguration>(mtype, mypdb);
-    if( !usingLowMem() ) dd=dissimilarities(iframe,jframe) = dissimilarities(jframe,iframe) = distance( getPbc(), getArguments(), myref1.get(), myref2.get(), true );
-    else dd=distance( getPbc(), getArguments(), myref1.get(), myref2.get(), true );
+    if( myrefs.size()!=getNumberOfDataPoints() ) { myrefs.clear(); myrefs.resize( getNumberOfDataPoints() ); }
+    if( !myrefs[iframe] ) {
+      getStoredData( iframe, true ).transferDataToPDB( mypdb );
+      myrefs[iframe]=metricRegister().create<ReferenceConfiguration>(mtype, mypdb);
+    }
+    if( !myrefs[jframe] ) {
+      getStoredData( jframe, true ).transferDataToPDB( mypdb );
+      myrefs[jframe]=metricRegister().create<ReferenceConfiguration>(mtype, mypdb);
+    }
+    double dd=distance( getPbc(), getArguments(), myrefs[iframe].get(), myrefs[jframe].get(), true );
+    if( !usingLowMem() ) dissimilarities(iframe,jframe) = dissimilarities(jframe,iframe) = dd;
     return dd;
   }
   return 0.0;
@@ -61,29 +61,34 @@ FarthestPointSampling::FarthestPointSampling( const ActionOptions& ao ):
 
 void FarthestPointSampling::selectLandmarks() {
   std::vector<unsigned> landmarks( getNumberOfDataPoints() );
+  const unsigned npoints = my_input_data->getNumberOfDataPoints();
 
   // Select first point at random
   Random random; random.setSeed(-seed); double rand=random.RandU01();
-  landmarks[0] = std::floor( my_input_data->getNumberOfDataPoints()*rand );
+  landmarks[0] = std::floor( npoints*rand );
   selectFrame( landmarks[0] );
 
-  // Now find distance to all other points (N.B. We can use squared distances here for speed)
-  Matrix<double> distances( getNumberOfDataPoints(), my_input_data->getNumberOfDataPoints() );
-  for(unsigned i=0; i<my_input_data->getNumberOfDataPoints(); ++i) distances(0,i) = my_input_data->getDissimilarity( landmarks[0], i );
+  // For every candidate keep its minimum distance to the landmarks selected
+  // so far: each new landmark contributes one distance row that is merged
+  // into the running minima in place, so selecting k landmarks costs one
+  // row per landmark rather than a rescan of all previous rows
+  // (N.B. We can use squared distances here for speed)
+  std::vector<double> mindists( npoints );
+  for(unsigned i=0; i<npoints; ++i) mindists[i] = my_input_data->getDissimilarity( landmarks[0], i );
 
   // Now find all other landmarks
   for(unsigned i=1; i<getNumberOfDataPoints(); ++i) {
     // Find point that has the largest minimum distance from the landmarks selected thus far
     double maxd=0;
-    for(unsigned j=0; j<my_input_data->getNumberOfDataPoints(); ++j) {
-      double mind=distances(0,j);
-      for(unsigned k=1; k<i; ++k) {
-        if( distances(k,j)<mind ) { mind=distances(k,j); }
-      }
-      if( mind>maxd ) { maxd=mind; landmarks[i]=j; }
+    for(unsigned j=0; j<npoints; ++j) {
+      if( mindists[j]>maxd ) { maxd=mindists[j]; landmarks[i]=j; }
     }
     selectFrame( landmarks[i] );
-    for(unsigned k=0; k<my_input_data->getNumberOfDataPoints(); ++k) distances(i,k) = my_input_data->getDissimilarity( landmarks[i], k );
+    // Merge the distance row of the new landmark into the running minima
+    for(unsigned k=0; k<npoints; ++k) {
+      double dist = my_input_data->getDissimilarity( landmarks[i], k );
+      if( dist<mindists[k] ) mindists[k]=dist;
+    }
   }
 }
 
@@ -27,6 +27,8 @@
 #include "multicolvar/MultiColvarBase.h"
 #include "core/PlumedMain.h"
 #include "core/ActionSet.h"
+#include "AnalysisBase.h"
+#include "DataCollectionObject.h"
 
 namespace PLMD {
 namespace analysis {
@@ -80,6 +82,18 @@ between two points on your grid rather than the value of a (continuous) function
 
 Additional material and examples can be also found in the tutorials \ref lugano-1.
 
+\par Automatic grid bounds
+
+When it is hard to guess the range that an argument will explore you can set GRID_MIN and GRID_MAX
+equal to auto for that argument.  For a periodic argument the bounds are then simply taken from its domain.
+For a non-periodic argument the bounds are instead determined from the sampled data: if the histogram is
+calculated from data that was collected with \ref COLLECT_FRAMES the full range of the stored data is
+available before any kernel is added to the grid so any kernel can be used.  If instead the histogram is
+accumulated on the fly the samples are buffered (together with their weights) until enough of them have
+been seen to fix the bounds, after which the buffer is replayed onto the grid.  In this second mode only
+KERNEL=DISCRETE can be used and any sample that falls outside the final bounds is added to the closest
+edge bin.  The number of such samples is reported at the end of the calculation.
+
 \par A note on block averaging and errors
 
 Some particularly important
@@ -192,6 +206,24 @@ HISTOGRAM ...
 DUMPGRID GRID=hh FILE=histo STRIDE=100000
 \endplumedfile
 
+The following input accumulates a discrete histogram of a distance without
+specifying its range on input.  The bounds of the grid are determined from
+the sampled data as explained above.
+
+\plumedfile
+d1: DISTANCE ATOMS=1,10
+HISTOGRAM ...
+  ARG=d1
+  KERNEL=DISCRETE
+  GRID_MIN=auto
+  GRID_MAX=auto
+  GRID_BIN=200
+  LABEL=hh
+... HISTOGRAM
+
+DUMPGRID GRID=hh FILE=histo
+\endplumedfile
+
 */
 //+ENDPLUMEDOC
 
@@ -199,6 +231,33 @@ class Histogram : public gridtools::ActionWithGrid {
 private:
   double ww;
   bool in_apply, mvectors;
+/// True if auto was used for the bounds of some of the grid dimensions
+  bool adaptive_bounds;
+/// True while the automatic bounds have not yet been fixed
+  bool bounds_pending;
+/// Which of the grid dimensions have automatic bounds
+  std::vector<bool> autodim;
+/// The bounds, numbers of bins and spacings read from the input, kept so
+/// that the bounds of an adaptive grid can be set once the extent of the
+/// sampled data is known
+  std::vector<std::string> gmin, gmax;
+  std::vector<unsigned> gbin;
+  std::vector<double> gspacing;
+/// Range of the sampled data for the dimensions with automatic bounds.
+/// Once the bounds have been fixed these hold the final bounds of the grid
+  std::vector<double> obs_min, obs_max;
+/// Samples deferred while the automatic bounds are still undetermined,
+/// stored together with their weights
+  std::vector<double> sample_points, sample_weights;
+/// Maximum number of samples to defer before the automatic bounds are fixed
+  unsigned max_samples;
+/// Number of samples that fell outside the automatic bounds after they were fixed
+  unsigned nclamped;
+/// The object the data is taken from when the histogram is calculated from stored analysis data
+  AnalysisBase* myanalysis;
+/// Fix the bounds of the dimensions that use automatic bounds from the
+/// range of the sampled data and resize the grid accordingly
+  void setAdaptiveBounds();
   std::unique_ptr<KernelFunctions> kernel;
   std::vector<double> forcesToApply, finalForces;
   std::vector<vesselbase::ActionWithVessel*> myvessels;
@@ -218,6 +277,7 @@ public:
   void turnOnDerivatives() override;
   void compute( const unsigned&, MultiValue& ) const override;
   void apply() override;
+  void runFinalJobs() override;
 };
 
 PLUMED_REGISTER_ACTION(Histogram,"HISTOGRAM")
@@ -227,8 +287,8 @@ void Histogram::registerKeywords( Keywords& keys ) {
   keys.add("compulsory","NORMALIZATION","ndata","This controls how the data is normalized it can be set equal to true, false or ndata.  See above for an explanation");
   keys.add("optional","DATA","input data from action with vessel and compute histogram");
   keys.add("optional","VECTORS","input three dimensional vectors for computing histogram");
-  keys.add("compulsory","GRID_MIN","the lower bounds for the grid");
-  keys.add("compulsory","GRID_MAX","the upper bounds for the grid");
+  keys.add("compulsory","GRID_MIN","the lower bounds for the grid.  Use auto to determine the bound from the domain of a periodic argument or from the sampled data");
+  keys.add("compulsory","GRID_MAX","the upper bounds for the grid.  Use auto to determine the bound from the domain of a periodic argument or from the sampled data");
   keys.add("optional","GRID_BIN","the number of bins for the grid");
   keys.add("optional","GRID_SPACING","the approximate grid spacing (to be used as an alternative or together with GRID_BIN)");
   keys.use("UPDATE_FROM"); keys.use("UPDATE_UNTIL");
@@ -239,7 +299,12 @@ Histogram::Histogram(const ActionOptions&ao):
   ActionWithGrid(ao),
   ww(0.0),
   in_apply(false),
-  mvectors(false)
+  mvectors(false),
+  adaptive_bounds(false),
+  bounds_pending(false),
+  max_samples(10000),
+  nclamped(0),
+  myanalysis(NULL)
 {
   // Read in arguments
   if( getNumberOfArguments()==0 ) {
@@ -308,14 +373,34 @@ Histogram::Histogram(const ActionOptions&ao):
   // notice that createGrid also sets mygrid=grid.get()
   if( mygrid->getType()=="flat" ) {
     if( mvectors ) error("computing histogram for three dimensional vectors but grid is not of fibonacci type - use CONCENTRATION");
-    std::vector<std::string> gmin( narg ), gmax( narg );
+    gmin.resize( narg ); gmax.resize( narg );
     parseVector("GRID_MIN",gmin); parseVector("GRID_MAX",gmax);
-    std::vector<unsigned> nbin; parseVector("GRID_BIN",nbin);
-    std::vector<double> gspacing; parseVector("GRID_SPACING",gspacing);
-    if( nbin.size()!=narg && gspacing.size()!=narg ) {
+    parseVector("GRID_BIN",gbin);
+    parseVector("GRID_SPACING",gspacing);
+    if( gbin.size()!=narg && gspacing.size()!=narg ) {
       error("GRID_BIN or GRID_SPACING must be set");
     }
-    mygrid->setBounds( gmin, gmax, nbin, gspacing );
+    // Deal with any bounds that should be worked out automatically
+    autodim.assign( narg, false );
+    for(unsigned i=0; i<narg; ++i) {
+      if( (gmin[i]=="auto")!=(gmax[i]=="auto") ) error("GRID_MIN and GRID_MAX should both be set to auto for the same argument");
+      if( gmin[i]!="auto" ) continue;
+      if( myvessels.size()>0 ) error("automatic grid bounds can only be used when the histogram is computed from plain arguments");
+      if( getPntrToArgument(i)->isPeriodic() ) {
+        // The bounds of a periodic argument are simply its domain
+        getPntrToArgument(i)->getDomain( gmin[i], gmax[i] );
+      } else {
+        autodim[i]=true; adaptive_bounds=bounds_pending=true;
+      }
+    }
+    if( adaptive_bounds ) {
+      if( gbin.size()==narg && gspacing.size()==narg ) error("GRID_BIN and GRID_SPACING cannot both be set when using automatic grid bounds");
+      if( clearstride>0 && !storeThenAverage() ) error("automatic grid bounds cannot be used together with CLEAR");
+      obs_min.assign( narg, 0.0 ); obs_max.assign( narg, 0.0 );
+      log.printf("  setting grid bounds automatically from the range of the sampled data\n");
+    } else {
+      mygrid->setBounds( gmin, gmax, gbin, gspacing );
+    }
   } else {
     std::vector<unsigned> nbin; parseVector("GRID_BIN",nbin);
     if( nbin.size()!=1 ) error("should only be one index for number of bins with spherical grid");
@@ -323,6 +408,16 @@ Histogram::Histogram(const ActionOptions&ao):
   }
   myhist = dynamic_cast<gridtools::HistogramOnGrid*>( mygrid );
   plumed_assert( myhist );
+  if( adaptive_bounds ) {
+    if( storeThenAverage() ) {
+      // The full range of the stored data is available before anything is
+      // added to the grid so any kernel type can be used in this mode
+      myanalysis = dynamic_cast<AnalysisBase*>( getPntrToArgument(0)->getPntrToAction() );
+      plumed_assert( myanalysis );
+    } else if( myhist->noDiscreteKernels() ) {
+      error("automatic grid bounds for a histogram that is accumulated on the fly require KERNEL=DISCRETE");
+    }
+  }
   if( myvessels.size()>0 ) {
     // Create a task list
     for(unsigned i=0; i<myvessels[0]->getFullNumberOfTasks(); ++i) addTaskToList(i);
@@ -338,6 +433,46 @@ Histogram::Histogram(const ActionOptions&ao):
   checkRead();
 }
 
+void Histogram::setAdaptiveBounds() {
+  plumed_assert( bounds_pending );
+  for(unsigned i=0; i<autodim.size(); ++i) {
+    if( !autodim[i] ) continue;
+    // Pad the observed range so that the extreme samples do not sit on the
+    // boundary of the grid.  If the spacing was set on input that is the
+    // natural amount of padding to use
+    double pad;
+    if( gspacing.size()==autodim.size() ) pad=gspacing[i];
+    else pad=0.05*( obs_max[i]-obs_min[i] );
+    if( pad<=0.0 ) pad=0.5;
+    obs_min[i]-=pad; obs_max[i]+=pad;
+    Tools::convert( obs_min[i], gmin[i] ); Tools::convert( obs_max[i], gmax[i] );
+    log.printf("  fixed bounds of grid for %s : %s to %s \n", mygrid->getComponentName(i).c_str(), gmin[i].c_str(), gmax[i].c_str() );
+  }
+  mygrid->setBounds( gmin, gmax, gbin, gspacing ); resizeFunctions();
+  bounds_pending=false;
+  // And replay any samples that were deferred while the bounds were unknown
+  if( sample_weights.size()>0 ) {
+    unsigned narg=getNumberOfArguments();
+    std::vector<double> point( narg );
+    unsigned num_neigh; std::vector<unsigned> neighbors(1);
+    for(unsigned i=0; i<sample_weights.size(); ++i) {
+      for(unsigned j=0; j<narg; ++j) point[j]=sample_points[i*narg+j];
+      myhist->getKernelAndNeighbors( point, num_neigh, neighbors );
+      mygrid->addToGridElement( neighbors[0], 0, sample_weights[i] );
+    }
+    std::vector<double>().swap( sample_points ); std::vector<double>().swap( sample_weights );
+  }
+}
+
+void Histogram::runFinalJobs() {
+  if( bounds_pending && myvessels.size()==0 && !storeThenAverage() ) {
+    if( sample_weights.empty() ) error("cannot set automatic bounds for grid as no data was sampled");
+    setAdaptiveBounds();
+  }
+  if( nclamped>0 ) log.printf("  %u samples fell outside the automatic bounds of the grid and were added to the closest edge bins\n",nclamped);
+  ActionWithAveraging::runFinalJobs();
+}
+
 void Histogram::turnOnDerivatives() {
   ActionWithGrid::turnOnDerivatives();
   std::vector<AtomNumber> all_atoms, tmp_atoms;
@@ -391,10 +526,49 @@ void Histogram::prepareForAveraging() {
     // Sort out normalization of histogram
     if( !noNormalization() ) ww = cweight / norm;
     else ww = cweight;
-  } else if( !storeThenAverage() ) {
+  } else if( storeThenAverage() ) {
+    if( bounds_pending ) {
+      // All the stored data is available before anything is added to the
+      // grid here so the bounds can be set from its full range
+      for(unsigned i=0; i<myanalysis->getNumberOfDataPoints(); ++i) {
+        DataCollectionObject& mystore=myanalysis->getStoredData( i, false );
+        for(unsigned j=0; j<getNumberOfArguments(); ++j) {
+          if( !autodim[j] ) continue;
+          double a=mystore.getArgumentValue( ActionWithArguments::getArguments()[j]->getName() );
+          if( i==0 || a<obs_min[j] ) obs_min[j]=a;
+          if( i==0 || a>obs_max[j] ) obs_max[j]=a;
+        }
+      }
+      setAdaptiveBounds();
+    }
+  } else {
     // Now fetch the kernel and the active points
     std::vector<double> point( getNumberOfArguments() );
     for(unsigned i=0; i<point.size(); ++i) point[i]=getArgument(i);
+    if( bounds_pending ) {
+      // The bounds of the grid are not yet known so stash this sample and
+      // its weight.  The buffer is replayed onto the grid when the bounds
+      // are fixed, either here or at the end of the calculation
+      for(unsigned i=0; i<point.size(); ++i) {
+        if( !autodim[i] ) continue;
+        if( sample_weights.empty() || point[i]<obs_min[i] ) obs_min[i]=point[i];
+        if( sample_weights.empty() || point[i]>obs_max[i] ) obs_max[i]=point[i];
+      }
+      for(unsigned i=0; i<point.size(); ++i) sample_points.push_back( point[i] );
+      sample_weights.push_back( cweight );
+      if( sample_weights.size()>=max_samples ) setAdaptiveBounds();
+      return;
+    } else if( adaptive_bounds ) {
+      // Samples falling outside the automatic bounds after they have been
+      // fixed are added to the closest edge bin
+      bool clamped=false;
+      for(unsigned i=0; i<point.size(); ++i) {
+        if( !autodim[i] ) continue;
+        if( point[i]<obs_min[i] ) { point[i]=obs_min[i]; clamped=true; }
+        else if( point[i]>obs_max[i] ) { point[i]=obs_max[i]; clamped=true; }
+      }
+      if( clamped ) nclamped++;
+    }
     unsigned num_neigh; std::vector<unsigned> neighbors(1);
     kernel=myhist->getKernelAndNeighbors( point, num_neigh, neighbors );
 
@@ -481,14 +655,14 @@ void Histogram::compute( const unsigned& current, MultiValue& myvals ) const {
     if( in_apply ) myvals.updateDynamicList();
   } else {
     plumed_assert( !in_apply );
-    std::vector<std::unique_ptr<Value>> vv( myhist->getVectorOfValues() );
+    const std::vector<Value*>& vv( myhist->getScratchVectorOfValues() );
     std::vector<double> val( getNumberOfArguments() ), der( getNumberOfArguments() );
     // Retrieve the location of the grid point at which we are evaluating the kernel
     mygrid->getGridPointCoordinates( current, val );
     if( kernel ) {
       for(unsigned i=0; i<getNumberOfArguments(); ++i) vv[i]->set( val[i] );
       // Evaluate the histogram at the relevant grid point and set the values
-      double vvh = kernel->evaluate( Tools::unique2raw(vv), der,true); myvals.setValue( 1, vvh );
+      double vvh = kernel->evaluate( vv, der,true); myvals.setValue( 1, vvh );
     } else {
       plumed_merror("normalisation of vectors does not work with arguments and spherical grids");
       // Evalulate dot product
@@ -23,6 +23,8 @@
 #include "core/PlumedMain.h"
 #include "core/ActionSet.h"
 #include "core/ActionRegister.h"
+#include "tools/Communicator.h"
+#include <cstdio>
 
 //+PLUMEDOC ANALYSIS COLLECT_FRAMES
 /*
@@ -44,6 +46,9 @@ void ReadAnalysisFrames::registerKeywords( Keywords& keys ) {
   keys.add("atoms-1","ATOMS","the atoms whose positions we are tracking for the purpose of analyzing the data");
   keys.add("atoms-1","STRIDE","the frequency with which data should be stored for analysis.  By default data is collected on every step");
   keys.add("compulsory","CLEAR","0","the frequency with which data should all be deleted and restarted");
+  keys.add("compulsory","MAX_RESIDENT_FRAMES","0","the maximum number of frames whose atomic positions are kept in memory.  The positions "
+           "of any further frames are spilled to a scratch file and read back on demand, which bounds the memory used when "
+           "collecting very long trajectories.  The default of 0 keeps everything in memory");
   keys.add("optional","LOGWEIGHTS","list of actions that calculates log weights that should be used to weight configurations when calculating averages");
   ActionWithValue::useCustomisableComponents( keys );
 }
@@ -53,7 +58,9 @@ ReadAnalysisFrames::ReadAnalysisFrames( const ActionOptions& ao ):
   AnalysisBase(ao),
   clearonnextstep(false),
   wham_pointer(NULL),
-  weights_calculated(false)
+  weights_calculated(false),
+  max_resident(0),
+  spill_natoms(0)
 {
   parse("CLEAR",clearstride);
   if( clearstride!=0 ) log.printf("  clearing stored data every %u steps\n",clearstride);
@@ -67,6 +74,15 @@ ReadAnalysisFrames::ReadAnalysisFrames( const ActionOptions& ao ):
     for(unsigned i=0; i<atom_numbers.size(); ++i) log.printf("%d ",atom_numbers[i].serial() );
     log.printf("\n"); requestAtoms(atom_numbers);
   }
+  parse("MAX_RESIDENT_FRAMES",max_resident);
+  if( max_resident>0 ) {
+    if( atom_numbers.size()==0 ) error("MAX_RESIDENT_FRAMES bounds the memory used for the stored atomic positions so it requires ATOMS");
+    // every rank keeps its own stash so every rank needs its own scratch file
+    std::string rnum; spill_fname=getLabel() + ".stash.tmp";
+    if( multi_sim_comm.Get_size()>1 ) { Tools::convert(multi_sim_comm.Get_rank(),rnum); spill_fname += "." + rnum; }
+    if( comm.Get_size()>1 ) { Tools::convert(comm.Get_rank(),rnum); spill_fname += "-" + rnum; }
+    log.printf("  keeping the positions of at most %u frames in memory, spilling the remainder to %s\n",max_resident,spill_fname.c_str());
+  }
 
   // Get stuff for any reweighting that should go on
   std::vector<std::string> wwstr; parseVector("LOGWEIGHTS",wwstr);
@@ -92,6 +108,44 @@ ReadAnalysisFrames::ReadAnalysisFrames( const ActionOptions& ao ):
   for(unsigned i=0; i<argument_names.size(); ++i) { addComponent( argument_names[i] ); componentIsNotPeriodic( argument_names[i] ); }
 }
 
+ReadAnalysisFrames::~ReadAnalysisFrames() {
+  if( spill_file.is_open() ) { spill_file.close(); std::remove( spill_fname.c_str() ); }
+}
+
+void ReadAnalysisFrames::evictFrame() {
+  unsigned victim=resident_list.front();
+  resident_list.pop_front(); resident_map.erase( victim );
+  std::vector<Vector>& pos( my_data_stash[victim].positions );
+  // positions never change once a frame has been collected, so each frame
+  // is written to its fixed-size record in the scratch file at most once
+  if( !on_disk[victim] ) {
+    if( !spill_file.is_open() ) {
+      spill_file.open( spill_fname.c_str(), std::fstream::in | std::fstream::out | std::fstream::binary | std::fstream::trunc );
+      if( !spill_file.is_open() ) error("could not open scratch file " + spill_fname + " for storing frame positions");
+    }
+    spill_file.seekp( static_cast<std::streamoff>(victim)*spill_natoms*3*sizeof(double) );
+    spill_file.write( reinterpret_cast<const char*>(&pos[0][0]), spill_natoms*3*sizeof(double) );
+    on_disk[victim]=true;
+  }
+  std::vector<Vector>().swap( pos );
+}
+
+void ReadAnalysisFrames::touchFrame( const unsigned& idata ) {
+  std::map<unsigned,std::list<unsigned>::iterator>::iterator it=resident_map.find( idata );
+  if( it!=resident_map.end() ) {
+    // the most recently used frames live at the back of the list
+    resident_list.splice( resident_list.end(), resident_list, it->second );
+    return;
+  }
+  plumed_assert( on_disk[idata] );
+  std::vector<Vector>& pos( my_data_stash[idata].positions );
+  pos.resize( spill_natoms );
+  spill_file.seekg( static_cast<std::streamoff>(idata)*spill_natoms*3*sizeof(double) );
+  spill_file.read( reinterpret_cast<char*>(&pos[0][0]), spill_natoms*3*sizeof(double) );
+  resident_map[idata]=resident_list.insert( resident_list.end(), idata );
+  while( resident_list.size()>max_resident ) evictFrame();
+}
+
 std::vector<Value*> ReadAnalysisFrames::getArgumentList() {
   std::vector<Value*> arg_vals( ActionWithArguments::getArguments() );
   for(unsigned i=0; i<weight_vals.size(); ++i) arg_vals.erase(arg_vals.end()-1);
@@ -134,6 +188,10 @@ void ReadAnalysisFrames::update() {
     my_data_stash.clear(); my_data_stash.resize(0);
     logweights.clear(); logweights.resize(0);
     if( wham_pointer ) wham_pointer->clearData();
+    if( max_resident>0 ) {
+      on_disk.clear(); resident_list.clear(); resident_map.clear();
+      if( spill_file.is_open() ) { spill_file.close(); std::remove( spill_fname.c_str() ); }
+    }
     clearonnextstep=false;
   }
 
@@ -147,6 +205,15 @@ void ReadAnalysisFrames::update() {
   my_data_stash[index].setAtomPositions( getPositions() );
   for(unsigned i=0; i<argument_names.size(); ++i) my_data_stash[index].setArgument( argument_names[i], getArgument(i) );
 
+  // with a bounded stash the new frame becomes resident and the least
+  // recently used positions are spilled to the scratch file
+  if( max_resident>0 && atom_numbers.size()>0 ) {
+    spill_natoms=atom_numbers.size();
+    on_disk.push_back( false );
+    resident_map[index]=resident_list.insert( resident_list.end(), index );
+    while( resident_list.size()>max_resident ) evictFrame();
+  }
+
   if( clearstride>0 ) {
     if( getStep()%clearstride==0 ) clearonnextstep=true;
   }
@@ -24,6 +24,9 @@
 
 #include "AnalysisBase.h"
 #include "bias/ReweightBase.h"
+#include <fstream>
+#include <list>
+#include <map>
 
 namespace PLMD {
 namespace analysis {
@@ -46,11 +49,29 @@ private:
   std::vector<double> logweights, weights;
 /// The data that has been collected from the trajectory
   std::vector<DataCollectionObject> my_data_stash;
+/// Maximum number of frames whose atomic positions are kept in memory (0 keeps everything)
+  unsigned max_resident;
+/// Number of atoms in each record of the scratch file
+  unsigned spill_natoms;
+/// Name of the scratch file that holds the spilled positions
+  std::string spill_fname;
+/// Scratch file with one fixed-size record of positions per frame
+  std::fstream spill_file;
+/// Which frames have already been written to the scratch file
+  std::vector<bool> on_disk;
+/// Frames whose positions are resident, least recently used at the front
+  std::list<unsigned> resident_list;
+  std::map<unsigned,std::list<unsigned>::iterator> resident_map;
+/// Make the positions of a frame resident, restoring them from disk if needed
+  void touchFrame( const unsigned& idata );
+/// Write the positions of the least recently used frame to disk and release them
+  void evictFrame();
 /// Calculate the weights of the various points from the logweights
   void calculateWeights();
 public:
   static void registerKeywords( Keywords& keys );
   explicit ReadAnalysisFrames( const ActionOptions& ao );
+  ~ReadAnalysisFrames();
   void update() override;
 /// This does nothing
   void performAnalysis() override {}
@@ -68,7 +89,8 @@ public:
   std::string getDissimilarityInstruction() const override;
 /// Get the weight of one of the objects
   double getWeight( const unsigned& idat ) override;
-/// Get the reference configuration
+/// Get the reference configuration.  With MAX_RESIDENT_FRAMES the atomic
+/// positions of the returned object stay valid until the next call only
   DataCollectionObject & getStoredData( const unsigned& idata, const bool& calcdist ) override;
 /// Get the list of atoms that are being stored
   const std::vector<AtomNumber>& getAtomIndexes() const override;
@@ -98,6 +120,7 @@ double ReadAnalysisFrames::getWeight( const unsigned& idat ) {
 inline
 DataCollectionObject & ReadAnalysisFrames::getStoredData( const unsigned& idata, const bool& calcdist ) {
   plumed_dbg_assert( idata<my_data_stash.size() );
+  if( max_resident>0 && spill_natoms>0 ) touchFrame( idata );
   return my_data_stash[idata];
 }
 
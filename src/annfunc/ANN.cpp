@@ -93,18 +93,23 @@ private:
   int num_layers;
   vector<int> num_nodes;
   vector<string> activations;   // activation functions
-  vector<vector<double> > weights;  // flattened weight arrays
+  vector<vector<double> > weights;  // flattened row-major weight arrays, weights[ii][jj * num_nodes[ii] + kk]
+  vector<vector<double> > weights_T;  // transposed copies of the weight arrays, used in back propagation
   vector<vector<double> > biases;
   vector<vector<double> > output_of_each_layer;
   vector<vector<double> > input_of_each_layer;
-  vector<double** > coeff;  // weight matrix arrays, reshaped from "weights"
+  vector<vector<double> > act_deriv_of_each_layer;  // derivative of the activation at each node, filled in the forward pass
+  vector<vector<double> > derivatives_of_each_layer;
+  vector<double> delta_scratch;  // derivative of output times activation derivative, shared by the back propagation loops
+  vector<double> input_layer_data;  // persistent input buffer, avoids one allocation per frame
+  vector<Value*> node_values;  // cached component pointers, avoids one name lookup per component per frame
 
 public:
   static void registerKeywords( Keywords& keys );
   explicit ANN(const ActionOptions&);
   virtual void calculate();
   void calculate_output_of_each_layer(const vector<double>& input);
-  void back_prop(vector<vector<double> >& derivatives_of_each_layer, int index_of_output_component);
+  void back_prop(int index_of_output_component);
 };
 
 PLUMED_REGISTER_ACTION(ANN,"ANN")
@@ -133,7 +138,8 @@ ANN::ANN(const ActionOptions&ao):
   activations = vector<string>(num_layers - 1);
   output_of_each_layer = vector<vector<double> >(num_layers);
   input_of_each_layer = vector<vector<double> >(num_layers);
-  coeff = vector<double** >(num_layers - 1);
+  act_deriv_of_each_layer = vector<vector<double> >(num_layers);
+  derivatives_of_each_layer = vector<vector<double> >(num_layers);
   parseVector("NUM_NODES", num_nodes);
   parseVector("ACTIVATIONS", activations);
   log.printf("\nactivations = ");
@@ -167,27 +173,36 @@ ANN::ANN(const ActionOptions&ao):
     error("Number of arguments is wrong");
   }
 
-  auto temp_coeff = weights;
   for (int ii = 0; ii < num_layers - 1; ii ++) {
     int num_of_rows, num_of_cols; // num of rows/cols for the coeff matrix of this connection
     num_of_rows = num_nodes[ii + 1];
     num_of_cols = num_nodes[ii];
-    assert (num_of_rows * num_of_cols == temp_coeff[ii].size()); // check whether the size matches
-    // create a 2d array to hold coefficients
-    coeff[ii] = new double*[num_of_rows];
-    for (int kk = 0; kk < num_of_rows; kk ++) {
-      coeff[ii][kk] = new double[num_of_cols];
-    }
-    for (int jj = 0; jj < temp_coeff[ii].size(); jj ++) {
-      coeff[ii][jj / num_of_cols][jj % num_of_cols] = temp_coeff[ii][jj];
+    assert (num_of_rows * num_of_cols == weights[ii].size()); // check whether the size matches
+    // keep a transposed copy, so that the back propagation also runs over
+    // contiguous memory
+    weights_T.push_back(vector<double>(num_of_rows * num_of_cols));
+    for (int jj = 0; jj < num_of_rows; jj ++) {
+      for (int kk = 0; kk < num_of_cols; kk ++) {
+        weights_T[ii][kk * num_of_rows + jj] = weights[ii][jj * num_of_cols + kk];
+      }
     }
   }
+  // size the per-layer buffers once, so that no allocation happens while calculating
+  int max_nodes = 0;
+  for (int ii = 0; ii < num_layers; ii ++) {
+    output_of_each_layer[ii].resize(num_nodes[ii]);
+    input_of_each_layer[ii].resize(num_nodes[ii]);
+    act_deriv_of_each_layer[ii].resize(num_nodes[ii]);
+    derivatives_of_each_layer[ii].resize(num_nodes[ii]);
+    if (num_nodes[ii] > max_nodes) max_nodes = num_nodes[ii];
+  }
+  delta_scratch.resize(max_nodes);
   // check coeff
   for (int ii = 0; ii < num_layers - 1; ii ++) {
     log.printf("coeff %d = \n", ii);
     for (int jj = 0; jj < num_nodes[ii + 1]; jj ++) {
       for (int kk = 0; kk < num_nodes[ii]; kk ++) {
-        log.printf("%f ", coeff[ii][jj][kk]);
+        log.printf("%f ", weights[ii][jj * num_nodes[ii] + kk]);
       }
       log.printf("\n");
     }
@@ -206,7 +221,9 @@ ANN::ANN(const ActionOptions&ao):
     string name_of_this_component = "node-" + to_string(ii);
     addComponentWithDerivatives(name_of_this_component);
     componentIsNotPeriodic(name_of_this_component);
+    node_values.push_back(getPntrToComponent(name_of_this_component));
   }
+  input_layer_data.resize(num_nodes[0]);
   checkRead();
 }
 
@@ -215,24 +232,32 @@ void ANN::calculate_output_of_each_layer(const vector<double>& input) {
   output_of_each_layer[0] = input;
   // following layers
   for(int ii = 1; ii < num_nodes.size(); ii ++) {
-    output_of_each_layer[ii].resize(num_nodes[ii]);
-    input_of_each_layer[ii].resize(num_nodes[ii]);
-    // first calculate input
+    // first calculate input: a matrix-vector product over the flat row-major
+    // weight array, so every inner loop runs over contiguous memory
+    const double* ww = &weights[ii - 1][0];
+    const double* prev = &output_of_each_layer[ii - 1][0];
+    int num_of_cols = num_nodes[ii - 1];
     for (int jj = 0; jj < num_nodes[ii]; jj ++) {
-      input_of_each_layer[ii][jj] = biases[ii - 1][jj];  // add bias term
-      for (int kk = 0; kk < num_nodes[ii - 1]; kk ++) {
-        input_of_each_layer[ii][jj] += coeff[ii - 1][jj][kk] * output_of_each_layer[ii - 1][kk];
+      double sum = biases[ii - 1][jj];  // add bias term
+      const double* row = ww + jj * num_of_cols;
+      for (int kk = 0; kk < num_of_cols; kk ++) {
+        sum += row[kk] * prev[kk];
       }
+      input_of_each_layer[ii][jj] = sum;
     }
-    // then get output
+    // then get output, together with the derivative of the activation that
+    // the back propagation needs, so that tanh is evaluated only once
     if (activations[ii - 1] == string("Linear")) {
       for(int jj = 0; jj < num_nodes[ii]; jj ++) {
         output_of_each_layer[ii][jj] = input_of_each_layer[ii][jj];
+        act_deriv_of_each_layer[ii][jj] = 1;
       }
     }
     else if (activations[ii - 1] == string("Tanh")) {
       for(int jj = 0; jj < num_nodes[ii]; jj ++) {
-        output_of_each_layer[ii][jj] = tanh(input_of_each_layer[ii][jj]);
+        double value = tanh(input_of_each_layer[ii][jj]);
+        output_of_each_layer[ii][jj] = value;
+        act_deriv_of_each_layer[ii][jj] = 1 - value * value;
       }
     }
     else if (activations[ii - 1] == string("Circular")) {
@@ -272,8 +297,7 @@ void ANN::calculate_output_of_each_layer(const vector<double>& input) {
   return;
 }
 
-void ANN::back_prop(vector<vector<double> >& derivatives_of_each_layer, int index_of_output_component) {
-  derivatives_of_each_layer = output_of_each_layer;  // the data structure and size should be the same, so I simply deep copy it
+void ANN::back_prop(int index_of_output_component) {
   // first calculate derivatives for bottleneck layer
   for (int ii = 0; ii < num_nodes[num_nodes.size() - 1]; ii ++ ) {
     if (ii == index_of_output_component) {
@@ -311,40 +335,33 @@ void ANN::back_prop(vector<vector<double> >& derivatives_of_each_layer, int inde
       }
 #endif
       // the calculate the derivative of output of layer jj, from derivative of input of layer (jj + 1)
+      const double* wt = &weights_T[jj][0];
+      int num_of_rows = num_nodes[jj + 1];
       for (int mm = 0; mm < num_nodes[jj]; mm ++) {
-        derivatives_of_each_layer[jj][mm] = 0;
-        for (int kk = 0; kk < num_nodes[jj + 1]; kk ++) {
-          derivatives_of_each_layer[jj][mm] += coeff[jj][kk][mm] \
-                                               * temp_derivative_of_input_for_this_layer[kk];
-#ifdef DEBUG
-          printf("derivatives_of_each_layer[%d][%d] = %lf\n", jj, mm, derivatives_of_each_layer[jj][mm]);
-          printf("coeff[%d][%d][%d] = %lf\n", jj, kk, mm, coeff[jj][kk][mm]);
-#endif
+        double sum = 0;
+        const double* col = wt + mm * num_of_rows;
+        for (int kk = 0; kk < num_of_rows; kk ++) {
+          sum += col[kk] * temp_derivative_of_input_for_this_layer[kk];
         }
+        derivatives_of_each_layer[jj][mm] = sum;
       }
       // TODO: should be fine, pass all tests, although there seems to be some problems here previously
     }
     else {
+      // fold the activation derivative stored in the forward pass into the
+      // derivative of the output once per node, instead of once per matrix element
+      int num_of_rows = num_nodes[jj + 1];
+      for (int kk = 0; kk < num_of_rows; kk ++) {
+        delta_scratch[kk] = derivatives_of_each_layer[jj + 1][kk] * act_deriv_of_each_layer[jj + 1][kk];
+      }
+      const double* wt = &weights_T[jj][0];
       for (int mm = 0; mm < num_nodes[jj]; mm ++) {
-        derivatives_of_each_layer[jj][mm] = 0;
-        for (int kk = 0; kk < num_nodes[jj + 1]; kk ++) {
-          if (activations[jj] == string("Tanh")) {
-            // printf("tanh\n");
-            derivatives_of_each_layer[jj][mm] += derivatives_of_each_layer[jj + 1][kk] \
-                                                 * coeff[jj][kk][mm] \
-                                                 * (1 - output_of_each_layer[jj + 1][kk] * output_of_each_layer[jj + 1][kk]);
-          }
-          else if (activations[jj] == string("Linear")) {
-            // printf("linear\n");
-            derivatives_of_each_layer[jj][mm] += derivatives_of_each_layer[jj + 1][kk] \
-                                                 * coeff[jj][kk][mm] \
-                                                 * 1;
-          }
-          else {
-            printf("layer type not found!\n\n");
-            return;
-          }
+        double sum = 0;
+        const double* col = wt + mm * num_of_rows;
+        for (int kk = 0; kk < num_of_rows; kk ++) {
+          sum += col[kk] * delta_scratch[kk];
         }
+        derivatives_of_each_layer[jj][mm] = sum;
       }
     }
   }
@@ -365,18 +382,15 @@ void ANN::back_prop(vector<vector<double> >& derivatives_of_each_layer, int inde
 
 void ANN::calculate() {
 
-  vector<double> input_layer_data(num_nodes[0]);
   for (int ii = 0; ii < num_nodes[0]; ii ++) {
     input_layer_data[ii] = getArgument(ii);
   }
 
   calculate_output_of_each_layer(input_layer_data);
-  vector<vector<double> > derivatives_of_each_layer;
 
   for (int ii = 0; ii < num_nodes[num_layers - 1]; ii ++) {
-    back_prop(derivatives_of_each_layer, ii);
-    string name_of_this_component = "node-" + to_string(ii);
-    Value* value_new=getPntrToComponent(name_of_this_component);
+    back_prop(ii);
+    Value* value_new=node_values[ii];
     value_new -> set(output_of_each_layer[num_layers - 1][ii]);
     for (int jj = 0; jj < num_nodes[0]; jj ++) {
       value_new -> setDerivative(jj, derivatives_of_each_layer[0][jj]);  // TODO: setDerivative or addDerivative?
@@ -132,6 +132,10 @@ void External::registerKeywords(Keywords& keys) {
   keys.addFlag("NOSPLINE",false,"specifies that no spline interpolation is to be used when calculating the energy and forces due to the external potential");
   keys.addFlag("SPARSE",false,"specifies that the external potential uses a sparse grid");
   keys.add("compulsory","SCALE","1.0","a factor that multiplies the external potential, useful to invert free energies");
+  keys.add("compulsory","REFINE_FACTOR","0","coarsen the input grid by this factor after reading it, keeping the full resolution only where it matters (0 means no coarsening). The fine grid is kept wherever interpolating the coarse one would introduce an error larger than REFINE_THRESHOLD, which cuts the memory footprint of smooth high-dimensional biases while preserving the accuracy at the barriers");
+  keys.add("compulsory","REFINE_THRESHOLD","0.0","maximum interpolation error (in energy units) tolerated in the regions that are coarsened by REFINE_FACTOR");
+  keys.add("compulsory","STORAGE","double","the precision used to keep the potential in memory after reading it: double (the default), float or half. Since the potential is only looked up, storing it in reduced precision halves or quarters the memory footprint of large grids at the price of truncating the values to about 7 (float) or 3 (half) significant digits");
+  keys.addFlag("RECOMPUTE_DER",false,"with STORAGE=float or STORAGE=half, do not store the derivatives of the potential but recompute them from the stored values by central differences, removing another factor 1+dimension from the memory footprint");
 }
 
 External::External(const ActionOptions& ao):
@@ -146,6 +150,18 @@ External::External(const ActionOptions& ao):
   parseFlag("NOSPLINE",nospline);
   bool spline=!nospline;
   parse("SCALE",scale_);
+  unsigned refine_factor=0;
+  parse("REFINE_FACTOR",refine_factor);
+  double refine_threshold=0.0;
+  parse("REFINE_THRESHOLD",refine_threshold);
+  if(refine_factor==1 || (refine_factor>1 && sparsegrid)) error("REFINE_FACTOR should be at least 2 and cannot be combined with SPARSE");
+  std::string storage;
+  parse("STORAGE",storage);
+  bool recompute_der=false;
+  parseFlag("RECOMPUTE_DER",recompute_der);
+  if(storage!="double" && storage!="float" && storage!="half") error("STORAGE should be double, float or half");
+  if(storage!="double" && (sparsegrid || refine_factor>1)) error("STORAGE=float/half cannot be combined with SPARSE or REFINE_FACTOR");
+  if(recompute_der && storage=="double") error("RECOMPUTE_DER requires STORAGE=float or STORAGE=half");
 
   checkRead();
 
@@ -162,6 +178,18 @@ External::External(const ActionOptions& ao):
   for(unsigned i=0; i<getNumberOfArguments(); ++i) {
     if( getPntrToArgument(i)->isPeriodic()!=BiasGrid_->getIsPeriodic()[i] ) error("periodicity mismatch between arguments and input bias");
   }
+  if(refine_factor>1) {
+    std::unique_ptr<RefinedGrid> rgrid(new RefinedGrid(funcl,*BiasGrid_,refine_factor,refine_threshold));
+    log.printf("  External potential coarsened by a factor %u, tolerating interpolation errors up to %f\n",refine_factor,refine_threshold);
+    log.printf("  storing %zu of %zu grid points\n",static_cast<size_t>(rgrid->getAllocatedSize()),static_cast<size_t>(rgrid->getSize()));
+    BiasGrid_=std::move(rgrid);
+  }
+  if(storage!="double") {
+    CompressedGrid::Precision prec=(storage=="float")?CompressedGrid::fp32:CompressedGrid::fp16;
+    BiasGrid_.reset(new CompressedGrid(funcl,*BiasGrid_,prec,!recompute_der));
+    log.printf("  External potential stored in %s precision\n",storage.c_str());
+    if(recompute_der) log.printf("  derivatives are not stored and will be recomputed from the values by central differences\n");
+  }
 }
 
 void External::calculate()
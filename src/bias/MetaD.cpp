@@ -29,12 +29,17 @@
 #include "core/FlexibleBin.h"
 #include "tools/Matrix.h"
 #include "tools/Random.h"
+#include "tools/OpenMP.h"
+#include "tools/FastMath.h"
+#include "tools/TargetClones.h"
+#include "tools/Communicator.h"
 #include <string>
 #include <cstring>
 #include "tools/File.h"
 #include <iostream>
 #include <limits>
 #include <ctime>
+#include <cstdint>
 #include <memory>
 
 #define DP2CUTOFF 6.25
@@ -88,7 +93,11 @@ This default choice should be reasonable for most applications.
 
 Metadynamics can be restarted either from a HILLS file as well as from a GRID, in this second
 case one can first save a GRID using GRID_WFILE (and GRID_WSTRIDE) and at a later stage read
-it using GRID_RFILE.
+it using GRID_RFILE. Grids written with GRID_WFILE carry a watermark with the number of hills
+they incorporate: when restarting with GRID_RFILE from such a grid, only the hills deposited
+after the grid was written are replayed from the HILLS files, so the restart takes seconds
+rather than replaying the entire history. Grids written by older versions have no watermark
+and are used as before, i.e. without replaying the HILLS files at all.
 
 Another option that is available in plumed is well-tempered metadynamics \cite Barducci:2008. In this
 variant of metadynamics the heights of the Gaussian hills are scaled at each step so the bias is now
@@ -229,6 +238,11 @@ id of the present walker (starting from 0 ) and the WALKERS_DIR is the directory
 where all the walkers are located. WALKERS_RSTRIDE is the number of step between
 one update and the other. Since version 2.2.5, hills files are automatically
 flushed every WALKERS_RSTRIDE steps.
+When all the walkers are replicas of the same multi-replica run (as in
+bias-exchange metadynamics) the WALKERS_SHARE_HILLS flag makes the new hills
+travel directly in memory over MPI every WALKERS_RSTRIDE steps, so the other
+walkers' hills files are never re-read during the run. The files are still
+written, and are only read when restarting.
 
 \par
 The \f$c(t)\f$ reweighting factor can be calculated on the fly using the equations
@@ -401,11 +415,35 @@ private:
   vector<double> sigma0min_;
   vector<double> sigma0max_;
   vector<Gaussian> hills_;
+/// Per-CV contiguous copies of the centers and inverse sigmas of the
+/// stored hills, plus their heights, used by the batched evaluation kernel
+  vector<vector<double> > hillCenters_;
+  vector<vector<double> > hillInvSigmas_;
+  vector<double> hillHeights_;
+/// Set to false when a hill that the batched kernel cannot handle
+/// (i.e. a multivariate one) is stored
+  bool canBatchHills_;
+/// Use a fast approximate exponential in the batched kernel
+  bool doFastExp_;
   OFile hillsOfile_;
+/// Store the hills in a fixed-record binary file instead of the text format
+  bool binary_hills_;
+/// Handle of the binary hills file; NULL when the text format is in use
+  FILE* hillsBinaryFile_;
   OFile gridfile_;
   std::unique_ptr<GridBase> BiasGrid_;
+/// With GRID_DOUBLEBUFFER this points to the decorator owned by BiasGrid_,
+/// whose buffers are swapped at the points of the update where the bias
+/// readers expect to see the newly deposited hills; NULL otherwise
+  DoubleBufferedGrid* dbgrid_;
   bool storeOldGrids_;
   int wgridstride_;
+/// Number of hills of each walker file already incorporated in BiasGrid_.
+/// It is written to the grid file as a watermark, so that a restart from
+/// the grid only needs to replay the tail of the hills files
+  std::vector<unsigned long> grid_nhills_;
+/// Set when the grid read with GRID_RFILE carries the watermark
+  bool grid_watermark_found_;
   bool grid_;
   double height0_;
   double biasf_;
@@ -432,9 +470,21 @@ private:
   string mw_dir_;
   int mw_id_;
   int mw_rstride_;
+/// Exchange new hills among the file-based walkers over the replica
+/// intercommunicator instead of re-reading the hills files
+  bool mw_share_hills_;
+/// Hills deposited since the last walker synchronization, kept so that
+/// they can be sent to the other walkers
+  vector<Gaussian> mw_new_hills_;
   bool walkers_mpi;
   unsigned mpi_nw_;
   unsigned mpi_mw_;
+/// communicators used for the two-level hill exchange: walkers on the
+/// same node talk through the node-local communicator (shared memory),
+/// only the node roots talk across the network
+  bool walker_comms_setup_;
+  Communicator walkers_node_comm_;
+  Communicator walkers_inter_comm_;
   bool flying;
   bool acceleration;
   double acc;
@@ -454,28 +504,61 @@ private:
   double reweight_factor_;
   unsigned rct_ustride_;
   double work_;
+/// Cache of the bias at the CV point of the present step. It is filled by
+/// calculate() and kept up to date by addGaussian(), so that the
+/// well-tempered height and the work are obtained without rescanning all
+/// the hills in runs without a grid
+  std::vector<double> bias_cache_cv_;
+  double bias_cache_value_;
+  bool bias_cache_valid_;
   long int last_step_warn_grid;
 
   static void   registerTemperingKeywords(const std::string &name_stem, const std::string &name, Keywords &keys);
   void   readTemperingSpecs(TemperingSpecs &t_specs);
   void   logTemperingSpecs(const TemperingSpecs &t_specs);
-  void   readGaussians(IFile*);
+/// Read hills from a text hills file, skipping the first nskip ones
+/// (e.g. because they are already part of a grid read on restart).
+/// Returns the total number of hills scanned, including the skipped ones
+  unsigned long readGaussians(IFile*,unsigned long nskip=0);
   void   writeGaussian(const Gaussian&,OFile&);
+/// Check whether a hills file was written with BINARY_HILLS
+  bool   hillsFileIsBinary(const std::string&);
+/// Bulk-load the hills of a binary hills file into the bias, seeking past
+/// the first nskip records. Returns the total number of records of the file
+  unsigned long readBinaryGaussians(const std::string&,unsigned long nskip=0);
+/// Write the header of a binary hills file
+  void   writeBinaryHillsHeader(FILE*);
+/// Append one fixed-size record to the binary hills file
+  void   writeBinaryGaussian(const Gaussian&);
   void   addGaussian(const Gaussian&);
   double getHeight(const vector<double>&);
   void   temperHeight(double &height, const TemperingSpecs &t_specs, const double tempering_bias);
   double getBiasAndDerivatives(const vector<double>&,double* der=NULL);
+/// Return the bias at the CV point of the present step, reusing the value
+/// cached by calculate() when it is still valid
+  double getBiasAtCurrentPoint(const vector<double>&);
   double evaluateGaussian(const vector<double>&, const Gaussian&,double* der=NULL);
+/// Evaluate all the batched hills at once, looping over blocks of hills
+/// stored in contiguous arrays so that the inner loops vectorize
+  double evaluateGaussianBatch(const vector<double>& cv, double* der, unsigned rank, unsigned stride);
+/// Append a hill to the contiguous arrays used by the batched kernel
+  void appendHillToBatch(const Gaussian&);
   double getGaussianNormalization( const Gaussian& );
   vector<unsigned> getGaussianSupport(const Gaussian&);
   bool   scanOneHill(IFile *ifile,  vector<Value> &v, vector<double> &center, vector<double>  &sigma, double &height, bool &multivariate);
   void   computeReweightingFactor();
   double getTransitionBarrierBias();
   void updateFrequencyAdaptiveStride();
+/// Split the walkers into node-local and cross-node communicators
+  void setupWalkerComms();
+/// Exchange the hills deposited since the last synchronization with the
+/// other file-based walkers over the replica intercommunicator
+  void shareNewHills();
   string fmt;
 
 public:
   explicit MetaD(const ActionOptions&);
+  ~MetaD();
   void calculate() override;
   void update() override;
   static void registerKeywords(Keywords& keys);
@@ -500,6 +583,9 @@ void MetaD::registerKeywords(Keywords& keys) {
   keys.add("compulsory","FILE","HILLS","a file in which the list of added hills is stored");
   keys.add("optional","HEIGHT","the heights of the Gaussian hills. Compulsory unless TAU and either BIASFACTOR or DAMPFACTOR are given");
   keys.add("optional","FMT","specify format for HILLS files (useful for decrease the number of digits in regtests)");
+  keys.addFlag("BINARY_HILLS",false,"store the hills in a fixed-record binary version of the HILLS file. Restarting then "
+               "requires a single bulk read instead of a field-by-field parse of the text format, which can be much faster "
+               "for long runs. The file can be converted to and from the text format with the \\ref hills_convert command line tool");
   keys.add("optional","BIASFACTOR","use well tempered metadynamics and use this bias factor.  Please note you must also specify temp");
   keys.add("optional","RECT","list of bias factors for all the replicas");
   keys.add("optional","DAMPFACTOR","damp hills with exp(-max(V)/(\\f$k_B\\f$T*DAMPFACTOR)");
@@ -518,7 +604,17 @@ void MetaD::registerKeywords(Keywords& keys) {
   keys.add("optional","RCT_USTRIDE","the update stride for calculating the \\f$c(t)\\f$ reweighting factor."
            "The default 1, so \\f$c(t)\\f$ is updated every time the bias is updated.");
   keys.addFlag("GRID_SPARSE",false,"use a sparse grid to store hills");
+  keys.addFlag("GRID_TILED",false,"use a tiled grid to store hills: memory is allocated in fixed-size tiles only for the regions of CV space that are actually visited, with point access almost as fast as for a dense grid");
+  keys.addFlag("GRID_MORTON",false,"store the grid in Morton (Z-curve) order, which keeps the corners of each spline cell close together in memory and speeds up the bias and force lookups on large grids in two or three dimensions. Every dimension is padded to a power of two, so some extra memory may be used");
+  keys.add("compulsory","GRID_REFINE_FACTOR","0","use a two-level refinement grid to store the hills: a coarse grid with this many times the grid spacing covers the whole domain and blocks at the full resolution are allocated only where hills are actually deposited (0 means a standard grid). With GRID_RFILE the grid that is read is coarsened, keeping the full resolution only where interpolating the coarse grid would introduce an error larger than GRID_REFINE_THRESHOLD");
+  keys.add("compulsory","GRID_REFINE_THRESHOLD","0.0","maximum interpolation error (in energy units) tolerated where the grid read with GRID_RFILE is coarsened");
   keys.addFlag("GRID_NOSPLINE",false,"don't use spline interpolation with grids");
+  keys.addFlag("GRID_SPLINE_CACHE",false,"cache the spline coefficients of each visited grid cell, so that the bias and force "
+               "lookup done at every step becomes a plain polynomial evaluation. The cache is invalidated whenever a hill is "
+               "added and rebuilt lazily, at the cost of some extra memory per visited cell");
+  keys.addFlag("GRID_DOUBLEBUFFER",false,"keep two copies of the grid: the bias and forces are read from a stable snapshot "
+               "while hills are deposited on the other copy, and the two are swapped at the end of each update. This doubles "
+               "the grid memory and allows the bias lookup to proceed concurrently with the deposition");
   keys.add("optional","GRID_WSTRIDE","write the grid to a file every N steps");
   keys.add("optional","GRID_WFILE","the file on which to write the grid");
   keys.add("optional","GRID_RFILE","a grid file from which the bias should be read at the initial step of the simulation");
@@ -528,9 +624,14 @@ void MetaD::registerKeywords(Keywords& keys) {
   keys.add("optional","WALKERS_N", "number of walkers");
   keys.add("optional","WALKERS_DIR", "shared directory with the hills files from all the walkers");
   keys.add("optional","WALKERS_RSTRIDE","stride for reading hills files");
+  keys.addFlag("WALKERS_SHARE_HILLS",false,"with the filesystem version of multiple walkers, exchange the new hills directly "
+               "in memory over MPI instead of re-reading the other walkers' hills files. All the walkers must be replicas of "
+               "the same multi-replica run, with WALKERS_ID equal to the replica index. The hills files are still written, so "
+               "the run remains restartable");
   keys.add("optional","INTERVAL","one dimensional lower and upper limits, outside the limits the system will not feel the biasing force.");
   keys.add("optional","SIGMA_MAX","the upper bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
   keys.add("optional","SIGMA_MIN","the lower bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
+  keys.addFlag("FAST_EXP",false,"use a fast approximation of the exponential when evaluating non-grid hills; the relative error is below 1e-9");
   keys.addFlag("WALKERS_MPI",false,"Switch on MPI version of multiple walkers - not compatible with WALKERS_* options other than WALKERS_DIR");
   keys.addFlag("FLYING_GAUSSIAN",false,"Switch on flying Gaussian method, must be used with WALKERS_MPI");
   keys.addFlag("ACCELERATION",false,"Set to TRUE if you want to compute the metadynamics acceleration factor.");
@@ -555,10 +656,37 @@ void MetaD::registerTemperingKeywords(const std::string &name_stem, const std::s
   keys.add("optional", name_stem + "ALPHA", "use " + name + " metadynamics with this hill size decay exponent parameter.  Please note you must also specify " + name_stem + "BIASFACTOR");
 }
 
+namespace {
+
+/// Scan the leading header of a text grid file for the nhills_<i> watermark
+/// written together with the grid (see GRID_WFILE). Returns false when the
+/// file carries no watermark, e.g. because it was written by an older version
+bool readGridHillCounts(const std::string& path, std::vector<unsigned long>& counts) {
+  FILE* fp=std::fopen(path.c_str(),"r");
+  if(!fp) return false;
+  bool found=false;
+  char line[1024];
+  while(std::fgets(line,sizeof(line),fp)) {
+    // the watermark sits among the #! SET lines of the leading header
+    if(line[0]!='#') break;
+    unsigned i; unsigned long n;
+    if(std::sscanf(line,"#! SET nhills_%u %lu",&i,&n)==2 && i<counts.size()) { counts[i]=n; found=true; }
+  }
+  std::fclose(fp);
+  return found;
+}
+
+}
+
 MetaD::MetaD(const ActionOptions& ao):
   PLUMED_BIAS_INIT(ao),
+// Batched hills and binary hills file
+  canBatchHills_(true),
+  doFastExp_(false),
+  binary_hills_(false), hillsBinaryFile_(NULL),
 // Grid stuff initialization
-  wgridstride_(0), grid_(false),
+  dbgrid_(NULL),
+  wgridstride_(0), grid_watermark_found_(false), grid_(false),
 // Metadynamics basic parameters
   height0_(std::numeric_limits<double>::max()), biasf_(-1.0), dampfactor_(0.0),
   tt_specs_(false, "TT", "Transition Tempered", -1.0, 0.0, 1.0),
@@ -573,8 +701,8 @@ MetaD::MetaD(const ActionOptions& ao):
 // Other stuff
   adaptive_(FlexibleBin::none),
 // Multiple walkers initialization
-  mw_n_(1), mw_dir_(""), mw_id_(0), mw_rstride_(1),
-  walkers_mpi(false), mpi_nw_(0), mpi_mw_(0),
+  mw_n_(1), mw_dir_(""), mw_id_(0), mw_rstride_(1), mw_share_hills_(false),
+  walkers_mpi(false), mpi_nw_(0), mpi_mw_(0), walker_comms_setup_(false),
 // Flying Gaussian
   flying(false),
   acceleration(false), acc(0.0), acc_restart_mean_(0.0),
@@ -587,6 +715,8 @@ MetaD::MetaD(const ActionOptions& ao):
   reweight_factor_(0.0),
   rct_ustride_(1),
   work_(0),
+  bias_cache_value_(0.0),
+  bias_cache_valid_(false),
   last_step_warn_grid(0)
 {
   // parse the flexible hills
@@ -649,6 +779,7 @@ MetaD::MetaD(const ActionOptions& ao):
   current_stride = stride_;
   string hillsfname="HILLS";
   parse("FILE",hillsfname);
+  parseFlag("BINARY_HILLS",binary_hills_);
 
   // Manually set to calculate special bias quantities
   // throughout the course of simulation. (These are chosen due to
@@ -765,9 +896,27 @@ MetaD::MetaD(const ActionOptions& ao):
   }
   bool sparsegrid=false;
   parseFlag("GRID_SPARSE",sparsegrid);
+  bool tiledgrid=false;
+  parseFlag("GRID_TILED",tiledgrid);
+  if(sparsegrid&&tiledgrid) error("GRID_SPARSE and GRID_TILED cannot be used at the same time");
+  bool mortongrid=false;
+  parseFlag("GRID_MORTON",mortongrid);
+  if(mortongrid&&(sparsegrid||tiledgrid)) error("GRID_MORTON cannot be combined with GRID_SPARSE or GRID_TILED");
+  unsigned refinedgrid=0;
+  parse("GRID_REFINE_FACTOR",refinedgrid);
+  double refinethreshold=0.0;
+  parse("GRID_REFINE_THRESHOLD",refinethreshold);
+  if(refinedgrid==1) error("GRID_REFINE_FACTOR should be at least 2");
+  if(refinedgrid>1&&(sparsegrid||tiledgrid||mortongrid)) error("GRID_REFINE_FACTOR cannot be combined with GRID_SPARSE, GRID_TILED or GRID_MORTON");
   bool nospline=false;
   parseFlag("GRID_NOSPLINE",nospline);
   bool spline=!nospline;
+  bool splinecache=false;
+  parseFlag("GRID_SPLINE_CACHE",splinecache);
+  if(splinecache&&nospline) error("GRID_SPLINE_CACHE requires spline interpolation");
+  bool doublebuffer=false;
+  parseFlag("GRID_DOUBLEBUFFER",doublebuffer);
+  if(doublebuffer&&(sparsegrid||tiledgrid||refinedgrid>1)) error("GRID_DOUBLEBUFFER keeps a dense copy of the grid, which would defeat the lazy allocation of GRID_SPARSE, GRID_TILED and GRID_REFINE_FACTOR");
   if(gbin.size()>0) {grid_=true;}
   parse("GRID_WSTRIDE",wgridstride_);
   string gridfilename_;
@@ -802,9 +951,13 @@ MetaD::MetaD(const ActionOptions& ao):
   if(mw_n_<=mw_id_) error("walker ID should be a numerical value less than the total number of walkers");
   parse("WALKERS_DIR",mw_dir_);
   parse("WALKERS_RSTRIDE",mw_rstride_);
+  parseFlag("WALKERS_SHARE_HILLS",mw_share_hills_);
+  if(mw_share_hills_ && mw_n_<=1) error("WALKERS_SHARE_HILLS requires the filesystem version of multiple walkers");
+  if(binary_hills_ && mw_n_>1) error("BINARY_HILLS cannot be used with file-based multiple walkers");
 
   // MPI version
   parseFlag("WALKERS_MPI",walkers_mpi);
+  parseFlag("FAST_EXP",doFastExp_);
 
   // Flying Gaussian
   parseFlag("FLYING_GAUSSIAN", flying);
@@ -863,6 +1016,7 @@ MetaD::MetaD(const ActionOptions& ao):
   log.printf("  Gaussian height %f\n",height0_);
   log.printf("  Gaussian deposition pace %d\n",stride_);
   log.printf("  Gaussian file %s\n",hillsfname.c_str());
+  if(binary_hills_) log.printf("  Gaussian file uses the fixed-record binary format\n");
   if(welltemp_) {
     log.printf("  Well-Tempered Bias Factor %f\n",biasf_);
     log.printf("  Hills relaxation time (tau) %f\n",tau);
@@ -925,6 +1079,7 @@ MetaD::MetaD(const ActionOptions& ao):
   }
 
   if(doInt_) log.printf("  Upper and Lower limits boundaries for the bias are activated at %f - %f\n", lowI_, uppI_);
+  if(doFastExp_) log.printf("  Using a fast approximate exponential in the evaluation of non-grid hills\n");
   if(grid_) {
     log.printf("  Grid min");
     for(unsigned i=0; i<gmin.size(); ++i) log.printf(" %s",gmin[i].c_str() );
@@ -937,6 +1092,8 @@ MetaD::MetaD(const ActionOptions& ao):
     log.printf("\n");
     if(spline) {log.printf("  Grid uses spline interpolation\n");}
     if(sparsegrid) {log.printf("  Grid uses sparse grid\n");}
+    if(tiledgrid) {log.printf("  Grid uses tiled storage, allocated on first visit\n");}
+    if(splinecache) {log.printf("  Grid lookups use cached spline coefficients\n");}
     if(wgridstride_>0) {log.printf("  Grid is written on file %s with stride %d\n",gridfilename_.c_str(),wgridstride_);}
   }
 
@@ -946,6 +1103,16 @@ MetaD::MetaD(const ActionOptions& ao):
     log.printf("  walker id %d\n",mw_id_);
     log.printf("  reading stride %d\n",mw_rstride_);
     if(mw_dir_!="")log.printf("  directory with hills files %s\n",mw_dir_.c_str());
+    if(mw_share_hills_) {
+      // new hills travel over the replica intercommunicator, so every walker
+      // must be a replica and the walker id must match the replica index
+      int nrepl=0, irepl=0;
+      if(comm.Get_rank()==0) { nrepl=multi_sim_comm.Get_size(); irepl=multi_sim_comm.Get_rank(); }
+      comm.Bcast(nrepl,0); comm.Bcast(irepl,0);
+      if(nrepl!=mw_n_) error("with WALKERS_SHARE_HILLS the number of replicas must be equal to WALKERS_N");
+      if(irepl!=mw_id_) error("with WALKERS_SHARE_HILLS WALKERS_ID must be equal to the replica index");
+      log.printf("  new hills are exchanged in memory over MPI, hills files are only read when restarting\n");
+    }
   } else {
     if(walkers_mpi) {
       log.printf("  Multiple walkers active using MPI communnication\n");
@@ -1090,8 +1257,11 @@ MetaD::MetaD(const ActionOptions& ao):
       }
     }
     std::string funcl=getLabel() + ".bias";
-    if(!sparsegrid) {BiasGrid_.reset(new Grid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
-    else {BiasGrid_.reset(new SparseGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    if(sparsegrid) {BiasGrid_.reset(new SparseGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    else if(tiledgrid) {BiasGrid_.reset(new TiledGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    else if(mortongrid) {BiasGrid_.reset(new MortonGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    else if(refinedgrid>1) {BiasGrid_.reset(new RefinedGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true,refinedgrid));}
+    else {BiasGrid_.reset(new Grid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
     std::vector<std::string> actualmin=BiasGrid_->getMin();
     std::vector<std::string> actualmax=BiasGrid_->getMax();
     for(unsigned i=0; i<getNumberOfArguments(); i++) {
@@ -1103,6 +1273,7 @@ MetaD::MetaD(const ActionOptions& ao):
   }
 
   // restart from external grid
+  grid_nhills_.assign(mw_n_,0);
   bool restartedFromGrid=false;
   if(gridreadfilename_.length()>0) {
     // read the grid in input, find the keys
@@ -1113,7 +1284,14 @@ MetaD::MetaD(const ActionOptions& ao):
     } else {
       error("The GRID file you want to read: " + gridreadfilename_ + ", cannot be found!");
     }
+    // the grid file may carry a watermark with the number of hills of each
+    // walker it already incorporates: pick it up, so that only the tail of
+    // the hills files is replayed below, and let the grid parser ignore
+    // the extra header field
+    grid_watermark_found_=readGridHillCounts(gridfile.getPath(),grid_nhills_);
+    gridfile.allowIgnoredFields();
     std::string funcl=getLabel() + ".bias";
+    if(tiledgrid) error("GRID_TILED cannot be combined with GRID_RFILE");
     BiasGrid_=GridBase::create(funcl, getArguments(), gridfile, gmin, gmax, gbin, sparsegrid, spline, true);
     if(BiasGrid_->getDimension()!=getNumberOfArguments()) error("mismatch between dimensionality of input grid and number of arguments");
     for(unsigned i=0; i<getNumberOfArguments(); ++i) {
@@ -1124,7 +1302,14 @@ MetaD::MetaD(const ActionOptions& ao):
       double mesh=(b-a)/((double)gbin[i]);
       if(mesh>0.5*sigma0_[i]) log<<"  WARNING: Using a METAD with a Grid Spacing larger than half of the Gaussians width can produce artifacts\n";
     }
+    if(refinedgrid>1) {
+      std::unique_ptr<RefinedGrid> rgrid(new RefinedGrid(funcl,*BiasGrid_,refinedgrid,refinethreshold));
+      log.printf("  Input grid coarsened by a factor %u, tolerating interpolation errors up to %f\n",refinedgrid,refinethreshold);
+      log.printf("  storing %zu of %zu grid points\n",static_cast<size_t>(rgrid->getAllocatedSize()),static_cast<size_t>(rgrid->getSize()));
+      BiasGrid_=std::move(rgrid);
+    }
     log.printf("  Restarting from %s:",gridreadfilename_.c_str());
+    if(grid_watermark_found_) log.printf("  the grid carries a hill-count watermark: only the tail of the hills files will be replayed\n");
     if(getRestart()) restartedFromGrid=true;
   }
 
@@ -1141,8 +1326,11 @@ MetaD::MetaD(const ActionOptions& ao):
       if(mesh>0.5*sigma0_[i]) log<<"  WARNING: Using a METAD with a Grid Spacing larger than half of the Gaussians width can produce artifacts\n";
     }
     std::string funcl=getLabel() + ".bias";
-    if(!sparsegrid) {BiasGrid_.reset(new Grid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
-    else {BiasGrid_.reset(new SparseGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    if(sparsegrid) {BiasGrid_.reset(new SparseGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    else if(tiledgrid) {BiasGrid_.reset(new TiledGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    else if(mortongrid) {BiasGrid_.reset(new MortonGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
+    else if(refinedgrid>1) {BiasGrid_.reset(new RefinedGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true,refinedgrid));}
+    else {BiasGrid_.reset(new Grid(funcl,getArguments(),gmin,gmax,gbin,spline,true));}
     std::vector<std::string> actualmin=BiasGrid_->getMin();
     std::vector<std::string> actualmax=BiasGrid_->getMax();
     for(unsigned i=0; i<getNumberOfArguments(); i++) {
@@ -1151,6 +1339,20 @@ MetaD::MetaD(const ActionOptions& ao):
     }
   }
 
+  if(doublebuffer) {
+    if(!grid_) error("GRID_DOUBLEBUFFER requires a grid");
+    std::string funcl=getLabel() + ".bias";
+    std::unique_ptr<DoubleBufferedGrid> dbgrid(new DoubleBufferedGrid(funcl,std::move(BiasGrid_)));
+    dbgrid_=dbgrid.get();
+    BiasGrid_=std::move(dbgrid);
+    log.printf("  Grid double buffered: the bias is read from a stable snapshot while hills are deposited\n");
+  }
+
+  if(splinecache) {
+    if(!grid_) error("GRID_SPLINE_CACHE requires a grid");
+    BiasGrid_->enableSplineCoefficientCache();
+  }
+
   // creating vector of ifile* for hills reading
   // open all files at the beginning and read Gaussians if restarting
   for(int i=0; i<mw_n_; ++i) {
@@ -1178,14 +1380,26 @@ MetaD::MetaD(const ActionOptions& ao):
     ifilesnames.push_back(fname);
     ifile->link(*this);
     if(ifile->FileExist(fname)) {
-      ifile->open(fname);
+      bool binary=hillsFileIsBinary(fname);
+      if(getRestart()&&(!restartedFromGrid||grid_watermark_found_)&&binary!=binary_hills_) {
+        if(binary) error("restart file " + fname + " is in binary format: either add BINARY_HILLS or convert the file with the hills_convert tool");
+        else error("restart file " + fname + " is in text format: either remove BINARY_HILLS or convert the file with the hills_convert tool");
+      }
+      if(!binary) ifile->open(fname);
       if(getRestart()&&!restartedFromGrid) {
         log.printf("  Restarting from %s:",ifilesnames[i].c_str());
-        readGaussians(ifiles[i].get());
+        if(binary) grid_nhills_[i]=readBinaryGaussians(fname);
+        else grid_nhills_[i]=readGaussians(ifiles[i].get());
+      } else if(getRestart()&&restartedFromGrid&&grid_watermark_found_) {
+        log.printf("  Replaying the tail of %s beyond the %lu hills already in the grid:",ifilesnames[i].c_str(),grid_nhills_[i]);
+        if(binary) grid_nhills_[i]=readBinaryGaussians(fname,grid_nhills_[i]);
+        else grid_nhills_[i]=readGaussians(ifiles[i].get(),grid_nhills_[i]);
+      }
+      if(!binary) {
+        ifiles[i]->reset(false);
+        // close only the walker own hills file for later writing
+        if(i==mw_id_) ifiles[i]->close();
       }
-      ifiles[i]->reset(false);
-      // close only the walker own hills file for later writing
-      if(i==mw_id_) ifiles[i]->close();
     } else {
       // in case a file does not exist and we are restarting, complain that the file was not found
       if(getRestart()) log<<"  WARNING: restart file "<<fname<<" not found\n";
@@ -1211,6 +1425,9 @@ MetaD::MetaD(const ActionOptions& ao):
     }
   }
 
+  // publish the hills replayed on restart before anything reads the grid
+  if(dbgrid_) dbgrid_->swapBuffers();
+
   // Calculate the Tiwary-Parrinello reweighting factor if we are restarting from previous hills
   if(getRestart() && calc_rct_) computeReweightingFactor();
   // Calculate all special bias quantities desired if restarting with nonzero bias.
@@ -1238,26 +1455,49 @@ MetaD::MetaD(const ActionOptions& ao):
   }
 
   // open hills file for writing
-  hillsOfile_.link(*this);
-  if(walkers_mpi) {
-    int r=0;
-    if(comm.Get_rank()==0) r=multi_sim_comm.Get_rank();
-    comm.Bcast(r,0);
-    if(r>0) ifilesnames[mw_id_]="/dev/null";
-    hillsOfile_.enforceSuffix("");
-  }
-  if(mw_n_>1) hillsOfile_.enforceSuffix("");
-  hillsOfile_.open(ifilesnames[mw_id_]);
-  if(fmt.length()>0) hillsOfile_.fmtField(fmt);
-  hillsOfile_.addConstantField("multivariate");
-  hillsOfile_.addConstantField("kerneltype");
-  if(doInt_) {
-    hillsOfile_.addConstantField("lower_int").printField("lower_int",lowI_);
-    hillsOfile_.addConstantField("upper_int").printField("upper_int",uppI_);
+  if(binary_hills_) {
+    if(walkers_mpi) {
+      int r=0;
+      if(comm.Get_rank()==0) r=multi_sim_comm.Get_rank();
+      comm.Bcast(r,0);
+      if(r>0) ifilesnames[mw_id_]="/dev/null";
+    }
+    // as for an OFile linked to the action, only the first rank writes
+    if(comm.Get_rank()==0) {
+      std::string fname=ifilesnames[mw_id_];
+      // honor the multi-replica field suffix, as OFile::open does;
+      // with WALKERS_MPI the text format enforces an empty suffix
+      if(!walkers_mpi) fname=FileBase::appendSuffix(fname,plumed.getSuffix());
+      // mimic the backup-on-overwrite behavior of OFile
+      if(!getRestart()) hillsOfile_.backupFile("bck",fname);
+      hillsBinaryFile_=std::fopen(fname.c_str(),getRestart()?"ab":"wb");
+      if(!hillsBinaryFile_) error("cannot open file " + fname);
+      std::fseek(hillsBinaryFile_,0,SEEK_END);
+      // a restart file carries its header already, a fresh file needs one
+      if(std::ftell(hillsBinaryFile_)==0) writeBinaryHillsHeader(hillsBinaryFile_);
+    }
+  } else {
+    hillsOfile_.link(*this);
+    if(walkers_mpi) {
+      int r=0;
+      if(comm.Get_rank()==0) r=multi_sim_comm.Get_rank();
+      comm.Bcast(r,0);
+      if(r>0) ifilesnames[mw_id_]="/dev/null";
+      hillsOfile_.enforceSuffix("");
+    }
+    if(mw_n_>1) hillsOfile_.enforceSuffix("");
+    hillsOfile_.open(ifilesnames[mw_id_]);
+    if(fmt.length()>0) hillsOfile_.fmtField(fmt);
+    hillsOfile_.addConstantField("multivariate");
+    hillsOfile_.addConstantField("kerneltype");
+    if(doInt_) {
+      hillsOfile_.addConstantField("lower_int").printField("lower_int",lowI_);
+      hillsOfile_.addConstantField("upper_int").printField("upper_int",uppI_);
+    }
+    hillsOfile_.setHeavyFlush();
+    // output periodicities of variables
+    for(unsigned i=0; i<getNumberOfArguments(); ++i) hillsOfile_.setupPrintValue( getPntrToArgument(i) );
   }
-  hillsOfile_.setHeavyFlush();
-  // output periodicities of variables
-  for(unsigned i=0; i<getNumberOfArguments(); ++i) hillsOfile_.setupPrintValue( getPntrToArgument(i) );
 
   bool concurrent=false;
   const ActionSet&actionSet(plumed.getActionSet());
@@ -1332,12 +1572,115 @@ void MetaD::logTemperingSpecs(const TemperingSpecs &t_specs) {
   if (t_specs.alpha != 1.0) log.printf("  %s decay shape parameter alpha %f\n", t_specs.name.c_str(), t_specs.alpha);
 }
 
-void MetaD::readGaussians(IFile *ifile)
+namespace {
+
+/// A binary hills file starts with these eight bytes, followed by a header
+/// carrying the names and the periodicity of the variables and by one
+/// fixed-size record per hill. The numbers in the records are the same
+/// that would be printed in the text format, so that converting between
+/// the two formats (see \\ref hills_convert) is a pure reformatting.
+const char binary_hills_magic[8]={'P','L','M','D','H','I','L','B'};
+const int32_t binary_hills_version=1;
+
+void writeBinaryInt(FILE* fp, int32_t i) {
+  std::fwrite(&i,sizeof(i),1,fp);
+}
+
+bool readBinaryInt(FILE* fp, int32_t & i) {
+  return std::fread(&i,sizeof(i),1,fp)==1;
+}
+
+void writeBinaryString(FILE* fp, const std::string & s) {
+  writeBinaryInt(fp,s.length());
+  std::fwrite(s.c_str(),1,s.length(),fp);
+}
+
+bool readBinaryString(FILE* fp, std::string & s) {
+  int32_t len;
+  if(!readBinaryInt(fp,len) || len<0) return false;
+  std::vector<char> buf(len);
+  if(len>0 && std::fread(&buf[0],1,len,fp)!=static_cast<size_t>(len)) return false;
+  s.assign(buf.begin(),buf.end());
+  return true;
+}
+/// Convert the internal sigma vector of a multivariate hill (the upper
+/// triangle of the inverse covariance matrix) to the "sigma like" band-ordered
+/// Cholesky factor stored in the hills files
+void sigmaToCholeskyBand(unsigned ncv, const vector<double> & sigma, vector<double> & band) {
+  Matrix<double> mymatrix(ncv,ncv);
+  unsigned k=0;
+  for(unsigned i=0; i<ncv; i++) {
+    for(unsigned j=i; j<ncv; j++) {
+      // recompose the full inverse matrix
+      mymatrix(i,j)=mymatrix(j,i)=sigma[k];
+      k++;
+    }
+  }
+  // invert it
+  Matrix<double> invmatrix(ncv,ncv);
+  Invert(mymatrix,invmatrix);
+  // enforce symmetry
+  for(unsigned i=0; i<ncv; i++) {
+    for(unsigned j=i; j<ncv; j++) {
+      invmatrix(i,j)=invmatrix(j,i);
+    }
+  }
+  // do cholesky so to have a "sigma like" number
+  Matrix<double> lower(ncv,ncv);
+  cholesky(invmatrix,lower);
+  // store it in band form
+  band.resize(ncv*(ncv+1)/2);
+  k=0;
+  for(unsigned i=0; i<ncv; i++) {
+    for(unsigned j=0; j<ncv-i; j++) {
+      band[k]=lower(j+i,j);
+      k++;
+    }
+  }
+}
+
+/// Inverse transformation, used when hills files are read back
+void choleskyBandToSigma(unsigned ncv, const vector<double> & band, vector<double> & sigma) {
+  Matrix<double> upper(ncv,ncv);
+  Matrix<double> lower(ncv,ncv);
+  unsigned k=0;
+  for(unsigned i=0; i<ncv; i++) {
+    for(unsigned j=0; j<ncv-i; j++) {
+      lower(j+i,j)=band[k];
+      upper(j,j+i)=band[k];
+      k++;
+    }
+  }
+  Matrix<double> mymult(ncv,ncv);
+  Matrix<double> invmatrix(ncv,ncv);
+  mult(lower,upper,mymult);
+  // now invert and get the sigmas
+  Invert(mymult,invmatrix);
+  // put the sigmas in the usual order: upper diagonal (this time in normal form and not in band form)
+  sigma.resize(ncv*(ncv+1)/2);
+  k=0;
+  for(unsigned i=0; i<ncv; i++) {
+    for(unsigned j=i; j<ncv; j++) {
+      sigma[k]=invmatrix(i,j);
+      k++;
+    }
+  }
+}
+
+}
+
+MetaD::~MetaD()
+{
+  if(hillsBinaryFile_) std::fclose(hillsBinaryFile_);
+}
+
+unsigned long MetaD::readGaussians(IFile *ifile,unsigned long nskip)
 {
   unsigned ncv=getNumberOfArguments();
   vector<double> center(ncv);
   vector<double> sigma(ncv);
   double height;
+  unsigned long nread=0;
   int nhills=0;
   bool multivariate=false;
 
@@ -1345,17 +1688,22 @@ void MetaD::readGaussians(IFile *ifile)
   for(unsigned j=0; j<getNumberOfArguments(); ++j) tmpvalues.push_back( Value( this, getPntrToArgument(j)->getName(), false ) );
 
   while(scanOneHill(ifile,tmpvalues,center,sigma,height,multivariate)) {
-    ;
+    nread++;
+// hills before the watermark are already part of the grid read on restart
+    if(nread<=nskip) continue;
     nhills++;
 // note that for gamma=1 we store directly -F
     if(welltemp_ && biasf_>1.0) {height*=(biasf_-1.0)/biasf_;}
     addGaussian(Gaussian(center,sigma,height,multivariate));
   }
-  log.printf("      %d Gaussians read\n",nhills);
+  if(nskip>0) log.printf("      %d Gaussians read beyond the %lu already in the grid\n",nhills,nskip);
+  else log.printf("      %d Gaussians read\n",nhills);
+  return nread;
 }
 
 void MetaD::writeGaussian(const Gaussian& hill, OFile&file)
 {
+  if(binary_hills_) { writeBinaryGaussian(hill); return; }
   unsigned ncv=getNumberOfArguments();
   file.printField("time",getTimeStep()*getStep());
   for(unsigned i=0; i<ncv; ++i) {
@@ -1405,41 +1753,170 @@ void MetaD::writeGaussian(const Gaussian& hill, OFile&file)
   file.printField();
 }
 
+bool MetaD::hillsFileIsBinary(const std::string& fname)
+{
+  // honor the multi-replica field suffix, as FileBase::FileExist does
+  FILE* fp=std::fopen(FileBase::appendSuffix(fname,plumed.getSuffix()).c_str(),"rb");
+  if(!fp) fp=std::fopen(fname.c_str(),"rb");
+  if(!fp) return false;
+  char magic[8];
+  bool binary=(std::fread(magic,1,8,fp)==8 && std::memcmp(magic,binary_hills_magic,8)==0);
+  std::fclose(fp);
+  return binary;
+}
+
+void MetaD::writeBinaryHillsHeader(FILE* fp)
+{
+  unsigned ncv=getNumberOfArguments();
+  std::fwrite(binary_hills_magic,1,8,fp);
+  writeBinaryInt(fp,binary_hills_version);
+  writeBinaryInt(fp,ncv);
+  writeBinaryInt(fp,doInt_?1:0);
+  double bounds[2]; bounds[0]=lowI_; bounds[1]=uppI_;
+  std::fwrite(bounds,sizeof(double),2,fp);
+  for(unsigned i=0; i<ncv; ++i) {
+    writeBinaryString(fp,getPntrToArgument(i)->getName());
+    if(getPntrToArgument(i)->isPeriodic()) {
+      writeBinaryInt(fp,1);
+      std::string pmin, pmax; getPntrToArgument(i)->getDomain(pmin,pmax);
+      writeBinaryString(fp,pmin);
+      writeBinaryString(fp,pmax);
+    } else {
+      writeBinaryInt(fp,0);
+      writeBinaryString(fp,"");
+      writeBinaryString(fp,"");
+    }
+  }
+}
+
+void MetaD::writeBinaryGaussian(const Gaussian& hill)
+{
+  // as for an OFile linked to the action, only the first rank writes
+  if(!hillsBinaryFile_) return;
+  unsigned ncv=getNumberOfArguments();
+  unsigned nsig=ncv*(ncv+1)/2;
+// record layout: time, multivariate, center[ncv], sigma[ncv*(ncv+1)/2], height, biasf
+  std::vector<double> record(4+ncv+nsig,0.0);
+  record[0]=getTimeStep()*getStep();
+  record[1]=hill.multivariate?1.0:0.0;
+  for(unsigned i=0; i<ncv; ++i) record[2+i]=hill.center[i];
+  if(hill.multivariate) {
+    std::vector<double> band;
+    sigmaToCholeskyBand(ncv,hill.sigma,band);
+    for(unsigned k=0; k<nsig; ++k) record[2+ncv+k]=band[k];
+  } else {
+    for(unsigned i=0; i<ncv; ++i) record[2+ncv+i]=hill.sigma[i];
+  }
+  double height=hill.height;
+// note that for gamma=1 we store directly -F
+  if(welltemp_ && biasf_>1.0) height*=biasf_/(biasf_-1.0);
+  record[2+ncv+nsig]=height;
+  record[3+ncv+nsig]=biasf_;
+  std::fwrite(&record[0],sizeof(double),record.size(),hillsBinaryFile_);
+// the text file is flushed at every hill as well (heavy flush)
+  std::fflush(hillsBinaryFile_);
+}
+
+unsigned long MetaD::readBinaryGaussians(const std::string& fname,unsigned long nskip)
+{
+  unsigned ncv=getNumberOfArguments();
+  unsigned nsig=ncv*(ncv+1)/2;
+  FILE* fp=std::fopen(FileBase::appendSuffix(fname,plumed.getSuffix()).c_str(),"rb");
+  if(!fp) fp=std::fopen(fname.c_str(),"rb");
+  if(!fp) error("cannot open file " + fname);
+  char magic[8];
+  int32_t version=0, fncv=0, fdoint=0;
+  double bounds[2];
+  bool ok=(std::fread(magic,1,8,fp)==8 && std::memcmp(magic,binary_hills_magic,8)==0);
+  ok=ok && readBinaryInt(fp,version) && readBinaryInt(fp,fncv) && readBinaryInt(fp,fdoint);
+  ok=ok && std::fread(bounds,sizeof(double),2,fp)==2;
+  if(!ok) { std::fclose(fp); error("cannot read the header of binary hills file " + fname); }
+  if(version!=binary_hills_version) { std::fclose(fp); error("unknown version of binary hills file " + fname); }
+  if(fncv!=static_cast<int32_t>(ncv)) { std::fclose(fp); error("mismatch between the number of variables in binary hills file " + fname + " and the number of arguments"); }
+  for(unsigned i=0; i<ncv; ++i) {
+    std::string name, pmin, pmax;
+    int32_t periodic=0;
+    if(!readBinaryString(fp,name) || !readBinaryInt(fp,periodic) || !readBinaryString(fp,pmin) || !readBinaryString(fp,pmax)) {
+      std::fclose(fp); error("cannot read the header of binary hills file " + fname);
+    }
+    if(name!=getPntrToArgument(i)->getName()) {
+      std::fclose(fp); error("in hills file " + fname + " variable " + name + " does not match argument " + getPntrToArgument(i)->getName());
+    }
+    if(periodic && !getPntrToArgument(i)->isPeriodic()) {
+      error("in hills file periodicity for variable " + name + " does not match periodicity in input");
+    } else if(periodic) {
+      std::string rmin, rmax; getPntrToArgument(i)->getDomain( rmin, rmax );
+      if( pmin!=rmin || pmax!=rmax ) {
+        error("in hills file periodicity for variable " + name + " does not match periodicity in input");
+      }
+    }
+  }
+  // bulk-load the fixed-size records and add them to the bias
+  long datastart=std::ftell(fp);
+  std::fseek(fp,0,SEEK_END);
+  long nbytes=std::ftell(fp)-datastart;
+  const unsigned recsize=4+ncv+nsig;
+  if(nbytes<0 || static_cast<unsigned long>(nbytes)%(recsize*sizeof(double))!=0) {
+    std::fclose(fp); error("binary hills file " + fname + " appears to be truncated");
+  }
+  unsigned long nhills=static_cast<unsigned long>(nbytes)/(recsize*sizeof(double));
+// records before the watermark are already part of the grid read on
+// restart: the fixed-size layout allows seeking straight past them
+  if(nskip>nhills) nskip=nhills;
+  std::fseek(fp,datastart+static_cast<long>(nskip*recsize*sizeof(double)),SEEK_SET);
+  std::vector<double> data((nhills-nskip)*recsize);
+  if(nhills>nskip && std::fread(&data[0],sizeof(double),data.size(),fp)!=data.size()) {
+    std::fclose(fp); error("cannot read binary hills file " + fname);
+  }
+  std::fclose(fp);
+  vector<double> center(ncv);
+  vector<double> sigma;
+  vector<double> band(nsig);
+  for(unsigned long n=0; n<nhills-nskip; ++n) {
+    const double* rec=&data[n*recsize];
+    bool multivariate=rec[1]>0.5;
+    for(unsigned i=0; i<ncv; ++i) center[i]=rec[2+i];
+    if(multivariate) {
+      for(unsigned k=0; k<nsig; ++k) band[k]=rec[2+ncv+k];
+      choleskyBandToSigma(ncv,band,sigma);
+    } else {
+      sigma.assign(rec+2+ncv,rec+2+ncv+ncv);
+    }
+    double height=rec[2+ncv+nsig];
+// note that for gamma=1 we store directly -F
+    if(welltemp_ && biasf_>1.0) height*=(biasf_-1.0)/biasf_;
+    addGaussian(Gaussian(center,sigma,height,multivariate));
+  }
+  if(nskip>0) log.printf("      %lu Gaussians read beyond the %lu already in the grid\n",nhills-nskip,nskip);
+  else log.printf("      %lu Gaussians read\n",nhills);
+  return nhills;
+}
+
 void MetaD::addGaussian(const Gaussian& hill)
 {
-  if(!grid_) hills_.push_back(hill);
+  // keep the cached bias at the present point consistent with the new hill
+  if(bias_cache_valid_) bias_cache_value_+=evaluateGaussian(bias_cache_cv_,hill);
+  if(!grid_) { hills_.push_back(hill); appendHillToBatch(hill); }
   else {
     unsigned ncv=getNumberOfArguments();
     vector<unsigned> nneighb=getGaussianSupport(hill);
     vector<Grid::index_t> neighbors=BiasGrid_->getNeighbors(hill.center,nneighb);
-    vector<double> der(ncv);
     vector<double> xx(ncv);
-    if(comm.Get_size()==1) {
-      for(unsigned i=0; i<neighbors.size(); ++i) {
-        Grid::index_t ineigh=neighbors[i];
-        for(unsigned j=0; j<ncv; ++j) der[j]=0.0;
-        BiasGrid_->getPoint(ineigh,xx);
-        double bias=evaluateGaussian(xx,hill,&der[0]);
-        BiasGrid_->addValueAndDerivatives(ineigh,bias,der);
-      }
-    } else {
-      unsigned stride=comm.Get_size();
-      unsigned rank=comm.Get_rank();
-      vector<double> allder(ncv*neighbors.size(),0.0);
-      vector<double> allbias(neighbors.size(),0.0);
-      for(unsigned i=rank; i<neighbors.size(); i+=stride) {
-        Grid::index_t ineigh=neighbors[i];
-        BiasGrid_->getPoint(ineigh,xx);
-        allbias[i]=evaluateGaussian(xx,hill,&allder[ncv*i]);
-      }
+// evaluate the hill over its support into a stencil block and hand it to the
+// grid in one go, so that indices are resolved with linear arithmetic
+    unsigned stride=comm.Get_size();
+    unsigned rank=comm.Get_rank();
+    vector<double> allder(ncv*neighbors.size(),0.0);
+    vector<double> allbias(neighbors.size(),0.0);
+    for(unsigned i=rank; i<neighbors.size(); i+=stride) {
+      BiasGrid_->getPoint(neighbors[i],xx);
+      allbias[i]=evaluateGaussian(xx,hill,&allder[ncv*i]);
+    }
+    if(stride>1) {
       comm.Sum(allbias);
       comm.Sum(allder);
-      for(unsigned i=0; i<neighbors.size(); ++i) {
-        Grid::index_t ineigh=neighbors[i];
-        for(unsigned j=0; j<ncv; ++j) {der[j]=allder[ncv*i+j];}
-        BiasGrid_->addValueAndDerivatives(ineigh,allbias[i],der);
-      }
     }
+    BiasGrid_->addKernel(neighbors,allbias,allder);
   }
 }
 
@@ -1510,11 +1987,24 @@ double MetaD::getBiasAndDerivatives(const vector<double>& cv, double* der)
     }
     unsigned stride=comm.Get_size();
     unsigned rank=comm.Get_rank();
-    for(unsigned i=rank; i<hills_.size(); i+=stride) {
-      bias+=evaluateGaussian(cv,hills_[i],der);
+    if(canBatchHills_) {
+      bias=evaluateGaussianBatch(cv,der,rank,stride);
+    } else {
+      for(unsigned i=rank; i<hills_.size(); i+=stride) {
+        bias+=evaluateGaussian(cv,hills_[i],der);
+      }
+    }
+// combine bias and derivatives in a single allreduce
+    if(der) {
+      std::vector<double> sbuf(getNumberOfArguments()+1);
+      sbuf[0]=bias;
+      for(unsigned i=0; i<getNumberOfArguments(); ++i) sbuf[1+i]=der[i];
+      comm.Sum(sbuf);
+      bias=sbuf[0];
+      for(unsigned i=0; i<getNumberOfArguments(); ++i) der[i]=sbuf[1+i];
+    } else {
+      comm.Sum(bias);
     }
-    comm.Sum(bias);
-    if(der) comm.Sum(der,getNumberOfArguments());
   } else {
     if(der) {
       vector<double> vder(getNumberOfArguments());
@@ -1528,6 +2018,12 @@ double MetaD::getBiasAndDerivatives(const vector<double>& cv, double* der)
   return bias;
 }
 
+double MetaD::getBiasAtCurrentPoint(const vector<double>& cv)
+{
+  if(bias_cache_valid_ && bias_cache_cv_==cv) return bias_cache_value_;
+  return getBiasAndDerivatives(cv);
+}
+
 double MetaD::getGaussianNormalization( const Gaussian& hill )
 {
   double norm=1;
@@ -1626,11 +2122,144 @@ double MetaD::evaluateGaussian(const vector<double>& cv, const Gaussian& hill, d
   return bias;
 }
 
+void MetaD::appendHillToBatch(const Gaussian& hill)
+{
+  if(hill.multivariate) { canBatchHills_=false; return; }
+  if(!canBatchHills_) return;
+  const unsigned ncv=getNumberOfArguments();
+  if(hillCenters_.size()!=ncv) { hillCenters_.resize(ncv); hillInvSigmas_.resize(ncv); }
+  for(unsigned i=0; i<ncv; ++i) {
+    hillCenters_[i].push_back(hill.center[i]);
+    hillInvSigmas_[i].push_back(hill.invsigma[i]);
+  }
+  hillHeights_.push_back(hill.height);
+}
+
+namespace {
+
+/// Inner loops of MetaD::evaluateGaussianBatch, kept as free functions so
+/// that they can be multi-versioned for the vector units of the executing
+/// CPU (see tools/TargetClones.h). OpenMP-outlined bodies cannot be cloned,
+/// hence the extraction
+
+PLUMED_TARGET_CLONES
+void batchHillDeltas( unsigned n, double x, const double* C, const double* S,
+                      unsigned base, unsigned stride, double* dpi, double* dp2 ) {
+  for(unsigned b=0; b<n; b++) {
+    const double d=(x-C[base+b*stride])*S[base+b*stride];
+    dpi[b]=d; dp2[b]+=d*d;
+  }
+}
+
+PLUMED_TARGET_CLONES
+void batchHillDeltasPeriodic( unsigned n, double x, const double* C, const double* S,
+                              unsigned base, unsigned stride, double period, double invperiod,
+                              double* dpi, double* dp2 ) {
+  for(unsigned b=0; b<n; b++) {
+    const double d=Tools::pbc((x-C[base+b*stride])*invperiod)*period*S[base+b*stride];
+    dpi[b]=d; dp2[b]+=d*d;
+  }
+}
+
+PLUMED_TARGET_CLONES
+void batchHillDerivatives( unsigned n, const double* eb, const double* dpi, const double* S,
+                           unsigned base, unsigned stride, double& der ) {
+  for(unsigned b=0; b<n; b++) der-=eb[b]*dpi[b]*S[base+b*stride];
+}
+
+}
+
+double MetaD::evaluateGaussianBatch(const vector<double>& cv, double* der, unsigned rank, unsigned stride)
+{
+  static const unsigned blocksize=128;
+  const unsigned ncv=getNumberOfArguments();
+  const unsigned nhills=hillHeights_.size();
+  double bias=0.0;
+
+  // see evaluateGaussian for the rationale of this replacement
+  const double *pcv=NULL;
+  double tmpcv[1];
+  if(cv.size()>0) pcv=&cv[0];
+  if(doInt_) {
+    plumed_assert(cv.size()==1);
+    tmpcv[0]=cv[0];
+    if(cv[0]<lowI_) tmpcv[0]=lowI_;
+    if(cv[0]>uppI_) tmpcv[0]=uppI_;
+    pcv=&(tmpcv[0]);
+  }
+
+// number of blocks in the MPI-strided share of this rank: each block is
+// evaluated by one OpenMP thread over the contiguous hill arrays
+  const unsigned nblocks=(nhills>rank? (nhills-rank+stride*blocksize-1)/(stride*blocksize) : 0);
+  unsigned nt=OpenMP::getNumThreads();
+  if(2*nt>nblocks) nt=1;
+
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<double> omp_der;
+    if(der && nt>1) omp_der.assign(ncv,0.0);
+// with one thread derivatives go straight into der, preserving the old
+// accumulation order exactly
+    double* derp=(der? (nt>1? omp_der.data() : der) : NULL);
+    std::vector<double> dp(ncv*blocksize);
+    double dp2[blocksize];
+    double eb[blocksize];
+
+// within each thread, hills are visited in the same (MPI-strided) order as
+// in the per-hill loop, a block at a time
+    #pragma omp for reduction(+:bias) nowait
+    for(unsigned ib=0; ib<nblocks; ++ib) {
+      const unsigned base=rank+ib*stride*blocksize;
+      unsigned n=0;
+      while(n<blocksize && base+n*stride<nhills) n++;
+      for(unsigned b=0; b<n; b++) dp2[b]=0.0;
+      for(unsigned i=0; i<ncv; i++) {
+        const double* C=hillCenters_[i].data();
+        const double* S=hillInvSigmas_[i].data();
+        double* dpi=&dp[i*blocksize];
+        const double x=pcv[i];
+        if(!getPntrToArgument(i)->isPeriodic()) {
+          batchHillDeltas( n, x, C, S, base, stride, dpi, dp2 );
+        } else {
+          double min,max; getPntrToArgument(i)->getDomain(min,max);
+          const double period=max-min, invperiod=1.0/period;
+          batchHillDeltasPeriodic( n, x, C, S, base, stride, period, invperiod, dpi, dp2 );
+        }
+      }
+      if(doFastExp_) {
+        for(unsigned b=0; b<n; b++) {
+          const double d2=0.5*dp2[b];
+          eb[b]=(d2<DP2CUTOFF)?hillHeights_[base+b*stride]*FastMath::exp(-d2):0.0;
+        }
+      } else {
+        for(unsigned b=0; b<n; b++) {
+          const double d2=0.5*dp2[b];
+          eb[b]=(d2<DP2CUTOFF)?hillHeights_[base+b*stride]*std::exp(-d2):0.0;
+        }
+      }
+      for(unsigned b=0; b<n; b++) bias+=eb[b];
+      if(derp) {
+        for(unsigned i=0; i<ncv; i++) {
+          batchHillDerivatives( n, eb, &dp[i*blocksize], hillInvSigmas_[i].data(), base, stride, derp[i] );
+        }
+      }
+    }
+    #pragma omp critical
+    if(der && nt>1) for(unsigned i=0; i<ncv; i++) der[i]+=omp_der[i];
+  }
+
+  if(doInt_ && der) {
+    if(cv[0]<lowI_ || cv[0]>uppI_) for(unsigned i=0; i<cv.size(); ++i) der[i]=0;
+  }
+
+  return bias;
+}
+
 double MetaD::getHeight(const vector<double>& cv)
 {
   double height=height0_;
   if(welltemp_) {
-    double vbias = getBiasAndDerivatives(cv);
+    double vbias = getBiasAtCurrentPoint(cv);
     if(biasf_>1.0) {
       height = height0_*exp(-vbias/(kbt_*(biasf_-1.0)));
     } else {
@@ -1676,6 +2305,13 @@ void MetaD::calculate()
     der[i]=0.;
   }
   double ene = getBiasAndDerivatives(cv,der.get());
+// cache the bias at the present point: update() needs it again for the
+// well-tempered height and for the work, and without a grid every
+// evaluation rescans all the hills. addGaussian() keeps the cache up to
+// date when hills are added later during the step
+  bias_cache_cv_=cv;
+  bias_cache_value_=ene;
+  bias_cache_valid_=true;
 // special case for gamma=1.0
   if(biasf_==1.0) {
     ene=0.0;
@@ -1704,6 +2340,78 @@ void MetaD::calculate()
   }
 }
 
+void MetaD::setupWalkerComms() {
+  // group the walkers that run on the same node, so that hills exchanged
+  // among them move through node shared memory and only one aggregated
+  // message per node travels over the network. This is collective over
+  // the walker roots, like the allgathers it replaces
+  multi_sim_comm.SplitByNode(multi_sim_comm.Get_rank(),walkers_node_comm_);
+  int color = (walkers_node_comm_.Get_rank()==0) ? 0 : 1;
+  multi_sim_comm.Split(color,multi_sim_comm.Get_rank(),walkers_inter_comm_);
+  walker_comms_setup_=true;
+}
+
+void MetaD::shareNewHills() {
+  // serialize the hills deposited since the last synchronization; each hill
+  // travels as (height, multivariate flag, number of sigmas, center, sigma).
+  // Unlike the hills files, heights travel unscaled so no well-tempered
+  // correction is needed on arrival
+  const unsigned ncv=getNumberOfArguments();
+  std::vector<double> buffer;
+  for(unsigned i=0; i<mw_new_hills_.size(); ++i) {
+    const Gaussian& hill=mw_new_hills_[i];
+    buffer.push_back(hill.height);
+    buffer.push_back(hill.multivariate?1.0:0.0);
+    buffer.push_back(static_cast<double>(hill.sigma.size()));
+    for(unsigned j=0; j<ncv; ++j) buffer.push_back(hill.center[j]);
+    for(unsigned j=0; j<hill.sigma.size(); ++j) buffer.push_back(hill.sigma[j]);
+  }
+  mw_new_hills_.clear();
+
+  // gather the buffers of all the walkers; their sizes can differ since with
+  // adaptive hills the number of sigmas depends on the walker
+  std::vector<int> counts(mw_n_,0), displs(mw_n_,0);
+  std::vector<double> gathered;
+  if(comm.Get_rank()==0) {
+    int mycount=buffer.size();
+    multi_sim_comm.Allgather(mycount,counts);
+    int total=counts[0];
+    for(int i=1; i<mw_n_; ++i) { displs[i]=displs[i-1]+counts[i-1]; total+=counts[i]; }
+    gathered.resize(total,0.0);
+    double dummy=0.0;
+    double* sendbuf = buffer.empty() ? &dummy : &buffer[0];
+    double* recvbuf = gathered.empty() ? &dummy : &gathered[0];
+    multi_sim_comm.Allgatherv(sendbuf,buffer.size(),recvbuf,&counts[0],&displs[0]);
+  }
+  // share the result with the other members of the group
+  comm.Bcast(counts,0); comm.Bcast(displs,0);
+  if(comm.Get_rank()!=0) {
+    int total=0; for(int i=0; i<mw_n_; ++i) total+=counts[i];
+    gathered.resize(total,0.0);
+  }
+  comm.Bcast(gathered,0);
+
+  // add the hills of the other walkers; our own were already added when
+  // they were deposited
+  for(int i=0; i<mw_n_; ++i) {
+    if(i==mw_id_) continue;
+    int k=displs[i]; const int end=displs[i]+counts[i];
+    while(k<end) {
+      double height=gathered[k];
+      bool multivariate=gathered[k+1]>0.5;
+      unsigned nsigma=static_cast<unsigned>(gathered[k+2]); k+=3;
+      std::vector<double> center(ncv), sigma(nsigma);
+      for(unsigned j=0; j<ncv; ++j) center[j]=gathered[k+j];
+      for(unsigned j=0; j<nsigma; ++j) sigma[j]=gathered[k+ncv+j];
+      k+=ncv+nsigma;
+      addGaussian( Gaussian(center,sigma,height,multivariate) );
+      // shared hills were written to the file of walker i, so they count
+      // towards its watermark entry
+      grid_nhills_[i]++;
+    }
+  }
+}
+
 void MetaD::update() {
   vector<double> cv(getNumberOfArguments());
   vector<double> thissigma;
@@ -1719,7 +2427,7 @@ void MetaD::update() {
 
   for(unsigned i=0; i<cv.size(); ++i) cv[i] = getArgument(i);
 
-  double vbias=getBiasAndDerivatives(cv);
+  double vbias=getBiasAtCurrentPoint(cv);
 
   // if you use adaptive, call the FlexibleBin
   if(adaptive_!=FlexibleBin::none) {
@@ -1739,44 +2447,75 @@ void MetaD::update() {
 
     // In case we use walkers_mpi, it is now necessary to communicate with other replicas.
     if(walkers_mpi) {
-      // Allocate arrays to store all walkers hills
-      std::vector<double> all_cv(mpi_nw_*cv.size(),0.0);
-      std::vector<double> all_sigma(mpi_nw_*thissigma.size(),0.0);
-      std::vector<double> all_height(mpi_nw_,0.0);
-      std::vector<int>    all_multivariate(mpi_nw_,0);
+      const unsigned ncv=cv.size();
+      const unsigned nsigma=thissigma.size();
+      // each hill travels as one packed record (walker index, height,
+      // multivariate flag, center, sigma) so that a single message per
+      // attempt is exchanged instead of four separate collectives
+      const unsigned recsize=3+ncv+nsigma;
+      std::vector<double> all_hills(mpi_nw_*recsize,0.0);
       if(comm.Get_rank()==0) {
-        // Communicate (only root)
-        multi_sim_comm.Allgather(cv,all_cv);
-        multi_sim_comm.Allgather(thissigma,all_sigma);
+        if(!walker_comms_setup_) setupWalkerComms();
+        std::vector<double> rec(recsize);
+        rec[0]=static_cast<double>(mpi_mw_);
 // notice that if gamma=1 we store directly -F so this scaling is not necessary:
-        multi_sim_comm.Allgather(height*(biasf_>1.0?biasf_/(biasf_-1.0):1.0),all_height);
-        multi_sim_comm.Allgather(int(multivariate),all_multivariate);
+        rec[1]=height*(biasf_>1.0?biasf_/(biasf_-1.0):1.0);
+        rec[2]=static_cast<double>(multivariate);
+        for(unsigned j=0; j<ncv; j++) rec[3+j]=cv[j];
+        for(unsigned j=0; j<nsigma; j++) rec[3+ncv+j]=thissigma[j];
+        // collect the records of the walkers running on this node; this
+        // traffic never leaves the shared memory of the node
+        std::vector<double> node_hills(walkers_node_comm_.Get_size()*recsize);
+        walkers_node_comm_.Allgather(rec,node_hills);
+        // only the node roots talk across the network, one aggregated
+        // message per node instead of one per walker
+        std::vector<double> gathered(mpi_nw_*recsize);
+        if(walkers_node_comm_.Get_rank()==0) {
+          std::vector<int> counts(walkers_inter_comm_.Get_size(),0);
+          const int mycount=node_hills.size();
+          walkers_inter_comm_.Allgather(mycount,counts);
+          std::vector<int> displs(counts.size(),0);
+          for(unsigned i=1; i<counts.size(); i++) displs[i]=displs[i-1]+counts[i-1];
+          walkers_inter_comm_.Allgatherv(&node_hills[0],node_hills.size(),&gathered[0],&counts[0],&displs[0]);
+        }
+        walkers_node_comm_.Bcast(gathered,0);
+        // records arrive grouped by node: put them back in replica order
+        // so that hills are added and written as with the flat allgather
+        for(unsigned i=0; i<mpi_nw_; i++) {
+          const unsigned w=static_cast<unsigned>(gathered[i*recsize]);
+          for(unsigned j=0; j<recsize; j++) all_hills[w*recsize+j]=gathered[i*recsize+j];
+        }
       }
       // Share info with group members
-      comm.Bcast(all_cv,0);
-      comm.Bcast(all_sigma,0);
-      comm.Bcast(all_height,0);
-      comm.Bcast(all_multivariate,0);
+      comm.Bcast(all_hills,0);
 
       // Flying Gaussian
       if (flying) {
         hills_.clear();
+        hillCenters_.clear();
+        hillInvSigmas_.clear();
+        hillHeights_.clear();
+        canBatchHills_=true;
+        // the cached bias refers to the hills that were just dropped
+        bias_cache_valid_=false;
         comm.Barrier();
       }
 
       for(unsigned i=0; i<mpi_nw_; i++) {
         // actually add hills one by one
-        std::vector<double> cv_now(cv.size());
-        std::vector<double> sigma_now(thissigma.size());
-        for(unsigned j=0; j<cv.size(); j++) cv_now[j]=all_cv[i*cv.size()+j];
-        for(unsigned j=0; j<thissigma.size(); j++) sigma_now[j]=all_sigma[i*thissigma.size()+j];
+        std::vector<double> cv_now(ncv);
+        std::vector<double> sigma_now(nsigma);
+        for(unsigned j=0; j<ncv; j++) cv_now[j]=all_hills[i*recsize+3+j];
+        for(unsigned j=0; j<nsigma; j++) sigma_now[j]=all_hills[i*recsize+3+ncv+j];
 // notice that if gamma=1 we store directly -F so this scaling is not necessary:
-        Gaussian newhill=Gaussian(cv_now,sigma_now,all_height[i]*(biasf_>1.0?(biasf_-1.0)/biasf_:1.0),all_multivariate[i]);
+        Gaussian newhill=Gaussian(cv_now,sigma_now,all_hills[i*recsize+1]*(biasf_>1.0?(biasf_-1.0)/biasf_:1.0),all_hills[i*recsize+2]>0.5);
         addGaussian(newhill);
 
         // Flying Gaussian
         if (!flying) {
           writeGaussian(newhill,hillsOfile_);
+          // every hill written to our own file counts towards the watermark
+          grid_nhills_[mw_id_]++;
         }
 
       }
@@ -1785,6 +2524,9 @@ void MetaD::update() {
       addGaussian(newhill);
       // print on HILLS file
       writeGaussian(newhill,hillsOfile_);
+      grid_nhills_[mw_id_]++;
+      // keep the hill so that it can be sent to the other walkers in memory
+      if(mw_share_hills_) mw_new_hills_.push_back(newhill);
     }
   }
 
@@ -1794,7 +2536,11 @@ void MetaD::update() {
     hillsOfile_.flush();
   }
 
-  double vbias1=getBiasAndDerivatives(cv);
+  // publish the hills deposited above, so that the work accumulated below
+  // and the force calculation of the next steps see them
+  if(dbgrid_) dbgrid_->swapBuffers();
+
+  double vbias1=getBiasAtCurrentPoint(cv);
   work_+=vbias1-vbias;
 
   // dump grid on file
@@ -1812,6 +2558,18 @@ void MetaD::update() {
       }
       if(r==0) gridfile_.rewind();
     }
+    // watermark the grid with the number of hills of each walker file it
+    // incorporates, so that a restart from this grid only needs to replay
+    // the tail of the hills files
+    for(int i=0; i<mw_n_; ++i) {
+      std::string num; Tools::convert(i,num);
+      gridfile_.addConstantField("nhills_"+num);
+    }
+    for(int i=0; i<mw_n_; ++i) {
+      std::string num; Tools::convert(i,num);
+      std::string cnum; Tools::convert(grid_nhills_[i],cnum);
+      gridfile_.printField("nhills_"+num,cnum);
+    }
     BiasGrid_->writeToFile(gridfile_);
     // if a single grid is stored, it is necessary to flush it, otherwise
     // the file might stay empty forever (when a single grid is not large enough to
@@ -1824,24 +2582,31 @@ void MetaD::update() {
 
   // if multiple walkers and time to read Gaussians
   if(mw_n_>1 && getStep()%mw_rstride_==0) {
-    for(int i=0; i<mw_n_; ++i) {
-      // don't read your own Gaussians
-      if(i==mw_id_) continue;
-      // if the file is not open yet
-      if(!(ifiles[i]->isOpen())) {
-        // check if it exists now and open it!
-        if(ifiles[i]->FileExist(ifilesnames[i])) {
-          ifiles[i]->open(ifilesnames[i]);
+    if(mw_share_hills_) {
+      shareNewHills();
+    } else {
+      for(int i=0; i<mw_n_; ++i) {
+        // don't read your own Gaussians
+        if(i==mw_id_) continue;
+        // if the file is not open yet
+        if(!(ifiles[i]->isOpen())) {
+          // check if it exists now and open it!
+          if(ifiles[i]->FileExist(ifilesnames[i])) {
+            ifiles[i]->open(ifilesnames[i]);
+            ifiles[i]->reset(false);
+          }
+          // otherwise read the new Gaussians
+        } else {
+          log.printf("  Reading hills from %s:",ifilesnames[i].c_str());
+          grid_nhills_[i]+=readGaussians(ifiles[i].get());
           ifiles[i]->reset(false);
         }
-        // otherwise read the new Gaussians
-      } else {
-        log.printf("  Reading hills from %s:",ifilesnames[i].c_str());
-        readGaussians(ifiles[i].get());
-        ifiles[i]->reset(false);
       }
     }
   }
+  // publish the hills just read from the other walkers
+  if(dbgrid_) dbgrid_->swapBuffers();
+
   // Recalculate special bias quantities whenever the bias has been changed by the update.
   bool bias_has_changed = (nowAddAHill || (mw_n_ > 1 && getStep() % mw_rstride_ == 0));
   if (calc_rct_ && bias_has_changed && getStep()%(stride_*rct_ustride_)==0) computeReweightingFactor();
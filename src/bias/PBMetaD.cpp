@@ -29,6 +29,7 @@
 #include "core/FlexibleBin.h"
 #include "tools/Matrix.h"
 #include "tools/Random.h"
+#include "tools/OpenMP.h"
 #include <string>
 #include <cstring>
 #include "tools/File.h"
@@ -949,20 +950,41 @@ void PBMetaD::calculate()
   // on adaptive hills (diff) after exchanges:
   if(adaptive_==FlexibleBin::diffusion && getExchangeStep()) error("ADAPTIVE=DIFF is not compatible with replica exchange");
 
-  vector<double> cv(1);
-  double der[1];
-  vector<double> bias(getNumberOfArguments());
-  vector<double> deriv(getNumberOfArguments());
+  const unsigned nargs=getNumberOfArguments();
+  vector<double> bias(nargs);
+  vector<double> deriv(nargs);
+
+  // the per-CV bias potentials are independent of each other, so they
+  // are evaluated in one parallel region over the CVs
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt>nargs) nt=nargs;
+  if(!grid_) {
+    // partial sums over the hills of all the CVs are accumulated first
+    // and reduced with a single collective, instead of two per CV
+    const unsigned stride=comm.Get_size();
+    const unsigned rank=comm.Get_rank();
+    #pragma omp parallel for num_threads(nt)
+    for(unsigned i=0; i<nargs; ++i) {
+      vector<double> cv_i(1); cv_i[0]=getArgument(i);
+      double b=0.0, d=0.0;
+      for(unsigned j=rank; j<hills_[i].size(); j+=stride) b+=evaluateGaussian(i,cv_i,hills_[i][j],&d);
+      bias[i]=b; deriv[i]=d;
+    }
+    comm.Sum(bias);
+    comm.Sum(deriv);
+  } else {
+    #pragma omp parallel for num_threads(nt)
+    for(unsigned i=0; i<nargs; ++i) {
+      vector<double> cv_i(1), vder(1);
+      cv_i[0]=getArgument(i);
+      bias[i]=BiasGrids_[i]->getValueAndDerivatives(cv_i,vder);
+      deriv[i]=vder[0];
+    }
+  }
 
   double ncv = (double) getNumberOfArguments();
   double bmin = 1.0e+19;
-  for(unsigned i=0; i<getNumberOfArguments(); ++i) {
-    cv[0]    = getArgument(i);
-    der[0]   = 0.0;
-    bias[i]  = getBiasAndDerivatives(i, cv, der);
-    deriv[i] = der[0];
-    if(bias[i] < bmin) bmin = bias[i];
-  }
+  for(unsigned i=0; i<nargs; ++i) if(bias[i] < bmin) bmin = bias[i];
   double ene = 0.;
   for(unsigned i=0; i<getNumberOfArguments(); ++i) {
     ene += exp((-bias[i]+bmin)/kbt_);
@@ -22,6 +22,7 @@
 #include "ReweightBase.h"
 #include "core/ActionRegister.h"
 #include "tools/Communicator.h"
+#include "tools/OpenMP.h"
 
 //+PLUMEDOC REWEIGHTING REWEIGHT_WHAM
 /*
@@ -140,28 +141,43 @@ void ReweightWham::calculateWeights( const unsigned& nframes ) {
   // Resize final weights array
   plumed_assert( stored_biases.size()%nreplicas==0 );
   final_weights.resize( stored_biases.size() / nreplicas, 1.0 );
-  // Offset and exponential of the bias
+  // Offset and exponential of the bias: the matrix is stored one frame per
+  // row, so both the construction and the weight pass below read it
+  // contiguously
   std::vector<double> expv( stored_biases.size() );
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt*8>expv.size()) nt=1;
+  #pragma omp parallel for num_threads(nt)
   for(unsigned i=0; i<expv.size(); ++i) expv[i] = exp( (-stored_biases[i]+minv) / simtemp );
-  // Initialize Z
-  std::vector<double> Z( nreplicas, 1.0 ), oldZ( nreplicas );
+  // Initialize Z (invZ turns the divisions of the hot inner loop into multiplies)
+  std::vector<double> Z( nreplicas, 1.0 ), oldZ( nreplicas ), invZ( nreplicas );
+  const unsigned nframes_stored=final_weights.size();
+  unsigned ntw=OpenMP::getNumThreads();
+  if(ntw*8>nframes_stored) ntw=1;
   // Now the iterative loop to calculate the WHAM weights
   for(unsigned iter=0; iter<maxiter; ++iter) {
     // Store Z
-    for(unsigned j=0; j<Z.size(); ++j) oldZ[j]=Z[j];
-    // Recompute weights
+    for(unsigned j=0; j<Z.size(); ++j) { oldZ[j]=Z[j]; invZ[j]=1.0/Z[j]; }
+    // Recompute weights, frames are independent so they are shared between threads
     double norm=0;
-    for(unsigned j=0; j<final_weights.size(); ++j) {
+    #pragma omp parallel for num_threads(ntw) reduction(+:norm)
+    for(unsigned j=0; j<nframes_stored; ++j) {
       double ew=0;
-      for(unsigned k=0; k<Z.size(); ++k) ew += expv[j*Z.size()+k]  / Z[k];
+      for(unsigned k=0; k<Z.size(); ++k) ew += expv[j*Z.size()+k]*invZ[k];
       final_weights[j] = 1.0 / ew; norm += final_weights[j];
     }
     // Normalize weights
-    for(unsigned j=0; j<final_weights.size(); ++j) final_weights[j] /= norm;
-    // Recompute Z
-    for(unsigned j=0; j<Z.size(); ++j) Z[j] = 0.0;
-    for(unsigned j=0; j<final_weights.size(); ++j) {
-      for(unsigned k=0; k<Z.size(); ++k) Z[k] += final_weights[j]*expv[j*Z.size()+k];
+    #pragma omp parallel for num_threads(ntw)
+    for(unsigned j=0; j<nframes_stored; ++j) final_weights[j] /= norm;
+    // Recompute Z: every thread owns whole columns of the bias matrix, so
+    // no partial accumulators are needed
+    unsigned ntz=OpenMP::getNumThreads();
+    if(ntz>Z.size()) ntz=Z.size();
+    #pragma omp parallel for num_threads(ntz)
+    for(unsigned k=0; k<Z.size(); ++k) {
+      double zk=0.0;
+      for(unsigned j=0; j<nframes_stored; ++j) zk += final_weights[j]*expv[j*Z.size()+k];
+      Z[k]=zk;
     }
     // Normalize Z and compute change in Z
     double change=0; norm=0; for(unsigned k=0; k<Z.size(); ++k) norm+=Z[k];
@@ -0,0 +1,262 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "CLTool.h"
+#include "CLToolRegister.h"
+#include "core/Value.h"
+#include "tools/Tools.h"
+#include "tools/Vector.h"
+#include "tools/Tensor.h"
+#include "tools/Pbc.h"
+#include "tools/RMSD.h"
+#include "tools/SwitchingFunction.h"
+#include "tools/NeighborList.h"
+#include "tools/Grid.h"
+#include "tools/KernelFunctions.h"
+#include "tools/Random.h"
+#include "tools/Communicator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace PLMD {
+namespace cltools {
+
+//+PLUMEDOC TOOLS benchmark
+/*
+benchmark is a tool that times the core plumed kernels on synthetic inputs
+
+It runs a fixed set of microbenchmarks (RMSD alignment, switching
+functions, periodic-boundary distances, neighbor-list updates, grid
+interpolation and hill evaluation) on synthetic data, without any file
+I/O, and reports the time per operation and an estimate of the memory
+traffic for each of them. The purpose is to compare the performance of
+the computational kernels across plumed versions and compilers on equal
+footing.
+
+\par Examples
+
+\verbatim
+plumed benchmark
+\endverbatim
+
+The amount of work can be scaled up to reduce the timing noise:
+
+\verbatim
+plumed benchmark --scale 10 --natoms 8000
+\endverbatim
+
+*/
+//+ENDPLUMEDOC
+
+class Benchmark:
+  public CLTool
+{
+public:
+  static void registerKeywords( Keywords& keys );
+  explicit Benchmark(const CLToolOptions& co );
+  int main(FILE* in, FILE*out,Communicator& pc) override;
+  string description()const override {
+    return "run microbenchmarks of the core plumed kernels";
+  }
+private:
+  static double now();
+  void report(FILE* out, const std::string& name, const double elapsed, const double nops, const double bytes_per_op);
+};
+
+PLUMED_REGISTER_CLTOOL(Benchmark,"benchmark")
+
+void Benchmark::registerKeywords( Keywords& keys ) {
+  CLTool::registerKeywords( keys );
+  keys.add("compulsory","--scale","1","scale factor for the number of repetitions of every kernel");
+  keys.add("compulsory","--natoms","4000","the number of atoms used in the neighbor-list benchmarks");
+}
+
+Benchmark::Benchmark(const CLToolOptions& co ):
+  CLTool(co)
+{
+  inputdata=commandline;
+}
+
+double Benchmark::now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Benchmark::report(FILE* out, const std::string& name, const double elapsed, const double nops, const double bytes_per_op) {
+  const double ns_per_op = 1.e9*elapsed/nops;
+  const double gb_per_s  = (nops*bytes_per_op/elapsed)*1.e-9;
+  fprintf(out,"%-24s %14.2f ns/op %12.3f GB/s\n",name.c_str(),ns_per_op,gb_per_s);
+}
+
+int Benchmark::main(FILE* in, FILE*out,Communicator& pc) {
+
+  unsigned scale; parse("--scale",scale);
+  unsigned natoms; parse("--natoms",natoms);
+  if(scale<1) {fprintf(stderr,"ERROR: --scale should be at least 1\n"); return 1;}
+  if(natoms<2) {fprintf(stderr,"ERROR: --natoms should be at least 2\n"); return 1;}
+
+  Random rnd; rnd.setSeed(-20);
+  // accumulated into by every kernel and printed at the end, both as a
+  // quick sanity check and to prevent the compiler from removing the work
+  double checksum=0.0;
+
+  fprintf(out,"PLUMED kernel microbenchmarks (scale %u, %u atoms)\n",scale,natoms);
+
+  // triclinic box used by the pbc and neighbor-list benchmarks
+  Pbc pbc;
+  pbc.setBox(Tensor(2.0,0.0,0.0, 0.1,2.0,0.0, 0.1,0.1,2.0));
+
+  // ---- RMSD (optimal alignment) ----
+  {
+    const unsigned nat=108;
+    std::vector<Vector> ref(nat), pos(nat), derivs(nat);
+    for(unsigned i=0; i<nat; i++) {
+      ref[i]=Vector(rnd.RandU01(),rnd.RandU01(),rnd.RandU01());
+      pos[i]=ref[i]+0.05*Vector(rnd.RandU01()-0.5,rnd.RandU01()-0.5,rnd.RandU01()-0.5);
+    }
+    std::vector<double> align(nat,1.0), displace(nat,1.0);
+    RMSD rmsd; rmsd.set(align,displace,ref,"OPTIMAL");
+    const unsigned nops=20000*scale;
+    const double t0=now();
+    for(unsigned i=0; i<nops; i++) {
+      pos[i%nat][0]+=1.e-6;
+      checksum+=rmsd.calculate(pos,derivs,true);
+    }
+    report(out,"rmsd (optimal, 108 at)",now()-t0,nops,2.0*nat*3*sizeof(double));
+  }
+
+  // ---- SwitchingFunction ----
+  {
+    SwitchingFunction sf;
+    std::string errors; sf.set("RATIONAL R_0=0.3 NN=6 MM=12",errors);
+    if(errors.length()>0) {fprintf(stderr,"ERROR: cannot set up switching function: %s\n",errors.c_str()); return 1;}
+    const unsigned ndist=1024;
+    std::vector<double> dist2(ndist);
+    for(unsigned i=0; i<ndist; i++) {double d=0.6*rnd.RandU01(); dist2[i]=d*d;}
+    const unsigned nsweeps=200000*scale/ndist+1;
+    double dfunc=0.0;
+    const double t0=now();
+    for(unsigned s=0; s<nsweeps; s++) {
+      for(unsigned i=0; i<ndist; i++) checksum+=sf.calculateSqr(dist2[i],dfunc);
+    }
+    report(out,"switching (rational)",now()-t0,nsweeps*(double)ndist,2.0*sizeof(double));
+  }
+
+  // ---- Pbc::distance (triclinic) ----
+  {
+    const unsigned npairs=1024;
+    std::vector<Vector> va(npairs), vb(npairs);
+    for(unsigned i=0; i<npairs; i++) {
+      va[i]=Vector(4.0*rnd.RandU01()-2.0,4.0*rnd.RandU01()-2.0,4.0*rnd.RandU01()-2.0);
+      vb[i]=Vector(4.0*rnd.RandU01()-2.0,4.0*rnd.RandU01()-2.0,4.0*rnd.RandU01()-2.0);
+    }
+    const unsigned nsweeps=100000*scale/npairs+1;
+    const double t0=now();
+    for(unsigned s=0; s<nsweeps; s++) {
+      for(unsigned i=0; i<npairs; i++) checksum+=pbc.distance(va[i],vb[i]).modulo2();
+    }
+    report(out,"pbc distance (triclinic)",now()-t0,nsweeps*(double)npairs,2.0*3*sizeof(double));
+  }
+
+  // ---- NeighborList::update ----
+  {
+    std::vector<AtomNumber> indices(natoms);
+    for(unsigned i=0; i<natoms; i++) indices[i].setIndex(i);
+    std::vector<Vector> positions(natoms);
+    for(unsigned i=0; i<natoms; i++) positions[i]=Vector(2.0*rnd.RandU01(),2.0*rnd.RandU01(),2.0*rnd.RandU01());
+    const double cutoff=0.3;
+    {
+      NeighborList nl(indices,true,true,pbc,pc,cutoff,0);
+      const unsigned nops=2*scale;
+      const double t0=now();
+      for(unsigned i=0; i<nops; i++) {nl.update(positions); checksum+=nl.size();}
+      report(out,"nl update (pairwise)",now()-t0,nops,natoms*3.0*sizeof(double));
+    }
+    {
+      NeighborList nl(indices,true,true,pbc,pc,cutoff,0,true);
+      const unsigned nops=20*scale;
+      const double t0=now();
+      for(unsigned i=0; i<nops; i++) {nl.update(positions); checksum+=nl.size();}
+      report(out,"nl update (celllist)",now()-t0,nops,natoms*3.0*sizeof(double));
+    }
+  }
+
+  // ---- Grid interpolation (2d, spline) ----
+  {
+    std::vector<std::string> names; names.push_back("x"); names.push_back("y");
+    std::vector<std::string> gmin(2,"0.0"), gmax(2,"1.0"), pmin(2,""), pmax(2,"");
+    std::vector<unsigned> nbin(2,64);
+    std::vector<bool> isperiodic(2,false);
+    Grid grid("bench",names,gmin,gmax,nbin,true,true,isperiodic,pmin,pmax);
+    std::vector<double> xx(2), der(2);
+    for(Grid::index_t i=0; i<grid.getSize(); i++) {
+      grid.getPoint(i,xx);
+      const double v=sin(2.0*pi*xx[0])*cos(2.0*pi*xx[1]);
+      der[0]=2.0*pi*cos(2.0*pi*xx[0])*cos(2.0*pi*xx[1]);
+      der[1]=-2.0*pi*sin(2.0*pi*xx[0])*sin(2.0*pi*xx[1]);
+      grid.setValueAndDerivatives(i,v,der);
+    }
+    const unsigned npoints=1024;
+    std::vector<std::vector<double> > points(npoints,std::vector<double>(2));
+    for(unsigned i=0; i<npoints; i++) {points[i][0]=rnd.RandU01(); points[i][1]=rnd.RandU01();}
+    const unsigned nsweeps=20000*scale/npoints+1;
+    const double t0=now();
+    for(unsigned s=0; s<nsweeps; s++) {
+      for(unsigned i=0; i<npoints; i++) checksum+=grid.getValueAndDerivatives(points[i],der);
+    }
+    // a 2d spline interpolation touches the values and derivatives of the 4 corners
+    report(out,"grid spline (2d)",now()-t0,nsweeps*(double)npoints,4.0*3*sizeof(double));
+  }
+
+  // ---- MetaD hill (gaussian kernel) evaluation ----
+  {
+    std::vector<double> center(2,0.5), sig(2,0.1);
+    KernelFunctions kernel(center,sig,"gaussian","DIAGONAL",1.2);
+    std::vector<std::unique_ptr<Value>> vv(2);
+    for(unsigned i=0; i<2; i++) {vv[i].reset(new Value()); vv[i]->setNotPeriodic();}
+    auto vv_ptr=Tools::unique2raw(vv);
+    std::vector<double> der(2);
+    const unsigned npoints=1024;
+    std::vector<std::vector<double> > points(npoints,std::vector<double>(2));
+    for(unsigned i=0; i<npoints; i++) {points[i][0]=rnd.RandU01(); points[i][1]=rnd.RandU01();}
+    const unsigned nsweeps=50000*scale/npoints+1;
+    const double t0=now();
+    for(unsigned s=0; s<nsweeps; s++) {
+      for(unsigned i=0; i<npoints; i++) {
+        vv[0]->set(points[i][0]); vv[1]->set(points[i][1]);
+        checksum+=kernel.evaluate(vv_ptr,der,true);
+      }
+    }
+    report(out,"hill evaluation (2d)",now()-t0,nsweeps*(double)npoints,4.0*sizeof(double));
+  }
+
+  fprintf(out,"checksum %f\n",checksum);
+
+  return 0;
+}
+
+}
+}
@@ -28,13 +28,26 @@
 #include "tools/Pbc.h"
 #include <cstdio>
 #include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 #include <vector>
 #include <map>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "tools/Units.h"
 #include "tools/PDB.h"
 #include "tools/FileBase.h"
 #include "tools/IFile.h"
+#include "tools/MassChargeCache.h"
 
 // when using molfile plugin
 #ifdef __PLUMED_HAS_MOLFILE_PLUGINS
@@ -195,6 +208,283 @@ static int register_cb(void *v, vmdplugin_t *p) {
 }
 #endif
 
+/// Collects hardware performance counters around the calculation of every
+/// frame through the Linux perf_event interface. The events are inherited
+/// by the threads created afterwards, so the OpenMP workers are counted as
+/// well. On platforms without perf_event open() fails and the driver
+/// falls back to plain timings.
+class PerfCounters {
+public:
+  static const unsigned ncounters=4;
+private:
+  int fds[ncounters];
+  long long base[ncounters];
+public:
+/// counts of the last frame and accumulated over the frames, in the order
+/// cycles, instructions, cache references, cache misses
+  long long delta[ncounters];
+  long long total[ncounters];
+  PerfCounters() {
+    for(unsigned i=0; i<ncounters; i++) {fds[i]=-1; base[i]=0; delta[i]=0; total[i]=0;}
+  }
+  ~PerfCounters() {
+#ifdef __linux__
+    for(unsigned i=0; i<ncounters; i++) if(fds[i]>=0) ::close(fds[i]);
+#endif
+  }
+/// opens the counters, returning false if they are not available
+  bool open() {
+#ifdef __linux__
+    const unsigned long long configs[ncounters]= {
+      PERF_COUNT_HW_CPU_CYCLES,PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES,PERF_COUNT_HW_CACHE_MISSES
+    };
+    for(unsigned i=0; i<ncounters; i++) {
+      struct perf_event_attr attr;
+      std::memset(&attr,0,sizeof(attr));
+      attr.size=sizeof(attr);
+      attr.type=PERF_TYPE_HARDWARE;
+      attr.config=configs[i];
+      attr.exclude_kernel=1;
+      attr.exclude_hv=1;
+      attr.inherit=1;
+      fds[i]=::syscall(__NR_perf_event_open,&attr,0,-1,-1,0);
+      if(fds[i]<0) {
+        for(unsigned j=0; j<i; j++) {::close(fds[j]); fds[j]=-1;}
+        return false;
+      }
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+/// the counters run freely, so a frame is measured as the difference
+/// between the readings at start() and stop()
+  void start() {
+#ifdef __linux__
+    for(unsigned i=0; i<ncounters; i++) {
+      if(::read(fds[i],&base[i],sizeof(long long))!=sizeof(long long)) base[i]=0;
+    }
+#endif
+  }
+  void stop() {
+#ifdef __linux__
+    for(unsigned i=0; i<ncounters; i++) {
+      long long v=base[i];
+      if(::read(fds[i],&v,sizeof(long long))!=sizeof(long long)) v=base[i];
+      delta[i]=v-base[i];
+      total[i]+=delta[i];
+    }
+#endif
+  }
+};
+
+/// Parse "<name> <x> <y> <z>" from an xyz line with a single pass of strtod,
+/// avoiding the repeated format-string scanning that sscanf does on the
+/// per-atom hot path
+static bool parseAtomLine(const char* p,double cc[3]) {
+  while(*p==' '||*p=='\t') p++;
+  if(*p=='\0') return false;
+  while(*p!='\0' && *p!=' ' && *p!='\t') p++;
+  for(unsigned k=0; k<3; k++) {
+    char* end=NULL;
+    cc[k]=std::strtod(p,&end);
+    if(end==p) return false;
+    p=end;
+  }
+  return true;
+}
+
+/// Magic marker starting a binary frame cache sidecar written by the driver
+static const char framecache_magic[8]= {'P','L','M','D','F','C','A','C'};
+static const int32_t framecache_version=1;
+
+/// Reads raw chunks of a text trajectory on a dedicated thread, so that
+/// disk I/O overlaps with parsing and with the calculation of the previous
+/// frame. getline() has the same semantics as Tools::getline() but consumes
+/// the in-memory buffers filled by the reader thread.
+class LinePrefetcher {
+/// maximum read-ahead is maxchunks*chunksize bytes
+  static const unsigned maxchunks=64;
+  static const unsigned chunksize=65536;
+  FILE* fp;
+/// chunk being consumed by getline() and the consumed prefix of it
+  std::string current;
+  std::string::size_type pos;
+/// chunks filled by the reader thread, oldest first
+  std::deque<std::string> chunks;
+/// set by the reader thread once the end of the file is reached
+  bool eof;
+/// set by the destructor to unblock the reader thread
+  bool done;
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::thread thread;
+/// body of the reader thread
+  void run() {
+    std::vector<char> buffer(chunksize);
+    while(true) {
+      size_t n=fread(buffer.data(),1,chunksize,fp);
+      std::unique_lock<std::mutex> lock(mutex);
+      if(n>0) {
+        while(chunks.size()>=maxchunks && !done) notFull.wait(lock);
+        if(done) return;
+        chunks.emplace_back(buffer.data(),n);
+        notEmpty.notify_one();
+      }
+      if(n<chunksize) {
+        eof=true;
+        notEmpty.notify_one();
+        return;
+      }
+    }
+  }
+/// makes the next chunk current, returning false at the end of the file
+  bool nextChunk() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(chunks.empty() && !eof) notEmpty.wait(lock);
+    if(chunks.empty()) return false;
+    current=std::move(chunks.front());
+    chunks.pop_front();
+    pos=0;
+    notFull.notify_one();
+    return true;
+  }
+public:
+  explicit LinePrefetcher(FILE* fp):
+    fp(fp),
+    pos(0),
+    eof(false),
+    done(false)
+  {
+    thread=std::thread(&LinePrefetcher::run,this);
+  }
+  ~LinePrefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done=true;
+      notFull.notify_one();
+    }
+    thread.join();
+  }
+/// equivalent to Tools::getline(fp,line): strips the trailing newline and
+/// carriage return, and returns false once the end of the file is reached
+  bool getline(std::string & line) {
+    line.clear();
+    bool ret=false;
+    while(true) {
+      if(pos>=current.length() && !nextChunk()) break;
+      std::string::size_type nl=current.find('\n',pos);
+      if(nl==std::string::npos) {
+        line.append(current,pos,std::string::npos);
+        pos=current.length();
+      } else {
+        line.append(current,pos,nl-pos);
+        pos=nl+1;
+        ret=true;
+        break;
+      }
+    }
+    if(line.length()>0) if(*(line.end()-1)=='\r') line.erase(line.end()-1);
+    return ret;
+  }
+};
+
+#ifdef __PLUMED_HAS_MOLFILE_PLUGINS
+/// Decodes molfile frames ahead of the calculation on a dedicated thread.
+/// Each slot owns its own coordinate buffer, so that a decoded frame is
+/// handed to the consumer without copying it. After construction the plugin
+/// is only ever called from the reader thread, which makes this safe also
+/// with plugins that are not thread safe.
+class MolfilePrefetcher {
+  struct Slot {
+    molfile_timestep_t ts;
+    std::unique_ptr<float[]> coords;
+    int rc;
+  };
+/// one frame in use by the consumer plus two decoded ahead
+  static const unsigned nslots=3;
+  molfile_plugin_t* api;
+  void* h_in;
+  int natoms;
+  std::vector<Slot> slots;
+/// slots available to the reader thread and slots holding decoded frames
+  std::deque<Slot*> freeSlots;
+  std::deque<Slot*> readySlots;
+/// slot whose frame is being processed by the consumer
+  Slot* held;
+/// set by the destructor to unblock the reader thread
+  bool done;
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::thread thread;
+/// body of the reader thread
+  void run() {
+    while(true) {
+      Slot* s;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(freeSlots.empty() && !done) notFull.wait(lock);
+        if(done) return;
+        s=freeSlots.front();
+        freeSlots.pop_front();
+      }
+      s->rc=api->read_next_timestep(h_in,natoms,&s->ts);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        readySlots.push_back(s);
+        notEmpty.notify_one();
+        if(s->rc!=MOLFILE_SUCCESS) return;
+      }
+    }
+  }
+public:
+  MolfilePrefetcher(molfile_plugin_t* api,void* h_in,int natoms):
+    api(api),
+    h_in(h_in),
+    natoms(natoms),
+    slots(nslots),
+    held(NULL),
+    done(false)
+  {
+    for(auto & s : slots) {
+      s.coords.reset(new float [3*natoms]);
+      s.ts.coords=s.coords.get();
+      s.ts.velocities=NULL;
+      s.ts.A=-1; // we use this to check whether cell is provided or not
+      freeSlots.push_back(&s);
+    }
+    thread=std::thread(&MolfilePrefetcher::run,this);
+  }
+  ~MolfilePrefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done=true;
+      notFull.notify_one();
+    }
+    thread.join();
+  }
+/// points ts to the next decoded frame and returns the molfile return code.
+/// The frame stays valid until the next call, when its slot is recycled.
+  int next(molfile_timestep_t* & ts) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if(held) {
+      freeSlots.push_back(held);
+      held=NULL;
+      notFull.notify_one();
+    }
+    while(readySlots.empty()) notEmpty.wait(lock);
+    held=readySlots.front();
+    readySlots.pop_front();
+    ts=&held->ts;
+    return held->rc;
+  }
+};
+#endif
+
 template<typename real>
 class Driver : public CLTool {
 public:
@@ -220,8 +510,13 @@ void Driver<real>::registerKeywords( Keywords& keys ) {
 #endif
           );
   keys.add("compulsory","--multi","0","set number of replicas for multi environment (needs MPI)");
+  keys.addFlag("--scatter",false,"distribute the frames of the trajectory over the MPI ranks; each rank runs an independent plumed instance and appends its rank to the names of the files it writes (needs MPI)");
   keys.addFlag("--noatoms",false,"don't read in a trajectory.  Just use colvar files as specified in plumed.dat");
   keys.addFlag("--parse-only",false,"read the plumed input file and stop");
+  keys.addFlag("--prefetch",false,"read and decode the trajectory on a separate thread, overlapping I/O with the calculation");
+  keys.add("optional","--read-stride","process only one in every N frames of the trajectory. The other frames are skipped without decoding them; for formats whose frames can be skipped with a seek (e.g. dcd) their bytes are not even read, which makes subsampled analysis of very large trajectories much cheaper");
+  keys.addFlag("--frame-cache",false,"with xyz and gro trajectories, write a binary sidecar file (.fcache) on the first pass over the trajectory and read the frames from it on subsequent passes, skipping the text parsing entirely; the cache is ignored and rewritten when the trajectory changes");
+  keys.addFlag("--perf-counters",false,"collect hardware counters (cycles, instructions, cache references and misses) around the calculation of every frame and print per-frame and aggregate statistics (Linux only)");
   keys.add("atoms","--ixyz","the trajectory in xyz format");
   keys.add("atoms","--igro","the trajectory in gro format");
   keys.add("atoms","--idlp4","the trajectory in DL_POLY_4 format");
@@ -237,7 +532,7 @@ void Driver<real>::registerKeywords( Keywords& keys ) {
   keys.add("optional","--dump-forces-fmt","( default=%%f ) the format to use to dump the forces");
   keys.addFlag("--dump-full-virial",false,"with --dump-forces, it dumps the 9 components of the virial");
   keys.add("optional","--pdb","provides a pdb with masses and charges");
-  keys.add("optional","--mc","provides a file with masses and charges as produced with DUMPMASSCHARGE");
+  keys.add("optional","--mc","provides a file with masses and charges as produced with DUMPMASSCHARGE, in either the text or the binary format");
   keys.add("optional","--box","comma-separated box dimensions (3 for orthorhombic, 9 for generic)");
   keys.add("optional","--natoms","provides number of atoms - only used if file format does not contain number of atoms");
   keys.add("optional","--initial-step","provides a number for the initial step, default is 0");
@@ -287,6 +582,9 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   // Are we reading trajectory data
   bool noatoms; parseFlag("--noatoms",noatoms);
   bool parseOnly; parseFlag("--parse-only",parseOnly);
+  bool prefetch; parseFlag("--prefetch",prefetch);
+  bool framecache; parseFlag("--frame-cache",framecache);
+  bool perfcounters; parseFlag("--perf-counters",perfcounters);
 
   std::string fakein;
   bool debug_float=false;
@@ -341,6 +639,20 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     intracomm.Set_comm(pc.Get_comm());
   }
 
+// set up for scattering the frames of the trajectory over the MPI ranks:
+  bool scatter; parseFlag("--scatter",scatter);
+  if(scatter) {
+    if(multi) error("--scatter cannot be used with --multi");
+    if(debug_pd || debug_dd) error("--scatter cannot be used with debug decompositions");
+    if(noatoms) error("--scatter needs a trajectory");
+    if(!Communicator::initialized() || pc.Get_size()<2) {
+      fprintf(out,"DRIVER: running on a single process, --scatter has no effect\n");
+      scatter=false;
+    } else {
+      fprintf(out,"DRIVER: scattering frames over %d processes; output files are labelled with the rank\n",pc.Get_size());
+    }
+  }
+
 // set up for debug replica exchange:
   bool debug_grex=parse("--debug-grex",fakein);
   int  grex_stride=0;
@@ -365,6 +677,9 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   real timestep=real(t);
 // the stride
   unsigned stride; parse("--trajectory-stride",stride);
+// how many frames of the trajectory to skip between processed ones
+  int read_stride=1; parse("--read-stride",read_stride);
+  if(read_stride<1) error("--read-stride should be at least 1");
 // are we writing forces
   string dumpforces(""), debugforces(""), dumpforcesFmt("%f");;
   bool dumpfullvirial=false;
@@ -392,6 +707,9 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   ts_in.coords=ts_in_coords.get();
   ts_in.velocities=NULL;
   ts_in.A=-1; // we use this to check whether cell is provided or not
+// points to the frame being processed: &ts_in, or a prefetcher slot
+  molfile_timestep_t* ts_ptr=&ts_in;
+  std::unique_ptr<MolfilePrefetcher> molfilePrefetcher;
 #endif
 
 // Read in an xyz file
@@ -515,7 +833,15 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
       p.cmd("GREX setMPIIntracomm",&intracomm.Get_comm());
       p.cmd("GREX init");
     }
-    p.cmd("setMPIComm",&intracomm.Get_comm());
+    if(scatter) {
+// each rank runs an independent serial plumed and labels its output files,
+// so that the per-rank results can be merged in frame order afterwards
+      string n; Tools::convert(intracomm.Get_rank(),n);
+      string suffix="."+n;
+      p.cmd("setSuffix",suffix.c_str());
+    } else {
+      p.cmd("setMPIComm",&intracomm.Get_comm());
+    }
   }
   p.cmd("setMDLengthUnits",&units.getLength());
   p.cmd("setMDChargeUnits",&units.getCharge());
@@ -535,7 +861,21 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   }
 
 
+// the counters must be opened before the OpenMP workers are spawned so
+// that they are inherited by them
+  PerfCounters perfc;
+  if(perfcounters && !perfc.open()) {
+    fprintf(out,"DRIVER: hardware counters are not available on this system, ignoring --perf-counters\n");
+    perfcounters=false;
+  }
+
   FILE* fp=NULL; FILE* fp_forces=NULL; OFile fp_dforces;
+  std::unique_ptr<LinePrefetcher> linePrefetcher;
+// binary frame cache sidecar: read from an up-to-date one, or written
+// while the text trajectory is parsed for the first time
+  FILE* fcache_in=NULL; FILE* fcache_out=NULL;
+  std::string fcache_name, fcache_tmpname;
+  bool fcache_complete=false;
 #ifdef __PLUMED_HAS_XDRFILE
   XDRFILE* xd=NULL;
 #endif
@@ -580,6 +920,56 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
         }
       }
     }
+    if(framecache && fp && fp!=in && (trajectory_fmt=="xyz" || trajectory_fmt=="gro")) {
+      if(scatter || debug_pd || debug_dd || read_stride>1) fprintf(out,"DRIVER: --frame-cache cannot be used with --scatter, --read-stride or the debug decompositions, ignoring it\n");
+      else if(pbc_cli_given) fprintf(out,"DRIVER: --frame-cache cannot be used with --box, ignoring it\n");
+      else {
+        fcache_name=trajectoryFile+".fcache";
+        struct stat traj_st;
+        if(stat(trajectoryFile.c_str(),&traj_st)==0) {
+          FILE* cfp=std::fopen(fcache_name.c_str(),"r");
+          if(cfp) {
+// the cache records the size and modification time of the trajectory it
+// was built from; a stale or truncated sidecar is ignored and rewritten
+            char magic[8]; int32_t version=0; uint64_t tsize=0; int64_t tmtime=0;
+            bool ok=std::fread(magic,1,8,cfp)==8 && std::memcmp(magic,framecache_magic,8)==0 &&
+                    std::fread(&version,sizeof(version),1,cfp)==1 && version==framecache_version &&
+                    std::fread(&tsize,sizeof(tsize),1,cfp)==1 && tsize==static_cast<uint64_t>(traj_st.st_size) &&
+                    std::fread(&tmtime,sizeof(tmtime),1,cfp)==1 && tmtime==static_cast<int64_t>(traj_st.st_mtime);
+            if(ok) {
+              fcache_in=cfp;
+              fprintf(out,"DRIVER: reading frames from the binary cache %s\n",fcache_name.c_str());
+            } else std::fclose(cfp);
+          }
+          if(!fcache_in) {
+// write to a per-process temporary name and rename it in place at the end
+// of the trajectory, so that a partial cache is never picked up
+            string spid; Tools::convert(static_cast<int>(getpid()),spid);
+            fcache_tmpname=fcache_name+".tmp."+spid;
+            fcache_out=std::fopen(fcache_tmpname.c_str(),"w");
+            if(fcache_out) {
+              const uint64_t tsize=traj_st.st_size;
+              const int64_t tmtime=traj_st.st_mtime;
+              bool ok=std::fwrite(framecache_magic,1,8,fcache_out)==8 &&
+                      std::fwrite(&framecache_version,sizeof(framecache_version),1,fcache_out)==1 &&
+                      std::fwrite(&tsize,sizeof(tsize),1,fcache_out)==1 &&
+                      std::fwrite(&tmtime,sizeof(tmtime),1,fcache_out)==1;
+              if(ok) fprintf(out,"DRIVER: writing the binary frame cache %s\n",fcache_name.c_str());
+              else { std::fclose(fcache_out); fcache_out=NULL; std::remove(fcache_tmpname.c_str()); }
+            }
+          }
+        }
+      }
+    }
+    if(prefetch) {
+      if(fcache_in) fprintf(out,"DRIVER: --prefetch is not needed when reading from the frame cache, ignoring it\n");
+      else if(fp) linePrefetcher.reset(new LinePrefetcher(fp));
+#ifdef __PLUMED_HAS_MOLFILE_PLUGINS
+      else if(use_molfile && read_stride>1) fprintf(out,"DRIVER: --prefetch would decode the frames skipped by --read-stride, ignoring it\n");
+      else if(use_molfile) molfilePrefetcher.reset(new MolfilePrefetcher(api,h_in,natoms));
+#endif
+      else fprintf(out,"DRIVER: --prefetch is not available for this trajectory format, reading it serially\n");
+    }
     if(dumpforces.length()>0) {
       if(Communicator::initialized() && pc.Get_size()>1) {
         string n;
@@ -599,6 +989,8 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   }
 
   std::string line;
+// when prefetching, trajectory lines are served from the read-ahead buffers
+  auto readline=[&](std::string & l) { return linePrefetcher ? linePrefetcher->getline(l) : Tools::getline(fp,l); };
   std::vector<real> coordinates;
   std::vector<real> forces;
   std::vector<real> masses;
@@ -622,30 +1014,46 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
   Random rnd;
 
   if(trajectory_fmt=="dlp4") {
-    if(!Tools::getline(fp,line)) error("error reading title");
-    if(!Tools::getline(fp,line)) error("error reading atoms");
+    if(!readline(line)) error("error reading title");
+    if(!readline(line)) error("error reading atoms");
     sscanf(line.c_str(),"%d %d %d",&lvl,&pb,&natoms);
 
   }
   bool lstep=true;
+// frames are assigned round robin over the ranks when scattering
+  long int frame=0;
+  bool process=true;
   while(true) {
+    if(scatter || read_stride>1) {
+      process=true;
+      if(scatter && frame%intracomm.Get_size()!=intracomm.Get_rank()) process=false;
+// subsampled frames reuse the machinery that consumes a frame without
+// decoding it (for dcd, without even reading its bytes)
+      if(frame%read_stride!=0) process=false;
+    }
     if(!noatoms&&!parseOnly) {
       if(use_molfile==true) {
 #ifdef __PLUMED_HAS_MOLFILE_PLUGINS
         int rc;
-        rc = api->read_next_timestep(h_in, natoms, &ts_in);
+        if(molfilePrefetcher) rc=molfilePrefetcher->next(ts_ptr);
+// passing a null timestep tells the plugin to skip the frame without decoding it
+        else rc = api->read_next_timestep(h_in, natoms, process?ts_ptr:NULL);
         if(rc==MOLFILE_EOF) {
           break;
         }
 #endif
+      } else if(fcache_in) {
+        int32_t cached_natoms=0;
+        if(std::fread(&cached_natoms,sizeof(cached_natoms),1,fcache_in)!=1) { fcache_complete=true; break; }
+        natoms=cached_natoms;
       } else if(trajectory_fmt=="xyz" || trajectory_fmt=="gro" || trajectory_fmt=="dlp4") {
-        if(!Tools::getline(fp,line)) break;
+        if(!readline(line)) { fcache_complete=true; break; }
       }
     }
     bool first_step=false;
     if(!noatoms&&!parseOnly) {
-      if(use_molfile==false && (trajectory_fmt=="xyz" || trajectory_fmt=="gro")) {
-        if(trajectory_fmt=="gro") if(!Tools::getline(fp,line)) error("premature end of trajectory file");
+      if(use_molfile==false && !fcache_in && (trajectory_fmt=="xyz" || trajectory_fmt=="gro")) {
+        if(trajectory_fmt=="gro") if(!readline(line)) error("premature end of trajectory file");
         sscanf(line.c_str(),"%100d",&natoms);
       }
       if(use_molfile==false && trajectory_fmt=="dlp4") {
@@ -677,12 +1085,22 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
         }
       }
       if(mcfile.length()>0) {
-        IFile ifile;
-        ifile.open(mcfile);
-        int index; double mass; double charge;
-        while(ifile.scanField("index",index).scanField("mass",mass).scanField("charge",charge).scanField()) {
-          masses[index]=mass;
-          charges[index]=charge;
+        if(MassChargeCache::isBinary(mcfile)) {
+          std::vector<int> mcindex; std::vector<double> mcmass,mccharge;
+          if(!MassChargeCache::read(mcfile,mcindex,mcmass,mccharge)) error("cannot read binary mass/charge file " + mcfile);
+          for(unsigned i=0; i<mcindex.size(); i++) {
+            if(mcindex[i]<0 || mcindex[i]>=natoms) error("atom index in mc file exceeds the number of atoms in trajectory");
+            if(!mcmass.empty()) masses[mcindex[i]]=real(mcmass[i]);
+            if(!mccharge.empty()) charges[mcindex[i]]=real(mccharge[i]);
+          }
+        } else {
+          IFile ifile;
+          ifile.open(mcfile);
+          int index; double mass; double charge;
+          while(ifile.scanField("index",index).scanField("mass",mass).scanField("charge",charge).scanField()) {
+            masses[index]=mass;
+            charges[index]=charge;
+          }
         }
       }
     } else if( checknatoms<0 && noatoms ) {
@@ -764,36 +1182,38 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     if(!noatoms) {
       if(use_molfile) {
 #ifdef __PLUMED_HAS_MOLFILE_PLUGINS
-        if(pbc_cli_given==false) {
-          if(ts_in.A>0.0) { // this is negative if molfile does not provide box
-            // info on the cell: convert using pbcset.tcl from pbctools in vmd distribution
-            real cosBC=cos(real(ts_in.alpha)*pi/180.);
-            //double sinBC=sin(ts_in.alpha*pi/180.);
-            real cosAC=cos(real(ts_in.beta)*pi/180.);
-            real cosAB=cos(real(ts_in.gamma)*pi/180.);
-            real sinAB=sin(real(ts_in.gamma)*pi/180.);
-            real Ax=real(ts_in.A);
-            real Bx=real(ts_in.B)*cosAB;
-            real By=real(ts_in.B)*sinAB;
-            real Cx=real(ts_in.C)*cosAC;
-            real Cy=(real(ts_in.C)*real(ts_in.B)*cosBC-Cx*Bx)/By;
-            real Cz=sqrt(real(ts_in.C)*real(ts_in.C)-Cx*Cx-Cy*Cy);
-            cell[0]=Ax/10.; cell[1]=0.; cell[2]=0.;
-            cell[3]=Bx/10.; cell[4]=By/10.; cell[5]=0.;
-            cell[6]=Cx/10.; cell[7]=Cy/10.; cell[8]=Cz/10.;
+        if(process) {
+          if(pbc_cli_given==false) {
+            if(ts_ptr->A>0.0) { // this is negative if molfile does not provide box
+              // info on the cell: convert using pbcset.tcl from pbctools in vmd distribution
+              real cosBC=cos(real(ts_ptr->alpha)*pi/180.);
+              //double sinBC=sin(ts_ptr->alpha*pi/180.);
+              real cosAC=cos(real(ts_ptr->beta)*pi/180.);
+              real cosAB=cos(real(ts_ptr->gamma)*pi/180.);
+              real sinAB=sin(real(ts_ptr->gamma)*pi/180.);
+              real Ax=real(ts_ptr->A);
+              real Bx=real(ts_ptr->B)*cosAB;
+              real By=real(ts_ptr->B)*sinAB;
+              real Cx=real(ts_ptr->C)*cosAC;
+              real Cy=(real(ts_ptr->C)*real(ts_ptr->B)*cosBC-Cx*Bx)/By;
+              real Cz=sqrt(real(ts_ptr->C)*real(ts_ptr->C)-Cx*Cx-Cy*Cy);
+              cell[0]=Ax/10.; cell[1]=0.; cell[2]=0.;
+              cell[3]=Bx/10.; cell[4]=By/10.; cell[5]=0.;
+              cell[6]=Cx/10.; cell[7]=Cy/10.; cell[8]=Cz/10.;
+            } else {
+              cell[0]=0.0; cell[1]=0.0; cell[2]=0.0;
+              cell[3]=0.0; cell[4]=0.0; cell[5]=0.0;
+              cell[6]=0.0; cell[7]=0.0; cell[8]=0.0;
+            }
           } else {
-            cell[0]=0.0; cell[1]=0.0; cell[2]=0.0;
-            cell[3]=0.0; cell[4]=0.0; cell[5]=0.0;
-            cell[6]=0.0; cell[7]=0.0; cell[8]=0.0;
+            for(unsigned i=0; i<9; i++)cell[i]=pbc_cli_box[i];
+          }
+          // info on coords
+          // the order is xyzxyz...
+          for(int i=0; i<3*natoms; i++) {
+            coordinates[i]=real(ts_ptr->coords[i])/real(10.); //convert to nm
+            //cerr<<"COOR "<<coordinates[i]<<endl;
           }
-        } else {
-          for(unsigned i=0; i<9; i++)cell[i]=pbc_cli_box[i];
-        }
-        // info on coords
-        // the order is xyzxyz...
-        for(int i=0; i<3*natoms; i++) {
-          coordinates[i]=real(ts_in.coords[i])/real(10.); //convert to nm
-          //cerr<<"COOR "<<coordinates[i]<<endl;
         }
 #endif
       } else if(trajectory_fmt=="xdr-xtc" || trajectory_fmt=="xdr-trr") {
@@ -813,9 +1233,17 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
         for(int i=0; i<natoms; i++) for(unsigned j=0; j<3; j++)
             coordinates[3*i+j]=real(pos[i][j]);
 #endif
+      } else if(fcache_in) {
+// replay the frame from the binary sidecar cache, skipping the text parsing
+        std::vector<double> fbuf(9+3*static_cast<std::size_t>(natoms));
+        if(std::fread(&fbuf[0],sizeof(double),fbuf.size(),fcache_in)!=fbuf.size()) {
+          error("frame cache file " + fcache_name + " is truncated: delete it and run again");
+        }
+        for(unsigned i=0; i<9; i++) cell[i]=real(fbuf[i]);
+        for(int i=0; i<3*natoms; i++) coordinates[i]=real(fbuf[9+i]);
       } else {
         if(trajectory_fmt=="xyz") {
-          if(!Tools::getline(fp,line)) error("premature end of trajectory file");
+          if(!readline(line)) error("premature end of trajectory file");
 
           std::vector<double> celld(9,0.0);
           if(pbc_cli_given==false) {
@@ -837,11 +1265,11 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
         if(trajectory_fmt=="dlp4") {
           std::vector<double> celld(9,0.0);
           if(pbc_cli_given==false) {
-            if(!Tools::getline(fp,line)) error("error reading vector a of cell");
+            if(!readline(line)) error("error reading vector a of cell");
             sscanf(line.c_str(),"%lf %lf %lf",&celld[0],&celld[1],&celld[2]);
-            if(!Tools::getline(fp,line)) error("error reading vector b of cell");
+            if(!readline(line)) error("error reading vector b of cell");
             sscanf(line.c_str(),"%lf %lf %lf",&celld[3],&celld[4],&celld[5]);
-            if(!Tools::getline(fp,line)) error("error reading vector c of cell");
+            if(!readline(line)) error("error reading vector c of cell");
             sscanf(line.c_str(),"%lf %lf %lf",&celld[6],&celld[7],&celld[8]);
           } else {
             celld=pbc_cli_box;
@@ -851,13 +1279,20 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
         int ddist=0;
         // Read coordinates
         for(int i=0; i<natoms; i++) {
-          bool ok=Tools::getline(fp,line);
+          bool ok=readline(line);
           if(!ok) error("premature end of trajectory file");
+          if(!process) {
+// the frame belongs to another rank: consume its lines without parsing them
+            if(trajectory_fmt=="dlp4") {
+              if(!readline(line)) error("error reading coordinates");
+              if(lvl>0 && !readline(line)) error("error skipping velocities");
+              if(lvl>1 && !readline(line)) error("error skipping forces");
+            }
+            continue;
+          }
           double cc[3];
           if(trajectory_fmt=="xyz") {
-            char dummy[1000];
-            int ret=std::sscanf(line.c_str(),"%999s %100lf %100lf %100lf",dummy,&cc[0],&cc[1],&cc[2]);
-            if(ret!=4) error("cannot read line"+line);
+            if(!parseAtomLine(line.c_str(),cc)) error("cannot read line"+line);
           } else if(trajectory_fmt=="gro") {
             // do the gromacs way
             if(!i) {
@@ -874,9 +1309,17 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
               if (p3 == NULL)error("seems there are only two coordinates in the gro file");
               if (p3 - p2 != ddist)error("not uniform spacing in fields in the gro file");
             }
-            Tools::convert(line.substr(20,ddist),cc[0]);
-            Tools::convert(line.substr(20+ddist,ddist),cc[1]);
-            Tools::convert(line.substr(20+ddist+ddist,ddist),cc[2]);
+// parse the fixed-width fields in place, instead of extracting substrings
+// and converting them through a stringstream
+            char numbuf[64];
+            if(ddist<=0 || ddist>=static_cast<int>(sizeof(numbuf))) error("field width in the gro file looks wrong");
+            if(line.length()<static_cast<std::size_t>(20+3*ddist)) error("cannot read line"+line);
+            for(unsigned k=0; k<3; k++) {
+              std::memcpy(numbuf,line.c_str()+20+k*ddist,ddist); numbuf[ddist]='\0';
+              char* end=NULL;
+              cc[k]=std::strtod(numbuf,&end);
+              if(end==numbuf) error("cannot read line"+line);
+            }
           } else if(trajectory_fmt=="dlp4") {
             char dummy[9];
             int idummy;
@@ -884,16 +1327,16 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
             sscanf(line.c_str(),"%8s %d %lf %lf",dummy,&idummy,&m,&c);
             masses[i]=real(m);
             charges[i]=real(c);
-            if(!Tools::getline(fp,line)) error("error reading coordinates");
+            if(!readline(line)) error("error reading coordinates");
             sscanf(line.c_str(),"%lf %lf %lf",&cc[0],&cc[1],&cc[2]);
             cc[0]*=0.1;
             cc[1]*=0.1;
             cc[2]*=0.1;
             if(lvl>0) {
-              if(!Tools::getline(fp,line)) error("error skipping velocities");
+              if(!readline(line)) error("error skipping velocities");
             }
             if(lvl>1) {
-              if(!Tools::getline(fp,line)) error("error skipping forces");
+              if(!readline(line)) error("error skipping forces");
             }
           } else plumed_error();
           if(!debug_pd || ( i>=pd_start && i<pd_start+pd_nlocal) ) {
@@ -903,7 +1346,7 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
           }
         }
         if(trajectory_fmt=="gro") {
-          if(!Tools::getline(fp,line)) error("premature end of trajectory file");
+          if(!readline(line)) error("premature end of trajectory file");
           std::vector<string> words=Tools::getWords(line);
           if(words.size()<3) error("cannot understand box format");
           Tools::convert(words[0],cell[0]);
@@ -916,9 +1359,29 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
           if(words.size()>7) Tools::convert(words[7],cell[6]);
           if(words.size()>8) Tools::convert(words[8],cell[7]);
         }
+        if(fcache_out && (trajectory_fmt=="xyz" || trajectory_fmt=="gro")) {
+// append the frame that has just been parsed to the cache being built
+          const int32_t cached_natoms=natoms;
+          std::vector<double> fbuf(9+3*static_cast<std::size_t>(natoms));
+          for(unsigned i=0; i<9; i++) fbuf[i]=static_cast<double>(cell[i]);
+          for(int i=0; i<3*natoms; i++) fbuf[9+i]=static_cast<double>(coordinates[i]);
+          bool ok=std::fwrite(&cached_natoms,sizeof(cached_natoms),1,fcache_out)==1 &&
+                  std::fwrite(&fbuf[0],sizeof(double),fbuf.size(),fcache_out)==fbuf.size();
+          if(!ok) {
+            fprintf(out,"DRIVER: error writing the frame cache, giving up on it\n");
+            std::fclose(fcache_out); fcache_out=NULL; std::remove(fcache_tmpname.c_str());
+          }
+        }
 
       }
 
+      if(!process) {
+// the frame belongs to another rank
+        step+=stride;
+        frame++;
+        continue;
+      }
+
       p.cmd("setStepLong",&step);
       p.cmd("setStopFlag",&plumedStopCondition);
 
@@ -949,7 +1412,13 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
       p.cmd("setStepLong",&step);
       p.cmd("setStopFlag",&plumedStopCondition);
     }
+    if(perfcounters) perfc.start();
     p.cmd("calc");
+    if(perfcounters) {
+      perfc.stop();
+      fprintf(out,"DRIVER: perf frame %ld cycles %lld instructions %lld cache-refs %lld cache-miss %lld\n",
+              step,perfc.delta[0],perfc.delta[1],perfc.delta[2],perfc.delta[3]);
+    }
     if(debugforces.length()>0) {
       virial.assign(9,real(0.0));
       forces.assign(3*natoms,real(0.0));
@@ -958,7 +1427,7 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     }
 
 // this is necessary as only processor zero is adding to the virial:
-    intracomm.Bcast(virial,0);
+    if(!scatter) intracomm.Bcast(virial,0);
     if(debug_pd) intracomm.Sum(forces);
     if(debug_dd) {
       for(int i=0; i<dd_nlocal; i++) {
@@ -1032,16 +1501,33 @@ int Driver<real>::main(FILE* in,FILE*out,Communicator& pc) {
     if(plumedStopCondition) break;
 
     step+=stride;
+    frame++;
   }
   if(!parseOnly) p.cmd("runFinalJobs");
 
+  if(perfcounters && frame>0) {
+    const double ipc = perfc.total[0]>0 ? static_cast<double>(perfc.total[1])/static_cast<double>(perfc.total[0]) : 0.0;
+    const double missrate = perfc.total[2]>0 ? 100.0*static_cast<double>(perfc.total[3])/static_cast<double>(perfc.total[2]) : 0.0;
+    fprintf(out,"DRIVER: perf total over %ld frames: cycles %lld instructions %lld (%.2f ipc) cache-refs %lld cache-miss %lld (%.1f%% miss)\n",
+            frame,perfc.total[0],perfc.total[1],ipc,perfc.total[2],perfc.total[3],missrate);
+  }
+
+  if(fcache_in) std::fclose(fcache_in);
+  if(fcache_out) {
+    std::fclose(fcache_out);
+// the cache is moved in place only when the whole trajectory was parsed,
+// so that an interrupted run never leaves a partial sidecar behind
+    if(!fcache_complete || std::rename(fcache_tmpname.c_str(),fcache_name.c_str())!=0) std::remove(fcache_tmpname.c_str());
+  }
   if(fp_forces) fclose(fp_forces);
   if(debugforces.length()>0) fp_dforces.close();
+  linePrefetcher.reset();
   if(fp && fp!=in)fclose(fp);
 #ifdef __PLUMED_HAS_XDRFILE
   if(xd) xdrfile_close(xd);
 #endif
 #ifdef __PLUMED_HAS_MOLFILE_PLUGINS
+  molfilePrefetcher.reset();
   if(h_in) api->close_file_read(h_in);
 #endif
   if(grex_log) fclose(grex_log);
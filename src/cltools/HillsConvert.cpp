@@ -0,0 +1,328 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2013-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "CLTool.h"
+#include "CLToolRegister.h"
+#include "tools/IFile.h"
+#include "tools/OFile.h"
+#include "tools/Tools.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace PLMD {
+namespace cltools {
+
+//+PLUMEDOC TOOLS hills_convert
+/*
+Convert metadynamics HILLS files between the text and the binary format.
+
+When \ref METAD is used with the BINARY_HILLS flag the hills are stored in
+a fixed-record binary file instead of the usual text format. This command
+converts a file from one format to the other, so that e.g. a binary file
+can be post-processed with \ref sum_hills, or a text file from an old run
+can be reused to restart a simulation that stores its hills in binary form.
+The direction of the conversion is detected automatically from the input
+file.
+
+Notice that the binary format stores exactly the numbers that would be
+printed in the text format, so the conversion does not involve any
+arithmetics. The only loss of precision happens when writing the text
+output, where the numbers are formatted with a finite number of digits
+that can be adjusted with the --fmt option.
+
+\par Examples
+
+Convert a binary HILLS file to the text format:
+\verbatim
+> plumed hills_convert --in HILLS --out HILLS.txt
+\endverbatim
+
+Convert a text HILLS file to the binary format, e.g. to restart
+with BINARY_HILLS:
+\verbatim
+> plumed hills_convert --in HILLS.txt --out HILLS
+\endverbatim
+
+*/
+//+ENDPLUMEDOC
+
+namespace {
+
+/// The magic marker and the header/record layout below must match the ones
+/// used by METAD with the BINARY_HILLS flag (see src/bias/MetaD.cpp)
+const char binary_hills_magic[8]={'P','L','M','D','H','I','L','B'};
+const int32_t binary_hills_version=1;
+
+void writeBinaryInt(FILE* fp, int32_t i) {
+  std::fwrite(&i,sizeof(i),1,fp);
+}
+
+bool readBinaryInt(FILE* fp, int32_t & i) {
+  return std::fread(&i,sizeof(i),1,fp)==1;
+}
+
+void writeBinaryString(FILE* fp, const std::string & s) {
+  writeBinaryInt(fp,s.length());
+  std::fwrite(s.c_str(),1,s.length(),fp);
+}
+
+bool readBinaryString(FILE* fp, std::string & s) {
+  int32_t len;
+  if(!readBinaryInt(fp,len) || len<0) return false;
+  std::vector<char> buf(len);
+  if(len>0 && std::fread(&buf[0],1,len,fp)!=static_cast<size_t>(len)) return false;
+  s.assign(buf.begin(),buf.end());
+  return true;
+}
+
+}
+
+class HillsConvert:
+  public CLTool
+{
+public:
+  static void registerKeywords( Keywords& keys );
+  explicit HillsConvert(const CLToolOptions& co );
+  int main(FILE* in, FILE*out,Communicator& pc) override;
+  string description()const override {
+    return "convert metadynamics HILLS files between the text and the binary format";
+  }
+private:
+  int convertToText(const std::string& ifname, const std::string& ofname, const std::string& fmt, FILE* out);
+  int convertToBinary(const std::string& ifname, const std::string& ofname, FILE* out);
+};
+
+PLUMED_REGISTER_CLTOOL(HillsConvert,"hills_convert")
+
+void HillsConvert::registerKeywords( Keywords& keys ) {
+  CLTool::registerKeywords( keys );
+  keys.add("compulsory","--in","specify the name of the input HILLS file, in either format");
+  keys.add("compulsory","--out","specify the name of the output HILLS file, in the other format");
+  keys.add("optional","--fmt","the format with which the numbers are written when converting to text");
+}
+
+HillsConvert::HillsConvert(const CLToolOptions& co ):
+  CLTool(co)
+{
+  inputdata=commandline;
+}
+
+int HillsConvert::main(FILE* in, FILE*out,Communicator& pc) {
+
+  std::string ifname;
+  parse("--in",ifname);
+  std::string ofname;
+  parse("--out",ofname);
+  std::string fmt;
+  parse("--fmt",fmt);
+
+  plumed_assert(ifname.length()>0) << "please specify the input file with --in";
+  plumed_assert(ofname.length()>0) << "please specify the output file with --out";
+
+  // detect the format of the input from the magic marker
+  FILE* fp=std::fopen(ifname.c_str(),"rb");
+  plumed_assert(fp) << "cannot open file " << ifname;
+  char magic[8];
+  bool binary=(std::fread(magic,1,8,fp)==8 && std::memcmp(magic,binary_hills_magic,8)==0);
+  std::fclose(fp);
+
+  if(binary) return convertToText(ifname,ofname,fmt,out);
+  else return convertToBinary(ifname,ofname,out);
+}
+
+int HillsConvert::convertToText(const std::string& ifname, const std::string& ofname, const std::string& fmt, FILE* out) {
+  fprintf(out,"  converting binary file %s to text file %s\n",ifname.c_str(),ofname.c_str());
+
+  FILE* fp=std::fopen(ifname.c_str(),"rb");
+  plumed_assert(fp) << "cannot open file " << ifname;
+
+  // parse the header
+  char magic[8];
+  int32_t version=0, incv=0, doint=0;
+  double bounds[2];
+  bool ok=(std::fread(magic,1,8,fp)==8);
+  ok=ok && readBinaryInt(fp,version) && readBinaryInt(fp,incv) && readBinaryInt(fp,doint);
+  ok=ok && std::fread(bounds,sizeof(double),2,fp)==2;
+  plumed_assert(ok && incv>0) << "cannot read the header of binary hills file " << ifname;
+  plumed_assert(version==binary_hills_version) << "unknown version of binary hills file " << ifname;
+  const unsigned ncv=incv;
+  const unsigned nsig=ncv*(ncv+1)/2;
+  std::vector<std::string> names(ncv), pmin(ncv), pmax(ncv);
+  std::vector<bool> periodic(ncv);
+  for(unsigned i=0; i<ncv; ++i) {
+    int32_t p=0;
+    ok=readBinaryString(fp,names[i]) && readBinaryInt(fp,p) && readBinaryString(fp,pmin[i]) && readBinaryString(fp,pmax[i]);
+    plumed_assert(ok) << "cannot read the header of binary hills file " << ifname;
+    periodic[i]=(p!=0);
+  }
+
+  OFile ofile;
+  ofile.open(ofname);
+  if(fmt.length()>0) ofile.fmtField(fmt);
+  ofile.addConstantField("multivariate");
+  ofile.addConstantField("kerneltype");
+  if(doint) {
+    ofile.addConstantField("lower_int").printField("lower_int",bounds[0]);
+    ofile.addConstantField("upper_int").printField("upper_int",bounds[1]);
+  }
+  for(unsigned i=0; i<ncv; ++i) {
+    if(periodic[i]) {
+      ofile.addConstantField("min_"+names[i]);
+      ofile.addConstantField("max_"+names[i]);
+    }
+  }
+
+  // reformat the fixed-size records one by one
+  const unsigned recsize=4+ncv+nsig;
+  std::vector<double> rec(recsize);
+  unsigned long nhills=0;
+  while(std::fread(&rec[0],sizeof(double),recsize,fp)==recsize) {
+    bool multivariate=rec[1]>0.5;
+    ofile.printField("time",rec[0]);
+    for(unsigned i=0; i<ncv; ++i) {
+      ofile.printField(names[i],rec[2+i]);
+      if(periodic[i]) {
+        ofile.printField("min_"+names[i],pmin[i]);
+        ofile.printField("max_"+names[i],pmax[i]);
+      }
+    }
+    ofile.printField("kerneltype","gaussian");
+    if(multivariate) {
+      ofile.printField("multivariate","true");
+      // band order, as written by METAD
+      unsigned k=0;
+      for(unsigned i=0; i<ncv; i++) {
+        for(unsigned j=0; j<ncv-i; j++) {
+          ofile.printField("sigma_"+names[j+i]+"_"+names[j],rec[2+ncv+k]);
+          k++;
+        }
+      }
+    } else {
+      ofile.printField("multivariate","false");
+      for(unsigned i=0; i<ncv; ++i) ofile.printField("sigma_"+names[i],rec[2+ncv+i]);
+    }
+    ofile.printField("height",rec[2+ncv+nsig]).printField("biasf",rec[3+ncv+nsig]);
+    ofile.printField();
+    nhills++;
+  }
+  std::fclose(fp);
+  fprintf(out,"  %lu hills converted\n",nhills);
+
+  return 0;
+}
+
+int HillsConvert::convertToBinary(const std::string& ifname, const std::string& ofname, FILE* out) {
+  fprintf(out,"  converting text file %s to binary file %s\n",ifname.c_str(),ofname.c_str());
+
+  IFile ifile;
+  ifile.open(ifname);
+  // fields such as clock are not stored in the binary format
+  ifile.allowIgnoredFields();
+
+  // derive the variable names from the field list: they sit between
+  // the time field and the first sigma field
+  std::vector<std::string> fields;
+  ifile.scanFieldList(fields);
+  plumed_assert(fields.size()>1 && fields[0]=="time") << "file " << ifname << " does not look like a HILLS file";
+  std::vector<std::string> names, signames;
+  for(unsigned i=1; i<fields.size(); ++i) {
+    if(fields[i].compare(0,6,"sigma_")==0) break;
+    names.push_back(fields[i]);
+  }
+  for(unsigned i=0; i<fields.size(); ++i) {
+    if(fields[i].compare(0,6,"sigma_")==0) signames.push_back(fields[i]);
+  }
+  const unsigned ncv=names.size();
+  const unsigned nsig=ncv*(ncv+1)/2;
+  plumed_assert(ncv>0 && (signames.size()==ncv || signames.size()==nsig))
+      << "cannot derive the variable names from the fields of " << ifname;
+  const bool doint=ifile.FieldExist("lower_int");
+
+  FILE* fp=std::fopen(ofname.c_str(),"wb");
+  plumed_assert(fp) << "cannot open file " << ofname;
+
+  const unsigned recsize=4+ncv+nsig;
+  std::vector<double> rec(recsize);
+  unsigned long nhills=0;
+  double time;
+  while(ifile.scanField("time",time)) {
+    for(unsigned i=0; i<recsize; ++i) rec[i]=0.0;
+    rec[0]=time;
+    for(unsigned i=0; i<ncv; ++i) ifile.scanField(names[i],rec[2+i]);
+    std::string ktype="gaussian";
+    if(ifile.FieldExist("kerneltype")) ifile.scanField("kerneltype",ktype);
+    plumed_assert(ktype=="gaussian") << "only gaussian kernels can be converted";
+    std::string mvs="false";
+    if(ifile.FieldExist("multivariate")) ifile.scanField("multivariate",mvs);
+    plumed_assert(mvs=="true" || mvs=="false") << "cannot parse multivariate = " << mvs;
+    rec[1]=(mvs=="true")?1.0:0.0;
+    plumed_assert(mvs=="false" || signames.size()==nsig)
+        << "multivariate hills in " << ifname << " carry an unexpected number of sigma fields";
+    for(unsigned k=0; k<signames.size(); ++k) ifile.scanField(signames[k],rec[2+ncv+k]);
+    ifile.scanField("height",rec[2+ncv+nsig]);
+    ifile.scanField("biasf",rec[3+ncv+nsig]);
+
+    if(nhills==0) {
+      // the header can only be written once the constant fields of the
+      // first record are available
+      std::fwrite(binary_hills_magic,1,8,fp);
+      writeBinaryInt(fp,binary_hills_version);
+      writeBinaryInt(fp,ncv);
+      writeBinaryInt(fp,doint?1:0);
+      double bounds[2]= {0.0,0.0};
+      if(doint) {
+        ifile.scanField("lower_int",bounds[0]);
+        ifile.scanField("upper_int",bounds[1]);
+      }
+      std::fwrite(bounds,sizeof(double),2,fp);
+      for(unsigned i=0; i<ncv; ++i) {
+        writeBinaryString(fp,names[i]);
+        std::string pmin, pmax;
+        if(ifile.FieldExist("min_"+names[i])) {
+          ifile.scanField("min_"+names[i],pmin);
+          ifile.scanField("max_"+names[i],pmax);
+          writeBinaryInt(fp,1);
+        } else {
+          writeBinaryInt(fp,0);
+        }
+        writeBinaryString(fp,pmin);
+        writeBinaryString(fp,pmax);
+      }
+    }
+
+    ifile.scanField();
+    std::fwrite(&rec[0],sizeof(double),recsize,fp);
+    nhills++;
+  }
+  std::fclose(fp);
+  fprintf(out,"  %lu hills converted\n",nhills);
+
+  return 0;
+}
+
+}
+
+} // End of namespace
@@ -0,0 +1,246 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "CLTool.h"
+#include "CLToolRegister.h"
+#include "core/PlumedMain.h"
+#include "tools/Tools.h"
+#include "tools/OpenMP.h"
+#include "tools/Communicator.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace PLMD {
+namespace cltools {
+
+//+PLUMEDOC TOOLS multidriver
+/*
+multidriver processes many trajectories concurrently with the same plumed input
+
+Unlike \ref driver, which analyzes one trajectory per invocation, this
+tool takes a file listing any number of xyz trajectories and works
+through them with a pool of threads, one independent plumed instance per
+trajectory.  All instances read the same plumed input, so the parsed
+input cache is primed once and reused, and the per-trajectory setup cost
+is overlapped with the frame processing of the other threads.  Output
+files written by each instance get the suffix ".i", where i is the
+zero-based position of the trajectory in the list, in the same way as
+the file suffixes used for multiple replicas.
+
+The trajectories must be in xyz format.  As in \ref driver, the comment
+line of each frame may contain either 3 or 9 numbers giving the cell.
+Masses and charges default to 1 and 0 and can be assigned with --mc,
+which takes a file with one line per atom containing index, mass and
+charge, as written by \ref DUMPMASSCHARGE.
+
+\par Examples
+
+\verbatim
+ls traj_*.xyz > list.txt
+plumed multidriver --plumed plumed.dat --trajectory-list list.txt --nt 8
+\endverbatim
+
+*/
+//+ENDPLUMEDOC
+
+class MultiDriver:
+  public CLTool
+{
+public:
+  static void registerKeywords( Keywords& keys );
+  explicit MultiDriver(const CLToolOptions& co );
+  int main(FILE* in, FILE*out,Communicator& pc) override;
+  string description()const override {
+    return "analyze many trajectories concurrently with the same plumed input";
+  }
+private:
+/// Process one trajectory with its own plumed instance; returns false on error
+  bool processTrajectory( const std::string& traj, const unsigned itraj );
+/// Serializes instance creation and parsing: the registries and input
+/// caches shared by all instances are not audited for concurrent setup
+  std::mutex initMutex;
+  std::string plumedFile;
+  double timestep;
+  std::vector<double> masses, charges;
+};
+
+PLUMED_REGISTER_CLTOOL(MultiDriver,"multidriver")
+
+void MultiDriver::registerKeywords( Keywords& keys ) {
+  CLTool::registerKeywords( keys );
+  keys.add("compulsory","--plumed","plumed.dat","the plumed input file");
+  keys.add("compulsory","--trajectory-list","a file with the path of one xyz trajectory per line");
+  keys.add("compulsory","--nt","0","the number of worker threads; 0 means the number of OpenMP threads");
+  keys.add("compulsory","--timestep","1.0","the timestep for the trajectory frames");
+  keys.add("optional","--mc","a file with one line per atom containing index, mass and charge, as written by DUMPMASSCHARGE");
+}
+
+MultiDriver::MultiDriver(const CLToolOptions& co ):
+  CLTool(co),
+  timestep(1.0)
+{
+  inputdata=commandline;
+}
+
+bool MultiDriver::processTrajectory( const std::string& traj, const unsigned itraj ) {
+  FILE* fp=std::fopen(traj.c_str(),"r");
+  if(!fp) {
+    std::fprintf(stderr,"ERROR: cannot open trajectory %s\n",traj.c_str());
+    return false;
+  }
+  std::string suffix; Tools::convert(int(itraj),suffix); suffix="."+suffix;
+
+  std::unique_ptr<PlumedMain> p;
+  int natoms=-1;
+  std::vector<double> positions, forces, box(9), virial(9);
+  std::vector<double> mass, charge;
+
+  bool ok=true; long long step=0; std::string line;
+  while( Tools::getline(fp,line) ) {
+    int nat=0;
+    if( !Tools::convert(line,nat) || nat<=0 ) { ok=false; break; }
+    if( natoms<0 ) {
+      natoms=nat;
+      positions.resize(3*natoms); forces.resize(3*natoms);
+      mass.assign(natoms,1.0); charge.assign(natoms,0.0);
+      if( !masses.empty() ) {
+        if( masses.size()!=static_cast<unsigned>(natoms) ) { ok=false; break; }
+        mass=masses; charge=charges;
+      }
+      // setup of the instance is serialized, see initMutex
+      std::lock_guard<std::mutex> lock(initMutex);
+      p.reset(new PlumedMain);
+      p->cmd("setMDEngine","multidriver");
+      p->cmd("setSuffix",suffix.c_str());
+      p->cmd("setLogFile",("multidriver.log"+suffix).c_str());
+      p->cmd("setTimestep",&timestep);
+      p->cmd("setNatoms",&natoms);
+      p->cmd("setPlumedDat",plumedFile.c_str());
+      p->cmd("init");
+    } else if( nat!=natoms ) { ok=false; break; }
+    // the comment line may carry the cell
+    if( !Tools::getline(fp,line) ) { ok=false; break; }
+    std::vector<std::string> celld=Tools::getWords(line);
+    for(unsigned i=0; i<9; i++) box[i]=0.0;
+    if( celld.size()==3 ) {
+      for(unsigned i=0; i<3; i++) if( !Tools::convert(celld[i],box[4*i]) ) { ok=false; break; }
+    } else if( celld.size()==9 ) {
+      for(unsigned i=0; i<9; i++) if( !Tools::convert(celld[i],box[i]) ) { ok=false; break; }
+    }
+    if(!ok) break;
+    for(int i=0; i<natoms && ok; i++) {
+      if( !Tools::getline(fp,line) ) { ok=false; break; }
+      std::vector<std::string> w=Tools::getWords(line);
+      if( w.size()<4 ) { ok=false; break; }
+      for(unsigned k=0; k<3; k++) if( !Tools::convert(w[k+1],positions[3*i+k]) ) { ok=false; break; }
+    }
+    if(!ok) break;
+    for(unsigned i=0; i<forces.size(); i++) forces[i]=0.0;
+    for(unsigned i=0; i<9; i++) virial[i]=0.0;
+    p->cmd("setStep",&step);
+    p->cmd("setMasses",mass.data());
+    p->cmd("setCharges",charge.data());
+    p->cmd("setPositions",positions.data());
+    p->cmd("setBox",box.data());
+    p->cmd("setForces",forces.data());
+    p->cmd("setVirial",virial.data());
+    p->cmd("calc");
+    step++;
+  }
+  std::fclose(fp);
+  if(!ok) std::fprintf(stderr,"ERROR: trajectory %s is misformatted at frame %lld\n",traj.c_str(),step);
+  // destruction flushes the output files of this instance; it touches the
+  // same shared state as creation, hence the same lock
+  std::lock_guard<std::mutex> lock(initMutex);
+  p.reset();
+  return ok;
+}
+
+int MultiDriver::main(FILE* in, FILE*out,Communicator& pc) {
+
+  parse("--plumed",plumedFile);
+  std::string listFile; parse("--trajectory-list",listFile);
+  unsigned nt; parse("--nt",nt);
+  parse("--timestep",timestep);
+  std::string mcFile; parse("--mc",mcFile);
+
+  if( nt==0 ) nt=OpenMP::getNumThreads();
+
+  std::vector<std::string> trajectories;
+  {
+    FILE* fp=std::fopen(listFile.c_str(),"r");
+    if(!fp) { std::fprintf(stderr,"ERROR: cannot open trajectory list %s\n",listFile.c_str()); return 1; }
+    std::string line;
+    while( Tools::getline(fp,line) ) {
+      Tools::trim(line);
+      if( line.length()>0 ) trajectories.push_back(line);
+    }
+    std::fclose(fp);
+  }
+  if( trajectories.empty() ) { std::fprintf(stderr,"ERROR: trajectory list %s is empty\n",listFile.c_str()); return 1; }
+  if( nt>trajectories.size() ) nt=trajectories.size();
+
+  if( mcFile.length()>0 ) {
+    FILE* fp=std::fopen(mcFile.c_str(),"r");
+    if(!fp) { std::fprintf(stderr,"ERROR: cannot open %s\n",mcFile.c_str()); return 1; }
+    std::string line;
+    while( Tools::getline(fp,line) ) {
+      std::vector<std::string> w=Tools::getWords(line);
+      if( w.empty() || w[0][0]=='#' ) continue;
+      if( w.size()<3 ) { std::fprintf(stderr,"ERROR: %s is misformatted\n",mcFile.c_str()); std::fclose(fp); return 1; }
+      int index; double m,c;
+      if( !Tools::convert(w[0],index) || !Tools::convert(w[1],m) || !Tools::convert(w[2],c) ) { std::fprintf(stderr,"ERROR: %s is misformatted\n",mcFile.c_str()); std::fclose(fp); return 1; }
+      if( masses.size()<static_cast<unsigned>(index+1) ) { masses.resize(index+1,1.0); charges.resize(index+1,0.0); }
+      masses[index]=m; charges[index]=c;
+    }
+    std::fclose(fp);
+  }
+
+  std::fprintf(out,"Processing %zu trajectories with %u threads\n",trajectories.size(),nt);
+
+  std::atomic<unsigned> next(0);
+  std::atomic<unsigned> failures(0);
+  std::vector<std::thread> workers;
+  for(unsigned t=0; t<nt; t++) {
+    workers.emplace_back([&]() {
+      for(unsigned i=next++; i<trajectories.size(); i=next++) {
+        if( !processTrajectory(trajectories[i],i) ) failures++;
+      }
+    });
+  }
+  for(auto & w : workers) w.join();
+
+  if( failures>0 ) {
+    std::fprintf(stderr,"ERROR: %u trajectories could not be processed\n",unsigned(failures));
+    return 1;
+  }
+  return 0;
+}
+
+}
+}
@@ -24,11 +24,13 @@
 #include "core/PlumedMain.h"
 #include "tools/Vector.h"
 #include "tools/Random.h"
+#include "tools/OpenMP.h"
 #include <string>
 #include <cstdio>
 #include <cmath>
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 using namespace std;
 
@@ -71,6 +73,10 @@ input file will be output.
 plumed simplemd --help
 \endverbatim
 
+The neighbour list is built with a cell list and the force loop is
+parallelized with OpenMP, so large systems can be run at a realistic
+speed; set PLUMED_NUM_THREADS to control the number of threads.
+
 */
 //+ENDPLUMEDOC
 
@@ -263,12 +269,76 @@ private:
   void compute_list(const int natoms,const int listsize,const vector<Vector>& positions,const double cell[3],const double listcutoff,
                     vector<int>& point,vector<int>& list) {
 // see Allen-Tildesey for a definition of point and list
-    Vector distance;     // distance of the two atoms
-    Vector distance_pbc; // minimum-image distance of the two atoms
     double listcutoff2;  // squared list cutoff
     listcutoff2=listcutoff*listcutoff;
+
+// number of cells per direction; the cell-list pass needs at least three
+// cells per direction, otherwise the same periodic image would be visited
+// twice, so small boxes fall back on the quadratic scan below
+    int nc[3];
+    for(int k=0; k<3; k++) nc[k]=std::max(1,int(cell[k]/listcutoff));
+    if(nc[0]>=3 && nc[1]>=3 && nc[2]>=3) {
+// bin the atoms on the cell grid through the usual linked chains;
+// binning uses wrapped coordinates, distances below use the minimum image
+// so unwrapped trajectories are handled correctly
+      const int ncells=nc[0]*nc[1]*nc[2];
+      vector<int> head(ncells,-1), next(natoms), icell(natoms);
+      for(int iatom=0; iatom<natoms; iatom++) {
+        int ix[3];
+        for(int k=0; k<3; k++) {
+          double s=positions[iatom][k]/cell[k];
+          s-=floor(s);
+          ix[k]=std::min(nc[k]-1,int(s*nc[k]));
+        }
+        const int ci=(ix[2]*nc[1]+ix[1])*nc[0]+ix[0];
+        icell[iatom]=ci; next[iatom]=head[ci]; head[ci]=iatom;
+      }
+// count the neighbours of every atom scanning the 27 surrounding cells,
+// then fill the list in a second pass; both passes are parallel since
+// every atom writes its own segment of the list
+      vector<int> count(natoms,0);
+      for(int pass=0; pass<2; pass++) {
+        #pragma omp parallel for schedule(static)
+        for(int iatom=0; iatom<natoms; iatom++) {
+          const int ci=icell[iatom];
+          const int ix=ci%nc[0], iy=(ci/nc[0])%nc[1], iz=ci/(nc[0]*nc[1]);
+          int found=0;
+          Vector distance, distance_pbc;
+          for(int dz=-1; dz<=1; dz++) for(int dy=-1; dy<=1; dy++) for(int dx=-1; dx<=1; dx++) {
+                const int jx=(ix+dx+nc[0])%nc[0];
+                const int jy=(iy+dy+nc[1])%nc[1];
+                const int jz=(iz+dz+nc[2])%nc[2];
+                for(int jatom=head[(jz*nc[1]+jy)*nc[0]+jx]; jatom>=0; jatom=next[jatom]) {
+                  if(jatom<=iatom) continue;
+                  for(int k=0; k<3; k++) distance[k]=positions[iatom][k]-positions[jatom][k];
+                  pbc(cell,distance,distance_pbc);
+                  double d2=0; for(int k=0; k<3; k++) d2+=distance_pbc[k]*distance_pbc[k];
+                  if(d2>listcutoff2) continue;
+                  if(pass==1) list[point[iatom]+found]=jatom;
+                  found++;
+                }
+              }
+          if(pass==0) count[iatom]=found;
+        }
+        if(pass==0) {
+          point[0]=0;
+          for(int iatom=0; iatom<natoms; iatom++) point[iatom+1]=point[iatom]+count[iatom];
+          if(point[natoms]>listsize) {
+// too many neighbours
+            fprintf(stderr,"%s","Verlet list size exceeded\n");
+            fprintf(stderr,"%s","Increase maxneighbours\n");
+            exit(1);
+          }
+        }
+      }
+      return;
+    }
+
+// quadratic fallback for boxes with less than three cells per direction
+    Vector distance;     // distance of the two atoms
+    Vector distance_pbc; // minimum-image distance of the two atoms
     point[0]=0;
-    for(int iatom=0; iatom<natoms-1; iatom++) {
+    for(int iatom=0; iatom<natoms; iatom++) {
       point[iatom+1]=point[iatom];
       for(int jatom=iatom+1; jatom<natoms; jatom++) {
         for(int k=0; k<3; k++) distance[k]=positions[iatom][k]-positions[jatom][k];
@@ -291,34 +361,51 @@ private:
   void compute_forces(const int natoms,const int listsize,const vector<Vector>& positions,const double cell[3],
                       double forcecutoff,const vector<int>& point,const vector<int>& list,vector<Vector>& forces,double & engconf)
   {
-    Vector distance;        // distance of the two atoms
-    Vector distance_pbc;    // minimum-image distance of the two atoms
-    double distance_pbc2;   // squared minimum-image distance
     double forcecutoff2;    // squared force cutoff
-    Vector f;               // force
     double engcorrection;   // energy necessary shift the potential avoiding discontinuities
 
     forcecutoff2=forcecutoff*forcecutoff;
     engconf=0.0;
     for(int i=0; i<natoms; i++)for(int k=0; k<3; k++) forces[i][k]=0.0;
     engcorrection=4.0*(1.0/pow(forcecutoff2,6.0)-1.0/pow(forcecutoff2,3));
-    for(int iatom=0; iatom<natoms-1; iatom++) {
-      for(int jlist=point[iatom]; jlist<point[iatom+1]; jlist++) {
-        int jatom=list[jlist];
-        for(int k=0; k<3; k++) distance[k]=positions[iatom][k]-positions[jatom][k];
-        pbc(cell,distance,distance_pbc);
-        distance_pbc2=0.0; for(int k=0; k<3; k++) distance_pbc2+=distance_pbc[k]*distance_pbc[k];
+// the pair loop is distributed over the threads; every thread accumulates
+// the Newton reaction forces on a private array which is reduced at the end,
+// so the half list can be kept
+    const unsigned nt=OpenMP::getNumThreads();
+    #pragma omp parallel num_threads(nt)
+    {
+      Vector distance;        // distance of the two atoms
+      Vector distance_pbc;    // minimum-image distance of the two atoms
+      double distance_pbc2;   // squared minimum-image distance
+      Vector f;               // force
+      vector<Vector> omp_forces;
+      if(nt>1) omp_forces.assign(natoms,Vector());
+      vector<Vector> & myforces=(nt>1)?omp_forces:forces;
+      double eng=0.0;
+      #pragma omp for schedule(static) nowait
+      for(int iatom=0; iatom<natoms; iatom++) {
+        for(int jlist=point[iatom]; jlist<point[iatom+1]; jlist++) {
+          int jatom=list[jlist];
+          for(int k=0; k<3; k++) distance[k]=positions[iatom][k]-positions[jatom][k];
+          pbc(cell,distance,distance_pbc);
+          distance_pbc2=0.0; for(int k=0; k<3; k++) distance_pbc2+=distance_pbc[k]*distance_pbc[k];
 // if the interparticle distance is larger than the cutoff, skip
-        if(distance_pbc2>forcecutoff2) continue;
-        double distance_pbc6=distance_pbc2*distance_pbc2*distance_pbc2;
-        double distance_pbc8=distance_pbc6*distance_pbc2;
-        double distance_pbc12=distance_pbc6*distance_pbc6;
-        double distance_pbc14=distance_pbc12*distance_pbc2;
-        engconf+=4.0*(1.0/distance_pbc12 - 1.0/distance_pbc6) - engcorrection;
-        for(int k=0; k<3; k++) f[k]=2.0*distance_pbc[k]*4.0*(6.0/distance_pbc14-3.0/distance_pbc8);
+          if(distance_pbc2>forcecutoff2) continue;
+          double distance_pbc6=distance_pbc2*distance_pbc2*distance_pbc2;
+          double distance_pbc8=distance_pbc6*distance_pbc2;
+          double distance_pbc12=distance_pbc6*distance_pbc6;
+          double distance_pbc14=distance_pbc12*distance_pbc2;
+          eng+=4.0*(1.0/distance_pbc12 - 1.0/distance_pbc6) - engcorrection;
+          for(int k=0; k<3; k++) f[k]=2.0*distance_pbc[k]*4.0*(6.0/distance_pbc14-3.0/distance_pbc8);
 // same force on the two atoms, with opposite sign:
-        for(int k=0; k<3; k++) forces[iatom][k]+=f[k];
-        for(int k=0; k<3; k++) forces[jatom][k]-=f[k];
+          for(int k=0; k<3; k++) myforces[iatom][k]+=f[k];
+          for(int k=0; k<3; k++) myforces[jatom][k]-=f[k];
+        }
+      }
+      #pragma omp critical
+      {
+        if(nt>1) for(int i=0; i<natoms; i++) forces[i]+=omp_forces[i];
+        engconf+=eng;
       }
     }
   }
@@ -505,7 +592,7 @@ private:
     velocities.resize(natoms);
     forces.resize(natoms);
     masses.resize(natoms);
-    point.resize(natoms);
+    point.resize(natoms+1);
     list.resize(listsize);
 
 // masses are hard-coded to 1
@@ -540,7 +627,7 @@ private:
 // neighbour list are computed, and reference positions are saved
     compute_list(natoms,listsize,positions,cell,listcutoff,point,list);
 
-    fprintf(out,"List size: %d\n",point[natoms-1]);
+    fprintf(out,"List size: %d\n",point[natoms]);
     for(int iatom=0; iatom<natoms; ++iatom) for(int k=0; k<3; ++k) positions0[iatom][k]=positions[iatom][k];
 
 // forces are computed before starting md
@@ -576,7 +663,7 @@ private:
         compute_list(natoms,listsize,positions,cell,listcutoff,point,list);
         for(int iatom=0; iatom<natoms; ++iatom) for(int k=0; k<3; ++k) positions0[iatom][k]=positions[iatom][k];
         fprintf(out,"Neighbour list recomputed at step %d\n",istep);
-        fprintf(out,"List size: %d\n",point[natoms-1]);
+        fprintf(out,"List size: %d\n",point[natoms]);
       }
 
       compute_forces(natoms,listsize,positions,cell,forcecutoff,point,list,forces,engconf);
@@ -145,6 +145,18 @@ plumed sum_hills --histo PATHTOMYCOLVARORHILLSFILE  --sigma 0.2,0.2 --kt 0.6 --n
 just to check the hypothetical free energy calculated in single blocks of time during a simulation
 and not in a cumulative way
 
+If all your hills have the same width you can sum them in Fourier space
+
+\verbatim
+plumed sum_hills --hills PATHTOMYHILLSFILE --fft
+\endverbatim
+
+here the hill centers are histogrammed on the grid and convolved with the Gaussian
+kernel with FFTs (this requires PLUMED to be compiled with FFTW): with millions of
+hills this is orders of magnitude faster than the direct summation. Note that each
+center is deposited on the nearest grid point, so the grid spacing should be small
+compared to the hill width.
+
 Output format can be controlled via the --fmt field
 
 \verbatim
@@ -215,6 +227,7 @@ void CLToolSumHills::registerKeywords( Keywords& keys ) {
   keys.addFlag("--negbias",false," print the negative bias instead of the free energy (only needed with well tempered runs and flexible hills) ");
   keys.addFlag("--nohistory",false," to be used with --stride:  it splits the bias/histogram in pieces without previous history ");
   keys.addFlag("--mintozero",false," it translate all the minimum value in bias/histogram to zero (useful to compare results) ");
+  keys.addFlag("--fft",false," sum the hills in fourier space: requires FFTW and hills of uniform width, see the manual ");
   keys.add("optional","--fmt","specify the output format");
 }
 
@@ -482,6 +495,11 @@ int CLToolSumHills::main(FILE* in,FILE*out,Communicator& pc) {
   if(mintozero) {
     actioninput.push_back("MINTOZERO");
   }
+  bool  dofft;
+  parseFlag("--fft",dofft);
+  if(dofft) {
+    actioninput.push_back("FFT");
+  }
   if(idw.size()!=0) {
     addme="PROJ=";
     for(unsigned i=0; i<idw.size()-1; i++) {addme+=idw[i]+",";}
@@ -25,11 +25,13 @@
 #include "tools/Vector.h"
 #include "tools/Random.h"
 #include "tools/Communicator.h"
+#include "tools/LeptonCache.h"
 #include <string>
 #include <cstdio>
 #include <cmath>
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 //+PLUMEDOC TOOLS pesmd
 /*
@@ -90,6 +92,28 @@ In this way we can use pesmd to do a dynamics on a free energy surface calculate
 and sum_hills.  On a final note once we have defined our potential we can use all the biasing functions
 within plumed in addition in order to do a biased dynamics on the potential energy landscape of interest.
 
+Alternatively the potential can be given directly to pesmd with the pes
+directive, which takes a lepton expression in the variables x,y,z (up to
+three dimensions) or x1,...,xd (any dimension):
+
+\verbatim
+temperature 0.722
+tstep 0.005
+friction 1
+dimension 2
+nstep 50
+ipos 0.0 0.0
+pes x^4-4*x^2+y^4-4*y^2+x*y
+\endverbatim
+
+The expression and its analytic derivatives are compiled once with
+lepton (and, when plumed is built with asmjit, JIT-compiled to native
+code), so every step costs a handful of function evaluations instead of
+going through the full plumed machinery.  In this mode plumed is only
+needed for biasing and output and the plumedstride directive can be used
+to call it every few steps only, which makes unbiased or stride-biased
+model-system sweeps of billions of steps feasible.
+
 */
 //+ENDPLUMEDOC
 
@@ -115,6 +139,8 @@ public:
     keys.addFlag("periodic","false","are your input coordinates periodic");
     keys.add("optional","min","minimum value the coordinates can take for a periodic domain");
     keys.add("optional","max","maximum value the coordinates can take for a periodic domain");
+    keys.add("optional","pes","an analytic potential energy surface, a lepton expression in the variables x,y,z (or x1,...,xd for more than three dimensions); when given it is compiled once and evaluated internally instead of through the plumed input");
+    keys.add("compulsory","plumedstride","1","how often plumed is called when the potential is evaluated internally with pes");
   }
 
   explicit PesMD( const CLToolOptions& co ) :
@@ -134,6 +160,9 @@ private:
                   int&    nstep,
                   bool&   lperiod,
                   std::vector<double>& periods,
+                  std::vector<double>& pmin,
+                  std::string& pesin,
+                  int&    pstride,
                   int&    idum)
   {
     // Read everything from input file
@@ -148,13 +177,16 @@ private:
     parse("plumed",plumedin); parse("dimension",dim);
     parse("nstep",nstep); parse("idum",idum);
     ipos.resize( dim ); parseVector("ipos",ipos);
+    parse("pes",pesin); parse("plumedstride",pstride);
+    if( pstride<1 ) error("plumedstride should be at least 1");
+    if( pstride>1 && pesin.length()==0 ) error("plumedstride can only be used together with pes");
 
     parseFlag("periodic",lperiod);
     if( lperiod ) {
       if( dim>3 ) error("can only do three dimensional periodic functions");
       std::vector<double> min( dim ); parseVector("min",min);
       std::vector<double> max( dim ); parseVector("max",max);
-      periods.resize( dim );
+      periods.resize( dim ); pmin=min;
       for(int i=0; i<dim; ++i) {
         if( max[i]<min[i] ) error("invalid periods specified max is less than min");
         periods[i]=max[i]-min[i];
@@ -168,14 +200,50 @@ public:
   int main( FILE* in, FILE* out, PLMD::Communicator& pc) override {
     std::string plumedin; std::vector<double> ipos;
     double temp, tstep, friction; bool lperiod;
-    int dim, nsteps, seed; std::vector<double> periods;
+    int dim, nsteps, seed; std::vector<double> periods, pmin;
+    std::string pesin; int pstride;
     int plumedWantsToStop;
     Random random;
 
-    read_input( temp, tstep, friction, dim, plumedin, ipos, nsteps, lperiod, periods, seed );
+    read_input( temp, tstep, friction, dim, plumedin, ipos, nsteps, lperiod, periods, pmin, pesin, pstride, seed );
     // Setup random number generator
     random.setSeed(seed);
 
+    // Compile the analytic potential and its derivatives, if given.  The
+    // trees come from the process-wide cache and, when plumed is built with
+    // asmjit, lepton turns them into native code, so the evaluations below
+    // are plain function calls
+    const bool has_pes=pesin.length()>0;
+    lepton::CompiledExpression pes_expr;
+    std::vector<lepton::CompiledExpression> pes_der;
+    std::vector<double*> pes_ref, pes_ref_der;
+    std::vector<std::string> var(dim);
+    if( has_pes ) {
+      if( dim<=3 ) {
+        const char* xyz[3]={"x","y","z"};
+        for(int i=0; i<dim; ++i) var[i]=xyz[i];
+      } else {
+        for(int i=0; i<dim; ++i) { std::string num; Tools::convert(i+1,num); var[i]="x"+num; }
+      }
+      pes_expr=LeptonCache::parse(pesin).createCompiledExpression();
+      for(auto &p : pes_expr.getVariables()) {
+        if( std::find(var.begin(),var.end(),p)==var.end() ) error("variable " + p + " is not defined in pes");
+      }
+      pes_der.resize(dim); pes_ref.assign(dim,nullptr); pes_ref_der.assign(dim*dim,nullptr);
+      for(int i=0; i<dim; ++i) pes_der[i]=LeptonCache::differentiate(pesin,var[i]).createCompiledExpression();
+      for(int i=0; i<dim; ++i) {
+        try { pes_ref[i]=&pes_expr.getVariableReference(var[i]); } catch(const PLMD::lepton::Exception& exc) {
+// this is necessary since in some cases lepton thinks a variable is not present even though it is present
+// e.g. pes=0*x
+        }
+        for(int j=0; j<dim; ++j) {
+          try { pes_ref_der[i*dim+j]=&pes_der[i].getVariableReference(var[j]); } catch(const PLMD::lepton::Exception& exc) {
+// as above
+          }
+        }
+      }
+    }
+
     // Setup box if we have periodic domain
     std::vector<double> box(9, 0.0);
     if( lperiod && dim==1 ) { box[0]=box[5]=box[9]=periods[0]; }
@@ -217,16 +285,34 @@ public:
       }
     }
 
+    // Evaluate the analytic potential: gather the coordinates, wrap them
+    // into the periodic domain if needed and accumulate -dV/dx on the forces
+    std::vector<double> cv(dim);
+    auto pes_eval=[&]( const std::vector<Vector>& pos, std::vector<Vector>& ff, double& eng ) {
+      for(int i=0; i<dim; ++i) {
+        double x=pos[1+i/3][i%3];
+        if( lperiod ) x-=std::floor((x-pmin[i])/periods[i])*periods[i];
+        cv[i]=x;
+      }
+      for(int i=0; i<dim; ++i) if(pes_ref[i]) *pes_ref[i]=cv[i];
+      eng=pes_expr.evaluate();
+      for(int i=0; i<dim; ++i) {
+        for(int j=0; j<dim; ++j) if(pes_ref_der[i*dim+j]) *pes_ref_der[i*dim+j]=cv[j];
+        ff[1+i/3][i%3]-=pes_der[i].evaluate();
+      }
+    };
+
     // Now call plumed to get initial forces
-    int istep=0; double zero=0;
+    int istep=0; double pes_eng=0;
     plumed->cmd("setStep",&istep);
     plumed->cmd("setMasses",&masses[0]);
     for(unsigned i=0; i<forces.size(); ++i) forces[i].zero();
     plumed->cmd("setForces",&forces[0]);
-    plumed->cmd("setEnergy",&zero);
+    plumed->cmd("setEnergy",&pes_eng);
     if( lperiod ) plumed->cmd("setBox",&box[0]);
     plumed->cmd("setPositions",&positions[0]);
     plumed->cmd("calc");
+    if( has_pes ) pes_eval( positions, forces, pes_eng );
 
 
     double therm_eng=0;
@@ -259,17 +345,19 @@ public:
 
       int istepplusone=istep+1;
       plumedWantsToStop=0;
-      plumed->cmd("setStep",&istepplusone);
-      plumed->cmd("setMasses",&masses[0]);
       for(unsigned i=0; i<forces.size(); ++i) forces[i].zero();
-      plumed->cmd("setForces",&forces[0]);
-      double fenergy=0.0;
-      plumed->cmd("setEnergy",&fenergy);
-      plumed->cmd("setPositions",&positions[0]);
-      plumed->cmd("setStopFlag",&plumedWantsToStop);
-      plumed->cmd("calc");
-      // if(istep%2000==0) plumed->cmd("writeCheckPointFile");
-      if(plumedWantsToStop) nsteps=istep;
+      if( !has_pes || istepplusone%pstride==0 ) {
+        plumed->cmd("setStep",&istepplusone);
+        plumed->cmd("setMasses",&masses[0]);
+        plumed->cmd("setForces",&forces[0]);
+        plumed->cmd("setEnergy",&pes_eng);
+        plumed->cmd("setPositions",&positions[0]);
+        plumed->cmd("setStopFlag",&plumedWantsToStop);
+        plumed->cmd("calc");
+        // if(istep%2000==0) plumed->cmd("writeCheckPointFile");
+        if(plumedWantsToStop) nsteps=istep;
+      }
+      if( has_pes ) pes_eval( positions, forces, pes_eng );
 
       // Second step of velocity verlet
       for(int j=0; j<nat; ++j) {
@@ -0,0 +1,154 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Colvar.h"
+#include "ActionRegister.h"
+#include "tools/Angle.h"
+#include "tools/OpenMP.h"
+
+#include <string>
+
+using namespace std;
+
+namespace PLMD {
+namespace colvar {
+
+//+PLUMEDOC COLVAR ANGLE_LIST
+/*
+Calculate many angles in a single action.
+
+Each numbered ATOMS keyword specifies one angle, following the same
+convention as \ref ANGLE: with three atoms the angle is centered on the
+second one, with four atoms the angle between the vector connecting the
+first two atoms and the vector connecting the last two atoms is
+computed. One component is produced per ATOMS keyword:
+
+\plumedfile
+a: ANGLE_LIST ATOMS1=1,2,3 ATOMS2=4,5,6,7
+PRINT ARG=a.ang-1,a.ang-2 FILE=COLVAR
+\endplumedfile
+
+The advantage over separate ANGLE actions is that all the angles are
+computed in one pass over a contiguous list of atoms, which avoids the
+per-action overhead for inputs that define many angles.
+
+*/
+//+ENDPLUMEDOC
+
+class AngleList : public Colvar {
+  bool pbc;
+  unsigned nangles;
+
+public:
+  explicit AngleList(const ActionOptions&);
+// active methods:
+  void calculate() override;
+  static void registerKeywords(Keywords& keys);
+};
+
+PLUMED_REGISTER_ACTION(AngleList,"ANGLE_LIST")
+
+void AngleList::registerKeywords( Keywords& keys ) {
+  Colvar::registerKeywords(keys);
+  keys.add("numbered","ATOMS","the atoms involved in each of the angles you wish to calculate (either 3 or 4 atoms). "
+           "Keywords like ATOMS1, ATOMS2, ATOMS3,... should be listed and one angle will be "
+           "calculated for each ATOMS keyword you specify.");
+  keys.reset_style("ATOMS","atoms");
+  keys.addOutputComponent("ang","default","the angles calculated from each of the ATOMS keywords");
+}
+
+AngleList::AngleList(const ActionOptions&ao):
+  PLUMED_COLVAR_INIT(ao),
+  pbc(true),
+  nangles(0)
+{
+  bool nopbc=!pbc;
+  parseFlag("NOPBC",nopbc);
+  pbc=!nopbc;
+
+  std::vector<AtomNumber> t, all_atoms;
+  for(int i=1;; ++i ) {
+    parseAtomList("ATOMS", i, t );
+    if( t.empty() ) break;
+    if(t.size()==3) {
+      log.printf("  angle %d between atoms %d %d %d\n",i,t[0].serial(),t[1].serial(),t[2].serial());
+      t.resize(4);
+      t[3]=t[2];
+      t[2]=t[1];
+    } else if(t.size()==4) {
+      log.printf("  angle %d between lines %d-%d and %d-%d\n",i,t[0].serial(),t[1].serial(),t[2].serial(),t[3].serial());
+    } else {
+      std::string ss; Tools::convert(i,ss);
+      error("ATOMS" + ss + " keyword should specify either 3 or 4 atoms");
+    }
+    for(unsigned j=0; j<4; ++j) all_atoms.push_back(t[j]);
+    t.resize(0);
+
+    std::string num; Tools::convert(i,num);
+    addComponentWithDerivatives("ang-"+num);
+    componentIsNotPeriodic("ang-"+num);
+    nangles++;
+  }
+  if( nangles==0 ) error("at least one angle should be specified using the ATOMS keywords");
+
+  if(pbc) log.printf("  using periodic boundary conditions\n");
+  else    log.printf("  without periodic boundary conditions\n");
+
+  checkRead();
+  requestAtoms(all_atoms);
+}
+
+// calculator
+void AngleList::calculate() {
+
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt*8>nangles) nt=1;
+  // every angle writes to its own component and to the derivatives of
+  // its own four slots, so the angles can be processed independently
+  #pragma omp parallel for num_threads(nt)
+  for(unsigned i=0; i<nangles; ++i) {
+    const Vector p0=getPosition(4*i+0);
+    const Vector p1=getPosition(4*i+1);
+    const Vector p2=getPosition(4*i+2);
+    const Vector p3=getPosition(4*i+3);
+    Vector dij,dik;
+    if(pbc) {
+      dij=pbcDistance(p2,p3);
+      dik=pbcDistance(p1,p0);
+    } else {
+      dij=delta(p2,p3);
+      dik=delta(p1,p0);
+    }
+    Vector ddij,ddik;
+    PLMD::Angle a;
+    double angle=a.compute(dij,dik,ddij,ddik);
+    Value* val=getPntrToComponent(i);
+    setAtomsDerivatives(val,4*i+0,ddik);
+    setAtomsDerivatives(val,4*i+1,-ddik);
+    setAtomsDerivatives(val,4*i+2,-ddij);
+    setAtomsDerivatives(val,4*i+3,ddij);
+    val->set(angle);
+    setBoxDerivatives(val,-(Tensor(dij,ddij)+Tensor(dik,ddik)));
+  }
+}
+
+}
+}
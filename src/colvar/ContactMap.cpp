@@ -113,6 +113,10 @@ private:
   std::unique_ptr<NeighborList> nl;
   std::vector<SwitchingFunction> sfs;
   vector<double> reference, weight;
+/// Contacts grouped by switching function parameters, used by the fused
+/// evaluation path to run each group as a tight loop with one set of
+/// parameters
+  std::vector<std::vector<unsigned> > sf_groups;
 public:
   static void registerKeywords( Keywords& keys );
   explicit ContactMap(const ActionOptions&);
@@ -255,6 +259,25 @@ ContactMap::ContactMap(const ActionOptions&ao):
     docomp=true;
   }
 
+  // Group the contacts by switching function parameters. When the map is
+  // reduced to a single number (SUM or CMDIST) the contacts can be
+  // evaluated group by group, so that each group runs as a tight loop
+  // with a single set of parameters.
+  if( !docomp ) {
+    std::map<std::string,unsigned> groupindex;
+    for(unsigned i=0; i<sfs.size(); ++i) {
+      const std::string descr=sfs[i].description();
+      auto p=groupindex.find(descr);
+      if( p==groupindex.end() ) {
+        p=groupindex.insert(std::pair<std::string,unsigned>(descr,sf_groups.size())).first;
+        sf_groups.push_back(std::vector<unsigned>());
+      }
+      sf_groups[p->second].push_back(i);
+    }
+    log.printf("  %u contacts grouped by %u distinct switching functions\n",
+               static_cast<unsigned>(sfs.size()), static_cast<unsigned>(sf_groups.size()));
+  }
+
   // Set up if it is just a list of contacts
   requestAtoms(nl->getFullAtomList());
   checkRead();
@@ -277,42 +300,65 @@ void ContactMap::calculate() {
     rank=comm.Get_rank();
   }
 
-// sum over close pairs
-  for(unsigned i=rank; i<nl->size(); i+=stride) {
-    Vector distance;
-    unsigned i0=nl->getClosePair(i).first;
-    unsigned i1=nl->getClosePair(i).second;
-    if(pbc) {
-      distance=pbcDistance(getPosition(i0),getPosition(i1));
-    } else {
-      distance=delta(getPosition(i0),getPosition(i1));
-    }
-
-    double dfunc=0.;
-    double coord = weight[i]*(sfs[i].calculate(distance.modulo(), dfunc) - reference[i]);
-    Vector tmpder = weight[i]*dfunc*distance;
-    Tensor tmpvir = weight[i]*dfunc*Tensor(distance,distance);
-    if(!docmdist) {
+// compute the distance vectors of all the contacts owned by this rank in
+// one block; the minimum image is resolved with a single batched pbc call
+// over contiguous data instead of one pbcDistance per contact
+  std::vector<Vector> dlist((nl->size()+stride-1-rank)/stride);
+  for(unsigned i=rank, k=0; i<nl->size(); i+=stride, ++k) {
+    dlist[k]=delta(getPosition(nl->getClosePair(i).first),getPosition(nl->getClosePair(i).second));
+  }
+  if(pbc) getPbc().apply(dlist);
+
+  if(docomp) {
+// when using components the contacts are processed in input order, since
+// the derivatives of a component accumulate those of the previous
+// contacts sharing its atoms
+    for(unsigned i=rank; i<nl->size(); i+=stride) {
+      unsigned i0=nl->getClosePair(i).first;
+      unsigned i1=nl->getClosePair(i).second;
+      const Vector & distance=dlist[(i-rank)/stride];
+
+      double dfunc=0.;
+      double coord = weight[i]*(sfs[i].calculateSqr(distance.modulo2(), dfunc) - reference[i]);
+      Vector tmpder = weight[i]*dfunc*distance;
+      Tensor tmpvir = weight[i]*dfunc*Tensor(distance,distance);
       deriv[i0] -= tmpder;
       deriv[i1] += tmpder;
       virial    -= tmpvir;
       ncoord    += coord;
-    } else {
-      tmpder *= 2.*coord;
-      tmpvir *= 2.*coord;
-      deriv[i0] -= tmpder;
-      deriv[i1] += tmpder;
-      virial    -= tmpvir;
-      ncoord    += coord*coord;
-    }
 
-    if(docomp) {
       Value* val=getPntrToComponent( i );
       setAtomsDerivatives( val, i0, deriv[i0] );
       setAtomsDerivatives( val, i1, deriv[i1] );
       setBoxDerivatives( val, -tmpvir );
       val->set(coord);
     }
+  } else {
+// fused path: the contacts are evaluated grouped by switching function,
+// with the sum or the squared deviation accumulated on the fly
+    for(const auto & group : sf_groups) {
+      const SwitchingFunction & sf=sfs[group[0]];
+      for(unsigned i : group) {
+        if( i%stride!=rank ) continue;
+        unsigned i0=nl->getClosePair(i).first;
+        unsigned i1=nl->getClosePair(i).second;
+        const Vector & distance=dlist[(i-rank)/stride];
+
+        double dfunc=0.;
+        double coord = weight[i]*(sf.calculateSqr(distance.modulo2(), dfunc) - reference[i]);
+        Vector tmpder = weight[i]*dfunc*distance;
+        Tensor tmpvir = weight[i]*dfunc*Tensor(distance,distance);
+        if(docmdist) {
+          tmpder *= 2.*coord;
+          tmpvir *= 2.*coord;
+          coord   = coord*coord;
+        }
+        deriv[i0] -= tmpder;
+        deriv[i1] += tmpder;
+        virial    -= tmpvir;
+        ncoord    += coord;
+      }
+    }
   }
 
   if(!serial) {
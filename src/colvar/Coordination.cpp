@@ -104,6 +104,8 @@ public:
 // active methods:
   static void registerKeywords( Keywords& keys );
   double pairing(double distance,double&dfunc,unsigned i,unsigned j)const override;
+  bool pairingPlateau( double& plateau2, double& value ) const override;
+  double pairingCutoffSqr() const override;
 };
 
 PLUMED_REGISTER_ACTION(Coordination,"COORDINATION")
@@ -153,6 +155,22 @@ double Coordination::pairing(double distance,double&dfunc,unsigned i,unsigned j)
   return switchingFunction.calculateSqr(distance,dfunc);
 }
 
+bool Coordination::pairingPlateau( double& plateau2, double& value ) const {
+  const double d0=switchingFunction.get_d0();
+  if(d0<=0.0) return false;
+// up to d_0 every switching function is flat at its maximum. The threshold
+// is shrunk by a few ulps so that the rounding of the square root cannot
+// push a distance classified as plateau above d_0
+  plateau2=d0*d0*(1.0-1e-10);
+  double dfunc=0.;
+  value=switchingFunction.calculate(0.0,dfunc);
+  return true;
+}
+
+double Coordination::pairingCutoffSqr() const {
+  return switchingFunction.get_dmax2();
+}
+
 }
 
 }
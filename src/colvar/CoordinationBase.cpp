@@ -25,6 +25,7 @@
 #include "tools/OpenMP.h"
 
 #include <string>
+#include <limits>
 
 using namespace std;
 
@@ -38,6 +39,10 @@ void CoordinationBase::registerKeywords( Keywords& keys ) {
   keys.addFlag("NLIST",false,"Use a neighbor list to speed up the calculation");
   keys.add("optional","NL_CUTOFF","The cutoff for the neighbor list");
   keys.add("optional","NL_STRIDE","The frequency with which we are updating the atoms in the neighbor list");
+  keys.add("optional","NL_SKIN","The Verlet skin for the neighbor list. The list is built with cutoff NL_CUTOFF+NL_SKIN "
+           "and rebuilt only when some atom has moved by more than half the skin, instead of at a fixed stride");
+  keys.addFlag("NL_CELLLIST",false,"Use a cell-list algorithm to update the neighbor list, so that the cost of "
+               "the update grows linearly rather than quadratically with the number of atoms. Requires periodic boundary conditions");
   keys.add("atoms","GROUPA","First list of atoms");
   keys.add("atoms","GROUPB","Second list of atoms (if empty, N*(N-1)/2 pairs in GROUPA are counted)");
 }
@@ -68,24 +73,44 @@ CoordinationBase::CoordinationBase(const ActionOptions&ao):
   bool doneigh=false;
   double nl_cut=0.0;
   int nl_st=0;
+  double nl_skin=0.0;
+  bool nl_cell=false;
   parseFlag("NLIST",doneigh);
   if(doneigh) {
     parse("NL_CUTOFF",nl_cut);
     if(nl_cut<=0.0) error("NL_CUTOFF should be explicitly specified and positive");
-    parse("NL_STRIDE",nl_st);
-    if(nl_st<=0) error("NL_STRIDE should be explicitly specified and positive");
+    parse("NL_SKIN",nl_skin);
+    if(nl_skin<0.0) error("NL_SKIN should be positive");
+    if(nl_skin>0.0) {
+// with a skin the rebuilds are triggered by atom displacements, so all the
+// atoms stay requested and no stride is needed
+      nl_st=0;
+      parse("NL_STRIDE",nl_st);
+      if(nl_st>0) error("NL_STRIDE and NL_SKIN cannot be used at the same time");
+    } else {
+      parse("NL_STRIDE",nl_st);
+      if(nl_st<=0) error("NL_STRIDE should be explicitly specified and positive");
+    }
+    parseFlag("NL_CELLLIST",nl_cell);
+    if(nl_cell&&!pbc) error("NL_CELLLIST requires periodic boundary conditions");
+    if(nl_cell&&dopair) error("NL_CELLLIST is useless with PAIR: the number of pairs is already linear in the number of atoms");
+  } else {
+    parseFlag("NL_CELLLIST",nl_cell);
+    if(nl_cell) error("NL_CELLLIST requires NLIST");
   }
 
   addValueWithDerivatives(); setNotPeriodic();
   if(gb_lista.size()>0) {
-    if(doneigh)  nl.reset( new NeighborList(ga_lista,gb_lista,serial,dopair,pbc,getPbc(),comm,nl_cut,nl_st) );
+    if(doneigh)  nl.reset( new NeighborList(ga_lista,gb_lista,serial,dopair,pbc,getPbc(),comm,nl_cut,nl_st,nl_cell,nl_skin) );
     else         nl.reset( new NeighborList(ga_lista,gb_lista,serial,dopair,pbc,getPbc(),comm) );
   } else {
-    if(doneigh)  nl.reset( new NeighborList(ga_lista,serial,pbc,getPbc(),comm,nl_cut,nl_st) );
+    if(doneigh)  nl.reset( new NeighborList(ga_lista,serial,pbc,getPbc(),comm,nl_cut,nl_st,nl_cell,nl_skin) );
     else         nl.reset( new NeighborList(ga_lista,serial,pbc,getPbc(),comm) );
   }
 
   requestAtoms(nl->getFullAtomList());
+// the atom lists can be large: gather positions from the SoA mirror
+  useSoAPositions();
 
   log.printf("  between two groups of %u and %u atoms\n",static_cast<unsigned>(ga_lista.size()),static_cast<unsigned>(gb_lista.size()));
   log.printf("  first group:\n");
@@ -104,7 +129,9 @@ CoordinationBase::CoordinationBase(const ActionOptions&ao):
   if(dopair) log.printf("  with PAIR option\n");
   if(doneigh) {
     log.printf("  using neighbor lists with\n");
-    log.printf("  update every %d steps and cutoff %f\n",nl_st,nl_cut);
+    if(nl_skin>0.0) log.printf("  cutoff %f, rebuilt when an atom moves more than half the skin %f\n",nl_cut,nl_skin);
+    else log.printf("  update every %d steps and cutoff %f\n",nl_st,nl_cut);
+    if(nl_cell) log.printf("  neighbor list updated with a cell-list algorithm\n");
   }
 }
 
@@ -112,6 +139,14 @@ CoordinationBase::~CoordinationBase() {
 // destructor required to delete forward declared class
 }
 
+bool CoordinationBase::pairingPlateau( double& plateau2, double& value ) const {
+  return false;
+}
+
+double CoordinationBase::pairingCutoffSqr() const {
+  return std::numeric_limits<double>::max();
+}
+
 void CoordinationBase::prepare() {
   if(nl->getStride()>0) {
     if(firsttime || (getStep()%nl->getStride()==0)) {
@@ -135,7 +170,10 @@ void CoordinationBase::calculate()
   Tensor virial;
   vector<Vector> deriv(getNumberOfAtoms());
 
-  if(nl->getStride()>0 && invalidateList) {
+  if(nl->getSkin()>0.0) {
+// with a skin the list is rebuilt only when some atom has moved too much
+    if(nl->needsUpdate(getPositions())) nl->update(getPositions());
+  } else if(nl->getStride()>0 && invalidateList) {
     nl->update(getPositions());
   }
 
@@ -149,43 +187,77 @@ void CoordinationBase::calculate()
     rank=comm.Get_rank();
   }
 
+// pairs well inside the plateau of the pair function contribute a constant
+// with zero derivative and pairs beyond its cutoff contribute nothing, so
+// both can be classified from the squared distance alone and skip the call
+// to pairing() and the derivative accumulation
+  double plateau2=-1., plateauval=0.;
+  pairingPlateau(plateau2,plateauval);
+  const double cutoff2=pairingCutoffSqr();
+
   unsigned nt=OpenMP::getNumThreads();
   const unsigned nn=nl->size();
   if(nt*stride*10>nn) nt=1;
+// after a few calibration steps the measured loop time replaces the
+// pair-count heuristic above when picking the team size
+  nt=threadtuner.getNumThreads(nt);
+
+// number of pairs of this MPI rank, processed in fixed-size blocks so that
+// the minimum image and the squared distances are computed on whole blocks
+  const unsigned nlocal=(nn>rank? (nn-rank+stride-1)/stride : 0);
+  const unsigned blocksize=64;
+  const unsigned nblocks=(nlocal+blocksize-1)/blocksize;
 
+  threadtuner.start();
   #pragma omp parallel num_threads(nt)
   {
     std::vector<Vector> omp_deriv(getPositions().size());
     Tensor omp_virial;
+    double dx[blocksize],dy[blocksize],dz[blocksize],d2[blocksize];
+    unsigned ip0[blocksize],ip1[blocksize];
 
     #pragma omp for reduction(+:ncoord) nowait
-    for(unsigned int i=rank; i<nn; i+=stride) {
-
-      Vector distance;
-      unsigned i0=nl->getClosePair(i).first;
-      unsigned i1=nl->getClosePair(i).second;
-
-      if(getAbsoluteIndex(i0)==getAbsoluteIndex(i1)) continue;
-
-      if(pbc) {
-        distance=pbcDistance(getPosition(i0),getPosition(i1));
-      } else {
-        distance=delta(getPosition(i0),getPosition(i1));
+    for(unsigned int ib=0; ib<nblocks; ++ib) {
+
+      const unsigned bstart=ib*blocksize;
+      const unsigned blen=std::min(blocksize,nlocal-bstart);
+
+// gather the distance vectors of the pairs of this block
+      unsigned npairs=0;
+      for(unsigned k=0; k<blen; ++k) {
+        const unsigned i=rank+(bstart+k)*stride;
+        unsigned i0=nl->getClosePair(i).first;
+        unsigned i1=nl->getClosePair(i).second;
+        if(getAbsoluteIndex(i0)==getAbsoluteIndex(i1)) continue;
+        const Vector d=delta(getPosition(i0),getPosition(i1));
+        dx[npairs]=d[0]; dy[npairs]=d[1]; dz[npairs]=d[2];
+        ip0[npairs]=i0; ip1[npairs]=i1;
+        npairs++;
       }
 
-      double dfunc=0.;
-      ncoord += pairing(distance.modulo2(), dfunc,i0,i1);
-
-      Vector dd(dfunc*distance);
-      Tensor vv(dd,distance);
-      if(nt>1) {
-        omp_deriv[i0]-=dd;
-        omp_deriv[i1]+=dd;
-        omp_virial-=vv;
-      } else {
-        deriv[i0]-=dd;
-        deriv[i1]+=dd;
-        virial-=vv;
+// minimum image on the whole block (vectorized for orthorombic boxes)
+      if(pbc) getPbc().apply(dx,dy,dz,npairs);
+      for(unsigned k=0; k<npairs; ++k) d2[k]=dx[k]*dx[k]+dy[k]*dy[k]+dz[k]*dz[k];
+
+// switching functions and derivatives on the whole block
+      for(unsigned k=0; k<npairs; ++k) {
+        if(d2[k]>cutoff2) continue;
+        if(d2[k]<=plateau2) { ncoord += plateauval; continue; }
+        double dfunc=0.;
+        ncoord += pairing(d2[k],dfunc,ip0[k],ip1[k]);
+
+        const Vector distance(dx[k],dy[k],dz[k]);
+        Vector dd(dfunc*distance);
+        Tensor vv(dd,distance);
+        if(nt>1) {
+          omp_deriv[ip0[k]]-=dd;
+          omp_deriv[ip1[k]]+=dd;
+          omp_virial-=vv;
+        } else {
+          deriv[ip0[k]]-=dd;
+          deriv[ip1[k]]+=dd;
+          virial-=vv;
+        }
       }
 
     }
@@ -195,6 +267,7 @@ void CoordinationBase::calculate()
       virial+=omp_virial;
     }
   }
+  threadtuner.stop(nt);
 
   if(!serial) {
     comm.Sum(ncoord);
@@ -22,6 +22,7 @@
 #ifndef __PLUMED_colvar_CoordinationBase_h
 #define __PLUMED_colvar_CoordinationBase_h
 #include "Colvar.h"
+#include "tools/ThreadTuner.h"
 #include <memory>
 
 namespace PLMD {
@@ -36,6 +37,8 @@ class CoordinationBase : public Colvar {
   std::unique_ptr<NeighborList> nl;
   bool invalidateList;
   bool firsttime;
+/// calibrates the OpenMP team size for the pair loop during the first steps
+  ThreadTuner threadtuner;
 
 public:
   explicit CoordinationBase(const ActionOptions&);
@@ -44,6 +47,17 @@ public:
   void calculate() override;
   void prepare() override;
   virtual double pairing(double distance,double&dfunc,unsigned i,unsigned j)const=0;
+/// If the pair function has an inner plateau, set plateau2 to the largest
+/// squared distance for which pairing() returns a constant with zero
+/// derivative whatever the pair, set value to that constant, and return true.
+/// Pairs closer than this are then counted without calling pairing().
+/// The base class returns false, meaning that no pair can be treated this way
+  virtual bool pairingPlateau( double& plateau2, double& value ) const ;
+/// Squared distance beyond which pairing() returns exactly zero with zero
+/// derivative, so that pairs further apart can be skipped altogether.
+/// The base class returns the largest representable double, meaning that
+/// no pair is ever skipped
+  virtual double pairingCutoffSqr() const ;
   static void registerKeywords( Keywords& keys );
 };
 
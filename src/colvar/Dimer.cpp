@@ -248,47 +248,28 @@ void Dimer::calculate()
 {
   double cv_val=0;
   Tensor virial;
-  vector<Vector> derivatives;
-  vector<Vector> my_pos=getPositions();
-  int atms = my_pos.size();
-  vector<Vector> der_b2;
-  for(int i=0; i<atms/2; i++)
+  const unsigned ndimers = getNumberOfAtoms()/2;
+  const double dsigquad = dsigma*dsigma;
+  const double invbs = 1.0/(dsigquad*beta);
+  for(unsigned i=0; i<ndimers; i++)
   {
-    Vector dist;
-    dist = pbcDistance(my_pos[i],my_pos[i+atms/2]);
-    double distquad=0;
-    for(int j=0; j<3; j++)
-      distquad += dist[j]*dist[j];
+    Vector dist = pbcDistance(getPosition(i),getPosition(i+ndimers));
+    double distquad = dist.modulo2();
 
-    double dsigquad = dsigma*dsigma;
     double fac1 = 1.0 + distquad/(2*qexp*dsigquad);
     double fac1qm1 = pow(fac1,qexp-1);
 
-
     cv_val += (fac1*fac1qm1-1.0)/beta;
-    Vector der_val;
-    Vector mder_val;
-    for(int j=0; j<3; j++)
-    {
-      der_val[j] = -fac1qm1*dist[j]/(dsigquad*beta);
-      mder_val[j]=-der_val[j];
-    }
-    derivatives.push_back(der_val);
-    der_b2.push_back(mder_val);
+
+    Vector dd(fac1qm1*invbs*dist);
+    setAtomsDerivatives(i,-dd);
+    setAtomsDerivatives(i+ndimers,dd);
 
     // virial part: each dimer contributes -x_{ij}*ds/dx_{ij}  (s is the CV)
-    double dfunc = fac1qm1/(beta*dsigquad);
-    Vector dd(dfunc*dist);
-    Tensor vv(dd,dist);
-    virial -= vv;
+    virial -= Tensor(dd,dist);
 
   }
 
-  derivatives.insert(derivatives.end(), der_b2.begin(), der_b2.end());
-
-  for(unsigned int i=0; i<derivatives.size(); i++)
-    setAtomsDerivatives(i,derivatives[i]);
-
   setValue(cv_val);
   setBoxDerivatives(virial);
 
@@ -0,0 +1,153 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Colvar.h"
+#include "ActionRegister.h"
+#include "tools/Pbc.h"
+#include "tools/OpenMP.h"
+
+#include <string>
+#include <cmath>
+
+using namespace std;
+
+namespace PLMD {
+namespace colvar {
+
+//+PLUMEDOC COLVAR DISTANCE_LIST
+/*
+Calculate many distances in a single action.
+
+Each numbered ATOMS keyword specifies one pair of atoms and produces one
+component, so this action is equivalent to a list of \ref DISTANCE actions:
+
+\plumedfile
+d: DISTANCE_LIST ATOMS1=1,2 ATOMS2=3,4 ATOMS3=5,6
+PRINT ARG=d.dist-1,d.dist-2,d.dist-3 FILE=COLVAR
+\endplumedfile
+
+The advantage over separate DISTANCE actions is that all the distance
+vectors are gathered into contiguous arrays, the minimum image is applied
+to the whole list at once (vectorized for orthorhombic boxes), and the
+per-action overhead is paid only once. For inputs that define thousands of
+distances, e.g. contact-based features, this is significantly faster. The
+components can be used exactly like the values of individual DISTANCE
+actions, e.g. as arguments of \ref PRINT or of a function.
+
+Only the scalar distances are computed: for the Cartesian or scaled
+components of a single distance use \ref DISTANCE with the COMPONENTS or
+SCALED_COMPONENTS keywords.
+
+*/
+//+ENDPLUMEDOC
+
+class DistanceList : public Colvar {
+  bool pbc;
+  unsigned ndistances;
+/// distance vectors gathered here so that the minimum image can be
+/// applied to the whole list with a single call
+  std::vector<double> dx,dy,dz;
+
+public:
+  explicit DistanceList(const ActionOptions&);
+// active methods:
+  void calculate() override;
+  static void registerKeywords(Keywords& keys);
+};
+
+PLUMED_REGISTER_ACTION(DistanceList,"DISTANCE_LIST")
+
+void DistanceList::registerKeywords(Keywords& keys) {
+  Colvar::registerKeywords( keys );
+  keys.add("numbered","ATOMS","the pair of atoms involved in each of the distances you wish to calculate. "
+           "Keywords like ATOMS1, ATOMS2, ATOMS3,... should be listed and one distance will be "
+           "calculated for each ATOMS keyword you specify.");
+  keys.reset_style("ATOMS","atoms");
+  keys.addOutputComponent("dist","default","the distances calculated from each of the ATOMS keywords");
+}
+
+DistanceList::DistanceList(const ActionOptions&ao):
+  PLUMED_COLVAR_INIT(ao),
+  pbc(true),
+  ndistances(0)
+{
+  bool nopbc=!pbc;
+  parseFlag("NOPBC",nopbc);
+  pbc=!nopbc;
+
+  std::vector<AtomNumber> t, all_atoms;
+  for(int i=1;; ++i ) {
+    parseAtomList("ATOMS", i, t );
+    if( t.empty() ) break;
+    if( t.size()!=2 ) {
+      std::string ss; Tools::convert(i,ss);
+      error("ATOMS" + ss + " keyword has the wrong number of atoms");
+    }
+    log.printf("  distance %d between atoms %d %d\n",i,t[0].serial(),t[1].serial());
+    all_atoms.push_back(t[0]); all_atoms.push_back(t[1]);
+    t.resize(0);
+
+    std::string num; Tools::convert(i,num);
+    addComponentWithDerivatives("dist-"+num);
+    componentIsNotPeriodic("dist-"+num);
+    ndistances++;
+  }
+  if( ndistances==0 ) error("at least one distance should be specified using the ATOMS keywords");
+
+  if(pbc) log.printf("  using periodic boundary conditions\n");
+  else    log.printf("  without periodic boundary conditions\n");
+
+  dx.resize(ndistances); dy.resize(ndistances); dz.resize(ndistances);
+
+  checkRead();
+  requestAtoms(all_atoms);
+}
+
+// calculator
+void DistanceList::calculate() {
+
+  const unsigned n=ndistances;
+  for(unsigned i=0; i<n; ++i) {
+    const Vector d=delta(getPosition(2*i),getPosition(2*i+1));
+    dx[i]=d[0]; dy[i]=d[1]; dz[i]=d[2];
+  }
+// minimum image on the whole list (vectorized for orthorombic boxes)
+  if(pbc) getPbc().apply(&dx[0],&dy[0],&dz[0],n);
+
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt*16>n) nt=1;
+  // every distance writes to its own component and to the derivatives of
+  // its own two atoms, so the pairs can be processed independently
+  #pragma omp parallel for num_threads(nt)
+  for(unsigned i=0; i<n; ++i) {
+    const Vector distance(dx[i],dy[i],dz[i]);
+    const double value=distance.modulo();
+    const double invvalue=1.0/value;
+    Value* val=getPntrToComponent(i);
+    setAtomsDerivatives(val,2*i+0,-invvalue*distance);
+    setAtomsDerivatives(val,2*i+1,invvalue*distance);
+    setBoxDerivatives(val,-invvalue*Tensor(distance,distance));
+    val->set(value);
+  }
+}
+
+}
+}
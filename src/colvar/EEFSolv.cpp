@@ -87,9 +87,19 @@ private:
   double nl_buffer;
   unsigned nl_stride;
   unsigned nl_update;
-  vector<vector<unsigned> > nl;
-  vector<vector<bool> > nlexpo;
+  /// packed CSR neighbour structure: the neighbours of atom i are
+  /// nl_idx[nl_start[i]]..nl_idx[nl_start[i+1]], with the single-exponential
+  /// flag stored pairwise in nl_expo. The flat arrays survive rebuilds so no
+  /// per-atom allocations happen at neighbour-list updates
+  vector<unsigned> nl_start;
+  vector<unsigned> nl_idx;
+  vector<unsigned char> nl_expo;
   vector<vector<double> > parameter;
+  /// structure-of-arrays copy of parameter, gathered in the hot loop
+  vector<double> p_vol;
+  vector<double> p_gfree;
+  vector<double> p_invlambda;
+  vector<double> p_radius;
   void setupConstants(const vector<AtomNumber> &atoms, vector<vector<double> > &parameter, bool tcorr);
   map<string, map<string, string> > setupTypeMap();
   map<string, vector<double> > setupValueMap();
@@ -139,10 +149,14 @@ EEFSolv::EEFSolv(const ActionOptions&ao):
 
   log << "  Bibliography " << plumed.cite("Lazaridis T, Karplus M, Proteins Struct. Funct. Genet. 35, 133 (1999)"); log << "\n";
 
-  nl.resize(size);
-  nlexpo.resize(size);
+  nl_start.assign(size+1, 0);
   parameter.resize(size, vector<double>(4, 0));
   setupConstants(atoms, parameter, tcorr);
+  p_vol.resize(size); p_gfree.resize(size); p_invlambda.resize(size); p_radius.resize(size);
+  for(unsigned i=0; i<size; i++) {
+    p_vol[i]=parameter[i][0]; p_gfree[i]=parameter[i][1];
+    p_invlambda[i]=parameter[i][2]; p_radius[i]=parameter[i][3];
+  }
 
   addValueWithDerivatives();
   setNotPeriodic();
@@ -153,13 +167,13 @@ void EEFSolv::update_neighb() {
   const double lower_c2 = 0.24 * 0.24; // this is the cut-off for bonded atoms
   const unsigned size = getNumberOfAtoms();
 
+  nl_idx.clear(); nl_expo.clear();
   for (unsigned i=0; i<size; i++) {
-    nl[i].clear();
-    nlexpo[i].clear();
+    nl_start[i]=nl_idx.size();
     const Vector posi = getPosition(i);
     // Loop through neighboring atoms, add the ones below cutoff
     for (unsigned j=i+1; j<size; j++) {
-      if(parameter[i][1]==0&&parameter[j][1]==0) continue;
+      if(p_gfree[i]==0&&p_gfree[j]==0) continue;
       const double d2 = delta(posi, getPosition(j)).modulo2();
       if (d2 < lower_c2 && j < i+14) {
         // crude approximation for i-i+1/2 interactions,
@@ -167,17 +181,16 @@ void EEFSolv::update_neighb() {
         continue;
       }
       // We choose the maximum lambda value and use a more conservative cutoff
-      double mlambda = 1./parameter[i][2];
-      if (1./parameter[j][2] > mlambda) mlambda = 1./parameter[j][2];
+      double mlambda = 1./p_invlambda[i];
+      if (1./p_invlambda[j] > mlambda) mlambda = 1./p_invlambda[j];
       const double c2 = (2. * mlambda + nl_buffer) * (2. * mlambda + nl_buffer);
       if (d2 < c2 ) {
-        nl[i].push_back(j);
-        if(parameter[i][2] == parameter[j][2] && parameter[i][3] == parameter[j][3]) {
-          nlexpo[i].push_back(true);
-        } else nlexpo[i].push_back(false);
+        nl_idx.push_back(j);
+        nl_expo.push_back( (p_invlambda[i]==p_invlambda[j] && p_radius[i]==p_radius[j]) ? 1 : 0 );
       }
     }
   }
+  nl_start[size]=nl_idx.size();
 }
 
 void EEFSolv::calculate() {
@@ -210,18 +223,19 @@ void EEFSolv::calculate() {
       const Vector posi = getPosition(i);
       double fedensity = 0.0;
       Vector deriv_i;
-      const double vdw_volume_i   = parameter[i][0];
-      const double delta_g_free_i = parameter[i][1];
-      const double inv_lambda_i   = parameter[i][2];
-      const double vdw_radius_i   = parameter[i][3];
+      const double vdw_volume_i   = p_vol[i];
+      const double delta_g_free_i = p_gfree[i];
+      const double inv_lambda_i   = p_invlambda[i];
+      const double vdw_radius_i   = p_radius[i];
 
       // The pairwise interactions are unsymmetric, but we can get away with calculating the distance only once
-      for (unsigned i_nl=0; i_nl<nl[i].size(); i_nl++) {
-        const unsigned j = nl[i][i_nl];
-        const double vdw_volume_j   = parameter[j][0];
-        const double delta_g_free_j = parameter[j][1];
-        const double inv_lambda_j   = parameter[j][2];
-        const double vdw_radius_j   = parameter[j][3];
+      const unsigned nl_end=nl_start[i+1];
+      for (unsigned i_nl=nl_start[i]; i_nl<nl_end; i_nl++) {
+        const unsigned j = nl_idx[i_nl];
+        const double vdw_volume_j   = p_vol[j];
+        const double delta_g_free_j = p_gfree[j];
+        const double inv_lambda_j   = p_invlambda[j];
+        const double vdw_radius_j   = p_radius[j];
 
         const Vector dist     = delta(posi, getPosition(j));
         const double rij      = dist.modulo();
@@ -231,7 +245,7 @@ void EEFSolv::calculate() {
         const double fact_ji  = inv_rij2 * delta_g_free_j * vdw_volume_i * INV_PI_SQRT_PI * inv_lambda_j;
 
         // in this case we can calculate a single exponential
-        if(!nlexpo[i][i_nl]) {
+        if(!nl_expo[i_nl]) {
           // i-j interaction
           if(inv_rij > 0.5*inv_lambda_i && delta_g_free_i!=0.)
           {
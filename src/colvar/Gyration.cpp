@@ -22,6 +22,7 @@
 #include "Colvar.h"
 #include "ActionRegister.h"
 #include "core/PlumedMain.h"
+#include "tools/OpenMP.h"
 
 #include <string>
 #include <cmath>
@@ -159,47 +160,55 @@ Gyration::Gyration(const ActionOptions&ao):
 
   addValueWithDerivatives(); setNotPeriodic();
   requestAtoms(atoms);
+  useSoAPositions();
 }
 
 void Gyration::calculate() {
 
   if(!nopbc) makeWhole();
 
-  Vector com;
-  double totmass = 0.;
-  if( use_masses ) {
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      totmass+=getMass(i);
-      com+=getMass(i)*getPosition(i);
+  const unsigned nat=getNumberOfAtoms();
+  unsigned nt=OpenMP::getNumThreads();
+  if(nat<10000) nt=1;
+
+  // first pass over the atoms: the total mass and the center of mass
+  double totmass=0.;
+  Vector S1;
+  #pragma omp parallel num_threads(nt)
+  {
+    double ltot=0.; Vector lS1;
+    #pragma omp for nowait
+    for(unsigned i=0; i<nat; i++) {
+      const double m = use_masses ? getMass(i) : 1.0;
+      ltot+=m;
+      lS1+=m*getPosition(i);
     }
-  } else {
-    totmass = static_cast<double>(getNumberOfAtoms());
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      com+=getPosition(i);
+    #pragma omp critical
+    { totmass+=ltot; S1+=lS1; }
+  }
+  const Vector com = S1/totmass;
+  // second pass: sum_i m_i (r_i-com) x (r_i-com), which is also minus the
+  // virial of the unscaled derivatives m_i (r_i-com).  The second moments
+  // are accumulated about the center of mass: recovering them from the
+  // moments about the origin would cancel most of the significant digits
+  Tensor moments;
+  #pragma omp parallel num_threads(nt)
+  {
+    Tensor lM2;
+    #pragma omp for nowait
+    for(unsigned i=0; i<nat; i++) {
+      const double m = use_masses ? getMass(i) : 1.0;
+      const Vector d=delta(com,getPosition(i));
+      lM2+=m*Tensor(d,d);
     }
+    #pragma omp critical
+    { moments+=lM2; }
   }
-  com /= totmass;
 
   double rgyr=0.;
-  vector<Vector> derivatives( getNumberOfAtoms() );
-  Tensor virial;
 
   if(rg_type==RADIUS||rg_type==TRACE) {
-    if( use_masses ) {
-      for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-        const Vector diff = delta( com, getPosition(i) );
-        rgyr          += getMass(i)*diff.modulo2();
-        derivatives[i] = diff*getMass(i);
-        virial        -= Tensor(getPosition(i),derivatives[i]);
-      }
-    } else {
-      for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-        const Vector diff = delta( com, getPosition(i) );
-        rgyr          += diff.modulo2();
-        derivatives[i] = diff;
-        virial        -= Tensor(getPosition(i),derivatives[i]);
-      }
-    }
+    rgyr = moments[0][0]+moments[1][1]+moments[2][2];
     double fact;
     if(rg_type==RADIUS) {
       rgyr = sqrt(rgyr/totmass);
@@ -209,40 +218,18 @@ void Gyration::calculate() {
       fact = 4;
     }
     setValue(rgyr);
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) setAtomsDerivatives(i,fact*derivatives[i]);
-    setBoxDerivatives(fact*virial);
+    // emit the derivatives directly, without an intermediate buffer
+    #pragma omp parallel for num_threads(nt)
+    for(unsigned i=0; i<nat; i++) {
+      const double m = use_masses ? getMass(i) : 1.0;
+      setAtomsDerivatives(i,(fact*m)*delta(com,getPosition(i)));
+    }
+    setBoxDerivatives(-fact*moments);
     return;
   }
 
 
-  Tensor3d gyr_tens;
-  //calculate gyration tensor
-  if( use_masses ) {
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      const Vector diff=delta( com, getPosition(i) );
-      gyr_tens[0][0]+=getMass(i)*diff[0]*diff[0];
-      gyr_tens[1][1]+=getMass(i)*diff[1]*diff[1];
-      gyr_tens[2][2]+=getMass(i)*diff[2]*diff[2];
-      gyr_tens[0][1]+=getMass(i)*diff[0]*diff[1];
-      gyr_tens[0][2]+=getMass(i)*diff[0]*diff[2];
-      gyr_tens[1][2]+=getMass(i)*diff[1]*diff[2];
-    }
-  } else {
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      const Vector diff=delta( com, getPosition(i) );
-      gyr_tens[0][0]+=diff[0]*diff[0];
-      gyr_tens[1][1]+=diff[1]*diff[1];
-      gyr_tens[2][2]+=diff[2]*diff[2];
-      gyr_tens[0][1]+=diff[0]*diff[1];
-      gyr_tens[0][2]+=diff[0]*diff[2];
-      gyr_tens[1][2]+=diff[1]*diff[2];
-    }
-  }
-
-  // first make the matrix symmetric
-  gyr_tens[1][0] = gyr_tens[0][1];
-  gyr_tens[2][0] = gyr_tens[0][2];
-  gyr_tens[2][1] = gyr_tens[1][2];
+  Tensor3d gyr_tens=moments;
   Tensor3d ttransf,transf;
   Vector princ_comp,prefactor;
   //diagonalize gyration tensor
@@ -345,32 +332,23 @@ void Gyration::calculate() {
   }
   }
 
-  if(use_masses) {
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      Vector tX;
-      const Vector diff=delta( com,getPosition(i) );
-      //project atomic postional vectors to diagonalized frame
-      for(unsigned j=0; j<3; j++) tX[j]=transf[0][j]*diff[0]+transf[1][j]*diff[1]+transf[2][j]*diff[2];
-      for(unsigned j=0; j<3; j++) derivatives[i][j]=getMass(i)*(prefactor[0]*transf[j][0]*tX[0]+
-            prefactor[1]*transf[j][1]*tX[1]+
-            prefactor[2]*transf[j][2]*tX[2]);
-      setAtomsDerivatives(i,derivatives[i]);
-    }
-  } else {
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      Vector tX;
-      const Vector diff=delta( com,getPosition(i) );
-      //project atomic postional vectors to diagonalized frame
-      for(unsigned j=0; j<3; j++) tX[j]=transf[0][j]*diff[0]+transf[1][j]*diff[1]+transf[2][j]*diff[2];
-      for(unsigned j=0; j<3; j++) derivatives[i][j]=prefactor[0]*transf[j][0]*tX[0]+
-            prefactor[1]*transf[j][1]*tX[1]+
-            prefactor[2]*transf[j][2]*tX[2];
-      setAtomsDerivatives(i,derivatives[i]);
-    }
+  // assemble the symmetric matrix that maps centered positions onto
+  // derivatives (projection to the diagonalized frame, scaling by the
+  // prefactors and projection back), so that the derivatives are emitted
+  // in a single sweep and the virial closes from the moments
+  Tensor A;
+  for(unsigned j=0; j<3; j++) for(unsigned k=0; k<3; k++)
+      A[j][k]=prefactor[0]*transf[j][0]*transf[k][0]+
+              prefactor[1]*transf[j][1]*transf[k][1]+
+              prefactor[2]*transf[j][2]*transf[k][2];
+  #pragma omp parallel for num_threads(nt)
+  for(unsigned i=0; i<nat; i++) {
+    const double m = use_masses ? getMass(i) : 1.0;
+    setAtomsDerivatives(i,m*matmul(A,delta(com,getPosition(i))));
   }
 
   setValue(rgyr);
-  setBoxDerivativesNoPbc();
+  setBoxDerivatives(-matmul(moments,A));
 }
 
 }
@@ -26,6 +26,7 @@
 #include "tools/PDB.h"
 #include "tools/RMSD.h"
 #include "tools/Tools.h"
+#include "tools/Matrix.h"
 #include <memory>
 
 using namespace std;
@@ -39,6 +40,16 @@ class PCARMSD : public Colvar {
   bool squared;
   bool nopbc;
   std::vector< std::vector<Vector> > eigenvectors;
+/// the eigenvectors packed one per row, so that all the projections are
+/// obtained with a single matrix-vector product
+  Matrix<double> eigmat;
+/// sum of each eigenvector over the atoms, entering the derivatives
+  std::vector<Vector> eigtotals;
+/// persistent workspace holding the flattened aligned displacement from
+/// the average structure
+  std::vector<double> displacement;
+/// the projections on the eigenvectors
+  std::vector<double> projections;
   std::vector<PDB> pdbv;
   std::vector<string> pca_names;
 public:
@@ -194,6 +205,22 @@ PCARMSD::PCARMSD(const ActionOptions&ao):
     log<<"  Found total "<<neigenvects<< " eigenvectors in the file "<<f_eigenvectors.c_str()<<" \n";
     if(neigenvects==0) error("at least one eigenvector is expected");
   }
+  // pack the eigenvectors in a matrix, one per row, so that in calculate()
+  // all the projections come from a single matrix-vector product, and
+  // precompute the per-eigenvector totals entering the derivatives
+  const unsigned nat=getNumberOfAtoms();
+  eigmat.resize( neigenvects, 3*nat );
+  eigtotals.resize( neigenvects );
+  for(unsigned i=0; i<neigenvects; i++) {
+    Vector tot;
+    for(unsigned iat=0; iat<nat; iat++) {
+      for(unsigned k=0; k<3; k++) eigmat(i,3*iat+k)=eigenvectors[i][iat][k];
+      tot+=eigenvectors[i][iat];
+    }
+    eigtotals[i]=tot;
+  }
+  displacement.resize( 3*nat );
+  projections.resize( neigenvects );
   // the components
   for(unsigned i=0; i<neigenvects; i++) {
     std::string num; Tools::convert( i, num );
@@ -226,33 +253,27 @@ void PCARMSD::calculate() {
   std::vector< Vector > der;
   der.resize(getNumberOfAtoms());
 
+  const unsigned nat=getNumberOfAtoms();
+  // fill the persistent workspace with the aligned displacement once, then
+  // project it on all the eigenvectors with a single matrix-vector product
+  for(unsigned iat=0; iat<nat; iat++) {
+    const Vector d(alignedpos[iat]-centeredref[iat]);
+    displacement[3*iat]=d[0]; displacement[3*iat+1]=d[1]; displacement[3*iat+2]=d[2];
+  }
+  mult( eigmat, displacement, projections );
 
   for(unsigned i=0; i<eigenvectors.size(); i++) {
     Value* value=getPntrToComponent(pca_names[i].c_str());
-    double val; val=0.;
-    for(unsigned iat=0; iat<getNumberOfAtoms(); iat++) {
-      val+=dotProduct(alignedpos[iat]-centeredref[iat],eigenvectors[i][iat]);	der[iat].zero();
-    }
-    value->set(val);
-    // here the loop is reversed to better suit the structure of the derivative of the rotation matrix
-    double tmp1;
-    for(unsigned a=0; a<3; a++) {
-      for(unsigned b=0; b<3; b++) {
-        tmp1=0.;
-        for(unsigned n=0; n<getNumberOfAtoms(); n++) {
-          tmp1+=centeredpos[n][b]*eigenvectors[i][n][a];
-        }
-        for(unsigned iat=0; iat<getNumberOfAtoms(); iat++) {
-          der[iat]+=drotdpos[a][b][iat]*tmp1;
-        }
-      }
-    }
-    Vector v1;
-    for(unsigned n=0; n<getNumberOfAtoms(); n++) {
-      v1+=(1./getNumberOfAtoms())*matmul(invrotation,eigenvectors[i][n]);
-    }
-    for(unsigned iat=0; iat<getNumberOfAtoms(); iat++) {
-      der[iat]+=matmul(invrotation,eigenvectors[i][iat])-v1;
+    value->set(projections[i]);
+    // all the contractions with the derivative of the rotation matrix are
+    // gathered in a single pass over the atoms
+    Tensor tmp1;
+    for(unsigned n=0; n<nat; n++) tmp1+=extProduct(eigenvectors[i][n],centeredpos[n]);
+    const Vector v1=matmul(invrotation,eigtotals[i])*(1./nat);
+    for(unsigned iat=0; iat<nat; iat++) {
+      Vector d;
+      for(unsigned a=0; a<3; a++) for(unsigned b=0; b<3; b++) d+=drotdpos[a][b][iat]*tmp1(a,b);
+      der[iat]=d+matmul(invrotation,eigenvectors[i][iat])-v1;
       setAtomsDerivatives (value,iat,der[iat]);
     }
   }
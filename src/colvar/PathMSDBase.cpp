@@ -41,6 +41,9 @@ void PathMSDBase::registerKeywords(Keywords& keys) {
   keys.add("optional","NEIGH_SIZE","size of the neighbor list");
   keys.add("optional","NEIGH_STRIDE","how often the neighbor list needs to be calculated in time units");
   keys.add("optional", "EPSILON", "(default=-1) the maximum distance between the close and the current structure, the positive value turn on the close structure method");
+  keys.add("optional", "SCREEN_TOL", "(default=off) a positive value turns on the triangle-inequality screening: frames whose distance bound "
+           "shows that their relative contribution to the path sums is below this tolerance are not recomputed and the result "
+           "of their last exact evaluation is reused");
   keys.add("optional", "LOG_CLOSE", "(default=0) value 1 enables logging regarding the close structure");
   keys.add("optional", "DEBUG_CLOSE", "(default=0) value 1 enables extensive debugging info regarding the close structure, the simulation will run much slower");
 }
@@ -50,6 +53,9 @@ PathMSDBase::PathMSDBase(const ActionOptions&ao):
   nopbc(false),
   neigh_size(-1),
   neigh_stride(-1),
+  screen_tol(-1),
+  firstScreen(true),
+  sharedAlign(false),
   epsilonClose(-1),
   debugClose(0),
   logClose(0),
@@ -61,6 +67,7 @@ PathMSDBase::PathMSDBase(const ActionOptions&ao):
   parse("NEIGH_STRIDE",neigh_stride);
   parse("REFERENCE",reference);
   parse("EPSILON", epsilonClose);
+  parse("SCREEN_TOL", screen_tol);
   parse("LOG_CLOSE", logClose);
   parse("DEBUG_CLOSE", debugClose);
   parseFlag("NOPBC",nopbc);
@@ -103,6 +110,13 @@ PathMSDBase::PathMSDBase(const ActionOptions&ao):
     fclose (fp);
     log<<"Found TOTAL "<<nframes<< " PDB in the file "<<reference.c_str()<<" \n";
     if(nframes==0) error("at least one frame expected");
+    // if every frame aligns with the same weights the centering of the positions
+    // can be shared between the frames when the distances are computed
+    sharedAlign=true;
+    for(unsigned i=1; i<pdbv.size(); ++i) {
+      if( pdbv[i].getOccupancy()!=pdbv[0].getOccupancy() ) { sharedAlign=false; break; }
+    }
+    if(sharedAlign) log.printf("  all frames align with the same weights: sharing the centering of the positions between frames\n");
     //set up rmsdRefClose, initialize it to the first structure loaded from reference file
     rmsdPosClose.set(pdbv[0], "OPTIMAL");
     firstPosClose = true;
@@ -129,6 +143,24 @@ PathMSDBase::PathMSDBase(const ActionOptions&ao):
   if (debugClose)
     log.printf(" Extensive debug info regarding close structure turned on\n");
 
+  if(screen_tol>0) {
+    if(epsilonClose>0) {
+      log.printf("  WARNING: SCREEN_TOL cannot be combined with the close structure method, screening disabled\n");
+      screen_tol=-1;
+    } else if( pdbv[0].getOccupancy()!=pdbv[0].getBeta() ) {
+      // with align!=displace the weighted rmsd is not guaranteed to obey the
+      // triangle inequality, so the bounds would not be safe
+      log.printf("  WARNING: SCREEN_TOL requires identical alignment and displacement weights, screening disabled\n");
+      screen_tol=-1;
+    } else {
+      log.printf("  Screening with triangle-inequality bounds, tolerance %e\n",screen_tol);
+      screenWeights=pdbv[0].getOccupancy();
+    }
+  }
+  screenDist.assign(nframes,0.0);
+  // a huge initial drift marks the bound as invalid and forces computation
+  screenDrift.assign(nframes,1e30);
+
   rotationRefClose.resize(nframes);
   savedIndices = vector<unsigned>(nframes);
 
@@ -197,6 +229,37 @@ void PathMSDBase::calculate() {
     }
   }
 
+  // triangle-inequality screening: since the optimal-alignment rmsd is a
+  // metric, |d_k(t)-d_k(t-1)| cannot exceed the rmsd between the current and
+  // the previous positions. Frames whose lower bound keeps them far enough
+  // from the closest frame cannot contribute to the path sums within the
+  // requested tolerance, and the result of their last evaluation is recycled
+  std::vector<bool> skipFrame(imgVec.size(),false);
+  double screen_delta=0.0;
+  bool doScreen=false;
+  if(screen_tol>0) {
+    if(!firstScreen) {
+      std::vector<Vector> tmpder;
+      screen_delta=rmsdScreen.calculate(getPositions(),tmpder,false);
+      double minUpper=1e30;
+      for(unsigned i=0; i<imgVec.size(); i++) {
+        const unsigned k=imgVec[i].index;
+        const double up=screenDist[k]+screenDrift[k]+screen_delta;
+        if(up*up<minUpper) minUpper=up*up;
+      }
+      const double margin=-std::log(screen_tol)/lambda;
+      for(unsigned i=0; i<imgVec.size(); i++) {
+        const unsigned k=imgVec[i].index;
+        const double low=screenDist[k]-screenDrift[k]-screen_delta;
+        if(low>0 && low*low>minUpper+margin) skipFrame[i]=true;
+      }
+      doScreen=true;
+    }
+    rmsdScreen.clear();
+    rmsdScreen.set(screenWeights,screenWeights,getPositions(),"OPTIMAL");
+    firstScreen=false;
+  }
+
   std::vector<double> tmp_distances(imgVec.size(),0.0);
   std::vector<Vector> tmp_derivs;
 // this array is a merge of all tmp_derivs, so as to allow a single comm.Sum below
@@ -235,9 +298,20 @@ void PathMSDBase::calculate() {
     }
   }
   else {
+    // the weighted center of the instantaneous positions is the same for every
+    // frame when the alignment weights are shared, so it is computed only once
+    Vector cpositions;
+    if(sharedAlign) cpositions=msdv[0].calcPositionsCenter(getPositions());
     // store temporary local results
     for(unsigned i=rank; i<imgVec.size(); i+=stride) {
-      tmp_distances[i]=msdv[imgVec[i].index].calculate(getPositions(),tmp_derivs,true);
+      if(doScreen && skipFrame[i]) {
+        // negligible contribution: recycle the last synchronised result
+        tmp_distances[i]=imgVec[i].distance;
+        for(unsigned j=0; j<nat; j++) tmp_derivs2[i*nat+j]=imgVec[i].distder[j];
+        continue;
+      }
+      if(sharedAlign) tmp_distances[i]=msdv[imgVec[i].index].calculate(getPositions(),cpositions,tmp_derivs,true);
+      else tmp_distances[i]=msdv[imgVec[i].index].calculate(getPositions(),tmp_derivs,true);
       plumed_assert(tmp_derivs.size()==nat);
       #pragma omp simd
       for(unsigned j=0; j<nat; j++) tmp_derivs2[i*nat+j]=tmp_derivs[j];
@@ -259,6 +333,19 @@ void PathMSDBase::calculate() {
     imgVec[i].distder.assign(&tmp_derivs2[i*nat],nat+&tmp_derivs2[i*nat]);
   }
 
+  // update the screening bounds; this is done identically on all ranks so
+  // that next step's skip decisions do not depend on the rank
+  if(screen_tol>0) {
+    std::vector<bool> computedNow(nframes,false);
+    for(unsigned i=0; i<imgVec.size(); i++) {
+      if(doScreen && skipFrame[i]) continue;
+      const unsigned k=imgVec[i].index;
+      screenDist[k]=std::sqrt(tmp_distances[i]); screenDrift[k]=0.0;
+      computedNow[k]=true;
+    }
+    for(unsigned k=0; k<nframes; k++) if(!computedNow[k]) screenDrift[k]+=screen_delta;
+  }
+
 // END OF THE HEAVY PART
 
   vector<Value*> val_s_path;
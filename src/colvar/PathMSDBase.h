@@ -63,7 +63,22 @@ class PathMSDBase : public Colvar {
   double lambda;
   int neigh_size;
   int neigh_stride;
+/// tolerance of the triangle-inequality screening, negative means disabled
+  double screen_tol;
+/// RMSD engine holding the positions of the previous step, used to bound how
+/// much each frame distance can have changed since the last exact evaluation
+  RMSD rmsdScreen;
+  bool firstScreen;
+/// alignment weights shared by all frames, reused for rmsdScreen
+  std::vector<double> screenWeights;
+/// per-frame last exactly computed rmsd and an upper bound on how much it can
+/// have drifted since then; a large drift forces an exact recomputation
+  std::vector<double> screenDist;
+  std::vector<double> screenDrift;
   std::vector<RMSD> msdv;
+/// do all frames align with the same weights?  if so the weighted center of the
+/// instantaneous positions is computed once per step and shared between frames
+  bool sharedAlign;
   std::string reference;
   std::vector<Vector> derivs_s;
   std::vector<Vector> derivs_z;
@@ -22,7 +22,7 @@
 #include "Colvar.h"
 #include "core/PlumedMain.h"
 #include "ActionRegister.h"
-#include "tools/Torsion.h"
+#include "tools/InternalCoordinates.h"
 
 #include <string>
 #include <cmath>
@@ -147,44 +147,45 @@ void Puckering::calculate() {
 
 void Puckering::calculate5m() {
 
-  Vector d0,d1,d2,d3,d4,d5;
-
-  d0=delta(getPosition(2),getPosition(1));
-  d1=delta(getPosition(3),getPosition(2));
-  d2=delta(getPosition(4),getPosition(3));
-  d3=delta(getPosition(4),getPosition(3));
-  d4=delta(getPosition(0),getPosition(4));
-  d5=delta(getPosition(1),getPosition(0));
-
-  Vector dd0,dd1,dd2,dd3,dd4,dd5;
-
-  PLMD::Torsion t;
-
-  double v1=t.compute(d0,d1,d2,dd0,dd1,dd2);
-  double v3=t.compute(d3,d4,d5,dd3,dd4,dd5);
-
-  double Zx=(v1+v3)/(2.0*cos(4.0*pi/5.0));
-  double Zy=(v1-v3)/(2.0*sin(4.0*pi/5.0));
+// the five ring bonds; the bond shared between the two torsions (d[2]) is
+// computed only once
+  Vector d[5];
+
+  d[0]=delta(getPosition(2),getPosition(1));
+  d[1]=delta(getPosition(3),getPosition(2));
+  d[2]=delta(getPosition(4),getPosition(3));
+  d[3]=delta(getPosition(0),getPosition(4));
+  d[4]=delta(getPosition(1),getPosition(0));
+
+// nu1 is the torsion over d[0],d[1],d[2] and nu3 the one over d[2],d[3],d[4]
+  static const unsigned triples[6]={0,1,2, 2,3,4};
+  double v[2]; Vector dd[6];
+  InternalCoordinates::torsions( 2, d, triples, v, dd );
+
+  const double izx=1.0/(2.0*cos(4.0*pi/5.0));
+  const double izy=1.0/(2.0*sin(4.0*pi/5.0));
+  double Zx=(v[0]+v[1])*izx;
+  double Zy=(v[0]-v[1])*izy;
   double phase=atan2(Zy,Zx);
   double amplitude=sqrt(Zx*Zx+Zy*Zy);
 
   Vector dZx_dR[5];
   Vector dZy_dR[5];
 
-  dZx_dR[0]=(dd5-dd4);
-  dZx_dR[1]=(dd0-dd5);
-  dZx_dR[2]=(dd1-dd0);
-  dZx_dR[3]=(dd2+dd3-dd1);
-  dZx_dR[4]=(dd4-dd3-dd2);
+  dZx_dR[0]=(dd[5]-dd[4]);
+  dZx_dR[1]=(dd[0]-dd[5]);
+  dZx_dR[2]=(dd[1]-dd[0]);
+  dZx_dR[3]=(dd[2]+dd[3]-dd[1]);
+  dZx_dR[4]=(dd[4]-dd[3]-dd[2]);
 
-  dZy_dR[0]=(dd4-dd5);
-  dZy_dR[1]=(dd0+dd5);
-  dZy_dR[2]=(dd1-dd0);
-  dZy_dR[3]=(dd2-dd3-dd1);
-  dZy_dR[4]=(dd3-dd4-dd2);
+  dZy_dR[0]=(dd[4]-dd[5]);
+  dZy_dR[1]=(dd[0]+dd[5]);
+  dZy_dR[2]=(dd[1]-dd[0]);
+  dZy_dR[3]=(dd[2]-dd[3]-dd[1]);
+  dZy_dR[4]=(dd[3]-dd[4]-dd[2]);
 
-  for(unsigned j=0; j<5; j++) dZx_dR[j]*=(1.0/(2.0*cos(4.0*pi/5.0)));
-  for(unsigned j=0; j<5; j++) dZy_dR[j]*=(1.0/(2.0*sin(4.0*pi/5.0)));
+  for(unsigned j=0; j<5; j++) dZx_dR[j]*=izx;
+  for(unsigned j=0; j<5; j++) dZy_dR[j]*=izy;
 
   Vector dphase_dR[5];
   for(unsigned j=0; j<5; j++) dphase_dR[j]=(1.0/(Zx*Zx+Zy*Zy))*(-Zy*dZx_dR[j] + Zx*dZy_dR[j]);
@@ -205,6 +205,7 @@ RMSD::RMSD(const ActionOptions&ao):
   rmsd->getAtomRequests( atoms );
 //  rmsd->setNumberOfAtoms( atoms.size() );
   requestAtoms( atoms );
+  useSoAPositions();
 
   // Setup the derivative pack
   myvals.resize( 1, 3*atoms.size()+9 ); mypack.resize( 0, atoms.size() );
@@ -0,0 +1,169 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Colvar.h"
+#include "ActionRegister.h"
+#include "tools/Torsion.h"
+#include "tools/OpenMP.h"
+
+#include <string>
+#include <cmath>
+
+using namespace std;
+
+namespace PLMD {
+namespace colvar {
+
+//+PLUMEDOC COLVAR TORSION_LIST
+/*
+Calculate many torsional angles in a single action.
+
+Each numbered ATOMS keyword specifies the four atoms of one dihedral and
+produces one component, so this action is equivalent to a list of
+\ref TORSION actions with ATOMS keywords:
+
+\plumedfile
+t: TORSION_LIST ATOMS1=1,2,3,4 ATOMS2=5,6,7,8 ATOMS3=9,10,11,12
+PRINT ARG=t.tor-1,t.tor-2,t.tor-3 FILE=COLVAR
+\endplumedfile
+
+The advantage over separate TORSION actions is that all the dihedrals are
+computed in one pass over a contiguous list of atom quadruplets, which
+avoids the per-action overhead and is significantly faster for inputs
+that define hundreds of backbone dihedrals. The components can be used
+exactly like the values of individual TORSION actions, e.g. as arguments
+of \ref METAD or \ref PRINT.
+
+As for \ref TORSION, the COSINE flag makes the action compute the cosine
+of each dihedral instead of the angle itself.
+
+*/
+//+ENDPLUMEDOC
+
+class TorsionList : public Colvar {
+  bool pbc;
+  bool do_cosine;
+  unsigned ntorsions;
+
+public:
+  explicit TorsionList(const ActionOptions&);
+// active methods:
+  void calculate() override;
+  static void registerKeywords(Keywords& keys);
+};
+
+PLUMED_REGISTER_ACTION(TorsionList,"TORSION_LIST")
+
+void TorsionList::registerKeywords(Keywords& keys) {
+  Colvar::registerKeywords( keys );
+  keys.add("numbered","ATOMS","the four atoms involved in each of the torsional angles you wish to calculate. "
+           "Keywords like ATOMS1, ATOMS2, ATOMS3,... should be listed and one torsion will be "
+           "calculated for each ATOMS keyword you specify.");
+  keys.reset_style("ATOMS","atoms");
+  keys.addFlag("COSINE",false,"calculate cosine instead of dihedral");
+  keys.addOutputComponent("tor","default","the torsion angles calculated from each of the ATOMS keywords");
+}
+
+TorsionList::TorsionList(const ActionOptions&ao):
+  PLUMED_COLVAR_INIT(ao),
+  pbc(true),
+  do_cosine(false),
+  ntorsions(0)
+{
+  parseFlag("COSINE",do_cosine);
+
+  bool nopbc=!pbc;
+  parseFlag("NOPBC",nopbc);
+  pbc=!nopbc;
+
+  std::vector<AtomNumber> t, all_atoms;
+  for(int i=1;; ++i ) {
+    parseAtomList("ATOMS", i, t );
+    if( t.empty() ) break;
+    if( t.size()!=4 ) {
+      std::string ss; Tools::convert(i,ss);
+      error("ATOMS" + ss + " keyword has the wrong number of atoms");
+    }
+    log.printf("  torsion %d between atoms %d %d %d %d\n",i,t[0].serial(),t[1].serial(),t[2].serial(),t[3].serial());
+    for(unsigned j=0; j<4; ++j) all_atoms.push_back(t[j]);
+    t.resize(0);
+
+    std::string num; Tools::convert(i,num);
+    addComponentWithDerivatives("tor-"+num);
+    if(!do_cosine) componentIsPeriodic("tor-"+num,"-pi","pi");
+    else componentIsNotPeriodic("tor-"+num);
+    ntorsions++;
+  }
+  if( ntorsions==0 ) error("at least one torsion should be specified using the ATOMS keywords");
+
+  if(pbc) log.printf("  using periodic boundary conditions\n");
+  else    log.printf("  without periodic boundary conditions\n");
+
+  if(do_cosine) log.printf("  calculating cosine instead of torsion\n");
+
+  checkRead();
+  requestAtoms(all_atoms);
+}
+
+// calculator
+void TorsionList::calculate() {
+
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt*8>ntorsions) nt=1;
+  // every torsion writes to its own component and to the derivatives of
+  // its own four atoms, so the quadruplets can be processed independently
+  #pragma omp parallel for num_threads(nt)
+  for(unsigned i=0; i<ntorsions; ++i) {
+    const Vector p0=getPosition(4*i+0);
+    const Vector p1=getPosition(4*i+1);
+    const Vector p2=getPosition(4*i+2);
+    const Vector p3=getPosition(4*i+3);
+    Vector d0,d1,d2;
+    if(pbc) {
+      d0=pbcDistance(p1,p0);
+      d1=pbcDistance(p2,p1);
+      d2=pbcDistance(p3,p2);
+    } else {
+      d0=delta(p1,p0);
+      d1=delta(p2,p1);
+      d2=delta(p3,p2);
+    }
+    Vector dd0,dd1,dd2;
+    PLMD::Torsion t;
+    double torsion=t.compute(d0,d1,d2,dd0,dd1,dd2);
+    if(do_cosine) {
+      dd0 *= -sin(torsion);
+      dd1 *= -sin(torsion);
+      dd2 *= -sin(torsion);
+      torsion = cos(torsion);
+    }
+    Value* val=getPntrToComponent(i);
+    setAtomsDerivatives(val,4*i+0,dd0);
+    setAtomsDerivatives(val,4*i+1,dd1-dd0);
+    setAtomsDerivatives(val,4*i+2,dd2-dd1);
+    setAtomsDerivatives(val,4*i+3,-dd2);
+    val->set(torsion);
+    setBoxDerivatives(val,-(Tensor(d0,dd0)+Tensor(d1,dd1)+Tensor(d2,dd2)));
+  }
+}
+
+}
+}
@@ -60,8 +60,12 @@ Action::Action(const ActionOptions&ao):
   update_from(std::numeric_limits<double>::max()),
   update_until(std::numeric_limits<double>::max()),
   active(false),
+  dormant(false),
   restart(ao.plumed.getRestart()),
   doCheckPoint(ao.plumed.getCPT()),
+  profile_ctime(0.0),
+  profile_atime(0.0),
+  profile_calls(0),
   plumed(ao.plumed),
   log(plumed.getLog()),
   comm(plumed.comm),
@@ -168,6 +172,9 @@ void Action::addDependency(Action*action) {
 }
 
 void Action::activate() {
+// a dormant action stays inactive, together with any dependency that is
+// not needed by some other active action
+  if(dormant) return;
 // preparation step is called only the first time an Action is activated.
 // since it could change its dependences (e.g. in an ActionAtomistic which is
 // accessing to a virtual atom), this is done just before dependencies are
@@ -82,6 +82,17 @@ public:
 /// Check if action should be updated.
   bool checkUpdate()const;
 
+/// Accumulate profiling data for the forward loop (used by PlumedMain)
+  void profileAddCalculate(double t) {profile_ctime+=t; profile_calls++;}
+/// Accumulate profiling data for the backward loop (used by PlumedMain)
+  void profileAddApply(double t) {profile_atime+=t;}
+/// Time spent in calculate, in seconds
+  double getCalculateTime()const {return profile_ctime;}
+/// Time spent in apply, in seconds
+  double getApplyTime()const {return profile_atime;}
+/// Number of times calculate has been invoked
+  unsigned long getCalculateCount()const {return profile_calls;}
+
 public:
   typedef std::vector<Action*> Dependencies;
 
@@ -92,6 +103,11 @@ private:
 /// Switch to activate Action on this step.
   bool active;
 
+/// A dormant Action refuses activation, so it is excluded from the
+/// scheduler and, if atomistic, from the set of atoms shared with the
+/// MD code. Used by UPDATE_IF to make inactive blocks truly free.
+  bool dormant;
+
 /// Option that you might have enabled
   std::set<std::string> options;
 
@@ -99,6 +115,13 @@ private:
 
   bool doCheckPoint;
 
+/// Wall-clock time accumulated in calculate and apply and the number of
+/// calculate calls. These are always collected by PlumedMain and reported
+/// in the per-action profile at the end of the run.
+  double profile_ctime;
+  double profile_atime;
+  unsigned long profile_calls;
+
 public:
 
 /// Reference to main plumed object
@@ -250,6 +273,12 @@ public:
 /// Check if action is active
   bool isActive()const;
 
+/// Make the action refuse (true) or accept (false) activation
+  void setDormant(const bool& d);
+
+/// Check if the action is dormant
+  bool isDormant()const;
+
 /// Check if an option is on
   bool isOptionOn(const std::string &s)const;
 
@@ -417,6 +446,16 @@ bool Action::isActive()const {
   return active;
 }
 
+inline
+void Action::setDormant(const bool& d) {
+  dormant=d;
+}
+
+inline
+bool Action::isDormant()const {
+  return dormant;
+}
+
 inline
 bool Action::isOptionOn(const std::string &s)const {
   return options.count(s);
@@ -25,6 +25,7 @@
 #include "GenericMolInfo.h"
 #include <vector>
 #include <string>
+#include <algorithm>
 #include "ActionWithValue.h"
 #include "Colvar.h"
 #include "ActionWithVirtualAtom.h"
@@ -40,13 +41,20 @@ namespace PLMD {
 ActionAtomistic::~ActionAtomistic() {
 // forget the pending request
   atoms.remove(this);
+  if(soapositions) atoms.releaseSoAPositions();
 }
 
 ActionAtomistic::ActionAtomistic(const ActionOptions&ao):
   Action(ao),
+  uniqueSerial(0),
+  virtualAtomsRequested(false),
+  epoch(1),
+  forcesClearedEpoch(0),
   lockRequestAtoms(false),
   donotretrieve(false),
   donotforce(false),
+  soapositions(false),
+  globalstatemodifier(false),
   atoms(plumed.getAtoms())
 {
   atoms.add(this);
@@ -61,17 +69,63 @@ void ActionAtomistic::registerKeywords( Keywords& keys ) {
 void ActionAtomistic::requestAtoms(const vector<AtomNumber> & a, const bool clearDep) {
   plumed_massert(!lockRequestAtoms,"requested atom list can only be changed in the prepare() method");
   int nat=a.size();
+  int n=atoms.positions.size();
+
+// unchanged request: everything below would rebuild to its current content,
+// so leave the tables and the serial alone, which also lets Atoms keep its
+// cached merged unique set
+  if( a==indexes ) return;
+
+// when the request differs from the previous one by a few atoms, as with
+// neighbor-list driven requests, patch the unique set instead of rebuilding
+// it from scratch.  Virtual atoms enter the dependency list rather than the
+// unique set and force the full path below
+  if( !virtualAtomsRequested && !indexes.empty() ) {
+    int dn=nat-static_cast<int>(indexes.size()); if(dn<0) dn=-dn;
+    if( 8*dn<nat ) {
+      std::vector<AtomNumber> sorted_old(indexes), sorted_new(a);
+      std::sort(sorted_old.begin(),sorted_old.end());
+      std::sort(sorted_new.begin(),sorted_new.end());
+      std::vector<AtomNumber> added, removed;
+      std::set_difference(sorted_new.begin(),sorted_new.end(),sorted_old.begin(),sorted_old.end(),std::back_inserter(added));
+      std::set_difference(sorted_old.begin(),sorted_old.end(),sorted_new.begin(),sorted_new.end(),std::back_inserter(removed));
+      if( 8*(added.size()+removed.size())<static_cast<unsigned>(nat) ) {
+        bool incremental=true;
+        for(unsigned i=0; i<added.size(); i++) {
+          if(added[i].index()>=static_cast<unsigned>(n)) { std::string num; Tools::convert( added[i].serial(),num ); error("atom " + num + " out of range"); }
+          if(atoms.isVirtualAtom(added[i])) { incremental=false; break; }
+        }
+        if(incremental) {
+          for(unsigned i=0; i<removed.size(); i++) {
+// requests can contain duplicates: only drop atoms that no longer appear at all
+            if( !std::binary_search(sorted_new.begin(),sorted_new.end(),removed[i]) ) unique.erase(removed[i]);
+          }
+          for(unsigned i=0; i<added.size(); i++) unique.insert(added[i]);
+          indexes=a;
+          positions.resize(nat);
+          forces.resize(nat);
+          masses.resize(nat);
+          charges.resize(nat);
+          if(clearDep) clearDependencies();
+          updateUniqueLocal();
+          atoms.unique.clear();
+          return;
+        }
+      }
+    }
+  }
+
   indexes=a;
   positions.resize(nat);
   forces.resize(nat);
   masses.resize(nat);
   charges.resize(nat);
-  int n=atoms.positions.size();
   if(clearDep) clearDependencies();
   unique.clear();
+  virtualAtomsRequested=false;
   for(unsigned i=0; i<indexes.size(); i++) {
     if(indexes[i].index()>=n) { std::string num; Tools::convert( indexes[i].serial(),num ); error("atom " + num + " out of range"); }
-    if(atoms.isVirtualAtom(indexes[i])) addDependency(atoms.getVirtualAtomsAction(indexes[i]));
+    if(atoms.isVirtualAtom(indexes[i])) { addDependency(atoms.getVirtualAtomsAction(indexes[i])); virtualAtomsRequested=true; }
 // only real atoms are requested to lower level Atoms class
     else unique.insert(indexes[i]);
   }
@@ -223,6 +277,9 @@ void ActionAtomistic::interpretAtomList( std::vector<std::string>& strings, std:
 
 
 void ActionAtomistic::retrieveAtoms() {
+// complete a possibly pending asynchronous position exchange.
+// this is a no-op unless PLUMED_ASYNC_SHARE=overlap is used
+  atoms.completeAsyncShare();
   pbc=atoms.pbc;
   Colvar*cc=dynamic_cast<Colvar*>(this);
   if(cc && cc->checkIsEnergy()) energy=atoms.getEnergy();
@@ -231,13 +288,34 @@ void ActionAtomistic::retrieveAtoms() {
   const vector<Vector> & p(atoms.positions);
   const vector<double> & c(atoms.charges);
   const vector<double> & m(atoms.masses);
-  for(unsigned j=0; j<indexes.size(); j++) positions[j]=p[indexes[j].index()];
+  if(soapositions && atoms.positionsX.size()==p.size()) {
+// gather from the structure-of-arrays mirror: each loop reads a single
+// contiguous array and writes with a constant stride, so it vectorizes
+    const double* px=atoms.positionsX.data();
+    const double* py=atoms.positionsY.data();
+    const double* pz=atoms.positionsZ.data();
+    for(unsigned j=0; j<indexes.size(); j++) positions[j][0]=px[indexes[j].index()];
+    for(unsigned j=0; j<indexes.size(); j++) positions[j][1]=py[indexes[j].index()];
+    for(unsigned j=0; j<indexes.size(); j++) positions[j][2]=pz[indexes[j].index()];
+  } else {
+    for(unsigned j=0; j<indexes.size(); j++) positions[j]=p[indexes[j].index()];
+  }
   for(unsigned j=0; j<indexes.size(); j++) charges[j]=c[indexes[j].index()];
   for(unsigned j=0; j<indexes.size(); j++) masses[j]=m[indexes[j].index()];
 }
 
+void ActionAtomistic::useSoAPositions() {
+  if(!soapositions) {
+    soapositions=true;
+    atoms.requestSoAPositions();
+  }
+}
+
 void ActionAtomistic::setForcesOnAtoms( const std::vector<double>& forcesToApply, unsigned ind ) {
   if(donotforce) return;
+// every element is assigned below, so the lazy clear is not needed, but the
+// epoch must be stamped or applyForces() will treat the forces as unset
+  forcesClearedEpoch=epoch;
   for(unsigned i=0; i<indexes.size(); ++i) {
     forces[i][0]=forcesToApply[ind]; ind++;
     forces[i][1]=forcesToApply[ind]; ind++;
@@ -257,9 +335,18 @@ void ActionAtomistic::setForcesOnAtoms( const std::vector<double>& forcesToApply
 
 void ActionAtomistic::applyForces() {
   if(donotforce) return;
-  vector<Vector>   & f(atoms.forces);
+  if(forcesClearedEpoch==epoch) {
+// the forces were actually accessed during this step
+    vector<Vector>   & f(atoms.forces);
+    for(unsigned j=0; j<indexes.size(); j++) {
+      const unsigned k=indexes[j].index();
+      f[k]+=forces[j];
+// record the atoms that received a force, so that the final scatter to the
+// MD code only needs to visit them
+      if(!atoms.forceTouched[k]) { atoms.forceTouched[k]=1; atoms.touchedAtoms.push_back(k); }
+    }
+  }
   Tensor           & v(atoms.virial);
-  for(unsigned j=0; j<indexes.size(); j++) f[indexes[j].index()]+=forces[j];
   v+=virial;
   atoms.forceOnEnergy+=forceOnEnergy;
   if(extraCV.length()>0) atoms.updateExtraCVForce(extraCV,forceOnExtraCV);
@@ -267,8 +354,11 @@ void ActionAtomistic::applyForces() {
 
 void ActionAtomistic::clearOutputForces() {
   virial.zero();
+// bumping the epoch invalidates the forces and the arena buffers without
+// touching their memory: the forces are zeroed again on the first
+// modifyForces() of the step
+  ++epoch;
   if(donotforce) return;
-  for(unsigned i=0; i<forces.size(); ++i)forces[i].zero();
   forceOnEnergy=0.0;
   forceOnExtraCV=0.0;
 }
@@ -296,6 +386,7 @@ void ActionAtomistic::makeWhole() {
 }
 
 void ActionAtomistic::updateUniqueLocal() {
+  ++uniqueSerial;
   unique_local.clear();
   if(atoms.dd && atoms.shuffledAtoms>0) {
     for(auto pp=unique.begin(); pp!=unique.end(); ++pp) {
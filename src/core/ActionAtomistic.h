@@ -47,6 +47,13 @@ class ActionAtomistic :
   std::set<AtomNumber>  unique;
 /// unique_local should be an ordered set since we later create a vector containing the corresponding indexes
   std::set<AtomNumber>  unique_local;
+/// incremented every time unique or unique_local changes; Atoms uses it to
+/// detect stale cached unions without comparing the sets element by element
+  unsigned              uniqueSerial;
+/// true when the current request contains virtual atoms; those enter the
+/// dependency list rather than the unique set and rule out the incremental
+/// update of the request
+  bool                  virtualAtomsRequested;
   std::vector<Vector>   positions;       // positions of the needed atoms
   double                energy;
   ForwardDecl<Pbc>      pbc_fwd;
@@ -57,6 +64,14 @@ class ActionAtomistic :
   std::vector<double>   charges;
 
   std::vector<Vector>   forces;          // forces on the needed atoms
+/// the forces and the arena buffers are invalidated by bumping the epoch in
+/// clearOutputForces() and are zeroed lazily when they are next accessed,
+/// so that untouched buffers cost nothing
+  unsigned long         epoch;
+  unsigned long         forcesClearedEpoch;
+/// step-stable scratch buffers handed out by getDerivativeBuffer()
+  std::vector<std::vector<double> > derivativeArena;
+  std::vector<unsigned long> derivativeArenaEpoch;
   double                forceOnEnergy;
 
   double                forceOnExtraCV;
@@ -67,6 +82,8 @@ class ActionAtomistic :
 
   bool                  donotretrieve;
   bool                  donotforce;
+  bool                  soapositions;
+  bool                  globalstatemodifier;
 
 protected:
   Atoms&                atoms;
@@ -119,8 +136,19 @@ public:
   double getMass(int i)const;
 /// Get charge of i-th atom
   double getCharge(int i)const;
-/// Get a reference to forces array
+/// Get a reference to forces array.
+/// The array is zeroed on the first access of each step
   std::vector<Vector> & modifyForces();
+/// Make sure the derivative arena has at least n buffer slots.
+/// Must be called outside of OpenMP parallel regions
+  void reserveDerivativeBuffers(unsigned n);
+/// Get a step-stable scratch buffer of n doubles from the derivative arena.
+/// Buffers persist across steps, so that no allocation happens once the
+/// sizes have settled. On return stale tells whether the buffer was last
+/// written in a previous step: a stale buffer holds undefined data, and
+/// callers that do not overwrite it completely have to zero it themselves.
+/// Thread safe on distinct slots
+  std::vector<double> & getDerivativeBuffer(unsigned slot,unsigned n,bool & stale);
 /// Get a reference to virial array
   Tensor & modifyVirial();
 /// Get a reference to force on energy
@@ -159,13 +187,25 @@ public:
 /// If this function is called during initialization, then forces are
 /// not going to be propagated. Can be used for optimization.
   void doNotForce() {donotforce=true;}
+/// Gather positions from a structure-of-arrays mirror (separate x/y/z arrays)
+/// maintained by Atoms. If this function is called during initialization,
+/// retrieveAtoms() gathers positions with three contiguous, vectorizable
+/// loops instead of an array-of-structures copy. Useful for actions that
+/// request large numbers of atoms.
+  void useSoAPositions();
 /// Make atoms whole, assuming they are in the proper order
   void makeWhole();
 /// Allow calls to modifyGlobalForce()
   void allowToAccessGlobalForces() {atoms.zeroallforces=true;}
+/// Declare that calculate() rewrites shared state (e.g. through
+/// modifyGlobalPosition), so that the forward loop schedule serializes
+/// this action against every action that follows it in the input
+  void declareGlobalStateModifier() {globalstatemodifier=true;}
 /// updates local unique atoms
   void updateUniqueLocal();
 public:
+/// Whether calculate() rewrites shared state, see declareGlobalStateModifier()
+  bool modifiesGlobalState() const {return globalstatemodifier;}
 
 // virtual functions:
 
@@ -189,6 +229,8 @@ public:
   void unlockRequests() override;
   const std::set<AtomNumber> & getUnique()const;
   const std::set<AtomNumber> & getUniqueLocal()const;
+/// Serial number identifying the current atom request list, see uniqueSerial
+  unsigned getUniqueSerial()const;
 /// Read in an input file containing atom positions and calculate the action for the atomic
 /// configuration therin
   void readAtomsFromPDB( const PDB& pdb ) override;
@@ -211,6 +253,8 @@ Vector & ActionAtomistic::modifyGlobalPosition(AtomNumber i) {
 
 inline
 Vector & ActionAtomistic::modifyGlobalForce(AtomNumber i) {
+// mark the atom as touched, so that the final force scatter visits it
+  if(!atoms.forceTouched[i.index()]) { atoms.forceTouched[i.index()]=1; atoms.touchedAtoms.push_back(i.index()); }
   return atoms.forces[i.index()];
 }
 
@@ -257,9 +301,31 @@ const Tensor & ActionAtomistic::getBox()const {
 
 inline
 std::vector<Vector> & ActionAtomistic::modifyForces() {
+  if(forcesClearedEpoch!=epoch) {
+    forcesClearedEpoch=epoch;
+    for(unsigned i=0; i<forces.size(); ++i) forces[i].zero();
+  }
   return forces;
 }
 
+inline
+void ActionAtomistic::reserveDerivativeBuffers(unsigned n) {
+  if(derivativeArena.size()<n) {
+    derivativeArena.resize(n);
+    derivativeArenaEpoch.resize(n,0);
+  }
+}
+
+inline
+std::vector<double> & ActionAtomistic::getDerivativeBuffer(unsigned slot,unsigned n,bool & stale) {
+  plumed_dbg_assert(slot<derivativeArena.size());
+  std::vector<double> & buffer(derivativeArena[slot]);
+  if(buffer.size()!=n) buffer.resize(n);
+  stale=(derivativeArenaEpoch[slot]!=epoch);
+  derivativeArenaEpoch[slot]=epoch;
+  return buffer;
+}
+
 inline
 Tensor & ActionAtomistic::modifyVirial() {
   return virial;
@@ -300,6 +366,11 @@ const std::set<AtomNumber> & ActionAtomistic::getUniqueLocal()const {
   return unique_local;
 }
 
+inline
+unsigned ActionAtomistic::getUniqueSerial()const {
+  return uniqueSerial;
+}
+
 inline
 unsigned ActionAtomistic::getTotAtoms()const {
   return atoms.positions.size();
@@ -45,6 +45,7 @@ ActionRegister& actionRegister() {
 void ActionRegister::remove(creator_pointer f) {
   for(auto p=m.begin(); p!=m.end(); ++p) {
     if((*p).second==f) {
+      mk_cache.erase((*p).first);
       m.erase(p); break;
     }
   }
@@ -55,6 +56,7 @@ void ActionRegister::add(string key,creator_pointer f,keywords_pointer k) {
   if ( std::any_of( std::begin( key ), std::end( key ), []( char c ) { return ( islower( c ) ); } ) ) plumed_error() << "Action: " + key + " cannot be registered, use only UPPERCASE characters";
   if(m.count(key)) {
     m.erase(key);
+    mk_cache.erase(key);
     disabled.insert(key);
   } else {
     m.insert(pair<string,creator_pointer>(key,f));
@@ -80,8 +82,17 @@ std::unique_ptr<Action> ActionRegister::create(const ActionOptions&ao) {
   // in the input.
   std::unique_ptr<Action> action;
   if( check(ao.line[0]) ) {
-    Keywords keys; mk[ao.line[0]](keys);
-    ActionOptions nao( ao,keys );
+    // The keywords for each action type are built only once and then
+    // cached in the register. Keyword registration involves many string
+    // and vector manipulations and was showing up in the startup cost of
+    // inputs with many actions. The cached object is persistent, so the
+    // reference kept by the Action remains valid after construction.
+    auto ck=mk_cache.find(ao.line[0]);
+    if(ck==mk_cache.end()) {
+      Keywords keys; mk[ao.line[0]](keys);
+      ck=mk_cache.emplace(ao.line[0],std::move(keys)).first;
+    }
+    ActionOptions nao( ao,ck->second );
     action=m[ao.line[0]](nao);
   }
   return action;
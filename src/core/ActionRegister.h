@@ -23,7 +23,7 @@
 #define __PLUMED_core_ActionRegister_h
 
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <set>
 #include <iosfwd>
 #include "tools/Keywords.h"
@@ -50,10 +50,18 @@ class ActionRegister {
   typedef std::unique_ptr<Action>(*creator_pointer)(const ActionOptions&);
 /// Pointer to a function which, returns the keywords allowed
   typedef void(*keywords_pointer)(Keywords&);
-/// Map action to a function which creates the related object
-  std::map<std::string,creator_pointer> m;
+/// Map action to a function which creates the related object.
+/// Hashed maps are used so that resolving a directive does not cost a
+/// chain of string comparisons; a build-time perfect hash is not possible
+/// here since directives are registered dynamically (e.g. with LOAD)
+  std::unordered_map<std::string,creator_pointer> m;
 /// Map action to a function which documents the related object
-  std::map<std::string,keywords_pointer> mk;
+  std::unordered_map<std::string,keywords_pointer> mk;
+/// The keywords of every action type are built once, the first time an
+/// action of that type is created, and then reused. The cached object
+/// also outlives the created actions, so the reference they keep to it
+/// stays valid for their whole lifetime
+  std::unordered_map<std::string,Keywords> mk_cache;
 /// Set of disabled actions (which were registered more than once)
   std::set<std::string> disabled;
 public:
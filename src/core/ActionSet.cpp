@@ -38,6 +38,9 @@ ActionSet::~ActionSet()
 void ActionSet::clearDelete() {
   for(int i=size()-1; i>=0; i--) (*this)[i].reset();
   clear();
+// drop the cached views: the size check alone cannot detect a clear
+// followed by a refill with the same number of actions
+  views.clear();
 }
 
 }
@@ -24,6 +24,8 @@
 
 #include "Action.h"
 #include <memory>
+#include <map>
+#include <typeindex>
 
 namespace PLMD {
 
@@ -40,6 +42,28 @@ class ActionSet:
   public std::vector<std::unique_ptr<Action>>
 {
   PlumedMain& plumed;
+/// Base class for the type-erased cached views built by select()
+  class TypedViewBase {
+  public:
+    virtual ~TypedViewBase() {}
+/// Number of actions in the set when the view was built, used for invalidation
+    unsigned nactions;
+  };
+/// A cached list of the actions that can be cast to T
+  template <class T>
+  class TypedView:
+    public TypedViewBase
+  {
+  public:
+    std::vector<T> view;
+  };
+/// Cached views indexed by type.  Views are built lazily on the first
+/// select<T>() and rebuilt when the number of actions has changed, so that
+/// repeated enumerations of the same type do not redo the dynamic_cast over
+/// the whole set.  Actions are only ever appended or cleared wholesale
+/// (see clearDelete(), which also drops the views), which makes the size
+/// check a sufficient invalidation rule
+  mutable std::map<std::type_index,std::unique_ptr<TypedViewBase>> views;
 public:
   explicit ActionSet(PlumedMain&p);
   ~ActionSet();
@@ -48,6 +72,9 @@ public:
 
 /// Extract pointers to all Action's of type T
 /// To extract all Colvar , use select<Colvar*>();
+/// The result is served from a cached view so that calling this
+/// repeatedly (e.g. once per step) costs an array copy rather than a
+/// dynamic_cast over the whole set
   template <class T>
   std::vector<T> select()const;
 /// Extract pointers to all Action's which are not of type T
@@ -82,12 +109,22 @@ public:
 
 template <class T>
 std::vector<T> ActionSet::select()const {
-  std::vector<T> ret;
-  for(const auto & p : (*this)) {
-    T t=dynamic_cast<T>(p.get());
-    if(t) ret.push_back(t);
-  };
-  return ret;
+  std::unique_ptr<TypedViewBase> & holder=views[std::type_index(typeid(T))];
+  TypedView<T>* tv=static_cast<TypedView<T>*>(holder.get());
+  if( !tv ) {
+    tv=new TypedView<T>();
+    holder.reset(tv);
+    tv->nactions=size()+1; // force the build below
+  }
+  if( tv->nactions!=size() ) {
+    tv->view.clear();
+    for(const auto & p : (*this)) {
+      T t=dynamic_cast<T>(p.get());
+      if(t) tv->view.push_back(t);
+    };
+    tv->nactions=size();
+  }
+  return tv->view;
 }
 
 template <class T>
@@ -70,6 +70,11 @@ void ActionWithValue::clearInputForces() {
 }
 
 void ActionWithValue::clearDerivatives() {
+// with a single value the parallel region below is pure overhead
+  if(values.size()==1) {
+    values[0]->clearDerivatives();
+    return;
+  }
   unsigned nt = OpenMP::getNumThreads();
   #pragma omp parallel num_threads(nt)
   {
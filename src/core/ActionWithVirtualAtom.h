@@ -92,6 +92,13 @@ AtomNumber ActionWithVirtualAtom::getIndex()const {
 inline
 void ActionWithVirtualAtom::setPosition(const Vector & pos) {
   atoms.positions[index.index()]=pos;
+// keep the structure-of-arrays mirror in sync, since it was refreshed
+// before any virtual atom was computed
+  if(atoms.soaPositionsEnabled() && atoms.positionsX.size()>index.index()) {
+    atoms.positionsX[index.index()]=pos[0];
+    atoms.positionsY[index.index()]=pos[1];
+    atoms.positionsZ[index.index()]=pos[2];
+  }
 }
 
 inline
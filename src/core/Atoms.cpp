@@ -24,6 +24,7 @@
 #include "MDAtoms.h"
 #include "PlumedMain.h"
 #include "tools/Pbc.h"
+#include "tools/Numa.h"
 #include <algorithm>
 #include <iostream>
 #include <string>
@@ -41,6 +42,7 @@ class PlumedMain;
 
 Atoms::Atoms(PlumedMain&plumed):
   natoms(0),
+  soaUsers(0),
   md_energy(0.0),
   energy(0.0),
   dataCanBeSet(false),
@@ -145,14 +147,35 @@ void Atoms::share() {
   }
 
   if(!(int(gatindex.size())==natoms && shuffledAtoms==0)) {
+// check whether unique can be reused from the previous step: it only needs
+// to be rebuilt when some action changed its request list (detected through
+// the per-action serials) or was switched on/off. With a stable set of
+// active actions this reduces to a cheap comparison
+    bool stale=false;
+    unsigned nc=0;
     for(unsigned i=0; i<actions.size(); i++) {
-      if(actions[i]->isActive()) {
-        if(!actions[i]->getUnique().empty()) {
-          atomsNeeded=true;
+      if(actions[i]->isActive() && !actions[i]->getUnique().empty()) {
+        atomsNeeded=true;
+        if(nc>=uniqueContributors.size()
+            || uniqueContributors[nc].first!=actions[i]
+            || uniqueContributors[nc].second!=actions[i]->getUniqueSerial()) stale=true;
+        nc++;
+      }
+    }
+    if(nc!=uniqueContributors.size()) stale=true;
+    if(stale) {
+      unique.clear();
+      uniqueContributors.clear();
+      uniqueContributors.reserve(nc);
+      for(unsigned i=0; i<actions.size(); i++) {
+        if(actions[i]->isActive() && !actions[i]->getUnique().empty()) {
           // unique are the local atoms
-          unique.insert(actions[i]->getUniqueLocal().begin(),actions[i]->getUniqueLocal().end());
+          unique.insert(unique.end(),actions[i]->getUniqueLocal().begin(),actions[i]->getUniqueLocal().end());
+          uniqueContributors.push_back(std::pair<const ActionAtomistic*,unsigned>(actions[i],actions[i]->getUniqueSerial()));
         }
       }
+      std::sort(unique.begin(),unique.end());
+      unique.erase(std::unique(unique.begin(),unique.end()),unique.end());
     }
   } else {
     for(unsigned i=0; i<actions.size(); i++) {
@@ -170,17 +193,18 @@ void Atoms::share() {
 
 void Atoms::shareAll() {
   unique.clear();
+  uniqueContributors.clear();
   // keep in unique only those atoms that are local
   if(dd && shuffledAtoms>0) {
-    for(int i=0; i<natoms; i++) if(g2l[i]>=0) unique.insert(AtomNumber::index(i));
+    for(int i=0; i<natoms; i++) if(g2l[i]>=0) unique.push_back(AtomNumber::index(i));
   } else {
-    for(int i=0; i<natoms; i++) unique.insert(AtomNumber::index(i));
+    for(int i=0; i<natoms; i++) unique.push_back(AtomNumber::index(i));
   }
   atomsNeeded=true;
   share(unique);
 }
 
-void Atoms::share(const std::set<AtomNumber>& unique) {
+void Atoms::share(const std::vector<AtomNumber>& unique) {
   plumed_assert( positionsHaveBeenSet==3 && massesHaveBeenSet );
 
   virial.zero();
@@ -190,6 +214,9 @@ void Atoms::share(const std::set<AtomNumber>& unique) {
     for(const auto & p : unique) forces[p.index()].zero();
   }
   for(unsigned i=getNatoms(); i<positions.size(); i++) forces[i].zero(); // virtual atoms
+// reset the touched-atom mask by visiting only the entries set last step
+  for(unsigned i=0; i<touchedAtoms.size(); i++) forceTouched[touchedAtoms[i]]=0;
+  touchedAtoms.clear();
   forceOnEnergy=0.0;
   mdatoms->getBox(box);
 
@@ -221,6 +248,10 @@ void Atoms::share(const std::set<AtomNumber>& unique) {
 
   if(dd && shuffledAtoms>0) {
     if(dd.async) {
+// in case the previous exchange was never completed (e.g. because no
+// action touched the positions) complete it now, before the receive
+// buffers are reused
+      completeAsyncShare();
       for(unsigned i=0; i<dd.mpi_request_positions.size(); i++) dd.mpi_request_positions[i].wait();
       for(unsigned i=0; i<dd.mpi_request_index.size(); i++)     dd.mpi_request_index[i].wait();
     }
@@ -238,12 +269,56 @@ void Atoms::share(const std::set<AtomNumber>& unique) {
     }
     if(dd.async) {
       asyncSent=true;
-      dd.mpi_request_positions.resize(dd.Get_size());
-      dd.mpi_request_index.resize(dd.Get_size());
-      for(int i=0; i<dd.Get_size(); i++) {
-        dd.mpi_request_index[i]=dd.Isend(&dd.indexToBeSent[0],count,i,666);
-        dd.mpi_request_positions[i]=dd.Isend(&dd.positionsToBeSent[0],ndata*count,i,667);
+      dd.ndataAsync=ndata;
+      const int n=dd.Get_size();
+      dd.mpi_request_positions.resize(n);
+      dd.mpi_request_index.resize(n);
+      dd.mpi_request_recv_positions.resize(n);
+      dd.mpi_request_recv_index.resize(n);
+// exchange the message sizes, so that exactly matching receives can be
+// posted here and completed later, in completeAsyncShare()
+      vector<int> counts(n);
+      dd.Allgather(count,counts);
+      vector<int> displ(n);
+      displ[0]=0;
+      for(int i=1; i<n; ++i) displ[i]=displ[i-1]+counts[i-1];
+      dd.totAsync=displ[n-1]+counts[n-1];
+// the exchange uses persistent requests: they are created only when the
+// counts or the buffer addresses change, and merely restarted otherwise
+      const bool rebuild = !dd.persistentValid
+                           || dd.persistentCount!=count
+                           || dd.persistentNdata!=ndata
+                           || dd.persistentCounts!=counts
+                           || dd.persistentSendIndex!=(const void*)dd.indexToBeSent.data()
+                           || dd.persistentSendPos!=(const void*)dd.positionsToBeSent.data()
+                           || dd.persistentRecvIndex!=(const void*)dd.indexToBeReceived.data()
+                           || dd.persistentRecvPos!=(const void*)dd.positionsToBeReceived.data();
+      if(rebuild) {
+        if(dd.persistentValid) {
+          for(unsigned i=0; i<dd.mpi_request_recv_index.size(); i++)     Communicator::Free(dd.mpi_request_recv_index[i]);
+          for(unsigned i=0; i<dd.mpi_request_recv_positions.size(); i++) Communicator::Free(dd.mpi_request_recv_positions[i]);
+          for(unsigned i=0; i<dd.mpi_request_index.size(); i++)          Communicator::Free(dd.mpi_request_index[i]);
+          for(unsigned i=0; i<dd.mpi_request_positions.size(); i++)      Communicator::Free(dd.mpi_request_positions[i]);
+        }
+        for(int i=0; i<n; i++) {
+          dd.mpi_request_recv_index[i]=dd.RecvInit(dd.indexToBeReceived.data()+displ[i],counts[i],i,666);
+          dd.mpi_request_recv_positions[i]=dd.RecvInit(dd.positionsToBeReceived.data()+ndata*displ[i],ndata*counts[i],i,667);
+          dd.mpi_request_index[i]=dd.SendInit(&dd.indexToBeSent[0],count,i,666);
+          dd.mpi_request_positions[i]=dd.SendInit(&dd.positionsToBeSent[0],ndata*count,i,667);
+        }
+        dd.persistentValid=true;
+        dd.persistentCount=count;
+        dd.persistentNdata=ndata;
+        dd.persistentCounts=counts;
+        dd.persistentSendIndex=dd.indexToBeSent.data();
+        dd.persistentSendPos=dd.positionsToBeSent.data();
+        dd.persistentRecvIndex=dd.indexToBeReceived.data();
+        dd.persistentRecvPos=dd.positionsToBeReceived.data();
       }
+      Communicator::StartAll(dd.mpi_request_recv_index);
+      Communicator::StartAll(dd.mpi_request_recv_positions);
+      Communicator::StartAll(dd.mpi_request_index);
+      Communicator::StartAll(dd.mpi_request_positions);
     } else {
       const int n=(dd.Get_size());
       vector<int> counts(n);
@@ -273,9 +348,6 @@ void Atoms::share(const std::set<AtomNumber>& unique) {
 
 void Atoms::wait() {
   dataCanBeSet=false; // Everything should be set by this stage
-// How many double per atom should be scattered
-  int ndata=3;
-  if(!massAndChargeOK)ndata=5;
 
   if(dd) {
     dd.Bcast(box,0);
@@ -284,33 +356,51 @@ void Atoms::wait() {
 
   if(collectEnergy) energy=md_energy;
 
+  bool refreshed=false;
   if(dd && shuffledAtoms>0) {
-// receive toBeReceived
-    if(asyncSent) {
-      Communicator::Status status;
-      int count=0;
-      for(int i=0; i<dd.Get_size(); i++) {
-        dd.Recv(&dd.indexToBeReceived[count],dd.indexToBeReceived.size()-count,i,666,status);
-        int c=status.Get_count<int>();
-        dd.Recv(&dd.positionsToBeReceived[ndata*count],dd.positionsToBeReceived.size()-ndata*count,i,667);
-        count+=c;
-      }
-      for(int i=0; i<count; i++) {
-        positions[dd.indexToBeReceived[i]][0]=dd.positionsToBeReceived[ndata*i+0];
-        positions[dd.indexToBeReceived[i]][1]=dd.positionsToBeReceived[ndata*i+1];
-        positions[dd.indexToBeReceived[i]][2]=dd.positionsToBeReceived[ndata*i+2];
-        if(!massAndChargeOK) {
-          masses[dd.indexToBeReceived[i]]      =dd.positionsToBeReceived[ndata*i+3];
-          charges[dd.indexToBeReceived[i]]     =dd.positionsToBeReceived[ndata*i+4];
-        }
-      }
-      asyncSent=false;
+// receive toBeReceived. in overlap mode this is deferred to the moment
+// in which an action first accesses the positions, so that the exchange
+// can overlap with the force computation of the MD code
+    if(asyncSent && !dd.overlap) {
+      completeAsyncShare();
+      refreshed=soaUsers>0;
     }
     if(collectEnergy) dd.Sum(energy);
   }
 // I take note that masses and charges have been set once for all
 // at the beginning of the simulation.
   if(shareMassAndChargeOnlyAtFirstStep) massAndChargeOK=true;
+
+  if(soaUsers>0 && !asyncSent && !refreshed) refreshSoAPositions();
+}
+
+void Atoms::completeAsyncShare() {
+  if(!asyncSent) return;
+  const int ndata=dd.ndataAsync;
+  for(unsigned i=0; i<dd.mpi_request_recv_index.size(); i++)     dd.mpi_request_recv_index[i].wait();
+  for(unsigned i=0; i<dd.mpi_request_recv_positions.size(); i++) dd.mpi_request_recv_positions[i].wait();
+  for(int i=0; i<dd.totAsync; i++) {
+    positions[dd.indexToBeReceived[i]][0]=dd.positionsToBeReceived[ndata*i+0];
+    positions[dd.indexToBeReceived[i]][1]=dd.positionsToBeReceived[ndata*i+1];
+    positions[dd.indexToBeReceived[i]][2]=dd.positionsToBeReceived[ndata*i+2];
+    if(ndata>3) {
+      masses[dd.indexToBeReceived[i]]      =dd.positionsToBeReceived[ndata*i+3];
+      charges[dd.indexToBeReceived[i]]     =dd.positionsToBeReceived[ndata*i+4];
+    }
+  }
+  asyncSent=false;
+  if(soaUsers>0) refreshSoAPositions();
+}
+
+void Atoms::refreshSoAPositions() {
+  const unsigned n=positions.size();
+  positionsX.resize(n);
+  positionsY.resize(n);
+  positionsZ.resize(n);
+// three separate loops so that each of them can be vectorized
+  for(unsigned i=0; i<n; i++) positionsX[i]=positions[i][0];
+  for(unsigned i=0; i<n; i++) positionsY[i]=positions[i][1];
+  for(unsigned i=0; i<n; i++) positionsZ[i]=positions[i][2];
 }
 
 void Atoms::updateForces() {
@@ -320,8 +410,11 @@ void Atoms::updateForces() {
     mdatoms->rescaleForces(gatindex,alpha);
     mdatoms->updateForces(gatindex,forces);
   } else {
-    if(int(gatindex.size())==natoms && shuffledAtoms==0) mdatoms->updateForces(gatindex,forces);
-    else mdatoms->updateForces(unique,uniq_index,forces);
+    if(int(gatindex.size())==natoms && shuffledAtoms==0) {
+// local and global indexes coincide here: scatter only the atoms that
+// actually received a force, instead of sweeping the whole local array
+      mdatoms->updateTouchedForces(touchedAtoms,natoms,forces);
+    } else mdatoms->updateForces(unique,uniq_index,forces);
   }
   if( !plumed.novirial && dd.Get_rank()==0 ) {
     plumed_assert( virialHasBeenSet );
@@ -331,8 +424,11 @@ void Atoms::updateForces() {
 
 void Atoms::setNatoms(int n) {
   natoms=n;
-  positions.resize(n);
-  forces.resize(n);
+// positions and forces are read and written by loops with no fixed thread
+// affinity, so their pages are interleaved over the threads at first touch
+  Numa::interleavedResize(positions,n);
+  Numa::interleavedResize(forces,n);
+  forceTouched.resize(n);
   masses.resize(n);
   charges.resize(n);
   gatindex.resize(n);
@@ -348,6 +444,9 @@ void Atoms::remove(ActionAtomistic*a) {
   auto f=find(actions.begin(),actions.end(),a);
   plumed_massert(f!=actions.end(),"cannot remove an action registered to atoms");
   actions.erase(f);
+// the removed action might appear in the cached signature; force a rebuild
+  uniqueContributors.clear();
+  unique.clear();
 }
 
 
@@ -355,11 +454,13 @@ void Atoms::DomainDecomposition::enable(Communicator& c) {
   on=true;
   Set_comm(c.Get_comm());
   async=Get_size()<10;
+  overlap=false;
   if(std::getenv("PLUMED_ASYNC_SHARE")) {
     std::string s(std::getenv("PLUMED_ASYNC_SHARE"));
     if(s=="yes") async=true;
     else if(s=="no") async=false;
-    else plumed_merror("PLUMED_ASYNC_SHARE variable is set to " + s + "; should be yes or no");
+    else if(s=="overlap") { async=true; overlap=true; }
+    else plumed_merror("PLUMED_ASYNC_SHARE variable is set to " + s + "; should be yes, no or overlap");
   }
 }
 
@@ -406,6 +507,7 @@ void Atoms::setAtomsGatindex(int*g,bool fortran) {
     actions[i]->updateUniqueLocal();
   }
   unique.clear();
+  uniqueContributors.clear();
 }
 
 void Atoms::setAtomsContiguous(int start) {
@@ -419,6 +521,7 @@ void Atoms::setAtomsContiguous(int start) {
     actions[i]->updateUniqueLocal();
   }
   unique.clear();
+  uniqueContributors.clear();
 }
 
 void Atoms::setRealPrecision(int p) {
@@ -472,15 +575,18 @@ void Atoms::createFullList(int*n) {
 // This is not very clear, and probably should be coded differently.
 // Hopefully this fix the longstanding issue with NAMD.
     unique.clear();
+    uniqueContributors.clear();
     for(unsigned i=0; i<actions.size(); i++) {
       if(actions[i]->isActive()) {
         if(!actions[i]->getUnique().empty()) {
           atomsNeeded=true;
           // unique are the local atoms
-          unique.insert(actions[i]->getUnique().begin(),actions[i]->getUnique().end());
+          unique.insert(unique.end(),actions[i]->getUnique().begin(),actions[i]->getUnique().end());
         }
       }
     }
+    std::sort(unique.begin(),unique.end());
+    unique.erase(std::unique(unique.begin(),unique.end()),unique.end());
     fullList.resize(0);
     fullList.reserve(unique.size());
     for(const auto & p : unique) fullList.push_back(p.index());
@@ -511,8 +617,9 @@ void Atoms::setDomainDecomposition(Communicator& comm) {
 }
 
 void Atoms::resizeVectors(unsigned n) {
-  positions.resize(n);
-  forces.resize(n);
+  Numa::interleavedResize(positions,n);
+  Numa::interleavedResize(forces,n);
+  forceTouched.resize(n);
   masses.resize(n);
   charges.resize(n);
 }
@@ -552,6 +659,24 @@ void Atoms::readBinary(std::istream&i) {
   i.read(reinterpret_cast<char*>(&box(0,0)),9*sizeof(double));
   i.read(reinterpret_cast<char*>(&energy),sizeof(double));
   pbc.setBox(box);
+// positions were overwritten behind the back of wait(), so the mirror
+// must be refreshed here or SoA readers would see the old coordinates
+  if(soaUsers>0) refreshSoAPositions();
+}
+
+void Atoms::writeBinarySubset(std::ostream&o,const std::vector<int>&indices)const {
+  for(unsigned i=0; i<indices.size(); ++i) o.write(reinterpret_cast<const char*>(&positions[indices[i]][0]),3*sizeof(double));
+  o.write(reinterpret_cast<const char*>(&box(0,0)),9*sizeof(double));
+  o.write(reinterpret_cast<const char*>(&energy),sizeof(double));
+}
+
+void Atoms::readBinarySubset(std::istream&i,const std::vector<int>&indices) {
+  for(unsigned j=0; j<indices.size(); ++j) i.read(reinterpret_cast<char*>(&positions[indices[j]][0]),3*sizeof(double));
+  i.read(reinterpret_cast<char*>(&box(0,0)),9*sizeof(double));
+  i.read(reinterpret_cast<char*>(&energy),sizeof(double));
+  pbc.setBox(box);
+// see readBinary() above
+  if(soaUsers>0) refreshSoAPositions();
 }
 
 double Atoms::getKBoltzmann()const {
@@ -49,7 +49,13 @@ class Atoms
   friend class ActionAtomistic;
   friend class ActionWithVirtualAtom;
   int natoms;
-  std::set<AtomNumber> unique;
+/// Union of the atoms requested by the active actions, kept as a flat sorted
+/// vector. It is rebuilt in share() only when some action changed its request
+/// list or was switched on/off, as detected through uniqueContributors
+  std::vector<AtomNumber> unique;
+/// The actions that contributed to unique when it was last rebuilt, together
+/// with their request serials. Used to detect when unique has become stale
+  std::vector<std::pair<const ActionAtomistic*,unsigned> > uniqueContributors;
   std::vector<unsigned> uniq_index;
 /// Map global indexes to local indexes
 /// E.g. g2l[i] is the position of atom i in the array passed from the MD engine.
@@ -58,7 +64,22 @@ class Atoms
 /// interface, where only a small number of atoms is passed to plumed.
   std::vector<int> g2l;
   std::vector<Vector> positions;
+/// Structure-of-arrays mirror of the positions (separate x/y/z arrays).
+/// It is only maintained when at least one action has asked for it with
+/// requestSoAPositions(). It is refreshed in wait() and kept in sync when
+/// virtual atoms set their position.
+  std::vector<double> positionsX;
+  std::vector<double> positionsY;
+  std::vector<double> positionsZ;
+/// Number of actions that asked for the structure-of-arrays positions
+  unsigned soaUsers;
   std::vector<Vector> forces;
+/// Mask of the atoms that received a PLUMED force during this step, together
+/// with the list of their indexes.  It is filled by
+/// ActionAtomistic::applyForces and lets the force scatter in updateForces
+/// visit only the touched atoms instead of the whole local array
+  std::vector<unsigned char> forceTouched;
+  std::vector<int> touchedAtoms;
   std::vector<double> masses;
   std::vector<double> charges;
   std::vector<ActionWithVirtualAtom*> virtualAtomsActions;
@@ -87,6 +108,9 @@ class Atoms
 
   void resizeVectors(unsigned);
 
+/// Refresh the structure-of-arrays mirror of the positions
+  void refreshSoAPositions();
+
   std::vector<int> fullList;
 
   std::unique_ptr<MDAtomsBase> mdatoms;
@@ -121,9 +145,31 @@ class Atoms
   public:
     bool on;
     bool async;
+/// Complete the asynchronous exchange lazily, when an action first
+/// accesses the positions, so that it overlaps with the MD code work
+    bool overlap;
+/// Number of doubles per atom sent in the pending exchange
+    int ndataAsync;
+/// Total number of atoms to be received in the pending exchange
+    int totAsync;
 
     std::vector<Communicator::Request> mpi_request_positions;
     std::vector<Communicator::Request> mpi_request_index;
+    std::vector<Communicator::Request> mpi_request_recv_positions;
+    std::vector<Communicator::Request> mpi_request_recv_index;
+
+/// Cache for the persistent requests used in the asynchronous exchange
+/// (MPI_Send_init style).  The requests stay valid while the per-rank counts
+/// and the buffer addresses are unchanged, which is the common case between
+/// neighbor-list updates; then they are just restarted instead of re-posted
+    bool persistentValid;
+    int persistentCount;
+    int persistentNdata;
+    std::vector<int> persistentCounts;
+    const void* persistentSendIndex;
+    const void* persistentSendPos;
+    const void* persistentRecvIndex;
+    const void* persistentRecvPos;
 
     std::vector<double> positionsToBeSent;
     std::vector<double> positionsToBeReceived;
@@ -131,7 +177,11 @@ class Atoms
     std::vector<int>    indexToBeReceived;
     operator bool() const {return on;}
     DomainDecomposition():
-      on(false), async(false)
+      on(false), async(false), overlap(false),
+      ndataAsync(0), totAsync(0),
+      persistentValid(false), persistentCount(0), persistentNdata(0),
+      persistentSendIndex(NULL), persistentSendPos(NULL),
+      persistentRecvIndex(NULL), persistentRecvPos(NULL)
     {}
     void enable(Communicator& c);
   };
@@ -139,7 +189,7 @@ class Atoms
   DomainDecomposition dd;
   long int ddStep;  //last step in which dd happened
 
-  void share(const std::set<AtomNumber>&);
+  void share(const std::vector<AtomNumber>&);
 
 public:
 
@@ -151,6 +201,11 @@ public:
   void share();
   void shareAll();
   void wait();
+/// Complete a pending asynchronous position exchange, if there is one.
+/// With PLUMED_ASYNC_SHARE=overlap this is called lazily, when an action
+/// first accesses the positions, so that the exchange overlaps with the
+/// force computation of the MD code. It is a cheap no-op otherwise.
+  void completeAsyncShare();
   void updateForces();
 
   void setRealPrecision(int);
@@ -227,12 +282,23 @@ public:
   void removeGroup(const std::string&name);
   void writeBinary(std::ostream&)const;
   void readBinary(std::istream&);
+/// Serialize only the positions of the listed atoms (plus box and energy).
+/// Used by GREX when exchanging the biased subset is enough
+  void writeBinarySubset(std::ostream&,const std::vector<int>&)const;
+  void readBinarySubset(std::istream&,const std::vector<int>&);
   double getKBoltzmann()const;
   double getMDKBoltzmann()const;
   bool usingNaturalUnits()const;
   void setNaturalUnits(bool n) {naturalUnits=n;}
   void setMDNaturalUnits(bool n) {MDnaturalUnits=n;}
 
+/// Ask Atoms to maintain the structure-of-arrays mirror of the positions
+  void requestSoAPositions();
+/// Release a previous request for the structure-of-arrays mirror
+  void releaseSoAPositions();
+/// Check whether the structure-of-arrays mirror is being maintained
+  bool soaPositionsEnabled()const;
+
   void setExtraCV(const std::string &name,void*p);
   void setExtraCVForce(const std::string &name,void*p);
   double getExtraCV(const std::string &name);
@@ -294,6 +360,22 @@ const Tensor& Atoms::getVirial()const {
   return virial;
 }
 
+inline
+void Atoms::requestSoAPositions() {
+  soaUsers++;
+}
+
+inline
+void Atoms::releaseSoAPositions() {
+  plumed_assert(soaUsers>0);
+  soaUsers--;
+}
+
+inline
+bool Atoms::soaPositionsEnabled()const {
+  return soaUsers>0;
+}
+
 
 }
 #endif
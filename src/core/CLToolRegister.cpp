@@ -45,6 +45,8 @@ CLToolRegister& cltoolRegister() {
 void CLToolRegister::remove(creator_pointer f) {
   for(auto p=m.begin(); p!=m.end(); ++p) {
     if((*p).second==f) {
+      mk.erase((*p).first);
+      mk_cache.erase((*p).first);
       m.erase(p); break;
     }
   }
@@ -53,14 +55,28 @@ void CLToolRegister::remove(creator_pointer f) {
 void CLToolRegister::add(string key,creator_pointer f,keywords_pointer kf) {
   if(m.count(key)) {
     m.erase(key);
+    mk.erase(key);
+    mk_cache.erase(key);
     disabled.insert(key);
   } else {
     m.insert(pair<string,creator_pointer>(key,f));
-    Keywords keys; kf(keys);
-    mk.insert(pair<string,Keywords>(key,keys));
+    // Only the pointer to the function that creates the keywords is stored
+    // here.  The keywords themselves are built the first time they are
+    // needed so that registering all the tools when the library is loaded
+    // does not build the documentation of each of them
+    mk.insert(pair<string,keywords_pointer>(key,kf));
   };
 }
 
+const Keywords & CLToolRegister::getCachedKeywords(const std::string& key) {
+  auto ck=mk_cache.find(key);
+  if(ck==mk_cache.end()) {
+    Keywords keys; mk[key](keys);
+    ck=mk_cache.emplace(key,std::move(keys)).first;
+  }
+  return ck->second;
+}
+
 bool CLToolRegister::check(string key)const {
   if(m.count(key)>0) return true;
   return false;
@@ -70,7 +86,7 @@ std::unique_ptr<CLTool> CLToolRegister::create(const CLToolOptions&ao) {
   if(ao.line.size()<1)return NULL;
   std::unique_ptr<CLTool> cltool;
   if(check(ao.line[0])) {
-    CLToolOptions nao( ao,mk[ao.line[0]] );
+    CLToolOptions nao( ao,getCachedKeywords(ao.line[0]) );
     cltool=m[ao.line[0]](nao);
   }
   return cltool;
@@ -94,19 +110,19 @@ std::ostream & operator<<(std::ostream &log,const CLToolRegister&ar) {
 
 bool CLToolRegister::printManual( const std::string& cltool, const bool& spelling ) {
   if( spelling && check(cltool) ) {
-    mk[cltool].print_spelling();
+    getCachedKeywords(cltool).print_spelling();
     return true;
   } else if ( check(cltool) ) {
-    mk[cltool].print_html();
+    getCachedKeywords(cltool).print_html();
     return true;
   } else {
     return false;
   }
 }
 
-std::vector<std::string> CLToolRegister::getKeys(const std::string& cltool)const {
+std::vector<std::string> CLToolRegister::getKeys(const std::string& cltool) {
   if ( check(cltool) ) {
-    return mk.find(cltool)->second.getKeys();
+    return getCachedKeywords(cltool).getKeys();
   } else {
     std::vector<std::string> empty;
     return empty;
@@ -45,10 +45,16 @@ class CLToolRegister {
   typedef void(*keywords_pointer)(Keywords&);
 /// Map cltool to a function which creates the related object
   std::map<std::string,creator_pointer> m;
-/// Map cltool name to the keywords for this function
-  std::map<std::string,Keywords> mk;
+/// Map cltool name to a function which documents the related object
+  std::map<std::string,keywords_pointer> mk;
+/// The keywords of every cltool are built once, the first time they are
+/// needed, and then reused.  Only pointers are stored at registration so
+/// that loading the library does not build the documentation of every tool
+  std::map<std::string,Keywords> mk_cache;
 /// Set of disabled cltools (which were registered more than once)
   std::set<std::string> disabled;
+/// Get the cached keywords for a cltool, building them on first use
+  const Keywords& getCachedKeywords(const std::string& cltool);
 public:
 /// Register a new class.
 /// \param key The name of the directive to be used in the input file
@@ -67,7 +73,7 @@ public:
 /// Print out the instructions for using the tool in html ready for input into the manual
   bool printManual(const std::string& cltool,const bool& spelling);
 /// Return all the keys of this cltool
-  std::vector<std::string> getKeys(const std::string& cltool)const;
+  std::vector<std::string> getKeys(const std::string& cltool);
 };
 
 /// Function returning a reference to the CLToolRegister.
@@ -0,0 +1,93 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "CheckpointService.h"
+#include "tools/Exception.h"
+#include <cstdio>
+
+namespace PLMD {
+
+CheckpointService::CheckpointService():
+  inflight(false),
+  done(false),
+  started(false)
+{
+}
+
+CheckpointService::~CheckpointService() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    done=true;
+    notEmpty.notify_one();
+  }
+  if(started) thread.join();
+}
+
+void CheckpointService::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for(;;) {
+    while(pending.empty() && !done) notEmpty.wait(lock);
+    if(pending.empty()) break;
+    auto it=pending.begin();
+    std::string path=it->first;
+    std::string data=std::move(it->second);
+    pending.erase(it);
+    inflight=true;
+    lock.unlock();
+    bool ok=writeSnapshot(path,data);
+    lock.lock();
+    if(!ok) failed=path;
+    inflight=false;
+    idle.notify_all();
+  }
+}
+
+bool CheckpointService::writeSnapshot( const std::string& path, const std::string& data ) {
+  const std::string tmp=path+".tmp";
+  FILE* fp=std::fopen(tmp.c_str(),"wb");
+  if(!fp) return false;
+  bool ok=( std::fwrite(data.c_str(),1,data.size(),fp)==data.size() );
+  if(std::fclose(fp)!=0) ok=false;
+  if(ok && std::rename(tmp.c_str(),path.c_str())!=0) ok=false;
+  return ok;
+}
+
+void CheckpointService::submit( const std::string& path, std::string&& snapshot ) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if(!started) {
+    thread=std::thread(&CheckpointService::run,this);
+    started=true;
+  }
+  pending[path]=std::move(snapshot);
+  notEmpty.notify_one();
+}
+
+void CheckpointService::barrier() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while(!pending.empty() || inflight) idle.wait(lock);
+  if(failed.length()>0) {
+    const std::string f=failed;
+    failed.clear();
+    plumed_merror("error writing checkpoint file " + f);
+  }
+}
+
+}
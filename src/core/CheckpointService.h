@@ -0,0 +1,81 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_core_CheckpointService_h
+#define __PLUMED_core_CheckpointService_h
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace PLMD {
+
+/// \ingroup INTERNAL
+/// Background writer for periodic state snapshots.
+///
+/// Stateful actions that periodically rewrite a whole file (restart
+/// states, grids, coefficient sets) can hand the complete contents of the
+/// file to this service instead of blocking the step on the filesystem.
+/// Snapshots are keyed by destination path and double buffered: a snapshot
+/// submitted while the previous one for the same path is still queued
+/// simply replaces it, so the writer never falls behind by more than one
+/// state per file and memory use is bounded.  Each snapshot is written to
+/// a temporary name and renamed into place, so an interrupted run never
+/// leaves a half written checkpoint.  barrier() blocks until everything
+/// queued is on disk; it is invoked from PlumedMain::fflush(), which makes
+/// the FLUSH action act as a barrier for checkpoints as well.
+class CheckpointService {
+/// Snapshots waiting for the writer thread, keyed by destination path
+  std::map<std::string,std::string> pending;
+/// Set while a snapshot is being written out, so that barrier() can wait for it
+  bool inflight;
+/// Set by the destructor to terminate the writer thread
+  bool done;
+/// Whether the writer thread has been started yet; it is spawned lazily on
+/// the first submission so that plumed objects that never checkpoint do not
+/// carry a thread around
+  bool started;
+/// Path of the last snapshot whose write failed, reported at the next barrier
+  std::string failed;
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable idle;
+  std::thread thread;
+/// Main loop of the writer thread
+  void run();
+/// Write one snapshot to a temporary file and rename it into place
+  static bool writeSnapshot( const std::string& path, const std::string& data );
+public:
+  CheckpointService();
+  ~CheckpointService();
+/// Queue the full contents of the checkpoint file at path to be written in
+/// the background.  Any pending snapshot of the same path is replaced
+  void submit( const std::string& path, std::string&& snapshot );
+/// Block until every queued snapshot is on disk.  Throws if any write
+/// since the previous barrier failed
+  void barrier();
+};
+
+}
+
+#endif
@@ -52,11 +52,13 @@ void Colvar::requestAtoms(const vector<AtomNumber> & a) {
 }
 
 void Colvar::apply() {
-  vector<Vector>&   f(modifyForces());
-  Tensor&           v(modifyVirial());
+// complete the box derivatives of the values marked by setBoxDerivativesNoPbc
+// before any force is propagated through them (or before they are inspected,
+// e.g. by DUMPDERIVATIVES, which runs in the later update step)
+  assembleDeferredVirials();
+
   const unsigned    nat=getNumberOfAtoms();
   const unsigned    ncp=getNumberOfComponents();
-  const unsigned    fsz=f.size();
 
   unsigned stride=1;
   unsigned rank=0;
@@ -69,39 +71,56 @@ void Colvar::apply() {
   if(nt>ncp/(4*stride)) nt=1;
 
   if(!isEnergy && !isExtraCV) {
+// two step-stable buffers per thread, so that no vector is allocated here
+// and nothing at all is touched when no force is applied to the components
+    reserveDerivativeBuffers(2*nt);
     #pragma omp parallel num_threads(nt)
     {
-      vector<Vector> omp_f(fsz);
-      Tensor         omp_v;
-      vector<double> forces(3*nat+9);
+      const unsigned t=OpenMP::getThreadNum();
+      bool stale;
+// flat accumulator: 3*nat force components followed by the 9 components of
+// the virial, zeroed only once this thread finds a force to apply
+      vector<double> & acc(getDerivativeBuffer(2*t,3*nat+9,stale));
+// fully overwritten by applyForce(), so it never needs zeroing
+      vector<double> & forces(getDerivativeBuffer(2*t+1,3*nat+9,stale));
+      bool gotforces=false;
       #pragma omp for
       for(unsigned i=rank; i<ncp; i+=stride) {
         if(getPntrToComponent(i)->applyForce(forces)) {
-          for(unsigned j=0; j<nat; ++j) {
-            omp_f[j][0]+=forces[3*j+0];
-            omp_f[j][1]+=forces[3*j+1];
-            omp_f[j][2]+=forces[3*j+2];
+          if(!gotforces) {
+            acc.assign(3*nat+9,0.0);
+            gotforces=true;
           }
-          omp_v(0,0)+=forces[3*nat+0];
-          omp_v(0,1)+=forces[3*nat+1];
-          omp_v(0,2)+=forces[3*nat+2];
-          omp_v(1,0)+=forces[3*nat+3];
-          omp_v(1,1)+=forces[3*nat+4];
-          omp_v(1,2)+=forces[3*nat+5];
-          omp_v(2,0)+=forces[3*nat+6];
-          omp_v(2,1)+=forces[3*nat+7];
-          omp_v(2,2)+=forces[3*nat+8];
+          for(unsigned j=0; j<3*nat+9; ++j) acc[j]+=forces[j];
         }
       }
-      #pragma omp critical
-      {
-        for(unsigned j=0; j<nat; ++j) f[j]+=omp_f[j];
-        v+=omp_v;
+      if(gotforces) {
+        #pragma omp critical
+        {
+          vector<Vector>& f(modifyForces());
+          Tensor&         v(modifyVirial());
+          for(unsigned j=0; j<nat; ++j) {
+            f[j][0]+=acc[3*j+0];
+            f[j][1]+=acc[3*j+1];
+            f[j][2]+=acc[3*j+2];
+          }
+          v(0,0)+=acc[3*nat+0];
+          v(0,1)+=acc[3*nat+1];
+          v(0,2)+=acc[3*nat+2];
+          v(1,0)+=acc[3*nat+3];
+          v(1,1)+=acc[3*nat+4];
+          v(1,2)+=acc[3*nat+5];
+          v(2,0)+=acc[3*nat+6];
+          v(2,1)+=acc[3*nat+7];
+          v(2,2)+=acc[3*nat+8];
+        }
       }
     }
 
     if(ncp>4*comm.Get_size()) {
-      if(fsz>0) comm.Sum(&f[0][0],3*fsz);
+      vector<Vector>& f(modifyForces());
+      Tensor&         v(modifyVirial());
+      if(!f.empty()) comm.Sum(&f[0][0],3*f.size());
       comm.Sum(&v[0][0],9);
     }
 
@@ -115,12 +134,51 @@ void Colvar::apply() {
 }
 
 void Colvar::setBoxDerivativesNoPbc(Value* v) {
-  Tensor virial;
-  unsigned nat=getNumberOfAtoms();
-  for(unsigned i=0; i<nat; i++) virial-=Tensor(getPosition(i),
-                                          Vector(v->getDerivative(3*i+0),
-                                              v->getDerivative(3*i+1),
-                                              v->getDerivative(3*i+2)));
-  setBoxDerivatives(v,virial);
+// when derivatives are computed numerically the machinery overwrites them
+// after this call, so the virial must be assembled immediately
+  if( checkNumericalDerivatives() ) {
+    Tensor virial;
+    unsigned nat=getNumberOfAtoms();
+    for(unsigned i=0; i<nat; i++) virial-=Tensor(getPosition(i),
+                                            Vector(v->getDerivative(3*i+0),
+                                                v->getDerivative(3*i+1),
+                                                v->getDerivative(3*i+2)));
+    setBoxDerivatives(v,virial);
+    return;
+  }
+// otherwise just mark the value: the virials of all the marked values are
+// assembled together in one fused pass at the beginning of apply(), which
+// saves one O(natoms) pass per value on multi component colvars
+  for(unsigned i=0; i<virial_pending.size(); ++i) {
+    if( virial_pending[i]==v ) return;
+  }
+  virial_pending.push_back(v);
+}
+
+void Colvar::assembleDeferredVirials() {
+  if( virial_pending.empty() ) return;
+  const unsigned nat=getNumberOfAtoms();
+  const unsigned nv=virial_pending.size();
+  std::vector<Tensor> virials(nv);
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt>nat/1000) nt=1;
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<Tensor> omp_virials(nv);
+    #pragma omp for nowait
+    for(unsigned i=0; i<nat; i++) {
+      const Vector & p(getPosition(i));
+      for(unsigned iv=0; iv<nv; ++iv) {
+        Value* v=virial_pending[iv];
+        omp_virials[iv]-=Tensor(p,Vector(v->getDerivative(3*i+0),
+                                         v->getDerivative(3*i+1),
+                                         v->getDerivative(3*i+2)));
+      }
+    }
+    #pragma omp critical
+    for(unsigned iv=0; iv<nv; ++iv) virials[iv]+=omp_virials[iv];
+  }
+  for(unsigned iv=0; iv<nv; ++iv) setBoxDerivatives(virial_pending[iv],virials[iv]);
+  virial_pending.clear();
 }
 }
@@ -41,6 +41,12 @@ class Colvar :
   public ActionWithValue
 {
 private:
+/// Values whose box derivatives still have to be assembled from the atomic
+/// derivatives, see setBoxDerivativesNoPbc
+  std::vector<Value*> virial_pending;
+/// Assemble the box derivatives of all the values marked by
+/// setBoxDerivativesNoPbc in one fused pass over the atoms
+  void assembleDeferredVirials();
 protected:
   bool isEnergy;
   bool isExtraCV;
@@ -60,6 +66,10 @@ protected:
 /// Set box derivatives automatically.
 /// It should be called after the setAtomsDerivatives has been used for all
 /// single atoms.
+/// Notice that the assembly of the box derivatives is deferred: the value is
+/// only marked here, and one fused O(natoms) pass in apply() computes the
+/// virials of all the marked values together, instead of one serial pass per
+/// value per step.
 /// \warning It only works for collective variable NOT using PBCs!
   void           setBoxDerivativesNoPbc();
   void           setBoxDerivativesNoPbc(Value*);
@@ -33,10 +33,13 @@ class DataFetchingObjectTyped : public DataFetchingObject {
 private:
 /// A map containing the data we are grabbing
   std::map<std::string,T*> data;
+/// The arena into which the registered values are copied in bulk
+  T* arena;
 public:
   explicit DataFetchingObjectTyped(PlumedMain&plumed);
   ~DataFetchingObjectTyped() {}
   void setData( const std::string& key, const std::string& type, void* outval ) override;
+  void setRegisteredArena( void* a ) override;
   void finishDataGrab() override;
 };
 
@@ -56,6 +59,24 @@ DataFetchingObject::DataFetchingObject(PlumedMain&p):
 {
 }
 
+long DataFetchingObject::registerData( const std::string& key, const std::string& type ) {
+  plumed_assert( Tools::getWords(key,"\t\n ,").size()==1 );
+  plumed_massert( key.find("*")==std::string::npos, "cannot use wildcards in python interface");
+  plumed_massert( type=="", "only plain values can be registered for the bulk fetch");
+
+  // Find the appropriate action and store value containing quantity of interest
+  ActionWithValue* myv = findAction( plumed.getActionSet(), key );
+  // Store the action if not already stored
+  bool found=false;
+  for(const auto & p : myactions) {
+    if( p->getLabel()==myv->getLabel() ) { found=true; break; }
+  }
+  if( !found ) myactions.push_back( myv );
+  // Store the value; its slot in the arena is just its registration order
+  regvalues.push_back( myv->copyOutput( key ) );
+  return static_cast<long>( regvalues.size()-1 );
+}
+
 bool DataFetchingObject::activate() const {
   for(unsigned j=0; j<myactions.size(); ++j) myactions[j]->activate();
   if( myactions.size()>0 ) return true;
@@ -112,10 +133,16 @@ void DataFetchingObject::get_shape( const ActionSet& a, const std::string& key,
 
 template <class T>
 DataFetchingObjectTyped<T>::DataFetchingObjectTyped(PlumedMain&p):
-  DataFetchingObject(p)
+  DataFetchingObject(p),
+  arena(NULL)
 {
 }
 
+template <class T>
+void DataFetchingObjectTyped<T>::setRegisteredArena( void* a ) {
+  arena=static_cast<T*>(a);
+}
+
 template <class T>
 void DataFetchingObjectTyped<T>::setData( const std::string& key, const std::string& type, void* outval ) {
   plumed_assert( Tools::getWords(key,"\t\n ,").size()==1 );
@@ -152,6 +179,11 @@ void DataFetchingObjectTyped<T>::finishDataGrab() {
       plumed_merror("not implemented yet");
     }
   }
+  // the registered values are copied with a single flat pass, with no
+  // per-key lookup, into consecutive slots of the caller-provided arena
+  if( arena ) {
+    for(unsigned i=0; i<regvalues.size(); ++i) arena[i] = static_cast<T>( regvalues[i]->get() );
+  }
 }
 
 }
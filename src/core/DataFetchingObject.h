@@ -41,6 +41,8 @@ protected:
   std::vector<ActionWithValue*> myactions;
 /// The values required by the user
   std::vector<Value*> myvalues;
+/// The values registered for the bulk fetch, in handle order
+  std::vector<Value*> regvalues;
 /// A copy of the plumed main object
   PlumedMain & plumed;
 public:
@@ -58,6 +60,14 @@ public:
   static ActionWithValue* findAction( const ActionSet& a, const std::string& key );
 /// Set the pointer to the data
   virtual void setData( const std::string& key, const std::string& type, void* outval )=0;
+/// Register a value for the bulk fetch and return its integer handle, that
+/// is its offset in the arena passed to setRegisteredArena.  Unlike setData
+/// this does no per-step lookup by name: all the registered values are
+/// copied into consecutive slots of the arena in one pass
+  long registerData( const std::string& key, const std::string& type );
+/// Set the caller-provided arena into which all the registered values are
+/// copied after each calculation
+  virtual void setRegisteredArena( void* arena )=0;
 /// After calc has been performed grab all the data and put it in the relevant arrays
   virtual void finishDataGrab()=0;
 };
@@ -39,6 +39,7 @@ GREX::GREX(PlumedMain&p):
   foreignDeltaBias(0),
   localUNow(0),
   localUSwap(0),
+  subsetExchange(false),
   myreplica(-1) // = unset
 {
   p.setSuffix(".NA");
@@ -117,6 +118,18 @@ void GREX::cmd(const string&key,void*val) {
       CHECK_INIT(initialized,key);
       partner=*static_cast<int*>(val);
       break;
+    case cmd_setSubsetExchange:
+// when set to a nonzero value, only the coordinates of the atoms requested
+// by the actions are serialized and exchanged rather than the whole system.
+// This is sufficient for the acceptance test, since the exchanged
+// coordinates are only used to recompute the bias on the swapped
+// configuration; the actual trajectory swap is done by the MD code.
+// It requires all the replicas to use inputs requesting the same atoms,
+// which is anyway the standard bias-exchange setup.
+      CHECK_INIT(initialized,key);
+      CHECK_NOTNULL(val,key);
+      subsetExchange=(*static_cast<int*>(val)!=0);
+      break;
     case cmd_savePositions:
       CHECK_INIT(initialized,key);
       savePositions();
@@ -164,6 +177,20 @@ void GREX::cmd(const string&key,void*val) {
       allDeltaBias[intercomm.Get_rank()]=localDeltaBias;
       intercomm.Sum(allDeltaBias);
       break;
+    case cmd_sharePartnerDeltaBias:
+// cheap alternative to shareAllDeltaBias for nearest-neighbor exchange
+// patterns: the delta bias of the candidate partner was already exchanged
+// point-to-point during calculate(), so here only the two entries of the
+// attempted pair are filled in, with no communication over the replica
+// ensemble. With many replicas this avoids stalling every attempt on a
+// collective sized to all of them.
+      CHECK_INIT(initialized,key);
+      if(intracomm.Get_rank()!=0) return;
+      plumed_massert(partner>=0,"cmd(\"GREX sharePartnerDeltaBias\") requires a partner set with cmd(\"GREX setPartner\")");
+      allDeltaBias.assign(intercomm.Get_size(),0.0);
+      allDeltaBias[intercomm.Get_rank()]=localDeltaBias;
+      allDeltaBias[partner]=foreignDeltaBias;
+      break;
     case cmd_getDeltaBias:
       CHECK_INIT(initialized,key);
       CHECK_NOTNULL(val,key);
@@ -185,38 +212,87 @@ void GREX::cmd(const string&key,void*val) {
   }
 }
 
+namespace {
+
+/// streambuf appending to a caller-owned vector, so that the serialized
+/// coordinates land directly in the persistent staging buffer instead of
+/// going through a stringstream and being copied out of it
+class VectorOBuf : public std::streambuf {
+  std::vector<char>& vec;
+public:
+  explicit VectorOBuf(std::vector<char>& v) : vec(v) {}
+protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    vec.insert(vec.end(),s,s+n); return n;
+  }
+  int overflow(int c) override {
+    if(c!=EOF) vec.push_back(static_cast<char>(c));
+    return c;
+  }
+};
+
+/// streambuf reading in place from a caller-owned buffer
+class VectorIBuf : public std::streambuf {
+public:
+  VectorIBuf(char* data, std::size_t n) { setg(data,data,data+n); }
+};
+
+}
+
 void GREX::savePositions() {
   plumedMain.prepareDependencies();
   plumedMain.resetActive(true);
   atoms.shareAll();
   plumedMain.waitData();
-  ostringstream o;
-  atoms.writeBinary(o);
-  buffer=o.str();
+// clear() keeps the capacity, so after the first attempt the
+// serialization below does not allocate
+  buffer.clear();
+  VectorOBuf obuf(buffer);
+  ostream o(&obuf);
+  if(subsetExchange) {
+// the atoms requested by the actions, with everything active, are
+// exactly what justCalculate() will look at after the exchange
+    int n=0; atoms.createFullList(&n);
+    int* list=NULL; atoms.getFullList(&list);
+    if(n>0) subset.assign(list,list+n);
+    else subset.clear();
+    atoms.clearFullList();
+    atoms.writeBinarySubset(o,subset);
+  } else {
+    atoms.writeBinary(o);
+  }
 }
 
 void GREX::calculate() {
 //fprintf(stderr,"CALCULATE %d %d\n",intercomm.Get_rank(),partner);
-  unsigned nn=buffer.size();
-  vector<char> rbuf(nn);
+  rbuf.resize(buffer.size());
   localDeltaBias=-plumedMain.getBias();
+  Communicator::Request breq;
   if(intracomm.Get_rank()==0) {
     Communicator::Request req=intercomm.Isend(buffer,partner,1066);
     intercomm.Recv(rbuf,partner,1066);
     req.wait();
+// post the receive for the partner delta bias now, so that the message can
+// arrive while the bias is recomputed on the swapped coordinates below
+    breq=intercomm.Irecv(foreignDeltaBias,partner,1067);
   }
   intracomm.Bcast(rbuf,0);
-  istringstream i(string(&rbuf[0],rbuf.size()));
-  atoms.readBinary(i);
+  VectorIBuf ibuf(&rbuf[0],rbuf.size());
+  istream i(&ibuf);
+  if(subsetExchange) atoms.readBinarySubset(i,subset);
+  else atoms.readBinary(i);
   plumedMain.setExchangeStep(true);
-  plumedMain.prepareDependencies();
+// only the bias enters the acceptance test, so the forward loop on the
+// swapped coordinates is restricted to the actions the bias depends on:
+// CVs that only feed output files on this step are not recomputed
+  plumedMain.prepareBiasDependencies();
   plumedMain.justCalculate();
   plumedMain.setExchangeStep(false);
   localDeltaBias+=plumedMain.getBias();
   localDeltaBias+=localUSwap-localUNow;
   if(intracomm.Get_rank()==0) {
     Communicator::Request req=intercomm.Isend(localDeltaBias,partner,1067);
-    intercomm.Recv(foreignDeltaBias,partner,1067);
+    breq.wait();
     req.wait();
 //fprintf(stderr,">>> %d %d %20.12f %20.12f %20.12f %20.12f\n",intercomm.Get_rank(),partner,localDeltaBias,foreignDeltaBias,localUSwap,localUNow);
   }
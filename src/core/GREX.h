@@ -49,7 +49,16 @@ class GREX:
   double localUNow;
   double localUSwap;
   std::vector<double> allDeltaBias;
-  std::string buffer;
+/// Staging buffers for the coordinate exchange. Both are allocated at the
+/// first exchange attempt and reused afterwards, so that repeated attempts
+/// do not touch the heap
+  std::vector<char> buffer;
+  std::vector<char> rbuf;
+/// If true only the atoms requested by the actions are exchanged,
+/// see cmd("GREX setSubsetExchange")
+  bool subsetExchange;
+/// The atom indices serialized when subsetExchange is set
+  std::vector<int> subset;
   int myreplica;
 public:
   explicit GREX(PlumedMain&);
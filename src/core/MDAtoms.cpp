@@ -25,6 +25,7 @@
 #include "tools/Exception.h"
 #include "tools/Units.h"
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <map>
 
@@ -51,6 +52,13 @@ class MDAtomsTyped:
   T *virial;
   std::map<std::string,T*> extraCV;
   std::map<std::string,T*> extraCVForce;
+/// True when the MD engine stores positions as contiguous double precision
+/// xyz triplets and length units match, so that gathering them requires no
+/// per-element conversion. Detected automatically from the pointers passed
+/// by the engine, no declaration from the engine side is needed
+  bool plainPositions()const {
+    return sizeof(T)==sizeof(double) && stride==3 && py==px+1 && pz==px+2 && scalep==T(1.0);
+  }
 public:
   MDAtomsTyped();
   void setm(void*m) override;
@@ -86,14 +94,15 @@ public:
   }
   void getBox(Tensor &) const override;
   void getPositions(const vector<int>&index,vector<Vector>&positions) const override;
-  void getPositions(const std::set<AtomNumber>&index,const vector<unsigned>&i,vector<Vector>&positions) const override;
+  void getPositions(const vector<AtomNumber>&index,const vector<unsigned>&i,vector<Vector>&positions) const override;
   void getPositions(unsigned j,unsigned k,vector<Vector>&positions) const override;
   void getLocalPositions(std::vector<Vector>&p) const override;
   void getMasses(const vector<int>&index,vector<double>&) const override;
   void getCharges(const vector<int>&index,vector<double>&) const override;
   void updateVirial(const Tensor&) const override;
   void updateForces(const vector<int>&index,const vector<Vector>&) override;
-  void updateForces(const std::set<AtomNumber>&index,const vector<unsigned>&i,const vector<Vector>&forces) override;
+  void updateForces(const vector<AtomNumber>&index,const vector<unsigned>&i,const vector<Vector>&forces) override;
+  void updateTouchedForces(const vector<int>&touched,int nlocal,const vector<Vector>&forces) override;
   void rescaleForces(const vector<int>&index,double factor) override;
   unsigned  getRealPrecision()const override;
 };
@@ -131,7 +140,7 @@ void MDAtomsTyped<T>::getPositions(const vector<int>&index,vector<Vector>&positi
 }
 
 template <class T>
-void MDAtomsTyped<T>::getPositions(const std::set<AtomNumber>&index,const vector<unsigned>&i, vector<Vector>&positions)const {
+void MDAtomsTyped<T>::getPositions(const vector<AtomNumber>&index,const vector<unsigned>&i, vector<Vector>&positions)const {
 // cannot be parallelized with omp because access to positions is not ordered
   unsigned k=0;
   for(const auto & p : index) {
@@ -144,6 +153,13 @@ void MDAtomsTyped<T>::getPositions(const std::set<AtomNumber>&index,const vector
 
 template <class T>
 void MDAtomsTyped<T>::getPositions(unsigned j,unsigned k,vector<Vector>&positions)const {
+// when layout and units match the engine arrays can be copied verbatim.
+// this is the path taken at every step by engines sharing all their atoms
+// (e.g. LAMMPS with no domain decomposition on the plumed side)
+  if(plainPositions() && j<k) {
+    std::memcpy(&positions[j][0],px+3*j,3*(k-j)*sizeof(double));
+    return;
+  }
   #pragma omp parallel for num_threads(OpenMP::getGoodNumThreads(&positions[j],(k-j)))
   for(unsigned i=j; i<k; ++i) {
     positions[i][0]=px[stride*i]*scalep;
@@ -155,6 +171,10 @@ void MDAtomsTyped<T>::getPositions(unsigned j,unsigned k,vector<Vector>&position
 
 template <class T>
 void MDAtomsTyped<T>::getLocalPositions(vector<Vector>&positions)const {
+  if(plainPositions() && positions.size()>0) {
+    std::memcpy(&positions[0][0],px,3*positions.size()*sizeof(double));
+    return;
+  }
   #pragma omp parallel for num_threads(OpenMP::getGoodNumThreads(positions))
   for(unsigned i=0; i<positions.size(); ++i) {
     positions[i][0]=px[stride*i]*scalep;
@@ -182,7 +202,7 @@ void MDAtomsTyped<T>::updateVirial(const Tensor&virial)const {
 }
 
 template <class T>
-void MDAtomsTyped<T>::updateForces(const std::set<AtomNumber>&index,const vector<unsigned>&i,const vector<Vector>&forces) {
+void MDAtomsTyped<T>::updateForces(const vector<AtomNumber>&index,const vector<unsigned>&i,const vector<Vector>&forces) {
   unsigned k=0;
   for(const auto & p : index) {
     fx[stride*i[k]]+=scalef*T(forces[p.index()][0]);
@@ -192,6 +212,17 @@ void MDAtomsTyped<T>::updateForces(const std::set<AtomNumber>&index,const vector
   }
 }
 
+template <class T>
+void MDAtomsTyped<T>::updateTouchedForces(const vector<int>&touched,int nlocal,const vector<Vector>&forces) {
+  for(unsigned i=0; i<touched.size(); ++i) {
+    const int k=touched[i];
+    if(k>=nlocal) continue; // virtual atoms have no slot in the MD arrays
+    fx[stride*k]+=scalef*T(forces[k][0]);
+    fy[stride*k]+=scalef*T(forces[k][1]);
+    fz[stride*k]+=scalef*T(forces[k][2]);
+  }
+}
+
 template <class T>
 void MDAtomsTyped<T>::updateForces(const vector<int>&index,const vector<Vector>&forces) {
   #pragma omp parallel for num_threads(OpenMP::getGoodNumThreads(fx,stride*index.size()))
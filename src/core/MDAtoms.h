@@ -26,7 +26,6 @@
 #include "tools/Vector.h"
 #include "tools/AtomNumber.h"
 #include <vector>
-#include <set>
 #include <memory>
 
 namespace PLMD {
@@ -88,7 +87,7 @@ public:
 /// Retrieve all atom positions from index i to index j.
   virtual void getPositions(unsigned i,unsigned j,std::vector<Vector>&p)const=0;
 /// Retrieve all atom positions from atom indices and local indices.
-  virtual void getPositions(const std::set<AtomNumber>&index,const std::vector<unsigned>&i,std::vector<Vector>&p)const=0;
+  virtual void getPositions(const std::vector<AtomNumber>&index,const std::vector<unsigned>&i,std::vector<Vector>&p)const=0;
 /// Retrieve selected masses.
 /// The operation is done in such a way that m[index[i]] is equal to the mass of atom i
   virtual void getMasses(const std::vector<int>&index,std::vector<double>&m)const=0;
@@ -104,7 +103,11 @@ public:
   virtual void updateForces(const std::vector<int>&index,const std::vector<Vector>&f)=0;
 /// Increment the force on selected atoms.
 /// The operation is done only for local atoms used in an action
-  virtual void updateForces(const std::set<AtomNumber>&index,const std::vector<unsigned>&i,const std::vector<Vector>&forces)=0;
+  virtual void updateForces(const std::vector<AtomNumber>&index,const std::vector<unsigned>&i,const std::vector<Vector>&forces)=0;
+/// Increment the force on the atoms listed in touched only.
+/// It assumes that local and global indexes coincide (no shuffling); entries
+/// of touched that are not smaller than nlocal (e.g. virtual atoms) are skipped
+  virtual void updateTouchedForces(const std::vector<int>&touched,int nlocal,const std::vector<Vector>&f)=0;
 /// Rescale all the forces, including the virial.
 /// It is applied to all atoms with local index going from 0 to index.size()-1
   virtual void rescaleForces(const std::vector<int>&index,double factor)=0;
@@ -24,6 +24,8 @@
 #include "ActionPilot.h"
 #include "ActionRegister.h"
 #include "ActionSet.h"
+#include "TaskScheduler.h"
+#include "CheckpointService.h"
 #include "ActionWithValue.h"
 #include "ActionWithVirtualAtom.h"
 #include "Atoms.h"
@@ -45,8 +47,12 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <set>
 #include <unordered_map>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
 #include <exception>
 #include <stdexcept>
 #include <ios>
@@ -56,6 +62,7 @@
 #include <system_error>
 #include <future>
 #include <memory>
+#include <unistd.h>
 #include <functional>
 #endif
 
@@ -148,6 +155,26 @@ PlumedMain::PlumedMain():
 
 // destructor needed to delete forward declarated objects
 PlumedMain::~PlumedMain() {
+// the profile is collected unconditionally but written to the log only
+// on request, so that the log of a normal run is not altered
+  if(initialized && actionSet.size()>0 && std::getenv("PLUMED_PROFILE")) log<<profileString();
+// machine readable timers, meant to be scraped by external tooling without
+// parsing the tail of the log.  One file per rank, named after the content
+// of the environment variable (plus the usual multi-replica suffix)
+  if(initialized) {
+    const char* jname=std::getenv("PLUMED_TIMERS_JSON");
+    if(jname && jname[0]) {
+      std::string fname(jname);
+      fname+=getSuffix();
+      if(comm.Get_size()>1) {
+        std::string r;
+        Tools::convert(comm.Get_rank(),r);
+        fname+="."+r;
+      }
+      std::ofstream ofs(fname.c_str());
+      if(ofs.is_open()) stopwatch.writeJson(ofs);
+    }
+  }
 }
 
 /////////////////////////////////////////////////////////////
@@ -158,420 +185,61 @@ PlumedMain::~PlumedMain() {
 #define CHECK_NOTNULL(val,word) plumed_massert(val,"NULL pointer received in cmd(\"" + word + "\")");
 
 
-void PlumedMain::cmd(const std::string & word,void*val) {
+namespace {
 
 // Enumerate all possible commands:
-  enum {
+enum {
 #include "PlumedMainEnum.inc"
-  };
+};
 
 // Static object (initialized once) containing the map of commands:
+const std::unordered_map<std::string, int> & commandMap() {
   const static std::unordered_map<std::string, int> word_map = {
 #include "PlumedMainMap.inc"
   };
+  return word_map;
+}
+
+// Retrieve the name of a command from its handle, for error messages
+const std::string & commandName(int handle) {
+  const static std::vector<std::string> names=[]() {
+    std::vector<std::string> n;
+    for(const auto & p : commandMap()) {
+      if(p.second>=int(n.size())) n.resize(p.second+1);
+      n[p.second]=p.first;
+    }
+    return n;
+  }();
+  const static std::string unknown="unknown command";
+  if(handle<0 || handle>=int(names.size())) return unknown;
+  return names[handle];
+}
+
+}
+
+void PlumedMain::cmd(const std::string & word,void*val) {
 
   try {
 
     auto ss=stopwatch.startPause();
 
-    std::vector<std::string> words=Tools::getWords(word);
-    unsigned nw=words.size();
-    if(nw==0) {
-      // do nothing
+    const auto & word_map=commandMap();
+    int iword=-1;
+    std::vector<std::string> words;
+// single-word commands, i.e. the vast majority and all of those issued at
+// every step, are looked up directly without splitting the string
+    const auto it=word_map.find(word);
+    if(it!=word_map.end()) {
+      iword=it->second;
+      words.push_back(word);
     } else {
-      int iword=-1;
-      double d;
-      const auto it=word_map.find(words[0]);
-      if(it!=word_map.end()) iword=it->second;
-      switch(iword) {
-      case cmd_setBox:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setBox(val);
-        break;
-      case cmd_setPositions:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val);
-        break;
-      case cmd_setMasses:
-        CHECK_INIT(initialized,word);
-        atoms.setMasses(val);
-        break;
-      case cmd_setCharges:
-        CHECK_INIT(initialized,word);
-        atoms.setCharges(val);
-        break;
-      case cmd_setPositionsX:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val,0);
-        break;
-      case cmd_setPositionsY:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val,1);
-        break;
-      case cmd_setPositionsZ:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val,2);
-        break;
-      case cmd_setVirial:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setVirial(val);
-        break;
-      case cmd_setEnergy:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setEnergy(val);
-        break;
-      case cmd_setForces:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val);
-        break;
-      case cmd_setForcesX:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val,0);
-        break;
-      case cmd_setForcesY:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val,1);
-        break;
-      case cmd_setForcesZ:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val,2);
-        break;
-      case cmd_calc:
-        CHECK_INIT(initialized,word);
-        calc();
-        break;
-      case cmd_prepareDependencies:
-        CHECK_INIT(initialized,word);
-        prepareDependencies();
-        break;
-      case cmd_shareData:
-        CHECK_INIT(initialized,word);
-        shareData();
-        break;
-      case cmd_prepareCalc:
-        CHECK_INIT(initialized,word);
-        prepareCalc();
-        break;
-      case cmd_performCalc:
-        CHECK_INIT(initialized,word);
-        performCalc();
-        break;
-      case cmd_performCalcNoUpdate:
-        CHECK_INIT(initialized,word);
-        performCalcNoUpdate();
-        break;
-      case cmd_update:
-        CHECK_INIT(initialized,word);
-        update();
-        break;
-      case cmd_setStep:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        step=(*static_cast<int*>(val));
-        atoms.startStep();
-        break;
-      case cmd_setStepLong:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        step=(*static_cast<long int*>(val));
-        atoms.startStep();
-        break;
-      // words used less frequently:
-      case cmd_setAtomsNlocal:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setAtomsNlocal(*static_cast<int*>(val));
-        break;
-      case cmd_setAtomsGatindex:
-        CHECK_INIT(initialized,word);
-        atoms.setAtomsGatindex(static_cast<int*>(val),false);
-        break;
-      case cmd_setAtomsFGatindex:
-        CHECK_INIT(initialized,word);
-        atoms.setAtomsGatindex(static_cast<int*>(val),true);
-        break;
-      case cmd_setAtomsContiguous:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setAtomsContiguous(*static_cast<int*>(val));
-        break;
-      case cmd_createFullList:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.createFullList(static_cast<int*>(val));
-        break;
-      case cmd_getFullList:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.getFullList(static_cast<int**>(val));
-        break;
-      case cmd_clearFullList:
-        CHECK_INIT(initialized,word);
-        atoms.clearFullList();
-        break;
-      /* ADDED WITH API==6 */
-      case cmd_getDataRank:
-        CHECK_INIT(initialized,words[0]); plumed_assert(nw==2 || nw==3);
-        if( nw==2 ) DataFetchingObject::get_rank( actionSet, words[1], "", static_cast<long*>(val) );
-        else DataFetchingObject::get_rank( actionSet, words[1], words[2], static_cast<long*>(val) );
-        break;
-      /* ADDED WITH API==6 */
-      case cmd_getDataShape:
-        CHECK_INIT(initialized,words[0]); plumed_assert(nw==2 || nw==3);
-        if( nw==2 ) DataFetchingObject::get_shape( actionSet, words[1], "", static_cast<long*>(val) );
-        else DataFetchingObject::get_shape( actionSet, words[1], words[2], static_cast<long*>(val) );
-        break;
-      /* ADDED WITH API==6 */
-      case cmd_setMemoryForData:
-        CHECK_INIT(initialized,words[0]); plumed_assert(nw==2 || nw==3);
-        if( nw==2 ) mydatafetcher->setData( words[1], "", val );
-        else mydatafetcher->setData( words[1], words[2], val );
-        break;
-      /* ADDED WITH API==6 */
-      case cmd_setErrorHandler:
-      {
-        if(val) error_handler=*static_cast<plumed_error_handler*>(val);
-        else error_handler.handler=NULL;
-      }
-      break;
-      case cmd_read:
-        CHECK_INIT(initialized,word);
-        if(val)readInputFile(static_cast<char*>(val));
-        else   readInputFile("plumed.dat");
-        break;
-      case cmd_readInputLine:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        readInputLine(static_cast<char*>(val));
-        break;
-      case cmd_readInputLines:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        readInputLines(static_cast<char*>(val));
-        break;
-      case cmd_clear:
-        CHECK_INIT(initialized,word);
-        actionSet.clearDelete();
-        break;
-      case cmd_getApiVersion:
-        CHECK_NOTNULL(val,word);
-        *(static_cast<int*>(val))=8;
-        break;
-      // commands which can be used only before initialization:
-      case cmd_init:
-        CHECK_NOTINIT(initialized,word);
-        init();
-        break;
-      case cmd_setRealPrecision:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setRealPrecision(*static_cast<int*>(val));
-        mydatafetcher=DataFetchingObject::create(*static_cast<int*>(val),*this);
-        break;
-      case cmd_setMDLengthUnits:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDLengthUnits(d);
-        break;
-      case cmd_setMDChargeUnits:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDChargeUnits(d);
-        break;
-      case cmd_setMDMassUnits:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDMassUnits(d);
-        break;
-      case cmd_setMDEnergyUnits:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDEnergyUnits(d);
-        break;
-      case cmd_setMDTimeUnits:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDTimeUnits(d);
-        break;
-      case cmd_setNaturalUnits:
-        // set the boltzman constant for MD in natural units (kb=1)
-        // only needed in LJ codes if the MD is passing temperatures to plumed (so, not yet...)
-        // use as cmd("setNaturalUnits")
-        CHECK_NOTINIT(initialized,word);
-        atoms.setMDNaturalUnits(true);
-        break;
-      case cmd_setNoVirial:
-        CHECK_NOTINIT(initialized,word);
-        novirial=true;
-        break;
-      case cmd_setPlumedDat:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        plumedDat=static_cast<char*>(val);
-        break;
-      case cmd_setMPIComm:
-        CHECK_NOTINIT(initialized,word);
-        comm.Set_comm(val);
-        atoms.setDomainDecomposition(comm);
-        break;
-      case cmd_setMPIFComm:
-        CHECK_NOTINIT(initialized,word);
-        comm.Set_fcomm(val);
-        atoms.setDomainDecomposition(comm);
-        break;
-      case cmd_setMPImultiSimComm:
-        CHECK_NOTINIT(initialized,word);
-        multi_sim_comm.Set_comm(val);
-        break;
-      case cmd_setNatoms:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setNatoms(*static_cast<int*>(val));
-        break;
-      case cmd_setTimestep:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setTimeStep(val);
-        break;
-      /* ADDED WITH API==2 */
-      case cmd_setKbT:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.setKbT(val);
-        break;
-      /* ADDED WITH API==3 */
-      case cmd_setRestart:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        if(*static_cast<int*>(val)!=0) restart=true;
-        break;
-      /* ADDED WITH API==4 */
-      case cmd_doCheckPoint:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        doCheckPoint = false;
-        if(*static_cast<int*>(val)!=0) doCheckPoint = true;
-        break;
-      /* ADDED WITH API==6 */
-      case cmd_setNumOMPthreads:
-        CHECK_NOTNULL(val,word);
-        OpenMP::setNumThreads(*static_cast<int*>(val)>0?*static_cast<int*>(val):1);
-        break;
-      /* ADDED WITH API==6 */
-      /* only used for testing */
-      case cmd_throw:
-        CHECK_NOTNULL(val,word);
-        testThrow((const char*) val);
-      /* STOP API */
-      case cmd_setMDEngine:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        MDEngine=static_cast<char*>(val);
-        break;
-      case cmd_setLog:
-        CHECK_NOTINIT(initialized,word);
-        log.link(static_cast<FILE*>(val));
-        break;
-      case cmd_setLogFile:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        log.open(static_cast<char*>(val));
-        break;
-      // other commands that should be used after initialization:
-      case cmd_setStopFlag:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        stopFlag=static_cast<int*>(val);
-        break;
-      case cmd_getExchangesFlag:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        exchangePatterns.getFlag((*static_cast<int*>(val)));
-        break;
-      case cmd_setExchangesSeed:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        exchangePatterns.setSeed((*static_cast<int*>(val)));
-        break;
-      case cmd_setNumberOfReplicas:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        exchangePatterns.setNofR((*static_cast<int*>(val)));
-        break;
-      case cmd_getExchangesList:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        exchangePatterns.getList((static_cast<int*>(val)));
-        break;
-      case cmd_runFinalJobs:
-        CHECK_INIT(initialized,word);
-        runJobsAtEndOfCalculation();
-        break;
-      case cmd_isEnergyNeeded:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        if(atoms.isEnergyNeeded()) *(static_cast<int*>(val))=1;
-        else                       *(static_cast<int*>(val))=0;
-        break;
-      case cmd_getBias:
-        CHECK_INIT(initialized,word);
-        CHECK_NOTNULL(val,word);
-        atoms.double2MD(getBias()/(atoms.getMDUnits().getEnergy()/atoms.getUnits().getEnergy()),val);
-        break;
-      case cmd_checkAction:
-        CHECK_NOTNULL(val,word);
-        plumed_assert(nw==2);
-        *(static_cast<int*>(val))=(actionRegister().check(words[1]) ? 1:0);
-        break;
-      case cmd_setExtraCV:
-        CHECK_NOTNULL(val,word);
-        plumed_assert(nw==2);
-        atoms.setExtraCV(words[1],val);
-        break;
-      case cmd_setExtraCVForce:
-        CHECK_NOTNULL(val,word);
-        plumed_assert(nw==2);
-        atoms.setExtraCVForce(words[1],val);
-        break;
-      case cmd_GREX:
-        if(!grex) grex.reset(new GREX(*this));
-        plumed_massert(grex,"error allocating grex");
-        {
-          std::string kk=words[1];
-          for(unsigned i=2; i<words.size(); i++) kk+=" "+words[i];
-          grex->cmd(kk.c_str(),val);
-        }
-        break;
-      case cmd_CLTool:
-        CHECK_NOTINIT(initialized,word);
-        if(!cltool) cltool.reset(new CLToolMain);
-        {
-          std::string kk=words[1];
-          for(unsigned i=2; i<words.size(); i++) kk+=" "+words[i];
-          cltool->cmd(kk.c_str(),val);
-        }
-        break;
-      /* ADDED WITH API==7 */
-      case cmd_convert:
-      {
-        double v;
-        plumed_assert(words.size()==2);
-        if(Tools::convert(words[1],v)) atoms.double2MD(v,val);
-      }
-      break;
-      default:
-        plumed_merror("cannot interpret cmd(\"" + word + "\"). check plumed developers manual to see the available commands.");
-        break;
+      words=Tools::getWords(word);
+      if(!words.empty()) {
+        const auto it2=word_map.find(words[0]);
+        if(it2!=word_map.end()) iword=it2->second;
       }
     }
+    if(!words.empty()) cmdExecute(iword,word,words,val);
 
   } catch (std::exception &e) {
     if(log.isOpen()) {
@@ -584,6 +252,462 @@ void PlumedMain::cmd(const std::string & word,void*val) {
   }
 }
 
+int PlumedMain::cmdHandle(const std::string & word) {
+  const auto it=commandMap().find(word);
+  plumed_massert(it!=commandMap().end(),"cannot interpret cmd(\"" + word + "\"). check plumed developers manual to see the available commands.");
+  return it->second;
+}
+
+void PlumedMain::cmd(int handle,void*val) {
+
+  try {
+
+    auto ss=stopwatch.startPause();
+
+    const std::vector<std::string> words(1,commandName(handle));
+    cmdExecute(handle,words[0],words,val);
+
+  } catch (std::exception &e) {
+    if(log.isOpen()) {
+      log<<"\n\n################################################################################\n\n";
+      log<<e.what();
+      log<<"\n\n################################################################################\n\n";
+      log.flush();
+    }
+    throw;
+  }
+}
+
+void PlumedMain::cmdExecute(int iword,const std::string & word,const std::vector<std::string> & words,void*val) {
+  unsigned nw=words.size();
+  double d;
+  switch(iword) {
+  case cmd_setBox:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setBox(val);
+    break;
+  case cmd_setPositions:
+    CHECK_INIT(initialized,word);
+    atoms.setPositions(val);
+    break;
+  case cmd_setMasses:
+    CHECK_INIT(initialized,word);
+    atoms.setMasses(val);
+    break;
+  case cmd_setCharges:
+    CHECK_INIT(initialized,word);
+    atoms.setCharges(val);
+    break;
+  case cmd_setPositionsX:
+    CHECK_INIT(initialized,word);
+    atoms.setPositions(val,0);
+    break;
+  case cmd_setPositionsY:
+    CHECK_INIT(initialized,word);
+    atoms.setPositions(val,1);
+    break;
+  case cmd_setPositionsZ:
+    CHECK_INIT(initialized,word);
+    atoms.setPositions(val,2);
+    break;
+  case cmd_setVirial:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setVirial(val);
+    break;
+  case cmd_setEnergy:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setEnergy(val);
+    break;
+  case cmd_setForces:
+    CHECK_INIT(initialized,word);
+    atoms.setForces(val);
+    break;
+  case cmd_setForcesX:
+    CHECK_INIT(initialized,word);
+    atoms.setForces(val,0);
+    break;
+  case cmd_setForcesY:
+    CHECK_INIT(initialized,word);
+    atoms.setForces(val,1);
+    break;
+  case cmd_setForcesZ:
+    CHECK_INIT(initialized,word);
+    atoms.setForces(val,2);
+    break;
+  case cmd_calc:
+    CHECK_INIT(initialized,word);
+    calc();
+    break;
+  case cmd_prepareDependencies:
+    CHECK_INIT(initialized,word);
+    prepareDependencies();
+    break;
+  case cmd_shareData:
+    CHECK_INIT(initialized,word);
+    shareData();
+    break;
+  case cmd_prepareCalc:
+    CHECK_INIT(initialized,word);
+    prepareCalc();
+    break;
+  case cmd_performCalc:
+    CHECK_INIT(initialized,word);
+    performCalc();
+    break;
+  case cmd_performCalcNoUpdate:
+    CHECK_INIT(initialized,word);
+    performCalcNoUpdate();
+    break;
+  case cmd_update:
+    CHECK_INIT(initialized,word);
+    update();
+    break;
+  case cmd_setStep:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    step=(*static_cast<int*>(val));
+    atoms.startStep();
+    break;
+  case cmd_setStepLong:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    step=(*static_cast<long int*>(val));
+    atoms.startStep();
+    break;
+  /* ADDED WITH API==7 */
+  case cmd_setAllData:
+  {
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    const PlumedStepData*data=static_cast<const PlumedStepData*>(val);
+    step=data->step;
+    atoms.startStep();
+    if(data->stopFlag) stopFlag=static_cast<int*>(data->stopFlag);
+    if(data->positions) atoms.setPositions(data->positions);
+    if(data->masses) atoms.setMasses(data->masses);
+    if(data->charges) atoms.setCharges(data->charges);
+    if(data->box) atoms.setBox(data->box);
+    if(data->forces) atoms.setForces(data->forces);
+    if(data->virial) atoms.setVirial(data->virial);
+    if(data->energy) atoms.setEnergy(data->energy);
+  }
+  break;
+  // words used less frequently:
+  case cmd_setAtomsNlocal:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setAtomsNlocal(*static_cast<int*>(val));
+    break;
+  case cmd_setAtomsGatindex:
+    CHECK_INIT(initialized,word);
+    atoms.setAtomsGatindex(static_cast<int*>(val),false);
+    break;
+  case cmd_setAtomsFGatindex:
+    CHECK_INIT(initialized,word);
+    atoms.setAtomsGatindex(static_cast<int*>(val),true);
+    break;
+  case cmd_setAtomsContiguous:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setAtomsContiguous(*static_cast<int*>(val));
+    break;
+  case cmd_createFullList:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.createFullList(static_cast<int*>(val));
+    break;
+  case cmd_getFullList:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.getFullList(static_cast<int**>(val));
+    break;
+  case cmd_clearFullList:
+    CHECK_INIT(initialized,word);
+    atoms.clearFullList();
+    break;
+  /* ADDED WITH API==6 */
+  case cmd_getDataRank:
+    CHECK_INIT(initialized,words[0]); plumed_assert(nw==2 || nw==3);
+    if( nw==2 ) DataFetchingObject::get_rank( actionSet, words[1], "", static_cast<long*>(val) );
+    else DataFetchingObject::get_rank( actionSet, words[1], words[2], static_cast<long*>(val) );
+    break;
+  /* ADDED WITH API==6 */
+  case cmd_getDataShape:
+    CHECK_INIT(initialized,words[0]); plumed_assert(nw==2 || nw==3);
+    if( nw==2 ) DataFetchingObject::get_shape( actionSet, words[1], "", static_cast<long*>(val) );
+    else DataFetchingObject::get_shape( actionSet, words[1], words[2], static_cast<long*>(val) );
+    break;
+  /* ADDED WITH API==6 */
+  case cmd_setMemoryForData:
+    CHECK_INIT(initialized,words[0]); plumed_assert(nw==2 || nw==3);
+    if( nw==2 ) mydatafetcher->setData( words[1], "", val );
+    else mydatafetcher->setData( words[1], words[2], val );
+    break;
+  /* ADDED WITH API==8 */
+  case cmd_registerData:
+    CHECK_INIT(initialized,words[0]);
+    CHECK_NOTNULL(val,words[0]); plumed_assert(nw==2 || nw==3);
+    if( nw==2 ) *static_cast<long*>(val)=mydatafetcher->registerData( words[1], "" );
+    else *static_cast<long*>(val)=mydatafetcher->registerData( words[1], words[2] );
+    break;
+  /* ADDED WITH API==8 */
+  case cmd_setMemoryForRegisteredData:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    mydatafetcher->setRegisteredArena(val);
+    break;
+  /* ADDED WITH API==6 */
+  case cmd_setErrorHandler:
+  {
+    if(val) error_handler=*static_cast<plumed_error_handler*>(val);
+    else error_handler.handler=NULL;
+  }
+  break;
+  case cmd_read:
+    CHECK_INIT(initialized,word);
+    if(val)readInputFile(static_cast<char*>(val));
+    else   readInputFile("plumed.dat");
+    break;
+  case cmd_readInputLine:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    readInputLine(static_cast<char*>(val));
+    break;
+  case cmd_readInputLines:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    readInputLines(static_cast<char*>(val));
+    break;
+  case cmd_clear:
+    CHECK_INIT(initialized,word);
+    actionSet.clearDelete();
+    break;
+  case cmd_getApiVersion:
+    CHECK_NOTNULL(val,word);
+    *(static_cast<int*>(val))=8;
+    break;
+  // commands which can be used only before initialization:
+  case cmd_init:
+    CHECK_NOTINIT(initialized,word);
+    init();
+    break;
+  case cmd_setRealPrecision:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setRealPrecision(*static_cast<int*>(val));
+    mydatafetcher=DataFetchingObject::create(*static_cast<int*>(val),*this);
+    break;
+  case cmd_setMDLengthUnits:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.MD2double(val,d);
+    atoms.setMDLengthUnits(d);
+    break;
+  case cmd_setMDChargeUnits:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.MD2double(val,d);
+    atoms.setMDChargeUnits(d);
+    break;
+  case cmd_setMDMassUnits:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.MD2double(val,d);
+    atoms.setMDMassUnits(d);
+    break;
+  case cmd_setMDEnergyUnits:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.MD2double(val,d);
+    atoms.setMDEnergyUnits(d);
+    break;
+  case cmd_setMDTimeUnits:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.MD2double(val,d);
+    atoms.setMDTimeUnits(d);
+    break;
+  case cmd_setNaturalUnits:
+    // set the boltzman constant for MD in natural units (kb=1)
+    // only needed in LJ codes if the MD is passing temperatures to plumed (so, not yet...)
+    // use as cmd("setNaturalUnits")
+    CHECK_NOTINIT(initialized,word);
+    atoms.setMDNaturalUnits(true);
+    break;
+  case cmd_setNoVirial:
+    CHECK_NOTINIT(initialized,word);
+    novirial=true;
+    break;
+  case cmd_setPlumedDat:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    plumedDat=static_cast<char*>(val);
+    break;
+  case cmd_setMPIComm:
+    CHECK_NOTINIT(initialized,word);
+    comm.Set_comm(val);
+    atoms.setDomainDecomposition(comm);
+    break;
+  case cmd_setMPIFComm:
+    CHECK_NOTINIT(initialized,word);
+    comm.Set_fcomm(val);
+    atoms.setDomainDecomposition(comm);
+    break;
+  case cmd_setMPImultiSimComm:
+    CHECK_NOTINIT(initialized,word);
+    multi_sim_comm.Set_comm(val);
+    break;
+  case cmd_setNatoms:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setNatoms(*static_cast<int*>(val));
+    break;
+  case cmd_setTimestep:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setTimeStep(val);
+    break;
+  /* ADDED WITH API==2 */
+  case cmd_setKbT:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.setKbT(val);
+    break;
+  /* ADDED WITH API==3 */
+  case cmd_setRestart:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    if(*static_cast<int*>(val)!=0) restart=true;
+    break;
+  /* ADDED WITH API==4 */
+  case cmd_doCheckPoint:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    doCheckPoint = false;
+    if(*static_cast<int*>(val)!=0) doCheckPoint = true;
+    break;
+  /* ADDED WITH API==6 */
+  case cmd_setNumOMPthreads:
+    CHECK_NOTNULL(val,word);
+    OpenMP::setNumThreads(*static_cast<int*>(val)>0?*static_cast<int*>(val):1);
+    break;
+  /* ADDED WITH API==6 */
+  /* only used for testing */
+  case cmd_throw:
+    CHECK_NOTNULL(val,word);
+    testThrow((const char*) val);
+  /* STOP API */
+  case cmd_setMDEngine:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    MDEngine=static_cast<char*>(val);
+    break;
+  case cmd_setLog:
+    CHECK_NOTINIT(initialized,word);
+    log.link(static_cast<FILE*>(val));
+    break;
+  case cmd_setLogFile:
+    CHECK_NOTINIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    log.open(static_cast<char*>(val));
+    break;
+  // other commands that should be used after initialization:
+  case cmd_setStopFlag:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    stopFlag=static_cast<int*>(val);
+    break;
+  case cmd_getExchangesFlag:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    exchangePatterns.getFlag((*static_cast<int*>(val)));
+    break;
+  case cmd_setExchangesSeed:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    exchangePatterns.setSeed((*static_cast<int*>(val)));
+    break;
+  case cmd_setNumberOfReplicas:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    exchangePatterns.setNofR((*static_cast<int*>(val)));
+    break;
+  case cmd_getExchangesList:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    exchangePatterns.getList((static_cast<int*>(val)));
+    break;
+  case cmd_runFinalJobs:
+    CHECK_INIT(initialized,word);
+    runJobsAtEndOfCalculation();
+    break;
+  case cmd_isEnergyNeeded:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    if(atoms.isEnergyNeeded()) *(static_cast<int*>(val))=1;
+    else                       *(static_cast<int*>(val))=0;
+    break;
+  case cmd_getBias:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    atoms.double2MD(getBias()/(atoms.getMDUnits().getEnergy()/atoms.getUnits().getEnergy()),val);
+    break;
+  case cmd_getProfile:
+    CHECK_INIT(initialized,word);
+    CHECK_NOTNULL(val,word);
+    profileReport=profileString();
+    *(static_cast<const char**>(val))=profileReport.c_str();
+    break;
+  case cmd_checkAction:
+    CHECK_NOTNULL(val,word);
+    plumed_assert(nw==2);
+    *(static_cast<int*>(val))=(actionRegister().check(words[1]) ? 1:0);
+    break;
+  case cmd_setExtraCV:
+    CHECK_NOTNULL(val,word);
+    plumed_assert(nw==2);
+    atoms.setExtraCV(words[1],val);
+    break;
+  case cmd_setExtraCVForce:
+    CHECK_NOTNULL(val,word);
+    plumed_assert(nw==2);
+    atoms.setExtraCVForce(words[1],val);
+    break;
+  case cmd_GREX:
+    if(!grex) grex.reset(new GREX(*this));
+    plumed_massert(grex,"error allocating grex");
+    {
+      std::string kk=words[1];
+      for(unsigned i=2; i<words.size(); i++) kk+=" "+words[i];
+      grex->cmd(kk.c_str(),val);
+    }
+    break;
+  case cmd_CLTool:
+    CHECK_NOTINIT(initialized,word);
+    if(!cltool) cltool.reset(new CLToolMain);
+    {
+      std::string kk=words[1];
+      for(unsigned i=2; i<words.size(); i++) kk+=" "+words[i];
+      cltool->cmd(kk.c_str(),val);
+    }
+    break;
+  /* ADDED WITH API==7 */
+  case cmd_convert:
+  {
+    double v;
+    plumed_assert(words.size()==2);
+    if(Tools::convert(words[1],v)) atoms.double2MD(v,val);
+  }
+  break;
+  default:
+    plumed_merror("cannot interpret cmd(\"" + word + "\"). check plumed developers manual to see the available commands.");
+    break;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 void PlumedMain::init() {
@@ -630,19 +754,124 @@ void PlumedMain::init() {
 void PlumedMain::readInputFile(std::string str) {
   plumed_assert(initialized);
   log.printf("FILE: %s\n",str.c_str());
+  if(readCachedInput(str)) {
+    endPlumed=false;
+    log.printf("END FILE: %s\n",str.c_str());
+    log.flush();
+    pilots=actionSet.select<ActionPilot*>();
+    return;
+  }
   IFile ifile;
   ifile.link(*this);
   ifile.open(str);
   ifile.allowNoEOL();
   std::vector<std::string> words;
-  while(Tools::getParsedLine(ifile,words) && !endPlumed) readInputWords(words);
+  std::vector<std::vector<std::string> > parsed;
+  const bool caching=std::getenv("PLUMED_INPUT_CACHE");
+  while(Tools::getParsedLine(ifile,words) && !endPlumed) {
+    if(caching) parsed.push_back(words);
+    readInputWords(words);
+  }
   endPlumed=false;
+  if(caching) writeCachedInput(str,parsed);
   log.printf("END FILE: %s\n",str.c_str());
   log.flush();
 
   pilots=actionSet.select<ActionPilot*>();
 }
 
+namespace {
+
+/// 64 bit FNV-1a hash of the contents of a file, used to key the input cache
+bool hashFileContents(const std::string & path,unsigned long long & hash) {
+  FILE* fp=std::fopen(path.c_str(),"r");
+  if(!fp) return false;
+  hash=14695981039346656037ULL;
+  char buffer[4096];
+  std::size_t n;
+  while((n=std::fread(buffer,1,sizeof(buffer),fp))>0) {
+    for(std::size_t i=0; i<n; i++) {
+      hash^=static_cast<unsigned char>(buffer[i]);
+      hash*=1099511628211ULL;
+    }
+  }
+  std::fclose(fp);
+  return true;
+}
+
+/// Resolve the name of the cache entry for a given input file. The suffix
+/// resolution mirrors the one done by IFile::open, so that every replica
+/// is keyed by the file it would actually read.
+bool inputCacheName(const std::string & str,const std::string & suffix,std::string & name) {
+  const char* dir=std::getenv("PLUMED_INPUT_CACHE");
+  if(!dir || std::strlen(dir)==0) return false;
+  unsigned long long hash;
+  if(!hashFileContents(FileBase::appendSuffix(str,suffix),hash) && !hashFileContents(str,hash)) return false;
+  std::ostringstream oss;
+  oss<<dir<<"/plumed-input-"<<std::hex<<hash<<".cache";
+  name=oss.str();
+  return true;
+}
+
+}
+
+bool PlumedMain::readCachedInput(const std::string & str) {
+  std::string cachename;
+  if(!inputCacheName(str,getSuffix(),cachename)) return false;
+  FILE* fp=std::fopen(cachename.c_str(),"r");
+  if(!fp) return false;
+  auto deleter=[](FILE* f) { std::fclose(f); };
+  std::unique_ptr<FILE,decltype(deleter)> fp_deleter(fp,deleter);
+  // The whole entry is parsed before any line is executed, so that a
+  // truncated or corrupted entry can be discarded without side effects
+  // and the input is then read from scratch.
+  unsigned version,nlines;
+  if(std::fscanf(fp,"#! PLUMED_INPUT_CACHE %u %u\n",&version,&nlines)!=2) return false;
+  if(version!=1) return false;
+  std::vector<std::vector<std::string> > parsed(nlines);
+  for(unsigned i=0; i<nlines; i++) {
+    unsigned nw;
+    if(std::fscanf(fp,"%u\n",&nw)!=1) return false;
+    parsed[i].resize(nw);
+    for(unsigned j=0; j<nw; j++) {
+      unsigned len;
+      if(std::fscanf(fp,"%u ",&len)!=1) return false;
+      std::vector<char> buffer(len);
+      if(len>0 && std::fread(buffer.data(),1,len,fp)!=len) return false;
+      parsed[i][j].assign(buffer.begin(),buffer.end());
+      if(std::fgetc(fp)!='\n') return false;
+    }
+  }
+  log.printf("Restoring pre-parsed input from cache entry %s\n",cachename.c_str());
+  for(unsigned i=0; i<nlines && !endPlumed; i++) readInputWords(parsed[i]);
+  return true;
+}
+
+void PlumedMain::writeCachedInput(const std::string & str,const std::vector<std::vector<std::string> > & parsed) {
+  std::string cachename;
+  if(!inputCacheName(str,getSuffix(),cachename)) return;
+  if(comm.Get_rank()!=0) return;
+  // Write to a per-process temporary name and rename it in place, so that
+  // concurrent instances reading the same input never see a partial entry.
+  std::ostringstream oss;
+  oss<<cachename<<".tmp."<<static_cast<unsigned long>(getpid());
+  const std::string tmpname=oss.str();
+  FILE* fp=std::fopen(tmpname.c_str(),"w");
+  if(!fp) return;
+  std::fprintf(fp,"#! PLUMED_INPUT_CACHE %u %zu\n",1u,parsed.size());
+  for(unsigned i=0; i<parsed.size(); i++) {
+    std::fprintf(fp,"%zu\n",parsed[i].size());
+    for(unsigned j=0; j<parsed[i].size(); j++) {
+      std::fprintf(fp,"%zu ",parsed[i][j].length());
+      std::fwrite(parsed[i][j].c_str(),1,parsed[i][j].length(),fp);
+      std::fputc('\n',fp);
+    }
+  }
+  std::fclose(fp);
+  if(std::rename(tmpname.c_str(),cachename.c_str())!=0) std::remove(tmpname.c_str());
+  log.printf("Parsed input stored in cache entry %s\n",cachename.c_str());
+}
+
 void PlumedMain::readInputLine(const std::string & str) {
   plumed_assert(initialized);
   if(str.empty()) return;
@@ -770,6 +999,37 @@ void PlumedMain::prepareDependencies() {
 
 }
 
+void PlumedMain::prepareBiasDependencies() {
+
+// Stopwatch is stopped when sw goes out of scope
+  auto sw=stopwatch.startStop("1 Prepare dependencies");
+
+// First switch off all actions
+  for(const auto & p : actionSet) {
+    p->deactivate();
+  }
+
+// then activate only the actions carrying a bias or work component.
+// Activation is recursive, so everything these actions depend on is switched
+// on as well, while actions that only feed output on this step stay off
+  active=false;
+  for(const auto & p : actionSet) {
+    ActionWithValue*av=dynamic_cast<ActionWithValue*>(p.get());
+    if( !av ) continue;
+    if( av->exists(av->getLabel()+".bias") || av->exists(av->getLabel()+".work") ) {
+      p->activate();
+      active=true;
+    }
+  }
+
+  for(const auto & p : actionSet) {
+    if(p->isActive()) {
+      if(p->checkNeedsGradients()) p->setOption("GRADIENTS");
+    }
+  }
+
+}
+
 void PlumedMain::shareData() {
 // atom positions are shared (but only if there is something to do)
   if(!active)return;
@@ -806,6 +1066,61 @@ void PlumedMain::justCalculate() {
   bias=0.0;
   work=0.0;
 
+// actions belonging to the same dependency level can be evaluated
+// concurrently. this is only done on request (PLUMED_TASK_PARALLEL), and
+// only without MPI parallelism (the collective operations performed inside
+// the actions require a fixed evaluation order across the ranks) and
+// without detailed timers (the stopwatch is shared). otherwise the actions
+// are evaluated in plain input order, as they always were
+  const bool parallel=taskScheduler.parallelRequested() && comm.Get_size()==1 && !detailedTimers;
+
+// group the active actions into levels of independent actions.
+// the schedule is persistent and only rebuilt when the active set changes
+  if(parallel) taskScheduler.update(actionSet);
+
+  auto calculateAction=[](Action* p, double & bias_, double & work_) {
+    const auto profile_t0=std::chrono::steady_clock::now();
+    ActionWithValue*av=dynamic_cast<ActionWithValue*>(p);
+    ActionAtomistic*aa=dynamic_cast<ActionAtomistic*>(p);
+    {
+      if(av) av->clearInputForces();
+      if(av) av->clearDerivatives();
+    }
+    {
+      if(aa) aa->clearOutputForces();
+      if(aa) if(aa->isActive()) aa->retrieveAtoms();
+    }
+    if(p->checkNumericalDerivatives()) p->calculateNumericalDerivatives();
+    else p->calculate();
+    // This retrieves components called bias
+    if(av) bias_+=av->getOutputQuantity("bias");
+    if(av) work_+=av->getOutputQuantity("work");
+    if(av)av->setGradientsIfNeeded();
+    ActionWithVirtualAtom*avv=dynamic_cast<ActionWithVirtualAtom*>(p);
+    if(avv)avv->setGradientsIfNeeded();
+    p->profileAddCalculate(std::chrono::duration<double>(std::chrono::steady_clock::now()-profile_t0).count());
+  };
+
+// complete a possibly pending position exchange before threads are spawned,
+// since the lazy completion triggered from retrieveAtoms() is not thread safe
+  if(parallel && atoms.getNatoms()>0) atoms.completeAsyncShare();
+
+  if(parallel) {
+// calculate the active actions level by level (assuming *backward* dependence)
+    for(const auto & level : taskScheduler.getLevels()) {
+      if(level.size()>1) {
+        double lbias=0.0, lwork=0.0;
+        #pragma omp parallel for reduction(+:lbias,lwork) schedule(dynamic,1)
+        for(unsigned i=0; i<level.size(); i++) calculateAction(level[i],lbias,lwork);
+        bias+=lbias;
+        work+=lwork;
+      } else {
+        for(const auto & p : level) calculateAction(p,bias,work);
+      }
+    }
+    return;
+  }
+
   int iaction=0;
 // calculate the active actions in order (assuming *backward* dependence)
   for(const auto & pp : actionSet) {
@@ -823,24 +1138,7 @@ void PlumedMain::justCalculate() {
         for(int i=0; i<pad; i++) actionNumberLabel=" "+actionNumberLabel;
         sw=stopwatch.startStop("4A "+actionNumberLabel+" "+p->getLabel());
       }
-      ActionWithValue*av=dynamic_cast<ActionWithValue*>(p);
-      ActionAtomistic*aa=dynamic_cast<ActionAtomistic*>(p);
-      {
-        if(av) av->clearInputForces();
-        if(av) av->clearDerivatives();
-      }
-      {
-        if(aa) aa->clearOutputForces();
-        if(aa) if(aa->isActive()) aa->retrieveAtoms();
-      }
-      if(p->checkNumericalDerivatives()) p->calculateNumericalDerivatives();
-      else p->calculate();
-      // This retrieves components called bias
-      if(av) bias+=av->getOutputQuantity("bias");
-      if(av) work+=av->getOutputQuantity("work");
-      if(av)av->setGradientsIfNeeded();
-      ActionWithVirtualAtom*avv=dynamic_cast<ActionWithVirtualAtom*>(p);
-      if(avv)avv->setGradientsIfNeeded();
+      calculateAction(p,bias,work);
     }
     iaction++;
   }
@@ -874,10 +1172,12 @@ void PlumedMain::backwardPropagate() {
         sw=stopwatch.startStop("5A "+actionNumberLabel+" "+p->getLabel());
       }
 
+      const auto profile_t0=std::chrono::steady_clock::now();
       p->apply();
       ActionAtomistic*a=dynamic_cast<ActionAtomistic*>(p);
 // still ActionAtomistic has a special treatment, since they may need to add forces on atoms
       if(a) a->applyForces();
+      p->profileAddApply(std::chrono::duration<double>(std::chrono::steady_clock::now()-profile_t0).count());
 
     }
     iaction++;
@@ -986,6 +1286,12 @@ void PlumedMain::fflush() {
   for(const auto  & p : files) {
     p->flush();
   }
+// wait for any state snapshot still queued in the background writer
+  checkpointService.barrier();
+}
+
+CheckpointService & PlumedMain::getCheckpointService() {
+  return checkpointService;
 }
 
 void PlumedMain::insertFile(FileBase&f) {
@@ -1000,6 +1306,33 @@ void PlumedMain::stop() {
   stopNow=true;
 }
 
+std::string PlumedMain::profileString() {
+  std::vector<Action*> sorted;
+  for(const auto & p : actionSet) sorted.push_back(p.get());
+  std::sort(sorted.begin(),sorted.end(),[](Action* a, Action* b) {
+    return (a->getCalculateTime()+a->getApplyTime())>(b->getCalculateTime()+b->getApplyTime());
+  });
+  std::ostringstream os;
+  char buffer[256];
+  os<<"Per-action profile (sorted by total time)\n";
+  std::snprintf(buffer,sizeof(buffer),"%-25s %-20s %10s %12s %12s %8s %10s\n",
+                "label","action","calls","calc [s]","apply [s]","natoms","nderiv");
+  os<<buffer;
+  for(const auto & p : sorted) {
+    unsigned natoms=0;
+    unsigned nderiv=0;
+    ActionAtomistic* aa=dynamic_cast<ActionAtomistic*>(p);
+    if(aa) natoms=aa->getNumberOfAtoms();
+    ActionWithValue* av=dynamic_cast<ActionWithValue*>(p);
+    if(av && av->getNumberOfComponents()>0 && av->copyOutput(0)->hasDerivatives()) nderiv=av->copyOutput(0)->getNumberOfDerivatives();
+    std::snprintf(buffer,sizeof(buffer),"%-25s %-20s %10lu %12.6f %12.6f %8u %10u\n",
+                  p->getLabel().c_str(),p->getName().c_str(),p->getCalculateCount(),
+                  p->getCalculateTime(),p->getApplyTime(),natoms,nderiv);
+    os<<buffer;
+  }
+  return os.str();
+}
+
 void PlumedMain::runJobsAtEndOfCalculation() {
   for(const auto & p : actionSet) {
     p->runFinalJobs();
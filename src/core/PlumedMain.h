@@ -57,6 +57,8 @@ class ActionPilot;
 class Log;
 class Atoms;
 class ActionSet;
+class TaskScheduler;
+class CheckpointService;
 class DLLoader;
 class Communicator;
 class Stopwatch;
@@ -65,6 +67,39 @@ class ExchangePatterns;
 class FileBase;
 class DataFetchingObject;
 
+/**
+Packed per-step data for the "setAllData" command.
+Engines that call plumed at every step can fill this structure once and pass
+its address with a single cmd("setAllData",&data), instead of issuing one
+string-keyed command per item. Any pointer left null is simply not set, with
+the same meaning as not issuing the corresponding individual command, and
+pointers are interpreted according to the declared real precision, exactly as
+in the individual commands.
+*/
+struct PlumedStepData {
+/// Current step, equivalent to cmd("setStepLong")
+  long int step;
+/// Equivalent to cmd("setPositions")
+  void* positions;
+/// Equivalent to cmd("setMasses")
+  void* masses;
+/// Equivalent to cmd("setCharges")
+  void* charges;
+/// Equivalent to cmd("setBox")
+  void* box;
+/// Equivalent to cmd("setForces")
+  void* forces;
+/// Equivalent to cmd("setVirial")
+  void* virial;
+/// Equivalent to cmd("setEnergy")
+  void* energy;
+/// Equivalent to cmd("setStopFlag")
+  void* stopFlag;
+  PlumedStepData():
+    step(0),positions(NULL),masses(NULL),charges(NULL),box(NULL),
+    forces(NULL),virial(NULL),energy(NULL),stopFlag(NULL) {}
+};
+
 /**
 Main plumed object.
 In MD engines this object is not manipulated directly but it is wrapped in
@@ -94,6 +129,9 @@ public:
   Communicator&multi_sim_comm=*multi_sim_comm_fwd;
 
 private:
+/// Execute a command already translated to its integer handle.
+/// This is the common back end of the two cmd() entry points
+  void cmdExecute(int iword,const std::string & word,const std::vector<std::string> & words,void*val);
 /// Error handler.
 /// Pointer to a function that is called an exception thrown within
 /// the library is about to leave the library.
@@ -162,6 +200,17 @@ private:
 /// Set of actions found in plumed.dat file
   ActionSet& actionSet=*actionSet_fwd;
 
+/// Forward declaration.
+  ForwardDecl<TaskScheduler> taskScheduler_fwd;
+/// Persistent schedule used in the forward loop, grouping independent
+/// actions into levels of the dependency graph
+  TaskScheduler& taskScheduler=*taskScheduler_fwd;
+
+/// Forward declaration.
+  ForwardDecl<CheckpointService> checkpointService_fwd;
+/// Background writer for periodic state snapshots, see CheckpointService
+  CheckpointService& checkpointService=*checkpointService_fwd;
+
 /// Set of Pilot actions.
 /// These are the action the, if they are Pilot::onStep(), can trigger execution
   std::vector<ActionPilot*> pilots;
@@ -199,6 +248,10 @@ private:
 /// Store information used in class \ref generic::UpdateIf
   std::stack<bool> updateFlags;
 
+/// Storage for the report returned by cmd("getProfile"), kept as a member
+/// so that the pointer handed to the caller stays valid
+  std::string profileReport;
+
 public:
 /// Flag to switch off virial calculation (for debug and MD codes with no barostat)
   bool novirial;
@@ -239,6 +292,17 @@ public:
    Notice that this interface should always keep retro-compatibility
   */
   void cmd(const std::string&key,void*val=NULL) override;
+  /**
+   Translate a command name into an integer handle.
+   The handle can then be passed to cmd(int,void*), skipping the string
+   lookup on every invocation. Only single-word commands can be invoked by
+   handle. Throws an exception for unknown commands.
+  */
+  int cmdHandle(const std::string&key);
+  /**
+   Invoke a command by the handle obtained with cmdHandle().
+  */
+  void cmd(int handle,void*val=NULL);
   ~PlumedMain();
   /**
     Read an input file.
@@ -267,6 +331,22 @@ public:
   */
   void readInputLines(const std::string & str);
 
+  /**
+    Try to restore the parsed lines of an input file from the input cache.
+    The cache is enabled by setting the PLUMED_INPUT_CACHE environment
+    variable to a directory. Entries are keyed by a hash of the file
+    contents, so a modified input never matches a stale entry.
+    \return true if a valid cache entry was found and replayed
+  */
+  bool readCachedInput(const std::string & str);
+
+  /**
+    Store the parsed lines of an input file in the input cache.
+    Only does something when the PLUMED_INPUT_CACHE environment variable
+    is set, see readCachedInput().
+  */
+  void writeCachedInput(const std::string & str,const std::vector<std::vector<std::string> > & parsed);
+
   /**
     Initialize the object.
     Should be called once.
@@ -284,6 +364,14 @@ public:
     the atoms needed at this step.
   */
   void prepareDependencies();
+  /**
+    Prepare the list of active Actions for an exchange attempt.
+    Same as prepareDependencies(), but only the actions on which the bias
+    depends are activated.  Only the bias enters the acceptance test, so the
+    actions that merely feed output on this step are not recomputed on the
+    swapped coordinates.
+  */
+  void prepareBiasDependencies();
   /**
     Share the needed atoms.
     In asynchronous implementations, this method sends the required atoms to all the plumed processes,
@@ -336,10 +424,21 @@ public:
     makes sures they are done
   */
   void runJobsAtEndOfCalculation();
+  /**
+    Build the per-action profile report: for every action the accumulated
+    time in calculate and apply, the number of calls, the number of
+    requested atoms and the size of the derivatives, sorted by total time.
+    It is written to the log at the end of the run when the environment
+    variable PLUMED_PROFILE is set and can be retrieved at any moment
+    with cmd("getProfile").
+  */
+  std::string profileString();
 /// Reference to atoms object
   Atoms& getAtoms();
 /// Reference to the list of Action's
   const ActionSet & getActionSet()const;
+/// Reference to the background checkpoint writer
+  CheckpointService & getCheckpointService();
 /// Referenge to the log stream
   Log & getLog();
 /// Return the number of the step
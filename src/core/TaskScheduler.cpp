@@ -0,0 +1,88 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "TaskScheduler.h"
+#include "Action.h"
+#include "ActionAtomistic.h"
+#include "ActionSet.h"
+#include "tools/Exception.h"
+
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+
+namespace PLMD {
+
+TaskScheduler::TaskScheduler():
+  taskParallel(false)
+{
+  if(std::getenv("PLUMED_TASK_PARALLEL")) {
+    std::string s(std::getenv("PLUMED_TASK_PARALLEL"));
+    if(s=="yes") taskParallel=true;
+    else if(s=="no") taskParallel=false;
+    else plumed_merror("PLUMED_TASK_PARALLEL variable is set to " + s + "; should be yes or no");
+  }
+}
+
+void TaskScheduler::update(const ActionSet& actions) {
+  std::vector<Action*> active;
+  active.reserve(scheduled.size());
+  for(const auto & pp : actions) {
+    Action* p(pp.get());
+    if(p->isActive()) active.push_back(p);
+  }
+  if(active==scheduled) return;
+
+  levels.clear();
+  std::unordered_map<const Action*,unsigned> levelOf;
+// the action set is topologically ordered (backward dependence), so all
+// the dependencies of an action have been assigned a level when the
+// action itself is examined
+  unsigned maxLev=0;
+// actions that rewrite shared state (e.g. WHOLEMOLECULES, which modifies
+// the global positions in place) affect every action that follows them in
+// the input, whether or not a dependency was registered. They act as
+// barriers: they are placed after everything already scheduled, and
+// nothing that follows them in the input may be hoisted before them
+  unsigned floor=0;
+  for(const auto & p : active) {
+    unsigned lev=floor;
+    auto* aa=dynamic_cast<ActionAtomistic*>(p);
+    if(aa && aa->modifiesGlobalState() && levelOf.size()>0) {
+      lev=maxLev+1;
+    } else {
+      for(const auto & d : p->getDependencies()) {
+        const auto it=levelOf.find(d);
+// dependencies that are not active are not evaluated this step and thus
+// impose no ordering
+        if(it!=levelOf.end() && it->second+1>lev) lev=it->second+1;
+      }
+    }
+    levelOf[p]=lev;
+    if(lev>maxLev) maxLev=lev;
+    if(aa && aa->modifiesGlobalState()) floor=lev+1;
+    if(lev>=levels.size()) levels.resize(lev+1);
+    levels[lev].push_back(p);
+  }
+  scheduled=std::move(active);
+}
+
+}
@@ -0,0 +1,74 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_core_TaskScheduler_h
+#define __PLUMED_core_TaskScheduler_h
+
+#include <vector>
+
+namespace PLMD {
+
+class Action;
+class ActionSet;
+
+/// \ingroup INTERNAL
+/// Persistent schedule for the forward (calculate) loop.
+///
+/// The active actions are grouped into the levels of their dependency
+/// graph: each action is placed in the first level that follows the levels
+/// of all the actions it depends on. Actions belonging to the same level
+/// are therefore independent of each other, directly and indirectly, and
+/// can be evaluated in any order or concurrently. Actions that rewrite
+/// shared state in place (see ActionAtomistic::modifiesGlobalState())
+/// are scheduled as barriers, after every earlier action and before
+/// every later one. Since the set of active actions changes rarely, the
+/// schedule is cached between steps and rebuilt only when the set changes.
+class TaskScheduler {
+/// The active actions for which the current schedule was built
+  std::vector<Action*> scheduled;
+/// The schedule, as a sequence of levels of mutually independent actions
+  std::vector<std::vector<Action*> > levels;
+/// Whether concurrent evaluation of independent actions was requested
+/// with PLUMED_TASK_PARALLEL
+  bool taskParallel;
+public:
+  TaskScheduler();
+/// Rebuild the schedule if the set of active actions has changed
+  void update(const ActionSet& actions);
+/// The active actions grouped by dependency level
+  const std::vector<std::vector<Action*> > & getLevels() const;
+/// Whether independent actions should be evaluated concurrently
+  bool parallelRequested() const;
+};
+
+inline
+const std::vector<std::vector<Action*> > & TaskScheduler::getLevels() const {
+  return levels;
+}
+
+inline
+bool TaskScheduler::parallelRequested() const {
+  return taskParallel;
+}
+
+}
+
+#endif
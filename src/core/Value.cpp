@@ -85,6 +85,14 @@ bool Value::applyForce(std::vector<double>& forces ) const {
   return true;
 }
 
+bool Value::accumulateForce(std::vector<double>& forces ) const {
+  if( !hasForce ) return false;
+  plumed_dbg_massert( derivatives.size()==forces.size()," forces array has wrong size" );
+  const unsigned N=derivatives.size();
+  for(unsigned i=0; i<N; ++i) forces[i]+=inputForce*derivatives[i];
+  return true;
+}
+
 void Value::setNotPeriodic() {
   min=0; max=0; periodicity=notperiodic;
 }
@@ -66,7 +66,11 @@ private:
   double inputForce;
 /// A flag telling us we have a force acting on this quantity
   bool hasForce;
-/// The derivatives of the quantity stored in value
+/// The derivatives of the quantity stored in value.
+/// Notice that this array is already compact: actions size it to their own
+/// number of derivatives (for a Colvar, 3*nat+9 where nat is the number of
+/// atoms it requested, not the number of atoms in the system), so a CV
+/// touching 4 atoms stores 21 doubles regardless of the system size
   std::vector<double> derivatives;
   std::map<AtomNumber,Vector> gradients;
 /// The name of this quantiy
@@ -133,6 +137,10 @@ public:
   double getForce() const ;
 /// Apply the forces to the derivatives using the chain rule (if there are no forces this routine returns false)
   bool applyForce( std::vector<double>& forces ) const ;
+/// Same as applyForce, but the result is accumulated into forces instead of
+/// overwriting it.  This fuses the chain rule with the sum over components,
+/// so the derivative array is traversed only once
+  bool accumulateForce( std::vector<double>& forces ) const ;
 /// Calculate the difference between the instantaneous value of the function and some other point: other_point-inst_val
   double difference(double)const;
 /// Calculate the difference between two values of this function: d2 -d1
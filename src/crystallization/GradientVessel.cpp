@@ -112,8 +112,7 @@ void GradientVessel::calculate( const unsigned& current, MultiValue& myvals, std
     for(unsigned jc=0; jc<ncomponents; ++jc) {
       double colvar=myvals.get( cstart + jc );
       buffer[bufstart+(xx+1+jc)*(nder+1) ] += weight*colvar;
-      myvals.chainRule( cstart + jc, xx + 1 + jc, 1, 0, weight, bufstart, buffer );
-      myvals.chainRule( wstart + iw, xx + 1 + jc, 1, 0, colvar, bufstart, buffer );
+      myvals.chainRule2( cstart + jc, wstart + iw, xx + 1 + jc, 1, 0, weight, colvar, bufstart, buffer );
     }
   }
 }
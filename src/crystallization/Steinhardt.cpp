@@ -67,6 +67,17 @@ Steinhardt::Steinhardt( const ActionOptions& ao ):
 
 void Steinhardt::setAngularMomentum( const unsigned& ang ) {
   tmom=ang; setVectorDimensionality( 2*(2*ang + 1) );
+  // tabulate the factorial prefactors used by deriv_poly; these are exact
+  // integers so looking them up gives bitwise identical results to the
+  // products they replace
+  factorials.resize( tmom+1 );
+  for(unsigned m=0; m<=tmom; ++m) {
+    factorials[m].assign( tmom-m+1, 1.0 );
+    for(unsigned j=1; j<=m; ++j) factorials[m][0]*=j;
+    for(unsigned k=1; k<=tmom-m; ++k) {
+      for(unsigned j=k+1; j<=m+k; ++j) factorials[m][k]*=j;
+    }
+  }
 }
 
 void Steinhardt::calculateVector( multicolvar::AtomValuePack& myatoms ) const {
@@ -136,7 +147,7 @@ void Steinhardt::calculateVector( multicolvar::AtomValuePack& myatoms ) const {
         // Imaginary part
         accumulateSymmetryFunction( 2+ncomp+tmom+m, i, sw*itq6, myimagvec, Tensor( -myimagvec,distance ), myatoms );
         // Store -m part of vector
-        double pref=pow(-1.0,m);
+        double pref=(m%2==0)? 1.0 : -1.0;
         // -m part of vector is just +m part multiplied by (-1.0)**m and multiplied by complex
         // conjugate of Legendre polynomial
         // Real part
@@ -155,16 +166,14 @@ void Steinhardt::calculateVector( multicolvar::AtomValuePack& myatoms ) const {
 }
 
 double Steinhardt::deriv_poly( const unsigned& m, const double& val, double& df ) const {
-  double fact=1.0;
-  for(unsigned j=1; j<=m; ++j) fact=fact*j;
-  double res=coeff_poly[m]*fact;
+  plumed_dbg_assert( m<factorials.size() );
+  const std::vector<double>& fact( factorials[m] );
+  double res=coeff_poly[m]*fact[0];
 
   double pow=1.0, xi=val, dxi=1.0; df=0.0;
   for(int i=m+1; i<=tmom; ++i) {
-    double fact=1.0;
-    for(unsigned j=i-m+1; j<=i; ++j) fact=fact*j;
-    res=res+coeff_poly[i]*fact*xi;
-    df = df + pow*coeff_poly[i]*fact*dxi;
+    res=res+coeff_poly[i]*fact[i-m]*xi;
+    df = df + pow*coeff_poly[i]*fact[i-m]*dxi;
     xi=xi*val; dxi=dxi*val; pow+=1.0;
   }
   df = df*normaliz[m];
@@ -37,6 +37,10 @@ private:
 protected:
   std::vector<double> coeff_poly;
   std::vector<double> normaliz;
+/// Factorial prefactors entering the associated Legendre polynomials,
+/// tabulated once in setAngularMomentum: factorials[m][k] = (m+k)!/k!.
+/// Rebuilding these per neighbor pair in deriv_poly dominated its cost
+  std::vector<std::vector<double> > factorials;
   void setAngularMomentum( const unsigned& ang );
 public:
   static void registerKeywords( Keywords& keys );
@@ -85,8 +85,8 @@ void VectorMean::calculate( const unsigned& current, MultiValue& myvals, std::ve
   if( diffweight ) myvals.chainRule( 0, 0, 1, 0, 1.0, bufstart, buffer );
   for(unsigned i=0; i<ncomp; ++i) {
     double colvar=myvals.get(2+i);
-    myvals.chainRule( 2+i, 1+i, 1, 0, weight, bufstart, buffer );
-    if( diffweight ) myvals.chainRule( 0, 1+i, 1, 0, colvar, bufstart, buffer );
+    if( diffweight ) myvals.chainRule2( 2+i, 0, 1+i, 1, 0, weight, colvar, bufstart, buffer );
+    else myvals.chainRule( 2+i, 1+i, 1, 0, weight, bufstart, buffer );
   }
   return;
 }
@@ -87,11 +87,15 @@ void DimensionalityReductionBase::performAnalysis() {
       for(unsigned j=0; j<nlow; ++j) projections(i,j)=newp[j];
     }
   }
-  // Calculate matrix of dissimilarities
+  // Calculate matrix of dissimilarities.  Rows are distributed over MPI
+  // ranks: every rank fills its own stripe through its local dissimilarity
+  // cache and the stripes are then summed together
   Matrix<double> targets( getNumberOfDataPoints(), getNumberOfDataPoints() ); targets=0;
-  for(unsigned i=1; i<getNumberOfDataPoints(); ++i) {
+  unsigned rank=comm.Get_rank(), size=comm.Get_size();
+  for(unsigned i=1+rank; i<getNumberOfDataPoints(); i+=size) {
     for(unsigned j=0; j<i; ++j) targets(i,j)=targets(j,i)=getDissimilarity( i, j );
   }
+  if( size>1 ) comm.Sum( targets );
   // This calculates the projections of the points
   calculateProjections( targets, projections );
   // Now set the projection values in the underlying object
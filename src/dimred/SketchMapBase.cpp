@@ -127,6 +127,15 @@ double SketchMapBase::calculateStress( const std::vector<double>& p, std::vector
   return stress;
 }
 
+void SketchMapBase::calculateStressBatch( const unsigned& np, const std::vector<double>& pp, std::vector<double>& eng, std::vector<double>& der ) {
+  std::vector<double> p( nlow ), d( nlow );
+  for(unsigned i=0; i<np; ++i) {
+    for(unsigned j=0; j<nlow; ++j) p[j]=pp[i*nlow+j];
+    eng[i]=calculateStress( p, d );
+    for(unsigned j=0; j<nlow; ++j) der[i*nlow+j]=d[j];
+  }
+}
+
 double SketchMapBase::calculateFullStress( const std::vector<double>& p, std::vector<double>& d ) {
   // Zero derivative and stress accumulators
   for(unsigned i=0; i<p.size(); ++i) d[i]=0.0;
@@ -66,6 +66,10 @@ public:
 /// This function makes use of the distance data in dtargets and ftargets
 /// It is used in PLMD::dimred::ProjectOutOfSample and in pointwise optimisation
   double calculateStress( const std::vector<double>& p, std::vector<double>& d ) override;
+/// Calculate the pointwise stress for a batch of np trial positions that are packed
+/// one after the other in pp.  This is used by the grid search in pointwise optimisation
+/// and is safe to call concurrently from several threads
+  void calculateStressBatch( const unsigned& np, const std::vector<double>& pp, std::vector<double>& eng, std::vector<double>& der );
 /// Calculate the total stress when the projections are placed at point p.  Notice
 /// this is a vectorized version of the matrix of projections
   double calculateFullStress( const std::vector<double>& p, std::vector<double>& d );
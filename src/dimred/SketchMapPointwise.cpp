@@ -111,7 +111,7 @@ void SketchMapPointwise::minimise( Matrix<double>& projections ) {
       // Find current projection of jth point
       for(unsigned k=0; k<mypoint.size(); ++k) mypoint[k]=projections(j,k);
       // Minimise using grid search
-      bool moved=mygridsearch.minimise( mypoint, &SketchMapPointwise::calculateStress );
+      bool moved=mygridsearch.minimise( mypoint, &SketchMapPointwise::calculateStress, &SketchMapPointwise::calculateStressBatch );
       if( moved ) {
         // Reassign the new projection
         for(unsigned k=0; k<mypoint.size(); ++k) projections(j,k)=mypoint[k];
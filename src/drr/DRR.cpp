@@ -92,6 +92,8 @@ void DRRForceGrid::fillTable(const vector<vector<double>> &in) {
   }
 }
 
+const size_t DRRForceGrid::checkpointBlockSize;
+
 DRRForceGrid::DRRForceGrid()
   : suffix(""), ndims(0), dimensions(0), sampleSize(0),
     headers(""), table(0), forces(0), samples(0), endpoints(0), shifts(0),
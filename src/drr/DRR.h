@@ -35,8 +35,10 @@
 // boost headers for serialization
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/array.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 namespace PLMD {
 namespace drr {
@@ -235,6 +237,23 @@ protected:
   static size_t index1D(const DRRAxis &c, double x);
   void fillTable(const vector<vector<double>> &in);
 
+  /// Number of sample points per serialization block
+  static const size_t checkpointBlockSize = 4096;
+  /// Whether a serialization block has collected no sample yet
+  bool blockIsEmpty(size_t b) const {
+    const size_t first = b * checkpointBlockSize;
+    const size_t last = std::min(first + checkpointBlockSize, sampleSize);
+    for (size_t i = first; i < last; ++i) {
+      if (samples[i] != 0)
+        return false;
+    }
+    for (size_t i = first * ndims; i < last * ndims; ++i) {
+      if (forces[i] != 0.0)
+        return false;
+    }
+    return true;
+  }
+
   /// Boost serialization functions
   friend class boost::serialization::access;
   template <class Archive>
@@ -242,17 +261,53 @@ protected:
     // Don't save all members.
     ar << suffix;
     ar << dimensions;
-    ar << forces;
-    ar << samples;
+    // Write the grids in fixed-size blocks, skipping the blocks that have
+    // collected no sample: on large eABF grids the unvisited regions
+    // dominate, and serializing them as zeros is what made the state
+    // files multi-GB and stalled the simulation at every checkpoint.
+    const size_t bs = checkpointBlockSize;
+    const size_t nblocks = (sampleSize + bs - 1) / bs;
+    size_t nstored = 0;
+    for (size_t b = 0; b < nblocks; ++b) {
+      if (!blockIsEmpty(b))
+        ++nstored;
+    }
+    ar << sampleSize;
+    ar << nstored;
+    for (size_t b = 0; b < nblocks; ++b) {
+      if (blockIsEmpty(b))
+        continue;
+      const size_t len = std::min(bs, sampleSize - b * bs);
+      ar << b;
+      ar << boost::serialization::make_array(&samples[b * bs], len);
+      ar << boost::serialization::make_array(&forces[b * bs * ndims], len * ndims);
+    }
   }
   template <class Archive> void load(Archive &ar, const unsigned int version) {
     ar >> suffix;
     ar >> dimensions;
-    ar >> forces;
-    ar >> samples;
-    // Restore other members.
     ndims = dimensions.size();
-    sampleSize = samples.size();
+    if (version == 0) {
+      // state file written before the blocked format
+      ar >> forces;
+      ar >> samples;
+      sampleSize = samples.size();
+    } else {
+      const size_t bs = checkpointBlockSize;
+      size_t nstored = 0;
+      ar >> sampleSize;
+      ar >> nstored;
+      forces.assign(sampleSize * ndims, 0.0);
+      samples.assign(sampleSize, 0);
+      for (size_t i = 0; i < nstored; ++i) {
+        size_t b = 0;
+        ar >> b;
+        const size_t len = std::min(bs, sampleSize - b * bs);
+        ar >> boost::serialization::make_array(&samples[b * bs], len);
+        ar >> boost::serialization::make_array(&forces[b * bs * ndims], len * ndims);
+      }
+    }
+    // Restore other members.
     std::stringstream ss;
     ss << "# " << ndims << '\n';
     vector<vector<double>> mp(ndims);
@@ -354,5 +409,9 @@ private:
 }
 }
 
+// bump the class version for the blocked grid storage, so that state
+// files written with the old full-vector format are still readable
+BOOST_CLASS_VERSION(PLMD::drr::DRRForceGrid, 1)
+
 #endif
 #endif
@@ -20,6 +20,7 @@
 #include "bias/Bias.h"
 #include "core/Atoms.h"
 #include "core/PlumedMain.h"
+#include "core/CheckpointService.h"
 #include "DRR.h"
 #include "tools/Random.h"
 #include "tools/Tools.h"
@@ -34,6 +35,7 @@
 #include <iostream>
 #include <limits>
 #include <random>
+#include <sstream>
 #include <string>
 
 using namespace PLMD;
@@ -800,12 +802,16 @@ void DynamicReferenceRestraining::update() {
 
 void DynamicReferenceRestraining::save(const string &filename,
                                        long long int step) {
-  std::ofstream out;
-  out.open(filename.c_str(), std::ios::binary);
-  boost::archive::binary_oarchive oa(out);
-  oa << step << fict << vfict << vfict_laststep << ffict << ABFGrid
-     << CZARestimator;
-  out.close();
+  // serialize to memory and hand the snapshot to the background checkpoint
+  // writer: the state includes the full CZAR and ABF grids and rewriting it
+  // in line stalls the step
+  std::ostringstream out(std::ios::binary);
+  {
+    boost::archive::binary_oarchive oa(out);
+    oa << step << fict << vfict << vfict_laststep << ffict << ABFGrid
+       << CZARestimator;
+  }
+  plumed.getCheckpointService().submit(filename, out.str());
 }
 
 void DynamicReferenceRestraining::load(const string &rfile_prefix) {
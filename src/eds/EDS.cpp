@@ -27,6 +27,7 @@ along with plumed.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include <iostream>
+#include <thread>
 
 
 using namespace PLMD;
@@ -209,6 +210,7 @@ private:
   std::vector<double> coupling_rate_;
   std::vector<double> coupling_accum_;
   std::vector<double> means_;
+  std::vector<double> deltas_; //reusable buffer for the online statistics
   std::vector<double> differences_;
   std::vector<double> alpha_vector_;
   std::vector<double> alpha_vector_2_;
@@ -236,6 +238,8 @@ private:
   bool b_virial_;
   bool b_update_virial_;
   bool b_weights_;
+  bool b_async_update_; //compute coupling updates on a helper thread
+  bool update_pending_; //a coupling update is running on update_thread_
   int seed_;
   int update_period_;
   int avg_coupling_count_;
@@ -248,6 +252,7 @@ private:
   double max_logweight_; // maximum observed max logweight for period
   double wsum_; // sum of weights thus far
   Random rand_;
+  std::thread update_thread_;
   Value* value_force2_;
   Value* value_pressure_;
 
@@ -311,6 +316,7 @@ void EDS::registerKeywords(Keywords& keys) {
   keys.addFlag("RAMP",false,"Slowly increase bias constant to a fixed value");
   keys.addFlag("COVAR",false,"Utilize the covariance matrix when updating the bias. Default Off, but may be enabled due to other options");
   keys.addFlag("FREEZE",false,"Fix bias at current level (only used for restarting).");
+  keys.addFlag("ASYNC_UPDATE",false,"Compute the coupling constant update on a helper thread, overlapping the matrix work of the update with the start of the next MD step. Useful when biasing many CVs, where the update stride otherwise causes a periodic latency spike. Cannot be combined with CENTER_ARG.");
   keys.addFlag("MEAN",false,"Instead of using final bias level from restart, use average. Can only be used in conjunction with FREEZE");
 
 
@@ -333,6 +339,7 @@ EDS::EDS(const ActionOptions&ao):
   coupling_rate_(ncvs_,1.0),
   coupling_accum_(ncvs_,0.0),
   means_(ncvs_,0.0),
+  deltas_(ncvs_,0.0),
   step_size_(ncvs_,0.0),
   pseudo_virial_(ncvs_),
   out_coupling_(ncvs_,NULL),
@@ -349,6 +356,8 @@ EDS::EDS(const ActionOptions&ao):
   b_lm_(false),
   b_virial_(false),
   b_weights_(false),
+  b_async_update_(false),
+  update_pending_(false),
   seed_(0),
   update_period_(0),
   avg_coupling_count_(1),
@@ -395,6 +404,7 @@ EDS::EDS(const ActionOptions&ao):
   parse("OUT_RESTART",out_restart_name_);
   parseFlag("LM",b_lm_);
   parseFlag("RAMP",b_ramp_);
+  parseFlag("ASYNC_UPDATE",b_async_update_);
   parseFlag("FREEZE",b_freeze_);
   parseFlag("MEAN",b_mean);
   parseFlag("COVAR",b_covar_);
@@ -476,6 +486,13 @@ EDS::EDS(const ActionOptions&ao):
     ssds_.resize(ncvs_);
   }
 
+  if(b_async_update_) {
+    //the helper thread reads the centers while the next step may be
+    //writing them when they come from another action
+    if(b_c_values_) error("ASYNC_UPDATE cannot be combined with CENTER_ARG");
+    log.printf("  EDS will compute coupling updates on a helper thread\n");
+  }
+
   b_virial_ = virial_scaling_;
 
   if(b_virial_) {
@@ -779,7 +796,6 @@ void EDS::apply_bias() {
 
 void EDS::update_statistics()  {
   double s, N, w = 1.0;
-  std::vector<double> deltas(ncvs_);
 
   // update weight max, if necessary
   if(b_weights_) {
@@ -799,16 +815,23 @@ void EDS::update_statistics()  {
 
   // Welford, West, and Hanso online variance method
   // with weights (default =  1.0)
-  for(unsigned int i = 0; i < ncvs_; ++i)  {
-    deltas[i] = difference(i,means_[i],getArgument(i)) * w;
-    means_[i] += deltas[i]/N;
-    if(!b_covar_ && !b_lm_)
-      ssds_[i] += deltas[i]*difference(i,means_[i],getArgument(i));
-  }
-  if(b_covar_ || b_lm_) {
+  if(!b_covar_ && !b_lm_) {
+    // fused pass: each argument is read once and mean and variance are
+    // updated together, with no per-step temporaries
+    for(unsigned int i = 0; i < ncvs_; ++i)  {
+      const double arg = getArgument(i);
+      const double delta = difference(i,means_[i],arg) * w;
+      means_[i] += delta/N;
+      ssds_[i] += delta*difference(i,means_[i],arg);
+    }
+  } else {
+    for(unsigned int i = 0; i < ncvs_; ++i)  {
+      deltas_[i] = difference(i,means_[i],getArgument(i)) * w;
+      means_[i] += deltas_[i]/N;
+    }
     for(unsigned int i = 0; i < ncvs_; ++i) {
       for(unsigned int j = i; j < ncvs_; ++j) {
-        s = (N - 1) * deltas[i] * deltas[j] / N / N - covar_(i,j) / N;
+        s = (N - 1) * deltas_[i] * deltas_[j] / N / N - covar_(i,j) / N;
         covar_(i,j) += s;
         //do this so we don't double count
         covar_(j,i) = covar_(i,j);
@@ -927,7 +950,6 @@ void EDS::update_pseudo_virial() {
 
 void EDS::update_bias()
 {
-  log.flush();
   if (b_lm_)
     calc_lm_step_size();
   else if(b_covar_)
@@ -974,6 +996,13 @@ void EDS::update_bias()
 
 
 void EDS::update() {
+  //finish an asynchronous coupling update from the previous step before
+  //touching the statistics or the couplings it writes
+  if(update_pending_) {
+    update_thread_.join();
+    update_pending_ = false;
+  }
+
   //adjust parameters according to EDS recipe
   update_calls_++;
 
@@ -1029,7 +1058,16 @@ void EDS::update() {
 
   //Now we update coupling constant, if necessary
   if(!b_equil_ && update_period_ > 0 && update_calls_ == update_period_ && !b_freeze_) {
-    update_bias();
+    log.flush();
+    if(b_async_update_) {
+      //the update only writes the set points, the rates and the
+      //statistics, none of which is read again before the join at the
+      //top of the next call, so it can overlap with the next MD step
+      update_pending_ = true;
+      update_thread_ = std::thread(&EDS::update_bias,this);
+    } else {
+      update_bias();
+    }
     update_calls_ = 0;
     avg_coupling_count_++;
     b_equil_ = true; //back to equilibration now
@@ -1043,6 +1081,7 @@ void EDS::update() {
 }
 
 EDS::~EDS() {
+  if(update_pending_) update_thread_.join();
   out_restart_.close();
 }
 
@@ -21,6 +21,7 @@ along with plumed.  If not, see <http://www.gnu.org/licenses/>.
 #include "tools/File.h"
 #include "tools/Matrix.h"
 #include "tools/Random.h"
+#include "tools/OpenMP.h"
 #include "legendre_rule_fast.h"
 
 #include <iostream>
@@ -111,6 +112,8 @@ private:
   std::vector<double> gauss_weight_;
   std::vector<double> partition_estimate_;
   std::vector<double> observable_weight_;
+  /*per-step cache of exp(beta*F_j*Q_i), shared by all the quadrature loops*/
+  std::vector<double> exp_q_;
 
   std::string in_restart_name_;
   std::string out_restart_name_;
@@ -150,6 +153,7 @@ private:
   /*write output restart*/
   void writeOutRestart();
   void writeOutObservable();
+  void cache_exponentials();
   void update_statistics();
   void update_bias();
   void apply_bias();
@@ -504,6 +508,10 @@ void FISST::calculate() {
     if(b_write_observable_) writeOutObservable();
   }
 
+  //the exponentials over the force grid depend only on the current CV values,
+  //so they are computed once here and shared by all the integrals below
+  cache_exponentials();
+
   if(! b_freeze_) {
     if(b_restart_ && b_first_restart_sample_) {
       //dont' update statistics if restarting and first sample
@@ -550,6 +558,22 @@ void FISST::apply_bias() {
   //log.flush();
 }
 
+void FISST::cache_exponentials() {
+  //every quadrature over the force grid needs exp(beta*F_j*Q_i) for the
+  //current CV values; filling the table in one tight loop per step keeps
+  //the integration loops below free of transcendentals
+  exp_q_.resize(ncvs_*n_interpolation_);
+  for(unsigned int i = 0; i < ncvs_; ++i) {
+    double bQ_i = beta_*difference(i, center_[i], getArgument(i));
+    unsigned int nt=OpenMP::getNumThreads();
+    if(nt*8>(unsigned int)n_interpolation_) nt=1;
+    #pragma omp parallel for num_threads(nt)
+    for(unsigned int j=0; j<(unsigned int)n_interpolation_; j++) {
+      exp_q_[i*n_interpolation_+j] = exp(bQ_i*forces_[j]);
+    }
+  }
+}
+
 void FISST::update_statistics()  {
 //get stride is for multiple time stepping
   double dt=getTimeStep()*getStride();
@@ -566,21 +590,19 @@ void FISST::update_statistics()  {
   double d_n_samples = (double)n_samples_;
 
   for(unsigned int i = 0; i < ncvs_; ++i) {
-    double Q_i = difference(i, center_[i], getArgument(i));
+    const double* exp_q_i = &exp_q_[i*n_interpolation_];
     for(unsigned int j=0; j<n_interpolation_; j++)
     {
       //if multiple cvs, these need to be updated to have 2 columns
-      double f_j = forces_[j];
       double w_j = force_weight_[j];
       double g_j = gauss_weight_[j];
 
-      fbar_denum_integral += g_j * w_j * exp(beta_*f_j * Q_i);
+      fbar_denum_integral += g_j * w_j * exp_q_i[j];
     }
 
     for(unsigned int j=0; j<n_interpolation_; j++)
     {
-      double f_j = forces_[j];
-      double sample_weight = exp(beta_*f_j * Q_i) / fbar_denum_integral;
+      double sample_weight = exp_q_i[j] / fbar_denum_integral;
 
       partition_estimate_[j] = sample_weight/d_n_samples + partition_estimate_[j]*(d_n_samples-1)/(d_n_samples);
 
@@ -600,17 +622,15 @@ void FISST::update_statistics()  {
 void FISST::update_bias()
 {
   for(unsigned int i = 0; i < ncvs_; ++i) {
-    double Q_i = difference(i, center_[i], getArgument(i));
+    const double* exp_q_i = &exp_q_[i*n_interpolation_];
     double fbar_num_integral = 0.0;
     double fbar_denum_integral = 0.0;
 
     for(unsigned int j=0; j<n_interpolation_; j++ ) {
-      double f_j = forces_[j];
-      double w_j = force_weight_[j];
-      double g_j = gauss_weight_[j];
+      double t_j = gauss_weight_[j] * force_weight_[j] * exp_q_i[j];
 
-      fbar_num_integral += g_j * f_j * w_j * exp(beta_*f_j*Q_i);
-      fbar_denum_integral += g_j * w_j * exp(beta_*f_j*Q_i);
+      fbar_num_integral += forces_[j] * t_j;
+      fbar_denum_integral += t_j;
     }
 
     current_avg_force_[i] = fbar_num_integral/fbar_denum_integral;
@@ -621,21 +641,22 @@ void FISST::compute_observable_weight() {
   double obs_num = (max_force_ - min_force_);
 
   for(unsigned int i = 0; i < ncvs_; ++i) {
-    double Q_i = difference(i, center_[i], getArgument(i));
+    const double* exp_q_i = &exp_q_[i*n_interpolation_];
+
+    //exp(beta*(F_k-F_j)*Q_i) factorizes into exp(beta*F_k*Q_i)/exp(beta*F_j*Q_i),
+    //so the integral over k is the same for every j up to the factor
+    //1/exp(beta*F_j*Q_i): one pass over the grid replaces the quadratic
+    //loop over pairs of force values
+    double denum_integral = 0.0;
+    for( unsigned int k=0; k<(unsigned int)n_interpolation_; k++ ) {
+      denum_integral += gauss_weight_[k] * force_weight_[k] * exp_q_i[k];
+    }
 
+    unsigned int nt=OpenMP::getNumThreads();
+    if(nt*8>(unsigned int)n_interpolation_) nt=1;
+    #pragma omp parallel for num_threads(nt)
     for(unsigned int j=0; j<n_interpolation_; j++ ) {
-      double z_j = partition_estimate_[j];
-      double f_j = forces_[j];
-      double denum_integral = 0.0;
-
-      for( unsigned int k=0; k<n_interpolation_; k++ ) {
-        double f_k = forces_[k];
-        double w_k = force_weight_[k];
-        double g_k = gauss_weight_[k];
-
-        denum_integral += g_k * w_k * exp(beta_*(f_k-f_j)*Q_i);
-      }
-      observable_weight_[j] = obs_num/(denum_integral*z_j);
+      observable_weight_[j] = obs_num*exp_q_i[j]/(denum_integral*partition_estimate_[j]);
     }
   }
 }
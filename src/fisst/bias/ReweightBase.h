@@ -0,0 +1 @@
+#include "../../bias/ReweightBase.h"
@@ -0,0 +1 @@
+#include "../../core/Action.h"
@@ -0,0 +1 @@
+#include "../../core/ActionAnyorder.h"
@@ -0,0 +1 @@
+#include "../../core/ActionAtomistic.h"
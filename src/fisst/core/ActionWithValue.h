@@ -0,0 +1 @@
+#include "../../core/ActionWithValue.h"
@@ -0,0 +1 @@
+#include "../../core/CheckpointService.h"
@@ -0,0 +1 @@
+#include "../../core/ExchangePatterns.h"
@@ -0,0 +1 @@
+#include "../../core/FlexibleBin.h"
@@ -0,0 +1 @@
+#include "../../core/MDAtoms.h"
@@ -0,0 +1 @@
+#include "../../tools/BiasRepresentation.h"
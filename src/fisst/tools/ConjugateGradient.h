@@ -0,0 +1 @@
+#include "../../tools/ConjugateGradient.h"
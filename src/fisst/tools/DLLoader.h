@@ -0,0 +1 @@
+#include "../../tools/DLLoader.h"
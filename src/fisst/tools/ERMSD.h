@@ -0,0 +1 @@
+#include "../../tools/ERMSD.h"
@@ -0,0 +1 @@
+#include "../../tools/FileBase.h"
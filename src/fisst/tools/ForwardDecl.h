@@ -0,0 +1 @@
+#include "../../tools/ForwardDecl.h"
@@ -0,0 +1 @@
+#include "../../tools/HistogramBead.h"
@@ -0,0 +1 @@
+#include "../../tools/InternalCoordinates.h"
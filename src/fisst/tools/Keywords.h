@@ -0,0 +1 @@
+#include "../../tools/Keywords.h"
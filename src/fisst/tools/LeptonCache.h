@@ -0,0 +1 @@
+#include "../../tools/LeptonCache.h"
@@ -0,0 +1 @@
+#include "../../tools/Log.h"
@@ -0,0 +1 @@
+#include "../../tools/LoopUnroller.h"
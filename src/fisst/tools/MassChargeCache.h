@@ -0,0 +1 @@
+#include "../../tools/MassChargeCache.h"
@@ -0,0 +1 @@
+#include "../../tools/Numa.h"
@@ -0,0 +1 @@
+#include "../../tools/OFile.h"
@@ -0,0 +1 @@
+#include "../../tools/PDB.h"
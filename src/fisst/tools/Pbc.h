@@ -0,0 +1 @@
+#include "../../tools/Pbc.h"
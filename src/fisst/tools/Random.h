@@ -0,0 +1 @@
+#include "../../tools/Random.h"
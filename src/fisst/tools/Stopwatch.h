@@ -0,0 +1 @@
+#include "../../tools/Stopwatch.h"
@@ -0,0 +1 @@
+#include "../../tools/TargetClones.h"
@@ -0,0 +1 @@
+#include "../../tools/Tools.h"
@@ -21,6 +21,7 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "ActionRegister.h"
 #include "Function.h"
+#include "tools/LeptonCache.h"
 
 #include "lepton/Lepton.h"
 
@@ -173,6 +174,11 @@ class Custom :
   vector<char*> names;
   vector<double*> lepton_ref;
   vector<double*> lepton_ref_deriv;
+/// after optimisation many derivative expressions reduce to constants
+/// (e.g. for linear combinations); those are evaluated once at setup and
+/// their value is reused at every step instead of re-running the interpreter
+  vector<bool> deriv_is_const;
+  vector<double> deriv_const;
 public:
   explicit Custom(const ActionOptions&);
   void calculate() override;
@@ -247,7 +253,7 @@ Custom::Custom(const ActionOptions&ao):
   for(unsigned i=0; i<var.size(); i++) log.printf(" %s",var[i].c_str());
   log.printf("\n");
 
-  lepton::ParsedExpression pe=lepton::Parser::parse(func).optimize(lepton::Constants());
+  const lepton::ParsedExpression & pe=LeptonCache::parse(func);
   log<<"  function as parsed by lepton: "<<pe<<"\n";
   expression=pe.createCompiledExpression();
   for(auto &p: expression.getVariables()) {
@@ -256,10 +262,16 @@ Custom::Custom(const ActionOptions&ao):
     }
   }
   log<<"  derivatives as computed by lepton:\n";
+  deriv_is_const.assign(getNumberOfArguments(),false);
+  deriv_const.assign(getNumberOfArguments(),0.0);
   for(unsigned i=0; i<getNumberOfArguments(); i++) {
-    lepton::ParsedExpression pe=lepton::Parser::parse(func).differentiate(var[i]).optimize(lepton::Constants());
+    const lepton::ParsedExpression & pe=LeptonCache::differentiate(func,var[i]);
     log<<"    "<<pe<<"\n";
     expression_deriv[i]=pe.createCompiledExpression();
+    if(expression_deriv[i].getVariables().empty()) {
+      deriv_is_const[i]=true;
+      deriv_const[i]=expression_deriv[i].evaluate();
+    }
   }
 
   for(unsigned i=0; i<getNumberOfArguments(); i++) {
@@ -283,13 +295,16 @@ Custom::Custom(const ActionOptions&ao):
 }
 
 void Custom::calculate() {
-  for(unsigned i=0; i<getNumberOfArguments(); i++) {
-    if(lepton_ref[i]) *lepton_ref[i]=getArgument(i);
+  const unsigned nargs=getNumberOfArguments();
+  for(unsigned i=0; i<nargs; i++) values[i]=getArgument(i);
+  for(unsigned i=0; i<nargs; i++) {
+    if(lepton_ref[i]) *lepton_ref[i]=values[i];
   }
   setValue(expression.evaluate());
-  for(unsigned i=0; i<getNumberOfArguments(); i++) {
-    for(unsigned j=0; j<getNumberOfArguments(); j++) {
-      if(lepton_ref_deriv[i*getNumberOfArguments()+j]) *lepton_ref_deriv[i*getNumberOfArguments()+j]=getArgument(j);
+  for(unsigned i=0; i<nargs; i++) {
+    if(deriv_is_const[i]) { setDerivative(i,deriv_const[i]); continue; }
+    for(unsigned j=0; j<nargs; j++) {
+      if(lepton_ref_deriv[i*nargs+j]) *lepton_ref_deriv[i*nargs+j]=values[j];
     }
     setDerivative(i,expression_deriv[i].evaluate());
   }
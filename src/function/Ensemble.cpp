@@ -63,6 +63,18 @@ class Ensemble :
   double   kbt;
   double   moment;
   double   power;
+/// With ASYNC the replica sums are staged hierarchically (a blocking sum
+/// over the replicas running on the same node, then a non-blocking sum
+/// across the nodes) and the completed result is consumed one step later
+  bool     do_async;
+  bool     async_primed;
+  bool     node_leader;
+  Communicator node_comm;
+  Communicator internode_comm;
+  std::vector<double> async_buf;
+  std::vector<double> async_result;
+  Communicator::Request async_req;
+  void     calculateAsync();
 public:
   explicit Ensemble(const ActionOptions&);
   void     calculate() override;
@@ -80,6 +92,7 @@ void Ensemble::registerKeywords(Keywords& keys) {
   keys.add("optional","TEMP","the system temperature - this is only needed if you are reweighting");
   keys.add("optional","MOMENT","the moment you want to calculate in alternative to the mean or the variance");
   keys.add("optional","POWER","the power of the mean (and moment)");
+  keys.addFlag("ASYNC",false,"overlap the sums over the replicas with the calculation: the sum over the replicas running on the same node is done immediately through shared memory, while the sum across the nodes is non-blocking and its result is consumed at the next step. The output therefore lags the arguments by one step (and central moments use the mean of the previous step); this is usually harmless for ensemble-averaged restraints and removes the global synchronization from the critical path. It cannot be combined with REWEIGHT");
   ActionWithValue::useCustomisableComponents(keys);
 }
 
@@ -92,7 +105,10 @@ Ensemble::Ensemble(const ActionOptions&ao):
   do_powers(false),
   kbt(-1.0),
   moment(0),
-  power(0)
+  power(0),
+  do_async(false),
+  async_primed(false),
+  node_leader(false)
 {
   parseFlag("REWEIGHT", do_reweight);
   double temp=0.0;
@@ -113,6 +129,9 @@ Ensemble::Ensemble(const ActionOptions&ao):
   if(power==1) error("POWER can be any number but for 0 and 1");
   if(power!=0) do_powers=true;
 
+  parseFlag("ASYNC",do_async);
+  if(do_async&&do_reweight) error("ASYNC cannot be used together with REWEIGHT: the weights depend on the biases of the current step");
+
   checkRead();
 
   master = (comm.Get_rank()==0);
@@ -125,6 +144,17 @@ Ensemble::Ensemble(const ActionOptions&ao):
   comm.Bcast(ens_dim,0);
   comm.Bcast(my_repl,0);
   if(ens_dim<2) log.printf("WARNING: ENSEMBLE with one replica is not doing any averaging!\n");
+  if(do_async&&ens_dim<2) do_async=false;
+  if(do_async) {
+    if(master) {
+// the sum over the replicas is staged: first over the replicas that share
+// a node, then - non-blocking - over one leader per node
+      multi_sim_comm.SplitByNode(my_repl,node_comm);
+      node_leader=(node_comm.Get_rank()==0);
+      multi_sim_comm.Split(node_leader?0:1,my_repl,internode_comm);
+    }
+    log.printf("  replica sums are staged hierarchically and consumed one step later\n");
+  }
 
   // prepare output components, the number depending on reweighing or not
   narg = getNumberOfArguments();
@@ -145,6 +175,12 @@ Ensemble::Ensemble(const ActionOptions&ao):
     }
   }
 
+  if(do_async) {
+    const unsigned bsize = do_moments ? 2*narg : narg;
+    async_buf.assign(bsize,0.0);
+    async_result.assign(bsize,0.0);
+  }
+
   log.printf("  averaging over %u replicas.\n", ens_dim);
   if(do_reweight) log.printf("  doing simple REWEIGHT using the latest ARGUMENT as energy.\n");
   if(do_moments&&!do_central)  log.printf("  calculating also the %lf standard moment\n", moment);
@@ -152,7 +188,90 @@ Ensemble::Ensemble(const ActionOptions&ao):
   if(do_powers)                log.printf("  calculating the %lf power of the mean (and moment)\n", power);
 }
 
+void Ensemble::calculateAsync() {
+  const double fact=1.0/static_cast<double>(ens_dim);
+  const unsigned bsize = do_moments ? 2*narg : narg;
+
+  vector<double> sums(bsize,0.0);
+  if(master) {
+    // complete the reduction posted at the previous step and share its
+    // result with the other replica leaders on this node
+    if(async_primed) {
+      if(node_leader) { async_req.wait(); async_result=async_buf; }
+      node_comm.Bcast(&async_result[0],bsize,0);
+    }
+    // stage the sums of the current step: a blocking sum over the replicas
+    // sharing this node, then a non-blocking sum across the nodes that is
+    // consumed at the next step
+    vector<double> curbuf(bsize);
+    for(unsigned i=0; i<narg; ++i) curbuf[i]=fact*getArgument(i);
+    if(do_moments) {
+      for(unsigned i=0; i<narg; ++i) {
+        // central moments use the global mean of the previous step; before
+        // the pipeline is primed the replica value stands in for it, which
+        // zeroes the contribution of the very first step
+        const double base = do_central ? ( async_primed ? async_result[i] : getArgument(i) ) : 0.0;
+        curbuf[narg+i]=fact*pow(getArgument(i)-base,moment);
+      }
+    }
+    node_comm.Sum(&curbuf[0],bsize);
+    if(node_leader) {
+      async_buf=curbuf;
+      async_req=internode_comm.Isum(&async_buf[0],bsize);
+    }
+    if(!async_primed) {
+      // at the very first step the reduction is consumed immediately, so
+      // that the output starts from an exact average
+      if(node_leader) { async_req.wait(); async_result=async_buf; }
+      node_comm.Bcast(&async_result[0],bsize,0);
+      async_primed=true;
+    }
+    sums=async_result;
+  }
+  comm.Sum(&sums[0],bsize);
+
+  vector<double> mean(sums.begin(),sums.begin()+narg);
+  vector<double> dmean(narg,fact);
+  vector<double> v_moment, dv_moment;
+  if(do_moments) {
+    v_moment.assign(sums.begin()+narg,sums.end());
+    dv_moment.resize(narg);
+    for(unsigned i=0; i<narg; ++i) {
+      // the derivatives use the latest available mean, consistently on all
+      // the ranks of this replica
+      if(!do_central) dv_moment[i]=moment*fact*pow(getArgument(i),moment-1);
+      else dv_moment[i]=moment*pow(getArgument(i)-mean[i],moment-1)*(fact-fact/static_cast<double>(ens_dim));
+    }
+  }
+
+  if(do_powers) {
+    for(unsigned i=0; i<narg; ++i) {
+      const double tmp1 = pow(mean[i],power-1);
+      mean[i]          *= tmp1;
+      dmean[i]         *= power*tmp1;
+      if(do_moments) {
+        const double tmp2 = pow(v_moment[i],power-1);
+        v_moment[i]      *= tmp2;
+        dv_moment[i]     *= power*tmp2;
+      }
+    }
+  }
+
+  for(unsigned i=0; i<narg; ++i) {
+    Value* v=getPntrToComponent(i);
+    v->set(mean[i]);
+    setDerivative(v, i, dmean[i]);
+    if(do_moments) {
+      Value* u=getPntrToComponent(i+narg);
+      u->set(v_moment[i]);
+      setDerivative(u, i, dv_moment[i]);
+    }
+  }
+}
+
 void Ensemble::calculate() {
+  if(do_async) { calculateAsync(); return; }
+
   double norm = 0.0;
   double fact = 0.0;
 
@@ -176,6 +176,16 @@ class FuncPathMSD : public Function {
   double lambda;
   int neigh_size;
   double neigh_stride;
+/// incremental softmin: exact exponentials are computed only within a window
+/// of frames around the dominant frame of the previous step; the remaining
+/// frames are screened using their cached distance plus an accumulated bound
+/// on how much it may have drifted since it was last evaluated exactly
+  int softmin_window;
+  double softmin_thresh;
+  bool softmin_primed;
+  unsigned softmin_imin;
+  vector<double> softmin_dprev;
+  vector<double> softmin_slack;
   vector< pair<Value *,double> > neighpair;
   map<Value *,double > indexmap; // use double to allow isomaps
   vector <Value*> allArguments;
@@ -230,6 +240,8 @@ void FuncPathMSD::registerKeywords(Keywords& keys) {
   keys.add("compulsory","LAMBDA","the lambda parameter is needed for smoothing, is in the units of plumed");
   keys.add("optional","NEIGH_SIZE","size of the neighbor list");
   keys.add("optional","NEIGH_STRIDE","how often the neighbor list needs to be calculated in time units");
+  keys.add("optional","SOFTMIN_WINDOW","evaluate exact exponentials only for frames within this distance (in frame indexes) from the dominant frame of the previous step; the remaining frames are screened with a conservative bound on their contribution. Cannot be used together with NEIGH_SIZE");
+  keys.add("optional","SOFTMIN_THRESH","(default=32.0) frames whose bounded weight relative to the dominant one is smaller than exp(-SOFTMIN_THRESH) are skipped");
   componentsAreNotOptional(keys);
   keys.addOutputComponent("s","default","the position on the path");
   keys.addOutputComponent("z","default","the distance from the path");
@@ -238,12 +250,20 @@ FuncPathMSD::FuncPathMSD(const ActionOptions&ao):
   Action(ao),
   Function(ao),
   neigh_size(-1),
-  neigh_stride(-1.)
+  neigh_stride(-1.),
+  softmin_window(-1),
+  softmin_thresh(32.0),
+  softmin_primed(false),
+  softmin_imin(0)
 {
 
   parse("LAMBDA",lambda);
   parse("NEIGH_SIZE",neigh_size);
   parse("NEIGH_STRIDE",neigh_stride);
+  parse("SOFTMIN_WINDOW",softmin_window);
+  parse("SOFTMIN_THRESH",softmin_thresh);
+  if(softmin_window>0 && neigh_size>0) error("SOFTMIN_WINDOW cannot be used together with NEIGH_SIZE");
+  if(softmin_thresh<=0.) error("SOFTMIN_THRESH should be larger than zero");
   checkRead();
   log.printf("  lambda is %f\n",lambda);
   // list the action involved and check the type
@@ -266,6 +286,11 @@ FuncPathMSD::FuncPathMSD(const ActionOptions&ao):
   } else {
     log.printf("  Neighbor list NOT enabled \n");
   }
+  if(softmin_window>0) {
+    log.printf("  Incremental softmin enabled: \n");
+    log.printf("                window    :  %d frames around the dominant one\n",softmin_window);
+    log.printf("                threshold :  %f \n",softmin_thresh);
+  }
 
   addComponentWithDerivatives("s"); componentIsNotPeriodic("s");
   addComponentWithDerivatives("z"); componentIsNotPeriodic("z");
@@ -291,10 +316,56 @@ void FuncPathMSD::calculate() {
   Value* val_s_path=getPntrToComponent("s");
   Value* val_z_path=getPntrToComponent("z");
 
-  for(auto & it : neighpair) {
-    it.second=exp(-lambda*(it.first->get()));
-    s_path+=(indexmap[it.first])*it.second;
-    partition+=it.second;
+  const unsigned nf=neighpair.size();
+  if(softmin_window>0 && softmin_primed && nf==softmin_dprev.size()) {
+    // exact pass within the window around the previous dominant frame,
+    // keeping track of the largest distance change observed there
+    int lo=int(softmin_imin)-softmin_window; if(lo<0) lo=0;
+    int hi=int(softmin_imin)+softmin_window; if(hi>int(nf)-1) hi=int(nf)-1;
+    double maxdelta=0.; double dmin=0.; unsigned imin=lo;
+    for(int i=lo; i<=hi; i++) {
+      const double d=neighpair[i].first->get();
+      const double delta=fabs(d-softmin_dprev[i]);
+      if(delta>maxdelta) maxdelta=delta;
+      softmin_dprev[i]=d; softmin_slack[i]=0.;
+      if(i==lo || d<dmin) { dmin=d; imin=i; }
+    }
+    for(unsigned i=0; i<nf; i++) {
+      if(int(i)>=lo && int(i)<=hi) {
+        neighpair[i].second=exp(-lambda*softmin_dprev[i]);
+        continue;
+      }
+      // the cached distance can have drifted by at most the accumulated slack
+      softmin_slack[i]+=maxdelta;
+      if(lambda*(softmin_dprev[i]-softmin_slack[i]-dmin)>softmin_thresh) {
+        neighpair[i].second=0.;
+      } else {
+        const double d=neighpair[i].first->get();
+        softmin_dprev[i]=d; softmin_slack[i]=0.;
+        neighpair[i].second=exp(-lambda*d);
+        if(d<dmin) { dmin=d; imin=i; }
+      }
+    }
+    softmin_imin=imin;
+    for(const auto & it : neighpair) {
+      s_path+=(indexmap[it.first])*it.second;
+      partition+=it.second;
+    }
+  } else {
+    if(softmin_window>0) { softmin_dprev.assign(nf,0.); softmin_slack.assign(nf,0.); }
+    unsigned imin=0; unsigned n=0;
+    for(auto & it : neighpair) {
+      const double d=it.first->get();
+      it.second=exp(-lambda*d);
+      if(softmin_window>0) {
+        softmin_dprev[n]=d;
+        if(d<softmin_dprev[imin]) imin=n;
+      }
+      s_path+=(indexmap[it.first])*it.second;
+      partition+=it.second;
+      n++;
+    }
+    if(softmin_window>0) { softmin_imin=imin; softmin_primed=true; }
   }
   s_path/=partition;
   val_s_path->set(s_path);
@@ -186,6 +186,7 @@ class FuncSumHills :
   bool negativebias;
   bool nohistory;
   bool minTOzero;
+  bool dofft;
   bool doInt;
   double lowI_;
   double uppI_;
@@ -224,6 +225,7 @@ void FuncSumHills::registerKeywords(Keywords& keys) {
   keys.addFlag("NEGBIAS",false,"dump  negative bias ( -bias )   instead of the free energy: needed in well tempered with flexible hills ");
   keys.addFlag("NOHISTORY",false,"to be used with INITSTRIDE:  it splits the bias/histogram in pieces without previous history  ");
   keys.addFlag("MINTOZERO",false,"translate the resulting bias/histogram to have the minimum to zero  ");
+  keys.addFlag("FFT",false,"sum the kernels in fourier space: the centers are histogrammed on the grid and convolved with the gaussian kernel using FFTW. Requires kernels of uniform width");
   keys.add("optional","FMT","the format that should be used to output real numbers");
 }
 
@@ -238,6 +240,7 @@ FuncSumHills::FuncSumHills(const ActionOptions&ao):
   negativebias(false),
   nohistory(false),
   minTOzero(false),
+  dofft(false),
   doInt(false),
   lowI_(-1.),
   uppI_(-1.),
@@ -430,6 +433,8 @@ FuncSumHills::FuncSumHills(const ActionOptions&ao):
   }
   parseFlag("MINTOZERO",minTOzero);
   if(minTOzero)log<<"  mintozero: bias/histogram will be translated to have the minimum value equal to zero\n";
+  parseFlag("FFT",dofft);
+  if(dofft)log<<"  fft: kernels will be summed in fourier space (uniform width kernels required)\n";
   //what might it be this?
   // here start
   // want something right now?? do it and return
@@ -459,6 +464,7 @@ FuncSumHills::FuncSumHills(const ActionOptions&ao):
     if(integratehills) {
       checkFilesAreExisting(hillsFiles);
       biasrep.reset(new BiasRepresentation(tmphillsvalues,comm, gmin, gmax, gbin, doInt, lowI_, uppI_));
+      if(dofft) biasrep->setFFTSum(true);
       if(negativebias) {
         biasrep->setRescaledToBias(true);
         log<<"  required the -bias instead of the free energy \n";
@@ -482,6 +488,7 @@ FuncSumHills::FuncSumHills(const ActionOptions&ao):
     if(integratehisto) {
       checkFilesAreExisting(histoFiles);
       historep.reset(new BiasRepresentation(tmphistovalues,comm,gmin,gmax,gbin,histoSigma));
+      if(dofft) historep->setFFTSum(true);
     }
 
     // decide how to source hills ( serial/parallel )
@@ -511,12 +518,16 @@ FuncSumHills::FuncSumHills(const ActionOptions&ao):
         if(nohistory) {biasrep->clear(); log<<"  clearing history before reading a new block\n";};
         log<<"  reading hills: \n";
         ibias=hillsHandler->readBunch(biasrep.get(),initstride) ; log<<"\n";
+        if(dofft) biasrep->completeFFTSum();
+        biasrep->syncGrid();
       }
 
       if(  integratehisto  && ihisto ) {
         if(nohistory) {historep->clear(); log<<"  clearing history before reading a new block\n";};
         log<<"  reading histogram: \n";
         ihisto=histoHandler->readBunch(historep.get(),initstride) ;  log<<"\n";
+        if(dofft) historep->completeFFTSum();
+        historep->syncGrid();
       }
 
       // dump: need to project?
@@ -79,19 +79,24 @@ void Function::apply()
   }
 
   unsigned at_least_one_forced=0;
-  #pragma omp parallel num_threads(OpenMP::getNumThreads()) shared(f)
-  {
-    vector<double> omp_f(noa,0.0);
-    vector<double> forces(noa);
-    #pragma omp for reduction( + : at_least_one_forced)
-    for(unsigned i=rank; i<ncp; i+=stride) {
-      if(getPntrToComponent(i)->applyForce(forces)) {
-        at_least_one_forced+=1;
-        for(unsigned j=0; j<noa; j++) omp_f[j]+=forces[j];
+  if(ncp>3 && OpenMP::getNumThreads()>1) {
+    #pragma omp parallel num_threads(OpenMP::getNumThreads()) shared(f)
+    {
+      vector<double> omp_f(noa,0.0);
+      #pragma omp for reduction( + : at_least_one_forced)
+      for(unsigned i=rank; i<ncp; i+=stride) {
+        if(getPntrToComponent(i)->accumulateForce(omp_f)) at_least_one_forced+=1;
       }
+      #pragma omp critical
+      for(unsigned j=0; j<noa; j++) f[j]+=omp_f[j];
+    }
+  } else {
+// common case of a function with few components (e.g. a function of
+// functions): fuse the chain rule with the accumulation, with no
+// temporary buffer and no parallel region overhead
+    for(unsigned i=rank; i<ncp; i+=stride) {
+      if(getPntrToComponent(i)->accumulateForce(f)) at_least_one_forced+=1;
     }
-    #pragma omp critical
-    for(unsigned j=0; j<noa; j++) f[j]+=omp_f[j];
   }
 
   if(noa>0&&ncp>4*cgs) { comm.Sum(&f[0],noa); comm.Sum(at_least_one_forced); }
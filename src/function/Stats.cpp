@@ -62,6 +62,12 @@ class Stats :
   bool sqdonly;
   bool components;
   bool upperd;
+/// the arguments are packed in a contiguous buffer once per step, so that
+/// the statistics and derivative kernels run over plain arrays and can be
+/// vectorized; the derivative buffers are kept as members to avoid
+/// reallocating them at every step
+  std::vector<double> packed_args;
+  std::vector<double> sq_der, co_der, sl_der, int_der;
 public:
   explicit Stats(const ActionOptions&);
   void calculate() override;
@@ -155,31 +161,45 @@ Stats::Stats(const ActionOptions&ao):
 
 void Stats::calculate()
 {
+  const unsigned n=parameters.size();
+  packed_args.resize(n);
+  for(unsigned i=0; i<n; ++i) packed_args[i]=getArgument(i);
+  const double* x=&packed_args[0];
+  const double* y=&parameters[0];
+
   if(sqdonly) {
 
-    double nsqd = 0.;
-    Value* val;
-    if(!components) val=getPntrToComponent("sqdevsum");
-    for(unsigned i=0; i<parameters.size(); ++i) {
-      double dev = getArgument(i)-parameters[i];
-      if(upperd&&dev<0) dev=0.;
-      if(components) {
-        val=getPntrToComponent(i);
+    if(components) {
+      for(unsigned i=0; i<n; ++i) {
+        double dev = x[i]-y[i];
+        if(upperd&&dev<0) dev=0.;
+        Value* val=getPntrToComponent(i);
         val->set(dev*dev);
-      } else {
+        setDerivative(val,i,2.*dev);
+      }
+    } else {
+      double nsqd = 0.;
+      sq_der.resize(n);
+      #pragma omp simd reduction(+:nsqd)
+      for(unsigned i=0; i<n; ++i) {
+        double dev = x[i]-y[i];
+        if(upperd&&dev<0) dev=0.;
         nsqd += dev*dev;
+        sq_der[i] = 2.*dev;
       }
-      setDerivative(val,i,2.*dev);
+      Value* val=getPntrToComponent("sqdevsum");
+      val->set(nsqd);
+      for(unsigned i=0; i<n; ++i) setDerivative(val,i,sq_der[i]);
     }
-    if(!components) val->set(nsqd);
 
   } else {
 
     double scx=0., scx2=0., scy=0., scy2=0., scxy=0.;
 
-    for(unsigned i=0; i<parameters.size(); ++i) {
-      const double tmpx=getArgument(i);
-      const double tmpy=parameters[i];
+    #pragma omp simd reduction(+:scx,scx2,scy,scy2,scxy)
+    for(unsigned i=0; i<n; ++i) {
+      const double tmpx=x[i];
+      const double tmpy=y[i];
       scx  += tmpx;
       scx2 += tmpx*tmpx;
       scy  += tmpy;
@@ -187,7 +207,7 @@ void Stats::calculate()
       scxy += tmpx*tmpy;
     }
 
-    const double ns = parameters.size();
+    const double ns = n;
 
     const double num = ns*scxy - scx*scy;
     const double idev2x = 1./(ns*scx2-scx*scx);
@@ -212,25 +232,29 @@ void Stats::calculate()
     valuec->set(slope);
     valued->set(inter);
 
-    /* derivatives */
-    for(unsigned i=0; i<parameters.size(); ++i) {
-      const double common_d1 = (ns*parameters[i]-scy)*idevx;
-      const double common_d2 = num*(ns*getArgument(i)-scx)*idev2x*idevx;
+    /* derivatives, all four components in one vectorized pass */
+    sq_der.resize(n); co_der.resize(n); sl_der.resize(n); int_der.resize(n);
+    #pragma omp simd
+    for(unsigned i=0; i<n; ++i) {
+      const double common_d1 = (ns*y[i]-scy)*idevx;
+      const double common_d2 = num*(ns*x[i]-scx)*idev2x*idevx;
       const double common_d3 = common_d1 - common_d2;
 
       /* sqdevsum */
-      const double sq_der = 2.*(getArgument(i)-parameters[i]);
+      sq_der[i] = 2.*(x[i]-y[i]);
       /* correlation */
-      const double co_der = common_d3*idevy;
+      co_der[i] = common_d3*idevy;
       /* slope */
-      const double sl_der = (common_d1-2.*common_d2)*idevx;
+      sl_der[i] = (common_d1-2.*common_d2)*idevx;
       /* intercept */
-      const double int_der = -(slope+ scx*sl_der)/ns;
+      int_der[i] = -(slope+ scx*sl_der[i])/ns;
+    }
 
-      setDerivative(valuea,i,sq_der);
-      setDerivative(valueb,i,co_der);
-      setDerivative(valuec,i,sl_der);
-      setDerivative(valued,i,int_der);
+    for(unsigned i=0; i<n; ++i) {
+      setDerivative(valuea,i,sq_der[i]);
+      setDerivative(valueb,i,co_der[i]);
+      setDerivative(valuec,i,sl_der[i]);
+      setDerivative(valued,i,int_der[i]);
     }
 
   }
@@ -18,6 +18,7 @@
 #include "core/Atoms.h"
 #include <iostream>
 #include "tools/RMSD.h"
+#include "tools/OpenMP.h"
 
 using namespace std;
 
@@ -103,6 +104,12 @@ class FUNNEL_PS : public Colvar {
   bool squared;
 private:
   vector<double> points;
+  // geometry of the funnel axis and the center of the reference structure
+  // do not change during the run, so they are computed once at setup
+  Vector p1;
+  Vector s;
+  Vector der_prj;
+  Vector centerreference;
 public:
   explicit FUNNEL_PS(const ActionOptions&);
 // active methods:
@@ -188,6 +195,17 @@ FUNNEL_PS::FUNNEL_PS(const ActionOptions&ao):
   if(pbc) log.printf("  using periodic boundary conditions\n");
   else    log.printf("  without periodic boundary conditions\n");
 
+  // The two points that define the axis and the center of the reference
+  // structure are fixed, so the related quantities are tabulated here once
+  p1 = VectorGeneric<3>(points[0],points[1],points[2]);
+  Vector p2 = VectorGeneric<3>(points[3],points[4],points[5]);
+  s = p2 - p1;
+  der_prj = s/s.modulo();
+  centerreference.zero();
+  for(unsigned i=0; i<pdb->size(); i++) {
+    centerreference+=pdb->getPositions()[i]*align[i]/align.size();
+  }
+
   addComponentWithDerivatives("lp");
   componentIsNotPeriodic("lp");
   addComponentWithDerivatives("ld");
@@ -216,7 +234,6 @@ void FUNNEL_PS::calculate() {
 
   std::vector<Vector> buffer;
 
-  Vector centerreference;
   Vector centerpositions;
 
   // Created only to give the correct object to calc_FitElements
@@ -228,22 +245,11 @@ void FUNNEL_PS::calculate() {
   sourcePositions=sourceAllPositions;
   sourcePositions.resize(sourcePositions.size()-2);// just the protein
 
-  // The two points that define the axis : this can be moved in the initialization
-  Vector p1 = VectorGeneric<3>(points[0],points[1],points[2]);
-  Vector p2 = VectorGeneric<3>(points[3],points[4],points[5]);
-  Vector s = p2 - p1;
-
   // I call the method calc_FitElements that initializes all feature that I need
-  // except for centerreference that I need to calculate from scratch
+  // except for centerreference that is tabulated at setup
   // Buffer has no meaning but I had to fulfill the requirements of calc_FitElements
   double rmsd = alignment->calc_FitElements( sourcePositions, Rotation, drotdpos, buffer, centerpositions, squared);
 
-  // To Plumed developers: it would be interesting to make the functions to calculate centers of mass public or protected
-  centerreference.zero();
-  for(unsigned i=0; i<pdb->size(); i++) {
-    centerreference+=pdb->getPositions()[i]*align[i]/align.size();
-  }
-
   /*
   // I cancelled the additional lines in the library of RMSD.h, thus I am missing the center of the reference
   // Creating variable kito to extract only the center of the reference, since no method is calling
@@ -279,9 +285,7 @@ void FUNNEL_PS::calculate() {
   const double prj_height = height.modulo() ;
   const double inv_prj_height = 1.0/prj_height;
 
-  // derivative of the prj: only on the com of the ligand
-  Vector der_prj;
-  der_prj=s/s.modulo();
+  // derivative of the prj (der_prj, tabulated at setup): only on the com of the ligand
 
   // derivative of the height: only on the com of the ligand
   Vector der_height(inv_prj_height*(height[0]-(s[0]/s.modulo2())*dotProduct(height,s)),
@@ -299,25 +303,31 @@ void FUNNEL_PS::calculate() {
   setAtomsDerivatives(valuelp,getNumberOfAtoms()-1,matmul(transpose(Rotation),der_prj));
   setAtomsDerivatives(valueld,getNumberOfAtoms()-1,matmul(transpose(Rotation),der_height));
 
-  Vector der_h;
-  Vector der_l;
   double weight=1./float(getNumberOfAtoms()-2.);
 
-  for(unsigned iat=0; iat<getNumberOfAtoms()-2; iat++) {
-    der_h.zero();
-    der_l.zero();
-    for(unsigned a=0; a<3; a++) {
-      for(unsigned b=0; b<3; b++) {
-        for(unsigned g=0; g<3; g++) {
-          der_h[a]+=der_height[b]*drotdpos[b][g][iat][a]*ligand_centered[g];
-          der_l[a]+=der_prj[b]*drotdpos[b][g][iat][a]*ligand_centered[g];
-        }
-        der_h[a]-=der_height[b]*Rotation[b][a]*weight;
-        der_l[a]-=der_prj[b]*Rotation[b][a]*weight;
+  // the outer products der*ligand_centered and the rotation corrections do
+  // not depend on the atom index: assembling them once turns the alignment
+  // loop into nine fused multiply-adds per atom and component
+  const Tensor W_h(der_height,ligand_centered);
+  const Tensor W_l(der_prj,ligand_centered);
+  const Vector corr_h=weight*matmul(transpose(Rotation),der_height);
+  const Vector corr_l=weight*matmul(transpose(Rotation),der_prj);
+
+  const unsigned nalign=getNumberOfAtoms()-2;
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt*8>nalign) nt=1;
+  #pragma omp parallel for num_threads(nt)
+  for(unsigned iat=0; iat<nalign; iat++) {
+    Vector der_h;
+    Vector der_l;
+    for(unsigned b=0; b<3; b++) {
+      for(unsigned g=0; g<3; g++) {
+        der_h+=W_h[b][g]*drotdpos[b][g][iat];
+        der_l+=W_l[b][g]*drotdpos[b][g][iat];
       }
     }
-    setAtomsDerivatives(valuelp,iat,der_l);
-    setAtomsDerivatives(valueld,iat,der_h);
+    setAtomsDerivatives(valuelp,iat,der_l-corr_l);
+    setAtomsDerivatives(valueld,iat,der_h-corr_h);
   }
 
   setBoxDerivativesNoPbc(valuelp);
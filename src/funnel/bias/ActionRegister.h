@@ -0,0 +1 @@
+#include "../../bias/ActionRegister.h"
@@ -0,0 +1 @@
+#include "../../colvar/ActionRegister.h"
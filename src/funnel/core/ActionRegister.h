@@ -0,0 +1 @@
+#include "../../core/ActionRegister.h"
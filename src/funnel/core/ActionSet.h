@@ -0,0 +1 @@
+#include "../../core/ActionSet.h"
@@ -0,0 +1 @@
+#include "../../core/ActionWithVirtualAtom.h"
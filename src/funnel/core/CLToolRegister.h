@@ -0,0 +1 @@
+#include "../../core/CLToolRegister.h"
@@ -0,0 +1 @@
+#include "../../core/Colvar.h"
@@ -0,0 +1 @@
+#include "../../core/GREX.h"
@@ -0,0 +1 @@
+#include "../../core/TaskScheduler.h"
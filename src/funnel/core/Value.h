@@ -0,0 +1 @@
+#include "../../core/Value.h"
@@ -0,0 +1 @@
+#include "../../core/WithCmd.h"
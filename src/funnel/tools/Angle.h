@@ -0,0 +1 @@
+#include "../../tools/Angle.h"
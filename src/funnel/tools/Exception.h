@@ -0,0 +1 @@
+#include "../../tools/Exception.h"
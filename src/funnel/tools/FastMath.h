@@ -0,0 +1 @@
+#include "../../tools/FastMath.h"
@@ -0,0 +1 @@
+#include "../../tools/File.h"
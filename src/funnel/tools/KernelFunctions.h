@@ -0,0 +1 @@
+#include "../../tools/KernelFunctions.h"
@@ -0,0 +1 @@
+#include "../../tools/Matrix.h"
@@ -0,0 +1 @@
+#include "../../tools/MatrixSquareBracketsAccess.h"
@@ -0,0 +1 @@
+#include "../../tools/MolDataClass.h"
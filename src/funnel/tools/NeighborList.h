@@ -0,0 +1 @@
+#include "../../tools/NeighborList.h"
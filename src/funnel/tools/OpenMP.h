@@ -0,0 +1 @@
+#include "../../tools/OpenMP.h"
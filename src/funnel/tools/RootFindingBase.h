@@ -0,0 +1 @@
+#include "../../tools/RootFindingBase.h"
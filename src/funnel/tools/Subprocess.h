@@ -0,0 +1 @@
+#include "../../tools/Subprocess.h"
@@ -0,0 +1 @@
+#include "../../tools/SwitchingFunction.h"
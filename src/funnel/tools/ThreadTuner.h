@@ -0,0 +1 @@
+#include "../../tools/ThreadTuner.h"
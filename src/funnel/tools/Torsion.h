@@ -0,0 +1 @@
+#include "../../tools/Torsion.h"
@@ -0,0 +1 @@
+#include "../../tools/Units.h"
@@ -0,0 +1 @@
+#include "../../tools/h36.h"
@@ -29,6 +29,10 @@
 #include "tools/Units.h"
 #include <cstdio>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "core/GenericMolInfo.h"
 #include "core/ActionSet.h"
 
@@ -137,6 +141,24 @@ class DumpAtoms:
   std::string fmt_xyz;
 #if defined(__PLUMED_HAS_XDRFILE)
   XDRFILE* xd;
+/// One snapshotted frame handed over to the compression thread
+  struct XtcFrame {
+    int natoms; int step;
+    float time; float precision;
+    matrix box;
+    std::vector<float> pos;
+  };
+/// With ASYNC_WRITE the xtc/trr frames are compressed and written by a
+/// background thread; update() only takes a snapshot of the coordinates.
+/// The queue is bounded to two frames, so at most one frame is being
+/// compressed while the next one is being snapshotted
+  bool async_write;
+  bool writer_done;
+  std::thread writer_thread;
+  std::mutex mtx;
+  std::condition_variable not_full, not_empty;
+  std::deque<XtcFrame> frame_queue;
+  void writerLoop();
 #endif
 public:
   explicit DumpAtoms(const ActionOptions&);
@@ -160,6 +182,7 @@ void DumpAtoms::registerKeywords( Keywords& keys ) {
   keys.add("optional", "PRECISION","The number of digits in trajectory file");
 #if defined(__PLUMED_HAS_XDRFILE)
   keys.add("optional", "TYPE","file type, either xyz, gro, xtc, or trr, can override an automatically detected file extension");
+  keys.addFlag("ASYNC_WRITE",false,"with xtc and trr files, compress and write the frames on a background thread; the main thread only takes a snapshot of the coordinates, so the cost of the compression is overlapped with the calculation. At most two frames are buffered");
 #else
   keys.add("optional", "TYPE","file type, either xyz or gro, can override an automatically detected file extension");
 #endif
@@ -173,6 +196,10 @@ DumpAtoms::DumpAtoms(const ActionOptions&ao):
   ActionAtomistic(ao),
   ActionPilot(ao),
   iprecision(3)
+#if defined(__PLUMED_HAS_XDRFILE)
+  ,async_write(false),
+  writer_done(false)
+#endif
 {
   vector<AtomNumber> atoms;
   string file;
@@ -196,6 +223,10 @@ DumpAtoms::DumpAtoms(const ActionOptions&ao):
   }
 #ifndef __PLUMED_HAS_XDRFILE
   if(type=="xtc" || type=="trr") error("types xtc and trr require PLUMED to be linked with the xdrfile library. Please install it and recompile PLUMED.");
+#else
+  parseFlag("ASYNC_WRITE",async_write);
+  if(async_write && type!="xtc" && type!="trr") error("ASYNC_WRITE can only be used with xtc and trr files");
+  if(async_write) log<<"  frames will be compressed and written on a background thread\n";
 #endif
 
   fmt_gro_pos="%8.3f";
@@ -241,6 +272,7 @@ DumpAtoms::DumpAtoms(const ActionOptions&ao):
     of.close();
     xd=xdrfile_open(path.c_str(),mode.c_str());
   }
+  if(async_write) writer_thread=std::thread(&DumpAtoms::writerLoop,this);
 #endif
   log.printf("  printing the following atoms in %s :", unitname.c_str() );
   for(unsigned i=0; i<atoms.size(); ++i) log.printf(" %d",atoms[i].serial() );
@@ -299,26 +331,64 @@ void DumpAtoms::update() {
               lenunit*t(1,2),lenunit*t(2,0),lenunit*t(2,1));
 #if defined(__PLUMED_HAS_XDRFILE)
   } else if(type=="xtc" || type=="trr") {
-    matrix box;
+    XtcFrame frame;
     const Tensor & t(getPbc().getBox());
-    int natoms=getNumberOfAtoms();
-    int step=getStep();
-    float time=getTime()/plumed.getAtoms().getUnits().getTime();
-    float precision=Tools::fastpow(10.0,iprecision);
-    for(int i=0; i<3; i++) for(int j=0; j<3; j++) box[i][j]=lenunit*t(i,j);
-    std::unique_ptr<rvec[]> pos(new rvec [natoms]);
-    for(int i=0; i<natoms; i++) for(int j=0; j<3; j++) pos[i][j]=lenunit*getPosition(i)(j);
-    if(type=="xtc") {
-      write_xtc(xd,natoms,step,time,box,&pos[0],precision);
+    frame.natoms=getNumberOfAtoms();
+    frame.step=getStep();
+    frame.time=getTime()/plumed.getAtoms().getUnits().getTime();
+    frame.precision=Tools::fastpow(10.0,iprecision);
+    for(int i=0; i<3; i++) for(int j=0; j<3; j++) frame.box[i][j]=lenunit*t(i,j);
+    frame.pos.resize(3*frame.natoms);
+    for(int i=0; i<frame.natoms; i++) for(int j=0; j<3; j++) frame.pos[3*i+j]=lenunit*getPosition(i)(j);
+    if(async_write) {
+      {
+        std::unique_lock<std::mutex> lck(mtx);
+        not_full.wait(lck,[this]() { return frame_queue.size()<2; });
+        frame_queue.push_back(std::move(frame));
+      }
+      not_empty.notify_one();
+    } else if(type=="xtc") {
+      write_xtc(xd,frame.natoms,frame.step,frame.time,frame.box,reinterpret_cast<rvec*>(&frame.pos[0]),frame.precision);
     } else if(type=="trr") {
-      write_trr(xd,natoms,step,time,0.0,box,&pos[0],NULL,NULL);
+      write_trr(xd,frame.natoms,frame.step,frame.time,0.0,frame.box,reinterpret_cast<rvec*>(&frame.pos[0]),NULL,NULL);
     }
 #endif
   } else plumed_merror("unknown file type "+type);
 }
 
+#if defined(__PLUMED_HAS_XDRFILE)
+void DumpAtoms::writerLoop() {
+  while(true) {
+    XtcFrame frame;
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      not_empty.wait(lck,[this]() { return !frame_queue.empty() || writer_done; });
+      if(frame_queue.empty()) return;
+      frame=std::move(frame_queue.front());
+      frame_queue.pop_front();
+    }
+    not_full.notify_one();
+    if(type=="xtc") {
+      write_xtc(xd,frame.natoms,frame.step,frame.time,frame.box,reinterpret_cast<rvec*>(&frame.pos[0]),frame.precision);
+    } else {
+      write_trr(xd,frame.natoms,frame.step,frame.time,0.0,frame.box,reinterpret_cast<rvec*>(&frame.pos[0]),NULL,NULL);
+    }
+  }
+}
+#endif
+
 DumpAtoms::~DumpAtoms() {
 #ifdef __PLUMED_HAS_XDRFILE
+  if(async_write) {
+// drain the queue before closing the file: the worker exits only once
+// writer_done is set and no frame is left to compress
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      writer_done=true;
+    }
+    not_empty.notify_one();
+    writer_thread.join();
+  }
   if(type=="xtc") {
     xdrfile_close(xd);
   } else if(type=="trr") {
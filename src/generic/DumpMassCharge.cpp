@@ -23,6 +23,7 @@
 #include "core/ActionPilot.h"
 #include "core/ActionRegister.h"
 #include "tools/File.h"
+#include "tools/MassChargeCache.h"
 #include "core/PlumedMain.h"
 #include "core/Atoms.h"
 
@@ -85,6 +86,15 @@ then
 plumed driver --mc newmc --plumed plumed.dat --ixyz traj.gro
 \endverbatim
 
+If the name passed to FILE ends in ".mcb" the file is written in a
+compact binary format in which the distinct mass and charge values are
+stored only once.  For systems with millions of atoms this makes the
+file much smaller and its loading by \ref driver almost instantaneous.
+The driver recognizes the binary format automatically, so the same
+--mc flag is used:
+\verbatim
+plumed driver --mc mcfile.mcb --plumed plumed.dat --ixyz traj.xyz
+\endverbatim
 
 */
 //+ENDPLUMEDOC
@@ -182,6 +192,20 @@ void DumpMassCharge::update() {
   if(!first) return;
   first=false;
 
+  if(file.length()>4 && file.substr(file.length()-4)==".mcb") {
+    vector<int> index(getNumberOfAtoms());
+    vector<double> masses,charges;
+    if(print_masses) masses.resize(getNumberOfAtoms());
+    if(print_charges) charges.resize(getNumberOfAtoms());
+    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
+      index[i]=getAbsoluteIndex(i).index();
+      if(print_masses) masses[i]=getMass(i);
+      if(print_charges) charges[i]=getCharge(i);
+    }
+    if(!MassChargeCache::write(file,index,masses,charges)) plumed_merror("cannot write binary mass/charge file " + file);
+    return;
+  }
+
   OFile of;
   of.link(*this);
   of.open(file);
@@ -71,6 +71,16 @@ EFFECTIVE_ENERGY_DRIFT PRINT_STRIDE=100 FILE=eff
 */
 //+ENDPLUMEDOC
 
+namespace {
+/// One step of Kahan compensated summation: adds term to sum, keeping in comp
+/// a running estimate of the rounding error that is fed back into later adds
+inline void addCompensated( double& sum, double& comp, const double& term ) {
+  const double y=term-comp;
+  const double t=sum+y;
+  comp=(t-sum)-y;
+  sum=t;
+}
+}
 
 class EffectiveEnergyDrift:
   public ActionPilot {
@@ -79,6 +89,9 @@ class EffectiveEnergyDrift:
   string fmt;
 
   double eed;
+/// compensation term of the running Kahan sum: over 10^9 steps the drift is
+/// built from tiny increments and a plain sum would itself drift
+  double eedComp;
 
   Atoms& atoms;
   vector<ActionWithValue*> biases;
@@ -142,6 +155,7 @@ EffectiveEnergyDrift::EffectiveEnergyDrift(const ActionOptions&ao):
   ActionPilot(ao),
   fmt("%f"),
   eed(0.0),
+  eedComp(0.0),
   atoms(plumed.getAtoms()),
   nProc(plumed.comm.Get_size()),
   initialBias(0.0),
@@ -280,21 +294,27 @@ void EffectiveEnergyDrift::update() {
     }
   }
 
-  //compute the effective energy drift on local atoms
-
-  double eed_tmp=eed;
-  #pragma omp parallel for reduction(+:eed_tmp)
-  for(int i=0; i<nLocalAtoms; i++) {
-    Vector dst=delta(pPositions[i],positions[i]);
-    if(pbc) for(unsigned k=0; k<3; k++) dst[k]=Tools::pbc(dst[k]);
-    eed_tmp += dotProduct(dst, forces[i]+pForces[i])*0.5;
+  //compute the effective energy drift on local atoms.  Each thread keeps its
+  //own compensated sum and the partial sums are then folded, compensated as
+  //well, into the running total
+  double sum=0.0, comp=0.0;
+  #pragma omp parallel
+  {
+    double lsum=0.0, lcomp=0.0;
+    #pragma omp for nowait
+    for(int i=0; i<nLocalAtoms; i++) {
+      Vector dst=delta(pPositions[i],positions[i]);
+      if(pbc) for(unsigned k=0; k<3; k++) dst[k]=Tools::pbc(dst[k]);
+      addCompensated(lsum,lcomp,dotProduct(dst, forces[i]+pForces[i])*0.5);
+    }
+    #pragma omp critical
+    addCompensated(sum,comp,lsum);
   }
-
-  eed=eed_tmp;
+  addCompensated(eed,eedComp,sum);
 
   if(plumed.comm.Get_rank()==0) {
     for(unsigned i=0; i<3; i++) for(unsigned j=0; j<3; j++)
-        eed-=0.5*(pfbox(i,j)+fbox(i,j))*(box(i,j)-pbox(i,j));
+        addCompensated(eed,eedComp,-0.5*(pfbox(i,j)+fbox(i,j))*(box(i,j)-pbox(i,j)));
   }
 
 
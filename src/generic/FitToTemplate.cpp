@@ -268,6 +268,10 @@ FitToTemplate::FitToTemplate(const ActionOptions&ao):
   if(type=="OPTIMAL" or type=="OPTIMAL-FAST" ) {
     rmsd.reset(new RMSD());
     rmsd->set(weights,weights_measure,positions,type,false,false);// note: the reference is shifted now with center in the origin
+    // successive steps see slowly varying positions, so the quaternion
+    // eigensolver can be warm started from the previous rotation; it falls
+    // back on a full diagonalization whenever the structure changed too much
+    rmsd->setWarmStart(true);
     log<<"  Method chosen for fitting: "<<rmsd->getMethod()<<" \n";
   }
   if(nopbc) {
@@ -288,6 +292,9 @@ FitToTemplate::FitToTemplate(const ActionOptions&ao):
   // this is required so as to allow modifyGlobalForce() to return correct
   // also for forces that are not owned (and thus not zeored) by all processors.
   allowToAccessGlobalForces();
+
+  // this action translates/rotates the global positions in place:
+  declareGlobalStateModifier();
 }
 
 
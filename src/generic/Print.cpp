@@ -104,6 +104,10 @@ void Print::registerKeywords(Keywords& keys) {
   keys.add("compulsory","STRIDE","1","the frequency with which the quantities of interest should be output");
   keys.add("optional","FILE","the name of the file on which to output these quantities");
   keys.add("optional","FMT","the format that should be used to output real numbers");
+  keys.addFlag("BINARY",false,"write the file in a typed binary columnar format instead of formatted text: a magic header "
+               "carrying the field schema is followed by one fixed-width record of doubles per line. Such files are written "
+               "at full precision, are much cheaper to write and to parse, and are read back transparently by anything "
+               "using PLUMED to read the file, e.g. \\ref READ");
   keys.add("hidden","_ROTATE","some funky thing implemented by GBussi");
   keys.use("RESTART");
   keys.use("UPDATE_FROM");
@@ -118,11 +122,15 @@ Print::Print(const ActionOptions&ao):
   rotate(0)
 {
   ofile.link(*this);
+  bool binary=false;
+  parseFlag("BINARY",binary);
   parse("FILE",file);
   if(file.length()>0) {
+    if(binary) ofile.setBinaryFields();
     ofile.open(file);
-    log.printf("  on file %s\n",file.c_str());
+    log.printf("  on file %s%s\n",file.c_str(),binary?" (binary format)":"");
   } else {
+    if(binary) error("BINARY can only be used together with FILE");
     log.printf("  on plumed log file\n");
     ofile.link(log);
   }
@@ -27,6 +27,7 @@
 #include "core/Atoms.h"
 #include "tools/IFile.h"
 #include <memory>
+#include <cstdlib>
 
 namespace PLMD {
 namespace generic {
@@ -155,6 +156,11 @@ Read::Read(const ActionOptions&ao):
     ifile->link(*this);
     ifile->open(filename);
     ifile->allowIgnoredFields();
+// READ only ever walks the file forward, so it can safely prefetch it in
+// the background; this hides the filesystem latency when replaying large
+// colvar files with driver.  Opt-in through the same switch as the
+// asynchronous output of OFile
+    if( std::getenv("PLUMED_ASYNC_IO") ) ifile->enableReadahead();
   }
   parse("EVERY",nlinesPerStep);
   if(nlinesPerStep>1) log.printf("  only reading every %uth line of file %s\n",nlinesPerStep,filename.c_str() );
@@ -221,8 +227,17 @@ void Read::prepare() {
     if( !ifile->scanField("time",du_time) ) {
       error("Reached end of file " + filename + " before end of trajectory");
     } else if( fabs( du_time-getTime() )>plumed.getAtoms().getTimeStep() && !ignore_time ) {
-      std::string str_dutime,str_ptime; Tools::convert(du_time,str_dutime); Tools::convert(getTime(),str_ptime);
-      error("mismatched times in colvar files : colvar time=" + str_dutime + " plumed time=" + str_ptime + ". Add IGNORE_TIME to ignore error.");
+// if the file starts before the trajectory, e.g. when replaying a
+// subsampled trajectory against the full colvar file, fast-forward to
+// the record matching the current time instead of giving up
+      while( du_time+plumed.getAtoms().getTimeStep()<getTime() ) {
+        ifile->scanField();
+        if( !ifile->scanField("time",du_time) ) error("Reached end of file " + filename + " before end of trajectory");
+      }
+      if( fabs( du_time-getTime() )>plumed.getAtoms().getTimeStep() ) {
+        std::string str_dutime,str_ptime; Tools::convert(du_time,str_dutime); Tools::convert(getTime(),str_ptime);
+        error("mismatched times in colvar files : colvar time=" + str_dutime + " plumed time=" + str_ptime + ". Add IGNORE_TIME to ignore error.");
+      }
     }
   }
 }
@@ -129,6 +129,9 @@ ResetCell::ResetCell(const ActionOptions&ao):
   if(type!="TRIANGULAR") error("undefined type "+type);
 
   checkRead();
+
+// this action rotates the global positions and the box in place:
+  declareGlobalStateModifier();
 }
 
 
@@ -22,6 +22,7 @@
 #include "core/ActionPilot.h"
 #include "core/ActionWithArguments.h"
 #include "core/ActionRegister.h"
+#include "core/ActionSet.h"
 #include "core/PlumedMain.h"
 
 using namespace std;
@@ -53,6 +54,14 @@ Of course, blocks can be nested at will.
 There are many potential usages for this keyword. One might e.g. decide to analyze some variable
 only when another variable is within a given range.
 
+By default the actions in an inactive block still take part in the dependency
+resolution and their atoms are still shared with the MD code, only their update
+is skipped. With the DORMANT flag the actions in the block are instead not
+activated at all while the block is off, so an expensive analysis gated behind
+UPDATE_IF costs nothing when it is inactive. Since the atomic positions are
+shared before the condition can be evaluated, with DORMANT the block is
+switched on and off using the condition computed at the previous step.
+
 \warning
 Notice that not all the possible usage make
 particular sense. For example, conditionally updating a \ref METAD keyword
@@ -86,6 +95,14 @@ class UpdateIf:
   std::vector<double> upper;
   bool on;
   bool end;
+/// make the actions in the block fully dormant when it is off (see DORMANT)
+  bool dormancy;
+/// the condition computed at the previous step, used to set the dormancy
+  bool blockActive;
+/// the pilot actions contained in this block, collected at the first step
+  bool blockScanned;
+  std::vector<Action*> blockPilots;
+  void scanBlock();
 public:
   void prepare() override;
   void calculate() override;
@@ -105,6 +122,10 @@ void UpdateIf::registerKeywords(Keywords& keys) {
   keys.use("ARG");
   keys.add("compulsory","STRIDE","1","the frequency with which the quantities of interest should be output");
   keys.addFlag("END",false,"end");
+  keys.addFlag("DORMANT",false,"when the block is off, the actions it contains are not activated at all: they are excluded "
+               "from the dependency resolution and their atoms are no longer shared with the MD code. Since atoms are shared "
+               "before the condition can be evaluated, the block is switched on and off using the condition computed at the "
+               "previous step");
   keys.add("optional","LESS_THAN","upper bound");
   keys.add("optional","MORE_THAN","lower bound");
 }
@@ -114,9 +135,15 @@ UpdateIf::UpdateIf(const ActionOptions&ao):
   ActionPilot(ao),
   ActionWithArguments(ao),
   on(false),
-  end(false)
+  end(false),
+  dormancy(false),
+  blockActive(true),
+  blockScanned(false)
 {
   parseFlag("END",end);
+  parseFlag("DORMANT",dormancy);
+  if(end && dormancy) error("END and DORMANT are not compatible");
+  if(dormancy) log.printf("  actions in this block are fully dormant when the block is off, based on the condition at the previous step\n");
   parseVector("LESS_THAN",upper);
   parseVector("MORE_THAN",lower);
   if(end && upper.size()!=0) error("END and LESS_THAN are not compatible");
@@ -131,8 +158,32 @@ UpdateIf::UpdateIf(const ActionOptions&ao):
   checkRead();
 }
 
+void UpdateIf::scanBlock() {
+  // collect the pilot actions between this action and the matching END.
+  // only pilots need to be marked: everything else is activated through
+  // the dependencies of some pilot anyway
+  unsigned depth=1; bool found=false;
+  for(const auto & pp : plumed.getActionSet()) {
+    Action* p=pp.get();
+    if(!found) { if(p==this) found=true; continue; }
+    UpdateIf* u=dynamic_cast<UpdateIf*>(p);
+    if(u) {
+      if(u->end) { depth--; if(depth==0) break; }
+      else depth++;
+    }
+    if(dynamic_cast<ActionPilot*>(p)) blockPilots.push_back(p);
+  }
+  if(depth>0) error("DORMANT requires a matching UPDATE_IF ... END");
+  blockScanned=true;
+}
+
 void UpdateIf::prepare() {
   on=false;
+  if(end || !dormancy) return;
+  if(!blockScanned) scanBlock();
+  // this runs before the pilots that follow in the input are activated,
+  // so setting them dormant here keeps them out of this step entirely
+  for(unsigned i=0; i<blockPilots.size(); ++i) blockPilots[i]->setDormant(!blockActive);
 }
 
 void UpdateIf::calculate() {
@@ -140,6 +191,7 @@ void UpdateIf::calculate() {
   for(unsigned i=0; i<getNumberOfArguments(); ++i) {
     if(getArgument(i)>=upper[i] || getArgument(i)<=lower[i]) on=false;
   }
+  if(dormancy) blockActive=on;
 }
 
 void UpdateIf::beforeUpdate() {
@@ -189,29 +189,29 @@ WholeMolecules::WholeMolecules(const ActionOptions&ao):
   requestAtoms(merge);
   doNotRetrieve();
   doNotForce();
+// this action rewrites the global positions in place:
+  declareGlobalStateModifier();
 }
 
 void WholeMolecules::calculate() {
-  if(doref) {
-    #pragma omp parallel num_threads(OpenMP::getNumThreads())
-    {
-      #pragma omp for nowait
-      for(unsigned i=0; i<groups.size(); ++i) {
-        Vector & first (modifyGlobalPosition(groups[i][0]));
-        first = refs[i]+pbcDistance(refs[i],first);
-        for(unsigned j=0; j<groups[i].size()-1; ++j) {
-          const Vector & first (getGlobalPosition(groups[i][j]));
-          Vector & second (modifyGlobalPosition(groups[i][j+1]));
-          second=first+pbcDistance(first,second);
-        }
-      }
-    }
-  } else {
+  // entities are reconstructed in parallel over OpenMP threads.  Within an
+  // entity the original sequential walk is kept, with every minimum image
+  // computed by pbcDistance from the already moved neighbour: resolving the
+  // deltas of the unmoved positions in a batch gives the same result up to
+  // rounding, but can pick the other periodic image when two atoms sit at
+  // exactly half a box length from each other
+  #pragma omp parallel num_threads(OpenMP::getNumThreads())
+  {
+    #pragma omp for nowait
     for(unsigned i=0; i<groups.size(); ++i) {
-      for(unsigned j=0; j<groups[i].size()-1; ++j) {
-        const Vector & first (getGlobalPosition(groups[i][j]));
-        Vector & second (modifyGlobalPosition(groups[i][j+1]));
-        second=first+pbcDistance(first,second);
+      Vector cur=getGlobalPosition(groups[i][0]);
+      if(doref) {
+        cur=refs[i]+pbcDistance(refs[i],cur);
+        modifyGlobalPosition(groups[i][0])=cur;
+      }
+      for(unsigned j=0; j+1<groups[i].size(); ++j) {
+        cur=cur+pbcDistance(cur,getGlobalPosition(groups[i][j+1]));
+        modifyGlobalPosition(groups[i][j+1])=cur;
       }
     }
   }
@@ -205,6 +205,8 @@ WrapAround::WrapAround(const ActionOptions&ao):
   requestAtoms(merged);
   doNotRetrieve();
   doNotForce();
+// this action rewrites the global positions in place:
+  declareGlobalStateModifier();
 }
 
 void WrapAround::calculate() {
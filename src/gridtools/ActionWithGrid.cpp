@@ -32,6 +32,10 @@ void ActionWithGrid::registerKeywords( Keywords& keys ) {
   keys.add("compulsory","KERNEL","gaussian","the kernel function you are using.  More details on  the kernels available "
            "in plumed plumed can be found in \\ref kernelfunctions.");
   keys.add("optional","CONCENTRATION","the concentration parameter for Von Mises-Fisher distributions");
+  keys.addFlag("ATOMIC_DEPOSIT",false,"accumulate the grid in shared fixed-point accumulators instead of per-thread buffers.  With many "
+               "threads and a large grid this avoids allocating and merging one copy of the grid per thread.  The fixed point "
+               "representation covers twelve orders of magnitude so this is only appropriate for histogram-style accumulation and "
+               "it cannot be used when forces are applied on the grid");
 }
 
 ActionWithGrid::ActionWithGrid( const ActionOptions& ao):
@@ -44,6 +48,10 @@ ActionWithGrid::ActionWithGrid( const ActionOptions& ao):
 std::unique_ptr<GridVessel> ActionWithGrid::createGrid( const std::string& type, const std::string& inputstr ) {
   // Start creating the input for the grid
   std::string vstring = inputstr;
+  if( keywords.exists("ATOMIC_DEPOSIT") ) {
+    bool atomdep=false; parseFlag("ATOMIC_DEPOSIT",atomdep);
+    if( atomdep ) vstring += " ATOMIC_DEPOSIT";
+  }
   if( keywords.exists("KERNEL") ) {
     std::string vconc; parse("CONCENTRATION",vconc);
     if( vconc.length()>0 ) {
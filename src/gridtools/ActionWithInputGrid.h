@@ -37,6 +37,7 @@ protected:
   double getFunctionValue( const unsigned& ipoint ) const ;
   double getFunctionValue( const std::vector<unsigned>& ip ) const ;
   double getFunctionValueAndDerivatives( const std::vector<double>& x, std::vector<double>& der ) const ;
+  double getFunctionValueAndDerivatives( const std::vector<double>& x, std::vector<double>& der, GridVessel::SplineCell& cell ) const ;
 public:
   static void registerKeywords( Keywords& keys );
   explicit ActionWithInputGrid(const ActionOptions&ao);
@@ -63,6 +64,11 @@ double ActionWithInputGrid::getFunctionValueAndDerivatives( const std::vector<do
   return ingrid->getValueAndDerivatives( x, mycomp, der );
 }
 
+inline
+double ActionWithInputGrid::getFunctionValueAndDerivatives( const std::vector<double>& x, std::vector<double>& der, GridVessel::SplineCell& cell ) const {
+  return ingrid->getValueAndDerivatives( x, mycomp, der, cell );
+}
+
 }
 }
 #endif
@@ -41,6 +41,14 @@ AverageOnGrid::AverageOnGrid( const vesselbase::VesselOptions& da ):
 }
 
 void AverageOnGrid::accumulate( const unsigned& ipoint, const double& weight, const double& dens, const std::vector<double>& der, std::vector<double>& buffer ) const {
+  if( fixed_point ) {
+    addToFixedPoint( nper*ipoint, weight*dens ); addToFixedPoint( nper*(ipoint+1) - (dimension+1), dens );
+    if( der.size()>0 ) {
+      for(unsigned j=0; j<dimension; ++j) addToFixedPoint( nper*ipoint + 1 + j, weight*der[j] );
+      for(unsigned j=0; j<dimension; ++j) addToFixedPoint( nper*(ipoint+1) - dimension + j, der[j] );
+    }
+    return;
+  }
   buffer[bufstart+nper*ipoint] += weight*dens; buffer[ bufstart+nper*(ipoint+1) - (dimension+1) ] += dens;
   if( der.size()>0 ) {
     for(unsigned j=0; j<dimension; ++j) buffer[ bufstart+nper*ipoint + 1 + j ] += weight*der[j];
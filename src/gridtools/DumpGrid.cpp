@@ -21,7 +21,10 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "GridPrintingBase.h"
 #include "core/ActionRegister.h"
+#include "core/PlumedMain.h"
 #include "tools/OFile.h"
+#include <cstdio>
+#include <cstdint>
 
 namespace PLMD {
 namespace gridtools {
@@ -136,30 +139,191 @@ HISTOGRAM ...
 DUMPGRID GRID=hh FILE=histo STRIDE=100000
 \endplumedfile
 
+\par Incremental output
+
+When a large grid is dumped frequently most of its cells are unchanged between
+two dumps.  With the INCREMENTAL flag the grid is not rewritten as text every
+stride: a single binary file is appended to instead, and each frame holds only
+the cells that changed since the previous frame.  A full keyframe is written
+every KEYFRAME_STRIDE frames so that a reader does not need to replay the whole
+file to reconstruct a late frame, and the file ends with a footer indexing the
+offset, step and type of every frame.  All numbers are written in the native
+representation of the machine.  The stored values are the unnormalized grid
+data together with the normalization of each frame, exactly as in the text
+format.
+
+\plumedfile
+TORSION ATOMS=1,2,3,4 LABEL=r1
+hh: HISTOGRAM ARG=r1 GRID_MIN=-pi GRID_MAX=pi GRID_BIN=600 BANDWIDTH=0.05
+
+DUMPGRID GRID=hh FILE=histo STRIDE=1000 INCREMENTAL
+\endplumedfile
+
 */
 //+ENDPLUMEDOC
 
 class DumpGrid : public GridPrintingBase {
+private:
+/// True if only the cells that changed since the previous dump are written
+  bool incremental;
+/// Number of incremental frames between two full keyframes
+  unsigned keystride;
+/// Number of frames written so far to the incremental file
+  unsigned nframes;
+/// Handle of the incremental binary file
+  FILE* bfile;
+/// Index of the frames written so far, stored in the footer on close
+  std::vector<unsigned long long> frame_offsets, frame_steps;
+  std::vector<int> frame_types;
+/// Write one keyframe or one diff frame to the incremental file
+  void writeIncrementalFrame();
+/// Write the footer index and close the incremental file
+  void closeIncrementalFile();
 public:
   static void registerKeywords( Keywords& keys );
   explicit DumpGrid(const ActionOptions&ao);
+  ~DumpGrid();
   void printGrid( OFile& ofile ) const override;
+  void update() override;
+  void runFinalJobs() override;
 };
 
 PLUMED_REGISTER_ACTION(DumpGrid,"DUMPGRID")
 
+namespace {
+
+/// Magic markers starting and ending an incremental grid file
+const char grid_magic[8]= {'P','L','M','D','G','R','I','D'};
+const char grid_trailer[8]= {'P','L','M','D','G','E','N','D'};
+const int32_t grid_version=1;
+
+void bwrite( FILE* f, const void* ptr, size_t s ) {
+  if( fwrite( ptr, 1, s, f )!=s ) plumed_merror("error writing incremental grid file");
+}
+
+template <class T>
+void bwritev( FILE* f, const T& t ) {
+  bwrite( f, &t, sizeof(T) );
+}
+
+void bwrites( FILE* f, const std::string& str ) {
+  int32_t l=str.length(); bwritev( f, l ); bwrite( f, str.c_str(), l );
+}
+
+}
+
 void DumpGrid::registerKeywords( Keywords& keys ) {
   GridPrintingBase::registerKeywords( keys );
+  keys.addFlag("INCREMENTAL",false,"append binary frames holding only the grid cells that changed since the previous "
+               "dump instead of rewriting the full grid as text every stride.  See the section on incremental output above");
+  keys.add("compulsory","KEYFRAME_STRIDE","10","when INCREMENTAL is used, write a full keyframe every this many frames "
+           "so that readers do not need to replay the whole file");
 }
 
 DumpGrid::DumpGrid(const ActionOptions&ao):
   Action(ao),
-  GridPrintingBase(ao)
+  GridPrintingBase(ao),
+  incremental(false),
+  keystride(10),
+  nframes(0),
+  bfile(NULL)
 {
   if( ingrid->getType()!="flat" ) error("cannot dump grid of type " + ingrid->getType() + " using DUMPGRID");
+  parseFlag("INCREMENTAL",incremental); parse("KEYFRAME_STRIDE",keystride);
+  if( incremental ) {
+    if( getStride()==0 ) error("INCREMENTAL makes no sense when the grid is only output at the end of the calculation - set STRIDE");
+    if( keystride<1 ) error("KEYFRAME_STRIDE should be at least one");
+    ingrid->trackDirtyPoints();
+    log.printf("  appending binary frames with the cells changed since the previous dump, with a full keyframe every %u frames\n",keystride);
+  }
   fmt = " " + fmt; checkRead();
 }
 
+DumpGrid::~DumpGrid() {
+// the footer is normally written in runFinalJobs; this is a safety net for
+// runs that are torn down without finalization
+  closeIncrementalFile();
+}
+
+void DumpGrid::writeIncrementalFrame() {
+  const unsigned nq=ingrid->getNumberOfQuantities(), np=ingrid->getNumberOfPoints(), dim=ingrid->getDimension();
+  if( !bfile ) {
+    // The file is opened and the header written on the first frame rather
+    // than during setup, when the bounds of the grid may not yet be known
+    std::string fname=FileBase::appendSuffix( filename, plumed.getSuffix() );
+    if( !getRestart() ) { OFile tmp; tmp.link(*this); tmp.backupFile( "bck", fname ); }
+    bfile=std::fopen( fname.c_str(), getRestart() ? "ab" : "wb" );
+    if( !bfile ) plumed_merror("cannot open file " + fname);
+    // On restart frames are appended after the footer of the previous run:
+    // every run adds one self contained segment ending with its own footer
+    bwrite( bfile, grid_magic, 8 ); bwritev( bfile, grid_version );
+    int32_t idim=dim, inq=nq; bwritev( bfile, idim ); bwritev( bfile, inq );
+    std::vector<std::string> smin( ingrid->getMin() ), smax( ingrid->getMax() );
+    std::vector<unsigned> nb( ingrid->getNbin() );
+    for(unsigned j=0; j<dim; ++j) {
+      bwrites( bfile, ingrid->getComponentName(j) );
+      double mn, mx; Tools::convert( smin[j], mn ); Tools::convert( smax[j], mx );
+      bwritev( bfile, mn ); bwritev( bfile, mx );
+      int64_t nbj=nb[j]; bwritev( bfile, nbj );
+      int32_t per=ingrid->isPeriodic(j) ? 1 : 0; bwritev( bfile, per );
+    }
+    for(unsigned j=0; j<nq; ++j) bwrites( bfile, ingrid->getComponentName(dim+j) );
+  }
+  const bool key=( nframes%keystride==0 );
+  frame_offsets.push_back( ftell(bfile) ); frame_steps.push_back( getStep() ); frame_types.push_back( key ? 0 : 1 );
+  int32_t type=key ? 0 : 1; bwritev( bfile, type );
+  int64_t step=getStep(); bwritev( bfile, step );
+  double norm=ingrid->getNorm(); bwritev( bfile, norm );
+  std::vector<double> row( nq );
+  if( key ) {
+    int64_t n=np; bwritev( bfile, n );
+    for(unsigned i=0; i<np; ++i) {
+      for(unsigned j=0; j<nq; ++j) row[j]=ingrid->getGridElement( i, j );
+      bwrite( bfile, &row[0], nq*sizeof(double) );
+    }
+  } else {
+    int64_t n=0;
+    for(unsigned i=0; i<np; ++i) {
+      if( ingrid->isDirty(i) ) n++;
+    }
+    bwritev( bfile, n );
+    for(unsigned i=0; i<np; ++i) {
+      if( !ingrid->isDirty(i) ) continue;
+      int64_t idx=i; bwritev( bfile, idx );
+      for(unsigned j=0; j<nq; ++j) row[j]=ingrid->getGridElement( i, j );
+      bwrite( bfile, &row[0], nq*sizeof(double) );
+    }
+  }
+  ingrid->clearDirtyPoints(); nframes++;
+  std::fflush( bfile );
+}
+
+void DumpGrid::closeIncrementalFile() {
+  if( !bfile ) return;
+  int64_t fstart=ftell( bfile );
+  for(unsigned i=0; i<frame_offsets.size(); ++i) {
+    int64_t off=frame_offsets[i]; bwritev( bfile, off );
+    int64_t st=frame_steps[i]; bwritev( bfile, st );
+    int32_t tp=frame_types[i]; bwritev( bfile, tp );
+  }
+  int64_t nfr=frame_offsets.size(); bwritev( bfile, nfr );
+  bwritev( bfile, fstart );
+  bwrite( bfile, grid_trailer, 8 );
+  std::fclose( bfile ); bfile=NULL;
+}
+
+void DumpGrid::update() {
+  if( !incremental ) { GridPrintingBase::update(); return; }
+  if( !outputForReplica() || getStep()==0 ) return;
+  writeIncrementalFrame();
+}
+
+void DumpGrid::runFinalJobs() {
+  if( !incremental ) { GridPrintingBase::runFinalJobs(); return; }
+  if( !outputForReplica() ) return;
+  closeIncrementalFile();
+}
+
 void DumpGrid::printGrid( OFile& ofile ) const {
   ofile.addConstantField("normalisation");
   for(unsigned i=0; i<ingrid->getDimension(); ++i) {
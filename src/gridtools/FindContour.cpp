@@ -24,6 +24,7 @@
 #include "ContourFindingBase.h"
 #include "core/PlumedMain.h"
 #include "core/Atoms.h"
+#include "tools/OpenMP.h"
 
 //+PLUMEDOC GRIDANALYSIS FIND_CONTOUR
 /*
@@ -95,6 +96,10 @@ class FindContour : public ContourFindingBase {
 private:
   bool firsttime;
   unsigned gbuffer;
+/// Only rescan the cells of the grid that changed since the last scan
+  bool incremental;
+/// The normalization of the grid when the last scan was done
+  double lastnorm;
 /// Stuff for output
   OFile of;
   double lenunit;
@@ -121,6 +126,8 @@ void FindContour::registerKeywords( Keywords& keys ) {
   keys.add("compulsory","FILE","file on which to output coordinates");
   keys.add("compulsory","UNITS","PLUMED","the units in which to print out the coordinates. PLUMED means internal PLUMED units");
   keys.add("optional", "PRECISION","The number of digits in trajectory file");
+  keys.addFlag("INCREMENTAL",false,"only redo the marching squares scan in the parts of the grid that changed since the last scan.  "
+               "Cells whose corner values did not change keep the contour points that were found on the previous scan");
 }
 
 FindContour::FindContour(const ActionOptions&ao):
@@ -131,6 +138,11 @@ FindContour::FindContour(const ActionOptions&ao):
 
   parse("BUFFER",gbuffer);
   if( gbuffer>0 ) log.printf("  after first step a subset of only %u grid points around where the countour was found will be checked\n",gbuffer);
+  parseFlag("INCREMENTAL",incremental); lastnorm=0.0;
+  if( incremental ) {
+    log.printf("  only rescanning the parts of the grid that changed since the last scan\n");
+    ingrid->trackDirtyPoints();
+  }
 
   std::string file; parse("FILE",file);
   if( file.length()==0 ) error("name out output file was not specified");
@@ -163,40 +175,59 @@ void FindContour::prepareForAveraging() {
   if( firsttime ) {
     for(unsigned i=0; i<ingrid->getDimension()*ingrid->getNumberOfPoints(); ++i) addTaskToList( i );
   }
+  // With INCREMENTAL only the cells whose corner values changed since the
+  // last scan are redone; the others keep the task flags they had.  A change
+  // in the normalization rescales the function everywhere so the whole grid
+  // must be rescanned whenever it happens
+  bool scan_all=true; std::vector<unsigned> oldflags;
+  if( incremental && !firsttime && ingrid->getNorm()==lastnorm ) { scan_all=false; oldflags=taskFlags; }
+  lastnorm=ingrid->getNorm();
   firsttime=false; deactivateAllTasks();
 
   // We now need to identify the grid points that we need to search through
+  const unsigned npoints=ingrid->getNumberOfPoints();
+  const unsigned dimension=ingrid->getDimension();
   std::vector<unsigned> nbin( ingrid->getNbin() );
-  std::vector<unsigned> ind( ingrid->getDimension() );
-  std::vector<unsigned> ones( ingrid->getDimension(), 1 );
-  unsigned num_neighbours; std::vector<unsigned> neighbours;
-  for(unsigned i=0; i<ingrid->getNumberOfPoints(); ++i) {
+  std::vector<unsigned> ones( dimension, 1 );
+  unsigned nt=OpenMP::getNumThreads();
+  if( nt*8>npoints ) nt=1;
+  #pragma omp parallel for num_threads(nt)
+  for(unsigned i=0; i<npoints; ++i) {
     // Ensure inactive grid points are ignored
     if( ingrid->inactive(i) ) continue;
 
     // Get the index of the current grid point
+    std::vector<unsigned> ind( dimension );
+    unsigned num_neighbours; std::vector<unsigned> neighbours;
     ingrid->getIndices( i, ind );
     ingrid->getNeighbors( ind, ones, num_neighbours, neighbours );
-    bool cycle=false;
+    bool cycle=false, dirtycell=scan_all;
     for(unsigned j=0; j<num_neighbours; ++j) {
       if( ingrid->inactive( neighbours[j]) ) { cycle=true; break; }
+      if( !scan_all && ingrid->isDirty( neighbours[j] ) ) dirtycell=true;
     }
     if( cycle ) continue;
+    // Nothing around this point changed so the old flags are still valid
+    if( !dirtycell ) {
+      for(unsigned j=0; j<dimension; ++j) taskFlags[ dimension*i + j ] = oldflags[ dimension*i + j ];
+      continue;
+    }
 
     // Get the value of a point on the grid
     double val1=getFunctionValue( i ) - contour;
     bool edge=false;
-    for(unsigned j=0; j<ingrid->getDimension(); ++j) {
+    for(unsigned j=0; j<dimension; ++j) {
       // Make sure we don't search at the edge of the grid
       if( !ingrid->isPeriodic(j) && (ind[j]+1)==nbin[j] ) continue;
       else if( (ind[j]+1)==nbin[j] ) { edge=true; ind[j]=0; }
       else ind[j]+=1;
       double val2=getFunctionValue( ind ) - contour;
-      if( val1*val2<0 ) taskFlags[ ingrid->getDimension()*i + j ] = 1;
+      if( val1*val2<0 ) taskFlags[ dimension*i + j ] = 1;
       if( ingrid->isPeriodic(j) && edge ) { edge=false; ind[j]=nbin[j]-1; }
       else ind[j]-=1;
     }
   }
+  if( incremental ) ingrid->clearDirtyPoints();
   lockContributors();
 }
 
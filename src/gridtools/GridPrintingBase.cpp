@@ -40,6 +40,7 @@ void GridPrintingBase::registerKeywords( Keywords& keys ) {
 GridPrintingBase::GridPrintingBase(const ActionOptions&ao):
   Action(ao),
   ActionPilot(ao),
+  async_output(std::getenv("PLUMED_ASYNC_IO")!=NULL),
   fmt("%f"),
   output_for_all_replicas(false)
 {
@@ -70,31 +71,62 @@ GridPrintingBase::GridPrintingBase(const ActionOptions&ao):
     log.printf("  outputting data for replicas ");
     for(unsigned i=0; i<preps.size(); ++i) log.printf("%d ", preps[i] );
   }
+  if( async_output ) log.printf("\n  grid will be formatted and written by a background thread \n");
 }
 
-void GridPrintingBase::update() {
-  if( !output_for_all_replicas ) {
-    bool found=false; unsigned myrep=plumed.multi_sim_comm.Get_rank();
-    for(unsigned i=0; i<preps.size(); ++i) {
-      if( myrep==preps[i] ) { found=true; break; }
-    }
-    if( !found ) return;
+GridPrintingBase::~GridPrintingBase() {
+  waitForPrinter();
+}
+
+void GridPrintingBase::waitForPrinter() {
+  if( printer_thread.joinable() ) printer_thread.join();
+// closing deregisters the file with PlumedMain, so it is done here
+// on the main thread rather than on the printer thread
+  print_ofile.reset();
+}
+
+void GridPrintingBase::printSnapshot() {
+// all the grid reads done by this thread are served from the snapshot,
+// so the calculation thread can keep accumulating on the live data
+  vesselbase::AveragingVessel::redirectReads( &print_snapshot );
+  printGrid( *print_ofile );
+  vesselbase::AveragingVessel::redirectReads( NULL );
+}
+
+bool GridPrintingBase::outputForReplica() const {
+  if( output_for_all_replicas ) return true;
+  unsigned myrep=plumed.multi_sim_comm.Get_rank();
+  for(unsigned i=0; i<preps.size(); ++i) {
+    if( myrep==preps[i] ) return true;
   }
+  return false;
+}
+
+void GridPrintingBase::update() {
+  if( !outputForReplica() ) return;
   if( getStep()==0 || getStride()==0 ) return ;
 
+  if( async_output ) {
+// make sure the previous output has landed, snapshot the data, open the
+// file here on the main thread and leave the formatting and the writing
+// to the background thread
+    waitForPrinter();
+    print_snapshot=ingrid->snapshotData();
+    print_ofile.reset(new OFile); print_ofile->link(*this);
+    print_ofile->setBackupString("analysis");
+    print_ofile->open( filename );
+    printer_thread=std::thread(&GridPrintingBase::printSnapshot,this);
+    return;
+  }
+
   OFile ofile; ofile.link(*this);
   ofile.setBackupString("analysis");
   ofile.open( filename ); printGrid( ofile );
 }
 
 void GridPrintingBase::runFinalJobs() {
-  if( !output_for_all_replicas ) {
-    bool found=false; unsigned myrep=plumed.multi_sim_comm.Get_rank();
-    for(unsigned i=0; i<preps.size(); ++i) {
-      if( myrep==preps[i] ) { found=true; break; }
-    }
-    if( !found ) return;
-  }
+  waitForPrinter();
+  if( !outputForReplica() ) return;
   if( getStride()>0 ) return;
 
   OFile ofile; ofile.link(*this);
@@ -26,18 +26,42 @@
 #include "GridVessel.h"
 #include "tools/OFile.h"
 
+#include <thread>
+#include <memory>
+
 namespace PLMD {
 namespace gridtools {
 
 class GridPrintingBase : public ActionPilot {
+private:
+/// Set when the PLUMED_ASYNC_IO environment variable is present: at the
+/// stride boundary the grid data is snapshotted and a background thread
+/// formats and writes it while the accumulation continues
+  bool async_output;
+/// Snapshot of the grid data being written by the background thread
+  std::vector<double> print_snapshot;
+/// File being written by the background thread.  It is opened and closed
+/// on the main thread, since opening and closing register the file with
+/// PlumedMain and that registry is not thread safe
+  std::unique_ptr<OFile> print_ofile;
+/// The background thread; joined before the next output, before the
+/// final jobs and on destruction
+  std::thread printer_thread;
+/// Body of the background thread: print the grid reading from the snapshot
+  void printSnapshot();
+/// Wait for a pending asynchronous output to complete and close its file
+  void waitForPrinter();
 protected:
   GridVessel* ingrid;
   std::string fmt, filename;
   bool output_for_all_replicas;
   std::vector<unsigned> preps;
+/// Check whether this replica should produce output
+  bool outputForReplica() const ;
 public:
   static void registerKeywords( Keywords& keys );
   explicit GridPrintingBase(const ActionOptions&ao);
+  ~GridPrintingBase();
   void calculate() override {}
   void apply() override {}
   void update() override;
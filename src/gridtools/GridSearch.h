@@ -23,6 +23,7 @@
 #define __PLUMED_gridtools_GridSearch_h
 
 #include "tools/MinimiseBase.h"
+#include "tools/OpenMP.h"
 #include "GridVessel.h"
 #include <iostream>
 #include <memory>
@@ -36,7 +37,14 @@ private:
 /// This is the pointer to the member function in the energy
 /// calculating class that calculates the energy
   typedef double(FCLASS::*engf_pointer)( const std::vector<double>& p, std::vector<double>& der );
+/// This is the pointer to an optional batched version of the energy routine.
+/// It receives np points packed one after the other in pp and must put the
+/// np energies in eng and the np*n derivatives in der.  The routine must be
+/// safe to call concurrently from multiple threads
+  typedef void(FCLASS::*engfb_pointer)( const unsigned& np, const std::vector<double>& pp, std::vector<double>& eng, std::vector<double>& der );
   FCLASS* myclass_func;
+/// Number of grid points that are gathered in each call to the batched energy routine
+  static const unsigned bsize=64;
   std::unique_ptr<GridVessel> mygrid;
   std::unique_ptr<GridVessel> myfgrid;
 public:
@@ -60,6 +68,7 @@ public:
     if( myfgrid ) myfgrid->setBounds( gmin, gmax, nfg, dummy_spacing );
   }
   bool minimise( std::vector<double>& p, engf_pointer myfunc );
+  bool minimise( std::vector<double>& p, engf_pointer myfunc, engfb_pointer myfuncb );
 };
 
 template <class FCLASS>
@@ -104,6 +113,83 @@ bool GridSearch<FCLASS>::minimise( std::vector<double>& p, engf_pointer myfunc )
   }
 }
 
+template <class FCLASS>
+bool GridSearch<FCLASS>::minimise( std::vector<double>& p, engf_pointer myfunc, engfb_pointer myfuncb ) {
+  std::vector<double> der( p.size() ); std::vector<double> coords( p.size() );
+  double initial_eng = (myclass_func->*myfunc)( p, der );
+  const unsigned n=p.size(), np=mygrid->getNumberOfPoints();
+
+  // Evaluate the objective over the coarse grid in batches of points so that
+  // the scan can be partitioned over the threads.  Each thread writes the
+  // energies and derivatives of its own batches into disjoint parts of the
+  // shared buffers and the results are transferred onto the grid serially
+  std::vector<double> vals( np ), ders( np*n );
+  const unsigned nb=(np+bsize-1)/bsize;
+  unsigned nt=OpenMP::getNumThreads(); if( nt>nb ) nt=nb;
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<double> tcoords( n ), batch( bsize*n ), beng( bsize ), bder( bsize*n );
+    #pragma omp for
+    for(unsigned ib=0; ib<nb; ++ib) {
+      const unsigned start=ib*bsize; unsigned nbp=bsize; if( start+nbp>np ) nbp=np-start;
+      for(unsigned i=0; i<nbp; ++i) {
+        mygrid->getGridPointCoordinates( start+i, tcoords );
+        for(unsigned j=0; j<n; ++j) batch[i*n+j]=tcoords[j];
+      }
+      (myclass_func->*myfuncb)( nbp, batch, beng, bder );
+      for(unsigned i=0; i<nbp; ++i) {
+        vals[start+i]=beng[i];
+        for(unsigned j=0; j<n; ++j) ders[(start+i)*n+j]=bder[i*n+j];
+      }
+    }
+  }
+  double emin=vals[0]; unsigned pmin=0;
+  for(unsigned i=0; i<np; ++i) {
+    for(unsigned j=0; j<n; ++j) der[j]=ders[i*n+j];
+    mygrid->setValueAndDerivatives( i, 0, vals[i], der );
+    if( vals[i]<emin ) { emin=vals[i]; pmin=i; }
+  }
+  // This prevents division by zero
+  mygrid->setNorm( 1.0 );
+
+  if( myfgrid ) {
+    // The interpolation pass only reads from the coarse grid so here each
+    // thread scans its own share of the fine grid points and the per thread
+    // minima are merged at the end.  Exact ties resolve to the lowest index
+    // so that the result does not depend on the number of threads
+    const unsigned nfp=myfgrid->getNumberOfPoints();
+    pmin=0; emin=0; bool first=true;
+    #pragma omp parallel num_threads(OpenMP::getNumThreads())
+    {
+      std::vector<double> tcoords( n ), tder( n ); GridVessel::SplineCell cell;
+      double temin=0; unsigned tpmin=0; bool tfirst=true;
+      #pragma omp for nowait
+      for(unsigned i=0; i<nfp; ++i) {
+        myfgrid->getGridPointCoordinates( i, tcoords );
+        double eng = mygrid->getValueAndDerivatives( tcoords, 0, tder, cell );
+        if( tfirst || eng<temin ) { temin=eng; tpmin=i; tfirst=false; }
+      }
+      #pragma omp critical
+      if( !tfirst && ( first || temin<emin || (temin==emin && tpmin<pmin) ) ) { emin=temin; pmin=tpmin; first=false; }
+    }
+    myfgrid->getGridPointCoordinates( pmin, coords );
+    double checkEng = (myclass_func->*myfunc)( coords, der );
+    if( checkEng<initial_eng ) {
+      myfgrid->getGridPointCoordinates( pmin, p );
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  if( emin<initial_eng ) {
+    mygrid->getGridPointCoordinates( pmin, p );
+    return true;
+  } else {
+    return false;
+  }
+}
+
 }
 }
 #endif
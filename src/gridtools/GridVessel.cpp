@@ -27,12 +27,15 @@
 namespace PLMD {
 namespace gridtools {
 
+constexpr double GridVessel::fp_scale;
+
 void GridVessel::registerKeywords( Keywords& keys ) {
   AveragingVessel::registerKeywords( keys );
   keys.add("compulsory","TYPE","flat","how the grid points are being generated");
   keys.add("compulsory","COMPONENTS","the names of the components in the vector");
   keys.add("compulsory","COORDINATES","the names of the coordinates of the grid");
   keys.add("compulsory","PBC","is the grid periodic in each direction or not");
+  keys.addFlag("ATOMIC_DEPOSIT",false,"accumulate the grid in shared fixed-point accumulators rather than per-thread buffers");
 }
 
 GridVessel::GridVessel( const vesselbase::VesselOptions& da ):
@@ -41,8 +44,11 @@ GridVessel::GridVessel( const vesselbase::VesselOptions& da ):
   npoints(0),
   cube_units(1.0),
   wasforced(false),
-  noderiv(false)
+  noderiv(false),
+  track_dirty(false),
+  fixed_point(false)
 {
+  parseFlag("ATOMIC_DEPOSIT",fixed_point);
   std::string geom; parse("TYPE",geom);
   if( geom=="flat" ) gtype=flat;
   else if( geom=="fibonacci" ) gtype=fibonacci;
@@ -184,6 +190,11 @@ void GridVessel::resize() {
   plumed_massert( nper>0, "Number of datapoints at each grid point has not been set");
   if( getAction() ) resizeBuffer( getNumberOfBufferPoints()*nper + 1 + 2*getAction()->getNumberOfDerivatives() );
   setDataSize( npoints*nper ); forces.resize( npoints );
+  if( fixed_point ) {
+    fp_data.reset( new std::atomic<long long>[ npoints*nper ] );
+    for(unsigned i=0; i<npoints*nper; ++i) fp_data[i].store( 0, std::memory_order_relaxed );
+  }
+  if( track_dirty ) dirty_points.assign( npoints, true );
   if( active.size()!=npoints) active.resize( npoints, true );
 }
 
@@ -325,6 +336,7 @@ double GridVessel::getGridElement( const unsigned& ipoint, const unsigned& jelem
 
 void GridVessel::setGridElement( const unsigned& ipoint, const unsigned& jelement, const double& value ) {
   plumed_dbg_assert( bounds_set && ipoint<npoints && jelement<nper );
+  if( track_dirty ) dirty_points[ipoint]=true;
   setDataElement( nper*ipoint + jelement, value );
 }
 
@@ -335,17 +347,59 @@ void GridVessel::setValueAndDerivatives( const unsigned& ipoint, const unsigned&
 
 void GridVessel::addToGridElement( const unsigned& ipoint, const unsigned& jelement, const double& value ) {
   plumed_dbg_assert( bounds_set && ipoint<npoints && jelement<nper );
+  if( track_dirty && value!=0.0 ) dirty_points[ipoint]=true;
   addDataElement( nper*ipoint + jelement, value );
 }
 
 void GridVessel::calculate( const unsigned& current, MultiValue& myvals, std::vector<double>& buffer, std::vector<unsigned>& der_list ) const {
   plumed_dbg_assert( myvals.getNumberOfValues()==(nper+1) );
+  if( fixed_point ) {
+    for(unsigned i=0; i<nper; ++i) addToFixedPoint( nper*current + i, myvals.get(i+1) );
+    return;
+  }
   for(unsigned i=0; i<nper; ++i) buffer[bufstart + nper*current + i] += myvals.get(i+1);
 }
 
+void GridVessel::trackDirtyPoints() {
+  track_dirty=true; dirty_points.assign( npoints, true );
+}
+
+void GridVessel::clear() {
+  // Zeroing the grid only changes the points that currently hold data
+  if( track_dirty && getNorm()!=0.0 ) {
+    for(unsigned i=0; i<npoints; ++i) {
+      for(unsigned k=0; k<nper; ++k) {
+        if( getDataElement( nper*i + k )!=0.0 ) { dirty_points[i]=true; break; }
+      }
+    }
+  }
+  AveragingVessel::clear();
+}
+
 void GridVessel::finish( const std::vector<double>& buffer ) {
   if( wasforced ) getFinalForces( buffer, finalForces );
-  else AveragingVessel::finish( buffer );
+  else if( !fixed_point ) {
+    AveragingVessel::finish( buffer );
+    if( track_dirty ) {
+      for(unsigned i=0; i<npoints; ++i) {
+        for(unsigned k=0; k<nper; ++k) {
+          if( buffer[bufstart + nper*i + k]!=0.0 ) { dirty_points[i]=true; break; }
+        }
+      }
+    }
+  }
+  if( fixed_point ) {
+    // Drain the shared accumulators into the grid proper.  The totals are
+    // converted back to floating point before they are summed over MPI as
+    // every rank only deposited its own stripe of the tasks
+    std::vector<double> tmp( npoints*nper );
+    for(unsigned i=0; i<tmp.size(); ++i) tmp[i] = static_cast<double>( fp_data[i].exchange( 0, std::memory_order_relaxed ) ) / fp_scale;
+    if( !getAction()->serialCalculation() ) getAction()->comm.Sum( tmp );
+    for(unsigned i=0; i<tmp.size(); ++i) {
+      addDataElement( i, tmp[i] );
+      if( track_dirty && tmp[i]!=0.0 ) dirty_points[i/nper]=true;
+    }
+  }
 }
 
 double GridVessel::getGridElement( const std::vector<unsigned>& indices, const unsigned& jelement ) const {
@@ -450,32 +504,50 @@ std::string GridVessel::getInputString() const {
 }
 
 double GridVessel::getValueAndDerivatives( const std::vector<double>& x, const unsigned& ind, std::vector<double>& der ) const {
-  plumed_dbg_assert( gtype==flat && der.size()==dimension && !noderiv && ind<getNumberOfComponents() );
+  SplineCell cell; return getValueAndDerivatives( x, ind, der, cell );
+}
 
-  double X,X2,X3,value=0; der.assign(der.size(),0.0);
-  std::vector<double> fd(dimension);
-  std::vector<double> C(dimension);
-  std::vector<double> D(dimension);
-  std::vector<double> dder(dimension);
+double GridVessel::getValueAndDerivatives( const std::vector<double>& x, const unsigned& ind, std::vector<double>& der, SplineCell& cell ) const {
+  plumed_dbg_assert( gtype==flat && der.size()==dimension && !noderiv && ind<getNumberOfComponents() );
 
-  std::vector<unsigned> nindices(dimension); unsigned n_neigh;
   std::vector<unsigned> indices(dimension); getIndices( x, indices );
-  std::vector<unsigned> neigh; getSplineNeighbors( getIndex(indices), n_neigh, neigh );
-  std::vector<double> xfloor(dimension); getFlatGridCoordinates( getIndex(x), nindices, xfloor );
+  unsigned mybox = getIndex( indices );
+  // Fetch the corner data if the point is not in the cell we have stored
+  if( !cell.valid || cell.mybox!=mybox || cell.component!=ind ) {
+    cell.fd.resize(dimension); cell.C.resize(dimension); cell.D.resize(dimension);
+    cell.dder.resize(dimension); cell.xfloor.resize(dimension);
+    getSplineNeighbors( mybox, cell.n_neigh, cell.neigh );
+    cell.vals.resize( cell.n_neigh ); cell.ders.resize( cell.n_neigh*dimension );
+    cell.corner_indices.resize( cell.n_neigh*dimension );
+    std::vector<unsigned> nindices(dimension);
+    getFlatGridCoordinates( mybox, nindices, cell.xfloor );
+    for(unsigned int ipoint=0; ipoint<cell.n_neigh; ++ipoint) {
+      cell.vals[ipoint]=getGridElement( cell.neigh[ipoint], ind*(1+dimension) );
+      for(unsigned j=0; j<dimension; ++j) cell.ders[ipoint*dimension+j] = getGridElement( cell.neigh[ipoint], ind*(1+dimension) + 1 + j );
+      getIndices( cell.neigh[ipoint], nindices );
+      for(unsigned j=0; j<dimension; ++j) cell.corner_indices[ipoint*dimension+j]=nindices[j];
+    }
+    cell.mybox=mybox; cell.component=ind; cell.valid=true;
+  }
+
+  double X,X2,X3,value=0; der.assign(der.size(),0.0);
+  std::vector<double>& fd( cell.fd );
+  std::vector<double>& C( cell.C );
+  std::vector<double>& D( cell.D );
+  std::vector<double>& dder( cell.dder );
 
 // loop over neighbors
-  for(unsigned int ipoint=0; ipoint<n_neigh; ++ipoint) {
-    double grid=getGridElement(neigh[ipoint], ind*(1+dimension) );
-    for(unsigned j=0; j<dimension; ++j) dder[j] = getGridElement( neigh[ipoint], ind*(1+dimension) + 1 + j );
+  for(unsigned int ipoint=0; ipoint<cell.n_neigh; ++ipoint) {
+    double grid=cell.vals[ipoint];
+    for(unsigned j=0; j<dimension; ++j) dder[j] = cell.ders[ipoint*dimension+j];
 
-    getIndices( neigh[ipoint], nindices );
     double ff=1.0;
 
     for(unsigned j=0; j<dimension; ++j) {
       int x0=1;
-      if(nindices[j]==indices[j]) x0=0;
+      if(cell.corner_indices[ipoint*dimension+j]==indices[j]) x0=0;
       double ddx=dx[j];
-      X=fabs((x[j]-xfloor[j])/ddx-(double)x0);
+      X=fabs((x[j]-cell.xfloor[j])/ddx-(double)x0);
       X2=X*X;
       X3=X2*X;
       double yy;
@@ -503,6 +575,7 @@ void GridVessel::activateThesePoints( const std::vector<bool>& to_activate ) {
 
 void GridVessel::setForce( const std::vector<double>& inforces ) {
   plumed_dbg_assert( inforces.size()==npoints );
+  plumed_massert( !fixed_point, "forces on the grid cannot be used together with ATOMIC_DEPOSIT");
   wasforced=true; for(unsigned i=0; i<npoints; ++i) forces[i]=inforces[i];
 }
 
@@ -25,6 +25,9 @@
 #include <string>
 #include <cstring>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <cmath>
 #include "vesselbase/AveragingVessel.h"
 
 namespace PLMD {
@@ -33,6 +36,32 @@ namespace gridtools {
 class GridVessel : public vesselbase::AveragingVessel {
   friend class ActionWithInputGrid;
   friend class DumpGrid;
+public:
+/// Holds the corner data of a single grid cell so that spline evaluations
+/// for many points that lie in the same cell can share the fetches
+  class SplineCell {
+    friend class GridVessel;
+  private:
+/// Is the data stored here valid
+    bool valid;
+/// The cell and the component of the grid the corner data was fetched for
+    unsigned mybox, component;
+/// The number of corners and their grid indices
+    unsigned n_neigh;
+    std::vector<unsigned> neigh;
+/// The indices of each of the corners
+    std::vector<unsigned> corner_indices;
+/// The values and derivatives on the corners of the cell
+    std::vector<double> vals, ders;
+/// The coordinates of the low corner of the cell
+    std::vector<double> xfloor;
+/// Scratch space for the evaluation of the spline
+    std::vector<double> fd, C, D, dder;
+  public:
+    SplineCell() : valid(false), mybox(0), component(0), n_neigh(0) {}
+/// The cell data must be fetched again the next time the spline is evaluated
+    void invalidate() { valid=false; }
+  };
 private:
 /// The way that grid points are constructed
   enum {flat,fibonacci} gtype;
@@ -81,6 +110,18 @@ protected:
   unsigned dimension;
 /// Which grid points are we actively accumulating
   std::vector<bool> active;
+/// Are we keeping track of the grid points whose values change
+  bool track_dirty;
+/// The grid points whose values changed since the flags were last cleared
+  std::vector<bool> dirty_points;
+/// Deposit directly into shared fixed-point accumulators rather than per-thread buffers
+  bool fixed_point;
+/// Conversion factor between the grid data and its fixed-point representation
+  static constexpr double fp_scale=4294967296.0;
+/// The shared fixed-point accumulators (one for each element of the grid data)
+  std::unique_ptr<std::atomic<long long>[]> fp_data;
+/// Add a value to one of the fixed point accumulators
+  void addToFixedPoint( const unsigned& ibuf, const double& value ) const ;
 /// Convert a point in space the the correspoinding grid point
   unsigned getIndex( const std::vector<double>& p ) const ;
 /// Get the index of the closest point on the fibonacci sphere
@@ -180,10 +221,21 @@ public:
   bool noDerivatives() const ;
 /// Get the value and derivatives at a particular location using spline interpolation
   double getValueAndDerivatives( const std::vector<double>& x, const unsigned& ind, std::vector<double>& der ) const ;
+/// As above but the corner data is kept in the cell object and reused as long
+/// as consecutive evaluations fall within the same grid cell
+  double getValueAndDerivatives( const std::vector<double>& x, const unsigned& ind, std::vector<double>& der, SplineCell& cell ) const ;
 /// Deactivate all the grid points
   void activateThesePoints( const std::vector<bool>& to_activate );
 /// Is this point active
   bool inactive( const unsigned& ip ) const ;
+/// Ask the grid to keep track of the points whose values change
+  void trackDirtyPoints();
+/// Has the value of this point changed since the dirty flags were last cleared
+  bool isDirty( const unsigned& ip ) const ;
+/// Mark all the points as unchanged again
+  void clearDirtyPoints();
+/// Clear all the data stored on the grid
+  void clear() override;
 /// This retrieves the final force
   virtual void getFinalForces( const std::vector<double>& buffer, std::vector<double>& finalForces ) { plumed_error(); }
 /// Apply the forces
@@ -260,6 +312,17 @@ bool GridVessel::inactive( const unsigned& ip ) const {
   return !active[ip];
 }
 
+inline
+bool GridVessel::isDirty( const unsigned& ip ) const {
+  plumed_dbg_assert( track_dirty && ip<npoints );
+  return dirty_points[ip];
+}
+
+inline
+void GridVessel::clearDirtyPoints() {
+  dirty_points.assign( npoints, false );
+}
+
 inline
 const std::vector<unsigned>& GridVessel::getStride() const {
   plumed_dbg_assert( gtype==flat );
@@ -268,9 +331,20 @@ const std::vector<unsigned>& GridVessel::getStride() const {
 
 inline
 unsigned GridVessel::getNumberOfBufferPoints() const {
+  // With fixed point accumulation the tasks deposit straight into the shared
+  // accumulators so no space is reserved for the grid in the task buffers
+  if( fixed_point ) return 0;
   return npoints;
 }
 
+inline
+void GridVessel::addToFixedPoint( const unsigned& ibuf, const double& value ) const {
+  // Rounding to fixed point before the addition makes the accumulated total
+  // independent of the order in which the threads deposit, as the integer
+  // additions are associative
+  fp_data[ibuf].fetch_add( static_cast<long long>( std::round( value*fp_scale ) ), std::memory_order_relaxed );
+}
+
 inline
 std::string GridVessel::getType() const {
   if( gtype==flat ) return "flat";
@@ -21,6 +21,7 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "HistogramOnGrid.h"
 #include "tools/KernelFunctions.h"
+#include "tools/OpenMP.h"
 
 namespace PLMD {
 namespace gridtools {
@@ -37,6 +38,7 @@ HistogramOnGrid::HistogramOnGrid( const vesselbase::VesselOptions& da ):
   neigh_tot(0),
   addOneKernelAtATime(false),
   bandwidths(dimension),
+  scratch_vv(OpenMP::getNumThreads()),
   discrete(false)
 {
   if( getType()=="flat" ) {
@@ -95,6 +97,12 @@ std::unique_ptr<KernelFunctions> HistogramOnGrid::getKernelAndNeighbors( std::ve
   return NULL;
 }
 
+std::vector<Value*> HistogramOnGrid::getScratchVectorOfValues() const {
+  const unsigned t=OpenMP::getThreadNum(); plumed_dbg_assert( t<scratch_vv.size() );
+  if( scratch_vv[t].empty() ) scratch_vv[t]=getVectorOfValues();
+  return Tools::unique2raw( scratch_vv[t] );
+}
+
 std::vector<std::unique_ptr<Value>> HistogramOnGrid::getVectorOfValues() const {
   std::vector<std::unique_ptr<Value>> vv;
   for(unsigned i=0; i<dimension; ++i) {
@@ -126,7 +134,7 @@ void HistogramOnGrid::calculate( const unsigned& current, MultiValue& myvals, st
     } else {
       double totwforce=0.0;
       std::vector<double> intforce( 2*dimension, 0.0 );
-      std::vector<std::unique_ptr<Value>> vv( getVectorOfValues() );
+      const std::vector<Value*>& vv( getScratchVectorOfValues() );
 
       double newval; std::vector<unsigned> tindices( dimension ); std::vector<double> xx( dimension );
       for(unsigned i=0; i<num_neigh; ++i) {
@@ -135,7 +143,7 @@ void HistogramOnGrid::calculate( const unsigned& current, MultiValue& myvals, st
         getGridPointCoordinates( ineigh, tindices, xx );
         if( kernel ) {
           for(unsigned j=0; j<dimension; ++j) vv[j]->set(xx[j]);
-          newval = kernel->evaluate( Tools::unique2raw(vv), der, true );
+          newval = kernel->evaluate( vv, der, true );
         } else {
           // Evalulate dot product
           double dot=0; for(unsigned j=0; j<dimension; ++j) { dot+=xx[j]*point[j]; der[j]=xx[j]; }
@@ -176,6 +184,11 @@ void HistogramOnGrid::calculate( const unsigned& current, MultiValue& myvals, st
 }
 
 void HistogramOnGrid::accumulate( const unsigned& ipoint, const double& weight, const double& dens, const std::vector<double>& der, std::vector<double>& buffer ) const {
+  if( fixed_point ) {
+    addToFixedPoint( nper*ipoint, weight*dens );
+    if( der.size()>0 ) for(unsigned j=0; j<dimension; ++j) addToFixedPoint( nper*ipoint + 1 + j, weight*der[j] );
+    return;
+  }
   buffer[bufstart+nper*ipoint] += weight*dens;
   if( der.size()>0 ) for(unsigned j=0; j<dimension; ++j) buffer[bufstart+nper*ipoint + 1 + j] += weight*der[j];
 }
@@ -38,6 +38,9 @@ private:
   std::string kerneltype;
   std::vector<double> bandwidths;
   std::vector<unsigned> nneigh;
+/// Per-thread scratch Value objects reused across kernel evaluations; each
+/// thread only ever touches its own slot, so no locking is needed
+  mutable std::vector<std::vector<std::unique_ptr<Value> > > scratch_vv;
 protected:
   bool discrete;
 public:
@@ -54,7 +57,9 @@ public:
   unsigned getNumberOfBufferPoints() const override;
   std::unique_ptr<KernelFunctions> getKernelAndNeighbors( std::vector<double>& point, unsigned& num_neigh, std::vector<unsigned>& neighbors ) const;
   std::vector<std::unique_ptr<Value>> getVectorOfValues() const ;
-  void addOneKernelEachTimeOnly() { addOneKernelAtATime=true; }
+/// Get the calling thread's scratch copy of the values, creating it on first use
+  std::vector<Value*> getScratchVectorOfValues() const ;
+  void addOneKernelEachTimeOnly() { plumed_massert( !fixed_point, "cannot add one kernel at a time with ATOMIC_DEPOSIT"); addOneKernelAtATime=true; }
   void getFinalForces( const std::vector<double>& buffer, std::vector<double>& finalForces ) override;
   bool noDiscreteKernels() const ;
   double getFibonacciCutoff() const override;
@@ -22,6 +22,7 @@
 #include "core/ActionRegister.h"
 #include "core/PlumedMain.h"
 #include "ActionWithInputGrid.h"
+#include "tools/OpenMP.h"
 
 //+PLUMEDOC GRIDANALYSIS INTERPOLATE_GRID
 /*
@@ -51,10 +52,15 @@ namespace PLMD {
 namespace gridtools {
 
 class InterpolateGrid : public ActionWithInputGrid {
+private:
+/// Per-thread caches of the cell corner data so that the fine grid points
+/// that fall in the same cell of the input grid share the coefficient fetches
+  mutable std::vector<GridVessel::SplineCell> cell_cache;
 public:
   static void registerKeywords( Keywords& keys );
   explicit InterpolateGrid(const ActionOptions&ao);
   unsigned getNumberOfQuantities() const override;
+  void prepareForAveraging() override;
   void compute( const unsigned& current, MultiValue& myvals ) const override;
   bool isPeriodic() override { return false; }
 };
@@ -70,7 +76,8 @@ void InterpolateGrid::registerKeywords( Keywords& keys ) {
 
 InterpolateGrid::InterpolateGrid(const ActionOptions&ao):
   Action(ao),
-  ActionWithInputGrid(ao)
+  ActionWithInputGrid(ao),
+  cell_cache(OpenMP::getNumThreads())
 {
   plumed_assert( ingrid->getNumberOfComponents()==1 );
   if( ingrid->noDerivatives() ) error("cannot interpolate a grid that does not have derivatives");
@@ -100,9 +107,16 @@ unsigned InterpolateGrid::getNumberOfQuantities() const {
   return 2 + ingrid->getDimension();
 }
 
+void InterpolateGrid::prepareForAveraging() {
+  ActionWithInputGrid::prepareForAveraging();
+  // The values on the input grid may have changed since the last step
+  for(unsigned i=0; i<cell_cache.size(); ++i) cell_cache[i].invalidate();
+}
+
 void InterpolateGrid::compute( const unsigned& current, MultiValue& myvals ) const {
   std::vector<double> pos( mygrid->getDimension() ); mygrid->getGridPointCoordinates( current, pos );
-  std::vector<double> der( mygrid->getDimension() ); double val = getFunctionValueAndDerivatives( pos, der );
+  const unsigned t=OpenMP::getThreadNum(); plumed_dbg_assert( t<cell_cache.size() );
+  std::vector<double> der( mygrid->getDimension() ); double val = getFunctionValueAndDerivatives( pos, der, cell_cache[t] );
   myvals.setValue( 0, 1.0 ); myvals.setValue(1, val );
   for(unsigned i=0; i<mygrid->getDimension(); ++i) myvals.setValue( 2+i, der[i] );
 }
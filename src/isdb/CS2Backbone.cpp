@@ -40,6 +40,7 @@
 #include "tools/Pbc.h"
 #include "tools/PDB.h"
 #include "tools/Torsion.h"
+#include "tools/LinkCells.h"
 
 using namespace std;
 
@@ -412,7 +413,6 @@ class CS2Backbone : public MetainferenceBase {
     vector<unsigned> side_chain;// atoms for the current sidechain
     vector<int> xd1;            // additional couple of atoms
     vector<int> xd2;            // additional couple of atoms
-    vector<unsigned> box_nb;    // non-bonded atoms
 
     ChemicalShift():
       exp_cs(0.),
@@ -433,7 +433,6 @@ class CS2Backbone : public MetainferenceBase {
     {
       xd1.reserve(26);
       xd2.reserve(26);
-      box_nb.reserve(150);
     }
   };
 
@@ -472,6 +471,17 @@ class CS2Backbone : public MetainferenceBase {
   bool             camshift;
   bool             pbc;
   bool             serial;
+  LinkCells        linkcells;
+  vector<Vector>   nl_refpos;
+  vector<unsigned> nb_list;   // CSR-packed non-bonded neighbours of all the shifts
+  vector<unsigned> nb_start;  // start of the neighbours of each shift in nb_list
+  double           cache_tol;
+  vector<Vector>   cache_refpos;
+  vector<unsigned char> cache_moved;
+  vector<unsigned char> cache_valid;
+  vector<double>   cache_shift;
+  vector<Vector>   cache_derivs;
+  vector<unsigned> cache_catoms;
 
   void init_cs(const string &file, const string &k, const PDB &pdb);
   void update_neighb();
@@ -502,7 +512,8 @@ void CS2Backbone::registerKeywords( Keywords& keys ) {
   keys.add("atoms","ATOMS","The atoms to be included in the calculation, e.g. the whole protein.");
   keys.add("compulsory","DATADIR","data/","The folder with the experimental chemical shifts.");
   keys.add("compulsory","TEMPLATE","template.pdb","A PDB file of the protein system.");
-  keys.add("compulsory","NEIGH_FREQ","20","Period in step for neighbor list update.");
+  keys.add("compulsory","NEIGH_FREQ","20","Kept for backward compatibility, it is ignored: the neighbor lists are now refreshed when an atom moved more than half of the list skin.");
+  keys.add("compulsory","CACHE_TOL","0.0","if greater than zero a chemical shift is recomputed only when one of the atoms it depends on moved more than this length (in nm) since the last recomputation, otherwise its cached value and derivatives are reused; the resulting error vanishes with the tolerance");
   keys.addFlag("CAMSHIFT",false,"Set to TRUE if you to calculate a single CamShift score.");
   keys.addFlag("NOEXP",false,"Set to TRUE if you don't want to have fixed components with the experimental values.");
   keys.addOutputComponent("ha","default","the calculated Ha hydrogen chemical shifts");
@@ -524,7 +535,8 @@ CS2Backbone::CS2Backbone(const ActionOptions&ao):
   max_cs_atoms(0),
   camshift(false),
   pbc(true),
-  serial(false)
+  serial(false),
+  linkcells(comm)
 {
   vector<AtomNumber> used_atoms;
   parseAtomList("ATOMS",used_atoms);
@@ -551,6 +563,10 @@ CS2Backbone::CS2Backbone(const ActionOptions&ao):
   box_nupdate=20;
   parse("NEIGH_FREQ", box_nupdate);
 
+  cache_tol=0.;
+  parse("CACHE_TOL", cache_tol);
+  if(cache_tol>0.) log.printf("  chemical shifts are recomputed only when one of their atoms moved more than %lf nm\n", cache_tol);
+
   string stringadb  = stringa_data + string("/camshift.db");
   string stringapdb = stringa_data + string("/") + stringa_template;
 
@@ -953,9 +969,67 @@ void CS2Backbone::calculate()
 {
   if(pbc) makeWhole();
   if(getExchangeStep()) box_count=0;
-  if(box_count==0) update_neighb();
+  // the neighbour lists are built with a buffer distance cutOffNB larger than
+  // the interaction cutoff cutOffDist, so they stay valid until one atom has
+  // moved more than half of that skin since the last build
+  bool nl_updated = (box_count==0);
+  if(!nl_updated) {
+    constexpr double skin2 = 0.25*(cutOffNB-cutOffDist)*(cutOffNB-cutOffDist);
+    const unsigned natoms = getNumberOfAtoms();
+    for(unsigned i=0; i<natoms; i++) {
+      if(delta(nl_refpos[i],getPosition(i)).modulo2()>skin2) { nl_updated=true; break; }
+    }
+  }
+  if(nl_updated) update_neighb();
+  box_count=1;
   compute_ring_parameters();
 
+  // with CACHE_TOL the shifts whose atoms did not move since their last
+  // evaluation are not recomputed: the cached value and derivatives are
+  // injected in the output arrays by the rank that owns the shift
+  const bool docache = cache_tol>0.;
+  if(docache) {
+    const unsigned natoms = getNumberOfAtoms();
+    if(nl_updated || cache_refpos.size()!=natoms) {
+      // a neighbour list update changes the dependencies and the layout of
+      // the per-shift arrays, so the whole cache must be rebuilt
+      cache_refpos.resize(natoms);
+      for(unsigned i=0; i<natoms; i++) cache_refpos[i]=getPosition(i);
+      cache_moved.assign(natoms,1);
+      cache_valid.assign(chemicalshifts.size(),0);
+      cache_shift.assign(chemicalshifts.size(),0.);
+      cache_derivs.assign(chemicalshifts.size()*max_cs_atoms,Vector(0,0,0));
+      cache_catoms.assign(chemicalshifts.size()*max_cs_atoms,0);
+    } else {
+      const double tol2 = cache_tol*cache_tol;
+      for(unsigned i=0; i<natoms; i++) {
+        if(delta(cache_refpos[i],getPosition(i)).modulo2()>tol2) {
+          cache_moved[i]=1;
+          cache_refpos[i]=getPosition(i);
+        } else cache_moved[i]=0;
+      }
+      // the ring currents couple every shift to all the ring atoms
+      bool rings_moved=false;
+      for(unsigned q=0; q<ringInfo.size()&&!rings_moved; q++) {
+        for(unsigned at=0; at<ringInfo[q].numAtoms; at++) if(cache_moved[ringInfo[q].atom[at]]) { rings_moved=true; break; }
+      }
+      for(unsigned cs=0; cs<chemicalshifts.size(); cs++) {
+        if(!cache_valid[cs]) continue;
+        if(rings_moved) { cache_valid[cs]=0; continue; }
+        const ChemicalShift & myfrag = chemicalshifts[cs];
+        bool moved = cache_moved[myfrag.ipos];
+        for(unsigned q=0; q<myfrag.bb.size()&&!moved; q++) moved = cache_moved[myfrag.bb[q]];
+        for(unsigned q=0; q<myfrag.side_chain.size()&&!moved; q++) moved = cache_moved[myfrag.side_chain[q]];
+        for(unsigned q=0; q<myfrag.xd1.size()&&!moved; q++) {
+          if(myfrag.xd1[q]!=-1) moved = cache_moved[myfrag.xd1[q]];
+          if(myfrag.xd2[q]!=-1) moved = moved||cache_moved[myfrag.xd2[q]];
+        }
+        for(unsigned q=nb_start[cs]; q<nb_start[cs+1]&&!moved; q++) moved = cache_moved[nb_list[q]];
+        if(moved) cache_valid[cs]=0;
+      }
+    }
+  }
+
   vector<double> camshift_sigma2(6);
   camshift_sigma2[0] = 0.08; // HA
   camshift_sigma2[1] = 0.30; // HN
@@ -991,6 +1065,14 @@ void CS2Backbone::calculate()
     for(unsigned cs=rank; cs<chemicalshifts.size(); cs+=stride) {
       const unsigned kdx=cs*max_cs_atoms;
       const ChemicalShift *myfrag = &chemicalshifts[cs];
+      if(docache && cache_valid[cs]) {
+        all_shifts[cs] = cache_shift[cs];
+        for(unsigned i=0; i<myfrag->totcsatoms; i++) {
+          cs_derivs[kdx+i] = cache_derivs[kdx+i];
+          cs_atoms[kdx+i]  = cache_catoms[kdx+i];
+        }
+        continue;
+      }
       const unsigned aa_kind = myfrag->res_kind;
       const unsigned at_kind = myfrag->atm_kind;
 
@@ -1026,14 +1108,32 @@ void CS2Backbone::calculate()
 
       //DIHEDRAL ANGLES
       const double *CO_DA = db.CO_DA(aa_kind,at_kind);
-      //Phi
+      // the dihedrals share the backbone bonds, which are computed once,
+      // and are evaluated together with the batch kernel of Torsion
+      Vector tv1[3], tv2[3], tv3[3], td1[3], td2[3], td3[3];
+      double tangle[3];
       {
-        const Vector d0 = delta(getPosition(myfrag->bb[Nc]), getPosition(myfrag->bb[Cp]));
-        const Vector d1 = delta(getPosition(myfrag->bb[CAc]), getPosition(myfrag->bb[Nc]));
-        const Vector d2 = delta(getPosition(myfrag->bb[Cc]), getPosition(myfrag->bb[CAc]));
+        const Vector bond_CpN  = delta(getPosition(myfrag->bb[Nc]),  getPosition(myfrag->bb[Cp]));
+        const Vector bond_NCA  = delta(getPosition(myfrag->bb[CAc]), getPosition(myfrag->bb[Nc]));
+        const Vector bond_CAC  = delta(getPosition(myfrag->bb[Cc]),  getPosition(myfrag->bb[CAc]));
+        const Vector bond_CNn  = delta(getPosition(myfrag->bb[Nn]),  getPosition(myfrag->bb[Cc]));
+        tv1[0]=bond_CpN; tv2[0]=bond_NCA; tv3[0]=bond_CAC; // phi
+        tv1[1]=bond_NCA; tv2[1]=bond_CAC; tv3[1]=bond_CNn; // psi
+        unsigned ndih=2;
+        if(myfrag->has_chi1) {
+          tv1[2]=bond_NCA;
+          tv2[2]=delta(getPosition(myfrag->bb[CBc]), getPosition(myfrag->bb[CAc]));
+          tv3[2]=delta(getPosition(myfrag->bb[CGc]), getPosition(myfrag->bb[CBc]));
+          ndih=3;
+        }
         Torsion t;
-        Vector dd0, dd1, dd2;
-        const double t_phi = t.compute(d0,d1,d2,dd0,dd1,dd2);
+        t.compute(ndih,tv1,tv2,tv3,tangle,td1,td2,td3);
+      }
+
+      //Phi
+      {
+        const Vector &dd0(td1[0]), &dd1(td2[0]), &dd2(td3[0]);
+        const double t_phi = tangle[0];
         const double *PARS_DA = db.PARS_DA(aa_kind,at_kind,0);
         const double val1 = 3.*t_phi+PARS_DA[3];
         const double val2 = t_phi+PARS_DA[4];
@@ -1052,12 +1152,8 @@ void CS2Backbone::calculate()
 
       //Psi
       {
-        const Vector d0 = delta(getPosition(myfrag->bb[CAc]), getPosition(myfrag->bb[Nc]));
-        const Vector d1 = delta(getPosition(myfrag->bb[Cc]), getPosition(myfrag->bb[CAc]));
-        const Vector d2 = delta(getPosition(myfrag->bb[Nn]), getPosition(myfrag->bb[Cc]));
-        Torsion t;
-        Vector dd0, dd1, dd2;
-        const double t_psi = t.compute(d0,d1,d2,dd0,dd1,dd2);
+        const Vector &dd0(td1[1]), &dd1(td2[1]), &dd2(td3[1]);
+        const double t_psi = tangle[1];
         const double *PARS_DA = db.PARS_DA(aa_kind,at_kind,1);
         const double val1 = 3.*t_psi+PARS_DA[3];
         const double val2 = t_psi+PARS_DA[4];
@@ -1076,12 +1172,8 @@ void CS2Backbone::calculate()
 
       //Chi
       if(myfrag->has_chi1) {
-        const Vector d0 = delta(getPosition(myfrag->bb[CAc]), getPosition(myfrag->bb[Nc]));
-        const Vector d1 = delta(getPosition(myfrag->bb[CBc]), getPosition(myfrag->bb[CAc]));
-        const Vector d2 = delta(getPosition(myfrag->bb[CGc]), getPosition(myfrag->bb[CBc]));
-        Torsion t;
-        Vector dd0, dd1, dd2;
-        const double t_chi1 = t.compute(d0,d1,d2,dd0,dd1,dd2);
+        const Vector &dd0(td1[2]), &dd1(td2[2]), &dd2(td3[2]);
+        const double t_chi1 = tangle[2];
         const double *PARS_DA = db.PARS_DA(aa_kind,at_kind,2);
         const double val1 = 3.*t_chi1+PARS_DA[3];
         const double val2 = t_chi1+PARS_DA[4];
@@ -1218,9 +1310,10 @@ void CS2Backbone::calculate()
       //NON BOND
       const double * CONST_CO_SPHERE3 = db.CO_SPHERE(aa_kind,at_kind,0);
       const double * CONST_CO_SPHERE  = db.CO_SPHERE(aa_kind,at_kind,1);
-      const unsigned boxsize = myfrag->box_nb.size();
+      const unsigned nbstart = nb_start[cs];
+      const unsigned boxsize = nb_start[cs+1]-nbstart;
       for(unsigned q=0; q<boxsize; q++) {
-        const unsigned jpos = myfrag->box_nb[q];
+        const unsigned jpos = nb_list[nbstart+q];
         const Vector distance = delta(getPosition(jpos),getPosition(ipos));
         const double d2 = distance.modulo2();
 
@@ -1266,12 +1359,18 @@ void CS2Backbone::calculate()
 
       atom_counter += boxsize;
       all_shifts[cs] = shift;
+
+      if(docache) {
+        cache_shift[cs] = shift;
+        for(unsigned i=0; i<myfrag->totcsatoms; i++) {
+          cache_derivs[kdx+i] = cs_derivs[kdx+i];
+          cache_catoms[kdx+i] = cs_atoms[kdx+i];
+        }
+        cache_valid[cs]=1;
+      }
     }
   }
 
-  ++box_count;
-  if(box_count == box_nupdate) box_count = 0;
-
   if(!camshift) {
     if(!serial) {
       if(!getDoScore()) {
@@ -1353,27 +1452,78 @@ void CS2Backbone::calculate()
 }
 
 void CS2Backbone::update_neighb() {
-  // cycle over chemical shifts
+  const unsigned natoms = getNumberOfAtoms();
+
+  // bucket the atoms with link cells instead of scanning all of them for
+  // every shift. The distances are plain differences on the whole-made
+  // molecule, so the cells are built in a fake orthorhombic box that contains
+  // it with a border of one cutoff: no atom is wrapped and the candidates
+  // coming from the periodic images of the cell grid are removed by the
+  // exact distance check below
+  Vector bmin = getPosition(0);
+  Vector bmax = bmin;
+  for(unsigned i=1; i<natoms; i++) {
+    const Vector & p(getPosition(i));
+    for(unsigned l=0; l<3; l++) {
+      if(p[l]<bmin[l]) bmin[l]=p[l];
+      if(p[l]>bmax[l]) bmax[l]=p[l];
+    }
+  }
+  Tensor fakebox; fakebox.zero();
+  for(unsigned l=0; l<3; l++) fakebox[l][l]=bmax[l]-bmin[l]+2.*cutOffNB;
+  Pbc fakepbc; fakepbc.setBox(fakebox);
+  const Vector center = 0.5*(bmin+bmax);
+  vector<Vector> cpos(natoms);
+  vector<unsigned> indices(natoms);
+  for(unsigned i=0; i<natoms; i++) { cpos[i]=getPosition(i)-center; indices[i]=i; }
+  linkcells.setCutoff(cutOffNB);
+  linkcells.buildCellLists(cpos,indices,fakepbc);
+
+  vector<vector<unsigned> > nb(chemicalshifts.size());
   unsigned nt=OpenMP::getNumThreads();
-  #pragma omp parallel for num_threads(nt)
-  for(unsigned cs=0; cs<chemicalshifts.size(); cs++) {
-    const unsigned boxsize = getNumberOfAtoms();
-    chemicalshifts[cs].box_nb.clear();
-    chemicalshifts[cs].box_nb.reserve(150);
-    const unsigned res_curr = res_num[chemicalshifts[cs].ipos];
-    for(unsigned bat=0; bat<boxsize; bat++) {
-      const unsigned res_dist = abs(static_cast<int>(res_curr-res_num[bat]));
-      if(res_dist<2) continue;
-      const Vector distance = delta(getPosition(bat),getPosition(chemicalshifts[cs].ipos));
-      const double d2=distance.modulo2();
-      if(d2<cutOffNB2) chemicalshifts[cs].box_nb.push_back(bat);
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<unsigned> cell_list( linkcells.getNumberOfCells() );
+    std::vector<unsigned> candidates( natoms+1 );
+    #pragma omp for
+    for(unsigned cs=0; cs<chemicalshifts.size(); cs++) {
+      const unsigned ipos = chemicalshifts[cs].ipos;
+      const unsigned res_curr = res_num[ipos];
+      candidates[0]=ipos;
+      unsigned natomsper=1;
+      linkcells.retrieveNeighboringAtoms( cpos[ipos], cell_list, natomsper, candidates );
+      nb[cs].reserve(150);
+      for(unsigned q=1; q<natomsper; q++) {
+        const unsigned bat = candidates[q];
+        const unsigned res_dist = abs(static_cast<int>(res_curr-res_num[bat]));
+        if(res_dist<2) continue;
+        const Vector distance = delta(getPosition(bat),getPosition(ipos));
+        const double d2=distance.modulo2();
+        if(d2<cutOffNB2) nb[cs].push_back(bat);
+      }
+      // the cells are visited in grid order: sort to recover the stable
+      // atom-index ordering of the lists
+      std::sort(nb[cs].begin(),nb[cs].end());
+      chemicalshifts[cs].totcsatoms = chemicalshifts[cs].csatoms + nb[cs].size();
     }
-    chemicalshifts[cs].totcsatoms = chemicalshifts[cs].csatoms + chemicalshifts[cs].box_nb.size();
   }
+
+  // pack the lists in CSR form so that the non-bonded loop streams them
+  nb_start.resize(chemicalshifts.size()+1);
+  nb_start[0]=0;
+  for(unsigned cs=0; cs<chemicalshifts.size(); cs++) nb_start[cs+1]=nb_start[cs]+nb[cs].size();
+  nb_list.resize(nb_start.back());
+  for(unsigned cs=0; cs<chemicalshifts.size(); cs++) {
+    for(unsigned q=0; q<nb[cs].size(); q++) nb_list[nb_start[cs]+q]=nb[cs][q];
+  }
+
   max_cs_atoms=0;
   for(unsigned cs=0; cs<chemicalshifts.size(); cs++) {
     if(chemicalshifts[cs].totcsatoms>max_cs_atoms) max_cs_atoms = chemicalshifts[cs].totcsatoms;
   }
+
+  nl_refpos.resize(natoms);
+  for(unsigned i=0; i<natoms; i++) nl_refpos[i]=getPosition(i);
 }
 
 void CS2Backbone::compute_ring_parameters() {
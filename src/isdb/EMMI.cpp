@@ -31,6 +31,7 @@
 #include <cmath>
 #include <map>
 #include <numeric>
+#include <algorithm>
 #include <ctime>
 #include "tools/Random.h"
 
@@ -150,6 +151,9 @@ private:
 // neighbor list
   double   nl_cutoff_;
   unsigned nl_stride_;
+// squared distance per data GMM component beyond which every overlap falls
+// off the tabulated exponential, used to cull atoms in the list update
+  vector<double> nl_dcut2_;
   bool first_time_;
   bool no_aver_;
   vector<unsigned> nl_;
@@ -1010,6 +1014,20 @@ void EMMI::calculate_useful_stuff(double reso)
   for(unsigned i=0; i<nexp_; ++i) {
     tab_exp_.push_back(exp(-static_cast<double>(i) * dexp_));
   }
+  // conservative squared distance cutoffs for the neighbor list update:
+  // the exponent md^T inv_sum md is bounded from below by |md|^2/trace(sum),
+  // so at |md|^2 > dexp*(2*nexp-1)*trace(sum) the tabulated exponential
+  // lookup would be skipped anyway. Here the maximum over the atom types is
+  // kept for each data GMM component
+  nl_dcut2_.assign(GMM_d_m_.size(), 0.0);
+  for(unsigned i=0; i<GMM_m_s_.size(); ++i) {
+    double ss = 0.5 * GMM_m_s_[i] / pi / pi;
+    for(unsigned j=0; j<GMM_d_m_.size(); ++j) {
+      double trace = 3.0*ss + GMM_d_cov_[j][0] + GMM_d_cov_[j][3] + GMM_d_cov_[j][5];
+      double d2 = dexp_ * (2.0*static_cast<double>(nexp_)-1.0) * trace;
+      if(d2>nl_dcut2_[j]) nl_dcut2_[j] = d2;
+    }
+  }
 }
 
 // get prefactors
@@ -1106,15 +1124,110 @@ void EMMI::update_neighbor_list()
   // clear old neighbor list
   nl_.clear();
 
+  // sort the atoms into spatial tiles with an edge of one cutoff, so that for
+  // every map component only the atoms of the surrounding tiles have to be
+  // considered and whole tiles can be culled with a bounding-sphere test.
+  // With pbc the minimal image breaks a single tiling, so in that case all
+  // atoms stay candidates and only the per-pair distance cull applies
+  double dcut2_max = 0.0;
+  for(unsigned j=0; j<GMM_d_size; ++j) dcut2_max = std::max(dcut2_max, nl_dcut2_[j]);
+  const double tile_edge = sqrt(dcut2_max);
+  const double inv_edge = 1.0/tile_edge;
+  int ntx=1, nty=1, ntz=1;
+  Vector origin;
+  vector<unsigned> tile_start, tile_atom, tile_count;
+  vector<Vector> tile_center;
+  vector<double> tile_radius;
+  if(!pbc_) {
+    Vector bmin = getPosition(0), bmax = bmin;
+    for(unsigned im=1; im<GMM_m_size; ++im) {
+      const Vector & p(getPosition(im));
+      for(unsigned l=0; l<3; l++) {
+        if(p[l]<bmin[l]) bmin[l]=p[l];
+        if(p[l]>bmax[l]) bmax[l]=p[l];
+      }
+    }
+    origin = bmin;
+    ntx = static_cast<int>(std::floor((bmax[0]-bmin[0])*inv_edge))+1;
+    nty = static_cast<int>(std::floor((bmax[1]-bmin[1])*inv_edge))+1;
+    ntz = static_cast<int>(std::floor((bmax[2]-bmin[2])*inv_edge))+1;
+    const unsigned ntiles = ntx*nty*ntz;
+    vector<unsigned> tindex(GMM_m_size);
+    tile_start.assign(ntiles+1,0);
+    for(unsigned im=0; im<GMM_m_size; ++im) {
+      const Vector & p(getPosition(im));
+      int ix = std::min(ntx-1, static_cast<int>(std::floor((p[0]-origin[0])*inv_edge)));
+      int iy = std::min(nty-1, static_cast<int>(std::floor((p[1]-origin[1])*inv_edge)));
+      int iz = std::min(ntz-1, static_cast<int>(std::floor((p[2]-origin[2])*inv_edge)));
+      tindex[im] = ix + ntx*(iy + nty*iz);
+      tile_start[tindex[im]+1]++;
+    }
+    for(unsigned t=0; t<ntiles; ++t) tile_start[t+1] += tile_start[t];
+    tile_atom.resize(GMM_m_size);
+    tile_count.assign(ntiles,0);
+    for(unsigned im=0; im<GMM_m_size; ++im) {
+      tile_atom[tile_start[tindex[im]]+tile_count[tindex[im]]] = im;
+      tile_count[tindex[im]]++;
+    }
+    // center and bounding radius of each occupied tile
+    tile_center.assign(ntiles,Vector(0,0,0));
+    tile_radius.assign(ntiles,0.0);
+    for(unsigned t=0; t<ntiles; ++t) {
+      const unsigned nat = tile_start[t+1]-tile_start[t];
+      if(nat==0) continue;
+      Vector c(0,0,0);
+      for(unsigned k=tile_start[t]; k<tile_start[t+1]; ++k) c += getPosition(tile_atom[k]);
+      tile_center[t] = c/static_cast<double>(nat);
+      double r2max = 0.0;
+      for(unsigned k=tile_start[t]; k<tile_start[t+1]; ++k) {
+        double r2 = delta(tile_center[t],getPosition(tile_atom[k])).modulo2();
+        if(r2>r2max) r2max=r2;
+      }
+      tile_radius[t] = sqrt(r2max);
+    }
+  }
+
+  // candidate atoms for one map component
+  vector<unsigned> cand;
+  cand.reserve(GMM_m_size);
+
   // cycle on GMM components - in parallel
   for(unsigned id=rank_; id<GMM_d_size; id+=size_) {
-    // overlap lists and map
-    vector<double> ov_l;
-    map<double, unsigned> ov_m;
+    const double dcut2 = nl_dcut2_[id];
+    const Vector & dm = GMM_d_m_[id];
+    // gather the atoms within the distance cutoff of this component
+    cand.clear();
+    if(!pbc_) {
+      const double dcut = sqrt(dcut2);
+      const int lx0 = std::max(0, static_cast<int>(std::floor((dm[0]-dcut-origin[0])*inv_edge)));
+      const int ly0 = std::max(0, static_cast<int>(std::floor((dm[1]-dcut-origin[1])*inv_edge)));
+      const int lz0 = std::max(0, static_cast<int>(std::floor((dm[2]-dcut-origin[2])*inv_edge)));
+      const int lx1 = std::min(ntx-1, static_cast<int>(std::floor((dm[0]+dcut-origin[0])*inv_edge)));
+      const int ly1 = std::min(nty-1, static_cast<int>(std::floor((dm[1]+dcut-origin[1])*inv_edge)));
+      const int lz1 = std::min(ntz-1, static_cast<int>(std::floor((dm[2]+dcut-origin[2])*inv_edge)));
+      for(int iz=lz0; iz<=lz1; ++iz) for(int iy=ly0; iy<=ly1; ++iy) for(int ix=lx0; ix<=lx1; ++ix) {
+            const unsigned t = ix + ntx*(iy + nty*iz);
+            if(tile_start[t+1]==tile_start[t]) continue;
+            // bounding-sphere cull of the whole tile
+            if(delta(tile_center[t],dm).modulo() > dcut+tile_radius[t]) continue;
+            for(unsigned k=tile_start[t]; k<tile_start[t+1]; ++k) {
+              const unsigned im = tile_atom[k];
+              if(delta(getPosition(im),dm).modulo2()<=dcut2) cand.push_back(im);
+            }
+          }
+    } else {
+      for(unsigned im=0; im<GMM_m_size; ++im) {
+        if(pbcDistance(getPosition(im),dm).modulo2()<=dcut2) cand.push_back(im);
+      }
+    }
+    // overlap list with atom indexes
+    vector< pair<double,unsigned> > ov_l;
+    ov_l.reserve(cand.size());
     // total overlap with id
     double ov_tot = 0.0;
-    // cycle on all atoms
-    for(unsigned im=0; im<GMM_m_size; ++im) {
+    // cycle on the candidate atoms
+    for(unsigned q=0; q<cand.size(); ++q) {
+      const unsigned im = cand[q];
       // get index in auxiliary lists
       unsigned kaux = GMM_m_type_[im] * GMM_d_size + id;
       // calculate exponent of overlap
@@ -1126,9 +1239,7 @@ void EMMI::update_neighbor_list()
       // in case calculate overlap
       double ov = pre_fact_[kaux] * tab_exp_[itab];
       // add to list
-      ov_l.push_back(ov);
-      // and map to retrieve atom index
-      ov_m[ov] = im;
+      ov_l.push_back(pair<double,unsigned>(ov,im));
       // increase ov_tot
       ov_tot += ov;
     }
@@ -1136,19 +1247,21 @@ void EMMI::update_neighbor_list()
     if(ov_l.size()==0) continue;
     // define cutoff
     double ov_cut = ov_tot * nl_cutoff_;
-    // sort ov_l in ascending order
+    // sort ov_l in ascending order of overlap
     std::sort(ov_l.begin(), ov_l.end());
-    // integrate ov_l
+    // integrate ov_l and discard the atoms whose summed overlap stays below
+    // the cutoff; unlike the old map-based bookkeeping this keeps atoms with
+    // exactly equal overlaps
     double res = 0.0;
+    unsigned keep_from = 0;
     for(unsigned i=0; i<ov_l.size(); ++i) {
-      res += ov_l[i];
+      res += ov_l[i].first;
       // if exceeding the cutoff for overlap, stop
-      if(res >= ov_cut) break;
-      else ov_m.erase(ov_l[i]);
+      if(res >= ov_cut) { keep_from = i; break; }
     }
     // now add atoms to neighborlist
-    for(map<double, unsigned>::iterator it=ov_m.begin(); it!=ov_m.end(); ++it)
-      nl_l.push_back(id*GMM_m_size+it->second);
+    for(unsigned i=keep_from; i<ov_l.size(); ++i)
+      nl_l.push_back(id*GMM_m_size+ov_l[i].second);
     // end cycle on GMM components in parallel
   }
   // find total dimension of neighborlist
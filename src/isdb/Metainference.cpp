@@ -251,6 +251,21 @@ class Metainference : public bias::Bias
   unsigned                   average_weights_stride_;
   vector< vector <double> >  average_weights_;
 
+  // bounded-staleness replica communication: when async_stride_ is larger
+  // than one the cross-replica reductions run only every async_stride_ steps
+  // and in between the cached contribution of the other replicas is reused
+  unsigned async_stride_;
+  bool     async_ready_;
+  bool     async_stale_now_;
+  vector<double> async_bias_others_;
+  vector<double> async_mean_others_;
+  vector<double> async_sm2_others_;
+  vector<double> async_force_others_;
+  vector<double> async_is2_others_;
+  vector<double> async_dev_others_;
+  vector<double> async_dev2_others_;
+  void sum_replicas_async(double* buf, unsigned n, vector<double> &others);
+
   double getEnergyMIGEN(const vector<double> &mean, const vector<double> &ftilde, const vector<double> &sigma,
                         const double scale, const double offset);
   double getEnergySP(const vector<double> &mean, const vector<double> &sigma,
@@ -295,6 +310,7 @@ void Metainference::registerKeywords(Keywords& keys) {
   keys.addFlag("NOENSEMBLE",false,"don't perform any replica-averaging");
   keys.addFlag("REWEIGHT",false,"simple REWEIGHT using the latest ARG as energy");
   keys.add("optional","AVERAGING", "Stride for calculation of averaged weights and sigma_mean");
+  keys.add("optional","ASYNC_STRIDE","synchronize the ensemble averages across the replicas only every this many steps: in between each replica averages its current data with the other replicas' data from the last synchronization, which is then at most ASYNC_STRIDE-1 steps old. Useful when a slow replica would otherwise drag all the others at every step");
   keys.add("compulsory","NOISETYPE","MGAUSS","functional form of the noise (GAUSS,MGAUSS,OUTLIERS,MOUTLIERS,GENERIC)");
   keys.add("compulsory","LIKELIHOOD","GAUSS","the likelihood for the GENERIC metainference model, GAUSS or LOGN");
   keys.add("compulsory","DFTILDE","0.1","fraction of sigma_mean used to evolve ftilde");
@@ -370,7 +386,10 @@ Metainference::Metainference(const ActionOptions&ao):
   N_optimized_step_(0),
   optimized_step_(0),
   sigmamax_opt_done_(false),
-  average_weights_stride_(1)
+  average_weights_stride_(1),
+  async_stride_(1),
+  async_ready_(false),
+  async_stale_now_(false)
 {
   bool noensemble = false;
   parseFlag("NOENSEMBLE", noensemble);
@@ -413,6 +432,10 @@ Metainference::Metainference(const ActionOptions&ao):
     optsigmamean_stride_    = averaging;
   }
 
+  parse("ASYNC_STRIDE", async_stride_);
+  if(async_stride_==0) async_stride_=1;
+  if(async_stride_>1&&nrep_>1) log.printf("  cross-replica averages synchronized every %u steps\n", async_stride_);
+
   parseVector("PARAMETERS",parameters);
   if(parameters.size()!=static_cast<unsigned>(narg)&&!parameters.empty())
     error("Size of PARAMETERS array should be either 0 or the same as of the number of arguments in ARG1");
@@ -1353,7 +1376,7 @@ void Metainference::getEnergyForceSP(const vector<double> &mean, const vector<do
       }
     }
     // collect contribution to forces and energy from other replicas
-    if(nrep_>1) multi_sim_comm.Sum(&f[0],narg);
+    if(nrep_>1) sum_replicas_async(&f[0], narg, async_force_others_);
   }
   // intra-replica summation
   comm.Sum(&f[0],narg);
@@ -1392,7 +1415,7 @@ void Metainference::getEnergyForceSPE(const vector<double> &mean, const vector<d
       }
     }
     // collect contribution to forces and energy from other replicas
-    if(nrep_>1) multi_sim_comm.Sum(&f[0],narg);
+    if(nrep_>1) sum_replicas_async(&f[0], narg, async_force_others_);
   }
   comm.Sum(&f[0],narg);
 
@@ -1416,7 +1439,7 @@ void Metainference::getEnergyForceGJ(const vector<double> &mean, const vector<do
 
   if(master) {
     inv_s2 = 1./(sigma_[0]*sigma_[0] + scale2*sigma_mean2_[0]);
-    if(nrep_>1) multi_sim_comm.Sum(inv_s2);
+    if(nrep_>1) sum_replicas_async(&inv_s2, 1, async_is2_others_);
   }
   comm.Sum(inv_s2);
 
@@ -1446,7 +1469,7 @@ void Metainference::getEnergyForceGJE(const vector<double> &mean, const vector<d
 
   if(master) {
     for(unsigned i=0; i<sigma_.size(); ++i) inv_s2[i] = 1./(sigma_[i]*sigma_[i] + scale2*sigma_mean2_[i]);
-    if(nrep_>1) multi_sim_comm.Sum(&inv_s2[0],sigma_.size());
+    if(nrep_>1) sum_replicas_async(&inv_s2[0], sigma_.size(), async_is2_others_);
   }
   comm.Sum(&inv_s2[0],sigma_.size());
 
@@ -1482,8 +1505,8 @@ void Metainference::getEnergyForceMIGEN(const vector<double> &mean, const vector
     }
   }
   if(master&&nrep_>1) {
-    multi_sim_comm.Sum(&dev[0],dev.size());
-    multi_sim_comm.Sum(&dev2[0],dev2.size());
+    sum_replicas_async(&dev[0], dev.size(), async_dev_others_);
+    sum_replicas_async(&dev2[0], dev2.size(), async_dev2_others_);
   }
   comm.Sum(&dev[0],dev.size());
   comm.Sum(&dev2[0],dev2.size());
@@ -1505,6 +1528,22 @@ void Metainference::getEnergyForceMIGEN(const vector<double> &mean, const vector
   }
 }
 
+// cross-replica reduction with bounded staleness: on synchronization steps
+// the buffer is summed across the replicas and the contribution of the other
+// replicas is cached, on the steps in between the cached contribution is
+// added to the fresh local one
+void Metainference::sum_replicas_async(double* buf, unsigned n, vector<double> &others)
+{
+  if(!async_stale_now_) {
+    vector<double> own(buf, buf+n);
+    multi_sim_comm.Sum(buf, n);
+    others.resize(n);
+    for(unsigned i=0; i<n; ++i) others[i] = buf[i]-own[i];
+  } else {
+    for(unsigned i=0; i<n; ++i) buf[i] += others[i];
+  }
+}
+
 void Metainference::get_weights(const unsigned iselect, double &fact, double &var_fact)
 {
   const double dnrep    = static_cast<double>(nrep_);
@@ -1518,7 +1557,7 @@ void Metainference::get_weights(const unsigned iselect, double &fact, double &va
     if(master) {
       bias[replica_] = getArgument(narg);
       //bias[replica_] = ((1.0/plumed.getAtoms().getKbT())- (1.0/kbt_) )*getArgument(narg);
-      if(nrep_>1) multi_sim_comm.Sum(&bias[0], nrep_);
+      if(nrep_>1) sum_replicas_async(&bias[0], nrep_, async_bias_others_);
     }
     comm.Sum(&bias[0], nrep_);
 
@@ -1578,7 +1617,7 @@ void Metainference::get_sigma_mean(const unsigned iselect, const double fact, co
           double tmp2 = -2.*mean[i]*(fact-ave_fact)*(fact*getArgument(i)-ave_fact*mean[i]);
           sigma_mean2_now[i] = tmp1 + tmp2;
         }
-        if(nrep_>1) multi_sim_comm.Sum(&sigma_mean2_now[0], narg);
+        if(nrep_>1) sum_replicas_async(&sigma_mean2_now[0], narg, async_sm2_others_);
       }
       comm.Sum(&sigma_mean2_now[0], narg);
       for(unsigned i=0; i<narg; ++i) sigma_mean2_now[i] = dnrep/(dnrep-1.)*(sigma_mean2_now[i] + mean[i]*mean[i]*var_fact);
@@ -1588,7 +1627,7 @@ void Metainference::get_sigma_mean(const unsigned iselect, const double fact, co
           double tmp  = getArgument(i)-mean[i];
           sigma_mean2_now[i] = fact*tmp*tmp;
         }
-        if(nrep_>1) multi_sim_comm.Sum(&sigma_mean2_now[0], narg);
+        if(nrep_>1) sum_replicas_async(&sigma_mean2_now[0], narg, async_sm2_others_);
       }
       comm.Sum(&sigma_mean2_now[0], narg);
       for(unsigned i=0; i<narg; ++i) sigma_mean2_now[i] /= dnrep;
@@ -1659,7 +1698,7 @@ void Metainference::replica_averaging(const double fact, vector<double> &mean, v
 {
   if(master) {
     for(unsigned i=0; i<narg; ++i) mean[i] = fact*getArgument(i);
-    if(nrep_>1) multi_sim_comm.Sum(&mean[0], narg);
+    if(nrep_>1) sum_replicas_async(&mean[0], narg, async_mean_others_);
   }
   comm.Sum(&mean[0], narg);
   // set the derivative of the mean with respect to the bias
@@ -1694,6 +1733,9 @@ void Metainference::calculate()
   // set the value of selector for  REM-like stuff
   if(selector_.length()>0) iselect = static_cast<unsigned>(plumed.passMap[selector_]);
 
+  // decide whether this step reuses the cached cross-replica contributions
+  async_stale_now_ = (async_stride_>1 && async_ready_ && !getExchangeStep() && (step%async_stride_)!=0);
+
   double       fact     = 0.0;
   double       var_fact = 0.0;
   // get weights for ensemble average
@@ -1736,6 +1778,8 @@ void Metainference::calculate()
 
   // set value of the bias
   setBias(ene);
+
+  if(!async_stale_now_) async_ready_=true;
 }
 
 void Metainference::writeStatus()
@@ -45,6 +45,7 @@ void MetainferenceBase::registerKeywords( Keywords& keys ) {
   keys.addFlag("NOENSEMBLE",false,"don't perform any replica-averaging");
   keys.addFlag("REWEIGHT",false,"simple REWEIGHT using the ARG as energy");
   keys.add("optional","AVERAGING", "Stride for calculation of averaged weights and sigma_mean");
+  keys.add("optional","ASYNC_STRIDE","synchronize the ensemble averages across the replicas only every this many steps: in between each replica averages its current data with the other replicas' data from the last synchronization, which is then at most ASYNC_STRIDE-1 steps old. Useful when a slow replica would otherwise drag all the others at every step");
   keys.add("compulsory","NOISETYPE","MGAUSS","functional form of the noise (GAUSS,MGAUSS,OUTLIERS,MOUTLIERS,GENERIC)");
   keys.add("compulsory","LIKELIHOOD","GAUSS","the likelihood for the GENERIC metainference model, GAUSS or LOGN");
   keys.add("compulsory","DFTILDE","0.1","fraction of sigma_mean used to evolve ftilde");
@@ -71,6 +72,7 @@ void MetainferenceBase::registerKeywords( Keywords& keys ) {
   keys.add("optional","TEMP","the system temperature - this is only needed if code doesn't pass the temperature to plumed");
   keys.add("optional","MC_STEPS","number of MC steps");
   keys.add("optional","MC_CHUNKSIZE","MC chunksize");
+  keys.addFlag("MC_DEFERRED",false,"run the Monte Carlo sampling of the uncertainties on a helper thread between force calls, committing the new parameters at the next step");
   keys.add("optional","STATUS_FILE","write a file with all the data useful for restart/continuation of Metainference");
   keys.add("compulsory","WRITE_STRIDE","10000","write the status to a file every N steps, this can be used for restart/continuation");
   keys.add("optional","SELECTOR","name of selector");
@@ -119,6 +121,10 @@ MetainferenceBase::MetainferenceBase(const ActionOptions&ao):
   MCacceptFT_(0),
   MCtrial_(0),
   MCchunksize_(0),
+  MCdeferred_(false),
+  MColdene_(0),
+  MCdefaccept_(0),
+  MCdeftrial_(0),
   firstTime(true),
   do_reweight_(false),
   do_optsigmamean_(0),
@@ -128,7 +134,10 @@ MetainferenceBase::MetainferenceBase(const ActionOptions&ao):
   N_optimized_step_(0),
   optimized_step_(0),
   sigmamax_opt_done_(false),
-  decay_w_(1.)
+  decay_w_(1.),
+  async_stride_(1),
+  async_ready_(false),
+  async_stale_now_(false)
 {
   parseFlag("DOSCORE", doscore_);
 
@@ -171,6 +180,10 @@ MetainferenceBase::MetainferenceBase(const ActionOptions&ao):
     optsigmamean_stride_ = averaging;
   }
 
+  parse("ASYNC_STRIDE", async_stride_);
+  if(async_stride_==0) async_stride_=1;
+  if(async_stride_>1&&nrep_>1) log.printf("  cross-replica averages synchronized every %u steps\n", async_stride_);
+
   string stringa_noise;
   parse("NOISETYPE",stringa_noise);
   if(stringa_noise=="GAUSS")           noise_type_ = GAUSS;
@@ -322,6 +335,9 @@ MetainferenceBase::MetainferenceBase(const ActionOptions&ao):
   // monte carlo stuff
   parse("MC_STEPS",MCsteps_);
   parse("MC_CHUNKSIZE", MCchunksize_);
+  parseFlag("MC_DEFERRED", MCdeferred_);
+  if(MCdeferred_&&(doscale_||dooffset_||noise_type_==GENERIC))
+    error("MC_DEFERRED samples the uncertainties only, it cannot be used with SCALEDATA, ADDOFFSET or NOISETYPE=GENERIC");
   // get temperature
   double temp=0.0;
   parse("TEMP",temp);
@@ -370,6 +386,7 @@ MetainferenceBase::MetainferenceBase(const ActionOptions&ao):
 
 MetainferenceBase::~MetainferenceBase()
 {
+  if(MCthread_.joinable()) MCthread_.join();
   if(sfile_.isOpen()) sfile_.close();
 }
 
@@ -664,6 +681,7 @@ void MetainferenceBase::Initialise(const unsigned input)
   log.printf("\n");
   log.printf("  temperature of the system %f\n",kbt_);
   log.printf("  MC steps %u\n",MCsteps_);
+  if(MCdeferred_) log.printf("  MC sampling runs on a helper thread between force calls\n");
   log.printf("  initial standard errors of the mean");
   for(unsigned i=0; i<sigma_mean2_.size(); ++i) log.printf(" %f", sqrt(sigma_mean2_[i]));
   log.printf("\n");
@@ -1014,6 +1032,88 @@ void MetainferenceBase::moveSigmas(const vector<double> &mean_, double old_energ
   }
 }
 
+void MetainferenceBase::deferredSigmaMC()
+{
+  // this runs on the helper thread while the MD engine is computing forces;
+  // it only touches the MC snapshot buffers and random[0]/random[2], which
+  // the main thread does not use again before joinDeferredMC. The energy
+  // functions are safe here because they read only state that is constant
+  // until the next call to getScore
+  vector<unsigned> indices;
+  if(MCchunksize_ > 0) {
+    for(unsigned j=0; j<MCsigma_.size(); j++) indices.push_back(j);
+    random[2].Shuffle(indices);
+  }
+
+  vector<double> new_sigma(MCsigma_.size());
+  for(unsigned i=0; i<MCsteps_; ++i) {
+    MCdeftrial_++;
+    new_sigma = MCsigma_;
+    bool breaknow = false;
+
+    // propose a move, with the same chunking and reflective boundaries as moveSigmas
+    if(MCchunksize_ > 0) {
+      if((MCchunksize_ * i) >= MCsigma_.size()) breaknow = true;
+      for(unsigned j=0; j<MCchunksize_; j++) {
+        const unsigned shuffle_index = j + MCchunksize_ * i;
+        if(shuffle_index >= MCsigma_.size()) break;
+        const unsigned index = indices[shuffle_index];
+        const double ds2 = Dsigma_[index]*random[0].Gaussian();
+        new_sigma[index] = MCsigma_[index] + ds2;
+        if(new_sigma[index] > sigma_max_[index]) {new_sigma[index] = 2.0 * sigma_max_[index] - new_sigma[index];}
+        if(new_sigma[index] < sigma_min_[index]) {new_sigma[index] = 2.0 * sigma_min_[index] - new_sigma[index];}
+      }
+    } else {
+      for(unsigned j=0; j<MCsigma_.size(); j++) {
+        const double ds2 = Dsigma_[j]*random[0].Gaussian();
+        new_sigma[j] = MCsigma_[j] + ds2;
+        if(new_sigma[j] > sigma_max_[j]) {new_sigma[j] = 2.0 * sigma_max_[j] - new_sigma[j];}
+        if(new_sigma[j] < sigma_min_[j]) {new_sigma[j] = 2.0 * sigma_min_[j] - new_sigma[j];}
+      }
+    }
+    if(breaknow) break;
+
+    double new_energy = 0.;
+    switch(noise_type_) {
+    case GAUSS:
+      new_energy = getEnergyGJ(MCmean_,new_sigma,scale_,offset_);
+      break;
+    case MGAUSS:
+      new_energy = getEnergyGJE(MCmean_,new_sigma,scale_,offset_);
+      break;
+    case OUTLIERS:
+      new_energy = getEnergySP(MCmean_,new_sigma,scale_,offset_);
+      break;
+    case MOUTLIERS:
+      new_energy = getEnergySPE(MCmean_,new_sigma,scale_,offset_);
+      break;
+    case GENERIC:
+      // excluded at setup
+      break;
+    }
+
+    // same acceptance as moveSigmas: every proposal is compared with the
+    // energy at the step boundary
+    const double delta = ( new_energy - MColdene_ ) / kbt_;
+    if( delta <= 0.0 || random[0].RandU01() < exp(-delta) ) {
+      MCsigma_ = new_sigma;
+      MCdefaccept_++;
+    }
+  }
+}
+
+void MetainferenceBase::joinDeferredMC()
+{
+  if(!MCthread_.joinable()) return;
+  MCthread_.join();
+  // commit the parameters sampled by the helper thread
+  sigma_ = MCsigma_;
+  MCtrial_ += MCdeftrial_;
+  MCaccept_ += MCdefaccept_;
+  for(unsigned i=0; i<sigma_.size(); i++) valueSigma[i]->set(sigma_[i]);
+  if(MCtrial_>0) valueAccept->set(static_cast<double>(MCaccept_) / static_cast<double>(MCtrial_));
+}
+
 double MetainferenceBase::doMonteCarlo(const vector<double> &mean_)
 {
   // calculate old energy with the updated coordinates
@@ -1038,7 +1138,18 @@ double MetainferenceBase::doMonteCarlo(const vector<double> &mean_)
   }
 
   // do not run MC if this is a replica-exchange trial
-  if(!getExchangeStep()) {
+  if(MCdeferred_&&!getExchangeStep()) {
+    // launch the sigma sampling on a helper thread using a snapshot of the
+    // averaged deviations; the result is committed by joinDeferredMC at the
+    // beginning of the next step
+    MCmean_ = mean_;
+    MCsigma_ = sigma_;
+    MColdene_ = old_energy;
+    MCdeftrial_ = 0;
+    MCdefaccept_ = 0;
+    for(unsigned i=0; i<sigma_.size(); i++) valueSigma[i]->set(sigma_[i]);
+    MCthread_ = std::thread(&MetainferenceBase::deferredSigmaMC, this);
+  } else if(!getExchangeStep()) {
 
     // Create vector of random sigma indices
     vector<unsigned> indices;
@@ -1122,7 +1233,7 @@ void MetainferenceBase::getEnergyForceSP(const vector<double> &mean, const vecto
       }
     }
     // collect contribution to forces and energy from other replicas
-    if(nrep_>1) multi_sim_comm.Sum(&f[0],narg);
+    if(nrep_>1) sum_replicas_async(&f[0], narg, async_force_others_);
   }
   // intra-replica summation
   comm.Sum(&f[0],narg);
@@ -1161,7 +1272,7 @@ void MetainferenceBase::getEnergyForceSPE(const vector<double> &mean, const vect
       }
     }
     // collect contribution to forces and energy from other replicas
-    if(nrep_>1) multi_sim_comm.Sum(&f[0],narg);
+    if(nrep_>1) sum_replicas_async(&f[0], narg, async_force_others_);
   }
   comm.Sum(&f[0],narg);
 
@@ -1185,7 +1296,7 @@ void MetainferenceBase::getEnergyForceGJ(const vector<double> &mean, const vecto
 
   if(master) {
     inv_s2 = 1./(sigma_[0]*sigma_[0] + scale2*sigma_mean2_[0]);
-    if(nrep_>1) multi_sim_comm.Sum(inv_s2);
+    if(nrep_>1) sum_replicas_async(&inv_s2, 1, async_is2_others_);
   }
   comm.Sum(inv_s2);
 
@@ -1215,7 +1326,7 @@ void MetainferenceBase::getEnergyForceGJE(const vector<double> &mean, const vect
 
   if(master) {
     for(unsigned i=0; i<sigma_.size(); ++i) inv_s2[i] = 1./(sigma_[i]*sigma_[i] + scale2*sigma_mean2_[i]);
-    if(nrep_>1) multi_sim_comm.Sum(&inv_s2[0],sigma_.size());
+    if(nrep_>1) sum_replicas_async(&inv_s2[0], sigma_.size(), async_is2_others_);
   }
   comm.Sum(&inv_s2[0],sigma_.size());
 
@@ -1251,8 +1362,8 @@ void MetainferenceBase::getEnergyForceMIGEN(const vector<double> &mean, const ve
     }
   }
   if(master&&nrep_>1) {
-    multi_sim_comm.Sum(&dev[0],dev.size());
-    multi_sim_comm.Sum(&dev2[0],dev2.size());
+    sum_replicas_async(&dev[0], dev.size(), async_dev_others_);
+    sum_replicas_async(&dev2[0], dev2.size(), async_dev2_others_);
   }
   comm.Sum(&dev[0],dev.size());
   comm.Sum(&dev2[0],dev2.size());
@@ -1274,6 +1385,22 @@ void MetainferenceBase::getEnergyForceMIGEN(const vector<double> &mean, const ve
   }
 }
 
+// cross-replica reduction with bounded staleness: on synchronization steps
+// the buffer is summed across the replicas and the contribution of the other
+// replicas is cached, on the steps in between the cached contribution is
+// added to the fresh local one
+void MetainferenceBase::sum_replicas_async(double* buf, unsigned n, vector<double> &others)
+{
+  if(!async_stale_now_) {
+    vector<double> own(buf, buf+n);
+    multi_sim_comm.Sum(buf, n);
+    others.resize(n);
+    for(unsigned i=0; i<n; ++i) others[i] = buf[i]-own[i];
+  } else {
+    for(unsigned i=0; i<n; ++i) buf[i] += others[i];
+  }
+}
+
 void MetainferenceBase::get_weights(double &fact, double &var_fact)
 {
   const double dnrep    = static_cast<double>(nrep_);
@@ -1286,7 +1413,7 @@ void MetainferenceBase::get_weights(double &fact, double &var_fact)
     vector<double> bias(nrep_,0);
     if(master) {
       bias[replica_] = getArgument(0);
-      if(nrep_>1) multi_sim_comm.Sum(&bias[0], nrep_);
+      if(nrep_>1) sum_replicas_async(&bias[0], nrep_, async_bias_others_);
     }
     comm.Sum(&bias[0], nrep_);
 
@@ -1345,7 +1472,7 @@ void MetainferenceBase::get_sigma_mean(const double fact, const double var_fact,
           double tmp2 = -2.*mean[i]*(fact-ave_fact)*(fact*getCalcData(i)-ave_fact*mean[i]);
           sigma_mean2_now[i] = tmp1 + tmp2;
         }
-        if(nrep_>1) multi_sim_comm.Sum(&sigma_mean2_now[0], narg);
+        if(nrep_>1) sum_replicas_async(&sigma_mean2_now[0], narg, async_sm2_others_);
       }
       comm.Sum(&sigma_mean2_now[0], narg);
       for(unsigned i=0; i<narg; ++i) sigma_mean2_now[i] = dnrep/(dnrep-1.)*(sigma_mean2_now[i] + mean[i]*mean[i]*var_fact);
@@ -1355,7 +1482,7 @@ void MetainferenceBase::get_sigma_mean(const double fact, const double var_fact,
           double tmp  = getCalcData(i)-mean[i];
           sigma_mean2_now[i] = fact*tmp*tmp;
         }
-        if(nrep_>1) multi_sim_comm.Sum(&sigma_mean2_now[0], narg);
+        if(nrep_>1) sum_replicas_async(&sigma_mean2_now[0], narg, async_sm2_others_);
       }
       comm.Sum(&sigma_mean2_now[0], narg);
       for(unsigned i=0; i<narg; ++i) sigma_mean2_now[i] /= dnrep;
@@ -1426,7 +1553,7 @@ void MetainferenceBase::replica_averaging(const double fact, vector<double> &mea
 {
   if(master) {
     for(unsigned i=0; i<narg; ++i) mean[i] = fact*calc_data_[i];
-    if(nrep_>1) multi_sim_comm.Sum(&mean[0], narg);
+    if(nrep_>1) sum_replicas_async(&mean[0], narg, async_mean_others_);
   }
   comm.Sum(&mean[0], narg);
   // set the derivative of the mean with respect to the bias
@@ -1455,6 +1582,12 @@ void MetainferenceBase::do_regression_zero(const vector<double> &mean)
 double MetainferenceBase::getScore()
 {
   /* Metainference */
+  // wait for the Monte Carlo launched at the previous step and commit the
+  // sampled parameters before anything below reads or updates them
+  if(MCdeferred_) joinDeferredMC();
+  // decide whether this step reuses the cached cross-replica contributions
+  async_stale_now_ = (async_stride_>1 && async_ready_ && !getExchangeStep() && (getStep()%async_stride_)!=0);
+
   /* 1) collect weights */
   double fact = 0.;
   double var_fact = 0.;
@@ -1497,6 +1630,8 @@ double MetainferenceBase::getScore()
     break;
   }
 
+  if(!async_stale_now_) async_ready_=true;
+
   return ene;
 }
 
@@ -28,6 +28,7 @@
 #include "core/PlumedMain.h"
 #include "tools/Random.h"
 #include "tools/OpenMP.h"
+#include <thread>
 
 #define PLUMED_METAINF_INIT(ao) Action(ao),MetainferenceBase(ao)
 
@@ -108,6 +109,16 @@ private:
   long unsigned MCacceptFT_;
   long unsigned MCtrial_;
   unsigned MCchunksize_;
+  // deferred MC: the sigma sampling runs on a helper thread between force
+  // calls, using a snapshot of the averaged deviations; the new parameters
+  // are committed at the beginning of the next step
+  bool MCdeferred_;
+  std::thread MCthread_;
+  std::vector<double> MCmean_;
+  std::vector<double> MCsigma_;
+  double MColdene_;
+  long unsigned MCdefaccept_;
+  long unsigned MCdeftrial_;
 
   // output
   Value*   valueScore;
@@ -151,6 +162,21 @@ private:
   double decay_w_;
   std::vector< std::vector <double> >  average_weights_;
 
+  // bounded-staleness replica communication: when async_stride_ is larger
+  // than one the cross-replica reductions run only every async_stride_ steps
+  // and in between the cached contribution of the other replicas is reused
+  unsigned async_stride_;
+  bool     async_ready_;
+  bool     async_stale_now_;
+  std::vector<double> async_bias_others_;
+  std::vector<double> async_mean_others_;
+  std::vector<double> async_sm2_others_;
+  std::vector<double> async_force_others_;
+  std::vector<double> async_is2_others_;
+  std::vector<double> async_dev_others_;
+  std::vector<double> async_dev2_others_;
+  void sum_replicas_async(double* buf, unsigned n, std::vector<double> &others);
+
   double getEnergyMIGEN(const std::vector<double> &mean, const std::vector<double> &ftilde, const std::vector<double> &sigma,
                         const double scale, const double offset);
   double getEnergySP(const std::vector<double> &mean, const std::vector<double> &sigma,
@@ -176,6 +202,8 @@ private:
   void moveScaleOffset(const std::vector<double> &mean_, double old_energy);
   void moveSigmas(const std::vector<double> &mean_, double old_energy, const unsigned i, const std::vector<unsigned> &indices, bool breaknow);
   double doMonteCarlo(const std::vector<double> &mean);
+  void deferredSigmaMC();
+  void joinDeferredMC();
 
 
 public:
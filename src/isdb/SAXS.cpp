@@ -30,6 +30,7 @@
 #include "core/ActionSet.h"
 #include "core/GenericMolInfo.h"
 #include "tools/Communicator.h"
+#include "tools/FastMath.h"
 #include "tools/Pbc.h"
 
 #include <string>
@@ -123,7 +124,12 @@ private:
   bool                       pbc;
   bool                       serial;
   bool                       gpu;
+  bool                       histapprox;
   int                        deviceid;
+  double                     hist_dr;
+  unsigned                   hist_nbins;
+  vector<double>             hist_tab;
+  vector<double>             FF_atom;
   vector<unsigned>           atoi;
   vector<double>             q_list;
   vector<double>             FF_rank;
@@ -132,6 +138,8 @@ private:
 
   void calculate_gpu(vector<Vector> &deriv);
   void calculate_cpu(vector<Vector> &deriv);
+  void calculate_cpu_hist(vector<Vector> &deriv);
+  void updateHistTables(double rmax);
   void getMartiniSFparam(const vector<AtomNumber> &atoms, vector<vector<long double> > &parameter);
   double calculateASF(const vector<AtomNumber> &atoms, vector<vector<long double> > &FF_tmp, const double rho);
 
@@ -151,6 +159,8 @@ void SAXS::registerKeywords(Keywords& keys) {
   keys.addFlag("SERIAL",false,"Perform the calculation in serial - for debug purpose");
   keys.add("compulsory","DEVICEID","0","Identifier of the GPU to be used");
   keys.addFlag("GPU",false,"calculate SAXS using ARRAYFIRE on an accelerator device");
+  keys.addFlag("HISTOGRAM",false,"evaluate the Debye sum on a binned pair-distance grid: sin(qr)/qr and its derivative factor are tabulated on a fine radial grid and linearly interpolated, removing all the trigonometric functions from the pair loop at the price of a small, controllable error");
+  keys.add("compulsory","HISTOGRAM_DR","0.005","width in nm of the radial bins used with HISTOGRAM, the relative error on the intensities scales as the square of the product of this width with the largest q value");
   keys.addFlag("ATOMISTIC",false,"calculate SAXS for an atomistic model");
   keys.addFlag("MARTINI",false,"calculate SAXS for a Martini model");
   keys.add("atoms","ATOMS","The atoms to be included in the calculation, e.g. the whole protein.");
@@ -168,7 +178,10 @@ SAXS::SAXS(const ActionOptions&ao):
   pbc(true),
   serial(false),
   gpu(false),
-  deviceid(0)
+  histapprox(false),
+  deviceid(0),
+  hist_dr(0.005),
+  hist_nbins(0)
 {
   vector<AtomNumber> atoms;
   parseAtomList("ATOMS",atoms);
@@ -187,6 +200,14 @@ SAXS::SAXS(const ActionOptions&ao):
   if(gpu) error("To use the GPU mode PLUMED must be compiled with ARRAYFIRE");
 #endif
 
+  parseFlag("HISTOGRAM",histapprox);
+  parse("HISTOGRAM_DR",hist_dr);
+  if(histapprox) {
+    if(gpu) error("HISTOGRAM cannot be used together with GPU");
+    if(hist_dr<=0.) error("HISTOGRAM_DR must be larger than zero");
+    log.printf("  evaluating the Debye sum on a binned pair-distance grid with bins of %lf nm\n",hist_dr);
+  }
+
   parse("DEVICEID",deviceid);
 #ifdef  __PLUMED_HAS_ARRAYFIRE
   if(gpu) {
@@ -294,6 +315,12 @@ SAXS::SAXS(const ActionOptions&ao):
       for(unsigned i=0; i<n_atom_types; i++) FF_value[i][k] = static_cast<double>(FF_tmp[k][i])/sqrt(scale_int);
       for(unsigned i=0; i<size; i++) FF_rank[k] += FF_value[atoi[i]][k]*FF_value[atoi[i]][k];
     }
+    // atom-major copy of the scattering factors: the pair loops read the
+    // factors of atom j for all the q values contiguously
+    FF_atom.resize(static_cast<size_t>(size)*numq);
+    for(unsigned i=0; i<size; i++) {
+      for(unsigned k=0; k<numq; k++) FF_atom[static_cast<size_t>(i)*numq+k] = FF_value[atoi[i]][k];
+    }
   } else {
     FFf_value.resize(numq,vector<float>(size));
     for(unsigned k=0; k<numq; ++k) {
@@ -471,6 +498,133 @@ void SAXS::calculate_cpu(vector<Vector> &deriv)
     rank   = 0;
   }
 
+  vector<double> sum(numq,0);
+  unsigned nt=OpenMP::getNumThreads();
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<Vector> omp_deriv(deriv.size());
+    std::vector<double> omp_sum(numq,0);
+    constexpr unsigned bsz=64;
+    double md[bsz], qdist[bsz], sb[bsz], cb[bsz];
+    Vector cd[bsz];
+    #pragma omp for nowait
+    for (unsigned i=rank; i<size-1; i+=stride) {
+      Vector posi = getPosition(i);
+      const double* FFi = &FF_atom[static_cast<size_t>(i)*numq];
+      // work on blocks of pairs so that the distances can be gathered first
+      // and the trigonometric kernel runs on a contiguous vectorizable array
+      for (unsigned j0=i+1; j0<size ; j0+=bsz) {
+        const unsigned nb = std::min(bsz,size-j0);
+        for (unsigned jj=0; jj<nb; jj++) {
+          Vector c_distances = delta(posi,getPosition(j0+jj));
+          double m_distances = c_distances.modulo();
+          md[jj] = m_distances;
+          cd[jj] = c_distances/m_distances/m_distances;
+        }
+        for (unsigned k=0; k<numq; k++) {
+          unsigned kdx=k*size;
+          const double qk = q_list[k];
+          const double fi2 = 2.*FFi[k];
+          for (unsigned jj=0; jj<nb; jj++) qdist[jj]=qk*md[jj];
+          FastMath::sincos(qdist,sb,cb,nb);
+          for (unsigned jj=0; jj<nb; jj++) {
+            const unsigned j=j0+jj;
+            double FFF = fi2*FF_atom[static_cast<size_t>(j)*numq+k];
+            double tsq = sb[jj]/qdist[jj];
+            double tcq = cb[jj];
+            double tmp = FFF*(tcq-tsq);
+            Vector dd  = cd[jj]*tmp;
+            if(nt>1) {
+              omp_deriv[kdx+i] -=dd;
+              omp_deriv[kdx+j] +=dd;
+              omp_sum[k] += FFF*tsq;
+            } else {
+              deriv[kdx+i] -= dd;
+              deriv[kdx+j] += dd;
+              sum[k]       += FFF*tsq;
+            }
+          }
+        }
+      }
+    }
+    #pragma omp critical
+    if(nt>1) {
+      for(unsigned i=0; i<deriv.size(); i++) deriv[i]+=omp_deriv[i];
+      for(unsigned k=0; k<numq; k++) sum[k]+=omp_sum[k];
+    }
+  }
+
+  if(!serial) {
+    comm.Sum(&deriv[0][0], 3*deriv.size());
+    comm.Sum(&sum[0], numq);
+  }
+
+  for (unsigned k=0; k<numq; k++) {
+    sum[k]+=FF_rank[k];
+    string num; Tools::convert(k,num);
+    Value* val=getPntrToComponent("q-"+num);
+    val->set(sum[k]);
+    if(getDoScore()) setCalcData(k, sum[k]);
+  }
+}
+
+// extend, if needed, the tables of sin(qr)/qr and of the derivative factor
+// cos(qr)-sin(qr)/qr up to rmax. The tables are stored bin-major with the
+// two entries for all the q values contiguous, so that the k loop in
+// calculate_cpu_hist reads consecutive memory
+void SAXS::updateHistTables(double rmax)
+{
+  const unsigned numq = q_list.size();
+  const unsigned rowsz = 2*numq;
+  // one extra bin so that linear interpolation can always read bin+1
+  const unsigned needed = static_cast<unsigned>(std::floor(rmax/hist_dr))+2;
+  if(needed<=hist_nbins) return;
+  hist_tab.resize(static_cast<size_t>(needed)*rowsz);
+  for(unsigned b=hist_nbins; b<needed; b++) {
+    const double r = b*hist_dr;
+    for(unsigned k=0; k<numq; k++) {
+      double tsq, tdf;
+      if(b==0) {
+        tsq = 1.0; tdf = 0.0;
+      } else {
+        const double qr = q_list[k]*r;
+        tsq = sin(qr)/qr;
+        tdf = cos(qr)-tsq;
+      }
+      hist_tab[static_cast<size_t>(b)*rowsz+2*k]   = tsq;
+      hist_tab[static_cast<size_t>(b)*rowsz+2*k+1] = tdf;
+    }
+  }
+  hist_nbins = needed;
+}
+
+void SAXS::calculate_cpu_hist(vector<Vector> &deriv)
+{
+  const unsigned size = getNumberOfAtoms();
+  const unsigned numq = q_list.size();
+  const unsigned rowsz = 2*numq;
+
+  unsigned stride = comm.Get_size();
+  unsigned rank   = comm.Get_rank();
+  if(serial) {
+    stride = 1;
+    rank   = 0;
+  }
+
+  // after makeWhole the distances are plain differences, so the diagonal of
+  // the bounding box bounds all of them and sets the size of the tables
+  Vector bmin = getPosition(0);
+  Vector bmax = bmin;
+  for(unsigned i=1; i<size; i++) {
+    const Vector & p(getPosition(i));
+    for(unsigned l=0; l<3; l++) {
+      if(p[l]<bmin[l]) bmin[l]=p[l];
+      if(p[l]>bmax[l]) bmax[l]=p[l];
+    }
+  }
+  updateHistTables(delta(bmin,bmax).modulo());
+  const double inv_dr = 1./hist_dr;
+
   vector<double> sum(numq,0);
   unsigned nt=OpenMP::getNumThreads();
   #pragma omp parallel num_threads(nt)
@@ -480,17 +634,23 @@ void SAXS::calculate_cpu(vector<Vector> &deriv)
     #pragma omp for nowait
     for (unsigned i=rank; i<size-1; i+=stride) {
       Vector posi = getPosition(i);
+      const double* FFi = &FF_atom[static_cast<size_t>(i)*numq];
       for (unsigned j=i+1; j<size ; j++) {
         Vector c_distances = delta(posi,getPosition(j));
         double m_distances = c_distances.modulo();
         c_distances = c_distances/m_distances/m_distances;
+        const double rb = m_distances*inv_dr;
+        const unsigned bin = static_cast<unsigned>(rb);
+        const double t = rb-bin;
+        const double* row0 = &hist_tab[static_cast<size_t>(bin)*rowsz];
+        const double* row1 = row0+rowsz;
+        const double* FFj = &FF_atom[static_cast<size_t>(j)*numq];
         for (unsigned k=0; k<numq; k++) {
           unsigned kdx=k*size;
-          double qdist = q_list[k]*m_distances;
-          double FFF = 2.*FF_value[atoi[i]][k]*FF_value[atoi[j]][k];
-          double tsq = sin(qdist)/qdist;
-          double tcq = cos(qdist);
-          double tmp = FFF*(tcq-tsq);
+          double FFF = 2.*FFi[k]*FFj[k];
+          double tsq = row0[2*k]   + t*(row1[2*k]  -row0[2*k]);
+          double tdf = row0[2*k+1] + t*(row1[2*k+1]-row0[2*k+1]);
+          double tmp = FFF*tdf;
           Vector dd  = c_distances*tmp;
           if(nt>1) {
             omp_deriv[kdx+i] -=dd;
@@ -534,6 +694,7 @@ void SAXS::calculate()
 
   vector<Vector> deriv(numq*size);
   if(gpu) calculate_gpu(deriv);
+  else if(histapprox) calculate_cpu_hist(deriv);
   else calculate_cpu(deriv);
 
   if(getDoScore()) {
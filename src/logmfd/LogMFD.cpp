@@ -354,6 +354,7 @@ replica.out.1
 #include "core/ActionRegister.h"
 #include "core/Atoms.h"
 #include "core/PlumedMain.h"
+#include "tools/OpenMP.h"
 
 #include <iostream>
 
@@ -821,8 +822,14 @@ void LogMFD::calculate() {
   } // firsttime
 
   // calculate force for fictitious variable
+  // every CV accumulates into its own slot of ffict/fict_ave, so the loop
+  // threads without partial buffers; only the energy needs a reduction
   double ene=0.0;
-  for(unsigned i=0; i<getNumberOfArguments(); ++i) {
+  const unsigned nargs=getNumberOfArguments();
+  unsigned nt=OpenMP::getNumThreads();
+  if(nt*8>nargs) nt=1;
+  #pragma omp parallel for num_threads(nt) reduction(+:ene)
+  for(unsigned i=0; i<nargs; ++i) {
     // difference between fictitious variable and collective variable.
     const double diff = difference(i,fict[i],getArgument(i));
     // restraining force.
@@ -965,6 +972,11 @@ void LogMFD::updateNVT() {
     vfict_backup[i] = vfict[i];
   }
 
+  // veta does not change until the end of this function, so the thermostat
+  // scaling factor is evaluated once instead of twice per variable and
+  // iteration
+  const double expfac = exp(-0.25*dt*veta);
+
   const int niter=5;
   for(unsigned j=0; j<niter; ++j) {
     // get latest free energy and flattening coefficient
@@ -978,9 +990,9 @@ void LogMFD::updateNVT() {
 
     // evolve vfict from vfict_backup by dt/2
     for(unsigned m=0; m<getNumberOfArguments(); ++m) {
-      vfict[m] *= exp(-0.25*dt*veta);
+      vfict[m] *= expfac;
       vfict[m] += 0.5*dt*clog*ffict[m]/mfict[m];
-      vfict[m] *= exp(-0.25*dt*veta);
+      vfict[m] *= expfac;
     }
   }
 
@@ -990,9 +1002,9 @@ void LogMFD::updateNVT() {
 
   // evolve vfict by dt/2, and evolve fict by dt
   for(unsigned i=0; i<getNumberOfArguments(); ++i) {
-    vfict[i] *= exp(-0.25*dt*veta);
+    vfict[i] *= expfac;
     vfict[i] += 0.5*dt*clog*ffict[i]/mfict[i];
-    vfict[i] *= exp(-0.25*dt*veta);
+    vfict[i] *= expfac;
     fict[i]  += dt*vfict[i];
   }
 
@@ -89,6 +89,7 @@ LWalls::LWalls(const ActionOptions& ao):
   parse("EXP",exp);
   parse("KAPPA",kappa);
   checkRead();
+  setWallParameters( kappa, at, offset, eps, exp, -1.0 );
 }
 
 double LWalls::calcPotential( const double& val, double& df ) const {
@@ -41,7 +41,10 @@ ManyRestraintsBase::ManyRestraintsBase(const ActionOptions& ao):
   ActionWithValue(ao),
   ActionPilot(ao),
   ActionWithVessel(ao),
-  ActionWithInputVessel(ao)
+  ActionWithInputVessel(ao),
+  simplewall(false),
+  wall_kappa(0.0), wall_at(0.0), wall_offset(0.0), wall_eps(1.0), wall_exp(2.0), wall_dir(1.0),
+  wall_iexp(0)
 {
   // Read in the vessel we are action on
   readArgument("bridge");
@@ -62,6 +65,15 @@ ManyRestraintsBase::ManyRestraintsBase(const ActionOptions& ao):
   readVesselKeywords();
 }
 
+void ManyRestraintsBase::setWallParameters( const double& kappa, const double& at, const double& offset, const double& eps, const double& wexp, const double& dir ) {
+  simplewall=true;
+  wall_kappa=kappa; wall_at=at; wall_offset=offset; wall_eps=eps; wall_exp=wexp; wall_dir=dir;
+  // integral exponents (the default EXP=2 in particular) are evaluated with
+  // repeated multiplication rather than pow in the task loop
+  wall_iexp=static_cast<int>(wexp);
+  if( static_cast<double>(wall_iexp)!=wexp || wall_iexp<=0 ) wall_iexp=0;
+}
+
 void ManyRestraintsBase::doJobsRequiredBeforeTaskList() {
   ActionWithVessel::doJobsRequiredBeforeTaskList();
   ActionWithValue::clearDerivatives();
@@ -70,8 +82,22 @@ void ManyRestraintsBase::doJobsRequiredBeforeTaskList() {
 void ManyRestraintsBase::transformBridgedDerivatives( const unsigned& current, MultiValue& invals, MultiValue& outvals ) const {
   outvals.setValue( 0, invals.get(0) );
 
-  // Get the potential
-  double dval=0, val=calcPotential( invals.get(1), dval );
+  // Get the potential.  The standard walls are evaluated inline from the
+  // packed parameters: with tens of thousands of restraints the virtual
+  // dispatch and the call to pow dominate over the wall arithmetic
+  double dval=0, val;
+  if( simplewall ) {
+    double uscale = ( invals.get(1) - wall_at + wall_offset )/wall_eps;
+    if( wall_dir*uscale > 0. ) {
+      double power = (wall_iexp>0) ? Tools::fastpow( uscale, wall_iexp ) : pow( uscale, wall_exp );
+      dval = ( wall_kappa / wall_eps ) * wall_exp * power / uscale;
+      val = wall_kappa*power;
+    } else {
+      val = 0.0;
+    }
+  } else {
+    val=calcPotential( invals.get(1), dval );
+  }
 
   outvals.setValue( 1, val );
   for(unsigned i=0; i<invals.getNumberActive(); ++i) {
@@ -40,6 +40,16 @@ class ManyRestraintsBase :
 private:
 /// Pointer to underlying action with vessel
   vesselbase::ActionWithVessel* aves;
+/// Parameters of the standard wall potential, packed here by UWalls and
+/// LWalls so that the per-task evaluation does not go through the virtual
+/// calcPotential and can use an integer power fast path
+  bool simplewall;
+  double wall_kappa, wall_at, wall_offset, wall_eps, wall_exp, wall_dir;
+  int wall_iexp;
+protected:
+/// To be called from the constructor of subclasses implementing the standard
+/// wall form; dir is +1.0 for an upper wall and -1.0 for a lower wall
+  void setWallParameters( const double& kappa, const double& at, const double& offset, const double& eps, const double& wexp, const double& dir );
 public:
   static void registerKeywords( Keywords& keys );
   explicit ManyRestraintsBase(const ActionOptions&);
@@ -93,6 +93,7 @@ UWalls::UWalls(const ActionOptions& ao):
   parse("EXP",exp);
   parse("KAPPA",kappa);
   checkRead();
+  setWallParameters( kappa, at, offset, eps, exp, +1.0 );
 }
 
 double UWalls::calcPotential( const double& val, double& df ) const {
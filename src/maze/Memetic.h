@@ -337,9 +337,18 @@ void Memetic::initialize_members() {
 }
 
 void Memetic::score_members() {
-  for (size_t i = 0; i < members_.size(); ++i) {
-    double s = score_member(members_[i].translation);
-    members_[i].score=s;
+  // score the population in parallel: every member scans the full neighbor
+  // list, so one thread per member scales better than one parallel region
+  // per member (the nested region in score_member stays inactive here)
+  const size_t n_members = members_.size();
+  unsigned int nt = get_n_threads_openmp();
+  if (nt > n_members) {
+    nt = n_members;
+  }
+
+  #pragma omp parallel for num_threads(nt) schedule(dynamic)
+  for (size_t i = 0; i < n_members; ++i) {
+    members_[i].score = score_member(members_[i].translation);
   }
 }
 
@@ -660,7 +669,6 @@ bool Memetic::out_of_bounds(double v) {
 
 double Memetic::score_member(const Vector& coding) {
   double action = 0;
-  Vector distance;
   const unsigned nl_size = neighbor_list_->size();
   Vector dev = coding;
 
@@ -675,6 +683,8 @@ double Memetic::score_member(const Vector& coding) {
         continue;
       }
 
+      // the distance has to be private to each thread
+      Vector distance;
       if (pbc_) {
         distance = pbcDistance(getPosition(i0) + dev, getPosition(i1));
       }
@@ -415,7 +415,6 @@ void Optimizer::prepare() {
 
 double Optimizer::score() {
   const unsigned nl_size = neighbor_list_->size();
-  Vector distance;
   double function = 0;
 
   #pragma omp parallel num_threads(n_threads_)
@@ -429,6 +428,8 @@ double Optimizer::score() {
         continue;
       }
 
+      // the distance has to be private to each thread
+      Vector distance;
       if (pbc_) {
         distance = pbcDistance(getPosition(i0), getPosition(i1));
       }
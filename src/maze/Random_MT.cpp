@@ -34,13 +34,16 @@ namespace PLMD {
 namespace maze {
 
 std::mt19937_64& rnd::mt_eng() {
-  static std::mt19937_64 mt{};
+  // one engine per thread, each stream seeded with a distinct offset, so
+  // that parallel sections can draw random numbers without locking and
+  // without sharing a single stream between threads
+  static thread_local std::mt19937_64 mt{std::mt19937_64::default_seed + OpenMP::getThreadNum()};
 
   return mt;
 }
 
 double rnd::next_double(double f, double e) {
-  static std::uniform_real_distribution<double> dist_double(f, e);
+  static thread_local std::uniform_real_distribution<double> dist_double(f, e);
   std::uniform_real_distribution<double>::param_type p(f, e);
   dist_double.param(p);
 
@@ -48,7 +51,7 @@ double rnd::next_double(double f, double e) {
 }
 
 double rnd::next_double() {
-  static std::uniform_real_distribution<double> dist_double(0, 1);
+  static thread_local std::uniform_real_distribution<double> dist_double(0, 1);
   std::uniform_real_distribution<double>::param_type p(0, 1);
   dist_double.param(p);
 
@@ -56,7 +59,7 @@ double rnd::next_double() {
 }
 
 int rnd::next_int(int e) {
-  static std::uniform_int_distribution<int> dist_int(0, e-1);
+  static thread_local std::uniform_int_distribution<int> dist_int(0, e-1);
   std::uniform_int_distribution<int>::param_type p(0, e-1);
   dist_int.param(p);
 
@@ -64,7 +67,7 @@ int rnd::next_int(int e) {
 }
 
 int rnd::next_int(int f, int e) {
-  static std::uniform_int_distribution<int> dist_int(f, e-1);
+  static thread_local std::uniform_int_distribution<int> dist_int(f, e-1);
   std::uniform_int_distribution<int>::param_type p(f, e-1);
   dist_int.param(p);
 
@@ -72,7 +75,7 @@ int rnd::next_int(int f, int e) {
 }
 
 double rnd::next_cauchy(double m, double s) {
-  static std::cauchy_distribution<double> dist_cauchy(m, s);
+  static thread_local std::cauchy_distribution<double> dist_cauchy(m, s);
 
   return dist_cauchy(mt_eng());
 }
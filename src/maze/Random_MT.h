@@ -29,6 +29,7 @@ along with maze. If not, see <https://www.gnu.org/licenses/>.
  */
 
 #include "Core.h"
+#include "tools/OpenMP.h"
 
 namespace PLMD {
 namespace maze {
@@ -45,11 +46,14 @@ class rnd {
 public:
   /**
    * Initialize MT sampler engine based on std::mt19937_64.
+   *
+   * Each thread owns an independent stream, so random numbers can be drawn
+   * inside OpenMP regions without locking.
    */
   static std::mt19937_64& mt_eng();
 
   /**
-   * Feed a random seed.
+   * Feed a random seed to the stream of the calling thread.
    */
   static void randomize();
 
@@ -147,7 +151,7 @@ inline double rnd::next_double(double e) {
 }
 
 inline void rnd::randomize() {
-  mt_eng().seed(time(0));
+  mt_eng().seed(time(0) + OpenMP::getThreadNum());
 }
 
 } // namespace maze
@@ -51,6 +51,9 @@ ActionVolume::ActionVolume(const ActionOptions&ao):
   parseFlag("OUTSIDE",not_in); sigma=0.0;
   if( keywords.exists("SIGMA") ) parse("SIGMA",sigma);
   if( keywords.exists("KERNEL") ) parse("KERNEL",kerneltype);
+  // atoms that stay more than this far away from the boundary of the region
+  // can keep their classification from the previous step
+  mask_margin=sigma;
 
   if( getPntrToMultiColvar()->isDensity() ) {
     std::string input;
@@ -59,11 +62,65 @@ ActionVolume::ActionVolume(const ActionOptions&ao):
   readVesselKeywords();
 }
 
+void ActionVolume::doJobsRequiredBeforeTaskList() {
+  // this retrieves the atoms and sets up the regions
+  VolumeGradientBase::doJobsRequiredBeforeTaskList();
+  updateRegionMasks();
+}
+
+void ActionVolume::updateRegionMasks() {
+  // the machinery for numerical derivatives displaces the atoms without any
+  // opportunity to refresh the masks so everything is treated as boundary
+  if( mask_margin<=0.0 || checkNumericalDerivatives() ) return;
+
+  MultiColvarBase* mcolv=getPntrToMultiColvar();
+  const unsigned ntasks=mcolv->getFullNumberOfTasks();
+  bool stale_all=false;
+  if( region_mask.size()!=ntasks ) {
+    region_mask.assign( ntasks, static_cast<unsigned>(mask_stale) );
+    mask_pos.resize( ntasks ); stale_all=true;
+  }
+  // a change in the cell moves the boundaries of the region
+  const Tensor & box( getBox() );
+  for(unsigned i=0; i<3; ++i) {
+    for(unsigned j=0; j<3; ++j) {
+      if( box(i,j)!=mask_box(i,j) ) stale_all=true;
+    }
+  }
+  mask_box=box;
+  // and so does a displacement of any of the atoms that define the region.
+  // Half of the margin is budgeted for these atoms and half for the central
+  // atoms so that the relative displacement stays below the full margin
+  const double half_margin2=0.25*mask_margin*mask_margin;
+  if( mask_refpos.size()!=getNumberOfAtoms() ) { mask_refpos.resize( getNumberOfAtoms() ); stale_all=true; }
+  for(unsigned i=0; i<mask_refpos.size(); ++i) {
+    if( !stale_all && delta( mask_refpos[i], getPosition(i) ).modulo2()>half_margin2 ) stale_all=true;
+  }
+  if( stale_all ) {
+    for(unsigned i=0; i<mask_refpos.size(); ++i) mask_refpos[i]=getPosition(i);
+  }
+  for(unsigned i=0; i<ntasks; ++i) {
+    const Vector cpos( mcolv->getCentralAtomPos( i ) );
+    if( !stale_all && region_mask[i]!=mask_stale && delta( mask_pos[i], cpos ).modulo2()<=half_margin2 ) continue;
+    if( !volumeWithinRange( cpos, mask_margin ) ) region_mask[i]=mask_outside;
+    else if( volumeEntirelyWithinRange( cpos, mask_margin ) ) region_mask[i]=mask_inside;
+    else region_mask[i]=mask_boundary;
+    mask_pos[i]=cpos;
+  }
+}
+
 void ActionVolume::calculateAllVolumes( const unsigned& curr, MultiValue& outvals ) const {
   Vector catom_pos=getPntrToMultiColvar()->getCentralAtomPos( curr );
 
   double weight; Vector wdf; Tensor vir; std::vector<Vector> refders( getNumberOfAtoms() );
-  weight=calculateNumberInside( catom_pos, wdf, vir, refders );
+  unsigned mask=mask_boundary;
+  if( curr<region_mask.size() ) mask=region_mask[curr];
+  // the kernels only have to be evaluated for atoms near the boundary of the
+  // region: deep inside them the weight is one and well outside it is zero,
+  // in both cases with vanishing derivatives
+  if( mask==mask_inside ) weight=1.0;
+  else if( mask==mask_outside ) weight=0.0;
+  else weight=calculateNumberInside( catom_pos, wdf, vir, refders );
   if( not_in ) {
     weight = 1.0 - weight; wdf *= -1.; vir *=-1;
     for(unsigned i=0; i<refders.size(); ++i) refders[i]*=-1;
@@ -80,5 +137,11 @@ bool ActionVolume::inVolumeOfInterest( const unsigned& curr ) const {
   return true;
 }
 
+bool ActionVolume::mayBeInVolumeOfInterest( const Vector& cpos, const double& range ) const {
+  // with OUTSIDE the weight grows as you move away from the region so no cheap bound applies
+  if( not_in ) return true;
+  return volumeWithinRange( cpos, range );
+}
+
 }
 }
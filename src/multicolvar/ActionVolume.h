@@ -37,6 +37,8 @@ coordination number inside that part of the cell.
 
 class ActionVolume : public VolumeGradientBase {
 private:
+/// The possible states of the cached classification of a central atom
+  enum {mask_stale, mask_boundary, mask_inside, mask_outside};
 /// Number of quantities in use in this colvar
   unsigned nquantities;
 /// The value of sigma
@@ -45,6 +47,22 @@ private:
   bool not_in;
 /// The kernel type for this histogram
   std::string kerneltype;
+/// How far atoms can move before they have to be classified again.  The
+/// masks are switched off when this is zero
+  double mask_margin;
+/// Cached classification of the central atom of each task with respect to
+/// the region, see updateRegionMasks
+  std::vector<unsigned> region_mask;
+/// Position of the central atom of each task when it was last classified
+  std::vector<Vector> mask_pos;
+/// Positions of the atoms that define the region when the masks were last checked
+  std::vector<Vector> mask_refpos;
+/// The cell on the step on which the masks were last checked
+  Tensor mask_box;
+/// Reclassify every central atom that has moved by more than the margin as
+/// certainly deep inside the region, certainly well outside it or near its
+/// boundary.  The kernels only have to be evaluated for the boundary atoms
+  void updateRegionMasks();
 protected:
   double getSigma() const ;
   std::string getKernelType() const ;
@@ -58,6 +76,19 @@ public:
 /// This calculates whether or not a particular is inside the box of interest
 /// this is used for neighbour list with volumes
   bool inVolumeOfInterest( const unsigned& curr ) const ;
+/// Could any central atom within range of cpos be inside the volume of interest?
+/// This is used to cull whole blocks of tasks at once and handles the OUTSIDE option
+  bool mayBeInVolumeOfInterest( const Vector& cpos, const double& range ) const ;
+/// Return false only if no point within range of cpos can have a weight above the
+/// tolerance.  The base class accepts everything so volume types that do not
+/// implement a cheap bound are simply never culled
+  virtual bool volumeWithinRange( const Vector& cpos, const double& range ) const { return true; }
+/// Return true only if every point within range of cpos is certain to have a
+/// weight of at least one minus the tolerance.  Together with volumeWithinRange
+/// this lets atoms far from the boundary of the region skip the kernels
+  virtual bool volumeEntirelyWithinRange( const Vector& cpos, const double& range ) const { return false; }
+/// Ensures the cached region masks are up to date before the tasks are run
+  void doJobsRequiredBeforeTaskList() override;
   virtual double calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const=0;
   unsigned getCentralAtomElementIndex();
 };
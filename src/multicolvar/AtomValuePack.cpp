@@ -32,7 +32,8 @@ AtomValuePack::AtomValuePack( MultiValue& vals, MultiColvarBase const * mcolv ):
   natoms(0),
   indices( vals.getIndices() ),
   sort_vector( vals.getSortIndices() ),
-  myatoms( vals.getAtomVector() )
+  myatoms( vals.getAtomVector() ),
+  sep_set(false)
 {
   if( indices.size()!=mcolv->getNumberOfAtoms() ) {
     indices.resize( mcolv->getNumberOfAtoms() );
@@ -51,6 +51,10 @@ private:
   std::vector<Vector>& myatoms;
 /// This is stuff for link cells
   std::vector<unsigned> cells_required;
+/// Separation between the first two atoms cached by calculateWeight, so
+/// that compute does not evaluate the same pbc distance a second time
+  bool sep_set;
+  Vector sep;
 ///
   void addAtomsDerivatives( const unsigned&, const unsigned&, const Vector& );
 ///
@@ -97,6 +101,10 @@ public:
   MultiValue& getUnderlyingMultiValue();
 ///
   void addDerivative( const unsigned&, const unsigned&, const double& );
+/// Cache the separation between the first two atoms
+  void cacheSeparation( const Vector& d );
+/// Retrieve the cached separation; returns false if none was cached
+  bool getCachedSeparation( Vector& d ) const ;
 };
 
 inline
@@ -209,6 +217,17 @@ MultiValue& AtomValuePack::getUnderlyingMultiValue() {
   return myvals;
 }
 
+inline
+void AtomValuePack::cacheSeparation( const Vector& d ) {
+  sep=d; sep_set=true;
+}
+
+inline
+bool AtomValuePack::getCachedSeparation( Vector& d ) const {
+  if( !sep_set ) return false;
+  d=sep; return true;
+}
+
 }
 }
 #endif
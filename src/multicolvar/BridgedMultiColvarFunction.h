@@ -46,6 +46,10 @@ protected:
   void deactivateAllAtoms();
 /// Activate the nth atom in the list
   void setAtomActive( const unsigned& n );
+/// Whether completeTask may steal the storage of the input MultiValue.
+/// When several actions bridge the same base colvar they all read the
+/// same input, so only the last of them is allowed to take it
+  bool canRecycleInputValues() const;
 public:
   static void registerKeywords( Keywords& keys );
   explicit BridgedMultiColvarFunction(const ActionOptions&);
@@ -102,6 +106,11 @@ MultiColvarBase* BridgedMultiColvarFunction::getPntrToMultiColvar() const {
   return mycolv;
 }
 
+inline
+bool BridgedMultiColvarFunction::canRecycleInputValues() const {
+  return myBridgeVessel->canRecycleInputValues();
+}
+
 inline
 unsigned BridgedMultiColvarFunction::getNumberOfDerivatives() {
   return mycolv->getNumberOfDerivatives() + 3*getNumberOfAtoms();
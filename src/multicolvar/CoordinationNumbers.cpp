@@ -151,6 +151,9 @@ CoordinationNumbers::CoordinationNumbers(const ActionOptions&ao):
   setLinkCellCutoff( rcut );
   rcut2 = rcut * rcut;
 
+  // the tasks only gather positions, so they can read them from the arena
+  use_position_arena=true;
+
   // And setup the ActionWithVessel
   std::vector<AtomNumber> all_atoms; setupMultiColvarBase( all_atoms ); checkRead();
 }
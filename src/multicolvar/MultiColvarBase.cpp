@@ -85,8 +85,10 @@ MultiColvarBase::MultiColvarBase(const ActionOptions&ao):
   threecells(comm),
   setup_completed(false),
   atomsWereRetrieved(false),
+  arena_is_filled(false),
   matsums(false),
   usespecies(false),
+  use_position_arena(false),
   nblock(0)
 {
   if( keywords.exists("NOPBC") ) {
@@ -703,6 +705,39 @@ void MultiColvarBase::setupActiveTaskSet( std::vector<unsigned>& active_tasks, c
       }
     }
     if( justVolumes ) {
+      // Build a two level hierarchy of bounding spheres over blocks of consecutive
+      // tasks so that localized volumes can discard whole regions of the system
+      // at once rather than testing every central atom individually
+      const unsigned blocksize=64; unsigned ntasks=getFullNumberOfTasks();
+      unsigned nblocks=( ntasks + blocksize - 1 ) / blocksize;
+      std::vector<Vector> block_center( nblocks ); std::vector<double> block_radius( nblocks );
+      for(unsigned b=0; b<nblocks; ++b) {
+        unsigned bstart=b*blocksize, bend=bstart+blocksize; if( bend>ntasks ) bend=ntasks;
+        Vector low=getCentralAtomPos( bstart ), high=low;
+        for(unsigned i=bstart+1; i<bend; ++i) {
+          Vector cpos=getCentralAtomPos( i );
+          for(unsigned k=0; k<3; ++k) {
+            if( cpos[k]<low[k] ) low[k]=cpos[k];
+            if( cpos[k]>high[k] ) high[k]=cpos[k];
+          }
+        }
+        block_center[b]=0.5*( low + high ); block_radius[b]=0.5*delta( low, high ).modulo();
+      }
+      unsigned nsupers=( nblocks + blocksize - 1 ) / blocksize;
+      std::vector<Vector> super_center( nsupers ); std::vector<double> super_radius( nsupers );
+      for(unsigned s=0; s<nsupers; ++s) {
+        unsigned sstart=s*blocksize, send=sstart+blocksize; if( send>nblocks ) send=nblocks;
+        Vector low, high;
+        for(unsigned k=0; k<3; ++k) { low[k]=block_center[sstart][k]-block_radius[sstart]; high[k]=block_center[sstart][k]+block_radius[sstart]; }
+        for(unsigned b=sstart+1; b<send; ++b) {
+          for(unsigned k=0; k<3; ++k) {
+            if( block_center[b][k]-block_radius[b]<low[k] ) low[k]=block_center[b][k]-block_radius[b];
+            if( block_center[b][k]+block_radius[b]>high[k] ) high[k]=block_center[b][k]+block_radius[b];
+          }
+        }
+        super_center[s]=0.5*( low + high ); super_radius[s]=0.5*delta( low, high ).modulo();
+      }
+
       for(unsigned j=0; j<getNumberOfVessels(); ++j) {
         vesselbase::BridgeVessel* myb=dynamic_cast<vesselbase::BridgeVessel*>( getPntrToVessel(j) );
         if( !myb ) continue ;
@@ -710,8 +745,16 @@ void MultiColvarBase::setupActiveTaskSet( std::vector<unsigned>& active_tasks, c
         if( !myv ) continue ;
         myv->retrieveAtoms(); myv->setupRegions();
 
-        for(unsigned i=0; i<getFullNumberOfTasks(); ++i) {
-          if( myv->inVolumeOfInterest(i) ) taskFlags[i]=1;
+        for(unsigned s=0; s<nsupers; ++s) {
+          if( !myv->mayBeInVolumeOfInterest( super_center[s], super_radius[s] ) ) continue;
+          unsigned bend=(s+1)*blocksize; if( bend>nblocks ) bend=nblocks;
+          for(unsigned b=s*blocksize; b<bend; ++b) {
+            if( !myv->mayBeInVolumeOfInterest( block_center[b], block_radius[b] ) ) continue;
+            unsigned iend=(b+1)*blocksize; if( iend>ntasks ) iend=ntasks;
+            for(unsigned i=b*blocksize; i<iend; ++i) {
+              if( taskFlags[i]==0 && myv->inVolumeOfInterest(i) ) taskFlags[i]=1;
+            }
+          }
         }
       }
     } else {
@@ -759,6 +802,10 @@ void MultiColvarBase::calculate() {
   // Recursive function that sets up tasks
   setupActiveTaskSet( taskFlags, getLabel() );
 
+  // Gather all the positions once, so that the link cell setup and the task
+  // loop read them with plain array lookups
+  if( use_position_arena ) fillPositionArena();
+
   // Check for filters and rerun setup of link cells if there are any
   if( mybasemulticolvars.size()>0 && filtersUsedAsInput() ) setupLinkCells();
 
@@ -789,7 +836,15 @@ void MultiColvarBase::prepare() {
 }
 
 void MultiColvarBase::retrieveAtoms() {
-  if( !atomsWereRetrieved ) { ActionAtomistic::retrieveAtoms(); atomsWereRetrieved=true; }
+  if( !atomsWereRetrieved ) { ActionAtomistic::retrieveAtoms(); atomsWereRetrieved=true; arena_is_filled=false; }
+}
+
+void MultiColvarBase::fillPositionArena() {
+  position_arena.resize( atom_lab.size() );
+// make sure that the raw lookups are used while the arena is being refilled
+  arena_is_filled=false;
+  for(unsigned i=0; i<atom_lab.size(); ++i) position_arena[i]=computePositionForLinkCells( i );
+  arena_is_filled=true;
 }
 
 void MultiColvarBase::mergeInputDerivatives( const unsigned& ival, const unsigned& start, const unsigned& end,
@@ -74,6 +74,17 @@ private:
   bool setup_completed;
 /// Ensures that retrieving of atoms is only done once per calculation loop
   bool atomsWereRetrieved;
+/// Step-persistent arena with the position of every atom used by the tasks,
+/// gathered once per step so that the task loop reads each coordinate with a
+/// single lookup instead of re-deriving it for every task it appears in
+  std::vector<Vector> position_arena;
+/// Is the position arena up to date for the current set of positions
+  bool arena_is_filled;
+/// The expensive (branchy) per-atom position lookup that the arena allows
+/// us to perform only once per step
+  Vector computePositionForLinkCells( const unsigned& iatom ) const ;
+/// Fill the position arena with the position of every atom in atom_lab
+  void fillPositionArena();
 /// Add derivatives of center of mass position
   void addComDerivatives( const int& ival, const unsigned& iatom, const Vector& der, multicolvar::AtomValuePack& myatoms ) const ;
 protected:
@@ -94,6 +105,9 @@ protected:
   bool matsums;
 /// Using the species keyword to read in atoms
   bool usespecies;
+/// Gather all the positions in a step-persistent arena at the start of
+/// calculate, so that tasks read them without any indirection
+  bool use_position_arena;
 /// Number of atoms in each block
   unsigned nblock;
 /// This is used when turning cvcodes into atom numbers
@@ -234,6 +248,12 @@ AtomNumber MultiColvarBase::getAbsoluteIndexOfCentralAtom( const unsigned& iatom
 inline
 Vector MultiColvarBase::getPositionOfAtomForLinkCells( const unsigned& iatom ) const {
   plumed_dbg_assert( iatom<atom_lab.size() );
+  if( arena_is_filled ) return position_arena[iatom];
+  return computePositionForLinkCells( iatom );
+}
+
+inline
+Vector MultiColvarBase::computePositionForLinkCells( const unsigned& iatom ) const {
   if( atom_lab[iatom].first>0  ) {
     unsigned mmc=atom_lab[iatom].first - 1;
     return mybasemulticolvars[mmc]->getCentralAtomPos( atom_lab[iatom].second );
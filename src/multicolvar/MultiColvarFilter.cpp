@@ -52,19 +52,26 @@ void MultiColvarFilter::doJobsRequiredBeforeTaskList() {
 }
 
 void MultiColvarFilter::completeTask( const unsigned& curr, MultiValue& invals, MultiValue& outvals ) const {
-  invals.copyValues( outvals );
-  if( derivativesAreRequired() ) invals.copyDerivatives( outvals );
-
-  // Retrieve the value of the multicolvar and apply filter
+  // Retrieve the value of the multicolvar and apply filter; this must
+  // happen before the handoff below, which may recycle the invals storage
   double val=invals.get(1), df, weight=applyFilter( val, df );
 
-  // Now propegate derivatives
+  if( derivativesAreRequired() ) {
+    // the storage handoff is only allowed when no other vessel reads invals
+    // after us; with several filters bridging the same base colvar the
+    // earlier ones must leave the input intact
+    if( canRecycleInputValues() ) invals.moveValuesAndDerivatives( outvals );
+    else { invals.copyValues( outvals ); invals.copyDerivatives( outvals ); }
+  } else invals.copyValues( outvals );
+
+  // Now propegate derivatives; the colvar derivatives are read back from
+  // outvals, where the handoff has put them
   if( filter && !getPntrToMultiColvar()->weightHasDerivatives ) {
     outvals.setValue( 0, weight );
     if( derivativesAreRequired() ) {
       for(unsigned i=0; i<invals.getNumberActive(); ++i) {
         unsigned jder=invals.getActiveIndex(i);
-        outvals.addDerivative( 0, jder, df*invals.getDerivative(1, jder ) );
+        outvals.addDerivative( 0, jder, df*outvals.getDerivative(1, jder ) );
       }
     }
   } else if( filter ) {
@@ -80,7 +87,7 @@ void MultiColvarFilter::completeTask( const unsigned& curr, MultiValue& invals,
     if( derivativesAreRequired() ) {
       for(unsigned i=0; i<invals.getNumberActive(); ++i) {
         unsigned jder=invals.getActiveIndex(i);
-        outvals.setDerivative( 1, jder, df*invals.getDerivative(1, jder ) );
+        outvals.setDerivative( 1, jder, df*outvals.getDerivative(1, jder ) );
       }
     }
   }
@@ -73,15 +73,32 @@ private:
   double xlow, xhigh;
   double ylow, yhigh;
   double zlow, zhigh;
+/// Beads for the three directions, set up once and for all on construction
+  HistogramBead xbead, ybead, zbead;
 public:
   static void registerKeywords( Keywords& keys );
   explicit VolumeAround(const ActionOptions& ao);
   void setupRegions() override;
+  bool volumeWithinRange( const Vector& cpos, const double& range ) const override;
+  bool volumeEntirelyWithinRange( const Vector& cpos, const double& range ) const override;
   double calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const override;
 };
 
 PLUMED_REGISTER_ACTION(VolumeAround,"AROUND")
 
+namespace {
+/// Largest value the bead can take over the nearest periodic images of x.
+/// A boxlen of zero means the direction is not periodic
+inline double maxBeadValue( const HistogramBead& bead, const double& x, const double& boxlen ) {
+  double der, v=bead.calculate( x, der );
+  if( boxlen>0 ) {
+    double vm=bead.calculate( x-boxlen, der ); if( vm>v ) v=vm;
+    double vp=bead.calculate( x+boxlen, der ); if( vp>v ) v=vp;
+  }
+  return v;
+}
+}
+
 void VolumeAround::registerKeywords( Keywords& keys ) {
   ActionVolume::registerKeywords( keys );
   keys.add("atoms","ATOM","the atom whose vicinity we are interested in examining");
@@ -110,33 +127,90 @@ VolumeAround::VolumeAround(const ActionOptions& ao):
   if( zlow==0.0 && zhigh==0.0 ) doz=false;
   if( !dox && !doy && !doz ) error("no subregion defined use XLOWER, XUPPER, YLOWER, YUPPER, ZLOWER, ZUPPER");
   log.printf("  boundaries for region (region of interest about atom) : x %f %f, y %f %f, z %f %f \n",xlow,xhigh,ylow,yhigh,zlow,zhigh);
+  if( dox ) { xbead.isNotPeriodic(); xbead.setKernelType( getKernelType() ); xbead.set( xlow, xhigh, getSigma() ); }
+  if( doy ) { ybead.isNotPeriodic(); ybead.setKernelType( getKernelType() ); ybead.set( ylow, yhigh, getSigma() ); }
+  if( doz ) { zbead.isNotPeriodic(); zbead.setKernelType( getKernelType() ); zbead.set( zlow, zhigh, getSigma() ); }
   checkRead(); requestAtoms(atom);
 }
 
 void VolumeAround::setupRegions() { }
 
-double VolumeAround::calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const {
-  // Setup the histogram bead
+bool VolumeAround::volumeWithinRange( const Vector& cpos, const double& range ) const {
+  // near the corners of a skewed cell a point within range of cpos can wrap to the
+  // far side of the box, so block culling is only attempted for orthorombic cells
+  if( getPbc().isSet() && !getPbc().isOrthorombic() ) return true;
+
+  // widening the bead limits by range gives an upper bound on the weight of any
+  // point that lies within range of cpos
+  HistogramBead bead; bead.isNotPeriodic(); bead.setKernelType( getKernelType() );
+  Vector fpos=pbcDistance( getPosition(0), cpos ); double bound=1.0;
+  if( dox ) {
+    double boxlen=0.0;
+    if( getPbc().isSet() ) { boxlen=getPbc().getBox()(0,0); if( range>=boxlen ) return true; }
+    bead.set( xlow - range, xhigh + range, getSigma() );
+    bound *= maxBeadValue( bead, fpos[0], boxlen );
+  }
+  if( doy ) {
+    double boxlen=0.0;
+    if( getPbc().isSet() ) { boxlen=getPbc().getBox()(1,1); if( range>=boxlen ) return true; }
+    bead.set( ylow - range, yhigh + range, getSigma() );
+    bound *= maxBeadValue( bead, fpos[1], boxlen );
+  }
+  if( doz ) {
+    double boxlen=0.0;
+    if( getPbc().isSet() ) { boxlen=getPbc().getBox()(2,2); if( range>=boxlen ) return true; }
+    bead.set( zlow - range, zhigh + range, getSigma() );
+    bound *= maxBeadValue( bead, fpos[2], boxlen );
+  }
+  return bound>=getTolerance();
+}
+
+bool VolumeAround::volumeEntirelyWithinRange( const Vector& cpos, const double& range ) const {
+  // see volumeWithinRange for why this is restricted to orthorombic cells
+  if( getPbc().isSet() && !getPbc().isOrthorombic() ) return false;
+
+  // narrowing the bead limits by range gives a lower bound on the weight of
+  // any point that lies within range of cpos, provided that no such point can
+  // wrap around to the other side of the box
   HistogramBead bead; bead.isNotPeriodic(); bead.setKernelType( getKernelType() );
+  Vector fpos=pbcDistance( getPosition(0), cpos ); double der, bound=1.0;
+  if( dox ) {
+    if( xlow + range >= xhigh - range ) return false;
+    if( getPbc().isSet() && std::fabs(fpos[0])>=0.5*getPbc().getBox()(0,0)-range ) return false;
+    bead.set( xlow + range, xhigh - range, getSigma() );
+    bound *= bead.calculate( fpos[0], der );
+  }
+  if( doy ) {
+    if( ylow + range >= yhigh - range ) return false;
+    if( getPbc().isSet() && std::fabs(fpos[1])>=0.5*getPbc().getBox()(1,1)-range ) return false;
+    bead.set( ylow + range, yhigh - range, getSigma() );
+    bound *= bead.calculate( fpos[1], der );
+  }
+  if( doz ) {
+    if( zlow + range >= zhigh - range ) return false;
+    if( getPbc().isSet() && std::fabs(fpos[2])>=0.5*getPbc().getBox()(2,2)-range ) return false;
+    bead.set( zlow + range, zhigh - range, getSigma() );
+    bound *= bead.calculate( fpos[2], der );
+  }
+  return bound>=1.0-getTolerance();
+}
 
+double VolumeAround::calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const {
   // Calculate position of atom wrt to origin
   Vector fpos=pbcDistance( getPosition(0), cpos );
   double xcontr, ycontr, zcontr, xder, yder, zder;
   if( dox ) {
-    bead.set( xlow, xhigh, getSigma() );
-    xcontr=bead.calculate( fpos[0], xder );
+    xcontr=xbead.calculate( fpos[0], xder );
   } else {
     xcontr=1.; xder=0.;
   }
   if( doy ) {
-    bead.set( ylow, yhigh, getSigma() );
-    ycontr=bead.calculate( fpos[1], yder );
+    ycontr=ybead.calculate( fpos[1], yder );
   } else {
     ycontr=1.; yder=0.;
   }
   if( doz ) {
-    bead.set( zlow, zhigh, getSigma() );
-    zcontr=bead.calculate( fpos[2], zder );
+    zcontr=zbead.calculate( fpos[2], zder );
   } else {
     zcontr=1.; zder=0.;
   }
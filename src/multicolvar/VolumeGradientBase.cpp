@@ -62,9 +62,12 @@ void VolumeGradientBase::completeTask( const unsigned& curr, MultiValue& invals,
   if( getPntrToMultiColvar()->isDensity() ) {
     outvals.setValue(0, 1.0); outvals.setValue(1, 1.0);
   } else {
-    // Copy derivatives of the colvar and the value of the colvar
-    invals.copyValues( outvals );
-    if( derivativesAreRequired() ) invals.copyDerivatives( outvals );
+    // Hand the value and the derivatives of the colvar over; the storage
+    // handoff is only allowed when no other vessel reads invals after us
+    if( derivativesAreRequired() ) {
+      if( canRecycleInputValues() ) invals.moveValuesAndDerivatives( outvals );
+      else { invals.copyValues( outvals ); invals.copyDerivatives( outvals ); }
+    } else invals.copyValues( outvals );
   }
   calculateAllVolumes( curr, outvals );
 }
@@ -81,6 +81,7 @@ public:
   static void registerKeywords( Keywords& keys );
   explicit VolumeInCylinder (const ActionOptions& ao);
   void setupRegions() override;
+  bool volumeWithinRange( const Vector& cpos, const double& range ) const override;
   double calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const override;
 };
 
@@ -132,6 +133,37 @@ VolumeInCylinder::VolumeInCylinder(const ActionOptions& ao):
 
 void VolumeInCylinder::setupRegions() { }
 
+bool VolumeInCylinder::volumeWithinRange( const Vector& cpos, const double& range ) const {
+  // near the corners of a skewed cell a point within range of cpos can wrap to the
+  // far side of the box, so culling is only attempted for orthorombic cells
+  if( getPbc().isSet() && !getPbc().isOrthorombic() ) return true;
+  Vector fpos=pbcDistance( getPosition(0), cpos );
+
+  // every switching function is exactly zero beyond its dmax and for an
+  // orthorombic cell the minimum image radial distance changes by at most
+  // range when the atom moves by range, so atoms whose radial distance cannot
+  // drop below dmax carry no weight at all
+  const double dd = fpos[dir[0]]*fpos[dir[0]] + fpos[dir[1]]*fpos[dir[1]];
+  const double dmax_r = switchingFunction.get_dmax() + range;
+  if( dd > dmax_r*dmax_r ) return false;
+
+  // widening the bead limits by range gives an upper bound on the weight of
+  // any point that lies within range of cpos along the axis of the cylinder
+  if( docylinder ) {
+    double boxlen=0.0;
+    if( getPbc().isSet() ) { boxlen=getPbc().getBox()(dir[2],dir[2]); if( range>=boxlen ) return true; }
+    HistogramBead wbead; wbead.isNotPeriodic(); wbead.setKernelType( getKernelType() );
+    wbead.set( bead.getlowb() - range, bead.getbigb() + range, getSigma() );
+    double der, bound=wbead.calculate( fpos[dir[2]], der );
+    if( boxlen>0 ) {
+      double vm=wbead.calculate( fpos[dir[2]]-boxlen, der ); if( vm>bound ) bound=vm;
+      double vp=wbead.calculate( fpos[dir[2]]+boxlen, der ); if( vp>bound ) bound=vp;
+    }
+    if( bound<getTolerance() ) return false;
+  }
+  return true;
+}
+
 double VolumeInCylinder::calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const {
   // Calculate position of atom wrt to origin
   Vector fpos=pbcDistance( getPosition(0), cpos );
@@ -77,6 +77,7 @@ public:
   static void registerKeywords( Keywords& keys );
   explicit VolumeInSphere(const ActionOptions& ao);
   void setupRegions() override;
+  bool volumeWithinRange( const Vector& cpos, const double& range ) const override;
   double calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const override;
 };
 
@@ -109,6 +110,16 @@ VolumeInSphere::VolumeInSphere(const ActionOptions& ao):
 
 void VolumeInSphere::setupRegions() { }
 
+bool VolumeInSphere::volumeWithinRange( const Vector& cpos, const double& range ) const {
+  // the minimum-image distance satisfies the triangle inequality, so this
+  // bound holds under any periodic boundary conditions
+  Vector fpos=pbcDistance( getPosition(0), cpos );
+  double dist=fpos.modulo()-range;
+  if( dist<=0 ) return true;
+  double dfunc;
+  return switchingFunction.calculate( dist, dfunc )>=getTolerance();
+}
+
 double VolumeInSphere::calculateNumberInside( const Vector& cpos, Vector& derivatives, Tensor& vir, std::vector<Vector>& refders ) const {
   // Calculate position of atom wrt to origin
   Vector fpos=pbcDistance( getPosition(0), cpos );
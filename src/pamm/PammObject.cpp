@@ -38,6 +38,29 @@ PammObject::PammObject( const PammObject& in ):
   max(in.max)
 {
   for(unsigned i=0; i<in.kernels.size(); ++i) kernels.emplace_back( new KernelFunctions( in.kernels[i].get() ) );
+  buildPruningData();
+}
+
+void PammObject::buildPruningData() {
+  unsigned ncv=pbc.size();
+  prune_center.resize( kernels.size()*ncv );
+  prune_support.resize( kernels.size()*ncv );
+  prune_ok.resize( kernels.size() );
+  for(unsigned i=0; i<kernels.size(); ++i) {
+    std::vector<double> cc( kernels[i]->getCenter() );
+    for(unsigned j=0; j<ncv; ++j) prune_center[i*ncv+j]=cc[j];
+    if( kernels[i]->hasContinuousSupport() ) {
+      // the kernel values enter ratios, so pruning must not perturb the
+      // normalizing sum: the box bounds the whole cutoff ellipsoid (also for
+      // non-diagonal metrics) and is stretched so that a gaussian is below
+      // machine precision at its boundary rather than at the gridding cutoff
+      std::vector<double> ss( kernels[i]->getConservativeSupport( 2.5 ) );
+      for(unsigned j=0; j<ncv; ++j) prune_support[i*ncv+j]=ss[j];
+      prune_ok[i]=1;
+    } else {
+      prune_ok[i]=0;
+    }
+  }
 }
 
 void PammObject::setup( const std::string& filename, const double& reg, const std::vector<std::string>& valnames,
@@ -69,6 +92,7 @@ void PammObject::setup( const std::string& filename, const double& reg, const st
     ifile.scanField();
   }
   ifile.close();
+  buildPruningData();
 }
 
 void PammObject::evaluate( const std::vector<double>& invar, std::vector<double>& outvals, std::vector<std::vector<double> >& der ) const {
@@ -86,7 +110,23 @@ void PammObject::evaluate( const std::vector<double>& invar, std::vector<double>
 
   // Evaluate the set of kernels
   double denom=regulariser; std::vector<double> dderiv( der[0].size(), 0 );
+  unsigned ncv=pbc.size();
   for(unsigned i=0; i<kernels.size(); ++i) {
+    // skip kernels whose center is further from the input point than the
+    // kernel support in any direction: the box built in buildPruningData is
+    // conservative, so the discarded contributions are negligible at machine
+    // precision and the normalizing sum below is unaffected
+    if( prune_ok[i] ) {
+      bool skip=false;
+      for(unsigned j=0; j<ncv; ++j) {
+        if( std::fabs( pos_ptr[j]->difference( prune_center[i*ncv+j] ) )>prune_support[i*ncv+j] ) { skip=true; break; }
+      }
+      if( skip ) {
+        outvals[i]=0.0;
+        for(unsigned j=0; j<der[i].size(); ++j) der[i][j]=0.0;
+        continue;
+      }
+    }
     outvals[i]=kernels[i]->evaluate( pos_ptr, der[i] ); denom+=outvals[i];
     for(unsigned j=0; j<der[i].size(); ++j) dderiv[j] += der[i][j];
   }
@@ -39,6 +39,14 @@ private:
   std::vector<std::string> min, max;
 /// List of kernel functions involved
   std::vector<std::unique_ptr<KernelFunctions>> kernels;
+/// Kernel centers and supports packed in flat arrays, used to skip kernels
+/// that cannot contribute to the sum at a given point without calling their
+/// evaluate method.  prune_ok flags the kernels for which a support is
+/// available (it is not for von Mises kernels)
+  std::vector<double> prune_center, prune_support;
+  std::vector<unsigned char> prune_ok;
+/// Fill the arrays above from the kernel list
+  void buildPruningData();
 public:
 // Explicit definitions for constructor, copy constructor and destructor
   PammObject();
@@ -729,8 +729,11 @@ void PIV::calculate()
   static std:: vector<std:: vector<double> > cPIV(Nlist);
   static std:: vector<std:: vector<int> > Atom0(Nlist);
   static std:: vector<std:: vector<int> > Atom1(Nlist);
-  std:: vector<std:: vector<int> > A0(Nprec);
-  std:: vector<std:: vector<int> > A1(Nprec);
+  // Occupancy bins are kept across steps: block sizes change little from
+  // frame to frame, so reusing the allocations avoids regrowing the bins
+  // from scratch every time the PIV is updated
+  static std:: vector<std:: vector<int> > A0(Nprec);
+  static std:: vector<std:: vector<int> > A1(Nprec);
   unsigned stride=1;
   unsigned rank=0;
 
@@ -885,6 +888,12 @@ void PIV::calculate()
         cPIV[j].resize(0);
         Atom0[j].resize(0);
         Atom1[j].resize(0);
+        // reset the occupancy bins keeping their capacity, so that pairs
+        // of the previous block (or step) cannot leak into this one
+        for(unsigned i=0; i<Nprec; i++) {
+          A0[i].resize(0);
+          A1[i].resize(0);
+        }
         // Building distances for the PIV vector at time t
         if(timer) stopwatch.start("1 Build cPIV");
         for(unsigned i=rank; i<nl[j]->size(); i+=stride) {
@@ -909,9 +918,13 @@ void PIV::calculate()
           int Vint=int(sfs[j].calculate(ddist.modulo()*Fvol, df)*double(Nprec-1)+0.5);
           //Integer transformed distance values as index of the Ordering Vector OrdVec
           OrdVec[Vint]+=1;
-          //Keeps track of atom indices for force and virial calculations
-          A0[Vint].push_back(i0);
-          A1[Vint].push_back(i1);
+          //Keeps track of atom indices for force and virial calculations.
+          //Zeros never enter the PIV, so their atom indices (the vast
+          //majority of the pairs for large blocks) are not stored at all
+          if(Vint>0) {
+            A0[Vint].push_back(i0);
+            A1[Vint].push_back(i1);
+          }
         }
         if(timer) stopwatch.stop("1 Build cPIV");
         if(timer) stopwatch.start("2 Sort cPIV");
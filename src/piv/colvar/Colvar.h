@@ -0,0 +1 @@
+#include "../../colvar/Colvar.h"
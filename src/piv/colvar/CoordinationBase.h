@@ -0,0 +1 @@
+#include "../../colvar/CoordinationBase.h"
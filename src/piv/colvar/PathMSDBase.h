@@ -0,0 +1 @@
+#include "../../colvar/PathMSDBase.h"
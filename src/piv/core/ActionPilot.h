@@ -0,0 +1 @@
+#include "../../core/ActionPilot.h"
@@ -0,0 +1 @@
+#include "../../core/ActionSetup.h"
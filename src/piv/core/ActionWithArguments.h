@@ -0,0 +1 @@
+#include "../../core/ActionWithArguments.h"
@@ -0,0 +1 @@
+#include "../../core/Atoms.h"
@@ -0,0 +1 @@
+#include "../../core/CLTool.h"
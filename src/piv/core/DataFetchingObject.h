@@ -0,0 +1 @@
+#include "../../core/DataFetchingObject.h"
@@ -0,0 +1 @@
+#include "../../core/GenericMolInfo.h"
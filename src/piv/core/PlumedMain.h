@@ -0,0 +1 @@
+#include "../../core/PlumedMain.h"
@@ -0,0 +1 @@
+#include "../../core/TargetDist.h"
@@ -0,0 +1 @@
+#include "../../tools/AtomNumber.h"
@@ -0,0 +1 @@
+#include "../../tools/Brent1DRootSearch.h"
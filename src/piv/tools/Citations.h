@@ -0,0 +1 @@
+#include "../../tools/Citations.h"
@@ -0,0 +1 @@
+#include "../../tools/Grid.h"
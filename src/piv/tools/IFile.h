@@ -0,0 +1 @@
+#include "../../tools/IFile.h"
@@ -0,0 +1 @@
+#include "../../tools/LatticeReduction.h"
@@ -0,0 +1 @@
+#include "../../tools/LinkCells.h"
@@ -0,0 +1 @@
+#include "../../tools/Tensor.h"
@@ -72,24 +72,40 @@ void DRMSD::setup_targets() {
     }
   }
   if( targets.empty() ) error("drmsd will compare no distances - check upper and lower bounds are sensible");
+  cache_targets();
+}
+
+void DRMSD::cache_targets() {
+  target_pairs.resize(0); target_pairs.reserve( targets.size() );
+  for(const auto & it : targets) {
+    TargetPair t; t.i=it.first.first; t.j=it.first.second; t.dist=it.second;
+    target_pairs.push_back(t);
+  }
 }
 
 double DRMSD::calc( const std::vector<Vector>& pos, const Pbc& pbc, ReferenceValuePack& myder, const bool& squared ) const {
-  plumed_dbg_assert(!targets.empty());
+  plumed_dbg_assert(!target_pairs.empty());
 
-  Vector distance;
   myder.clear();
-  double drmsd=0.;
-  for(const auto & it : targets) {
-
-    const unsigned i=getAtomIndex( it.first.first );
-    const unsigned j=getAtomIndex( it.first.second );
+  const unsigned npairs=target_pairs.size();
+
+  // gather all the bare distance vectors first and resolve the periodic
+  // images in one batched call, so that the accumulation loop below is
+  // branch free and the compiler can vectorize the arithmetic
+  std::vector<Vector> distances( npairs );
+  for(unsigned k=0; k<npairs; ++k) {
+    distances[k]=delta( pos[ getAtomIndex( target_pairs[k].i ) ], pos[ getAtomIndex( target_pairs[k].j ) ] );
+  }
+  if(!nopbc) pbc.apply( distances, npairs );
 
-    if(nopbc) distance=delta( pos[i], pos[j] );
-    else      distance=pbc.distance( pos[i], pos[j] );
+  double drmsd=0.;
+  for(unsigned k=0; k<npairs; ++k) {
+    const Vector & distance( distances[k] );
+    const unsigned i=getAtomIndex( target_pairs[k].i );
+    const unsigned j=getAtomIndex( target_pairs[k].j );
 
     const double len = distance.modulo();
-    const double diff = len - it.second;
+    const double diff = len - target_pairs[k].dist;
     const double der = diff / len;
 
     drmsd += diff * diff;
@@ -36,8 +36,15 @@ protected:
   bool bounds_were_set;
   double lower, upper;
   std::map< std::pair <unsigned,unsigned>, double> targets;
+/// Flat copy of targets iterated in calc(); walking the map at every
+/// evaluation is cache unfriendly. Rebuilt by cache_targets(), which must be
+/// called at the end of every setup_targets() implementation
+  struct TargetPair { unsigned i, j; double dist; };
+  std::vector<TargetPair> target_pairs;
 /// Read in NOPBC, LOWER_CUTOFF and UPPER_CUTOFF
   void readBounds( const PDB& );
+/// Rebuild target_pairs from targets
+  void cache_targets();
 public:
   explicit DRMSD( const ReferenceConfigurationOptions& ro );
 /// This sets upper and lower bounds on distances to be used in DRMSD
@@ -63,6 +63,7 @@ void IntermolecularDRMSD::setup_targets() {
       }
     }
   }
+  cache_targets();
 }
 
 }
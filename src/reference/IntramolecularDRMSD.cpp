@@ -61,6 +61,7 @@ void IntramolecularDRMSD::setup_targets() {
       }
     }
   }
+  cache_targets();
 }
 
 }
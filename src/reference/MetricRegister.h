@@ -76,6 +76,8 @@ std::unique_ptr<T> MetricRegister::create( const std::string& type ) {
   } else {
     std::size_t dash=type.find("-FAST"); // We must remove the fast label
     ftype=type.substr(0,dash);
+    // the packed suffix is handled by the optimal metric itself
+    if( ftype=="OPTIMAL-PACKED" ) ftype="OPTIMAL";
   }
   plumed_massert( check(ftype), "metric " + ftype + " does not exist" );
   ReferenceConfigurationOptions ro( type );
@@ -29,13 +29,21 @@ namespace PLMD {
 class OptimalRMSD : public RMSDBase {
 private:
   bool fast;
+/// whether the alignment and displacement weights coincide; comparing the
+/// two vectors at every call is wasteful so this is cached at setup time
+  bool alEqDis;
   RMSD myrmsd;
 public:
   explicit OptimalRMSD(const ReferenceConfigurationOptions& ro);
   void read( const PDB& ) override;
   double calc( const std::vector<Vector>& pos, ReferenceValuePack& myder, const bool& squared ) const override;
   bool pcaIsEnabledForThisReference() override { return true; }
-  void setupRMSDObject() override { myrmsd.clear(); myrmsd.set(getAlign(),getDisplace(),getReferencePositions(),"OPTIMAL"); }
+  void setupRMSDObject() override {
+    myrmsd.clear();
+    if( getName().find("-PACKED")!=std::string::npos ) myrmsd.set(getAlign(),getDisplace(),getReferencePositions(),"OPTIMAL-PACKED");
+    else myrmsd.set(getAlign(),getDisplace(),getReferencePositions(),"OPTIMAL");
+    alEqDis=( getAlign()==getDisplace() );
+  }
   void setupPCAStorage( ReferenceValuePack& mypack ) override {
     mypack.switchOnPCAOption();
     mypack.centeredpos.resize( getNumberOfAtoms() );
@@ -50,7 +58,8 @@ PLUMED_REGISTER_METRIC(OptimalRMSD,"OPTIMAL")
 
 OptimalRMSD::OptimalRMSD(const ReferenceConfigurationOptions& ro ):
   ReferenceConfiguration(ro),
-  RMSDBase(ro)
+  RMSDBase(ro),
+  alEqDis(true)
 {
   fast=ro.usingFastOption();
 }
@@ -62,15 +71,17 @@ void OptimalRMSD::read( const PDB& pdb ) {
 double OptimalRMSD::calc( const std::vector<Vector>& pos, ReferenceValuePack& myder, const bool& squared ) const {
   double d;
   if( myder.calcUsingPCAOption() ) {
-    std::vector<Vector> centeredreference( getNumberOfAtoms () );
+    // scratch vector is kept per thread as this routine runs once per frame of a path
+    thread_local std::vector<Vector> centeredreference;
+    centeredreference.resize( getNumberOfAtoms () );
     d=myrmsd.calc_PCAelements(pos,myder.getAtomVector(),myder.rot[0],myder.DRotDPos,myder.getAtomsDisplacementVector(),myder.centeredpos,centeredreference,squared);
     unsigned nat = pos.size();
     for(unsigned i=0; i<nat; ++i) { myder.getAtomsDisplacementVector()[i] -= getReferencePosition(i); myder.getAtomsDisplacementVector()[i] *= getDisplace()[i]; }
   } else if( fast ) {
-    if( getAlign()==getDisplace() ) d=myrmsd.optimalAlignment<false,true>(getAlign(),getDisplace(),pos,getReferencePositions(),myder.getAtomVector(),squared);
+    if( alEqDis ) d=myrmsd.optimalAlignment<false,true>(getAlign(),getDisplace(),pos,getReferencePositions(),myder.getAtomVector(),squared);
     else d=myrmsd.optimalAlignment<false,false>(getAlign(),getDisplace(),pos,getReferencePositions(),myder.getAtomVector(),squared);
   } else {
-    if( getAlign()==getDisplace() ) d=myrmsd.optimalAlignment<true,true>(getAlign(),getDisplace(),pos,getReferencePositions(),myder.getAtomVector(),squared);
+    if( alEqDis ) d=myrmsd.optimalAlignment<true,true>(getAlign(),getDisplace(),pos,getReferencePositions(),myder.getAtomVector(),squared);
     else d=myrmsd.optimalAlignment<true,false>(getAlign(),getDisplace(),pos,getReferencePositions(),myder.getAtomVector(),squared);
   }
   myder.clear(); for(unsigned i=0; i<pos.size(); ++i) myder.setAtomDerivatives( i, myder.getAtomVector()[i] );
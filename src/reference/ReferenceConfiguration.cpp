@@ -117,7 +117,10 @@ double distance( const Pbc& pbc, const std::vector<Value*> & vals, ReferenceConf
   if( ref1->getReferencePositions().size()>0 ) nder=ref1->getReferenceArguments().size() + 3*ref1->getReferencePositions().size() + 9;
   else nder=ref1->getReferenceArguments().size();
 
-  MultiValue myvals( 1, nder ); ReferenceValuePack myder( ref1->getReferenceArguments().size(), ref1->getReferencePositions().size(), myvals );
+  // the scratch space is borrowed from the per-thread pool as this routine is
+  // called for every pair of frames when dissimilarity matrices are computed
+  TemporaryMultiValue tval( 1, nder ); MultiValue& myvals=*tval;
+  ReferenceValuePack myder( ref1->getReferenceArguments().size(), ref1->getReferencePositions().size(), myvals );
   double dist1=ref1->calc( ref2->getReferencePositions(), pbc, vals, ref2->getReferenceArguments(), myder, squared );
 #ifndef NDEBUG
   // Check that A - B = B - A
@@ -23,18 +23,42 @@
 
 namespace PLMD {
 
+namespace {
+// Pool of alignment workspaces that have been released by destroyed packs.
+// As the pool is thread local it needs no locking; keeping it short stops
+// stale workspaces from accumulating
+thread_local std::vector<std::unique_ptr<AlignmentWorkspace> > awk_pool;
+
+std::unique_ptr<AlignmentWorkspace> borrowAlignmentWorkspace() {
+  if( !awk_pool.empty() ) {
+    std::unique_ptr<AlignmentWorkspace> wsp=std::move( awk_pool.back() );
+    awk_pool.pop_back(); wsp->clear(); return wsp;
+  }
+  return std::unique_ptr<AlignmentWorkspace>( new AlignmentWorkspace() );
+}
+}
+
 ReferenceValuePack::ReferenceValuePack( const unsigned& nargs, const unsigned& natoms, MultiValue& vals ):
   boxWasSet(false),
   numberOfArgs(nargs),
   oind_set(false),
   myvals(vals),
   atom_indices(myvals.getIndices()),
-  pca(false)
+  pca(false),
+  wspace(borrowAlignmentWorkspace()),
+  centeredpos(wspace->centeredpos),
+  displacement(wspace->displacement),
+  rot(wspace->rot),
+  DRotDPos(wspace->DRotDPos)
 {
   if( atom_indices.size()!=natoms ) { atom_indices.resize( natoms ); myvals.getAtomVector().resize( natoms ); }
   if( vals.getNumberOfValues()==1 ) { oind=0; oind_set=true; }
 }
 
+ReferenceValuePack::~ReferenceValuePack() {
+  if( awk_pool.size()<8 ) awk_pool.push_back( std::move(wspace) );
+}
+
 void ReferenceValuePack::resize( const unsigned& nargs, const unsigned& natoms ) {
   numberOfArgs=nargs; atom_indices.resize( natoms );
   myvals.getAtomVector().resize( natoms );
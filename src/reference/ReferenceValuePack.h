@@ -26,6 +26,24 @@
 
 namespace PLMD {
 
+/// Scratch space used by the PCA style alignment routines.  Instances are
+/// borrowed from a per-thread pool when a ReferenceValuePack is constructed
+/// and handed back when it is destroyed, so packs that are rebuilt for every
+/// task (one per frame of a path) share a single workspace allocation per
+/// thread rather than reallocating these vectors for every frame
+class AlignmentWorkspace {
+  friend class ReferenceValuePack;
+private:
+  std::vector<Vector> centeredpos;
+  std::vector<Vector> displacement;
+  std::vector<Tensor> rot;
+  Matrix< std::vector<Vector> > DRotDPos;
+public:
+/// Empty the scratch vectors so a recycled workspace looks like a fresh one
+/// while retaining the capacity acquired in earlier use
+  void clear() { centeredpos.clear(); displacement.clear(); rot.clear(); }
+};
+
 class ReferenceValuePack {
   friend class MultiDomainRMSD;
   friend class OptimalRMSD;
@@ -43,16 +61,19 @@ private:
   std::vector<unsigned>& atom_indices;
 /// Are we using pca
   bool pca;
+/// The alignment workspace borrowed from the per-thread pool
+  std::unique_ptr<AlignmentWorkspace> wspace;
 /// A vector of vectors to save us some overhead for vector resizes
-  std::vector<Vector> centeredpos;
+  std::vector<Vector>& centeredpos;
 ///
-  std::vector<Vector> displacement;
+  std::vector<Vector>& displacement;
 ///
-  std::vector<Tensor> rot;
+  std::vector<Tensor>& rot;
 ///
-  Matrix< std::vector<Vector> >  DRotDPos;
+  Matrix< std::vector<Vector> >&  DRotDPos;
 public:
   ReferenceValuePack( const unsigned& nargs, const unsigned& natoms, MultiValue& vals );
+  ~ReferenceValuePack();
 ///
   void resize( const unsigned& nargs, const unsigned& natoms );
 ///
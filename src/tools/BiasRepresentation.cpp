@@ -26,6 +26,11 @@
 #include "KernelFunctions.h"
 #include "File.h"
 #include "Grid.h"
+#include "OpenMP.h"
+#include <complex>
+#ifdef __PLUMED_HAS_FFTW
+#include <fftw3.h> // FFTW interface
+#endif
 
 
 namespace PLMD {
@@ -33,7 +38,7 @@ namespace PLMD {
 using namespace std;
 
 /// the constructor here
-BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc ):hasgrid(false),rescaledToBias(false),mycomm(cc) {
+BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc ):hasgrid(false),rescaledToBias(false),dofft_(false),needssync_(false),mycomm(cc) {
   lowI_=0.0;
   uppI_=0.0;
   doInt_=false;
@@ -44,7 +49,7 @@ BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communi
   }
 }
 /// overload the constructor: add the sigma  at constructor time
-BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc,  const vector<double> & sigma ):hasgrid(false), rescaledToBias(false), histosigma(sigma),mycomm(cc) {
+BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc,  const vector<double> & sigma ):hasgrid(false), rescaledToBias(false), dofft_(false),needssync_(false), histosigma(sigma),mycomm(cc) {
   lowI_=0.0;
   uppI_=0.0;
   doInt_=false;
@@ -56,7 +61,7 @@ BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communi
 }
 /// overload the constructor: add the grid at constructor time
 BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc, const vector<string> & gmin, const vector<string> & gmax,
-                                       const vector<unsigned> & nbin, bool doInt, double lowI, double uppI ):hasgrid(false), rescaledToBias(false), mycomm(cc) {
+                                       const vector<unsigned> & nbin, bool doInt, double lowI, double uppI ):hasgrid(false), rescaledToBias(false), dofft_(false),needssync_(false), mycomm(cc) {
   ndim=tmpvalues.size();
   for(int  i=0; i<ndim; i++) {
     values.push_back(tmpvalues[i]);
@@ -69,7 +74,7 @@ BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communi
   addGrid(gmin,gmax,nbin);
 }
 /// overload the constructor with some external sigmas: needed for histogram
-BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc, const vector<string> & gmin, const vector<string> & gmax, const vector<unsigned> & nbin, const vector<double> & sigma):hasgrid(false), rescaledToBias(false),histosigma(sigma),mycomm(cc) {
+BiasRepresentation::BiasRepresentation(const vector<Value*> & tmpvalues, Communicator &cc, const vector<string> & gmin, const vector<string> & gmax, const vector<unsigned> & nbin, const vector<double> & sigma):hasgrid(false), rescaledToBias(false),dofft_(false),needssync_(false),histosigma(sigma),mycomm(cc) {
   lowI_=0.0;
   uppI_=0.0;
   doInt_=false;
@@ -158,6 +163,20 @@ void BiasRepresentation::pushKernel( IFile *ifile ) {
       plumed_massert(maxi==maxv,"the input periodicity in hills and in value definition does not match"  );
     }
   }
+  // in fourier mode the scatter on the grid is deferred to completeFFTSum:
+  // here only the center and the height of the kernel are recorded
+  if(dofft_) {
+    plumed_massert(kk->isDiagonalGaussian(),"the fourier-space summation works only with diagonal gaussian kernels: rerun without FFT");
+    if(fftsigma_.size()==0) {fftsigma_=kk->getWidth();}
+    else plumed_massert(fftsigma_==kk->getWidth(),"the fourier-space summation requires all the kernels to have the same width: rerun without FFT");
+    double hh=kk->getHeight();
+    if(rescaledToBias) hh*=(biasf.back()-1.)/(biasf.back());
+    vector<double> cc(kk->getCenter());
+    for(int j=0; j<ndim; ++j) fftcenters_.push_back(cc[j]);
+    fftheights_.push_back(hh);
+    hills.emplace_back(std::move(kk));
+    return;
+  }
   // if grid is defined then it should be added on the grid
   //cerr<<"now with "<<hills.size()<<endl;
   if(hasgrid) {
@@ -166,10 +185,52 @@ void BiasRepresentation::pushKernel( IFile *ifile ) {
       nneighb=BiasGrid_->getNbin();
     } else nneighb=kk->getSupport(BiasGrid_->getDx());
     vector<Grid::index_t> neighbors=BiasGrid_->getNeighbors(kk->getCenter(),nneighb);
-    vector<double> der(ndim);
-    vector<double> xx(ndim);
-    if(mycomm.Get_size()==1) {
-      for(unsigned i=0; i<neighbors.size(); ++i) {
+    // with MPI each rank only deposits a stripe of the neighbor list into its
+    // local copy of the grid; the stripes are reduced in one shot by syncGrid()
+    // once all the kernels have been read, rather than once per kernel
+    unsigned mpistride=mycomm.Get_size();
+    unsigned mpirank=mycomm.Get_rank();
+    if(mpistride>1) needssync_=true;
+    // when the stencil is wider than a periodic box the neighbor list revisits
+    // grid points, in which case concurrent stripes would collide
+    bool stripe_safe=true;
+    vector<unsigned> nbin(BiasGrid_->getNbin());
+    for(int j=0; j<ndim; ++j) if( 2*nneighb[j]+1>nbin[j] ) stripe_safe=false;
+    unsigned nt=OpenMP::getGoodNumThreads( neighbors );
+    if(nt>1 && stripe_safe && mpistride==1) {
+      #pragma omp parallel num_threads(nt)
+      {
+        // each thread needs its own values to evaluate the kernel on
+        vector<std::unique_ptr<Value> > tvalues; vector<Value*> valptr;
+        for(int j=0; j<ndim; ++j) {
+          tvalues.emplace_back(new Value(NULL,names[j],false)); valptr.push_back(tvalues[j].get());
+          if( values[j]->isPeriodic() ) {
+            string vmin,vmax; values[j]->getDomain(vmin,vmax);
+            valptr[j]->setDomain(vmin,vmax);
+          } else valptr[j]->setNotPeriodic();
+        }
+        vector<double> der(ndim); vector<double> xx(ndim);
+        #pragma omp for
+        for(unsigned i=0; i<neighbors.size(); ++i) {
+          Grid::index_t ineigh=neighbors[i];
+          for(int j=0; j<ndim; ++j) {der[j]=0.0;}
+          BiasGrid_->getPoint(ineigh,xx);
+          for(int j=0; j<ndim; ++j) {valptr[j]->set(xx[j]);}
+          double bias;
+          if(doInt_) bias=kk->evaluate(valptr,der,true,doInt_,lowI_,uppI_);
+          else bias=kk->evaluate(valptr,der,true);
+          if(rescaledToBias) {
+            double f=(biasf.back()-1.)/(biasf.back());
+            bias*=f;
+            for(int j=0; j<ndim; ++j) {der[j]*=f;}
+          }
+          BiasGrid_->addValueAndDerivatives(ineigh,bias,der);
+        }
+      }
+    } else {
+      vector<double> der(ndim);
+      vector<double> xx(ndim);
+      for(unsigned i=mpirank; i<neighbors.size(); i+=mpistride) {
         Grid::index_t ineigh=neighbors[i];
         for(int j=0; j<ndim; ++j) {der[j]=0.0;}
         BiasGrid_->getPoint(ineigh,xx);
@@ -185,38 +246,119 @@ void BiasRepresentation::pushKernel( IFile *ifile ) {
         }
         BiasGrid_->addValueAndDerivatives(ineigh,bias,der);
       }
-    } else {
-      unsigned stride=mycomm.Get_size();
-      unsigned rank=mycomm.Get_rank();
-      vector<double> allder(ndim*neighbors.size(),0.0);
-      vector<double> allbias(neighbors.size(),0.0);
-      vector<double> tmpder(ndim);
-      for(unsigned i=rank; i<neighbors.size(); i+=stride) {
-        Grid::index_t ineigh=neighbors[i];
-        BiasGrid_->getPoint(ineigh,xx);
-        for(int j=0; j<ndim; ++j) {values[j]->set(xx[j]);}
-        if(doInt_) allbias[i]=kk->evaluate(values,der,true,doInt_,lowI_,uppI_);
-        else allbias[i]=kk->evaluate(values,der,true);
-        if(rescaledToBias) {
-          double f=(biasf.back()-1.)/(biasf.back());
-          allbias[i]*=f;
-          for(int j=0; j<ndim; ++j) {tmpder[j]*=f;}
-        }
-        // this solution with the temporary vector is rather bad, probably better to take
-        // a pointer of double as it was in old gaussian
-        for(int j=0; j<ndim; ++j) { allder[ndim*i+j]=tmpder[j]; tmpder[j]=0.;}
-      }
-      mycomm.Sum(allbias);
-      mycomm.Sum(allder);
-      for(unsigned i=0; i<neighbors.size(); ++i) {
-        Grid::index_t ineigh=neighbors[i];
-        for(int j=0; j<ndim; ++j) {der[j]=allder[ndim*i+j];}
-        BiasGrid_->addValueAndDerivatives(ineigh,allbias[i],der);
-      }
     }
   }
   hills.emplace_back(std::move(kk));
 }
+void BiasRepresentation::setFFTSum(bool doit) {
+#ifndef __PLUMED_HAS_FFTW
+  if(doit) plumed_merror("the fourier-space summation of the kernels is only available if you compile PLUMED with FFTW");
+#endif
+  if(doit) {
+    plumed_massert(hasgrid,"the fourier-space summation requires a grid representation");
+    plumed_massert(!doInt_,"the fourier-space summation cannot be used together with INTERVAL");
+  }
+  dofft_=doit;
+}
+void BiasRepresentation::completeFFTSum() {
+  if(!dofft_ || fftheights_.size()==0) return;
+#ifdef __PLUMED_HAS_FFTW
+  const vector<unsigned> npoints(BiasGrid_->getNbin());
+  const vector<double> dx(BiasGrid_->getDx());
+  const vector<bool> pbc(BiasGrid_->getIsPeriodic());
+  // pad the non periodic directions by the kernel support so that the circular
+  // convolution cannot wrap the gaussian tails back onto the grid
+  vector<unsigned> support(hills.back()->getSupport(dx));
+  vector<int> np(ndim); vector<unsigned> pad(ndim);
+  size_t ptot=1;
+  for(int j=0; j<ndim; ++j) {
+    pad[j]= pbc[j] ? 0 : support[j];
+    np[j]=static_cast<int>(npoints[j]+2*pad[j]);
+    ptot*=static_cast<size_t>(np[j]);
+  }
+  // histogram of the centers: each kernel deposits its height on the nearest
+  // grid point, so the grid should be fine compared to the kernel width
+  vector<std::complex<double> > hist(ptot,std::complex<double>(0.,0.));
+  vector<double> cc(ndim), pp(ndim); vector<unsigned> ind(ndim);
+  for(unsigned k=0; k<fftheights_.size(); ++k) {
+    for(int j=0; j<ndim; ++j) cc[j]=fftcenters_[k*ndim+j];
+    BiasGrid_->getIndices(cc,ind); BiasGrid_->getPoint(ind,pp);
+    size_t flat=0;
+    for(int j=0; j<ndim; ++j) {
+      unsigned ij=ind[j];
+      if( cc[j]-pp[j]>0.5*dx[j] ) ij+=1;
+      if( pbc[j] && ij>=npoints[j] ) ij-=npoints[j];
+      plumed_massert(ij<npoints[j],"found a center outside the grid: the fourier-space summation requires a grid covering all the centers");
+      flat=flat*static_cast<size_t>(np[j])+static_cast<size_t>(ij+pad[j]);
+    }
+    hist[flat]+=std::complex<double>(fftheights_[k],0.);
+  }
+  // sample the unit height kernel and its analytic derivatives on the padded
+  // box, wrapped so that the center sits on the first point as required by
+  // the circular convolution
+  vector<std::complex<double> > kern(ptot);
+  vector<vector<std::complex<double> > > dkern(ndim,vector<std::complex<double> >(ptot));
+  vector<unsigned> kind(ndim,0); vector<double> dist(ndim);
+  for(size_t i=0; i<ptot; ++i) {
+    double r2=0.;
+    for(int j=0; j<ndim; ++j) {
+      double d;
+      if( kind[j]<=static_cast<unsigned>(np[j]/2) ) d=kind[j]*dx[j];
+      else d=(static_cast<double>(kind[j])-static_cast<double>(np[j]))*dx[j];
+      dist[j]=d; r2+=(d/fftsigma_[j])*(d/fftsigma_[j]);
+    }
+    double kv=std::exp(-0.5*r2);
+    kern[i]=std::complex<double>(kv,0.);
+    for(int j=0; j<ndim; ++j) dkern[j][i]=std::complex<double>(-dist[j]*kv/(fftsigma_[j]*fftsigma_[j]),0.);
+    // advance the indices, last dimension runs fastest as in the flat index above
+    for(int j=ndim-1; j>=0; --j) { kind[j]++; if(kind[j]<static_cast<unsigned>(np[j])) break; kind[j]=0; }
+  }
+  // transform the histogram once, then convolve value and derivative kernels
+  vector<std::complex<double> > fhist(ptot), fwork(ptot);
+  fftw_plan ph=fftw_plan_dft(ndim,np.data(),reinterpret_cast<fftw_complex*>(hist.data()),reinterpret_cast<fftw_complex*>(fhist.data()),FFTW_FORWARD,FFTW_ESTIMATE);
+  fftw_execute(ph); fftw_destroy_plan(ph);
+  for(int j=-1; j<ndim; ++j) {
+    vector<std::complex<double> > & karr( j<0 ? kern : dkern[j] );
+    fftw_plan pf=fftw_plan_dft(ndim,np.data(),reinterpret_cast<fftw_complex*>(karr.data()),reinterpret_cast<fftw_complex*>(fwork.data()),FFTW_FORWARD,FFTW_ESTIMATE);
+    fftw_execute(pf); fftw_destroy_plan(pf);
+    for(size_t i=0; i<ptot; ++i) fwork[i]*=fhist[i];
+    fftw_plan pb=fftw_plan_dft(ndim,np.data(),reinterpret_cast<fftw_complex*>(fwork.data()),reinterpret_cast<fftw_complex*>(karr.data()),FFTW_BACKWARD,FFTW_ESTIMATE);
+    fftw_execute(pb); fftw_destroy_plan(pb);
+  }
+  // fftw transforms are unnormalized: a forward/backward pair scales by ptot
+  const double scale=1.0/static_cast<double>(ptot);
+  vector<double> der(ndim);
+  for(Grid::index_t i=0; i<BiasGrid_->getSize(); ++i) {
+    BiasGrid_->getIndices(i,ind);
+    size_t flat=0;
+    for(int j=0; j<ndim; ++j) flat=flat*static_cast<size_t>(np[j])+static_cast<size_t>(ind[j]+pad[j]);
+    for(int j=0; j<ndim; ++j) der[j]=dkern[j][flat].real()*scale;
+    BiasGrid_->addValueAndDerivatives(i,kern[flat].real()*scale,der);
+  }
+  fftcenters_.clear(); fftheights_.clear();
+#endif
+}
+void BiasRepresentation::syncGrid() {
+  if(!needssync_) return;
+  const Grid::index_t nn=BiasGrid_->getSize();
+  const unsigned nd=BiasGrid_->getDimension();
+  if( syncval_.size()!=nn ) { syncval_.assign(nn,0.0); syncder_.assign(nd*nn,0.0); }
+  // reduce only what was deposited since the last reduction, as after that
+  // every rank already holds the full grid
+  vector<double> val(nn,0.0), der(nd*nn,0.0), tmpder(nd);
+  for(Grid::index_t i=0; i<nn; ++i) {
+    val[i]=BiasGrid_->getValueAndDerivatives(i,tmpder)-syncval_[i];
+    for(unsigned j=0; j<nd; ++j) der[nd*i+j]=tmpder[j]-syncder_[nd*i+j];
+  }
+  mycomm.Sum(val);
+  mycomm.Sum(der);
+  for(Grid::index_t i=0; i<nn; ++i) {
+    syncval_[i]+=val[i];
+    for(unsigned j=0; j<nd; ++j) { syncder_[nd*i+j]+=der[nd*i+j]; tmpder[j]=syncder_[nd*i+j]; }
+    BiasGrid_->setValueAndDerivatives(i,syncval_[i],tmpder);
+  }
+  needssync_=false;
+}
 int BiasRepresentation::getNumberOfKernels() {
   return hills.size();
 }
@@ -260,6 +402,11 @@ void BiasRepresentation::getMinMaxBin(vector<double> &vmin, vector<double> &vmax
 }
 void BiasRepresentation::clear() {
   hills.clear();
+  fftcenters_.clear();
+  fftheights_.clear();
+  syncval_.clear();
+  syncder_.clear();
+  needssync_=false;
   // clear the grid
   if(hasgrid) {
     BiasGrid_->clear();
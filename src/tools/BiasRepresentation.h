@@ -61,6 +61,19 @@ public:
   void 		addGrid(const std::vector<std::string> & gmin, const std::vector<std::string> & gmax, const std::vector<unsigned> & nbin );
   /// push a kernel on the representation (includes widths and height)
   void 		pushKernel( IFile * ff);
+  /// activate the fourier-space summation of the kernels: instead of being
+  /// scattered on the grid one by one, the kernels are only recorded by
+  /// pushKernel and summed in one shot by completeFFTSum. Requires FFTW
+  /// and diagonal gaussian kernels of uniform width
+  void 		setFFTSum(bool doit);
+  /// histogram the centers recorded while in fourier mode and convolve them
+  /// with the common gaussian kernel; the result is added to the grid.
+  /// This is a no op when the fourier mode is off or no kernel is pending
+  void 		completeFFTSum();
+  /// reduce the per-rank grid stripes into the full grid. When running with
+  /// MPI each rank only deposits its own stripe of every kernel, so this must
+  /// be called before the grid is read out. No op in serial or when up to date
+  void 		syncGrid();
   /// set the flag that rescales the free energy to the bias
   void 		setRescaledToBias(bool rescaled);
   /// check if the representation is rescaled to the bias
@@ -90,6 +103,19 @@ private:
   bool hasgrid;
   bool rescaledToBias;
   bool doInt_;
+/// when true the kernels are summed in fourier space by completeFFTSum
+  bool dofft_;
+/// centers (flat, ndim per kernel) and heights recorded in fourier mode
+  std::vector<double> fftcenters_;
+  std::vector<double> fftheights_;
+/// the common width of the kernels recorded in fourier mode
+  std::vector<double> fftsigma_;
+/// true when the grid holds unreduced per-rank stripes
+  bool needssync_;
+/// snapshot of the grid at the last reduction, needed to reduce only the
+/// stripes deposited since then
+  std::vector<double> syncval_;
+  std::vector<double> syncder_;
   double lowI_;
   double uppI_;
   std::vector<Value*> values;
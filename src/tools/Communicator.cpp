@@ -172,6 +172,88 @@ Communicator::Request Communicator::Isend(ConstData data,int source,int tag) {
   return req;
 }
 
+Communicator::Request Communicator::Isum(Data data) {
+  Request req;
+#ifdef __PLUMED_HAS_MPI
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+#if MPI_VERSION>=3
+  MPI_Iallreduce(MPI_IN_PLACE,data.pointer,data.size,data.type,MPI_SUM,communicator,&req.r);
+#else
+  MPI_Allreduce(MPI_IN_PLACE,data.pointer,data.size,data.type,MPI_SUM,communicator);
+  req.r=MPI_REQUEST_NULL;
+#endif
+#else
+  (void) data;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+  return req;
+}
+
+Communicator::Request Communicator::Irecv(Data data,int source,int tag) {
+  Request req;
+#ifdef __PLUMED_HAS_MPI
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+  MPI_Irecv(data.pointer,data.size,data.type,source,tag,communicator,&req.r);
+#else
+  (void) data;
+  (void) source;
+  (void) tag;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+  return req;
+}
+
+Communicator::Request Communicator::SendInit(ConstData data,int dest,int tag) {
+  Request req;
+#ifdef __PLUMED_HAS_MPI
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+  void*s=const_cast<void*>((const void*)data.pointer);
+  MPI_Send_init(s,data.size,data.type,dest,tag,communicator,&req.r);
+#else
+  (void) data;
+  (void) dest;
+  (void) tag;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+  return req;
+}
+
+Communicator::Request Communicator::RecvInit(Data data,int source,int tag) {
+  Request req;
+#ifdef __PLUMED_HAS_MPI
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+  MPI_Recv_init(data.pointer,data.size,data.type,source,tag,communicator,&req.r);
+#else
+  (void) data;
+  (void) source;
+  (void) tag;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+  return req;
+}
+
+void Communicator::Start(Request&req) {
+#ifdef __PLUMED_HAS_MPI
+  MPI_Start(&req.r);
+#else
+  (void) req;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+}
+
+void Communicator::StartAll(std::vector<Request>&reqs) {
+  for(unsigned i=0; i<reqs.size(); ++i) Start(reqs[i]);
+}
+
+void Communicator::Free(Request&req) {
+#ifdef __PLUMED_HAS_MPI
+  MPI_Request_free(&req.r);
+#else
+  (void) req;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+}
+
 void Communicator::Allgatherv(ConstData in,Data out,const int*recvcounts,const int*displs) {
   void*s=const_cast<void*>((const void*)in.pointer);
   void*r=const_cast<void*>((const void*)out.pointer);
@@ -299,6 +381,20 @@ void Communicator::Split(int color,int key,Communicator&pc)const {
 #endif
 }
 
+void Communicator::SplitByNode(int key,Communicator&pc)const {
+#ifdef __PLUMED_HAS_MPI
+#if MPI_VERSION>=3
+  MPI_Comm_split_type(communicator,MPI_COMM_TYPE_SHARED,key,MPI_INFO_NULL,&pc.communicator);
+#else
+  MPI_Comm_split(communicator,0,key,&pc.communicator);
+#endif
+#else
+  (void) key;
+  (void) pc;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+}
+
 int Communicator::Status::Get_count(MPI_Datatype type)const {
   int i;
 #ifdef __PLUMED_HAS_MPI
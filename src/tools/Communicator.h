@@ -209,6 +209,40 @@ public:
   template <class T> Request Isend(const T*buf,int count,int source,int tag) {return Isend(ConstData(buf,count),source,tag);}
 /// Wrapper for MPI_Isend (reference)
   template <class T> Request Isend(const T&buf,int source,int tag) {return Isend(ConstData(buf),source,tag);}
+/// Wrapper for MPI_Irecv (data struct)
+  Request Irecv(Data,int,int);
+/// Wrapper for MPI_Irecv (pointer)
+  template <class T> Request Irecv(T*buf,int count,int source,int tag) {return Irecv(Data(buf,count),source,tag);}
+/// Wrapper for MPI_Irecv (reference)
+  template <class T> Request Irecv(T&buf,int source,int tag) {return Irecv(Data(buf),source,tag);}
+
+/// Wrapper for MPI_Iallreduce with MPI_SUM, summing in place (data struct).
+/// With pre MPI-3 libraries the sum is performed immediately and the
+/// returned request completes at once
+  Request Isum(Data);
+/// Wrapper for MPI_Iallreduce with MPI_SUM (pointer)
+  template <class T> Request Isum(T*buf,int count) {return Isum(Data(buf,count));}
+/// Wrapper for MPI_Iallreduce with MPI_SUM (reference)
+  template <class T> Request Isum(T&buf) {return Isum(Data(buf));}
+
+/// Wrapper for MPI_Send_init (data struct).
+/// The returned request is persistent: activate it with Start() or StartAll(),
+/// complete it with wait(), and release it with Free().  Useful for recurring
+/// exchanges with fixed buffers and sizes, where it avoids the per-call setup
+/// cost of Isend
+  Request SendInit(ConstData,int,int);
+/// Wrapper for MPI_Send_init (pointer)
+  template <class T> Request SendInit(const T*buf,int count,int dest,int tag) {return SendInit(ConstData(buf,count),dest,tag);}
+/// Wrapper for MPI_Recv_init (data struct)
+  Request RecvInit(Data,int,int);
+/// Wrapper for MPI_Recv_init (pointer)
+  template <class T> Request RecvInit(T*buf,int count,int source,int tag) {return RecvInit(Data(buf,count),source,tag);}
+/// Wrapper for MPI_Start
+  static void Start(Request&);
+/// Start a whole set of persistent requests
+  static void StartAll(std::vector<Request>&);
+/// Wrapper for MPI_Request_free, to be used on persistent requests only
+  static void Free(Request&);
 
 /// Wrapper for MPI_Allgatherv (data struct)
   void Allgatherv(ConstData in,Data out,const int*,const int*);
@@ -241,6 +275,10 @@ public:
 
 /// Wrapper to MPI_Comm_split
   void Split(int,int,Communicator&)const;
+///// Wrapper to MPI_Comm_split_type with MPI_COMM_TYPE_SHARED: groups the
+/// processes that can share memory (i.e. that run on the same node).
+/// With pre MPI-3 libraries all the processes end up in a single group
+  void SplitByNode(int,Communicator&)const;
 };
 
 }
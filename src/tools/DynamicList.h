@@ -205,8 +205,18 @@ public:
   void sortActiveList();
 /// Retriee the list of active objects
   std::vector<T> retrieveActiveList();
+/// Return a pointer to the first of the getNumberActive() positions in the
+/// full list that are currently active.  Notice that these are positions and
+/// not values: they only coincide with the values returned by operator[]
+/// when the list was created from an identity map
+  const unsigned* getActivePositions() const;
 };
 
+template <typename T>
+const unsigned* DynamicList<T>::getActivePositions() const {
+  return active.data();
+}
+
 template <typename T>
 std::vector<T> DynamicList<T>::retrieveActiveList() {
   std::vector<T> this_active(nactive);
@@ -62,13 +62,28 @@ void ERMSD::setReference(const vector<Vector> & reference, const std::vector<uns
   }
 
   cutoff = mycutoff;
+  // the skin is half the interaction range maxdist=cutoff/2: wide enough that
+  // the list survives several steps, narrow enough not to inflate it
+  skin = 0.25*cutoff;
+  // lookup table so that pair membership is tested in constant time
+  pair_map.assign( nresidues*nresidues, false );
+  for(unsigned i=0; i<npairs; ++i) {
+    pair_map[ pairs[i].first*nresidues + pairs[i].second ] = true;
+    pair_map[ pairs[i].second*nresidues + pairs[i].first ] = true;
+  }
+  // force a rebuild of the pair list and forget stale bookkeeping
+  nl_centers.clear(); touched.clear();
+
   std::vector<TensorGeneric<4,3> > deri;
   deri.resize(natoms*natoms);
-  reference_mat.resize(nresidues*nresidues);
+  reference_mat.clear(); reference_mat.resize(nresidues*nresidues);
   Pbc fake_pbc;
 
 
   calcMat(reference,fake_pbc,reference_mat,deri);
+  // the reference pass must not leave its written entries in the lazy-zero
+  // list, as they belong to reference_mat rather than to the running matrix
+  touched.clear(); nl_centers.clear();
 
 }
 
@@ -77,12 +92,7 @@ bool ERMSD::inPair(unsigned i, unsigned j) {
 
   //return true;
   if(pairs.size()==0) return true;
-  for(unsigned idx=0; idx<pairs.size(); idx++) {
-    //std::cout << "AAA " << pairs[idx][0] << " " << pairs[idx][1] << "\n";
-    if(pairs[idx].first == i && pairs[idx].second == j) return true;
-    if(pairs[idx].second == i && pairs[idx].first == j) return true;
-  }
-  return false;
+  return pair_map[ i*nresidues + j ];
 }
 //double ERMSD::calculate(const std::vector<Vector> & positions,
 //                        std::vector<Vector> &derivatives, Tensor& virial) const {
@@ -177,32 +187,57 @@ void ERMSD::calcMat(const std::vector<Vector> & positions,const Pbc& pbc, std::v
   }
 
 
-  // Initialization (unnecessary?)
-  for (unsigned i1=0; i1<nresidues*nresidues; i1++) {
-    for (unsigned i2=0; i2<4; i2++) {
-      mat[i1][i2] = 0.0;
-    }
+  // Lazily zero only the entries that were written on the previous invocation,
+  // rather than rescanning the whole matrix
+  for (unsigned t=0; t<touched.size(); t++) {
+    mat[touched[t]].zero();
+    for (unsigned l=0; l<6; l++) Gderi[6*touched[t]+l].zero();
   }
+  touched.resize(0);
 
   double maxdist = cutoff/form_factor[0];
   double gamma = pi/cutoff;
   unsigned idx;
   unsigned idx1 = 0;
-  // Calculate mat
-  for (unsigned i=0; i<nresidues; i++) {
-    for (unsigned j=0; j<nresidues; j++) {
 
-      // skip i==j
-      if(inPair(i,j) and i != j) {
-        //if(i!=j){
+  // Refresh the candidate pair list when the centers have moved by more than
+  // half the skin since it was last built
+  bool rebuild = ( nl_centers.size()!=nresidues );
+  if(!rebuild) {
+    double maxdisp2=0.;
+    for (unsigned i=0; i<nresidues; i++) {
+      double d2=delta(nl_centers[i],centers[i]).modulo2();
+      if(d2>maxdisp2) maxdisp2=d2;
+    }
+    if(maxdisp2 > 0.25*skin*skin) rebuild=true;
+  }
+  if(rebuild) {
+    nl_pairs.resize(0); nl_centers=centers;
+    double nl_dist2 = (maxdist+skin)*(maxdist+skin);
+    for (unsigned i=0; i<nresidues; i++) {
+      for (unsigned j=i+1; j<nresidues; j++) {
+        if( !inPair(i,j) ) continue;
+        if( delta(centers[i],centers[j]).modulo2()<nl_dist2 ) nl_pairs.push_back(std::pair<unsigned,unsigned>(i,j));
+      }
+    }
+  }
+
+  std::vector<Tensor3d> drtilde_dx(6);
+  // Calculate mat over the retained pairs; the matrix is not symmetric so both
+  // orientations of each pair are evaluated
+  for (unsigned ipair=0; ipair<nl_pairs.size(); ipair++) {
 
+    // Calculate normal distance first
+    Vector pdiff = delta(centers[nl_pairs[ipair].first],centers[nl_pairs[ipair].second]);
+    double d1 = pdiff.modulo();
+    if(d1<maxdist) {
 
-        // Calculate normal distance first
-        Vector diff = delta(centers[i],centers[j]);
-        double d1 = diff.modulo();
-        //std::cout << inPair(i,j) << " " << i << " " << j << " "<< d1 <<"\n";
-        //std::cout << inPair(i,j) << " " << i << " " << j << " "<< d1 <<"\n";
-        if(d1<maxdist) {
+      for (unsigned dir=0; dir<2; dir++) {
+        unsigned i = (dir==0) ? nl_pairs[ipair].first  : nl_pairs[ipair].second;
+        unsigned j = (dir==0) ? nl_pairs[ipair].second : nl_pairs[ipair].first;
+        Vector diff = (dir==0) ? pdiff : -pdiff;
+
+        {
 
           // calculate r_tilde_ij
           Vector3d rtilde;
@@ -218,6 +253,7 @@ void ERMSD::calcMat(const std::vector<Vector> & positions,const Pbc& pbc, std::v
           // ellipsoidal cutoff
           if(rtilde_norm < cutoff) {
             idx = i*nresidues + j;
+            touched.push_back(idx);
             //std::cout << i << " " << j << " " << rtilde_norm << " " << idx <<"\n";
 
 
@@ -229,8 +265,6 @@ void ERMSD::calcMat(const std::vector<Vector> & positions,const Pbc& pbc, std::v
             mat[idx][3] = (1.+ cos(gamma*rtilde_norm))/gamma;
 
             // Derivative (drtilde_dx)
-            std::vector<Tensor3d> drtilde_dx;
-            drtilde_dx.resize(6);
             unsigned pos_idx = 3*i;
             unsigned deri_idx = 9*i;
             for (unsigned at=0; at<3; at++) {
@@ -287,20 +321,22 @@ double ERMSD::calculate(const std::vector<Vector> & positions,const Pbc& pbc,\
 
 
   double ermsd=0.;
-  std::vector<Vector4d> mat;
-  mat.resize(nresidues*nresidues);
-
-  std::vector<TensorGeneric<4,3> > Gderi;
-  Gderi.resize(natoms*natoms);
+  // persistent workspace: these arrays run to tens of megabytes for a couple
+  // of hundred residues, so they are sized once and calcMat zeroes lazily the
+  // entries it wrote on the previous step
+  if( Gmat.size()!=nresidues*nresidues ) {
+    Gmat.clear(); Gmat.resize(nresidues*nresidues);
+    Gderi.clear(); Gderi.resize(6*nresidues*nresidues);
+  }
 
-  calcMat(positions,pbc,mat,Gderi);
+  calcMat(positions,pbc,Gmat,Gderi);
 
   unsigned idx1 = 0;
   for(unsigned i=0; i<nresidues; i++) {
     for(unsigned j=0; j<nresidues; j++) {
       unsigned ii = i*nresidues + j;
 
-      Vector4d dd = delta(reference_mat[ii],mat[ii]);
+      Vector4d dd = delta(reference_mat[ii],Gmat[ii]);
       double val = dd.modulo2();
       //std::cout << "AAA " << i << " " << j << " " << ii << " "<< val << "\n";
 
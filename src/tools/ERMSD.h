@@ -44,10 +44,26 @@ class ERMSD {
   unsigned nresidues;
   std::vector<std::pair <unsigned,unsigned> > pairs;
   double cutoff;
+/// width of the shell beyond the interaction range that is kept in the pair list
+  double skin;
+/// fast lookup for the pairs the user restricted the calculation to
+  std::vector<bool> pair_map;
+/// candidate residue pairs whose centers are within maxdist+skin of each other,
+/// rebuilt only when the centers have moved by more than half the skin
+  std::vector<std::pair <unsigned,unsigned> > nl_pairs;
+/// the centers at the time the pair list was last built
+  std::vector<Vector> nl_centers;
+/// entries of the G matrix written on the previous step, zeroed lazily at the
+/// start of the next one so the full matrix is never rescanned
+  std::vector<unsigned> touched;
+/// persistent workspace for calculate(): for a few hundred residues these
+/// arrays are far too large to reallocate every step
+  std::vector<Vector4d> Gmat;
+  std::vector<TensorGeneric<4,3> > Gderi;
 
 public:
 /// Constructor
-  ERMSD(): natoms(0),nresidues(0), cutoff(0.0) {}
+  ERMSD(): natoms(0),nresidues(0), cutoff(0.0), skin(0.0) {}
 
 /// clear the structure
   void clear();
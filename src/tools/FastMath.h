@@ -0,0 +1,205 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_FastMath_h
+#define __PLUMED_tools_FastMath_h
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+Branch free polynomial kernels for the transcendental functions that show
+up in hot loops (Gaussian hills, switching functions, Debye sums).
+
+The scalar forms avoid the libm call overhead and, more importantly, the
+block forms are written so that the compiler can vectorize them with the
+SIMD instruction set it is targeting (SSE/AVX/NEON), which a loop of libm
+calls prevents.  The precision of each kernel is stated in its doc
+comment; all of them are accurate to far better than the precision with
+which results are ever printed or compared, but they are approximations,
+so code that needs correctly rounded results at the edges of the range
+should keep calling libm.
+*/
+class FastMath {
+/// Constants for the range reduction of exp against powers of two
+  static constexpr double log2e=1.4426950408889634074;
+  static constexpr double ln2hi=0.69314718036912381649;
+  static constexpr double ln2lo=1.9082149292705877e-10;
+/// Split of pi/2 in three parts for the Cody-Waite reduction in sincos
+  static constexpr double pio2hi=1.57079632673412561417e+00;
+  static constexpr double pio2mid=6.07710050650619224932e-11;
+  static constexpr double pio2lo=2.02226624879595063154e-21;
+/// Core of exp once the argument has been clamped to [-708,709]
+  static double expKernel( const double x );
+/// Arctangent on [-tan(pi/8),tan(pi/8)], used by atan2 after reduction
+  static double atanKernel( const double t );
+public:
+/// Exponential with relative error below 1e-14.  The argument is clamped
+/// to [-708,709], so the result saturates instead of overflowing to
+/// infinity or underflowing through the subnormal range
+  static double exp( const double x );
+/// Block form of exp: y[i]=exp(x[i]) for i<n
+  static void exp( const double* x, double* y, const unsigned n );
+/// Error function with relative error below 1e-15, following the rational
+/// approximations of W. J. Cody (Math. Comp. 23, 1969)
+  static double erf( const double x );
+/// Block form of erf: y[i]=erf(x[i]) for i<n
+  static void erf( const double* x, double* y, const unsigned n );
+/// Evaluate sine and cosine together on a block: s[i]=sin(x[i]) and
+/// c[i]=cos(x[i]) for i<n.  The absolute error is below 1e-13; the
+/// quadrant is located with an int, so |x| must stay below 2^31*pi/2
+  static void sincos( const double* x, double* s, double* c, const unsigned n );
+/// Four-quadrant arctangent with absolute error below 1e-14.  Signed
+/// zeros are not honoured: atan2(+-0,x) returns 0 for x>=0 and pi for
+/// x<0, and atan2 of two zeros returns 0
+  static double atan2( const double y, const double x );
+/// Block form of atan2: r[i]=atan2(y[i],x[i]) for i<n
+  static void atan2( const double* y, const double* x, double* r, const unsigned n );
+};
+
+inline
+double FastMath::expKernel( const double x ) {
+  const double k=std::floor(x*log2e+0.5);
+  const double r=(x-k*ln2hi)-k*ln2lo;
+// degree 11 Taylor polynomial on |r|<=0.5*ln2, truncation below 1e-15
+  const double p=1.0+r*(1.0+r*(1.0/2.0+r*(1.0/6.0+r*(1.0/24.0+r*(1.0/120.0+r*(1.0/720.0+r*(1.0/5040.0+r*(1.0/40320.0+r*(1.0/362880.0+r*(1.0/3628800.0+r/39916800.0))))))))));
+// scale by 2^k through the exponent bits; the clamp done by the callers
+// guarantees that k+1023 is a valid biased exponent
+  const std::int64_t ik=static_cast<std::int64_t>(k);
+  const std::uint64_t bits=static_cast<std::uint64_t>(ik+1023)<<52;
+  double scale; std::memcpy(&scale,&bits,sizeof(scale));
+  return p*scale;
+}
+
+inline
+double FastMath::exp( const double x ) {
+  return expKernel( std::min(709.0,std::max(-708.0,x)) );
+}
+
+inline
+void FastMath::exp( const double* x, double* y, const unsigned n ) {
+  for(unsigned i=0; i<n; i++) y[i]=expKernel( std::min(709.0,std::max(-708.0,x[i])) );
+}
+
+inline
+double FastMath::erf( const double x ) {
+  const double y=std::fabs(x);
+  if( y<=0.46875 ) {
+    const double z=y*y;
+    double num=1.85777706184603153e-1*z;
+    double den=z;
+    num=(num+3.16112374387056560e+0)*z; den=(den+2.36012909523441209e+1)*z;
+    num=(num+1.13864154151050156e+2)*z; den=(den+2.44024637934444173e+2)*z;
+    num=(num+3.77485237685302021e+2)*z; den=(den+1.28261652607737228e+3)*z;
+    return x*(num+3.20937758913846947e+3)/(den+2.84423683343917062e+3);
+  }
+  double erfc;
+  if( y<=4.0 ) {
+    double num=2.15311535474403846e-8*y;
+    double den=y;
+    num=(num+5.64188496988670089e-1)*y; den=(den+1.57449261107098347e+1)*y;
+    num=(num+8.88314979438837594e+0)*y; den=(den+1.17693950891312499e+2)*y;
+    num=(num+6.61191906371416295e+1)*y; den=(den+5.37181101862009858e+2)*y;
+    num=(num+2.98635138197400131e+2)*y; den=(den+1.62138957456669019e+3)*y;
+    num=(num+8.81952221241769090e+2)*y; den=(den+3.29079923573345963e+3)*y;
+    num=(num+1.71204761263407058e+3)*y; den=(den+4.36261909014324716e+3)*y;
+    num=(num+2.05107837782607147e+3)*y; den=(den+3.43936767414372164e+3)*y;
+    erfc=std::exp(-y*y)*(num+1.23033935479799725e+3)/(den+1.23033935480374942e+3);
+  } else if( y<27.0 ) {
+    const double z=1.0/(y*y);
+    double num=1.63153871373020978e-2*z;
+    double den=z;
+    num=(num+3.05326634961232344e-1)*z; den=(den+2.56852019228982242e+0)*z;
+    num=(num+3.60344899949804439e-1)*z; den=(den+1.87295284992346047e+0)*z;
+    num=(num+1.25781726111229246e-1)*z; den=(den+5.27905102951428412e-1)*z;
+    num=(num+1.60837851487422766e-2)*z; den=(den+6.05183413124413191e-2)*z;
+    const double r=z*(num+6.58749161529837803e-4)/(den+2.33520497626869185e-3);
+    erfc=(std::exp(-y*y)/y)*(5.6418958354775628695e-1-r);
+  } else {
+    erfc=0.0;
+  }
+  return (x<0.0) ? erfc-1.0 : 1.0-erfc;
+}
+
+inline
+void FastMath::erf( const double* x, double* y, const unsigned n ) {
+  for(unsigned i=0; i<n; i++) y[i]=erf(x[i]);
+}
+
+inline
+void FastMath::sincos( const double* x, double* s, double* c, const unsigned n ) {
+  for(unsigned i=0; i<n; i++) {
+    const int k=static_cast<int>(std::nearbyint(x[i]*0.63661977236758134308)); // 2/pi
+    const double dk=static_cast<double>(k);
+    const double y=((x[i]-dk*pio2hi)-dk*pio2mid)-dk*pio2lo;
+    const double z=y*y;
+    const double sy=y*(1.0+z*(-1.0/6.0+z*(1.0/120.0+z*(-1.0/5040.0+z*(1.0/362880.0+z*(-1.0/39916800.0+z*(1.0/6227020800.0)))))));
+    const double cy=1.0+z*(-0.5+z*(1.0/24.0+z*(-1.0/720.0+z*(1.0/40320.0+z*(-1.0/3628800.0+z*(1.0/479001600.0+z*(-1.0/87178291200.0)))))));
+    const int q=k&3;
+    const double ss=(q&1) ? cy : sy;
+    const double cc=(q&1) ? sy : cy;
+    s[i]=(q&2) ? -ss : ss;
+    c[i]=((q+1)&2) ? -cc : cc;
+  }
+}
+
+inline
+double FastMath::atanKernel( const double t ) {
+// Taylor polynomial with odd powers up to 33; on |t|<=tan(pi/8) the
+// truncation is below 1e-14
+  const double z=t*t;
+  double p=1.0/33.0;
+  p=-1.0/31.0+z*p; p=1.0/29.0+z*p; p=-1.0/27.0+z*p; p=1.0/25.0+z*p;
+  p=-1.0/23.0+z*p; p=1.0/21.0+z*p; p=-1.0/19.0+z*p; p=1.0/17.0+z*p;
+  p=-1.0/15.0+z*p; p=1.0/13.0+z*p; p=-1.0/11.0+z*p; p=1.0/9.0+z*p;
+  p=-1.0/7.0+z*p;  p=1.0/5.0+z*p;  p=-1.0/3.0+z*p;  p=1.0+z*p;
+  return t*p;
+}
+
+inline
+double FastMath::atan2( const double y, const double x ) {
+  const double ax=std::fabs(x), ay=std::fabs(y);
+  const double mx=std::max(ax,ay), mn=std::min(ax,ay);
+  if(mx==0.0) return 0.0;
+  double t=mn/mx;
+  double base=0.0;
+// reduce to |t|<=tan(pi/8) through atan(t)=pi/4+atan((t-1)/(t+1))
+  if(t>0.41421356237309503) { base=0.78539816339744830962; t=(t-1.0)/(t+1.0); }
+  double r=base+atanKernel(t);
+// undo the |y|/|x| ordering and place the result in the right quadrant
+  if(ay>ax) r=1.57079632679489661923-r;
+  if(x<0.0) r=3.14159265358979323846-r;
+  return (y<0.0) ? -r : r;
+}
+
+inline
+void FastMath::atan2( const double* y, const double* x, double* r, const unsigned n ) {
+  for(unsigned i=0; i<n; i++) r[i]=atan2(y[i],x[i]);
+}
+
+}
+
+#endif
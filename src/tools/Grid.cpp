@@ -28,14 +28,17 @@
 #include "KernelFunctions.h"
 #include "RootFindingBase.h"
 #include "Communicator.h"
+#include "OpenMP.h"
 
 #include <vector>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <cstdio>
 #include <cfloat>
 #include <array>
+#include <algorithm>
 
 using namespace std;
 namespace PLMD {
@@ -112,6 +115,8 @@ void GridBase::Init(const std::string& funcl, const std::vector<std::string> &na
   dospline_=dospline;
   usederiv_=usederiv;
   if(dospline_) plumed_assert(dospline_==usederiv_);
+  use_spline_cache_=false;
+  edit_version_=0;
   maxsize_=1;
   for(unsigned int i=0; i<dimension_; ++i) {
     dx_.push_back( (max_[i]-min_[i])/static_cast<double>( nbin_[i] ) );
@@ -337,6 +342,84 @@ void GridBase::getSplineNeighbors(const vector<unsigned> & indices, vector<GridB
   }
 }
 
+void GridBase::enableSplineCoefficientCache() {
+  plumed_massert(dospline_ && usederiv_,"the spline coefficient cache requires spline interpolation");
+  plumed_assert(dimension_<32);
+  use_spline_cache_=true;
+}
+
+void GridBase::buildSplineCacheEntry(const vector<unsigned>& indices, SplineCacheEntry& entry) const {
+  vector<index_t> neigh;
+  unsigned nneigh;
+  getSplineNeighbors(indices,neigh,nneigh);
+  const unsigned stride=2+dimension_;
+  entry.nneigh=nneigh;
+  entry.data.assign(nneigh*stride,0.0);
+  entry.version=edit_version_;
+  vector<double> dder(dimension_);
+  vector<unsigned> nindices(dimension_);
+  for(unsigned ipoint=0; ipoint<nneigh; ++ipoint) {
+    double grid=getValueAndDerivatives(neigh[ipoint],dder);
+    getIndices(neigh[ipoint],nindices);
+    double* e=&entry.data[ipoint*stride];
+    e[0]=grid;
+    unsigned mask=0;
+    for(unsigned j=0; j<dimension_; ++j) {
+      if(nindices[j]!=indices[j]) mask|=(1u<<j);
+      double yy;
+      if(fabs(grid)<0.0000001) yy=0.0;
+      else yy=-dder[j]/grid;
+      e[2+j]=yy;
+    }
+    e[1]=static_cast<double>(mask);
+  }
+}
+
+double GridBase::splineCacheLookup(const vector<double>& x, const vector<unsigned>& indices, vector<double>& der) const {
+  const index_t cell=getIndex(indices);
+  SplineCacheEntry & entry=spline_cache_[cell];
+  if(entry.data.empty() || entry.version!=edit_version_) buildSplineCacheEntry(indices,entry);
+
+  double X,X2,X3,value;
+  std::array<double,maxdim> fd, C, D;
+  value=0.0;
+  for(unsigned int i=0; i<dimension_; ++i) der[i]=0.0;
+
+  vector<double> xfloor(dimension_);
+  getPoint(indices, xfloor);
+
+// same arithmetics and neighbor order as the uncached lookup, so that the
+// result is identical to the last bit; what is saved is the per-neighbor
+// point gathering, index decoding and derivative/value division
+  const unsigned stride=2+dimension_;
+  for(unsigned int ipoint=0; ipoint<entry.nneigh; ++ipoint) {
+    const double* e=&entry.data[ipoint*stride];
+    const double grid=e[0];
+    const unsigned mask=static_cast<unsigned>(e[1]);
+    double ff=1.0;
+
+    for(unsigned j=0; j<dimension_; ++j) {
+      const int x0=(mask>>j)&1;
+      double dx=getDx(j);
+      X=fabs((x[j]-xfloor[j])/dx-(double)x0);
+      X2=X*X;
+      X3=X2*X;
+      const double yy=e[2+j];
+      C[j]=(1.0-3.0*X2+2.0*X3) - (x0?-1.0:1.0)*yy*(X-2.0*X2+X3)*dx;
+      D[j]=( -6.0*X +6.0*X2) - (x0?-1.0:1.0)*yy*(1.0-4.0*X +3.0*X2)*dx;
+      D[j]*=(x0?-1.0:1.0)/dx;
+      ff*=C[j];
+    }
+    for(unsigned j=0; j<dimension_; ++j) {
+      fd[j]=D[j];
+      for(unsigned i=0; i<dimension_; ++i) if(i!=j) fd[j]*=C[i];
+    }
+    value+=grid*ff;
+    for(unsigned j=0; j<dimension_; ++j) der[j]+=grid*fd[j];
+  }
+  return value;
+}
+
 vector<GridBase::index_t> GridBase::getNearestNeighbors(const index_t index) const {
   vector<index_t> nearest_neighs = vector<index_t>();
   for (unsigned i = 0; i < dimension_; i++) {
@@ -395,6 +478,18 @@ void GridBase::addKernel( const KernelFunctions& kernel ) {
 }
 
 
+void GridBase::addKernel( const std::vector<index_t>& points, const std::vector<double>& values, const std::vector<double>& der ) {
+  plumed_dbg_assert( points.size()==values.size() );
+  plumed_dbg_assert( !usederiv_ || der.size()==points.size()*dimension_ );
+  std::vector<double> vder( dimension_ );
+  for(unsigned i=0; i<points.size(); ++i) {
+    if( usederiv_ ) {
+      for(unsigned j=0; j<dimension_; ++j) vder[j]=der[i*dimension_+j];
+      addValueAndDerivatives( points[i], values[i], vder );
+    } else addValue( points[i], values[i] );
+  }
+}
+
 double GridBase::getValue(const vector<unsigned> & indices) const {
   return getValue(getIndex(indices));
 }
@@ -427,6 +522,7 @@ double GridBase::getValueAndDerivatives
 
     vector<unsigned> indices(dimension_);
     getIndices(x, indices);
+    if(use_spline_cache_) return splineCacheLookup(x,indices,der);
     vector<double> xfloor(dimension_);
     getPoint(indices, xfloor);
     vector<index_t> neigh; unsigned nneigh; getSplineNeighbors(indices, neigh, nneigh);
@@ -746,28 +842,59 @@ double Grid::getValueAndDerivatives
 
 void Grid::setValue(index_t index, double value) {
   plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
   grid_[index]=value;
 }
 
 void Grid::setValueAndDerivatives
 (index_t index, double value, vector<double>& der) {
   plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
   grid_[index]=value;
   for(unsigned i=0; i<dimension_; i++) der_[dimension_*index+i]=der[i];
 }
 
 void Grid::addValue(index_t index, double value) {
   plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
   grid_[index]+=value;
 }
 
 void Grid::addValueAndDerivatives
 (index_t index, double value, vector<double>& der) {
   plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
   grid_[index]+=value;
   for(unsigned int i=0; i<dimension_; ++i) der_[index*dimension_+i]+=der[i];
 }
 
+void Grid::addKernel( const std::vector<index_t>& points, const std::vector<double>& values, const std::vector<double>& der ) {
+  plumed_dbg_assert( points.size()==values.size() );
+  plumed_dbg_assert( !usederiv_ || der.size()==points.size()*dimension_ );
+  const unsigned npoints=points.size();
+  unsigned nt=OpenMP::getGoodNumThreads( values );
+  if( nt>1 ) {
+// a stencil wider than a periodic box revisits grid points, so the threaded
+// accumulation has to be atomic
+    #pragma omp parallel for num_threads(nt)
+    for(unsigned i=0; i<npoints; ++i) {
+      const index_t ipoint=points[i];
+      #pragma omp atomic
+      grid_[ipoint]+=values[i];
+      if( usederiv_ ) for(unsigned j=0; j<dimension_; ++j) {
+          #pragma omp atomic
+          der_[ipoint*dimension_+j]+=der[i*dimension_+j];
+        }
+    }
+  } else {
+    for(unsigned i=0; i<npoints; ++i) {
+      const index_t ipoint=points[i];
+      grid_[ipoint]+=values[i];
+      if( usederiv_ ) for(unsigned j=0; j<dimension_; ++j) der_[ipoint*dimension_+j]+=der[i*dimension_+j];
+    }
+  }
+}
+
 Grid::index_t SparseGrid::getSize() const {
   return map_.size();
 }
@@ -798,24 +925,28 @@ double SparseGrid::getValueAndDerivatives
 
 void SparseGrid::setValue(index_t index, double value) {
   plumed_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
   map_[index]=value;
 }
 
 void SparseGrid::setValueAndDerivatives
 (index_t index, double value, vector<double>& der) {
   plumed_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
   map_[index]=value;
   der_[index]=der;
 }
 
 void SparseGrid::addValue(index_t index, double value) {
   plumed_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
   map_[index]+=value;
 }
 
 void SparseGrid::addValueAndDerivatives
 (index_t index, double value, vector<double>& der) {
   plumed_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
   map_[index]+=value;
   der_[index].resize(dimension_);
   for(unsigned int i=0; i<dimension_; ++i) der_[index][i]+=der[i];
@@ -865,6 +996,830 @@ double SparseGrid::getMaxValue() const {
   return maxval;
 }
 
+double* TiledGrid::findTile(index_t tile) const {
+  if(cachedTile_ && cachedKey_==tile) return cachedTile_;
+  const auto it=tiles_.find(tile);
+  if(it==tiles_.end()) return NULL;
+// pointers into the tile remain valid: tiles are allocated once and never resized
+  cachedKey_=tile;
+  cachedTile_=const_cast<double*>(it->second.data());
+  return cachedTile_;
+}
+
+double* TiledGrid::getTile(index_t tile) {
+  double* t=findTile(tile);
+  if(t) return t;
+  std::vector<double> & block=tiles_[tile];
+  block.assign(tilesize_*pointstride_,0.0);
+  cachedKey_=tile;
+  cachedTile_=block.data();
+  return cachedTile_;
+}
+
+Grid::index_t TiledGrid::getSize() const {
+  return maxsize_;
+}
+
+Grid::index_t TiledGrid::getAllocatedSize() const {
+  return tiles_.size()*tilesize_;
+}
+
+double TiledGrid::getValue(index_t index) const {
+  plumed_dbg_assert(index<maxsize_);
+  const double* t=findTile(index>>tileshift_);
+  if(!t) return 0.0;
+  return t[(index&(tilesize_-1))*pointstride_];
+}
+
+double TiledGrid::getValueAndDerivatives
+(index_t index, vector<double>& der) const {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  const double* t=findTile(index>>tileshift_);
+  if(!t) {
+    for(unsigned i=0; i<dimension_; ++i) der[i]=0.0;
+    return 0.0;
+  }
+  const double* point=t+(index&(tilesize_-1))*pointstride_;
+  for(unsigned i=0; i<dimension_; ++i) der[i]=point[1+i];
+  return point[0];
+}
+
+void TiledGrid::setValue(index_t index, double value) {
+  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
+  getTile(index>>tileshift_)[(index&(tilesize_-1))*pointstride_]=value;
+}
+
+void TiledGrid::setValueAndDerivatives
+(index_t index, double value, vector<double>& der) {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
+  double* point=getTile(index>>tileshift_)+(index&(tilesize_-1))*pointstride_;
+  point[0]=value;
+  for(unsigned i=0; i<dimension_; ++i) point[1+i]=der[i];
+}
+
+void TiledGrid::addValue(index_t index, double value) {
+  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
+  getTile(index>>tileshift_)[(index&(tilesize_-1))*pointstride_]+=value;
+}
+
+void TiledGrid::addValueAndDerivatives
+(index_t index, double value, vector<double>& der) {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
+  double* point=getTile(index>>tileshift_)+(index&(tilesize_-1))*pointstride_;
+  point[0]+=value;
+  for(unsigned i=0; i<dimension_; ++i) point[1+i]+=der[i];
+}
+
+double TiledGrid::getMinValue() const {
+// as in SparseGrid, the points that were never allocated count as zeros
+  double minval=0.0;
+  for(auto const & t : tiles_) {
+    for(index_t i=0; i<tilesize_; ++i) {
+      if(t.second[i*pointstride_]<minval) minval=t.second[i*pointstride_];
+    }
+  }
+  return minval;
+}
+
+double TiledGrid::getMaxValue() const {
+  double maxval=0.0;
+  for(auto const & t : tiles_) {
+    for(index_t i=0; i<tilesize_; ++i) {
+      if(t.second[i*pointstride_]>maxval) maxval=t.second[i*pointstride_];
+    }
+  }
+  return maxval;
+}
+
+void TiledGrid::writeToFile(OFile& ofile) {
+  vector<double> xx(dimension_);
+  vector<double> der(dimension_);
+  double f;
+  writeHeader(ofile);
+  ofile.fmtField(" "+fmt_);
+// dump the allocated tiles in the order of the flat grid index
+  std::vector<index_t> keys;
+  keys.reserve(tiles_.size());
+  for(auto const & t : tiles_) keys.push_back(t.first);
+  std::sort(keys.begin(),keys.end());
+  for(auto const & key : keys) {
+    for(index_t j=0; j<tilesize_; ++j) {
+      index_t i=(key<<tileshift_)+j;
+// the last tile can extend beyond the end of the grid
+      if(i>=maxsize_) break;
+      xx=getPoint(i);
+      if(usederiv_) {f=getValueAndDerivatives(i,der);}
+      else {f=getValue(i);}
+      if(i>0 && dimension_>1 && getIndices(i)[dimension_-2]==0) ofile.printf("\n");
+      for(unsigned k=0; k<dimension_; ++k) {
+        ofile.printField("min_" + argnames[k], str_min_[k] );
+        ofile.printField("max_" + argnames[k], str_max_[k] );
+        ofile.printField("nbins_" + argnames[k], static_cast<int>(nbin_[k]) );
+        if( pbc_[k] ) ofile.printField("periodic_" + argnames[k], "true" );
+        else          ofile.printField("periodic_" + argnames[k], "false" );
+      }
+      for(unsigned k=0; k<dimension_; ++k) ofile.printField(argnames[k],xx[k]);
+      ofile.printField(funcname, f);
+      if(usederiv_) { for(unsigned k=0; k<dimension_; ++k) ofile.printField("der_" + argnames[k],der[k]); }
+      ofile.printField();
+    }
+  }
+}
+
+MortonGrid::MortonGrid(const std::string& funcl, const std::vector<Value*> & args, const std::vector<std::string> & gmin,
+                       const std::vector<std::string> & gmax, const std::vector<unsigned> & nbin, bool dospline,
+                       bool usederiv):
+  GridBase(funcl,args,gmin,gmax,nbin,dospline,usederiv),
+  pointstride_(usederiv?1+dimension_:1)
+{
+  if( dimension_!=2 && dimension_!=3 ) plumed_merror("Morton order storage is only useful for grids in two or three dimensions");
+  bits_.resize(dimension_); maxlevel_=0; index_t padded=1;
+  for(unsigned j=0; j<dimension_; ++j) {
+    unsigned b=0; while( (index_t(1)<<b) < nbin_[j] ) ++b;
+    bits_[j]=b; if(b>maxlevel_) maxlevel_=b;
+    padded <<= b;
+  }
+  data_.assign(padded*pointstride_,0.0);
+}
+
+GridBase::index_t MortonGrid::mortonOffset(const std::vector<unsigned>& ind) const {
+// the dimensions are visited round robin, skipping those that ran out of
+// bits, so each dimension is only padded to its own power of two
+  index_t code=0; unsigned outbit=0;
+  for(unsigned l=0; l<maxlevel_; ++l) {
+    for(unsigned j=0; j<dimension_; ++j) {
+      if( l>=bits_[j] ) continue;
+      if( (ind[j]>>l) & 1 ) code |= index_t(1)<<outbit;
+      ++outbit;
+    }
+  }
+  return code*pointstride_;
+}
+
+double* MortonGrid::record(index_t index) {
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  return &data_[mortonOffset(ind)];
+}
+
+const double* MortonGrid::record(index_t index) const {
+  return const_cast<MortonGrid*>(this)->record(index);
+}
+
+Grid::index_t MortonGrid::getSize() const {
+  return maxsize_;
+}
+
+double MortonGrid::getValue(index_t index) const {
+  plumed_dbg_assert(index<maxsize_);
+  return record(index)[0];
+}
+
+double MortonGrid::getValueAndDerivatives
+(index_t index, vector<double>& der) const {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  const double* point=record(index);
+  for(unsigned i=0; i<dimension_; ++i) der[i]=point[1+i];
+  return point[0];
+}
+
+void MortonGrid::setValue(index_t index, double value) {
+  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
+  record(index)[0]=value;
+}
+
+void MortonGrid::setValueAndDerivatives
+(index_t index, double value, vector<double>& der) {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
+  double* point=record(index);
+  point[0]=value;
+  for(unsigned i=0; i<dimension_; ++i) point[1+i]=der[i];
+}
+
+void MortonGrid::addValue(index_t index, double value) {
+  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
+  record(index)[0]+=value;
+}
+
+void MortonGrid::addValueAndDerivatives
+(index_t index, double value, vector<double>& der) {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
+  double* point=record(index);
+  point[0]+=value;
+  for(unsigned i=0; i<dimension_; ++i) point[1+i]+=der[i];
+}
+
+double MortonGrid::getMinValue() const {
+// the padding slots hold zeros so the scan has to go through the real points
+  double minval=DBL_MAX;
+  for(index_t i=0; i<maxsize_; ++i) {
+    double v=getValue(i);
+    if(v<minval) minval=v;
+  }
+  return minval;
+}
+
+double MortonGrid::getMaxValue() const {
+  double maxval=-DBL_MAX;
+  for(index_t i=0; i<maxsize_; ++i) {
+    double v=getValue(i);
+    if(v>maxval) maxval=v;
+  }
+  return maxval;
+}
+
+void MortonGrid::writeToFile(OFile& ofile) {
+  vector<double> xx(dimension_);
+  vector<double> der(dimension_);
+  double f;
+  writeHeader(ofile);
+  for(index_t i=0; i<getSize(); ++i) {
+    xx=getPoint(i);
+    if(usederiv_) {f=getValueAndDerivatives(i,der);}
+    else {f=getValue(i);}
+    if(i>0 && dimension_>1 && getIndices(i)[dimension_-2]==0) ofile.printf("\n");
+    for(unsigned j=0; j<dimension_; ++j) {
+      ofile.printField("min_" + argnames[j], str_min_[j] );
+      ofile.printField("max_" + argnames[j], str_max_[j] );
+      ofile.printField("nbins_" + argnames[j], static_cast<int>(nbin_[j]) );
+      if( pbc_[j] ) ofile.printField("periodic_" + argnames[j], "true" );
+      else          ofile.printField("periodic_" + argnames[j], "false" );
+    }
+    for(unsigned j=0; j<dimension_; ++j) { ofile.fmtField(" "+fmt_); ofile.printField(argnames[j],xx[j]); }
+    ofile.fmtField(" "+fmt_); ofile.printField(funcname,f);
+    if(usederiv_) for(unsigned j=0; j<dimension_; ++j) { ofile.fmtField(" "+fmt_); ofile.printField("der_" + argnames[j],der[j]); }
+    ofile.printField();
+  }
+}
+
+RefinedGrid::RefinedGrid(const std::string& funcl, const std::vector<Value*> & args, const std::vector<std::string> & gmin,
+                         const std::vector<std::string> & gmax, const std::vector<unsigned> & nbin, bool dospline,
+                         bool usederiv, unsigned refine_factor):
+  GridBase(funcl,args,gmin,gmax,nbin,dospline,usederiv),
+  rf_(refine_factor),
+  pointstride_(usederiv?1+dimension_:1),
+  cachedKey_(0),
+  cachedBlock_(NULL)
+{
+  setupCoarse();
+}
+
+std::vector<unsigned> GridBase::sourceNbin(const GridBase& source) {
+// GridBase::Init adds one bin along the non periodic dimensions, so it has
+// to be removed before handing the bins back to the GridBase constructor
+  std::vector<unsigned> nb(source.getNbin());
+  std::vector<bool> p(source.getIsPeriodic());
+  for(unsigned j=0; j<nb.size(); ++j) if(!p[j]) nb[j]-=1;
+  return nb;
+}
+
+RefinedGrid::RefinedGrid(const std::string& funcl, const GridBase& source, unsigned refine_factor, double accuracy_threshold):
+  GridBase(funcl,source.getArgNames(),source.getMin(),source.getMax(),sourceNbin(source),source.hasSpline(),
+           source.hasDerivatives(),source.getIsPeriodic(),source.getMin(),source.getMax()),
+  rf_(refine_factor),
+  pointstride_(source.hasDerivatives()?1+dimension_:1),
+  cachedKey_(0),
+  cachedBlock_(NULL)
+{
+  setupCoarse();
+// copy the coarse points from the source
+  std::vector<unsigned> cind(dimension_), ind(dimension_);
+  std::vector<double> der(dimension_);
+  for(index_t c=0; c<cgrid_.size(); ++c) {
+    index_t kk=c;
+    for(unsigned j=0; j<dimension_; ++j) { cind[j]=kk%ncpoint_[j]; kk/=ncpoint_[j]; ind[j]=cind[j]*rf_; }
+    if(usederiv_) {
+      cgrid_[c]=source.getValueAndDerivatives(getIndex(ind),der);
+      for(unsigned j=0; j<dimension_; ++j) cder_[c*dimension_+j]=der[j];
+    } else cgrid_[c]=source.getValue(getIndex(ind));
+  }
+// refine the blocks where the coarse interpolation misses the source
+  double point[1+maxdim];
+  for(index_t i=0; i<maxsize_; ++i) {
+    getIndices(i,ind);
+    interpolateCoarse(ind,point);
+    if( std::fabs(source.getValue(i)-point[0])>accuracy_threshold ) {
+      index_t offset; refineBlock(getCellAndOffset(ind,offset));
+    }
+  }
+// and store the exact source values on all the refined points
+  for(auto & b : blocks_) {
+    index_t kk=b.first;
+    for(unsigned j=0; j<dimension_; ++j) { cind[j]=kk%ncell_[j]; kk/=ncell_[j]; }
+    std::vector<unsigned> l(dimension_,0);
+    for(index_t p=0; p<blocksize_; ++p) {
+      bool inside=true;
+      for(unsigned j=0; j<dimension_; ++j) { ind[j]=cind[j]*rf_+l[j]; if(ind[j]>=nbin_[j]) inside=false; }
+      if(inside) {
+        double* dest=b.second.data()+p*pointstride_;
+        if(usederiv_) {
+          dest[0]=source.getValueAndDerivatives(getIndex(ind),der);
+          for(unsigned j=0; j<dimension_; ++j) dest[1+j]=der[j];
+        } else dest[0]=source.getValue(getIndex(ind));
+      }
+      for(unsigned j=0; j<dimension_; ++j) { l[j]++; if(l[j]<rf_) break; l[j]=0; }
+    }
+  }
+}
+
+void RefinedGrid::setupCoarse() {
+  plumed_massert(rf_>1,"the refinement factor should be at least 2");
+  ncpoint_.resize(dimension_); ncell_.resize(dimension_);
+  index_t csize=1; blocksize_=1;
+  for(unsigned j=0; j<dimension_; ++j) {
+    const unsigned nfbin= pbc_[j] ? nbin_[j] : nbin_[j]-1;
+    plumed_massert(nfbin%rf_==0,"the number of bins along each dimension should be a multiple of the refinement factor");
+    ncpoint_[j]=nfbin/rf_ + ( pbc_[j] ? 0 : 1 );
+// along the non periodic dimensions an extra layer of cells holds the
+// points on the upper boundary
+    ncell_[j]=(nbin_[j]+rf_-1)/rf_;
+    csize*=ncpoint_[j]; blocksize_*=rf_;
+  }
+  cgrid_.assign(csize,0.0);
+  if(usederiv_) cder_.assign(csize*dimension_,0.0);
+}
+
+GridBase::index_t RefinedGrid::getCellAndOffset(const std::vector<unsigned>& ind, index_t& offset) const {
+  index_t cell=0, local=0;
+  for(unsigned i=dimension_; i>0; --i) {
+    cell=cell*ncell_[i-1]+ind[i-1]/rf_;
+    local=local*rf_+ind[i-1]%rf_;
+  }
+  offset=local*pointstride_;
+  return cell;
+}
+
+void RefinedGrid::interpolateCoarse(const std::vector<unsigned>& ind, double* point) const {
+  unsigned c0[maxdim], c1[maxdim]; double w[maxdim];
+  for(unsigned j=0; j<dimension_; ++j) {
+    c0[j]=ind[j]/rf_; w[j]=static_cast<double>(ind[j]%rf_)/static_cast<double>(rf_);
+    if( w[j]==0.0 ) c1[j]=c0[j];
+    else c1[j]= pbc_[j] ? (c0[j]+1)%ncpoint_[j] : c0[j]+1;
+  }
+  for(index_t k=0; k<pointstride_; ++k) point[k]=0.0;
+  for(unsigned corner=0; corner<(1u<<dimension_); ++corner) {
+    double weight=1.0; index_t cidx=0;
+    for(unsigned i=dimension_; i>0; --i) {
+      const unsigned j=i-1;
+      if( corner&(1u<<j) ) { weight*=w[j]; cidx=cidx*ncpoint_[j]+c1[j]; }
+      else { weight*=1.0-w[j]; cidx=cidx*ncpoint_[j]+c0[j]; }
+    }
+    if( weight==0.0 ) continue;
+    point[0]+=weight*cgrid_[cidx];
+    if(usederiv_) for(unsigned j=0; j<dimension_; ++j) point[1+j]+=weight*cder_[cidx*dimension_+j];
+  }
+}
+
+double* RefinedGrid::findBlock(index_t cell) const {
+  if(cachedBlock_ && cachedKey_==cell) return cachedBlock_;
+  const auto it=blocks_.find(cell);
+  if(it==blocks_.end()) return NULL;
+// pointers into the block remain valid: blocks are allocated once and never resized
+  cachedKey_=cell;
+  cachedBlock_=const_cast<double*>(it->second.data());
+  return cachedBlock_;
+}
+
+double* RefinedGrid::refineBlock(index_t cell) {
+  double* b=findBlock(cell);
+  if(b) return b;
+  std::vector<double> & block=blocks_[cell];
+  block.assign(blocksize_*pointstride_,0.0);
+// seed the new block from the coarse interpolation, so that refining a
+// block is transparent for the points that are only read
+  std::vector<unsigned> cind(dimension_), ind(dimension_);
+  index_t kk=cell;
+  for(unsigned j=0; j<dimension_; ++j) { cind[j]=kk%ncell_[j]; kk/=ncell_[j]; }
+  std::vector<unsigned> l(dimension_,0);
+  for(index_t p=0; p<blocksize_; ++p) {
+    bool inside=true;
+    for(unsigned j=0; j<dimension_; ++j) { ind[j]=cind[j]*rf_+l[j]; if(ind[j]>=nbin_[j]) inside=false; }
+    if(inside) interpolateCoarse(ind,block.data()+p*pointstride_);
+// advance the local indices, first dimension runs fastest as in getCellAndOffset
+    for(unsigned j=0; j<dimension_; ++j) { l[j]++; if(l[j]<rf_) break; l[j]=0; }
+  }
+  cachedKey_=cell;
+  cachedBlock_=block.data();
+  return cachedBlock_;
+}
+
+Grid::index_t RefinedGrid::getSize() const {
+  return maxsize_;
+}
+
+Grid::index_t RefinedGrid::getAllocatedSize() const {
+  return cgrid_.size()+blocks_.size()*blocksize_;
+}
+
+double RefinedGrid::getValue(index_t index) const {
+  plumed_dbg_assert(index<maxsize_);
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  index_t offset; const index_t cell=getCellAndOffset(ind,offset);
+  const double* b=findBlock(cell);
+  if(b) return b[offset];
+  double point[1+maxdim];
+  interpolateCoarse(ind,point);
+  return point[0];
+}
+
+double RefinedGrid::getValueAndDerivatives
+(index_t index, vector<double>& der) const {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  index_t offset; const index_t cell=getCellAndOffset(ind,offset);
+  const double* b=findBlock(cell);
+  if(b) {
+    for(unsigned i=0; i<dimension_; ++i) der[i]=b[offset+1+i];
+    return b[offset];
+  }
+  double point[1+maxdim];
+  interpolateCoarse(ind,point);
+  for(unsigned i=0; i<dimension_; ++i) der[i]=point[1+i];
+  return point[0];
+}
+
+void RefinedGrid::setValue(index_t index, double value) {
+  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  index_t offset; double* b=refineBlock(getCellAndOffset(ind,offset));
+  b[offset]=value;
+}
+
+void RefinedGrid::setValueAndDerivatives
+(index_t index, double value, vector<double>& der) {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  index_t offset; double* b=refineBlock(getCellAndOffset(ind,offset));
+  b[offset]=value;
+  for(unsigned i=0; i<dimension_; ++i) b[offset+1+i]=der[i];
+}
+
+void RefinedGrid::addValue(index_t index, double value) {
+  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+  edit_version_++;
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  index_t offset; double* b=refineBlock(getCellAndOffset(ind,offset));
+  b[offset]+=value;
+}
+
+void RefinedGrid::addValueAndDerivatives
+(index_t index, double value, vector<double>& der) {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  edit_version_++;
+  std::vector<unsigned> ind(dimension_);
+  getIndices(index,ind);
+  index_t offset; double* b=refineBlock(getCellAndOffset(ind,offset));
+  b[offset]+=value;
+  for(unsigned i=0; i<dimension_; ++i) b[offset+1+i]+=der[i];
+}
+
+double RefinedGrid::getMinValue() const {
+  double minval=getValue(0);
+  for(index_t i=1; i<maxsize_; ++i) {
+    const double v=getValue(i);
+    if(v<minval) minval=v;
+  }
+  return minval;
+}
+
+double RefinedGrid::getMaxValue() const {
+  double maxval=getValue(0);
+  for(index_t i=1; i<maxsize_; ++i) {
+    const double v=getValue(i);
+    if(v>maxval) maxval=v;
+  }
+  return maxval;
+}
+
+void RefinedGrid::writeToFile(OFile& ofile) {
+  vector<double> xx(dimension_);
+  vector<double> der(dimension_);
+  double f;
+  writeHeader(ofile);
+  for(index_t i=0; i<getSize(); ++i) {
+    xx=getPoint(i);
+    if(usederiv_) {f=getValueAndDerivatives(i,der);}
+    else {f=getValue(i);}
+    if(i>0 && dimension_>1 && getIndices(i)[dimension_-2]==0) ofile.printf("\n");
+    for(unsigned j=0; j<dimension_; ++j) {
+      ofile.printField("min_" + argnames[j], str_min_[j] );
+      ofile.printField("max_" + argnames[j], str_max_[j] );
+      ofile.printField("nbins_" + argnames[j], static_cast<int>(nbin_[j]) );
+      if( pbc_[j] ) ofile.printField("periodic_" + argnames[j], "true" );
+      else          ofile.printField("periodic_" + argnames[j], "false" );
+    }
+    for(unsigned j=0; j<dimension_; ++j) { ofile.fmtField(" "+fmt_); ofile.printField(argnames[j],xx[j]); }
+    ofile.fmtField(" "+fmt_); ofile.printField(funcname,f);
+    if(usederiv_) for(unsigned j=0; j<dimension_; ++j) { ofile.fmtField(" "+fmt_); ofile.printField("der_" + argnames[j],der[j]); }
+    ofile.printField();
+  }
+}
+
+uint16_t CompressedGrid::toHalf(double x) {
+  float f=static_cast<float>(x);
+  uint32_t bits;
+  std::memcpy(&bits,&f,4);
+  const uint32_t sign=(bits>>16)&0x8000u;
+  int32_t exponent=static_cast<int32_t>((bits>>23)&0xffu)-127+15;
+  uint32_t mantissa=bits&0x7fffffu;
+  if(exponent>=31) {
+// infinity, or NaN when the mantissa is not empty
+    return static_cast<uint16_t>(sign|0x7c00u|(mantissa?0x200u:0u));
+  }
+  if(exponent<=0) {
+// too small even for a subnormal half
+    if(exponent<-10) return static_cast<uint16_t>(sign);
+// subnormal half: shift the mantissa (with its implicit bit) into place
+    mantissa|=0x800000u;
+    return static_cast<uint16_t>(sign|(mantissa>>(14-exponent)));
+  }
+// round to nearest, carrying into the exponent when the mantissa overflows
+  mantissa+=0x1000u;
+  if(mantissa&0x800000u) { mantissa=0; exponent++; if(exponent>=31) return static_cast<uint16_t>(sign|0x7c00u); }
+  return static_cast<uint16_t>(sign|(static_cast<uint32_t>(exponent)<<10)|(mantissa>>13));
+}
+
+double CompressedGrid::fromHalf(uint16_t h) {
+  const uint32_t sign=static_cast<uint32_t>(h&0x8000u)<<16;
+  uint32_t exponent=(h>>10)&0x1fu;
+  uint32_t mantissa=h&0x3ffu;
+  uint32_t bits;
+  if(exponent==0) {
+    if(mantissa==0) {
+      bits=sign;
+    } else {
+// subnormal half: renormalize into a normal float
+      exponent=127-15+1;
+      while(!(mantissa&0x400u)) { mantissa<<=1; exponent--; }
+      mantissa&=0x3ffu;
+      bits=sign|(exponent<<23)|(mantissa<<13);
+    }
+  } else if(exponent==31) {
+    bits=sign|0x7f800000u|(mantissa<<13);
+  } else {
+    bits=sign|((exponent-15+127)<<23)|(mantissa<<13);
+  }
+  float f;
+  std::memcpy(&f,&bits,4);
+  return static_cast<double>(f);
+}
+
+CompressedGrid::CompressedGrid(const std::string& funcl, const GridBase& source, Precision precision, bool keep_derivatives):
+  GridBase(funcl,source.getArgNames(),source.getMin(),source.getMax(),sourceNbin(source),source.hasSpline(),
+           source.hasDerivatives(),source.getIsPeriodic(),source.getMin(),source.getMax()),
+  precision_(precision),
+  storederiv_(keep_derivatives && source.hasDerivatives())
+{
+  if(precision_==fp32) {
+    fgrid_.resize(maxsize_);
+    if(storederiv_) fder_.resize(maxsize_*dimension_);
+  } else {
+    hgrid_.resize(maxsize_);
+    if(storederiv_) hder_.resize(maxsize_*dimension_);
+  }
+  std::vector<double> der(dimension_);
+  for(index_t i=0; i<maxsize_; ++i) {
+    double v;
+    if(storederiv_) v=source.getValueAndDerivatives(i,der);
+    else v=source.getValue(i);
+    if(precision_==fp32) {
+      fgrid_[i]=static_cast<float>(v);
+      if(storederiv_) for(unsigned j=0; j<dimension_; ++j) fder_[i*dimension_+j]=static_cast<float>(der[j]);
+    } else {
+      hgrid_[i]=toHalf(v);
+      if(storederiv_) for(unsigned j=0; j<dimension_; ++j) hder_[i*dimension_+j]=toHalf(der[j]);
+    }
+  }
+}
+
+GridBase::index_t CompressedGrid::getSize() const {
+  return maxsize_;
+}
+
+double CompressedGrid::rawValue(index_t index) const {
+  if(precision_==fp32) return fgrid_[index];
+  return fromHalf(hgrid_[index]);
+}
+
+double CompressedGrid::rawDer(index_t index, unsigned j) const {
+  if(precision_==fp32) return fder_[index*dimension_+j];
+  return fromHalf(hder_[index*dimension_+j]);
+}
+
+double CompressedGrid::getValue(index_t index) const {
+  plumed_dbg_assert(index<maxsize_);
+  return rawValue(index);
+}
+
+double CompressedGrid::getValueAndDerivatives(index_t index, vector<double>& der) const {
+  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+  if(storederiv_) {
+    for(unsigned j=0; j<dimension_; ++j) der[j]=rawDer(index,j);
+  } else {
+// recompute the derivatives from the stored values by central
+// differences, falling back to one-sided differences at the borders of
+// the non periodic dimensions
+    std::vector<unsigned> ind(dimension_);
+    getIndices(index,ind);
+    for(unsigned j=0; j<dimension_; ++j) {
+      const unsigned save=ind[j];
+      unsigned up=save, down=save;
+      if(pbc_[j]) {
+        up=(save+1)%nbin_[j];
+        down=(save+nbin_[j]-1)%nbin_[j];
+      } else {
+        if(save+1<nbin_[j]) up=save+1;
+        if(save>0) down=save-1;
+      }
+      double span=0.0;
+      if(up!=save) span+=1.0;
+      if(down!=save) span+=1.0;
+      ind[j]=up;   const double vup=rawValue(getIndex(ind));
+      ind[j]=down; const double vdown=rawValue(getIndex(ind));
+      ind[j]=save;
+      der[j]=(span>0.0)?(vup-vdown)/(span*dx_[j]):0.0;
+    }
+  }
+  return rawValue(index);
+}
+
+void CompressedGrid::setValue(index_t, double) {
+  plumed_merror("the grid is stored in compressed form and cannot be modified");
+}
+
+void CompressedGrid::setValueAndDerivatives(index_t, double, vector<double>&) {
+  plumed_merror("the grid is stored in compressed form and cannot be modified");
+}
+
+void CompressedGrid::addValue(index_t, double) {
+  plumed_merror("the grid is stored in compressed form and cannot be modified");
+}
+
+void CompressedGrid::addValueAndDerivatives(index_t, double, vector<double>&) {
+  plumed_merror("the grid is stored in compressed form and cannot be modified");
+}
+
+double CompressedGrid::getMinValue() const {
+  double minval=DBL_MAX;
+  for(index_t i=0; i<maxsize_; ++i) {
+    if(rawValue(i)<minval) minval=rawValue(i);
+  }
+  return minval;
+}
+
+double CompressedGrid::getMaxValue() const {
+  double maxval=-DBL_MAX;
+  for(index_t i=0; i<maxsize_; ++i) {
+    if(rawValue(i)>maxval) maxval=rawValue(i);
+  }
+  return maxval;
+}
+
+void CompressedGrid::writeToFile(OFile& ofile) {
+  vector<double> xx(dimension_);
+  vector<double> der(dimension_);
+  double f;
+  writeHeader(ofile);
+  for(index_t i=0; i<getSize(); ++i) {
+    xx=getPoint(i);
+    if(usederiv_) {f=getValueAndDerivatives(i,der);}
+    else {f=getValue(i);}
+    if(i>0 && dimension_>1 && getIndices(i)[dimension_-2]==0) ofile.printf("\n");
+    for(unsigned j=0; j<dimension_; ++j) {
+      ofile.printField("min_" + argnames[j], str_min_[j] );
+      ofile.printField("max_" + argnames[j], str_max_[j] );
+      ofile.printField("nbins_" + argnames[j], static_cast<int>(nbin_[j]) );
+      if( pbc_[j] ) ofile.printField("periodic_" + argnames[j], "true" );
+      else          ofile.printField("periodic_" + argnames[j], "false" );
+    }
+    for(unsigned j=0; j<dimension_; ++j) { ofile.fmtField(" "+fmt_); ofile.printField(argnames[j],xx[j]); }
+    ofile.fmtField(" "+fmt_); ofile.printField(funcname,f);
+    if(usederiv_) for(unsigned j=0; j<dimension_; ++j) { ofile.fmtField(" "+fmt_); ofile.printField("der_" + argnames[j],der[j]); }
+    ofile.printField();
+  }
+}
+
+DoubleBufferedGrid::DoubleBufferedGrid(const std::string& funcl, std::unique_ptr<GridBase> inner):
+  GridBase(funcl,inner->getArgNames(),inner->getMin(),inner->getMax(),sourceNbin(*inner),
+           inner->hasSpline(),inner->hasDerivatives(),inner->getIsPeriodic(),inner->getMin(),inner->getMax())
+{
+  write_=std::move(inner);
+// the twin buffer is a dense grid with the geometry of the wrapped grid
+  read_.reset(new Grid(funcl,argnames,str_min_,str_max_,sourceNbin(*write_),dospline_,usederiv_,
+                       getIsPeriodic(),str_min_,str_max_));
+  plumed_assert(read_->getSize()==write_->getSize());
+// seed it with the content of the wrapped grid, so that the two buffers
+// start out identical even when the wrapped grid was read from a file
+  vector<double> der(dimension_);
+  for(index_t i=0; i<maxsize_; ++i) {
+    if(usederiv_) {
+      double v=write_->getValueAndDerivatives(i,der);
+      read_->setValueAndDerivatives(i,v,der);
+    } else read_->setValue(i,write_->getValue(i));
+  }
+}
+
+void DoubleBufferedGrid::swapBuffers() {
+// with an empty log the two buffers are already identical
+  if(edits_.size()==0) return;
+  for(unsigned i=0; i<edits_.size(); ++i) {
+    Edit & e(edits_[i]);
+    switch(e.op) {
+    case op_set:    read_->setValue(e.index,e.value); break;
+    case op_setder: read_->setValueAndDerivatives(e.index,e.value,e.der); break;
+    case op_add:    read_->addValue(e.index,e.value); break;
+    case op_addder: read_->addValueAndDerivatives(e.index,e.value,e.der); break;
+    }
+  }
+// clear() keeps the capacity, so steady-state deposition does not allocate
+  edits_.clear();
+  read_.swap(write_);
+// the snapshot served to the readers has changed: spline coefficients
+// cached against the previous one must be rebuilt on their next lookup
+  edit_version_++;
+}
+
+GridBase::index_t DoubleBufferedGrid::getSize() const {
+  return read_->getSize();
+}
+
+double DoubleBufferedGrid::getValue(index_t index) const {
+  return read_->getValue(index);
+}
+
+double DoubleBufferedGrid::getValueAndDerivatives(index_t index, vector<double>& der) const {
+  return read_->getValueAndDerivatives(index,der);
+}
+
+void DoubleBufferedGrid::setValue(index_t index, double value) {
+  write_->setValue(index,value);
+  edits_.push_back(Edit());
+  Edit & e(edits_.back());
+  e.index=index; e.op=op_set; e.value=value;
+}
+
+void DoubleBufferedGrid::setValueAndDerivatives(index_t index, double value, vector<double>& der) {
+  write_->setValueAndDerivatives(index,value,der);
+  edits_.push_back(Edit());
+  Edit & e(edits_.back());
+  e.index=index; e.op=op_setder; e.value=value; e.der=der;
+}
+
+void DoubleBufferedGrid::addValue(index_t index, double value) {
+  write_->addValue(index,value);
+  edits_.push_back(Edit());
+  Edit & e(edits_.back());
+  e.index=index; e.op=op_add; e.value=value;
+}
+
+void DoubleBufferedGrid::addValueAndDerivatives(index_t index, double value, vector<double>& der) {
+  write_->addValueAndDerivatives(index,value,der);
+  edits_.push_back(Edit());
+  Edit & e(edits_.back());
+  e.index=index; e.op=op_addder; e.value=value; e.der=der;
+}
+
+void DoubleBufferedGrid::addKernel( const std::vector<index_t>& points, const std::vector<double>& values, const std::vector<double>& der ) {
+// let the wrapped grid use its own batched path, then log the points
+  write_->addKernel(points,values,der);
+  for(unsigned i=0; i<points.size(); ++i) {
+    edits_.push_back(Edit());
+    Edit & e(edits_.back());
+    e.index=points[i]; e.value=values[i];
+    if(usederiv_) {
+      e.op=op_addder;
+      e.der.assign(der.begin()+i*dimension_,der.begin()+(i+1)*dimension_);
+    } else e.op=op_add;
+  }
+}
+
+double DoubleBufferedGrid::getMinValue() const {
+  return read_->getMinValue();
+}
+
+double DoubleBufferedGrid::getMaxValue() const {
+  return read_->getMaxValue();
+}
+
+void DoubleBufferedGrid::writeToFile(OFile& ofile) {
+  write_->writeToFile(ofile);
+}
+
 void Grid::projectOnLowDimension(double &val, std::vector<int> &vHigh, WeightBase * ptr2obj ) {
   unsigned i=0;
   for(i=0; i<vHigh.size(); i++) {
@@ -22,10 +22,13 @@
 #ifndef __PLUMED_tools_Grid_h
 #define __PLUMED_tools_Grid_h
 
+#include "Numa.h"
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <cmath>
+#include <cstdint>
 #include <memory>
 
 namespace PLMD {
@@ -94,6 +97,30 @@ protected:
 /// get "neighbors" for spline
   void getSplineNeighbors(const std::vector<unsigned> & indices, std::vector<index_t>& neigh, unsigned& nneigh )const;
 // std::vector<index_t> getSplineNeighbors(const std::vector<unsigned> & indices)const;
+/// Entry of the spline coefficient cache: for each corner of a cell, the
+/// grid value and the precomputed derivative/value ratios entering the
+/// cubic basis polynomials
+  struct SplineCacheEntry {
+    unsigned long version;
+    unsigned nneigh;
+    std::vector<double> data;
+    SplineCacheEntry(): version(0), nneigh(0) {}
+  };
+/// the original number of bins of an existing grid: Init adds one bin
+/// along the non periodic dimensions, so it has to be removed before
+/// handing the bins back to a GridBase constructor
+  static std::vector<unsigned> sourceNbin(const GridBase& source);
+/// When the cache is enabled, the coefficients of each visited cell are
+/// stored here, built lazily on first touch
+  bool use_spline_cache_;
+  mutable std::unordered_map<index_t,SplineCacheEntry> spline_cache_;
+/// Bumped at every write to the grid, so that stale cache entries are
+/// detected and rebuilt on their next lookup
+  unsigned long edit_version_;
+/// Rebuild the cache entry of the cell whose lower corner is at indices
+  void buildSplineCacheEntry(const std::vector<unsigned>& indices, SplineCacheEntry& entry) const;
+/// Fused value+derivative lookup going through the coefficient cache
+  double splineCacheLookup(const std::vector<double>& x, const std::vector<unsigned>& indices, std::vector<double>& der) const;
 
 
 public:
@@ -129,6 +156,13 @@ public:
   std::vector<std::string> getArgNames() const;
 /// get if the grid has derivatives
   bool hasDerivatives() const {return usederiv_;}
+/// get if the grid uses spline interpolation
+  bool hasSpline() const {return dospline_;}
+/// Cache the spline coefficients of each visited cell, so that the hot
+/// value+derivative lookup skips the neighbor gathering and the
+/// derivative/value divisions. Any write to the grid invalidates the
+/// cache, which is then rebuilt lazily cell by cell
+  void enableSplineCoefficientCache();
 
 /// methods to handle grid indices
   void getIndices(index_t index, std::vector<unsigned>& rindex) const;
@@ -187,6 +221,12 @@ public:
   void addValueAndDerivatives(const std::vector<unsigned> & indices, double value, std::vector<double>& der);
 /// add a kernel function to the grid
   void addKernel( const KernelFunctions& kernel );
+/// add a precomputed kernel stencil to the grid: values[i] and, if the grid
+/// holds derivatives, der[i*dimension+j] are accumulated on grid point
+/// points[i]. The default implementation just loops over
+/// addValueAndDerivatives; dense grids override it with direct array
+/// arithmetic and thread the accumulation for wide stencils
+  virtual void addKernel( const std::vector<index_t>& points, const std::vector<double>& values, const std::vector<double>& der );
 
 /// get minimum value
   virtual double getMinValue() const = 0;
@@ -221,8 +261,10 @@ public:
        const std::vector<unsigned> & nbin, bool dospline, bool usederiv):
     GridBase(funcl,args,gmin,gmax,nbin,dospline,usederiv)
   {
-    grid_.assign(maxsize_,0.0);
-    if(usederiv_) der_.assign(maxsize_*dimension_,0.0);
+    // interpolation walks the grid with no thread affinity, so the pages of
+    // large grids are interleaved over the threads at first touch
+    Numa::interleavedResize(grid_,maxsize_);
+    if(usederiv_) Numa::interleavedResize(der_,maxsize_*dimension_);
   }
 /// this constructor here is not Value-aware
   Grid(const std::string& funcl, const std::vector<std::string> &names, const std::vector<std::string> & gmin,
@@ -231,8 +273,8 @@ public:
        const std::vector<std::string> &pmax ):
     GridBase(funcl,names,gmin,gmax,nbin,dospline,usederiv,isperiodic,pmin,pmax)
   {
-    grid_.assign(maxsize_,0.0);
-    if(usederiv_) der_.assign(maxsize_*dimension_,0.0);
+    Numa::interleavedResize(grid_,maxsize_);
+    if(usederiv_) Numa::interleavedResize(der_,maxsize_*dimension_);
   }
   index_t getSize() const override;
 /// this is to access to Grid:: version of these methods (allowing overloading of virtual methods)
@@ -242,6 +284,7 @@ public:
   using GridBase::setValueAndDerivatives;
   using GridBase::addValue;
   using GridBase::addValueAndDerivatives;
+  using GridBase::addKernel;
 /// get grid value
   double getValue(index_t index) const override;
 /// get grid value and derivatives
@@ -255,6 +298,8 @@ public:
   void addValue(index_t index, double value) override;
 /// add to grid value and derivatives
   void addValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+/// add a precomputed kernel stencil with linear index arithmetic
+  void addKernel( const std::vector<index_t>& points, const std::vector<double>& values, const std::vector<double>& der ) override;
 
 /// get minimum value
   double getMinValue() const override;
@@ -333,6 +378,363 @@ public:
 
   virtual ~SparseGrid() {}
 };
+
+/// A grid that allocates memory in fixed-size tiles of contiguous points,
+/// so that only the regions of CV space that have actually been visited
+/// consume memory. Unlike SparseGrid, which performs one map lookup per
+/// point (and a second one for the derivatives), here a lookup is needed
+/// only when crossing a tile boundary, and value and derivatives of a
+/// point are stored next to each other. Points that were never touched
+/// behave as if they held a value (and derivatives) of zero, so this
+/// class is a drop-in replacement for Grid.
+class TiledGrid : public GridBase
+{
+/// number of grid points per tile, as a power of two of the flat index
+  static const unsigned tileshift_=8;
+  static const index_t tilesize_=1<<tileshift_;
+/// number of doubles stored per point (1, plus dimension_ if there are derivatives)
+  index_t pointstride_;
+/// allocated tiles, indexed by (flat index)>>tileshift_
+  std::unordered_map<index_t,std::vector<double> > tiles_;
+/// cache of the last tile that was accessed, to avoid repeated map
+/// lookups while a hill is spread over neighboring points.
+/// Pointers into the map are stable since tiles are never resized.
+  mutable index_t cachedKey_;
+  mutable double* cachedTile_;
+/// return the tile containing flat index, or nullptr if it was never allocated
+  double* findTile(index_t tile) const;
+/// return the tile containing flat index, allocating it if needed
+  double* getTile(index_t tile);
+public:
+  TiledGrid(const std::string& funcl, const std::vector<Value*> & args, const std::vector<std::string> & gmin,
+            const std::vector<std::string> & gmax,
+            const std::vector<unsigned> & nbin, bool dospline, bool usederiv):
+    GridBase(funcl,args,gmin,gmax,nbin,dospline,usederiv),
+    pointstride_(usederiv?1+dimension_:1),
+    cachedKey_(0),
+    cachedTile_(NULL)
+  {}
+
+/// returns the full size of the grid, as for Grid: untouched points simply read as zero
+  index_t getSize() const override;
+/// number of points for which memory has actually been allocated
+  index_t getAllocatedSize() const;
+
+/// this is to access to Grid:: version of these methods (allowing overloading of virtual methods)
+  using GridBase::getValue;
+  using GridBase::getValueAndDerivatives;
+  using GridBase::setValue;
+  using GridBase::setValueAndDerivatives;
+  using GridBase::addValue;
+  using GridBase::addValueAndDerivatives;
+
+/// get grid value
+  double getValue(index_t index) const override;
+/// get grid value and derivatives
+  double getValueAndDerivatives(index_t index, std::vector<double>& der) const override;
+
+/// set grid value
+  void setValue(index_t index, double value) override;
+/// set grid value and derivatives
+  void setValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+/// add to grid value
+  void addValue(index_t index, double value) override;
+/// add to grid value and derivatives
+  void addValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+
+/// get minimum value
+  double getMinValue() const override;
+/// get maximum value
+  double getMaxValue() const override;
+/// dump grid on file, writing only the allocated tiles
+  void writeToFile(OFile&) override;
+
+  virtual ~TiledGrid() {}
+};
+
+///// A dense grid that stores its points in Morton (Z-curve) order: the bits
+/// of the indices of a point are interleaved to form its storage offset, so
+/// the corners of a spline cell -- which the row-major layout scatters
+/// across whole planes in three dimensions -- land a few cache lines apart,
+/// and the value and derivatives of each point sit next to each other.
+/// The flat grid index keeps its usual row-major meaning, so neighbor
+/// lists and files are unaffected; only the in-memory layout differs.
+/// The price is that every dimension is padded to a power of two, which
+/// can cost up to a factor of two in memory per dimension, so this is
+/// meant for lookup-bound grids in two or three dimensions
+class MortonGrid : public GridBase
+{
+/// number of doubles stored per point (1, plus dimension_ if there are derivatives)
+  index_t pointstride_;
+/// number of bits of the Morton code taken from each dimension
+  std::vector<unsigned> bits_;
+/// deepest bit level over all the dimensions
+  unsigned maxlevel_;
+/// storage in Morton order, padded to a power of two along each dimension
+  std::vector<double> data_;
+/// interleave the bits of the indices of a point into its storage offset
+  index_t mortonOffset(const std::vector<unsigned>& ind) const;
+/// storage record of the point with this flat grid index
+  double* record(index_t index);
+  const double* record(index_t index) const;
+public:
+  MortonGrid(const std::string& funcl, const std::vector<Value*> & args, const std::vector<std::string> & gmin,
+             const std::vector<std::string> & gmax,
+             const std::vector<unsigned> & nbin, bool dospline, bool usederiv);
+
+  index_t getSize() const override;
+
+/// this is to access to Grid:: version of these methods (allowing overloading of virtual methods)
+  using GridBase::getValue;
+  using GridBase::getValueAndDerivatives;
+  using GridBase::setValue;
+  using GridBase::setValueAndDerivatives;
+  using GridBase::addValue;
+  using GridBase::addValueAndDerivatives;
+
+/// get grid value
+  double getValue(index_t index) const override;
+/// get grid value and derivatives
+  double getValueAndDerivatives(index_t index, std::vector<double>& der) const override;
+
+/// set grid value
+  void setValue(index_t index, double value) override;
+/// set grid value and derivatives
+  void setValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+/// add to grid value
+  void addValue(index_t index, double value) override;
+/// add to grid value and derivatives
+  void addValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+
+/// get minimum value
+  double getMinValue() const override;
+/// get maximum value
+  double getMaxValue() const override;
+/// dump grid on file
+  void writeToFile(OFile&) override;
+
+  virtual ~MortonGrid() {}
+};
+
+/// A two-level refinement grid: a coarse base grid holds the smooth part of
+/// the function, while blocks at the full resolution are allocated only
+/// where they are needed. Reads at points that have no refined block
+/// interpolate the coarse values (and derivatives) multilinearly; any write
+/// refines the target block first, seeding it from the interpolation, so
+/// writes are always exact at the fine resolution. When the grid is built
+/// from an existing one, blocks are kept refined only where the coarse
+/// interpolation misses the source by more than a threshold, which
+/// concentrates the memory where the function has high curvature (the
+/// barriers) while the coarse cells suffice in the smooth regions
+class RefinedGrid : public GridBase
+{
+/// refinement factor between the fine and the coarse spacing
+  unsigned rf_;
+/// number of doubles stored per point (1, plus dimension_ if there are derivatives)
+  index_t pointstride_;
+/// number of fine points per refined block
+  index_t blocksize_;
+/// number of coarse points and of coarse cells along each dimension
+  std::vector<unsigned> ncpoint_, ncell_;
+/// the coarse base grid (values and derivatives)
+  std::vector<double> cgrid_, cder_;
+/// refined blocks of rf_^dimension_ fine points, indexed by flat cell index
+  std::unordered_map<index_t,std::vector<double> > blocks_;
+/// cache of the last block that was accessed, as in TiledGrid
+  mutable index_t cachedKey_;
+  mutable double* cachedBlock_;
+/// check that the bins are commensurate with the refinement factor and
+/// allocate the coarse arrays
+  void setupCoarse();
+/// flat index of the cell holding a fine point and offset of the point
+/// inside the block data
+  index_t getCellAndOffset(const std::vector<unsigned>& ind, index_t& offset) const;
+/// value (and derivatives) at a fine point interpolated from the coarse grid
+  void interpolateCoarse(const std::vector<unsigned>& ind, double* point) const;
+/// return the block holding the cell, or NULL if it was never refined
+  double* findBlock(index_t cell) const;
+/// return the block holding the cell, refining it if needed
+  double* refineBlock(index_t cell);
+public:
+  RefinedGrid(const std::string& funcl, const std::vector<Value*> & args, const std::vector<std::string> & gmin,
+              const std::vector<std::string> & gmax, const std::vector<unsigned> & nbin, bool dospline,
+              bool usederiv, unsigned refine_factor);
+/// coarsen an existing grid: the coarse points are copied from source and a
+/// block is kept at the fine resolution only where the coarse interpolation
+/// misses the source values by more than accuracy_threshold
+  RefinedGrid(const std::string& funcl, const GridBase& source, unsigned refine_factor, double accuracy_threshold);
+
+/// returns the full size of the grid at the fine resolution
+  index_t getSize() const override;
+/// number of points (coarse plus refined) actually stored
+  index_t getAllocatedSize() const;
+
+/// this is to access to Grid:: version of these methods (allowing overloading of virtual methods)
+  using GridBase::getValue;
+  using GridBase::getValueAndDerivatives;
+  using GridBase::setValue;
+  using GridBase::setValueAndDerivatives;
+  using GridBase::addValue;
+  using GridBase::addValueAndDerivatives;
+
+/// get grid value
+  double getValue(index_t index) const override;
+/// get grid value and derivatives
+  double getValueAndDerivatives(index_t index, std::vector<double>& der) const override;
+
+/// set grid value
+  void setValue(index_t index, double value) override;
+/// set grid value and derivatives
+  void setValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+/// add to grid value
+  void addValue(index_t index, double value) override;
+/// add to grid value and derivatives
+  void addValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+
+/// get minimum value
+  double getMinValue() const override;
+/// get maximum value
+  double getMaxValue() const override;
+/// dump grid on file at the full resolution, interpolating the coarse regions
+  void writeToFile(OFile&) override;
+
+  virtual ~RefinedGrid() {}
+};
+
+/// A read-only grid that stores the values (and optionally the
+/// derivatives) of an existing grid in single or half precision, halving
+/// or quartering the memory footprint of static lookup-only potentials.
+/// The compressed numbers are converted back to double on every access,
+/// so the interpolation machinery of GridBase works unchanged on top.
+/// When the derivatives are not stored they are recomputed on the fly
+/// from the stored values by central differences, which removes another
+/// factor 1+dimension from the footprint at the price of a further
+/// approximation. Any attempt to write to the grid is an error.
+class CompressedGrid : public GridBase
+{
+public:
+/// precision used for the stored numbers
+  enum Precision { fp32, fp16 };
+private:
+  Precision precision_;
+/// whether the derivatives are stored or recomputed by central differences
+  bool storederiv_;
+/// compressed storage; only the pair matching precision_ is allocated
+  std::vector<float> fgrid_, fder_;
+  std::vector<uint16_t> hgrid_, hder_;
+/// conversions between double and IEEE 754 binary16
+  static uint16_t toHalf(double x);
+  static double fromHalf(uint16_t h);
+/// decompress one stored value or derivative
+  double rawValue(index_t index) const;
+  double rawDer(index_t index, unsigned j) const;
+public:
+/// compress an existing grid
+  CompressedGrid(const std::string& funcl, const GridBase& source, Precision precision, bool keep_derivatives);
+
+  index_t getSize() const override;
+
+/// this is to access to Grid:: version of these methods (allowing overloading of virtual methods)
+  using GridBase::getValue;
+  using GridBase::getValueAndDerivatives;
+  using GridBase::setValue;
+  using GridBase::setValueAndDerivatives;
+  using GridBase::addValue;
+  using GridBase::addValueAndDerivatives;
+
+/// get grid value
+  double getValue(index_t index) const override;
+/// get grid value and derivatives
+  double getValueAndDerivatives(index_t index, std::vector<double>& der) const override;
+
+/// the grid is read-only: all the writers below throw
+  void setValue(index_t index, double value) override;
+  void setValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+  void addValue(index_t index, double value) override;
+  void addValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+
+/// get minimum value
+  double getMinValue() const override;
+/// get maximum value
+  double getMaxValue() const override;
+/// dump grid on file, decompressing the values
+  void writeToFile(OFile&) override;
+
+  virtual ~CompressedGrid() {}
+};
+
+/// A decorator that double buffers another grid, so that the bias can be
+/// read from a stable snapshot while new hills are deposited. All the
+/// reads are served by the read buffer, whose content only changes when
+/// swapBuffers() is called; the writes are applied to the write buffer
+/// immediately and recorded in a log. swapBuffers(), to be called at a
+/// step boundary when no reader is active, replays the log into the read
+/// buffer and exchanges the two, so that both buffers always hold the
+/// complete function. Replaying costs as much as the deposition itself,
+/// since a hill only touches the points around its center. The twin
+/// buffer is a dense Grid with the geometry of the wrapped grid, seeded
+/// with its content, so a grid freshly read from file can be wrapped too
+class DoubleBufferedGrid : public GridBase
+{
+/// the stable snapshot served to the readers
+  std::unique_ptr<GridBase> read_;
+/// the buffer to which the writes are applied
+  std::unique_ptr<GridBase> write_;
+/// one recorded write, replayed into the read buffer by swapBuffers()
+  struct Edit {
+    index_t index;
+    unsigned op;
+    double value;
+    std::vector<double> der;
+  };
+  enum {op_set, op_setder, op_add, op_addder};
+/// log of the writes received since the last swapBuffers()
+  std::vector<Edit> edits_;
+public:
+/// wrap an existing grid; the twin buffer is allocated and seeded here
+  DoubleBufferedGrid(const std::string& funcl, std::unique_ptr<GridBase> inner);
+/// replay the logged writes into the read buffer and exchange the two
+/// buffers. Must not be called while another thread is reading the grid.
+/// Bumps the edit version, so that spline coefficients cached against the
+/// previous snapshot are rebuilt on their next lookup
+  void swapBuffers();
+
+  index_t getSize() const override;
+
+/// this is to access to Grid:: version of these methods (allowing overloading of virtual methods)
+  using GridBase::getValue;
+  using GridBase::getValueAndDerivatives;
+  using GridBase::setValue;
+  using GridBase::setValueAndDerivatives;
+  using GridBase::addValue;
+  using GridBase::addValueAndDerivatives;
+  using GridBase::addKernel;
+
+/// get grid value from the current snapshot
+  double getValue(index_t index) const override;
+/// get grid value and derivatives from the current snapshot
+  double getValueAndDerivatives(index_t index, std::vector<double>& der) const override;
+
+/// set grid value on the write buffer
+  void setValue(index_t index, double value) override;
+/// set grid value and derivatives on the write buffer
+  void setValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+/// add to grid value on the write buffer
+  void addValue(index_t index, double value) override;
+/// add to grid value and derivatives on the write buffer
+  void addValueAndDerivatives(index_t index, double value, std::vector<double>& der) override;
+/// add a batch-evaluated kernel to the write buffer
+  void addKernel( const std::vector<index_t>& points, const std::vector<double>& values, const std::vector<double>& der ) override;
+
+/// get minimum value of the current snapshot
+  double getMinValue() const override;
+/// get maximum value of the current snapshot
+  double getMaxValue() const override;
+/// dump grid on file; the write buffer is used, as it is the most current
+  void writeToFile(OFile&) override;
+
+  virtual ~DoubleBufferedGrid() {}
+};
 }
 
 #endif
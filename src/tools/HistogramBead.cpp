@@ -84,14 +84,74 @@ w_j(s) = \int_{a + \frac{j-1}{n}(b-a)}^{a + \frac{j}{n}(b-a)} \sum_i K\left( \fr
 */
 //+ENDPLUMEDOC
 
+namespace {
+
+/// cubic-Hermite tables for erf(x) and exp(-x*x) on [0,xmax].  The derivatives
+/// at the nodes are analytic so the interpolation error is O(h^4), which with
+/// 2048 intervals is around 1e-10 -- far below the kernel cutoff truncation.
+/// These replace the libm calls in the innermost bead loops, but only when
+/// requested with the TABULATE flag: the interpolated values are not bit
+/// identical to the library ones.
+struct KernelTables {
+  static const unsigned nbins=2048;
+  double xmax, h, ih;
+  std::vector<double> erf_v, erf_d, gau_v, gau_d;
+  KernelTables() : xmax(4.0), h(xmax/nbins), ih(nbins/xmax),
+    erf_v(nbins+1), erf_d(nbins+1), gau_v(nbins+1), gau_d(nbins+1) {
+    for(unsigned i=0; i<=nbins; ++i) {
+      const double x=i*h;
+      gau_v[i]=exp(-x*x);
+      gau_d[i]=-2.0*x*gau_v[i];
+      erf_v[i]=erf(x);
+      erf_d[i]=(2.0/sqrt(pi))*gau_v[i];
+    }
+  }
+  double hermite( double t, const std::vector<double>& v, const std::vector<double>& d, unsigned i ) const {
+    const double t2=t*t, t3=t2*t;
+    return (2.*t3-3.*t2+1.)*v[i] + (t3-2.*t2+t)*h*d[i] + (3.*t2-2.*t3)*v[i+1] + (t3-t2)*h*d[i+1];
+  }
+  double evalErf( double x ) const {
+    const double ax=fabs(x);
+    if( ax>=xmax ) return x>0 ? erf_v[nbins] : -erf_v[nbins];
+    const double u=ax*ih; const unsigned i=static_cast<unsigned>(u);
+    const double f=hermite( u-i, erf_v, erf_d, i );
+    return x>0 ? f : -f;
+  }
+  double evalGauss( double x ) const {
+    const double ax=fabs(x);
+    if( ax>=xmax ) return 0.0;
+    const double u=ax*ih; const unsigned i=static_cast<unsigned>(u);
+    return hermite( u-i, gau_v, gau_d, i );
+  }
+};
+
+const KernelTables & kernelTables() {
+  static KernelTables tables;
+  return tables;
+}
+
+double beadErf( const double& x, const bool& tabulate ) {
+  if( tabulate ) return kernelTables().evalErf( x );
+  return erf( x );
+}
+
+double beadGauss( const double& x, const bool& tabulate ) {
+  if( tabulate ) return kernelTables().evalGauss( x );
+  return exp( -x*x );
+}
+
+}
+
 void HistogramBead::registerKeywords( Keywords& keys ) {
   keys.add("compulsory","LOWER","the lower boundary for this particular bin");
   keys.add("compulsory","UPPER","the upper boundary for this particular bin");
   keys.add("compulsory","SMEAR","0.5","the amount to smear the Gaussian for each value in the distribution");
+  keys.addFlag("TABULATE",false,"evaluate the Gaussian kernel from an interpolation table rather than with the library erf/exp calls");
 }
 
 HistogramBead::HistogramBead():
   init(false),
+  tabulate(false),
   lowb(0.0),
   highb(0.0),
   width(0.0),
@@ -127,12 +187,13 @@ void HistogramBead::generateBins( const std::string& params, std::vector<std::st
   plumed_massert(range[0]<range[1],"Range specification is dubious");
   bool found_b=Tools::parse(data,"SMEAR",smear);
   if(!found_b) { Tools::convert(0.5,smear); }
+  bool dotabulate=false; Tools::parseFlag(data,"TABULATE",dotabulate);
 
   std::string lb,ub; double delr = ( range[1]-range[0] ) / static_cast<double>( nbins );
   for(unsigned i=0; i<nbins; ++i) {
     Tools::convert( range[0]+i*delr, lb );
     Tools::convert( range[0]+(i+1)*delr, ub );
-    bins.push_back( name + " " +  "LOWER=" + lb + " " + "UPPER=" + ub + " " + "SMEAR=" + smear );
+    bins.push_back( name + " " +  "LOWER=" + lb + " " + "UPPER=" + ub + " " + "SMEAR=" + smear + (dotabulate ? " TABULATE" : "") );
   }
   plumed_assert(bins.size()==nbins);
 }
@@ -157,6 +218,7 @@ void HistogramBead::set( const std::string& params, std::string& errormsg ) {
   if( lowb>=highb ) errormsg="Lower bound is higher than upper bound";
 
   smear=0.5; Tools::parse(data,"SMEAR",smear);
+  Tools::parseFlag(data,"TABULATE",tabulate);
   width=smear*(highb-lowb); init=true;
 }
 
@@ -180,8 +242,8 @@ double HistogramBead::calculate( double x, double& df ) const {
   if( type==gaussian ) {
     lowB = difference( x, lowb ) / ( sqrt(2.0) * width );
     upperB = difference( x, highb ) / ( sqrt(2.0) * width );
-    df = ( exp( -lowB*lowB ) - exp( -upperB*upperB ) ) / ( sqrt(2*pi)*width );
-    f = 0.5*( erf( upperB ) - erf( lowB ) );
+    df = ( beadGauss( lowB, tabulate ) - beadGauss( upperB, tabulate ) ) / ( sqrt(2*pi)*width );
+    f = 0.5*( beadErf( upperB, tabulate ) - beadErf( lowB, tabulate ) );
   } else if( type==triangular ) {
     lowB = ( difference( x, lowb ) / width );
     upperB = ( difference( x, highb ) / width );
@@ -211,8 +273,8 @@ double HistogramBead::calculateWithCutoff( double x, double& df ) const {
 
   if( type==gaussian ) {
     lowB /= sqrt(2.0); upperB /= sqrt(2.0);
-    df = ( exp( -lowB*lowB ) - exp( -upperB*upperB ) ) / ( sqrt(2*pi)*width );
-    f = 0.5*( erf( upperB ) - erf( lowB ) );
+    df = ( beadGauss( lowB, tabulate ) - beadGauss( upperB, tabulate ) ) / ( sqrt(2*pi)*width );
+    f = 0.5*( beadErf( upperB, tabulate ) - beadErf( lowB, tabulate ) );
   } else if( type==triangular ) {
     df=0;
     if( fabs(lowB)<1. ) df = (1 - fabs(lowB)) / width;
@@ -231,6 +293,40 @@ double HistogramBead::calculateWithCutoff( double x, double& df ) const {
   return f;
 }
 
+void HistogramBead::calculateAllWithCutoff( double x, const std::vector<HistogramBead>& beads,
+    std::vector<double>& f, std::vector<double>& df ) {
+  const unsigned n=beads.size();
+  f.resize(n); df.resize(n);
+  // the values at the boundary shared between two contiguous gaussian beads
+  // are carried over from one bead to the next instead of being recomputed
+  bool have_prev=false; double prev_erf=0., prev_gauss=0.;
+  for(unsigned i=0; i<n; ++i) {
+    const HistogramBead & b=beads[i];
+    plumed_dbg_assert( b.init && b.periodicity!=unset );
+    if( b.type!=gaussian ) {
+      f[i]=b.calculateWithCutoff( x, df[i] ); have_prev=false;
+      continue;
+    }
+    double lowB = b.difference( x, b.lowb ) / b.width;
+    double upperB = b.difference( x, b.highb ) / b.width;
+    if( upperB<=-b.cutoff || lowB>=b.cutoff ) {
+      f[i]=0.; df[i]=0.; have_prev=false;
+      continue;
+    }
+    lowB /= sqrt(2.0); upperB /= sqrt(2.0);
+    double erf_low, gauss_low;
+    if( have_prev && beads[i-1].highb==b.lowb && beads[i-1].width==b.width && beads[i-1].tabulate==b.tabulate ) {
+      erf_low=prev_erf; gauss_low=prev_gauss;
+    } else {
+      erf_low=beadErf( lowB, b.tabulate ); gauss_low=beadGauss( lowB, b.tabulate );
+    }
+    const double erf_up=beadErf( upperB, b.tabulate ), gauss_up=beadGauss( upperB, b.tabulate );
+    f[i] = 0.5*( erf_up - erf_low );
+    df[i] = ( gauss_low - gauss_up ) / ( sqrt(2*pi)*b.width );
+    prev_erf=erf_up; prev_gauss=gauss_up; have_prev=true;
+  }
+}
+
 double HistogramBead::lboundDerivative( const double& x ) const {
   if( type==gaussian ) {
     double lowB = difference( x, lowb ) / ( sqrt(2.0) * width );
@@ -40,6 +40,7 @@ A class for calculating whether or not values are within a given range using : \
 class HistogramBead {
 private:
   bool init;
+  bool tabulate;
   double lowb;
   double highb;
   double width;
@@ -61,6 +62,11 @@ public:
   void set(double l, double h, double w);
   double calculate(double x, double&df) const;
   double calculateWithCutoff( double x, double& df ) const;
+/// Evaluate a full set of beads for a single value in one pass.  When the bins
+/// are contiguous (the upper bound of one bead is the lower bound of the next)
+/// the kernel integral at the shared boundary is computed once and reused
+  static void calculateAllWithCutoff( double x, const std::vector<HistogramBead>& beads,
+                                      std::vector<double>& f, std::vector<double>& df );
   double lboundDerivative( const double& x ) const;
   double uboundDerivative( const double& x ) const;
   double getlowb() const ;
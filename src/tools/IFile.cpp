@@ -28,16 +28,132 @@
 #include "Tools.h"
 #include <cstdarg>
 #include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
 #include <cmath>
 
 #include <iostream>
 #include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #ifdef __PLUMED_HAS_ZLIB
 #include <zlib.h>
 #endif
 
 namespace PLMD {
 
+namespace {
+
+/// Magic marker starting a binary fields file, shared with OFile
+const char binary_fields_magic[8]={'P','L','M','D','C','O','L','B'};
+const int32_t binary_fields_version=1;
+
+bool readBinaryInt(FILE* fp, int32_t & i) {
+  return std::fread(&i,sizeof(i),1,fp)==1;
+}
+
+bool readBinaryString(FILE* fp, std::string & s) {
+  int32_t len;
+  if(!readBinaryInt(fp,len) || len<0) return false;
+  std::vector<char> buf(len);
+  if(len>0 && std::fread(&buf[0],1,len,fp)!=static_cast<size_t>(len)) return false;
+  s.assign(buf.begin(),buf.end());
+  return true;
+}
+
+}
+
+/// Read-side counterpart of OFile::AsyncWriter: a background thread keeps a
+/// bounded ring of prefetched chunks ahead of the consumer, so that llread
+/// almost never waits for the filesystem.  Only usable on files that are read
+/// strictly forward, see IFile::enableReadahead()
+class IFile::Readahead {
+/// Number of chunks that can be prefetched before the thread blocks
+  static const unsigned nchunks=4;
+/// Size of each prefetched chunk
+  static const size_t chunksize=1048576;
+/// Handle of the file; owned by the IFile, not by this class
+  FILE* fp;
+/// Prefetched chunks waiting for the consumer
+  std::deque<std::vector<char> > pending;
+/// Bytes of the front chunk already handed out
+  size_t consumed;
+/// Set by the prefetch thread once the end of the file or an error was hit
+  bool done;
+/// Set together with done when the underlying read failed
+  bool failed;
+/// Set by the destructor to terminate the prefetch thread
+  bool stop;
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::thread thread;
+/// Main loop of the prefetch thread
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;) {
+      while(pending.size()>=nchunks && !stop) notFull.wait(lock);
+      if(stop) break;
+      lock.unlock();
+      std::vector<char> buf(chunksize);
+      size_t r=std::fread(&buf[0],1,chunksize,fp);
+      bool ateof=(r<chunksize);
+      bool aterr=std::ferror(fp);
+      buf.resize(r);
+      lock.lock();
+      if(r>0) pending.push_back(std::move(buf));
+      if(ateof||aterr) {
+        done=true; failed=aterr;
+        notEmpty.notify_all();
+        break;
+      }
+      notEmpty.notify_one();
+    }
+  }
+public:
+  explicit Readahead(FILE* f):
+    fp(f),
+    consumed(0),
+    done(false),
+    failed(false),
+    stop(false)
+  {
+    thread=std::thread(&Readahead::run,this);
+  }
+  ~Readahead() {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      stop=true;
+      notFull.notify_all();
+    }
+    thread.join();
+  }
+/// Hand out up to s prefetched bytes, waiting for the thread if the ring is
+/// empty.  Mirrors the semantics of fread: a short count means end of file
+  size_t read(char* ptr,size_t s,bool& at_eof,bool& at_err) {
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t got=0;
+    while(got<s) {
+      while(pending.empty() && !done) notEmpty.wait(lock);
+      if(pending.empty()) break;
+      const std::vector<char>& front=pending.front();
+      size_t n=front.size()-consumed;
+      if(n>s-got) n=s-got;
+      std::memcpy(ptr+got,&front[consumed],n);
+      consumed+=n; got+=n;
+      if(consumed==front.size()) {
+        pending.pop_front(); consumed=0;
+        notFull.notify_one();
+      }
+    }
+    if(got<s) { at_eof=true; at_err=failed; }
+    return got;
+  }
+};
+
 size_t IFile::llread(char*ptr,size_t s) {
   plumed_assert(fp);
   size_t r;
@@ -50,6 +166,11 @@ size_t IFile::llread(char*ptr,size_t s) {
 #else
     plumed_merror("file " + getPath() + ": trying to use a gz file without zlib being linked");
 #endif
+  } else if(readahead_) {
+    bool at_eof=false, at_err=false;
+    r=readahead_->read(ptr,s,at_eof,at_err);
+    if(at_eof) eof=true;
+    if(at_err) err=true;
   } else {
     r=fread(ptr,1,s,fp);
     if(feof(fp))   eof=true;
@@ -60,12 +181,67 @@ size_t IFile::llread(char*ptr,size_t s) {
 
 IFile& IFile::advanceField() {
   plumed_assert(!inMiddleOfField);
-  std::string line;
+  tokensValid_=false;
+  if(binaryFields_) {
+    // one fixed-width record of doubles per line; the values are formatted
+    // back to strings with enough digits for an exact round trip, so that
+    // the standard field scanning machinery can be reused as it is
+    std::vector<double> record(binaryNFields_);
+    if(!record.empty() && llread(reinterpret_cast<char*>(&record[0]),record.size()*sizeof(double))!=record.size()*sizeof(double)) {
+      eof=true;
+      return *this;
+    }
+    char buf[32];
+    unsigned j=0;
+    for(unsigned i=0; i<fields.size(); i++) {
+      if(fields[i].constant) continue;
+      std::sprintf(buf,"%.17g",record[j]);
+      fields[i].value=buf;
+      fields[i].read=false;
+      j++;
+    }
+    inMiddleOfField=true;
+    return *this;
+  }
   bool done=false;
   while(!done) {
-    getline(line);
+    getline(lineBuffer_);
 // using explicit conversion not to confuse cppcheck 1.86
     if(!bool(*this)) {return *this;}
+    if(lineBuffer_.find_first_of("#()[]{}")==std::string::npos) {
+// the common case, a plain data line, is tokenized in place: the fields
+// just remember where their token sits in the line buffer, and scanField
+// parses the values straight out of it without allocating any string
+      unsigned nf=0;
+      for(unsigned i=0; i<fields.size(); i++) if(!fields[i].constant) nf++;
+      const std::size_t len=lineBuffer_.length();
+      unsigned ntok=0, ifield=0;
+      std::size_t pos=0;
+      while(pos<len) {
+        const char c=lineBuffer_[pos];
+        if(c==' '||c=='\t'||c=='\n') { pos++; continue; }
+        const std::size_t start=pos;
+        while(pos<len && lineBuffer_[pos]!=' ' && lineBuffer_[pos]!='\t' && lineBuffer_[pos]!='\n') pos++;
+        ntok++;
+        if(ntok<=nf) {
+          while(fields[ifield].constant) ifield++;
+          fields[ifield].tok_start=start;
+          fields[ifield].tok_len=pos-start;
+          fields[ifield].read=false;
+          ifield++;
+        }
+      }
+      if( ntok==nf ) {
+        tokensValid_=nf>0;
+        done=true;
+      } else if( ntok!=0 ) {
+        plumed_merror("file " + getPath() + ": mismatch between number of fields in file and expected number");
+      }
+      continue;
+    }
+// header lines and lines containing comments or parenthesis go through
+// the generic parser; they are a negligible fraction of a large file
+    std::string line=lineBuffer_;
     std::vector<std::string> words=Tools::getWords(line);
     if(words.size()>=2 && words[0]=="#!" && words[1]=="FIELDS") {
       fields.clear();
@@ -119,6 +295,37 @@ IFile& IFile::open(const std::string&path) {
     plumed_merror("file " + getPath() + ": trying to use a gz file without zlib being linked");
 #endif
   }
+  if(fp && !gzfp) {
+    char magic[8];
+    if(std::fread(magic,1,8,fp)==8 && std::memcmp(magic,binary_fields_magic,8)==0) {
+      // the file is in the typed binary columnar format: parse the schema
+      // here, so that the usual field scanning interface works transparently
+      int32_t version=0, nf=0, nc=0;
+      bool ok=readBinaryInt(fp,version) && readBinaryInt(fp,nf) && nf>=0;
+      plumed_massert(ok,"cannot read the schema of binary file " + getPath());
+      plumed_massert(version==binary_fields_version,"unknown version of binary file " + getPath());
+      binaryFields_=true;
+      binaryNFields_=nf;
+      fields.clear();
+      for(int32_t i=0; i<nf; i++) {
+        Field field;
+        ok=readBinaryString(fp,field.name);
+        plumed_massert(ok,"cannot read the schema of binary file " + getPath());
+        fields.push_back(field);
+      }
+      ok=readBinaryInt(fp,nc) && nc>=0;
+      plumed_massert(ok,"cannot read the schema of binary file " + getPath());
+      for(int32_t i=0; i<nc; i++) {
+        Field field;
+        ok=readBinaryString(fp,field.name) && readBinaryString(fp,field.value);
+        plumed_massert(ok,"cannot read the schema of binary file " + getPath());
+        field.constant=true;
+        fields.push_back(field);
+      }
+    } else {
+      std::fseek(fp,0,SEEK_SET);
+    }
+  }
   if(plumed) plumed->insertFile(*this);
   return *this;
 }
@@ -146,12 +353,31 @@ IFile& IFile::scanField(const std::string&name,std::string&str) {
 // using explicit conversion not to confuse cppcheck 1.86
   if(!bool(*this)) return *this;
   unsigned i=findField(name);
-  str=fields[i].value;
+  if(tokensValid_ && !fields[i].constant) str.assign(lineBuffer_,fields[i].tok_start,fields[i].tok_len);
+  else str=fields[i].value;
   fields[i].read=true;
   return *this;
 }
 
 IFile& IFile::scanField(const std::string&name,double &x) {
+  if(!inMiddleOfField) advanceField();
+// using explicit conversion not to confuse cppcheck 1.86
+  if(!bool(*this)) return *this;
+  unsigned i=findField(name);
+  if(tokensValid_ && !fields[i].constant) {
+// parse the number straight out of the line buffer; the token is followed
+// by a separator or by the terminator of c_str, where strtod stops
+    const char* start=lineBuffer_.c_str()+fields[i].tok_start;
+    char* end=NULL;
+    double v=std::strtod(start,&end);
+    if(end==start+fields[i].tok_len) {
+      x=v;
+      fields[i].read=true;
+      return *this;
+    }
+  }
+// anything that is not plain numeric (e.g. expressions involving pi)
+// takes the generic route through Tools::convert
   std::string str;
   scanField(name,str);
   if(*this) Tools::convert(str,x);
@@ -159,6 +385,20 @@ IFile& IFile::scanField(const std::string&name,double &x) {
 }
 
 IFile& IFile::scanField(const std::string&name,int &x) {
+  if(!inMiddleOfField) advanceField();
+// using explicit conversion not to confuse cppcheck 1.86
+  if(!bool(*this)) return *this;
+  unsigned i=findField(name);
+  if(tokensValid_ && !fields[i].constant) {
+    const char* start=lineBuffer_.c_str()+fields[i].tok_start;
+    char* end=NULL;
+    long v=std::strtol(start,&end,10);
+    if(end==start+fields[i].tok_len && v>=INT_MIN && v<=INT_MAX) {
+      x=static_cast<int>(v);
+      fields[i].read=true;
+      return *this;
+    }
+  }
   std::string str;
   scanField(name,str);
   if(*this) Tools::convert(str,x);
@@ -192,6 +432,9 @@ IFile& IFile::scanField() {
 
 IFile::IFile():
   inMiddleOfField(false),
+  binaryFields_(false),
+  binaryNFields_(0),
+  tokensValid_(false),
   ignoreFields(false),
   noEOL(false)
 {
@@ -205,7 +448,10 @@ IFile& IFile::getline(std::string &str) {
   char tmp=0;
   str="";
   fpos_t pos;
-  fgetpos(fp,&pos);
+// with readahead the file position belongs to the prefetch thread: saving
+// and restoring it here would be meaningless, and is not needed since the
+// prefetched bytes are consumed strictly forward anyway
+  if(!readahead_) fgetpos(fp,&pos);
   while(llread(&tmp,1)==1 && tmp && tmp!='\n' && tmp!='\r' && !eof && !err) {
     str+=tmp;
   }
@@ -218,7 +464,7 @@ IFile& IFile::getline(std::string &str) {
   } else if(eof || err || tmp!='\n') {
     eof = true;
     str="";
-    if(!err) fsetpos(fp,&pos);
+    if(!err && !readahead_) fsetpos(fp,&pos);
 // there was a fsetpos here that apparently is not necessary
 //  fsetpos(fp,&pos);
 // I think it was necessary to have rewind working correctly
@@ -257,4 +503,8 @@ void IFile::allowNoEOL() {
   noEOL=true;
 }
 
+void IFile::enableReadahead() {
+  if(fp && !gzfp && !readahead_) readahead_.reset(new Readahead(fp));
+}
+
 }
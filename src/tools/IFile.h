@@ -24,6 +24,8 @@
 
 #include "FileBase.h"
 #include <vector>
+#include <cstddef>
+#include <memory>
 
 namespace PLMD {
 
@@ -44,15 +46,36 @@ class IFile:
     public FieldBase {
   public:
     bool read;
-    Field(): read(false) {}
+/// Offset and length in IFile::lineBuffer_ of the token holding the value
+/// of this field, only meaningful while IFile::tokensValid_ is set
+    std::size_t tok_start;
+    std::size_t tok_len;
+    Field(): read(false), tok_start(0), tok_len(0) {}
   };
 /// Low-level read.
 /// Note: in parallel, all processes read
   size_t llread(char*,size_t);
+/// Helper running the background prefetch thread, see \ref enableReadahead
+  class Readahead;
+/// When allocated, llread is served from chunks prefetched by a background
+/// thread instead of reading the file synchronously
+  std::unique_ptr<Readahead> readahead_;
 /// All the defined fields
   std::vector<Field> fields;
 /// Flag set in the middle of a field reading
   bool inMiddleOfField;
+/// True if the file is in the typed binary columnar format written by
+/// OFile::setBinaryFields(), detected from its magic marker on open
+  bool binaryFields_;
+/// Number of non-constant fields of a binary fields file
+  unsigned binaryNFields_;
+/// Reusable buffer holding the last line read, so that reading many lines
+/// does not allocate once the buffer has grown to the line length
+  std::string lineBuffer_;
+/// True when the tokens of the non-constant fields point into lineBuffer_.
+/// Data lines are tokenized in place and scanField reads the values
+/// straight out of the buffer, without allocating per-line strings
+  bool tokensValid_;
 /// Set to true if you want to allow fields to be ignored in the read in file
   bool ignoreFields;
 /// Set to true to allow files without end-of-line at the end
@@ -99,6 +122,12 @@ public:
 /// This in practice should be only used when opening
 /// plumed input files
   void allowNoEOL();
+/// Prefetch the file with a background thread, so that reading it line
+/// by line does not block on filesystem latency.  Only valid for files
+/// that are read strictly forward: it must not be used on files that are
+/// rewound or re-read after reset(), like the hills files of multiple
+/// walkers.  No-op for gzipped files
+  void enableReadahead();
 };
 
 }
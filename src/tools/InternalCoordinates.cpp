@@ -0,0 +1,66 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "InternalCoordinates.h"
+#include "Angle.h"
+#include "Torsion.h"
+
+#include <algorithm>
+
+namespace PLMD {
+
+double InternalCoordinates::bond( const Vector& d, Vector& dd ) {
+  const double len=d.modulo();
+  dd=d*(1.0/len);
+  return len;
+}
+
+double InternalCoordinates::angle( const Vector& v1, const Vector& v2, Vector& d1, Vector& d2 ) {
+  Angle a;
+  return a.compute( v1, v2, d1, d2 );
+}
+
+double InternalCoordinates::torsion( const Vector& v1, const Vector& v2, const Vector& v3, Vector& d1, Vector& d2, Vector& d3 ) {
+  Torsion t;
+  return t.compute( v1, v2, v3, d1, d2, d3 );
+}
+
+void InternalCoordinates::torsions( const unsigned& n, const Vector* bonds, const unsigned* triples, double* values, Vector* derivs ) {
+// the indexed bonds are gathered into contiguous blocks, so that the
+// batch kernel of Torsion can be used
+  Torsion t;
+  constexpr unsigned bs=32;
+  Vector v1[bs], v2[bs], v3[bs], d1[bs], d2[bs], d3[bs];
+  for(unsigned start=0; start<n; start+=bs) {
+    const unsigned nb=std::min(bs,n-start);
+    for(unsigned j=0; j<nb; ++j) {
+      const unsigned* tr=triples+3*(start+j);
+      v1[j]=bonds[tr[0]]; v2[j]=bonds[tr[1]]; v3[j]=bonds[tr[2]];
+    }
+    t.compute(nb,v1,v2,v3,values+start,d1,d2,d3);
+    for(unsigned j=0; j<nb; ++j) {
+      Vector* dd=derivs+3*(start+j);
+      dd[0]=d1[j]; dd[1]=d2[j]; dd[2]=d3[j];
+    }
+  }
+}
+
+}
@@ -0,0 +1,60 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_InternalCoordinates_h
+#define __PLUMED_tools_InternalCoordinates_h
+
+#include "Vector.h"
+
+namespace PLMD {
+
+/// \ingroup TOOLBOX
+/// Small library of internal-coordinate kernels: bonds, bond angles and
+/// torsions, all with analytic derivatives. The single-coordinate methods
+/// are thin wrappers around \ref Angle and \ref Torsion. The batch method
+/// works on a list of bond vectors that the caller has computed once, with
+/// each coordinate referring to its bonds by index; in this way bonds that
+/// are shared between several internal coordinates (consecutive torsions
+/// along a chain, the bonds of a ring, ...) are computed and differentiated
+/// only once.
+class InternalCoordinates {
+public:
+/// Compute the length of the bond vector d. On output dd contains the
+/// derivative of the length with respect to d, i.e. the unit vector
+/// along the bond
+  static double bond( const Vector& d, Vector& dd );
+/// Compute the angle between the vectors v1 and v2 together with its
+/// derivatives with respect to the two vectors
+  static double angle( const Vector& v1, const Vector& v2, Vector& d1, Vector& d2 );
+/// Compute the torsion defined by the three bond vectors v1, v2 and v3
+/// together with its derivatives with respect to the three vectors
+  static double torsion( const Vector& v1, const Vector& v2, const Vector& v3, Vector& d1, Vector& d2, Vector& d3 );
+/// Compute n torsions in a single call. The i-th torsion is built from
+/// the bond vectors bonds[triples[3*i]], bonds[triples[3*i+1]] and
+/// bonds[triples[3*i+2]]; its value is stored in values[i] and its
+/// derivatives with respect to the three bonds in derivs[3*i] up to
+/// derivs[3*i+2]
+  static void torsions( const unsigned& n, const Vector* bonds, const unsigned* triples, double* values, Vector* derivs );
+};
+
+}
+
+#endif
@@ -289,6 +289,30 @@ std::vector<double> KernelFunctions::getContinuousSupport( ) const {
   return support;
 }
 
+std::vector<double> KernelFunctions::getConservativeSupport( const double& stretch ) const {
+  unsigned ncv=ndim();
+  std::vector<double> support( ncv );
+  if(dtype==diagonal) {
+    for(unsigned i=0; i<ncv; ++i) support[i]=stretch*getCutoff(width[i]);
+  } else if(dtype==multi) {
+    Matrix<double> mymatrix( getMatrix() ), myinv( ncv,ncv );
+    Invert(mymatrix,myinv);
+    Matrix<double> myautovec(ncv,ncv); std::vector<double> myautoval(ncv);
+    diagMat(myinv,myautoval,myautovec);
+    // the box must contain the whole cutoff ellipsoid: the half extent along
+    // each axis is the sum of the projections of all the semi-axes on that
+    // axis, not only of the longest one as in getContinuousSupport
+    for(unsigned i=0; i<ncv; ++i) {
+      double extent=0.;
+      for(unsigned j=0; j<ncv; ++j) extent+=sqrt(fabs(myautoval[j]))*fabs(myautovec(i,j));
+      support[i]=stretch*getCutoff( extent );
+    }
+  } else {
+    plumed_merror("cannot find support if metric is not multi or diagonal type");
+  }
+  return support;
+}
+
 std::vector<unsigned> KernelFunctions::getSupport( const std::vector<double>& dx ) const {
   plumed_assert( ndim()==dx.size() );
   std::vector<unsigned> support( dx.size() );
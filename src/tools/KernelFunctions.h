@@ -57,10 +57,21 @@ public:
   double getCutoff( const double& width ) const ;
 /// Get the position of the center
   std::vector<double> getCenter() const;
+/// Get the height of the kernel
+  double getHeight() const;
+/// Get the widths of the kernel (only for kernels with a diagonal metric)
+  std::vector<double> getWidth() const;
+/// Check whether this is a gaussian kernel with a diagonal metric
+  bool isDiagonalGaussian() const;
 /// Get the support
   std::vector<unsigned> getSupport( const std::vector<double>& dx ) const;
 /// get it in continuous form
   std::vector<double> getContinuousSupport( ) const;
+/// Get a per-dimension half width that is guaranteed to contain the whole
+/// cutoff ellipsoid also for non-diagonal metrics, optionally stretched
+  std::vector<double> getConservativeSupport( const double& stretch ) const;
+/// Check whether getContinuousSupport can be used for this kernel
+  bool hasContinuousSupport() const;
 /// Evaluate the kernel function with constant intervals
   double evaluate( const std::vector<Value*>& pos, std::vector<double>& derivatives, bool usederiv=true, bool doInt=false, double lowI_=-1, double uppI_=-1 ) const;
 /// Read a kernel function from a file
@@ -89,5 +100,26 @@ std::vector<double> KernelFunctions::getCenter() const {
   return center;
 }
 
+inline
+double KernelFunctions::getHeight() const {
+  return height;
+}
+
+inline
+std::vector<double> KernelFunctions::getWidth() const {
+  plumed_dbg_assert( dtype==diagonal );
+  return width;
+}
+
+inline
+bool KernelFunctions::isDiagonalGaussian() const {
+  return dtype==diagonal && ktype==gaussian;
+}
+
+inline
+bool KernelFunctions::hasContinuousSupport() const {
+  return dtype==diagonal || dtype==multi;
+}
+
 }
 #endif
@@ -0,0 +1,70 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "LeptonCache.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace PLMD {
+
+namespace {
+
+/// The map is keyed on the canonical text of the unoptimized parsed tree,
+/// followed by the differentiation variable for derivatives, and owns the
+/// optimized trees.  Entries are never erased.
+std::map<std::string,std::unique_ptr<lepton::ParsedExpression>> & cacheMap() {
+  static std::map<std::string,std::unique_ptr<lepton::ParsedExpression>> cache;
+  return cache;
+}
+
+std::mutex & cacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::string structuralKey( const lepton::ParsedExpression& pe ) {
+  std::ostringstream oss; oss<<pe; return oss.str();
+}
+
+}
+
+const lepton::ParsedExpression & LeptonCache::parse( const std::string& func ) {
+  lepton::ParsedExpression pe=lepton::Parser::parse(func);
+  const std::string key=structuralKey( pe );
+  std::lock_guard<std::mutex> lock( cacheMutex() );
+  auto & slot=cacheMap()[key];
+  if( !slot ) slot.reset( new lepton::ParsedExpression( pe.optimize(lepton::Constants()) ) );
+  return *slot;
+}
+
+const lepton::ParsedExpression & LeptonCache::differentiate( const std::string& func, const std::string& var ) {
+  lepton::ParsedExpression pe=lepton::Parser::parse(func);
+  const std::string key=structuralKey( pe ) + " d/d " + var;
+  std::lock_guard<std::mutex> lock( cacheMutex() );
+  auto & slot=cacheMap()[key];
+  if( !slot ) slot.reset( new lepton::ParsedExpression( pe.differentiate(var).optimize(lepton::Constants()) ) );
+  return *slot;
+}
+
+}
@@ -0,0 +1,57 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_LeptonCache_h
+#define __PLUMED_tools_LeptonCache_h
+
+#include "lepton/Lepton.h"
+#include <string>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+Process wide cache of parsed lepton expressions.
+
+Inputs that apply the same algebraic transformation many times (for
+instance hundreds of identical CUSTOM actions, or the same switching
+function on every pair) otherwise parse, optimize and differentiate the
+same expression once per consumer.  The cache keys each expression on
+the canonical text of its parsed tree, so that strings that differ only
+in spacing or bracketing share a single optimized tree.  Only the trees
+are shared: a lepton::CompiledExpression keeps its scratch workspace
+(and, when the JIT is enabled, its generated code) inside the object,
+so every consumer still compiles its own instance from the cached tree.
+Cached trees are never discarded, hence the references handed out stay
+valid for the lifetime of the process.
+*/
+class LeptonCache {
+public:
+/// Parse func and return the optimized expression, reusing a previously
+/// cached result when an expression with the same structure has been seen
+  static const lepton::ParsedExpression & parse( const std::string& func );
+/// As parse, but return the optimized derivative of func with respect to var
+  static const lepton::ParsedExpression & differentiate( const std::string& func, const std::string& var );
+};
+
+}
+
+#endif
@@ -50,11 +50,15 @@ void LinkCells::buildCellLists( const std::vector<Vector>& pos, const std::vecto
   // Setup the pbc object by copying it from action
   mypbc.setBox( pbc.getBox() );
 
-  // Setup the lists
+  // Setup the lists.  When nothing changed size the storage of the
+  // previous build is reused and no memory is touched
+  bool redo=false;
   if( pos.size()!=allcells.size() ) {
-    allcells.resize( pos.size() ); lcell_lists.resize( pos.size() );
+    allcells.resize( pos.size() ); newcells.resize( pos.size() ); lcell_lists.resize( pos.size() );
+    redo=true;
   }
 
+  unsigned oldncells[3]; for(unsigned k=0; k<3; ++k) oldncells[k]=ncells[k];
   {
 // This is the reciprocal lattice
 // notice that reciprocal.getRow(0) is a vector that is orthogonal to b and c
@@ -67,6 +71,7 @@ void LinkCells::buildCellLists( const std::vector<Vector>& pos, const std::vecto
     ncells[2] = std::floor( 1.0/ reciprocal.getRow(2).modulo() / link_cutoff );
     if( ncells[2]==0 ) ncells[2]=1;
   }
+  if( ncells[0]!=oldncells[0] || ncells[1]!=oldncells[1] || ncells[2]!=oldncells[2] ) redo=true;
   // Setup the strides
   nstride[0]=1; nstride[1]=ncells[0]; nstride[2]=ncells[0]*ncells[1];
 
@@ -74,20 +79,27 @@ void LinkCells::buildCellLists( const std::vector<Vector>& pos, const std::vecto
   unsigned ncellstot=ncells[0]*ncells[1]*ncells[2];
   if( lcell_tots.size()!=ncellstot ) {
     lcell_tots.resize( ncellstot ); lcell_starts.resize( ncellstot );
+    redo=true;
   }
-  // Clear nlcells
-  for(unsigned i=0; i<ncellstot; ++i) lcell_tots[i]=0;
-  // Clear allcells
-  allcells.assign( allcells.size(), 0 );
 
-  // Find out what cell everyone is in
+  // Find out what cell everyone is in.  This pass is needed whatever happens,
+  // so it also serves to detect the atoms that changed cell since the lists
+  // were last built
   unsigned rank=comm.Get_rank(), size=comm.Get_size();
-  for(unsigned i=rank; i<pos.size(); i+=size) {
-    allcells[i]=findCell( pos[i] );
-    lcell_tots[allcells[i]]++;
-  }
+  if( size>1 ) newcells.assign( newcells.size(), 0 );
+  for(unsigned i=rank; i<pos.size(); i+=size) newcells[i]=findCell( pos[i] );
   // And gather all this information on every node
-  comm.Sum( allcells ); comm.Sum( lcell_tots );
+  if( size>1 ) comm.Sum( newcells );
+
+  // If the cell grid is the one of the previous build and no atom moved to a
+  // different cell then the lists built last time are still valid
+  if( !redo && newcells==allcells && indices==last_indices ) return;
+  allcells.swap( newcells );
+  last_indices=indices;
+
+  // Count the atoms in each cell
+  for(unsigned i=0; i<ncellstot; ++i) lcell_tots[i]=0;
+  for(unsigned j=0; j<pos.size(); ++j) lcell_tots[allcells[j]]++;
 
   // Now prepare the link cell lists
   unsigned tot=0;
@@ -48,6 +48,11 @@ private:
   std::vector<unsigned> nstride;
 /// The list of cells each atom is inside
   std::vector<unsigned> allcells;
+/// Scratch used to find the cell of every atom before comparing with allcells
+  std::vector<unsigned> newcells;
+/// The indices the cell lists were built with, kept so that a rebuild can
+/// be skipped when nothing changed cell between two builds
+  std::vector<unsigned> last_indices;
 /// The start of each block corresponding to each link cell
   std::vector<unsigned> lcell_starts;
 /// The number of atoms in each link cell
@@ -82,6 +87,12 @@ public:
                              unsigned& natomsper, std::vector<unsigned>& atoms ) const ;
 /// Retrieve the atoms we need to consider
   void retrieveNeighboringAtoms( const Vector& pos, std::vector<unsigned>& cell_list, unsigned& natomsper, std::vector<unsigned>& atoms ) const ;
+/// Return the number of atoms in the icell-th link cell
+  unsigned getNumberOfAtomsInCell( const unsigned& icell ) const ;
+/// Return a pointer to the indices of the atoms in the icell-th link cell.
+/// The atoms of each cell are stored contiguously, so the slice can be
+/// traversed in place rather than copied out atom by atom
+  const unsigned* getCellAtomList( const unsigned& icell ) const ;
 };
 
 inline
@@ -94,6 +105,16 @@ unsigned LinkCells::getNumberOfCells() const {
   return ncells[0]*ncells[1]*ncells[2];
 }
 
+inline
+unsigned LinkCells::getNumberOfAtomsInCell( const unsigned& icell ) const {
+  return lcell_tots[icell];
+}
+
+inline
+const unsigned* LinkCells::getCellAtomList( const unsigned& icell ) const {
+  return lcell_lists.data() + lcell_starts[icell];
+}
+
 }
 
 #endif
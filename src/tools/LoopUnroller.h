@@ -22,6 +22,8 @@
 #ifndef __PLUMED_tools_LoopUnroller_h
 #define __PLUMED_tools_LoopUnroller_h
 
+#include <cstddef>
+
 namespace PLMD {
 
 /**
@@ -71,6 +73,12 @@ public:
 /// Dot product of d and v
 /// Same as `r=0.0; for(unsigned i=0;i<n;i++) r+=d[i]*v[i]; return r;`
   static double _dot(const double*d,const double*v);
+/// Indexed chain rule accumulation.
+/// Same as `for(unsigned i=0;i<n;i++) d[idx[i]*stride]+=df*v[idx[i]];`
+  static void _chain(double*d,const double df,const double*v,const unsigned*idx,const unsigned stride);
+/// Fused two-term indexed chain rule accumulation.
+/// Same as `for(unsigned i=0;i<n;i++) d[idx[i]*stride]+=df1*v1[idx[i]]+df2*v2[idx[i]];`
+  static void _chain2(double*d,const double df1,const double*v1,const double df2,const double*v2,const unsigned*idx,const unsigned stride);
 };
 
 template<unsigned n>
@@ -155,6 +163,95 @@ double LoopUnroller<1>::_dot(const double*d,const double*v) {
   return d[0]*v[0];
 }
 
+template<unsigned n>
+void LoopUnroller<n>::_chain(double*d,const double df,const double*v,const unsigned*idx,const unsigned stride) {
+  LoopUnroller<n-1>::_chain(d,df,v,idx,stride);
+  d[idx[n-1]*stride]+=df*v[idx[n-1]];
+}
+
+template<>
+inline
+void LoopUnroller<1>::_chain(double*d,const double df,const double*v,const unsigned*idx,const unsigned stride) {
+  d[idx[0]*stride]+=df*v[idx[0]];
+}
+
+template<unsigned n>
+void LoopUnroller<n>::_chain2(double*d,const double df1,const double*v1,const double df2,const double*v2,const unsigned*idx,const unsigned stride) {
+  LoopUnroller<n-1>::_chain2(d,df1,v1,df2,v2,idx,stride);
+  d[idx[n-1]*stride]+=df1*v1[idx[n-1]]+df2*v2[idx[n-1]];
+}
+
+template<>
+inline
+void LoopUnroller<1>::_chain2(double*d,const double df1,const double*v1,const double df2,const double*v2,const unsigned*idx,const unsigned stride) {
+  d[idx[0]*stride]+=df1*v1[idx[0]]+df2*v2[idx[0]];
+}
+
+/**
+\ingroup TOOLBOX
+Runtime dispatch to the unrolled kernels of LoopUnroller.
+
+In a few hot loops the length of the vectors involved is only known at
+run time but is almost always small: the number of arguments of a
+function, the number of active derivatives of a multicolvar task and so
+on.  This class holds function-pointer tables over the LoopUnroller
+instantiations for lengths 1 to nmax so that such loops can be dispatched
+to a fully unrolled kernel once the length is known, without the caller
+having to spell out a switch.  Kernel lookups return NULL when the length
+is zero or larger than nmax, in which case the caller should fall back on
+its generic loop.
+*/
+class LoopDispatch {
+public:
+/// Largest length covered by the kernel tables
+  static const unsigned nmax=8;
+/// Signature of the dot product kernels
+  typedef double (*dot_f)(const double*,const double*);
+/// Signature of the indexed chain rule kernels
+  typedef void (*chain_f)(double*,const double,const double*,const unsigned*,const unsigned);
+/// Signature of the fused two-term chain rule kernels
+  typedef void (*chain2_f)(double*,const double,const double*,const double,const double*,const unsigned*,const unsigned);
+/// Return the unrolled dot product kernel for length n or NULL if n is zero or larger than nmax
+  static dot_f dotKernel(const unsigned n);
+/// Return the unrolled chain rule kernel for length n or NULL if n is zero or larger than nmax
+  static chain_f chainKernel(const unsigned n);
+/// Return the unrolled fused two-term chain rule kernel for length n or NULL if n is zero or larger than nmax
+  static chain2_f chain2Kernel(const unsigned n);
+};
+
+inline
+LoopDispatch::dot_f LoopDispatch::dotKernel(const unsigned n) {
+  static const dot_f table[nmax+1]= {
+    NULL,
+    LoopUnroller<1>::_dot, LoopUnroller<2>::_dot, LoopUnroller<3>::_dot, LoopUnroller<4>::_dot,
+    LoopUnroller<5>::_dot, LoopUnroller<6>::_dot, LoopUnroller<7>::_dot, LoopUnroller<8>::_dot
+  };
+  if( n<1 || n>nmax ) return NULL;
+  return table[n];
+}
+
+inline
+LoopDispatch::chain_f LoopDispatch::chainKernel(const unsigned n) {
+  static const chain_f table[nmax+1]= {
+    NULL,
+    LoopUnroller<1>::_chain, LoopUnroller<2>::_chain, LoopUnroller<3>::_chain, LoopUnroller<4>::_chain,
+    LoopUnroller<5>::_chain, LoopUnroller<6>::_chain, LoopUnroller<7>::_chain, LoopUnroller<8>::_chain
+  };
+  if( n<1 || n>nmax ) return NULL;
+  return table[n];
+}
+
+inline
+LoopDispatch::chain2_f LoopDispatch::chain2Kernel(const unsigned n) {
+  static const chain2_f table[nmax+1]= {
+    NULL,
+    LoopUnroller<1>::_chain2, LoopUnroller<2>::_chain2, LoopUnroller<3>::_chain2, LoopUnroller<4>::_chain2,
+    LoopUnroller<5>::_chain2, LoopUnroller<6>::_chain2, LoopUnroller<7>::_chain2, LoopUnroller<8>::_chain2
+  };
+  if( n<1 || n>nmax ) return NULL;
+  return table[n];
+}
+
 }
 
 #endif
@@ -0,0 +1,178 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "MassChargeCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PLMD {
+
+namespace {
+
+const char mc_magic[8]= {'P','L','M','D','M','C','H','G'};
+const int32_t mc_version=1;
+const uint32_t mc_has_masses=1;
+const uint32_t mc_has_charges=2;
+
+// fixed size header, laid out so that the 64 bit fields that follow it
+// stay naturally aligned in the mapped file
+struct McHeader {
+  char magic[8];
+  int32_t version;
+  uint32_t flags;
+  uint64_t n;
+  uint64_t nmass;
+  uint64_t ncharge;
+};
+
+template<typename T>
+bool mcWrite(FILE* fp,const T* data,std::size_t n) {
+  return std::fwrite(data,sizeof(T),n,fp)==n;
+}
+
+// deduplicate a column of values: table receives the distinct values,
+// codes the per atom position in the table
+void mcEncode(const std::vector<double>& values,std::vector<double>& table,std::vector<uint32_t>& codes) {
+  std::map<double,uint32_t> seen;
+  codes.resize(values.size());
+  for(std::size_t i=0; i<values.size(); i++) {
+    auto it=seen.find(values[i]);
+    if(it==seen.end()) {
+      it=seen.insert(std::pair<double,uint32_t>(values[i],static_cast<uint32_t>(table.size()))).first;
+      table.push_back(values[i]);
+    }
+    codes[i]=it->second;
+  }
+}
+
+// expand a column back, checking that every code points inside the table
+bool mcDecode(const char* table,uint64_t ntable,const char* codes,uint64_t n,std::vector<double>& values) {
+  values.resize(n);
+  for(uint64_t i=0; i<n; i++) {
+    uint32_t c; std::memcpy(&c,codes+4*i,4);
+    if(c>=ntable) return false;
+    std::memcpy(&values[i],table+8*c,8);
+  }
+  return true;
+}
+
+}
+
+bool MassChargeCache::isBinary( const std::string& file ) {
+  FILE* fp=std::fopen(file.c_str(),"r");
+  if(!fp) return false;
+  char magic[8];
+  bool found=std::fread(magic,1,8,fp)==8 && std::memcmp(magic,mc_magic,8)==0;
+  std::fclose(fp);
+  return found;
+}
+
+bool MassChargeCache::write( const std::string& file, const std::vector<int>& index,
+                             const std::vector<double>& masses, const std::vector<double>& charges ) {
+  if(!masses.empty() && masses.size()!=index.size()) return false;
+  if(!charges.empty() && charges.size()!=index.size()) return false;
+  std::vector<double> masstable,chargetable;
+  std::vector<uint32_t> masscodes,chargecodes;
+  if(!masses.empty()) mcEncode(masses,masstable,masscodes);
+  if(!charges.empty()) mcEncode(charges,chargetable,chargecodes);
+  McHeader h;
+  std::memcpy(h.magic,mc_magic,8);
+  h.version=mc_version;
+  h.flags=(masses.empty()?0:mc_has_masses)|(charges.empty()?0:mc_has_charges);
+  h.n=index.size();
+  h.nmass=masstable.size();
+  h.ncharge=chargetable.size();
+  std::vector<int64_t> idx(index.begin(),index.end());
+  FILE* fp=std::fopen(file.c_str(),"w");
+  if(!fp) return false;
+  bool ok=mcWrite(fp,&h,1) &&
+          (h.n==0 || mcWrite(fp,idx.data(),h.n)) &&
+          (h.nmass==0 || mcWrite(fp,masstable.data(),h.nmass)) &&
+          (h.ncharge==0 || mcWrite(fp,chargetable.data(),h.ncharge)) &&
+          (masscodes.empty() || mcWrite(fp,masscodes.data(),h.n)) &&
+          (chargecodes.empty() || mcWrite(fp,chargecodes.data(),h.n));
+  if(std::fclose(fp)!=0) ok=false;
+  return ok;
+}
+
+bool MassChargeCache::read( const std::string& file, std::vector<int>& index,
+                            std::vector<double>& masses, std::vector<double>& charges ) {
+  index.clear(); masses.clear(); charges.clear();
+  int fd=open(file.c_str(),O_RDONLY);
+  if(fd<0) return false;
+  struct stat st;
+  if(fstat(fd,&st)!=0) { close(fd); return false; }
+  // header only validation: check the magic, the version and that the
+  // file size matches the one implied by the stored counts, then trust
+  // the payload and let the kernel fault it in on demand
+  McHeader h;
+  bool ok=static_cast<uint64_t>(st.st_size)>=sizeof(McHeader) &&
+          ::read(fd,&h,sizeof(McHeader))==static_cast<ssize_t>(sizeof(McHeader)) &&
+          std::memcmp(h.magic,mc_magic,8)==0 && h.version==mc_version;
+  if(ok) {
+    uint64_t expected=sizeof(McHeader)+8*h.n+8*(h.nmass+h.ncharge);
+    if(h.flags&mc_has_masses) expected+=4*h.n;
+    if(h.flags&mc_has_charges) expected+=4*h.n;
+    ok=static_cast<uint64_t>(st.st_size)==expected;
+  }
+  if(!ok) { close(fd); return false; }
+  const char* base=nullptr;
+  void* map=mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  std::vector<char> buffer;
+  if(map!=MAP_FAILED) base=static_cast<const char*>(map);
+  else {
+    // e.g. filesystems without mmap support: fall back to a plain read
+    buffer.resize(st.st_size);
+    ok=lseek(fd,0,SEEK_SET)==0 &&
+       ::read(fd,buffer.data(),st.st_size)==static_cast<ssize_t>(st.st_size);
+    base=buffer.data();
+  }
+  if(ok) {
+    const char* ptr=base+sizeof(McHeader);
+    index.resize(h.n);
+    for(uint64_t i=0; i<h.n; i++) {
+      int64_t ii; std::memcpy(&ii,ptr+8*i,8);
+      index[i]=static_cast<int>(ii);
+    }
+    const char* masstable=ptr+8*h.n;
+    const char* chargetable=masstable+8*h.nmass;
+    const char* codes=chargetable+8*h.ncharge;
+    if(ok && (h.flags&mc_has_masses)) {
+      ok=mcDecode(masstable,h.nmass,codes,h.n,masses);
+      codes+=4*h.n;
+    }
+    if(ok && (h.flags&mc_has_charges)) ok=mcDecode(chargetable,h.ncharge,codes,h.n,charges);
+  }
+  if(map!=MAP_FAILED) munmap(map,st.st_size);
+  close(fd);
+  if(!ok) { index.clear(); masses.clear(); charges.clear(); }
+  return ok;
+}
+
+}
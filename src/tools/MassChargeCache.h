@@ -0,0 +1,70 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_MassChargeCache_h
+#define __PLUMED_tools_MassChargeCache_h
+
+#include <string>
+#include <vector>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+Binary format for mass and charge files.
+
+The text format written by DUMPMASSCHARGE and consumed by driver --mc
+stores one formatted line per atom, which has to be tokenized and
+converted back at every startup.  For systems with millions of atoms
+this dominates the setup time of reanalysis runs.  This class provides
+an equivalent binary format that exploits the fact that most atoms share
+a handful of distinct mass and charge values: the distinct values are
+stored once in small tables and each atom carries a 32 bit code into
+them.  Readers validate the header only (magic, version and the file
+size implied by the stored counts) and then map the file into memory, so
+that the data pages are faulted in on demand rather than read and parsed
+up front.
+
+Either column can be absent, mirroring the ONLY_MASSES and ONLY_CHARGES
+options of DUMPMASSCHARGE.  Values are stored in PLUMED internal units,
+like in the text format.
+*/
+class MassChargeCache {
+public:
+/// Check whether file starts with the binary mass/charge magic.
+/// Returns false also when the file cannot be opened.
+  static bool isBinary( const std::string& file );
+/// Write index, mass and charge columns in the binary format.
+/// Pass an empty masses or charges vector to omit that column; non empty
+/// vectors must have the same size as index. Returns false on I/O errors.
+  static bool write( const std::string& file, const std::vector<int>& index,
+                     const std::vector<double>& masses, const std::vector<double>& charges );
+/// Read a binary mass/charge file. On success index contains the atom
+/// indexes and masses/charges the per atom values, left empty when the
+/// corresponding column was not stored. Returns false if the file is not
+/// in the binary format or fails the header validation.
+  static bool read( const std::string& file, std::vector<int>& index,
+                    std::vector<double>& masses, std::vector<double>& charges );
+};
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 #include "MatrixSquareBracketsAccess.h"
 #include "Tools.h"
 #include "Log.h"
+#include "LoopUnroller.h"
 #include "lapack/lapack.h"
 
 namespace PLMD {
@@ -46,6 +47,16 @@ template <typename T> T norm( const std::vector<T>& A ) {
   return val;
 }
 
+/// Dot product between two vectors of doubles, dispatched to the unrolled
+/// kernels of LoopUnroller when the length is small
+inline double dotProduct( const std::vector<double>& A, const std::vector<double>& B ) {
+  plumed_assert( A.size()==B.size() );
+  const LoopDispatch::dot_f kernel=LoopDispatch::dotKernel( A.size() );
+  if( kernel ) return kernel( &A[0], &B[0] );
+  double val=0.0; for(unsigned i=0; i<A.size(); ++i) { val+=A[i]*B[i]; }
+  return val;
+}
+
 /// This class stores a full matrix and allows one to do some simple matrix operations
 template <typename T>
 class Matrix:
@@ -57,6 +68,8 @@ class Matrix:
   template <typename U> friend void mult( const Matrix<U>&, const Matrix<U>&, Matrix<U>& );
   /// Matrix times a std::vector
   template <typename U> friend void mult( const Matrix<U>&, const std::vector<U>&, std::vector<U>& );
+  /// Matrix of doubles times a std::vector of doubles, dispatched to unrolled kernels for small column counts
+  friend void mult( const Matrix<double>&, const std::vector<double>&, std::vector<double>& );
   /// std::vector times a Matrix
   template <typename U> friend void mult( const std::vector<U>&, const Matrix<U>&, std::vector<U>& );
   /// Matrix transpose
@@ -178,6 +191,21 @@ template <typename T> void mult( const Matrix<T>& A, const std::vector<T>& B, st
   for(unsigned i=0; i<A.rw; ++i) for(unsigned k=0; k<A.cl; ++k) C[i]+=A(i,k)*B[k] ;
 }
 
+inline void mult( const Matrix<double>& A, const std::vector<double>& B, std::vector<double>& C) {
+  plumed_assert( A.cl==B.size() );
+  if( C.size()!=A.rw  ) { C.resize(A.rw); }
+  // rows are stored contiguously so each element of C is a dot product of
+  // length ncols; for the small column counts that dominate our profiles we
+  // pick the unrolled kernel once and reuse it for every row
+  const LoopDispatch::dot_f kernel=LoopDispatch::dotKernel( A.cl );
+  if( kernel ) {
+    for(unsigned i=0; i<A.rw; ++i) C[i]=kernel( &A.data[i*A.cl], &B[0] );
+    return;
+  }
+  for(unsigned i=0; i<A.rw; ++i) { C[i]=0.0; }
+  for(unsigned i=0; i<A.rw; ++i) for(unsigned k=0; k<A.cl; ++k) C[i]+=A(i,k)*B[k] ;
+}
+
 template <typename T> void mult( const std::vector<T>& A, const Matrix<T>& B, std::vector<T>& C) {
   plumed_assert( B.rw==A.size() );
   if( C.size()!=B.cl ) {C.resize( B.cl );}
@@ -203,10 +231,90 @@ template <typename T> void matrixOut( Log& ostr, const Matrix<T>& mat) {
   return;
 }
 
+namespace smallmat {
+
+/// Cyclic Jacobi diagonalization of an n x n symmetric matrix with n<=4.
+/// a holds the matrix row-wise and is destroyed; on output evals contains
+/// the eigenvalues in ascending order and the i-th ROW of evecs the
+/// corresponding eigenvector, as in diagMat. Everything lives on the stack,
+/// so for the tiny matrices that dominate alignment-heavy inputs this
+/// bypasses the LAPACK workspace queries and calls entirely. Returns false
+/// if the sweeps did not converge, in which case the caller should fall
+/// back on LAPACK
+inline bool jacobiDiag( const unsigned n, double* a, double* evals, double* evecs ) {
+  plumed_dbg_assert( n>0 && n<=4 );
+  double v[16];
+  for(unsigned i=0; i<n; ++i) for(unsigned j=0; j<n; ++j) v[i*n+j]=(i==j?1.0:0.0);
+  bool converged=false;
+  for(unsigned sweep=0; sweep<50; ++sweep) {
+    double off=0.0;
+    for(unsigned i=0; i<n; ++i) for(unsigned j=i+1; j<n; ++j) off+=std::fabs(a[i*n+j]);
+    if( off==0.0 ) { converged=true; break; }
+    for(unsigned p=0; p<n; ++p) for(unsigned q=p+1; q<n; ++q) {
+        const double apq=a[p*n+q];
+        if( apq==0.0 ) continue;
+        const double theta=0.5*(a[q*n+q]-a[p*n+p])/apq;
+        double t=1.0/(std::fabs(theta)+std::sqrt(1.0+theta*theta));
+        if( theta<0.0 ) t=-t;
+        const double c=1.0/std::sqrt(1.0+t*t), s=t*c, tau=s/(1.0+c);
+        a[p*n+p]-=t*apq; a[q*n+q]+=t*apq;
+        a[p*n+q]=a[q*n+p]=0.0;
+        for(unsigned k=0; k<n; ++k) {
+          if( k==p || k==q ) continue;
+          const double akp=a[k*n+p], akq=a[k*n+q];
+          a[k*n+p]=a[p*n+k]=akp-s*(akq+tau*akp);
+          a[k*n+q]=a[q*n+k]=akq+s*(akp-tau*akq);
+        }
+        // the columns of v accumulate the eigenvectors
+        for(unsigned k=0; k<n; ++k) {
+          const double vkp=v[k*n+p], vkq=v[k*n+q];
+          v[k*n+p]=vkp-s*(vkq+tau*vkp);
+          v[k*n+q]=vkq+s*(vkp-tau*vkq);
+        }
+      }
+  }
+  if( !converged ) return false;
+  // sort the eigenvalues in ascending order, as dsyevr does, and store
+  // the eigenvectors row-wise
+  unsigned order[4]; for(unsigned i=0; i<n; ++i) order[i]=i;
+  for(unsigned i=1; i<n; ++i) for(unsigned j=i; j>0 && a[order[j]*n+order[j]]<a[order[j-1]*n+order[j-1]]; --j) { const unsigned tmp=order[j]; order[j]=order[j-1]; order[j-1]=tmp; }
+  for(unsigned i=0; i<n; ++i) {
+    evals[i]=a[order[i]*n+order[i]];
+    for(unsigned k=0; k<n; ++k) evecs[i*n+k]=v[k*n+order[i]];
+  }
+  return true;
+}
+
+}
+
 template <typename T> int diagMat( const Matrix<T>& A, std::vector<double>& eigenvals, Matrix<double>& eigenvecs ) {
 
   // Check matrix is square and symmetric
   plumed_assert( A.rw==A.cl ); plumed_assert( A.isSymmetric()==1 );
+
+  // For tiny matrices a few Jacobi sweeps on the stack are cheaper than
+  // the LAPACK workspace queries and calls
+  if( A.cl<=4 && A.cl>0 ) {
+    const unsigned nn=A.cl;
+    double a[16], sevals[4], sevecs[16];
+    for(unsigned i=0; i<nn; ++i) for(unsigned j=0; j<nn; ++j) a[i*nn+j]=static_cast<double>( A(i,j) );
+    if( smallmat::jacobiDiag( nn, a, sevals, sevecs ) ) {
+      if( eigenvals.size()!=nn ) { eigenvals.resize( nn ); }
+      if( eigenvecs.rw!=nn || eigenvecs.cl!=nn ) { eigenvecs.resize( nn, nn ); }
+      for(unsigned i=0; i<nn; ++i) {
+        eigenvals[i]=sevals[i];
+        for(unsigned j=0; j<nn; ++j) eigenvecs(i,j)=sevecs[i*nn+j];
+      }
+      // This changes eigenvectors so that the first non-null element
+      // of each of them is positive, consistently with the LAPACK path
+      for(unsigned i=0; i<nn; ++i) {
+        unsigned j;
+        for(j=0; j<nn; j++) if(eigenvecs(i,j)*eigenvecs(i,j)>1e-14) break;
+        if(j<nn) if(eigenvecs(i,j)<0.0) for(j=0; j<nn; j++) eigenvecs(i,j)*=-1;
+      }
+      return 0;
+    }
+  }
   std::vector<double> da(A.sz);
   unsigned k=0;
   std::vector<double> evals(A.cl);
@@ -258,6 +366,27 @@ template <typename T> int diagMat( const Matrix<T>& A, std::vector<double>& eige
 }
 
 template <typename T> int pseudoInvert( const Matrix<T>& A, Matrix<double>& pseudoinverse ) {
+  // For tiny symmetric matrices the singular values are the moduli of the
+  // eigenvalues, so the pseudoinverse can be built from a stack-based
+  // Jacobi diagonalization without ever calling LAPACK
+  if( A.rw==A.cl && A.rw<=4 && A.rw>0 && A.isSymmetric()==1 ) {
+    const unsigned nn=A.cl;
+    double a[16], sevals[4], sevecs[16];
+    for(unsigned i=0; i<nn; ++i) for(unsigned j=0; j<nn; ++j) a[i*nn+j]=static_cast<double>( A(i,j) );
+    if( smallmat::jacobiDiag( nn, a, sevals, sevecs ) ) {
+      // Tolerance on the singular values as in the LAPACK path below
+      double tol=std::fabs(sevals[0]);
+      for(unsigned i=1; i<nn; ++i) { if( std::fabs(sevals[i])>tol ) tol=std::fabs(sevals[i]); }
+      tol*=nn*epsilon;
+      if( pseudoinverse.rw!=nn || pseudoinverse.cl!=nn ) pseudoinverse.resize( nn, nn );
+      for(unsigned i=0; i<nn; ++i) for(unsigned j=0; j<nn; ++j) {
+          double tmp=0.0;
+          for(unsigned k=0; k<nn; ++k) { if( std::fabs(sevals[k])>tol ) tmp+=sevecs[k*nn+i]*sevecs[k*nn+j]/sevals[k]; }
+          pseudoinverse(i,j)=tmp;
+        }
+      return 0;
+    }
+  }
   std::vector<double> da(A.sz);
   unsigned k=0;
   // Transfer the matrix to the local array
@@ -315,6 +444,40 @@ template <typename T> int Invert( const Matrix<T>& A, Matrix<double>& inverse )
     if(err!=0) return err;
     for (unsigned i=0; i<A.rw; ++i) for (unsigned j=0; j<A.cl; ++j) tevec(i,j)=evec(j,i)/eval[j];
     mult(tevec,evec,inverse);
+  } else if( A.rw==A.cl && A.rw<=3 && A.rw>0 ) {
+    // Analytic inversion through the adjugate: no LU factorization and no
+    // heap traffic for the 2x2 and 3x3 systems solved over and over during
+    // alignment and fitting
+    const unsigned nn=A.rw;
+    if( inverse.cl!=nn || inverse.rw!=nn ) { inverse.resize(nn,nn); }
+    if( nn==1 ) {
+      const double det=static_cast<double>( A(0,0) );
+      if( det==0.0 ) return 1;
+      inverse(0,0)=1.0/det;
+    } else if( nn==2 ) {
+      const double a=A(0,0), b=A(0,1), c=A(1,0), d=A(1,1);
+      const double det=a*d-b*c;
+      if( det==0.0 ) return 1;
+      const double idet=1.0/det;
+      inverse(0,0)=d*idet;  inverse(0,1)=-b*idet;
+      inverse(1,0)=-c*idet; inverse(1,1)=a*idet;
+    } else {
+      const double c00=A(1,1)*A(2,2)-A(1,2)*A(2,1);
+      const double c01=A(1,2)*A(2,0)-A(1,0)*A(2,2);
+      const double c02=A(1,0)*A(2,1)-A(1,1)*A(2,0);
+      const double det=A(0,0)*c00+A(0,1)*c01+A(0,2)*c02;
+      if( det==0.0 ) return 1;
+      const double idet=1.0/det;
+      inverse(0,0)=c00*idet;
+      inverse(1,0)=c01*idet;
+      inverse(2,0)=c02*idet;
+      inverse(0,1)=(A(0,2)*A(2,1)-A(0,1)*A(2,2))*idet;
+      inverse(1,1)=(A(0,0)*A(2,2)-A(0,2)*A(2,0))*idet;
+      inverse(2,1)=(A(0,1)*A(2,0)-A(0,0)*A(2,1))*idet;
+      inverse(0,2)=(A(0,1)*A(1,2)-A(0,2)*A(1,1))*idet;
+      inverse(1,2)=(A(0,2)*A(1,0)-A(0,0)*A(1,2))*idet;
+      inverse(2,2)=(A(0,0)*A(1,1)-A(0,1)*A(1,0))*idet;
+    }
   } else {
     std::vector<double> da(A.sz);
     std::vector<int> ipiv(A.cl);
@@ -376,6 +539,17 @@ template <typename T> int logdet( const Matrix<T>& M, double& ldet ) {
   // Check matrix is square and symmetric
   plumed_assert( M.rw==M.cl || M.isSymmetric() );
 
+  // Tiny matrices are diagonalized on the stack
+  if( M.cl<=4 && M.cl>0 ) {
+    const unsigned nn=M.cl;
+    double a[16], sevals[4], sevecs[16];
+    for(unsigned i=0; i<nn; ++i) for(unsigned j=0; j<nn; ++j) a[i*nn+j]=static_cast<double>( M(i,j) );
+    if( smallmat::jacobiDiag( nn, a, sevals, sevecs ) ) {
+      ldet=0; for(unsigned i=0; i<nn; i++) { ldet+=log(sevals[i]); }
+      return 0;
+    }
+  }
+
   std::vector<double> da(M.sz);
   unsigned k=0;
   std::vector<double> evals(M.cl);
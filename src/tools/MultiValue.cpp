@@ -20,6 +20,7 @@
    along with plumed.  If not, see <http://www.gnu.org/licenses/>.
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "MultiValue.h"
+#include "LoopUnroller.h"
 
 namespace PLMD {
 
@@ -50,6 +51,15 @@ void MultiValue::clearAll() {
   clearTemporyDerivatives(); hasDerivatives.deactivateAll(); atLeastOneSet=false;
 }
 
+void MultiValue::clearFast() {
+  tmpval=0.;
+  if( !atLeastOneSet ) {
+    for(unsigned i=0; i<values.size(); ++i) values[i]=0.;
+    return;
+  }
+  clearAll();
+}
+
 void MultiValue::clear( const unsigned& ival ) {
   values[ival]=0;
   unsigned base=ival*nderivatives, ndert=hasDerivatives.getNumberActive();
@@ -68,12 +78,32 @@ void MultiValue::chainRule( const unsigned& ival, const unsigned& iout, const un
   plumed_dbg_assert( off<stride );
   unsigned base=nderivatives*ival, ndert=hasDerivatives.getNumberActive();
   unsigned start=bufstart+stride*(nderivatives+1)*iout + stride;
+  // the active list here was built from an identity map so positions and
+  // values coincide, which lets us hand the raw index array to the unrolled
+  // kernels when few derivatives are active
+  const LoopDispatch::chain_f kernel=LoopDispatch::chainKernel( ndert );
+  if( kernel ) { kernel( &buffer[start], df, &derivatives[base], hasDerivatives.getActivePositions(), stride ); return; }
   for(unsigned i=0; i<ndert; ++i) {
     unsigned jder=hasDerivatives[i];
     buffer[start+jder*stride] += df*derivatives[base+jder];
   }
 }
 
+void MultiValue::chainRule2( const unsigned& ival1, const unsigned& ival2, const unsigned& iout, const unsigned& stride, const unsigned& off,
+                             const double& df1, const double& df2, const unsigned& bufstart, std::vector<double>& buffer ) {
+  if( !hasDerivatives.updateComplete() ) hasDerivatives.updateActiveMembers();
+
+  plumed_dbg_assert( off<stride );
+  unsigned base1=nderivatives*ival1, base2=nderivatives*ival2, ndert=hasDerivatives.getNumberActive();
+  unsigned start=bufstart+stride*(nderivatives+1)*iout + stride;
+  const LoopDispatch::chain2_f kernel=LoopDispatch::chain2Kernel( ndert );
+  if( kernel ) { kernel( &buffer[start], df1, &derivatives[base1], df2, &derivatives[base2], hasDerivatives.getActivePositions(), stride ); return; }
+  for(unsigned i=0; i<ndert; ++i) {
+    unsigned jder=hasDerivatives[i];
+    buffer[start+jder*stride] += df1*derivatives[base1+jder] + df2*derivatives[base2+jder];
+  }
+}
+
 void MultiValue::copyValues( MultiValue& outvals ) const {
   plumed_dbg_assert( values.size()<=outvals.getNumberOfValues() );
   for(unsigned i=0; i<values.size(); ++i) outvals.setValue( i, values[i] );
@@ -90,15 +120,67 @@ void MultiValue::copyDerivatives( MultiValue& outvals ) {
   }
 
   unsigned base=0, obase=0;
+  const LoopDispatch::chain_f kernel=LoopDispatch::chainKernel( ndert );
   for(unsigned i=0; i<values.size(); ++i) {
-    for(unsigned j=0; j<ndert; ++j) {
-      unsigned jder=hasDerivatives[j];
-      outvals.derivatives[obase+jder] += derivatives[base+jder];
+    if( kernel ) {
+      kernel( &outvals.derivatives[obase], 1.0, &derivatives[base], hasDerivatives.getActivePositions(), 1 );
+    } else {
+      for(unsigned j=0; j<ndert; ++j) {
+        unsigned jder=hasDerivatives[j];
+        outvals.derivatives[obase+jder] += derivatives[base+jder];
+      }
     }
     obase+=outvals.nderivatives; base+=nderivatives;
   }
 }
 
+void MultiValue::moveValuesAndDerivatives( MultiValue& outvals ) {
+  plumed_dbg_assert( &outvals!=this );
+  plumed_dbg_assert( values.size()<=outvals.getNumberOfValues() && nderivatives<=outvals.getNumberOfDerivatives() );
+  if( !hasDerivatives.updateComplete() ) hasDerivatives.updateActiveMembers();
+  unsigned ndert=hasDerivatives.getNumberActive();
+  if( values.size()==outvals.values.size() && nderivatives==outvals.nderivatives && !outvals.atLeastOneSet ) {
+    // the target is clean and has the same layout: exchange the storage
+    // wholesale rather than accumulating row by row.  Both objects live
+    // across the task loop, so the buffers just ping pong between them
+    // and nothing is reallocated
+    values.swap( outvals.values );
+    derivatives.swap( outvals.derivatives );
+    std::swap( hasDerivatives, outvals.hasDerivatives );
+    outvals.atLeastOneSet=atLeastOneSet; atLeastOneSet=false;
+    // keep the source active list alive: it came in deactivated from the
+    // clean target, and the indices are the same on both sides
+    for(unsigned j=0; j<ndert; ++j) hasDerivatives.activate( outvals.hasDerivatives[j] );
+    hasDerivatives.updateActiveMembers();
+    return;
+  }
+  // different row strides (e.g. the bridged action carries extra
+  // derivatives): fall back to the accumulating copy
+  copyValues( outvals );
+  copyDerivatives( outvals );
+}
+
+namespace {
+// each thread keeps its own free list of recycled objects so that borrowing
+// needs no locking; only exact shape matches are reused and the list is kept
+// short so stale size classes do not accumulate
+thread_local std::vector<std::unique_ptr<MultiValue> > tmv_pool;
+}
+
+TemporaryMultiValue::TemporaryMultiValue( const unsigned& nvals, const unsigned& nder ) {
+  for(unsigned i=0; i<tmv_pool.size(); ++i) {
+    if( tmv_pool[i]->getNumberOfValues()==nvals && tmv_pool[i]->getNumberOfDerivatives()==nder ) {
+      myval=std::move(tmv_pool[i]); tmv_pool.erase(tmv_pool.begin()+i);
+      myval->clearFast(); return;
+    }
+  }
+  myval.reset(new MultiValue(nvals,nder));
+}
+
+TemporaryMultiValue::~TemporaryMultiValue() {
+  if( tmv_pool.size()<8 ) tmv_pool.push_back(std::move(myval));
+}
+
 void MultiValue::quotientRule( const unsigned& nder, const unsigned& oder ) {
   plumed_dbg_assert( nder<values.size() && oder<values.size() );
   if( !hasDerivatives.updateComplete() ) hasDerivatives.updateActiveMembers();
@@ -23,6 +23,7 @@
 #define __PLUMED_tools_MultiValue_h
 
 #include <vector>
+#include <memory>
 #include "Exception.h"
 #include "DynamicList.h"
 
@@ -78,6 +79,9 @@ public:
   double getTemporyDerivative( const unsigned& jder ) const ;
 /// Clear all values
   void clearAll();
+/// Clear all values, skipping the derivative bookkeeping entirely when no
+/// derivative was ever set
+  void clearFast();
 /// Clear the tempory derivatives
   void clearTemporyDerivatives();
 /// Clear a value
@@ -97,14 +101,41 @@ public:
   unsigned getActiveIndex( const unsigned& ) const ;
 /// Transfer derivatives to buffer
   void chainRule( const unsigned&, const unsigned&, const unsigned&, const unsigned&, const double&, const unsigned&, std::vector<double>& buffer );
+/// Transfer the derivatives of two values to the same output in a single
+/// pass over the active list, accumulating df1*der(ival1)+df2*der(ival2).
+/// Equivalent to two chainRule calls with the same iout but does half
+/// the scatters into the buffer
+  void chainRule2( const unsigned& ival1, const unsigned& ival2, const unsigned& iout, const unsigned& stride, const unsigned& off,
+                   const double& df1, const double& df2, const unsigned& bufstart, std::vector<double>& buffer );
 ///
   void copyValues( MultiValue& ) const ;
 ///
   void copyDerivatives( MultiValue& );
+/// Hand values and derivatives over to outvals. When the two objects have
+/// the same shape and outvals is clean the storage is swapped wholesale
+/// instead of being copied element by element; the data contents of this
+/// object are then unspecified, but its active derivative list survives,
+/// as bridged actions consult it after the transfer
+  void moveValuesAndDerivatives( MultiValue& );
 ///
   void quotientRule( const unsigned& nder, const unsigned& oder );
 };
 
+/// Borrow a MultiValue of the requested shape from a per-thread pool of
+/// recycled objects and return it when the handle goes out of scope.  Task
+/// loops that need scratch MultiValue objects should use this rather than
+/// constructing one per call, which churns the allocator.  The borrowed
+/// object is handed over cleared
+class TemporaryMultiValue {
+private:
+  std::unique_ptr<MultiValue> myval;
+public:
+  TemporaryMultiValue( const unsigned& nvals, const unsigned& nder );
+  ~TemporaryMultiValue();
+  MultiValue& operator*() const { return *myval; }
+  MultiValue* operator->() const { return myval.get(); }
+};
+
 inline
 unsigned MultiValue::getNumberOfValues() const {
   return values.size();
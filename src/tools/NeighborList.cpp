@@ -35,10 +35,15 @@ using namespace std;
 
 NeighborList::NeighborList(const vector<AtomNumber>& list0, const vector<AtomNumber>& list1,
                            const bool& serial, const bool& do_pair, const bool& do_pbc, const Pbc& pbc, Communicator& cm,
-                           const double& distance, const unsigned& stride): reduced(false),
-  serial_(serial), do_pair_(do_pair), do_pbc_(do_pbc), pbc_(&pbc), comm(cm),
-  distance_(distance), stride_(stride)
+                           const double& distance, const unsigned& stride, const bool& do_celllist,
+                           const double& skin): reduced(false),
+  serial_(serial), do_pair_(do_pair), do_pbc_(do_pbc), do_celllist_(do_celllist), pbc_(&pbc), comm(cm),
+  linkcells_(serial?nullcomm_:cm),
+  distance_(distance), skin_(skin), stride_(stride)
 {
+// with the PAIR option the number of pairs is already linear in the
+// number of atoms, so spatial binning would only add overhead
+  if(do_pair_) do_celllist_=false;
 // store full list of atoms needed
   fullatomlist_=list0;
   fullatomlist_.insert(fullatomlist_.end(),list1.begin(),list1.end());
@@ -58,9 +63,11 @@ NeighborList::NeighborList(const vector<AtomNumber>& list0, const vector<AtomNum
 
 NeighborList::NeighborList(const vector<AtomNumber>& list0, const bool& serial, const bool& do_pbc,
                            const Pbc& pbc, Communicator& cm, const double& distance,
-                           const unsigned& stride): reduced(false),
-  serial_(serial), do_pbc_(do_pbc), pbc_(&pbc), comm(cm),
-  distance_(distance), stride_(stride) {
+                           const unsigned& stride, const bool& do_celllist,
+                           const double& skin): reduced(false),
+  serial_(serial), do_pbc_(do_pbc), do_celllist_(do_celllist), pbc_(&pbc), comm(cm),
+  linkcells_(serial?nullcomm_:cm),
+  distance_(distance), skin_(skin), stride_(stride) {
   fullatomlist_=list0;
   nlist0_=list0.size();
   twolists_=false;
@@ -97,7 +104,9 @@ pair<unsigned,unsigned> NeighborList::getIndexPair(unsigned ipair) {
 
 void NeighborList::update(const vector<Vector>& positions) {
   neighbors_.clear();
-  const double d2=distance_*distance_;
+// the skin enlarges the build cutoff, so that the list remains valid until
+// some atom moves by more than half the skin
+  const double d2=(distance_+skin_)*(distance_+skin_);
   // check if positions array has the correct length
   plumed_assert(positions.size()==fullatomlist_.size());
 
@@ -111,28 +120,32 @@ void NeighborList::update(const vector<Vector>& positions) {
   }
   std::vector<unsigned> local_flat_nl;
 
-  #pragma omp parallel num_threads(nt)
-  {
-    std::vector<unsigned> private_flat_nl;
-    #pragma omp for nowait
-    for(unsigned int i=rank; i<nallpairs_; i+=stride) {
-      pair<unsigned,unsigned> index=getIndexPair(i);
-      unsigned index0=index.first;
-      unsigned index1=index.second;
-      Vector distance;
-      if(do_pbc_) {
-        distance=pbc_->distance(positions[index0],positions[index1]);
-      } else {
-        distance=delta(positions[index0],positions[index1]);
-      }
-      double value=modulo2(distance);
-      if(value<=d2) {
-        private_flat_nl.push_back(index0);
-        private_flat_nl.push_back(index1);
+  if(canUseCellList()) {
+    updateWithCellList(positions,local_flat_nl,rank,stride,nt);
+  } else {
+    #pragma omp parallel num_threads(nt)
+    {
+      std::vector<unsigned> private_flat_nl;
+      #pragma omp for nowait
+      for(unsigned int i=rank; i<nallpairs_; i+=stride) {
+        pair<unsigned,unsigned> index=getIndexPair(i);
+        unsigned index0=index.first;
+        unsigned index1=index.second;
+        Vector distance;
+        if(do_pbc_) {
+          distance=pbc_->distance(positions[index0],positions[index1]);
+        } else {
+          distance=delta(positions[index0],positions[index1]);
+        }
+        double value=modulo2(distance);
+        if(value<=d2) {
+          private_flat_nl.push_back(index0);
+          private_flat_nl.push_back(index1);
+        }
       }
+      #pragma omp critical
+      local_flat_nl.insert(local_flat_nl.end(), private_flat_nl.begin(), private_flat_nl.end());
     }
-    #pragma omp critical
-    local_flat_nl.insert(local_flat_nl.end(), private_flat_nl.begin(), private_flat_nl.end());
   }
 
   // find total dimension of neighborlist
@@ -140,7 +153,11 @@ void NeighborList::update(const vector<Vector>& positions) {
   local_nl_size[rank] = local_flat_nl.size();
   if(!serial_) comm.Sum(&local_nl_size[0], stride);
   int tot_size = std::accumulate(local_nl_size.begin(), local_nl_size.end(), 0);
-  if(tot_size==0) {setRequestList(); return;}
+  if(tot_size==0) {
+    if(skin_>0.0) lastPositions_=positions;
+    setRequestList();
+    return;
+  }
   // merge
   std::vector<unsigned> merge_nl(tot_size, 0);
   // calculate vector of displacement
@@ -161,9 +178,57 @@ void NeighborList::update(const vector<Vector>& positions) {
     neighbors_[i] = std::make_pair(merge_nl[j],merge_nl[j+1]);
   }
 
+  if(skin_>0.0) lastPositions_=positions;
+
   setRequestList();
 }
 
+bool NeighborList::canUseCellList() const {
+// the cell lists bin atoms inside the box, so they need periodic
+// boundary conditions and a properly set box
+  return do_celllist_ && do_pbc_ && pbc_->getBox().determinant()!=0.0;
+}
+
+void NeighborList::updateWithCellList(const vector<Vector>& positions, std::vector<unsigned>& flat_nl,
+                                      unsigned rank, unsigned stride, unsigned nt) {
+  const double d2=(distance_+skin_)*(distance_+skin_);
+// bin all the atoms on a grid of cells of side distance_+skin_, so that all
+// the neighbors of an atom are found in its own cell and in the adjacent ones
+  linkcells_.setCutoff( distance_+skin_ );
+  std::vector<unsigned> indices(positions.size());
+  std::iota(indices.begin(),indices.end(),0);
+  linkcells_.buildCellLists( positions, indices, *pbc_ );
+
+  #pragma omp parallel num_threads(nt)
+  {
+    std::vector<unsigned> private_flat_nl;
+    std::vector<unsigned> cell_list( linkcells_.getNumberOfCells() );
+    std::vector<unsigned> atoms( 1+positions.size() );
+    #pragma omp for nowait
+    for(unsigned int i=rank; i<nlist0_; i+=stride) {
+      atoms[0]=i; unsigned natomsper=1;
+      linkcells_.retrieveNeighboringAtoms( positions[i], cell_list, natomsper, atoms );
+      for(unsigned k=1; k<natomsper; ++k) {
+        unsigned j=atoms[k];
+        if(twolists_) {
+          // with two lists only pairs between the first and the second list count
+          if(j<nlist0_) continue;
+        } else {
+          // with a single list each pair should be examined only once
+          if(j<=i) continue;
+        }
+        Vector distance=pbc_->distance(positions[i],positions[j]);
+        if(modulo2(distance)<=d2) {
+          private_flat_nl.push_back(i);
+          private_flat_nl.push_back(j);
+        }
+      }
+    }
+    #pragma omp critical
+    flat_nl.insert(flat_nl.end(), private_flat_nl.begin(), private_flat_nl.end());
+  }
+}
+
 void NeighborList::setRequestList() {
   requestlist_.clear();
   for(unsigned int i=0; i<size(); ++i) {
@@ -192,6 +257,26 @@ unsigned NeighborList::getStride() const {
   return stride_;
 }
 
+double NeighborList::getSkin() const {
+  return skin_;
+}
+
+bool NeighborList::needsUpdate(const vector<Vector>& positions) const {
+  plumed_assert(skin_>0.0);
+  if(lastPositions_.size()!=positions.size()) return true;
+  const double half2=0.25*skin_*skin_;
+  for(unsigned i=0; i<positions.size(); ++i) {
+    Vector displacement;
+    if(do_pbc_) {
+      displacement=pbc_->distance(lastPositions_[i],positions[i]);
+    } else {
+      displacement=delta(lastPositions_[i],positions[i]);
+    }
+    if(modulo2(displacement)>half2) return true;
+  }
+  return false;
+}
+
 unsigned NeighborList::getLastUpdate() const {
   return lastupdate_;
 }
@@ -24,13 +24,14 @@
 
 #include "Vector.h"
 #include "AtomNumber.h"
+#include "Communicator.h"
+#include "LinkCells.h"
 
 #include <vector>
 
 namespace PLMD {
 
 class Pbc;
-class Communicator;
 
 /// \ingroup TOOLBOX
 /// A class that implements neighbor lists from two lists or a single list of atoms
@@ -39,17 +40,35 @@ class NeighborList
   bool reduced;
   bool serial_;
   bool do_pair_,do_pbc_,twolists_;
+/// Rebuild the list of close pairs with a cell-list (spatial binning) algorithm,
+/// which scales linearly with the number of atoms instead of quadratically
+  bool do_celllist_;
+/// Positions of all the atoms at the time of the last rebuild, used to
+/// trigger displacement-based rebuilds when a skin is in use
+  std::vector<PLMD::Vector> lastPositions_;
   const PLMD::Pbc* pbc_;
   Communicator& comm;
+/// Dummy communicator used by the cell lists when the neighbor list is serial
+  Communicator nullcomm_;
+  LinkCells linkcells_;
   std::vector<PLMD::AtomNumber> fullatomlist_,requestlist_;
   std::vector<std::pair<unsigned,unsigned> > neighbors_;
   double distance_;
+/// Verlet skin: the list is built with cutoff distance_+skin_ and declared
+/// stale only when some atom has moved by more than half the skin
+  double skin_;
   unsigned stride_,nlist0_,nlist1_,nallpairs_,lastupdate_;
 /// Initialize the neighbor list with all possible pairs
   void initialize();
 /// Return the pair of indexes in the positions array
 /// of the two atoms forming the i-th pair among all possible pairs
   std::pair<unsigned,unsigned> getIndexPair(unsigned i);
+/// Check whether the cell-list build path can be used for this update
+  bool canUseCellList() const;
+/// Build the list of close pairs by binning atoms on a grid of cells of
+/// size distance_, so that only pairs in neighboring cells are examined
+  void updateWithCellList(const std::vector<PLMD::Vector>& positions, std::vector<unsigned>& flat_nl,
+                          unsigned rank, unsigned stride, unsigned nt);
 /// Extract the list of atoms from the current list of close pairs
   void setRequestList();
 public:
@@ -57,12 +76,14 @@ public:
                const std::vector<PLMD::AtomNumber>& list1,
                const bool& serial,
                const bool& do_pair, const bool& do_pbc, const PLMD::Pbc& pbc, Communicator &cm,
-               const double& distance=1.0e+30, const unsigned& stride=0);
+               const double& distance=1.0e+30, const unsigned& stride=0,
+               const bool& do_celllist=false, const double& skin=0.0);
   NeighborList(const std::vector<PLMD::AtomNumber>& list0,
                const bool& serial,
                const bool& do_pbc,
                const PLMD::Pbc& pbc, Communicator &cm, const double& distance=1.0e+30,
-               const unsigned& stride=0);
+               const unsigned& stride=0, const bool& do_celllist=false,
+               const double& skin=0.0);
 /// Return the list of all atoms. These are needed to rebuild the neighbor list.
   std::vector<PLMD::AtomNumber>& getFullAtomList();
 /// Update the indexes in the neighbor list to match the
@@ -74,6 +95,11 @@ public:
   void update(const std::vector<PLMD::Vector>& positions);
 /// Get the update stride of the neighbor list
   unsigned getStride() const;
+/// Get the Verlet skin of the neighbor list (0 if not used)
+  double getSkin() const;
+/// Check whether the list is stale, i.e. whether some atom has moved by
+/// more than half the skin since the last rebuild
+  bool needsUpdate(const std::vector<PLMD::Vector>& positions) const;
 /// Get the last step in which the neighbor list was updated
   unsigned getLastUpdate() const;
 /// Set the step of the last update
@@ -0,0 +1,37 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "Numa.h"
+
+namespace PLMD {
+
+void Numa::touch( char* ptr, const std::size_t& nbytes, const bool chunked ) {
+  const std::size_t npages=(nbytes+pagesize-1)/pagesize;
+  if( chunked ) {
+    #pragma omp parallel for schedule(static) num_threads(OpenMP::getNumThreads())
+    for(std::size_t i=0; i<npages; ++i) ptr[i*pagesize]=0;
+  } else {
+    #pragma omp parallel for schedule(static,1) num_threads(OpenMP::getNumThreads())
+    for(std::size_t i=0; i<npages; ++i) ptr[i*pagesize]=0;
+  }
+}
+
+}
@@ -0,0 +1,89 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_Numa_h
+#define __PLUMED_tools_Numa_h
+
+#include "OpenMP.h"
+#include <vector>
+#include <cstddef>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+NUMA aware allocation helpers.
+
+On multi socket machines the operating system places each page of memory
+on the node of the thread that first writes to it.  std::vector
+initializes its storage serially, which puts every large per step array
+on the socket of the master thread and makes the threads of the other
+socket fetch everything across the interconnect.  The helpers here
+allocate fresh storage and touch it page by page from a parallel region
+before the vector takes ownership, so that pages end up distributed over
+the nodes of the machine.  Placement only matters the first time a page
+is written, so these helpers are meant for the initial (re)allocation of
+long lived buffers; they fall back on a plain resize when no thread team
+is available or when the vector capacity is already sufficient, in which
+case placement has happened long ago.
+*/
+class Numa {
+/// Page size used to stride the first touch loops
+  static const std::size_t pagesize=4096;
+/// Touch every page of a raw range from a parallel region.  With
+/// chunked=true consecutive page ranges go to consecutive threads; with
+/// chunked=false pages are interleaved round robin over the threads
+  static void touch( char* ptr, const std::size_t& nbytes, const bool chunked );
+public:
+/// Resize v to n elements with block first touch: consecutive page ranges
+/// go to consecutive threads, matching statically scheduled loops over the
+/// array
+  template<class T> static void firstTouchResize( std::vector<T>& v, const std::size_t& n );
+/// Resize v to n elements with the pages interleaved over the threads,
+/// for arrays that are accessed with no particular thread affinity
+  template<class T> static void interleavedResize( std::vector<T>& v, const std::size_t& n );
+};
+
+template<class T>
+void Numa::firstTouchResize( std::vector<T>& v, const std::size_t& n ) {
+  if( v.capacity()>=n || OpenMP::getNumThreads()<2 ) { v.resize(n); return; }
+  std::vector<T> fresh;
+  fresh.reserve(n);
+  touch( reinterpret_cast<char*>(fresh.data()), n*sizeof(T), true );
+  fresh.resize(n);
+  std::copy( v.begin(), v.end(), fresh.begin() );
+  v.swap(fresh);
+}
+
+template<class T>
+void Numa::interleavedResize( std::vector<T>& v, const std::size_t& n ) {
+  if( v.capacity()>=n || OpenMP::getNumThreads()<2 ) { v.resize(n); return; }
+  std::vector<T> fresh;
+  fresh.reserve(n);
+  touch( reinterpret_cast<char*>(fresh.data()), n*sizeof(T), false );
+  fresh.resize(n);
+  std::copy( v.begin(), v.end(), fresh.begin() );
+  v.swap(fresh);
+}
+
+}
+
+#endif
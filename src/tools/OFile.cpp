@@ -27,6 +27,7 @@
 #include "Communicator.h"
 #include "Tools.h"
 #include <cstdarg>
+#include <cstdint>
 #include <cstring>
 
 #include <iostream>
@@ -36,6 +37,10 @@
 
 #include <memory>
 #include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 #ifdef __PLUMED_HAS_ZLIB
 #include <zlib.h>
@@ -43,17 +48,187 @@
 
 namespace PLMD {
 
+namespace {
+
+/// Magic marker starting a binary fields file, shared with IFile
+const char binary_fields_magic[8]={'P','L','M','D','C','O','L','B'};
+const int32_t binary_fields_version=1;
+
+void appendBinaryInt(std::string & buf, int32_t i) {
+  buf.append(reinterpret_cast<const char*>(&i),sizeof(i));
+}
+
+void appendBinaryString(std::string & buf, const std::string & s) {
+  appendBinaryInt(buf,s.length());
+  buf.append(s);
+}
+
+}
+
+/// \page asyncwriter
+/// Background writer used when the PLUMED_ASYNC_IO environment variable is
+/// set. Formatted output is appended to an in-memory buffer; full buffers
+/// rotate through a small ring handed to a flush thread, so that the
+/// calculation thread only blocks on the filesystem when all the buffers
+/// are in flight. flush() acts as a barrier: it returns once everything
+/// that was queued has been handed to the operating system.
+class OFile::AsyncWriter {
+/// Number of buffers that can be queued before the writer blocks
+  static const unsigned nbuffers=4;
+/// A buffer is queued to the flush thread once it grows to this size
+  static const size_t bufsize=65536;
+/// Handle of the file; owned by the OFile, not by this class
+  FILE* fp;
+/// Buffer currently being filled
+  std::string current;
+/// Full buffers waiting for the flush thread
+  std::deque<std::string> pending;
+/// Set when a buffer is being written out, so that barrier() can wait for it
+  bool inflight;
+/// Set by the destructor to terminate the flush thread
+  bool done;
+/// Set by the flush thread when a write fails, reported at the next barrier
+  bool failed;
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::thread thread;
+/// Main loop of the flush thread
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;) {
+      while(pending.empty() && !done) notEmpty.wait(lock);
+      if(pending.empty()) break;
+      std::string buf;
+      buf.swap(pending.front());
+      pending.pop_front();
+      inflight=true;
+      lock.unlock();
+      size_t r=std::fwrite(buf.c_str(),1,buf.size(),fp);
+      lock.lock();
+      if(r!=buf.size()) failed=true;
+      inflight=false;
+      notFull.notify_all();
+    }
+  }
+public:
+  explicit AsyncWriter(FILE* f):
+    fp(f),
+    inflight(false),
+    done(false),
+    failed(false)
+  {
+    current.reserve(bufsize);
+    thread=std::thread(&AsyncWriter::run,this);
+  }
+  ~AsyncWriter() {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if(!current.empty()) {
+        pending.emplace_back();
+        pending.back().swap(current);
+      }
+      done=true;
+      notEmpty.notify_one();
+    }
+    thread.join();
+  }
+/// Queue some formatted output, blocking only when the ring is full
+  size_t write(const char* ptr,size_t s) {
+    std::unique_lock<std::mutex> lock(mutex);
+    current.append(ptr,s);
+    if(current.size()>=bufsize) {
+      while(pending.size()>=nbuffers) notFull.wait(lock);
+      pending.emplace_back();
+      pending.back().swap(current);
+      current.reserve(bufsize);
+      notEmpty.notify_one();
+    }
+    return s;
+  }
+/// Wait until everything queued so far has been handed to the operating system
+  void barrier() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if(!current.empty()) {
+      pending.emplace_back();
+      pending.back().swap(current);
+      notEmpty.notify_one();
+    }
+    while(!pending.empty() || inflight) notFull.wait(lock);
+    if(failed) plumed_merror("error writing file");
+  }
+/// Change the file handle, e.g. after the heavy-flush close/reopen.
+/// Must be called right after a barrier(), when the queue is empty
+  void resetHandle(FILE* f) {
+    std::unique_lock<std::mutex> lock(mutex);
+    fp=f;
+  }
+};
+
+#ifdef __PLUMED_HAS_MPI
+/// Writes to a single file shared between all the replicas using MPI-IO.
+/// Every line is prefixed with a tag identifying the replica that produced
+/// it.  Output is gathered into complete lines and the lines into a large
+/// buffer that is written with the shared file pointer, so that records
+/// from different replicas never interleave within a line and the metadata
+/// load on the filesystem is that of one file rather than one per replica
+class OFile::SharedFile {
+/// The MPI-IO handle, opened collectively on the inter-replica communicator
+  MPI_File fh;
+/// Tag prepended to every line
+  std::string tag;
+/// Bytes received that are not yet terminated by a newline
+  std::string pending;
+/// Complete tagged lines waiting to be written
+  std::string outbuf;
+/// Lines are aggregated up to roughly this size before they are written
+  static const std::size_t chunksize=1048576;
+public:
+  SharedFile( MPI_Comm comm, const std::string& path, const int& replica, const bool& restart ) {
+    std::string num; Tools::convert( replica, num ); tag="R" + num + " ";
+    int amode=MPI_MODE_CREATE|MPI_MODE_WRONLY;
+    if( restart ) amode|=MPI_MODE_APPEND;
+    if( MPI_File_open( comm, const_cast<char*>(path.c_str()), amode, MPI_INFO_NULL, &fh )!=MPI_SUCCESS )
+      plumed_merror("cannot open shared file " + path);
+    if( !restart ) MPI_File_set_size( fh, 0 );
+  }
+  ~SharedFile() { flush(); MPI_File_close( &fh ); }
+  size_t write( const char* ptr, size_t s ) {
+    pending.append( ptr, s );
+    std::size_t nl;
+    while( (nl=pending.find('\n'))!=std::string::npos ) {
+      outbuf+=tag; outbuf.append( pending, 0, nl+1 );
+      pending.erase( 0, nl+1 );
+    }
+    if( outbuf.size()>=chunksize ) flush();
+    return s;
+  }
+  void flush() {
+    if( outbuf.empty() ) return;
+    MPI_File_write_shared( fh, const_cast<char*>(outbuf.c_str()), outbuf.size(), MPI_CHAR, MPI_STATUS_IGNORE );
+    outbuf.clear();
+  }
+};
+#endif
+
 size_t OFile::llwrite(const char*ptr,size_t s) {
   size_t r;
   if(linked) return linked->llwrite(ptr,s);
   if(! (comm && comm->Get_rank()>0)) {
-    if(!fp) plumed_merror("writing on uninitialized File");
-    if(gzfp) {
+#ifdef __PLUMED_HAS_MPI
+    if(sharedFile_) {
+      r=sharedFile_->write(ptr,s);
+    } else
+#endif
+    if(!fp) { plumed_merror("writing on uninitialized File");
+    } else if(gzfp) {
 #ifdef __PLUMED_HAS_ZLIB
       r=gzwrite(gzFile(gzfp),ptr,s);
 #else
       plumed_merror("file " + getPath() + ": trying to use a gz file without zlib being linked");
 #endif
+    } else if(asyncWriter_) {
+      r=asyncWriter_->write(ptr,s);
     } else {
       r=fwrite(ptr,1,s,fp);
     }
@@ -73,7 +248,11 @@ size_t OFile::llwrite(const char*ptr,size_t s) {
 
 OFile::OFile():
   linked(NULL),
+  binaryFields_(false),
+  binaryHeaderWritten_(false),
   fieldChanged(false),
+  nfields(0),
+  nprevious_fields(0),
   backstring("bck"),
   enforceRestart_(false),
   enforceBackup_(false)
@@ -89,6 +268,12 @@ OFile::OFile():
   for(unsigned i=0; i<1000; ++i) buffer_string[i]=0;
 }
 
+OFile::~OFile() {
+// defined here, where AsyncWriter is a complete type.
+// the writer is a member, so it drains and joins before
+// ~FileBase closes the file handle
+}
+
 OFile& OFile::link(OFile&l) {
   fp=NULL;
   gzfp=NULL;
@@ -150,9 +335,21 @@ OFile& OFile::clearFields() {
   fields.clear();
   const_fields.clear();
   previous_fields.clear();
+  nfields=0;
+  nprevious_fields=0;
   return *this;
 }
 
+OFile::Field& OFile::nextField() {
+  if(nfields==fields.size()) fields.push_back(Field());
+  Field& f=fields[nfields]; nfields++;
+// recycled entries keep the string capacity of a previous line, but
+// everything else has to be reset
+  f.constant=false;
+  f.dvalue=0.0;
+  return f;
+}
+
 OFile& OFile::fmtField(const std::string&fmt) {
   this->fieldFmt=fmt;
   return *this;
@@ -163,17 +360,40 @@ OFile& OFile::fmtField() {
   return *this;
 }
 
+OFile& OFile::setBinaryFields() {
+  plumed_massert(!binaryHeaderWritten_,"setBinaryFields should be called before the first printField");
+// binary records are not newline-delimited so they cannot be tagged per replica
+  plumed_massert(!sharedFile_,"binary fields cannot be written to an MPI shared file");
+  binaryFields_=true;
+  return *this;
+}
+
 OFile& OFile::printField(const std::string&name,double v) {
 // When one tries to print -nan we print nan instead.
 // The distinction between +nan and -nan is not well defined
 // Always printing nan simplifies some regtest (special functions computed our of range).
   if(std::isnan(v)) v=std::numeric_limits<double>::quiet_NaN();
+  if(binaryFields_) {
+    unsigned i;
+    for(i=0; i<const_fields.size(); i++) if(const_fields[i].name==name) break;
+    if(i>=const_fields.size()) {
+// regular fields are stored unformatted and written as raw doubles
+      Field& field=nextField();
+      field.name.assign(name);
+      field.dvalue=v;
+      return *this;
+    }
+// constant fields end up as strings in the schema header
+  }
   sprintf(buffer_string.get(),fieldFmt.c_str(),v);
   printField(name,buffer_string.get());
   return *this;
 }
 
 OFile& OFile::printField(const std::string&name,int v) {
+// in a binary file integer fields are stored as doubles,
+// so that all the records have the same fixed-width layout
+  if(binaryFields_) return printField(name,double(v));
   sprintf(buffer_string.get()," %d",v);
   printField(name,buffer_string.get());
   return *this;
@@ -183,10 +403,10 @@ OFile& OFile::printField(const std::string&name,const std::string & v) {
   unsigned i;
   for(i=0; i<const_fields.size(); i++) if(const_fields[i].name==name) break;
   if(i>=const_fields.size()) {
-    Field field;
-    field.name=name;
-    field.value=v;
-    fields.push_back(field);
+    if(binaryFields_) plumed_merror("file " + getPath() + ": only constant fields can hold strings in a binary fields file");
+    Field& field=nextField();
+    field.name.assign(name);
+    field.value.assign(v);
   } else {
     if(const_fields[i].value!=v) fieldChanged=true;
     const_fields[i].value=v;
@@ -205,18 +425,54 @@ OFile& OFile::setupPrintValue( Value *val ) {
 OFile& OFile::printField( Value* val, const double& v ) {
   printField( val->getName(), v );
   if( val->isPeriodic() ) {
-    std::string min, max; val->getDomain( min, max );
-    printField( "min_" + val->getName(), min );
-    printField("max_" + val->getName(), max );
+// member scratch strings are used so that printing a periodic value
+// at every step does not allocate
+    val->getDomain( tmp_min, tmp_max );
+    tmp_name.assign("min_"); tmp_name.append(val->getName());
+    printField( tmp_name, tmp_min );
+    tmp_name.assign("max_"); tmp_name.append(val->getName());
+    printField( tmp_name, tmp_max );
   }
   return *this;
 }
 
 OFile& OFile::printField() {
+  if(binaryFields_) {
+    if(!binaryHeaderWritten_) {
+      std::string header;
+      header.append(binary_fields_magic,8);
+      appendBinaryInt(header,binary_fields_version);
+      appendBinaryInt(header,nfields);
+      for(unsigned i=0; i<nfields; i++) appendBinaryString(header,fields[i].name);
+      appendBinaryInt(header,const_fields.size());
+      for(unsigned i=0; i<const_fields.size(); i++) {
+        appendBinaryString(header,const_fields[i].name);
+        appendBinaryString(header,const_fields[i].value);
+      }
+      llwrite(header.c_str(),header.length());
+      binaryHeaderWritten_=true;
+    } else {
+      bool changed=(fieldChanged || nfields!=nprevious_fields);
+      if(!changed) for(unsigned i=0; i<nfields; i++) {
+          if(previous_fields[i].name!=fields[i].name) { changed=true; break; }
+        }
+      if(changed) plumed_merror("file " + getPath() + ": the fields of a binary fields file cannot change");
+    }
+    binary_record.resize(nfields);
+    for(unsigned i=0; i<nfields; i++) binary_record[i]=fields[i].dvalue;
+    if(nfields>0) llwrite(reinterpret_cast<const char*>(&binary_record[0]),nfields*sizeof(double));
+// swap rather than copy, so that the recycled entries keep their string
+// capacity and building the next line does not allocate
+    fields.swap(previous_fields);
+    nprevious_fields=nfields;
+    nfields=0;
+    fieldChanged=false;
+    return *this;
+  }
   bool reprint=false;
-  if(fieldChanged || fields.size()!=previous_fields.size()) {
+  if(fieldChanged || nfields!=nprevious_fields) {
     reprint=true;
-  } else for(unsigned i=0; i<fields.size(); i++) {
+  } else for(unsigned i=0; i<nfields; i++) {
       if( previous_fields[i].name!=fields[i].name ||
           (fields[i].constant && fields[i].value!=previous_fields[i].value) ) {
         reprint=true;
@@ -225,17 +481,20 @@ OFile& OFile::printField() {
     }
   if(reprint) {
     printf("#! FIELDS");
-    for(unsigned i=0; i<fields.size(); i++) printf(" %s",fields[i].name.c_str());
+    for(unsigned i=0; i<nfields; i++) printf(" %s",fields[i].name.c_str());
     printf("\n");
     for(unsigned i=0; i<const_fields.size(); i++) {
       printf("#! SET %s %s",const_fields[i].name.c_str(),const_fields[i].value.c_str());
       printf("\n");
     }
   }
-  for(unsigned i=0; i<fields.size(); i++) printf("%s",fields[i].value.c_str());
+  for(unsigned i=0; i<nfields; i++) printf("%s",fields[i].value.c_str());
   printf("\n");
-  previous_fields=fields;
-  fields.clear();
+// swap rather than copy, so that the recycled entries keep their string
+// capacity and building the next line does not allocate
+  fields.swap(previous_fields);
+  nprevious_fields=nfields;
+  nfields=0;
   fieldChanged=false;
   return *this;
 }
@@ -293,6 +552,34 @@ OFile& OFile::open(const std::string&path) {
   err=false;
   fp=NULL;
   gzfp=NULL;
+#ifdef __PLUMED_HAS_MPI
+// Optionally write one file shared between all the replicas instead of one
+// file per replica.  This is only done for the replica's own standard files:
+// a file with an enforced suffix (e.g. one written on behalf of another
+// replica) keeps its own name and file
+  if(std::getenv("PLUMED_MPIIO") && plumed && plumed->multi_sim_comm.Get_size()>1
+      && getSuffix()==plumed->getSuffix() && Tools::extension(path)!="gz") {
+    this->path=path;
+    if(checkRestart()) {
+      mode="a";
+    } else {
+      mode="w";
+      if(!comm || comm->Get_rank()==0) {
+        if(plumed->multi_sim_comm.Get_rank()==0) backupFile( backstring, this->path );
+        plumed->multi_sim_comm.Barrier();
+      }
+    }
+    if(comm) comm->Barrier();
+    // The file is opened collectively, but only the first rank of each
+    // replica takes part: it is also the only one that writes in llwrite
+    if(!comm || comm->Get_rank()==0) {
+      sharedFile_.reset(new SharedFile( plumed->multi_sim_comm.Get_comm(), this->path,
+                                        plumed->multi_sim_comm.Get_rank(), mode=="a" ));
+    }
+    plumed->insertFile(*this);
+    return *this;
+  }
+#endif
   this->path=path;
   this->path=appendSuffix(path,getSuffix());
   if(checkRestart()) {
@@ -318,16 +605,29 @@ OFile& OFile::open(const std::string&path) {
 #endif
     }
   }
+  if(fp && !gzfp && std::getenv("PLUMED_ASYNC_IO")) asyncWriter_.reset(new AsyncWriter(fp));
   if(plumed) plumed->insertFile(*this);
   return *this;
 }
 
+void OFile::close() {
+// wait for the background writer before the handle is closed
+  asyncWriter_.reset();
+// flushes the remaining lines and closes the MPI-IO handle
+  sharedFile_.reset();
+  FileBase::close();
+}
+
 OFile& OFile::rewind() {
 // we use here "hard" rewind, which means close/reopen
 // the reason is that normal rewind does not work when in append mode
 // moreover, we can take a backup of the file
+  plumed_massert(!sharedFile_,"rewinding is not possible when writing to an MPI shared file");
   plumed_assert(fp);
   clearFields();
+// the background writer may still hold buffers referring to the old handle:
+// they have to land before the file is closed
+  if(asyncWriter_) asyncWriter_->barrier();
   if(gzfp) {
 #ifdef __PLUMED_HAS_ZLIB
     gzclose((gzFile)gzfp);
@@ -350,11 +650,22 @@ OFile& OFile::rewind() {
 #ifdef __PLUMED_HAS_ZLIB
     gzfp=(void*)gzopen(const_cast<char*>(this->path.c_str()),"w9");
 #endif
-  } else fp=std::fopen(const_cast<char*>(path.c_str()),"w");
+  } else {
+    fp=std::fopen(const_cast<char*>(path.c_str()),"w");
+    if(asyncWriter_) asyncWriter_->resetHandle(fp);
+  }
   return *this;
 }
 
 FileBase& OFile::flush() {
+#ifdef __PLUMED_HAS_MPI
+// complete lines gathered so far are handed to MPI-IO; heavy flushing
+// makes no sense for a shared file
+  if(sharedFile_) { sharedFile_->flush(); return *this; }
+#endif
+// flushing is a barrier for the background writer:
+// everything queued so far is handed to the operating system first
+  if(asyncWriter_) asyncWriter_->barrier();
   if(heavyFlush) {
     if(gzfp) {
 #ifdef __PLUMED_HAS_ZLIB
@@ -364,6 +675,7 @@ FileBase& OFile::flush() {
     } else {
       fclose(fp);
       fp=std::fopen(const_cast<char*>(path.c_str()),"a");
+      if(asyncWriter_) asyncWriter_->resetHandle(fp);
     }
   } else {
     FileBase::flush();
@@ -163,9 +163,34 @@ class OFile:
 /// Class identifying a single field for fielded output
   class Field:
     public FieldBase {
+  public:
+/// Raw value, used instead of the formatted one in binary fields mode
+    double dvalue;
+    Field(): dvalue(0.0) {}
   };
 /// Low-level write
   size_t llwrite(const char*,size_t);
+/// Helper running the background flush thread, see \ref asyncwriter
+  class AsyncWriter;
+/// Hands formatted output to a background flush thread. Only allocated
+/// when the PLUMED_ASYNC_IO environment variable is set and the file is
+/// a plain (non gzipped, non linked) one
+  std::unique_ptr<AsyncWriter> asyncWriter_;
+/// Helper writing to a single file shared between all the replicas with
+/// MPI-IO, see \ref open
+  class SharedFile;
+/// When allocated the output goes to one file shared between all the
+/// replicas instead of one file per replica, with every line tagged with
+/// the index of the replica that produced it (e.g. "R3 ").  Allocated in
+/// open() when the PLUMED_MPIIO environment variable is set in a
+/// multi-replica run, so that large jobs do not create and flush one
+/// small file per replica
+  std::unique_ptr<SharedFile> sharedFile_;
+/// True if the fields are written in the typed binary columnar format
+/// rather than as formatted text, see setBinaryFields()
+  bool binaryFields_;
+/// True once the schema header of a binary fields file has been written
+  bool binaryHeaderWritten_;
 /// True if fields has changed.
 /// This could be due to a change in the list of fields or a reset
 /// of a nominally constant field
@@ -174,8 +199,22 @@ class OFile:
   std::string fieldFmt;
 /// All the previously defined variable fields
   std::vector<Field> previous_fields;
-/// All the defined variable fields
+/// All the defined variable fields.
+/// The vector is never shrunk between lines: entries are recycled through
+/// nextField(), so that their strings keep their capacity and building a
+/// line at steady state does not touch the heap
   std::vector<Field> fields;
+/// Number of entries of fields used for the line being built
+  unsigned nfields;
+/// Number of entries of previous_fields used for the last line
+  unsigned nprevious_fields;
+/// Scratch record reused when writing binary fields
+  std::vector<double> binary_record;
+/// Scratch strings used to build the min_/max_ field names and the domain
+/// of periodic values without allocating at every step
+  std::string tmp_name;
+  std::string tmp_min;
+  std::string tmp_max;
 /// All the defined constant fields
   std::vector<Field> const_fields;
 /// Prefix for line (e.g. "PLUMED: ")
@@ -186,6 +225,8 @@ class OFile:
   std::string backstring;
 /// Find field index given name
   unsigned findField(const std::string&name)const;
+/// Return the next recycled entry of fields
+  Field& nextField();
 /// check if we are restarting
   bool checkRestart()const;
 /// True if restart behavior should be forced
@@ -195,6 +236,8 @@ class OFile:
 public:
 /// Constructor
   OFile();
+/// Destructor. Defined where AsyncWriter is complete
+  ~OFile();
 /// Allows overloading of link
   using FileBase::link;
 /// Allows overloading of open
@@ -216,10 +259,18 @@ public:
   void backupAllFiles( const std::string& str );
 /// Opens the file using automatic append/backup
   OFile& open(const std::string&name) override;
+/// Closes the file, waiting for the background flush thread if needed
+  void close() override;
 /// Set the prefix for output.
 /// Typically "PLUMED: ". Notice that lines with a prefix cannot
 /// be parsed using fields in a IFile.
   OFile& setLinePrefix(const std::string&);
+/// Switch to the typed binary columnar format: the file starts with a
+/// magic marker and the field schema, followed by one fixed-width record
+/// of doubles per printField() line. Such files are transparently
+/// detected and parsed back by IFile. Must be called before the first
+/// printField()
+  OFile& setBinaryFields();
 /// Set the format for writing double precision fields
   OFile& fmtField(const std::string&);
 /// Reset the format for writing double precision fields to its default
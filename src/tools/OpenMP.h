@@ -39,6 +39,10 @@ public:
 /// Returns a unique thread identification number within the current team
   static unsigned getThreadNum();
 
+/// Returns the number of threads in the current team, which can be smaller
+/// than the number requested when the team was spawned
+  static unsigned getTeamSize();
+
 /// get cacheline size
   static unsigned getCachelineSize();
 
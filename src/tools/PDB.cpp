@@ -24,7 +24,12 @@
 #include "Log.h"
 #include "h36.h"
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "core/GenericMolInfo.h"
 #include "Tensor.h"
 
@@ -127,6 +132,79 @@ In addition, as of PLUMED 2.5, we provide a \ref pdbrenumber "command line tool"
 
 namespace PLMD {
 
+namespace {
+
+// Helpers used to read and write the binary sidecar files produced when
+// PDB::read is called with use_cache=true. The sidecar is machine local,
+// so fields are stored in native endianness with fixed width types.
+
+const char pdbcache_magic[8]= {'P','L','M','D','P','D','B','C'};
+const int32_t pdbcache_version=1;
+
+template<typename T>
+bool cacheRead(FILE* fp,T* data,std::size_t n) {
+  return std::fread(data,sizeof(T),n,fp)==n;
+}
+
+template<typename T>
+bool cacheWrite(FILE* fp,const T* data,std::size_t n) {
+  return std::fwrite(data,sizeof(T),n,fp)==n;
+}
+
+bool cacheReadString(FILE* fp,std::string & str) {
+  uint32_t len;
+  if(!cacheRead(fp,&len,1)) return false;
+  std::vector<char> buffer(len);
+  if(len>0 && !cacheRead(fp,buffer.data(),len)) return false;
+  str.assign(buffer.begin(),buffer.end());
+  return true;
+}
+
+bool cacheWriteString(FILE* fp,const std::string & str) {
+  uint32_t len=str.length();
+  if(!cacheWrite(fp,&len,1)) return false;
+  return len==0 || cacheWrite(fp,str.c_str(),len);
+}
+
+// String columns are dictionary encoded: a pdb file contains only a
+// handful of distinct atom, residue and chain names, so each column is
+// stored as a small table of unique strings plus one code per atom.
+
+bool cacheReadStringColumn(FILE* fp,std::size_t n,std::vector<std::string> & col) {
+  uint32_t ntable;
+  if(!cacheRead(fp,&ntable,1)) return false;
+  std::vector<std::string> table(ntable);
+  for(auto & s : table) if(!cacheReadString(fp,s)) return false;
+  std::vector<uint32_t> codes(n);
+  if(n>0 && !cacheRead(fp,codes.data(),n)) return false;
+  col.resize(n);
+  for(std::size_t i=0; i<n; i++) {
+    if(codes[i]>=ntable) return false;
+    col[i]=table[codes[i]];
+  }
+  return true;
+}
+
+bool cacheWriteStringColumn(FILE* fp,const std::vector<std::string> & col) {
+  std::map<std::string,uint32_t> index;
+  std::vector<std::string> table;
+  std::vector<uint32_t> codes(col.size());
+  for(std::size_t i=0; i<col.size(); i++) {
+    auto p=index.find(col[i]);
+    if(p==index.end()) {
+      p=index.insert(std::pair<std::string,uint32_t>(col[i],table.size())).first;
+      table.push_back(col[i]);
+    }
+    codes[i]=p->second;
+  }
+  uint32_t ntable=table.size();
+  if(!cacheWrite(fp,&ntable,1)) return false;
+  for(const auto & s : table) if(!cacheWriteString(fp,s)) return false;
+  return col.empty() || cacheWrite(fp,codes.data(),codes.size());
+}
+
+}
+
 void PDB::setAtomNumbers( const std::vector<AtomNumber>& atoms ) {
   positions.resize( atoms.size() ); occupancy.resize( atoms.size() );
   beta.resize( atoms.size() ); numbers.resize( atoms.size() );
@@ -282,6 +360,7 @@ bool PDB::readFromFilepointer(FILE *fp,bool naturalUnits,double scale) {
   //cerr<<file<<endl;
   bool file_is_alive=false;
   if(naturalUnits) scale=1.0;
+  residue2atoms.clear();
   string line;
   fpos_t pos; bool between_ters=true;
   while(Tools::getline(fp,line)) {
@@ -376,14 +455,157 @@ bool PDB::readFromFilepointer(FILE *fp,bool naturalUnits,double scale) {
   return file_is_alive;
 }
 
-bool PDB::read(const std::string&file,bool naturalUnits,double scale) {
+bool PDB::read(const std::string&file,bool naturalUnits,double scale,bool use_cache) {
+  if(naturalUnits) scale=1.0;
+  if(use_cache && readFromBinaryCache(file,scale)) return true;
   FILE* fp=fopen(file.c_str(),"r");
   if(!fp) return false;
   readFromFilepointer(fp,naturalUnits,scale);
   fclose(fp);
+  if(use_cache) writeBinaryCache(file,scale);
+  return true;
+}
+
+bool PDB::readFromBinaryCache(const std::string&file,double scale) {
+  struct stat st;
+  if(stat(file.c_str(),&st)!=0) return false;
+  FILE* fp=std::fopen((file+".pcache").c_str(),"r");
+  if(!fp) return false;
+  auto deleter=[](FILE* f) { std::fclose(f); };
+  std::unique_ptr<FILE,decltype(deleter)> fp_deleter(fp,deleter);
+  // Everything is read and validated into local variables before the
+  // object is touched, so that a stale, truncated or corrupted sidecar
+  // is simply ignored and the pdb file is parsed from scratch.
+  char magic[8]; int32_t version;
+  uint64_t pdbsize; int64_t pdbmtime; double stored_scale; uint64_t natoms;
+  if(!cacheRead(fp,magic,8) || std::memcmp(magic,pdbcache_magic,8)!=0) return false;
+  if(!cacheRead(fp,&version,1) || version!=pdbcache_version) return false;
+  if(!cacheRead(fp,&pdbsize,1) || pdbsize!=static_cast<uint64_t>(st.st_size)) return false;
+  if(!cacheRead(fp,&pdbmtime,1) || pdbmtime!=static_cast<int64_t>(st.st_mtime)) return false;
+  if(!cacheRead(fp,&stored_scale,1) || !(stored_scale>0.0)) return false;
+  if(!cacheRead(fp,&natoms,1)) return false;
+  std::vector<int64_t> serials(natoms);
+  std::vector<uint32_t> resnos(natoms);
+  std::vector<double> coords(3*natoms);
+  std::vector<double> occ(natoms),bet(natoms);
+  if(natoms>0) {
+    if(!cacheRead(fp,serials.data(),natoms)) return false;
+    if(!cacheRead(fp,resnos.data(),natoms)) return false;
+    if(!cacheRead(fp,coords.data(),3*natoms)) return false;
+    if(!cacheRead(fp,occ.data(),natoms)) return false;
+    if(!cacheRead(fp,bet.data(),natoms)) return false;
+  }
+  std::vector<std::string> asym,resnam,chains;
+  if(!cacheReadStringColumn(fp,natoms,asym)) return false;
+  if(!cacheReadStringColumn(fp,natoms,resnam)) return false;
+  if(!cacheReadStringColumn(fp,natoms,chains)) return false;
+  uint64_t nblocks;
+  if(!cacheRead(fp,&nblocks,1)) return false;
+  std::vector<uint32_t> blocks(nblocks);
+  if(nblocks>0 && !cacheRead(fp,blocks.data(),nblocks)) return false;
+  double boxdata[15];
+  if(!cacheRead(fp,boxdata,15)) return false;
+  std::string cmtype;
+  if(!cacheReadString(fp,cmtype)) return false;
+  uint64_t nargs,nflags,ndata;
+  std::vector<std::string> cargnames,cflags;
+  if(!cacheRead(fp,&nargs,1)) return false;
+  cargnames.resize(nargs);
+  for(auto & s : cargnames) if(!cacheReadString(fp,s)) return false;
+  if(!cacheRead(fp,&nflags,1)) return false;
+  cflags.resize(nflags);
+  for(auto & s : cflags) if(!cacheReadString(fp,s)) return false;
+  if(!cacheRead(fp,&ndata,1)) return false;
+  std::map<std::string,double> cargdata;
+  for(uint64_t i=0; i<ndata; i++) {
+    std::string name; double value;
+    if(!cacheReadString(fp,name) || !cacheRead(fp,&value,1)) return false;
+    cargdata.insert(std::pair<std::string,double>(name,value));
+  }
+  // commit to the object, rescaling if the sidecar was written with
+  // different length units
+  const double factor=scale/stored_scale;
+  numbers.resize(natoms); number2index.clear();
+  positions.resize(natoms); residue.resize(natoms);
+  for(uint64_t i=0; i<natoms; i++) {
+    numbers[i].setSerial(serials[i]);
+    number2index[numbers[i]]=i;
+    residue[i]=resnos[i];
+    for(unsigned j=0; j<3; j++) positions[i][j]=factor*coords[3*i+j];
+  }
+  occupancy=occ; beta=bet;
+  atomsymb=asym; residuenames=resnam; chain=chains;
+  block_ends.assign(blocks.begin(),blocks.end());
+  for(unsigned j=0; j<3; j++) BoxXYZ[j]=factor*boxdata[j];
+  for(unsigned j=0; j<3; j++) BoxABG[j]=boxdata[3+j];
+  for(unsigned j=0; j<3; j++) for(unsigned k=0; k<3; k++) Box[j][k]=factor*boxdata[6+3*j+k];
+  mtype=cmtype; argnames=cargnames; flags=cflags; arg_data=cargdata;
+  residue2atoms.clear();
   return true;
 }
 
+void PDB::writeBinaryCache(const std::string&file,double scale) const {
+  struct stat st;
+  if(stat(file.c_str(),&st)!=0) return;
+  const std::string cachename=file+".pcache";
+  // write to a per-process temporary name and rename it in place, so that
+  // concurrent readers of the same pdb never see a partial sidecar
+  std::string spid; Tools::convert(static_cast<int>(getpid()),spid);
+  const std::string tmpname=cachename+".tmp."+spid;
+  FILE* fp=std::fopen(tmpname.c_str(),"w");
+  if(!fp) return;
+  const uint64_t pdbsize=st.st_size;
+  const int64_t pdbmtime=st.st_mtime;
+  const uint64_t natoms=size();
+  std::vector<int64_t> serials(natoms);
+  std::vector<uint32_t> resnos(natoms);
+  std::vector<double> coords(3*natoms);
+  for(uint64_t i=0; i<natoms; i++) {
+    serials[i]=numbers[i].serial();
+    resnos[i]=residue[i];
+    for(unsigned j=0; j<3; j++) coords[3*i+j]=positions[i][j];
+  }
+  double boxdata[15];
+  for(unsigned j=0; j<3; j++) boxdata[j]=BoxXYZ[j];
+  for(unsigned j=0; j<3; j++) boxdata[3+j]=BoxABG[j];
+  for(unsigned j=0; j<3; j++) for(unsigned k=0; k<3; k++) boxdata[6+3*j+k]=Box[j][k];
+  const uint64_t nblocks=block_ends.size();
+  std::vector<uint32_t> blocks(block_ends.begin(),block_ends.end());
+  const uint64_t nargs=argnames.size();
+  const uint64_t nflags=flags.size();
+  const uint64_t ndata=arg_data.size();
+  bool ok=cacheWrite(fp,pdbcache_magic,8) &&
+          cacheWrite(fp,&pdbcache_version,1) &&
+          cacheWrite(fp,&pdbsize,1) &&
+          cacheWrite(fp,&pdbmtime,1) &&
+          cacheWrite(fp,&scale,1) &&
+          cacheWrite(fp,&natoms,1);
+  if(ok && natoms>0) {
+    ok=cacheWrite(fp,serials.data(),natoms) &&
+       cacheWrite(fp,resnos.data(),natoms) &&
+       cacheWrite(fp,coords.data(),3*natoms) &&
+       cacheWrite(fp,occupancy.data(),natoms) &&
+       cacheWrite(fp,beta.data(),natoms);
+  }
+  ok=ok && cacheWriteStringColumn(fp,atomsymb) &&
+     cacheWriteStringColumn(fp,residuenames) &&
+     cacheWriteStringColumn(fp,chain) &&
+     cacheWrite(fp,&nblocks,1) &&
+     (nblocks==0 || cacheWrite(fp,blocks.data(),nblocks)) &&
+     cacheWrite(fp,boxdata,15) &&
+     cacheWriteString(fp,mtype) &&
+     cacheWrite(fp,&nargs,1);
+  if(ok) for(const auto & s : argnames) if(!(ok=cacheWriteString(fp,s))) break;
+  ok=ok && cacheWrite(fp,&nflags,1);
+  if(ok) for(const auto & s : flags) if(!(ok=cacheWriteString(fp,s))) break;
+  ok=ok && cacheWrite(fp,&ndata,1);
+  if(ok) for(const auto & p : arg_data) {
+      if(!(ok=cacheWriteString(fp,p.first) && cacheWrite(fp,&p.second,1))) break;
+    }
+  std::fclose(fp);
+  if(!ok || std::rename(tmpname.c_str(),cachename.c_str())!=0) std::remove(tmpname.c_str());
+}
+
 void PDB::getChainNames( std::vector<std::string>& chains ) const {
   chains.resize(0);
   chains.push_back( chain[0] );
@@ -426,18 +648,27 @@ void PDB::getAtomRange( const std::string& chainname, AtomNumber& a_start, AtomN
   if(inres) a_end=numbers[size()-1];
 }
 
+void PDB::buildResidueIndex() const {
+  residue2atoms.clear();
+  for(unsigned i=0; i<size(); ++i) residue2atoms[residue[i]].push_back(i);
+}
+
 std::string PDB::getResidueName( const unsigned& resnum ) const {
-  for(unsigned i=0; i<size(); ++i) {
-    if( residue[i]==resnum ) return residuenames[i];
-  }
+  if(residue2atoms.empty()) buildResidueIndex();
+  const auto p=residue2atoms.find(resnum);
+  if( p!=residue2atoms.end() ) return residuenames[p->second[0]];
   std::string num; Tools::convert( resnum, num );
   plumed_merror("residue " + num + " not found" );
   return "";
 }
 
 std::string PDB::getResidueName(const unsigned& resnum,const std::string& chainid ) const {
-  for(unsigned i=0; i<size(); ++i) {
-    if( residue[i]==resnum && ( chainid=="*" || chain[i]==chainid) ) return residuenames[i];
+  if(residue2atoms.empty()) buildResidueIndex();
+  const auto p=residue2atoms.find(resnum);
+  if( p!=residue2atoms.end() ) {
+    for(unsigned i : p->second) {
+      if( chainid=="*" || chain[i]==chainid ) return residuenames[i];
+    }
   }
   std::string num; Tools::convert( resnum, num );
   plumed_merror("residue " + num + " not found in chain " + chainid );
@@ -446,8 +677,12 @@ std::string PDB::getResidueName(const unsigned& resnum,const std::string& chaini
 
 
 AtomNumber PDB::getNamedAtomFromResidue( const std::string& aname, const unsigned& resnum ) const {
-  for(unsigned i=0; i<size(); ++i) {
-    if( residue[i]==resnum && atomsymb[i]==aname ) return numbers[i];
+  if(residue2atoms.empty()) buildResidueIndex();
+  const auto p=residue2atoms.find(resnum);
+  if( p!=residue2atoms.end() ) {
+    for(unsigned i : p->second) {
+      if( atomsymb[i]==aname ) return numbers[i];
+    }
   }
   std::string num; Tools::convert( resnum, num );
   plumed_merror("residue " + num + " does not contain an atom named " + aname );
@@ -455,8 +690,12 @@ AtomNumber PDB::getNamedAtomFromResidue( const std::string& aname, const unsigne
 }
 
 AtomNumber PDB::getNamedAtomFromResidueAndChain( const std::string& aname, const unsigned& resnum, const std::string& chainid ) const {
-  for(unsigned i=0; i<size(); ++i) {
-    if( residue[i]==resnum && atomsymb[i]==aname && ( chainid=="*" || chain[i]==chainid) ) return numbers[i];
+  if(residue2atoms.empty()) buildResidueIndex();
+  const auto p=residue2atoms.find(resnum);
+  if( p!=residue2atoms.end() ) {
+    for(unsigned i : p->second) {
+      if( atomsymb[i]==aname && ( chainid=="*" || chain[i]==chainid) ) return numbers[i];
+    }
   }
   std::string num; Tools::convert( resnum, num );
   plumed_merror("residue " + num + " from chain " + chainid + " does not contain an atom named " + aname );
@@ -464,9 +703,13 @@ AtomNumber PDB::getNamedAtomFromResidueAndChain( const std::string& aname, const
 }
 
 std::vector<AtomNumber> PDB::getAtomsInResidue(const unsigned& resnum,const std::string& chainid)const {
+  if(residue2atoms.empty()) buildResidueIndex();
   std::vector<AtomNumber> tmp;
-  for(unsigned i=0; i<size(); ++i) {
-    if( residue[i]==resnum && ( chainid=="*" || chain[i]==chainid) ) tmp.push_back(numbers[i]);
+  const auto p=residue2atoms.find(resnum);
+  if( p!=residue2atoms.end() ) {
+    for(unsigned i : p->second) {
+      if( chainid=="*" || chain[i]==chainid ) tmp.push_back(numbers[i]);
+    }
   }
   if(tmp.size()==0) {
     std::string num; Tools::convert( resnum, num );
@@ -487,9 +730,9 @@ std::vector<AtomNumber> PDB::getAtomsInChain(const std::string& chainid)const {
 }
 
 std::string PDB::getChainID(const unsigned& resnumber) const {
-  for(unsigned i=0; i<size(); ++i) {
-    if(resnumber==residue[i]) return chain[i];
-  }
+  if(residue2atoms.empty()) buildResidueIndex();
+  const auto p=residue2atoms.find(resnumber);
+  if( p!=residue2atoms.end() ) return chain[p->second[0]];
   plumed_merror("Not enough residues in pdb input file");
 }
 
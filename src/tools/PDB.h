@@ -55,9 +55,23 @@ class PDB {
   std::map<std::string,double> arg_data;
   Vector BoxXYZ,BoxABG;
   Tensor Box;
+/// Lazily built index from residue number to the atoms of that residue,
+/// in file order. It avoids a scan over all the atoms on every residue query.
+  mutable std::map<unsigned,std::vector<unsigned> > residue2atoms;
+/// Build the residue2atoms index
+  void buildResidueIndex() const;
+/// Read all the fields from an indexed binary sidecar file, see read()
+  bool readFromBinaryCache(const std::string&file,double scale);
+/// Write all the fields to an indexed binary sidecar file, see read()
+  void writeBinaryCache(const std::string&file,double scale) const;
 public:
-/// Read the pdb from a file, scaling positions by a factor scale
-  bool read(const std::string&file,bool naturalUnits,double scale);
+/// Read the pdb from a file, scaling positions by a factor scale.
+/// When use_cache is true, a binary sidecar file named file.pcache is
+/// written on the first parse and loaded on subsequent reads, which is
+/// much faster than parsing the pdb line by line for large structures.
+/// The sidecar is keyed on the size and modification time of the pdb
+/// file, so that an outdated sidecar is transparently re-generated.
+  bool read(const std::string&file,bool naturalUnits,double scale,bool use_cache=false);
 /// Read from a file pointer
   bool readFromFilepointer(FILE *fp,bool naturalUnits,double scale);
 /// Access to the position array
@@ -23,19 +23,82 @@
 #include "Tools.h"
 #include "Exception.h"
 #include "LatticeReduction.h"
+#include "TargetClones.h"
 #include <iostream>
 #include "Random.h"
 #include <cmath>
 
 namespace PLMD {
 
+namespace {
+/// Wrap a list of vectors into the orthorhombic cell. Kept as a free
+/// function so that it can be multi-versioned for the available vector
+/// units (see TargetClones.h)
+PLUMED_TARGET_CLONES
+void applyOrthorombic( Vector* dlist, unsigned n, const Tensor& box, const Tensor& invBox ) {
+  for(unsigned k=0; k<n; ++k) for(int i=0; i<3; i++) dlist[k][i]=Tools::pbc(dlist[k][i]*invBox(i,i))*box(i,i);
+}
+
+/// Same as above for coordinates packed into separate x/y/z arrays
+PLUMED_TARGET_CLONES
+void applyOrthorombicPacked( double* dx, double* dy, double* dz, unsigned n, const Tensor& box, const Tensor& invBox ) {
+  const double bx=box(0,0), by=box(1,1), bz=box(2,2);
+  const double ix=invBox(0,0), iy=invBox(1,1), iz=invBox(2,2);
+  for(unsigned k=0; k<n; ++k) dx[k]=Tools::pbc(dx[k]*ix)*bx;
+  for(unsigned k=0; k<n; ++k) dy[k]=Tools::pbc(dy[k]*iy)*by;
+  for(unsigned k=0; k<n; ++k) dz[k]=Tools::pbc(dz[k]*iz)*bz;
+}
+}
+
 Pbc::Pbc():
-  type(unset)
+  type(unset),
+  mindist_fn(&Pbc::mindistUnset)
 {
   box.zero();
   invBox.zero();
 }
 
+Vector Pbc::mindistUnset(Vector d) const {
+  return d;
+}
+
+Vector Pbc::mindistOrthorombic(Vector d) const {
+#ifdef __PLUMED_PBC_WHILE
+  for(unsigned i=0; i<3; i++) {
+    while(d[i]>hdiag[i]) d[i]-=diag[i];
+    while(d[i]<=mdiag[i]) d[i]+=diag[i];
+  }
+#else
+  for(int i=0; i<3; i++) d[i]=Tools::pbc(d[i]*invBox(i,i))*box(i,i);
+#endif
+  return d;
+}
+
+Vector Pbc::mindistGeneric(Vector d) const {
+  Vector s=matmul(d,invReduced);
+// bring to -0.5,+0.5 region in scaled coordinates:
+  for(int i=0; i<3; i++) s[i]=Tools::pbc(s[i]);
+  d=matmul(s,reduced);
+// check if shifts have to be attempted:
+  if((std::fabs(s[0])+std::fabs(s[1])+std::fabs(s[2])>0.5)) {
+// list of shifts is specific for that "octant" (depends on signs of s[i]):
+    const std::vector<Vector> & myshifts(shifts[(s[0]>0?1:0)][(s[1]>0?1:0)][(s[2]>0?1:0)]);
+    Vector best(d);
+    double lbest(modulo2(best));
+// loop over possible shifts:
+    for(unsigned i=0; i<myshifts.size(); i++) {
+      Vector trial=d+myshifts[i];
+      double ltrial=modulo2(trial);
+      if(ltrial<lbest) {
+        lbest=ltrial;
+        best=trial;
+      }
+    }
+    d=best;
+  }
+  return d;
+}
+
 void Pbc::buildShifts(std::vector<Vector> shifts[2][2][2])const {
   const double small=1e-28;
 
@@ -118,6 +181,7 @@ void Pbc::setBox(const Tensor&b) {
   const double epsilon=1e-28;
 
   type=unset;
+  mindist_fn=&Pbc::mindistUnset;
   double det=box.determinant();
   if(det*det<epsilon) return;
 
@@ -133,6 +197,10 @@ void Pbc::setBox(const Tensor&b) {
   if(cxy && cxz && cyz) type=orthorombic;
   else type=generic;
 
+// install the specialized minimum-image routine for this box
+  if(type==orthorombic) mindist_fn=&Pbc::mindistOrthorombic;
+  else mindist_fn=&Pbc::mindistGeneric;
+
   if(type==orthorombic) {
     reduced=box;
     invReduced=inverse(reduced);
@@ -170,13 +238,26 @@ void Pbc::apply(std::vector<Vector>& dlist, unsigned max_index) const {
       while(dlist[k][2]<=mdiag[2])  dlist[k][2]+=diag[2];
     }
 #else
-    for(unsigned k=0; k<max_index; ++k) for(int i=0; i<3; i++) dlist[k][i]=Tools::pbc(dlist[k][i]*invBox(i,i))*box(i,i);
+    applyOrthorombic( dlist.data(), max_index, box, invBox );
 #endif
   } else if(type==generic) {
     for(unsigned k=0; k<max_index; ++k) dlist[k]=distance(Vector(0.0,0.0,0.0),dlist[k]);
   } else plumed_merror("unknown pbc type");
 }
 
+void Pbc::apply(double* dx, double* dy, double* dz, unsigned n) const {
+  if(type==unset) {
+    // do nothing
+  } else if(type==orthorombic) {
+    applyOrthorombicPacked( dx, dy, dz, n, box, invBox );
+  } else if(type==generic) {
+    for(unsigned k=0; k<n; ++k) {
+      Vector d=distance(Vector(0.0,0.0,0.0),Vector(dx[k],dy[k],dz[k]));
+      dx[k]=d[0]; dy[k]=d[1]; dz[k]=d[2];
+    }
+  } else plumed_merror("unknown pbc type");
+}
+
 Vector Pbc::distance(const Vector&v1,const Vector&v2,int*nshifts)const {
   Vector d=delta(v1,v2);
   if(type==unset) {
@@ -224,6 +305,13 @@ Vector Pbc::distance(const Vector&v1,const Vector&v2,int*nshifts)const {
   return d;
 }
 
+void Pbc::distance(const std::vector<Vector>& v1,const std::vector<Vector>& v2,std::vector<Vector>& d) const {
+  plumed_dbg_assert(v1.size()==v2.size());
+  d.resize(v1.size());
+  for(unsigned k=0; k<d.size(); ++k) d[k]=delta(v1[k],v2[k]);
+  apply(d);
+}
+
 Vector Pbc::realToScaled(const Vector&d)const {
   return matmul(invBox.transpose(),d);
 }
@@ -62,6 +62,14 @@ class Pbc {
 /// depending on the sign of the scaled coordinates representing
 /// a distance vector.
   void buildShifts(std::vector<Vector> shifts[2][2][2])const;
+/// Specialized minimum-image routine installed by setBox, so that
+/// distance() jumps straight to the right implementation without
+/// re-checking the box type at every call
+  Vector (Pbc::*mindist_fn)(Vector) const;
+/// The three specializations that mindist_fn can point to
+  Vector mindistUnset(Vector d) const;
+  Vector mindistOrthorombic(Vector d) const;
+  Vector mindistGeneric(Vector d) const;
 public:
 /// Constructor
   Pbc();
@@ -69,11 +77,19 @@ public:
   double distance( const bool pbc, const Vector& v1, const Vector& v2 ) const;
 /// Computes v2-v1, using minimal image convention
   Vector distance(const Vector& v1,const Vector& v2)const;
+/// Compute the minimum-image distances v2[k]-v1[k] for a whole block of
+/// pairs. The minimum image is applied with apply(), i.e. with a
+/// vectorizable loop for orthorombic boxes
+  void distance(const std::vector<Vector>& v1,const std::vector<Vector>& v2,std::vector<Vector>& d)const;
 /// version of distance which also returns the number
 /// of attempted shifts
   Vector distance(const Vector&,const Vector&,int*nshifts)const;
 /// Apply PBC to a set of positions or distance vectors
   void apply(std::vector<Vector>&dlist, unsigned max_index=0) const;
+/// Apply PBC to a block of distance vectors stored as separate x/y/z arrays.
+/// For orthorombic boxes this runs a vectorizable loop per component;
+/// for generic boxes it falls back to the minimal image search of distance()
+  void apply(double* dx, double* dy, double* dz, unsigned n) const;
 /// Set the lattice vectors.
 /// b[i][j] is the j-th component of the i-th vector
   void setBox(const Tensor&b);
@@ -99,7 +115,7 @@ public:
 
 inline
 Vector Pbc::distance(const Vector& v1,const Vector& v2)const {
-  return distance(v1,v2,NULL);
+  return (this->*mindist_fn)(delta(v1,v2));
 }
 
 inline
@@ -23,13 +23,60 @@
 #include "PDB.h"
 #include "Log.h"
 #include "Exception.h"
+#include "TargetClones.h"
 #include <cmath>
 #include <iostream>
 #include "Tools.h"
 using namespace std;
 namespace PLMD {
 
-RMSD::RMSD() : alignmentMethod(SIMPLE),reference_center_is_calculated(false),reference_center_is_removed(false),positions_center_is_calculated(false),positions_center_is_removed(false) {}
+RMSD::RMSD() : alignmentMethod(SIMPLE),packed_blocks(false),warm_start(false),warm_evecs_set(false),reference_center_is_calculated(false),reference_center_is_removed(false),positions_center_is_calculated(false),positions_center_is_removed(false) {}
+
+namespace {
+/// Accumulate the second moments of positions and reference with respect to
+/// their centers, operating on blocks of coordinates packed into contiguous
+/// x/y/z arrays. The eleven accumulators (rr00, rr11 and the nine entries of
+/// the correlation matrix) are independent and the weight is folded into a
+/// single factor per entry, so the inner loops vectorize well. This is
+/// numerically equivalent to the scalar per-atom loop but sums in a
+/// different (blocked) order.
+PLUMED_TARGET_CLONES
+void packedSecondMoments(const std::vector<double> & align,
+                         const std::vector<Vector> & positions, const Vector & cp,
+                         const std::vector<Vector> & reference, const Vector & cr,
+                         double & rr00, double & rr11, Tensor & rr01) {
+  const unsigned n=positions.size();
+  const unsigned blocksize=32;
+  double px[blocksize],py[blocksize],pz[blocksize];
+  double rx[blocksize],ry[blocksize],rz[blocksize];
+  double s00=0.0,s11=0.0;
+  double xx=0.0,xy=0.0,xz=0.0,yx=0.0,yy=0.0,yz=0.0,zx=0.0,zy=0.0,zz=0.0;
+  for(unsigned start=0; start<n; start+=blocksize) {
+    const unsigned len=std::min(blocksize,n-start);
+// pack the block into contiguous per-component arrays
+    for(unsigned k=0; k<len; k++) {
+      px[k]=positions[start+k][0]-cp[0];
+      py[k]=positions[start+k][1]-cp[1];
+      pz[k]=positions[start+k][2]-cp[2];
+      rx[k]=reference[start+k][0]-cr[0];
+      ry[k]=reference[start+k][1]-cr[1];
+      rz[k]=reference[start+k][2]-cr[2];
+    }
+    for(unsigned k=0; k<len; k++) {
+      const double w=align[start+k];
+      const double wx=w*px[k], wy=w*py[k], wz=w*pz[k];
+      s00+=wx*px[k]+wy*py[k]+wz*pz[k];
+      s11+=w*(rx[k]*rx[k]+ry[k]*ry[k]+rz[k]*rz[k]);
+      xx+=wx*rx[k]; xy+=wx*ry[k]; xz+=wx*rz[k];
+      yx+=wy*rx[k]; yy+=wy*ry[k]; yz+=wy*rz[k];
+      zx+=wz*rx[k]; zy+=wz*ry[k]; zz+=wz*rz[k];
+    }
+  }
+  rr00+=s00;
+  rr11+=s11;
+  rr01+=Tensor(xx,xy,xz,yx,yy,yz,zx,zy,zz);
+}
+}
 
 ///
 /// general method to set all the rmsd property at once by using a pdb where occupancy column sets the weights for the atoms involved in the
@@ -52,13 +99,22 @@ void RMSD::set(const std::vector<double> & align, const std::vector<double> & di
 void RMSD::setType(const string & mytype) {
 
   alignmentMethod=SIMPLE; // initialize with the simplest case: no rotation
-  if (mytype=="SIMPLE") {
+  packed_blocks=false;
+  std::string type=mytype;
+// the -PACKED suffix selects the block-packed correlation kernel and can be
+// combined with both the optimal alignments
+  if(type.length()>7 && type.compare(type.length()-7,7,"-PACKED")==0) {
+    packed_blocks=true;
+    type=type.substr(0,type.length()-7);
+  }
+  if (type=="SIMPLE") {
     alignmentMethod=SIMPLE;
+    if(packed_blocks) plumed_merror("PACKED is only available with OPTIMAL and OPTIMAL-FAST RMSD types");
   }
-  else if (mytype=="OPTIMAL") {
+  else if (type=="OPTIMAL") {
     alignmentMethod=OPTIMAL;
   }
-  else if (mytype=="OPTIMAL-FAST") {
+  else if (type=="OPTIMAL-FAST") {
     alignmentMethod=OPTIMAL_FAST;
   }
   else plumed_merror("unknown RMSD type" + mytype);
@@ -75,6 +131,12 @@ void RMSD::clear() {
   positions_center.zero();
   positions_center_is_calculated=false;
   positions_center_is_removed=false;
+  warm_evecs_set=false;
+}
+
+void RMSD::setWarmStart(bool ws) {
+  warm_start=ws;
+  warm_evecs_set=false;
 }
 
 string RMSD::getMethod() {
@@ -84,6 +146,7 @@ string RMSD::getMethod() {
   case OPTIMAL: mystring.assign("OPTIMAL"); break;
   case OPTIMAL_FAST: mystring.assign("OPTIMAL-FAST"); break;
   }
+  if(packed_blocks) mystring+="-PACKED";
   return mystring;
 }
 ///
@@ -192,6 +255,37 @@ double RMSD::calculate(const std::vector<Vector> & positions,std::vector<Vector>
 
 }
 
+double RMSD::calculate(const std::vector<Vector> & positions, const Vector & cpositions, std::vector<Vector> &derivatives, bool squared)const {
+
+  double ret=0.;
+
+  switch(alignmentMethod) {
+  case SIMPLE : {
+    // the precomputed center plays no role in the simple alignment
+    return calculate( positions, derivatives, squared );
+  } case OPTIMAL_FAST : {
+    if(align==displace) ret=optimalAlignment<false,true>(align,displace,positions,reference,cpositions,derivatives,squared);
+    else                ret=optimalAlignment<false,false>(align,displace,positions,reference,cpositions,derivatives,squared);
+    break;
+
+  } case OPTIMAL : {
+    if(align==displace) ret=optimalAlignment<true,true>(align,displace,positions,reference,cpositions,derivatives,squared);
+    else ret=optimalAlignment<true,false>(align,displace,positions,reference,cpositions,derivatives,squared);
+    break;
+  }
+  }
+
+  return ret;
+
+}
+
+Vector RMSD::calcPositionsCenter(const std::vector<Vector> & positions)const {
+  plumed_massert(positions.size()==align.size(),"mismatch in dimension of position/align arrays while calculating the center");
+  Vector c; c.zero();
+  for(unsigned i=0; i<positions.size(); i++) c+=positions[i]*align[i];
+  return c;
+}
+
 
 /// convenience method for calculating the standard derivatives and the derivative of the rmsd respect to the reference position
 double RMSD::calc_DDistDRef( const std::vector<Vector>& positions, std::vector<Vector> &derivatives, std::vector<Vector>& DDistDRef, const bool squared  ) {
@@ -420,13 +514,6 @@ double RMSD::optimalAlignment(const  std::vector<double>  & align,
                               const std::vector<Vector> & reference,
                               std::vector<Vector>  & derivatives, bool squared)const {
   const unsigned n=reference.size();
-// This is the trace of positions*positions + reference*reference
-  double rr00(0);
-  double rr11(0);
-// This is positions*reference
-  Tensor rr01;
-
-  derivatives.resize(n);
 
   Vector cpositions;
 
@@ -435,14 +522,37 @@ double RMSD::optimalAlignment(const  std::vector<double>  & align,
     double w=align[iat];
     cpositions+=positions[iat]*w;
   }
+  return optimalAlignment<safe,alEqDis>(align,displace,positions,reference,cpositions,derivatives,squared);
+}
+
+// this version takes the center of the instantaneous positions as an input, so that
+// loops over the frames of a path can compute it once and share it between frames
+template <bool safe,bool alEqDis>
+double RMSD::optimalAlignment(const  std::vector<double>  & align,
+                              const  std::vector<double>  & displace,
+                              const std::vector<Vector> & positions,
+                              const std::vector<Vector> & reference,
+                              const Vector & cpositions,
+                              std::vector<Vector>  & derivatives, bool squared)const {
+  const unsigned n=reference.size();
+// This is the trace of positions*positions + reference*reference
+  double rr00(0);
+  double rr11(0);
+// This is positions*reference
+  Tensor rr01;
+
+  derivatives.resize(n);
 
 // second expensive loop: compute second moments wrt centers
-  for(unsigned iat=0; iat<n; iat++) {
-    double w=align[iat];
-    rr00+=dotProduct(positions[iat]-cpositions,positions[iat]-cpositions)*w;
-    rr11+=dotProduct(reference[iat],reference[iat])*w;
-    rr01+=Tensor(positions[iat]-cpositions,reference[iat])*w;
-  }
+  if(packed_blocks) {
+    Vector cr; cr.zero();
+    packedSecondMoments(align,positions,cpositions,reference,cr,rr00,rr11,rr01);
+  } else for(unsigned iat=0; iat<n; iat++) {
+      double w=align[iat];
+      rr00+=dotProduct(positions[iat]-cpositions,positions[iat]-cpositions)*w;
+      rr11+=dotProduct(reference[iat],reference[iat])*w;
+      rr01+=Tensor(positions[iat]-cpositions,reference[iat])*w;
+    }
 
   Tensor4d m;
 
@@ -561,7 +671,7 @@ double RMSD::optimalAlignment(const  std::vector<double>  & align,
 
 // third expensive loop: derivatives
   for(unsigned iat=0; iat<n; iat++) {
-    Vector d(positions[iat]-cpositions - matmul(rotation,reference[iat]));
+    Vector d(subMatmul(positions[iat]-cpositions,rotation,reference[iat]));
     if(alEqDis) {
 // there is no need for derivatives of rotation and shift here as it is by construction zero
 // (similar to Hellman-Feynman forces)
@@ -612,6 +722,7 @@ double RMSD::optimalAlignment(const  std::vector<double>  & align,
                               bool squared) const {
   //std::cerr<<"setting up the core data \n";
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
 
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
@@ -630,6 +741,32 @@ double RMSD::optimalAlignment(const  std::vector<double>  & align,
   derivatives=cd.getDDistanceDPositions();
   return dist;
 }
+
+/// the core-data implementation manages the centers itself, so the variant with a
+/// precomputed center simply hands the center over before running the calculation
+template <bool safe,bool alEqDis>
+double RMSD::optimalAlignment(const  std::vector<double>  & align,
+                              const  std::vector<double>  & displace,
+                              const std::vector<Vector> & positions,
+                              const std::vector<Vector> & reference,
+                              const Vector & cpositions,
+                              std::vector<Vector>  & derivatives,
+                              bool squared) const {
+  RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
+
+  cd.setPositionsCenterIsRemoved(positions_center_is_removed);
+  cd.setPositionsCenter(cpositions);
+
+  cd.setReferenceCenterIsRemoved(reference_center_is_removed);
+  if(!reference_center_is_calculated) {cd.calcReferenceCenter();}
+  else {cd.setReferenceCenter(reference_center);}
+
+  cd.doCoreCalc(safe,alEqDis);
+  double dist=cd.getDistance(squared);
+  derivatives=cd.getDDistanceDPositions();
+  return dist;
+}
 #endif
 template <bool safe,bool alEqDis>
 double RMSD::optimalAlignment_DDistDRef(const  std::vector<double>  & align,
@@ -642,6 +779,7 @@ double RMSD::optimalAlignment_DDistDRef(const  std::vector<double>  & align,
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
@@ -673,6 +811,7 @@ double RMSD::optimalAlignment_SOMA(const  std::vector<double>  & align,
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
@@ -707,6 +846,7 @@ double RMSD::optimalAlignment_DDistDRef_Rot_DRotDPos(const  std::vector<double>
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
@@ -745,6 +885,7 @@ double RMSD::optimalAlignment_DDistDRef_Rot_DRotDPos_DRotDRef(const  std::vector
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
@@ -781,6 +922,7 @@ double RMSD::optimalAlignment_Rot_DRotDRr01(const  std::vector<double>  & align,
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
   if(positions_center_is_calculated) {cd.setPositionsCenter(positions_center);}
@@ -812,6 +954,7 @@ double RMSD::optimalAlignment_Rot(const  std::vector<double>  & align,
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
   if(positions_center_is_calculated) {cd.setPositionsCenter(positions_center);}
@@ -845,6 +988,7 @@ double RMSD::optimalAlignmentWithCloseStructure(const  std::vector<double>  & al
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
   if(positions_center_is_calculated) {cd.setPositionsCenter(positions_center);}
@@ -879,6 +1023,7 @@ double RMSD::optimalAlignment_PCA(const  std::vector<double>  & align,
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
   if(positions_center_is_calculated) {cd.setPositionsCenter(positions_center);}
@@ -921,6 +1066,8 @@ double RMSD::optimalAlignment_Fit(const  std::vector<double>  & align,
   //initialize the data into the structure
   // typically the positions do not have the com neither calculated nor subtracted. This layer takes care of this business
   RMSDCoreData cd(align,displace,positions,reference);
+  cd.setPackedBlocks(packed_blocks);
+  if(warm_start) cd.setWarmStart(&warm_evecs,&warm_evecs_set);
   // transfer the settings for the center to let the CoreCalc deal with it
   cd.setPositionsCenterIsRemoved(positions_center_is_removed);
   if(positions_center_is_calculated) {cd.setPositionsCenter(positions_center);}
@@ -972,12 +1119,14 @@ void RMSDCoreData::doCoreCalc(bool safe,bool alEqDis, bool only_rotation) {
   Vector cp; cp.zero(); if(!cpositions_is_removed)cp=cpositions;
   Vector cr; cr.zero(); if(!creference_is_removed)cr=creference;
 // second expensive loop: compute second moments wrt centers
-  for(unsigned iat=0; iat<n; iat++) {
-    double w=align[iat];
-    rr00+=dotProduct(positions[iat]-cp,positions[iat]-cp)*w;
-    rr11+=dotProduct(reference[iat]-cr,reference[iat]-cr)*w;
-    rr01+=Tensor(positions[iat]-cp,reference[iat]-cr)*w;
-  }
+  if(use_packed_kernel) {
+    packedSecondMoments(align,positions,cp,reference,cr,rr00,rr11,rr01);
+  } else for(unsigned iat=0; iat<n; iat++) {
+      double w=align[iat];
+      rr00+=dotProduct(positions[iat]-cp,positions[iat]-cp)*w;
+      rr11+=dotProduct(reference[iat]-cr,reference[iat]-cr)*w;
+      rr01+=Tensor(positions[iat]-cp,reference[iat]-cr)*w;
+    }
 
 // the quaternion matrix: this is internal
   Tensor4d m;
@@ -1025,7 +1174,42 @@ void RMSDCoreData::doCoreCalc(bool safe,bool alEqDis, bool only_rotation) {
 
   Tensor dq_drr01[4];
   if(!alEqDis or !only_rotation) {
-    diagMatSym(m, eigenvals, eigenvecs );
+    bool solved=false;
+    if( warm_evecs && *warm_evecs_set ) {
+      // rotate m into the eigenbasis of the previous call: between
+      // consecutive MD steps the result is nearly diagonal and a couple of
+      // Jacobi sweeps on the stack refine it to full precision without
+      // calling LAPACK. When the structure changed too much the rotated
+      // matrix has large off-diagonal elements and we fall back on the
+      // full diagonalization below
+      const Tensor4d & V(*warm_evecs);
+      Tensor4d mp;
+      for(unsigned i=0; i<4; i++) for(unsigned j=0; j<4; j++) {
+          double tmp=0.0;
+          for(unsigned k=0; k<4; k++) for(unsigned l=0; l<4; l++) tmp+=V[i][k]*m[k][l]*V[j][l];
+          mp[i][j]=tmp;
+        }
+      double off=0.0, dia=0.0;
+      for(unsigned i=0; i<4; i++) { dia+=std::fabs(mp[i][i]); for(unsigned j=i+1; j<4; j++) off+=std::fabs(mp[i][j]); }
+      if( off<0.05*dia ) {
+        double a[16], sevals[4], sevecs[16];
+        for(unsigned i=0; i<4; i++) for(unsigned j=0; j<4; j++) a[4*i+j]=mp[i][j];
+        if( smallmat::jacobiDiag( 4, a, sevals, sevecs ) ) {
+          for(unsigned i=0; i<4; i++) {
+            eigenvals[i]=sevals[i];
+            for(unsigned j=0; j<4; j++) { double tmp=0.0; for(unsigned k=0; k<4; k++) tmp+=sevecs[4*i+k]*V[k][j]; eigenvecs[i][j]=tmp; }
+          }
+          // same phase convention as diagMatSym, for reproducibility
+          for(unsigned i=0; i<4; i++) {
+            unsigned j; for(j=0; j<4; j++) if(eigenvecs[i][j]*eigenvecs[i][j]>1e-14) break;
+            if(j<4) if(eigenvecs[i][j]<0.0) for(j=0; j<4; j++) eigenvecs[i][j]*=-1;
+          }
+          solved=true;
+        }
+      }
+    }
+    if( !solved ) diagMatSym(m, eigenvals, eigenvecs );
+    if( warm_evecs ) { *warm_evecs=eigenvecs; *warm_evecs_set=true; }
     q=Vector4d(eigenvecs[0][0],eigenvecs[0][1],eigenvecs[0][2],eigenvecs[0][3]);
     double dq_dm[4][4][4];
     for(unsigned i=0; i<4; i++) for(unsigned j=0; j<4; j++) for(unsigned k=0; k<4; k++) {
@@ -1084,7 +1268,7 @@ void RMSDCoreData::doCoreCalc(bool safe,bool alEqDis, bool only_rotation) {
   #pragma omp simd
   for(unsigned iat=0; iat<n; iat++) {
     // components differences: this is useful externally
-    d[iat]=positions[iat]-cp - matmul(rotation,reference[iat]-cr);
+    d[iat]=subMatmul(positions[iat]-cp,rotation,reference[iat]-cr);
     //cerr<<"D "<<iat<<" "<<d[iat][0]<<" "<<d[iat][1]<<" "<<d[iat][2]<<"\n";
   }
   // ddist_drotation if needed
@@ -1147,7 +1331,7 @@ void RMSDCoreData::doCoreCalcWithCloseStructure(bool safe,bool alEqDis, Tensor &
 
   #pragma omp simd
   for (unsigned iat=0; iat<natoms; iat++) {
-    d[iat] = positions[iat] - cp - matmul(rotation, reference[iat]-cr);
+    d[iat] = subMatmul(positions[iat]-cp, rotation, reference[iat]-cr);
   }
   if (!alEqDis) {
     for (unsigned iat=0; iat<natoms; iat++) {
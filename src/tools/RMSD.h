@@ -65,6 +65,16 @@ class RMSD
 {
   enum AlignmentMethod {SIMPLE, OPTIMAL, OPTIMAL_FAST};
   AlignmentMethod alignmentMethod;
+// accumulate the correlation matrix on packed coordinate blocks, which the
+// compiler can vectorize: selected by appending -PACKED to the type string
+  bool packed_blocks;
+// warm start the quaternion eigensolver from the eigenvectors of the
+// previous call, see setWarmStart
+  bool warm_start;
+// true once warm_evecs contains the eigenvectors of a previous call
+  bool warm_evecs_set;
+// eigenvectors of the quaternion matrix at the previous call (row-wise)
+  Tensor4d warm_evecs;
 // Reference coordinates
   std::vector<Vector> reference;
 // Weights for alignment
@@ -106,6 +116,13 @@ public:
   void set(const std::vector<double> & align, const std::vector<double> & displace, const std::vector<Vector> & reference,const std::string & mytype, bool remove_center=true, bool normalize_weights=true );
 /// set the type of alignment we are doing
   void setType(const std::string & mytype);
+/// refine the quaternion eigensystem starting from the one of the previous call
+/// instead of always performing a full diagonalization: between consecutive MD
+/// steps one or two Jacobi sweeps typically suffice, and a full diagonalization
+/// is automatically performed whenever the structure changed too much.
+/// Only enable this when successive calls operate on slowly varying positions,
+/// as when fitting at every step (see FIT_TO_TEMPLATE)
+  void setWarmStart(bool ws);
 /// set reference coordinates, remove the com by using uniform weights
   void setReference(const std::vector<Vector> & reference);
   std::vector<Vector> getReference();
@@ -132,6 +149,14 @@ public:
                           const std::vector<Vector> & reference,
                           std::vector<Vector>  & DDistDPos, bool squared=false)const;
 
+  template <bool safe,bool alEqDis>
+  double optimalAlignment(const  std::vector<double>  & align,
+                          const  std::vector<double>  & displace,
+                          const std::vector<Vector> & positions,
+                          const std::vector<Vector> & reference,
+                          const Vector & cpositions,
+                          std::vector<Vector>  & DDistDPos, bool squared=false)const;
+
   template <bool safe, bool alEqDis>
   double optimalAlignmentWithCloseStructure(const  std::vector<double>  & align,
       const  std::vector<double>  & displace,
@@ -229,6 +254,13 @@ public:
 
 /// Compute rmsd: note that this is an intermediate layer which is kept in order to evtl expand with more alignment types/user options to be called while keeping the workhorses separated
   double calculate(const std::vector<Vector> & positions,std::vector<Vector> &derivatives, bool squared=false)const;
+/// Compute rmsd with the alignment-weighted center of the instantaneous positions precomputed
+/// by the caller using calcPositionsCenter.  Path variables that measure the distance from many
+/// frames sharing the same alignment weights use this so the positions are centered once per
+/// step rather than once per frame
+  double calculate(const std::vector<Vector> & positions, const Vector & cpositions, std::vector<Vector> &derivatives, bool squared=false)const;
+/// Compute the alignment-weighted center of the instantaneous positions for use with the method above
+  Vector calcPositionsCenter(const std::vector<Vector> & positions)const;
 /// Other convenience methods:
 /// calculate the derivative of distance respect to position(DDistDPos) and reference (DDistDPos)
   double calc_DDistDRef( const std::vector<Vector>& positions, std::vector<Vector> &DDistDPos, std::vector<Vector>& DDistDRef, const bool squared=false   );
@@ -267,6 +299,13 @@ private:
   bool hasDistance;  // distance is already calculated
   bool isInitialized;
   bool safe;
+  bool use_packed_kernel;
+
+  // when non-null the eigensolver is warm started from *warm_evecs (if
+  // *warm_evecs_set) and the refined eigenvectors are stored back, see
+  // RMSD::setWarmStart
+  Tensor4d* warm_evecs;
+  bool* warm_evecs_set;
 
   // this need to be copied and they are small, should not affect the performance
   Vector creference;
@@ -302,14 +341,21 @@ public:
   RMSDCoreData(const std::vector<double> &a,const std::vector<double> &d,const std::vector<Vector> &p, const std::vector<Vector> &r, Vector &cp, Vector &cr ):
     alEqDis(false),distanceIsMSD(false),hasDistance(false),isInitialized(false),safe(false),
     creference(cr),creference_is_calculated(true),creference_is_removed(true),
-    cpositions(cp),cpositions_is_calculated(true),cpositions_is_removed(true),retrieve_only_rotation(false),positions(p),reference(r),align(a),displace(d),dist(0.0),rr00(0.0),rr11(0.0) {};
+    cpositions(cp),cpositions_is_calculated(true),cpositions_is_removed(true),retrieve_only_rotation(false),positions(p),reference(r),align(a),displace(d),dist(0.0),rr00(0.0),rr11(0.0) {use_packed_kernel=false; warm_evecs=NULL; warm_evecs_set=NULL;};
 
   // this constructor does not assume that the positions and reference have the center subtracted
   RMSDCoreData(const std::vector<double> &a,const std::vector<double> &d,const std::vector<Vector> &p, const std::vector<Vector> &r):
     alEqDis(false),distanceIsMSD(false),hasDistance(false),isInitialized(false),safe(false),
     creference_is_calculated(false),creference_is_removed(false),
     cpositions_is_calculated(false),cpositions_is_removed(false),retrieve_only_rotation(false),positions(p),reference(r),align(a),displace(d),dist(0.0),rr00(0.0),rr11(0.0)
-  {cpositions.zero(); creference.zero();};
+  {cpositions.zero(); creference.zero(); use_packed_kernel=false; warm_evecs=NULL; warm_evecs_set=NULL;};
+
+  // use the block-packed kernel for the correlation matrix (see RMSD::setType)
+  void setPackedBlocks(bool t) {use_packed_kernel=t;};
+
+  // warm start the eigensolver from the eigenvectors stored by a previous
+  // call (see RMSD::setWarmStart)
+  void setWarmStart(Tensor4d* evecs, bool* evecs_set) {warm_evecs=evecs; warm_evecs_set=evecs_set;};
 
   // set the center on the fly without subtracting
   void calcPositionsCenter() {
@@ -50,6 +50,38 @@ Stopwatch::~Stopwatch() {
   }
 }
 
+void Stopwatch::writeJson(std::ostream&os) {
+// Make sure paused watches are stopped, as is done when logging on destruction
+  for(auto & w : watches) {
+    if(w.second.state==Watch::State::paused) w.second.start().stop();
+  }
+
+  std::vector<std::string> names;
+  for(const auto & it : watches) names.push_back(it.first);
+  std::sort(names.begin(),names.end());
+
+  const double frac=1.0/1000000000.0;
+  char buffer[1000];
+
+  os<<"{\n";
+  for(unsigned i=0; i<names.size(); i++) {
+    const Watch&t(watches.find(names[i])->second);
+// the only characters in the names that need escaping in a JSON string
+    std::string escaped;
+    for(char c : names[i]) {
+      if(c=='"' || c=='\\') escaped+='\\';
+      escaped+=c;
+    }
+    const double average = t.cycles>0 ? frac*t.total/t.cycles : 0.0;
+    std::sprintf(buffer,"{\"cycles\": %u, \"total\": %.9f, \"average\": %.9f, \"minimum\": %.9f, \"maximum\": %.9f}",
+                 t.cycles, frac*t.total, average, frac*t.min, frac*t.max);
+    os<<"  \""<<escaped<<"\": "<<buffer;
+    if(i+1<names.size()) os<<",";
+    os<<"\n";
+  }
+  os<<"}\n";
+}
+
 std::ostream& Stopwatch::log(std::ostream&os)const {
   char buffer[1000];
   buffer[0]=0;
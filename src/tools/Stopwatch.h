@@ -251,6 +251,12 @@ private:
 /// Each watch is labeled with a string.
   std::unordered_map<std::string,Watch> watches;
 
+/// Cached pointer to the unnamed watch.
+/// The unnamed watch brackets every call to PlumedMain::cmd(), so it is worth
+/// skipping the lookup in the map for it.  References into an unordered_map
+/// are never invalidated by insertions, so the cache stays valid
+  Watch* unnamed=nullptr;
+
 /// Log over stream os.
   std::ostream& log(std::ostream& os)const;
 
@@ -282,6 +288,15 @@ public:
 /// pauses the watch. This allows Stopwatch to be started and paused in
 /// an exception safe manner.
   Handler startPause(const std::string&name=StopwatchEmptyString());
+/// Get a direct reference to the watch named name, creating it if needed.
+/// References are never invalidated, so code timing a hot region can look
+/// its watch up once, keep the reference and call Watch::startStop() or
+/// Watch::startPause() on it directly, paying for the hashing of the name
+/// only once instead of at every use.
+  Watch & watch(const std::string&name=StopwatchEmptyString());
+/// Write all the timers in machine readable (JSON) form.
+/// Paused watches are stopped first, as is done when logging on destruction.
+  void writeJson(std::ostream&os);
 };
 
 inline
@@ -300,32 +315,41 @@ Stopwatch::Handler::~Handler() {
   }
 }
 
+inline
+Stopwatch::Watch & Stopwatch::watch(const std::string & name) {
+  if(name.empty()) {
+    if(!unnamed) unnamed=&watches[name];
+    return *unnamed;
+  }
+  return watches[name];
+}
+
 inline
 Stopwatch& Stopwatch::start(const std::string & name) {
-  watches[name].start();
+  watch(name).start();
   return *this;
 }
 
 inline
 Stopwatch& Stopwatch::stop(const std::string & name) {
-  watches[name].stop();
+  watch(name).stop();
   return *this;
 }
 
 inline
 Stopwatch& Stopwatch::pause(const std::string & name) {
-  watches[name].pause();
+  watch(name).pause();
   return *this;
 }
 
 inline
 Stopwatch::Handler Stopwatch::startStop(const std::string&name) {
-  return watches[name].startStop();
+  return watch(name).startStop();
 }
 
 inline
 Stopwatch::Handler Stopwatch::startPause(const std::string&name) {
-  return watches[name].startPause();
+  return watch(name).startPause();
 }
 
 inline
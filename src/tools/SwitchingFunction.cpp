@@ -23,6 +23,8 @@
 #include "Tools.h"
 #include "Keywords.h"
 #include "OpenMP.h"
+#include "LeptonCache.h"
+#include "FastMath.h"
 #include <vector>
 #include <limits>
 
@@ -169,6 +171,17 @@ removed in the future. Similarly, the STRETCH keyword is still allowed but has n
 Notice that switching functions defined with the simplified syntax are never stretched
 for backward compatibility. This might change in the future.
 
+Any switching function with a finite D_MAX can also be tabulated by adding the TABULATE
+flag to its definition, e.g.
+\verbatim
+KEYWORD={SMAP R_0=0.5 A=8 B=8 D_MAX=1.0 TABULATE}
+\endverbatim
+The function is then sampled once at setup time into a cubic interpolation table, which
+is refined until it reproduces the exact function to within TABULATE_ERROR (default 1e-6),
+and the table is used in its place afterwards. Since the table is uniform in the square
+of the distance, this makes the evaluation of expensive forms such as SMAP or CUSTOM
+roughly as fast as a RATIONAL one, at the price of the chosen accuracy.
+
 */
 //+ENDPLUMEDOC
 
@@ -182,6 +195,43 @@ void SwitchingFunction::registerKeywords( Keywords& keys ) {
   keys.add("compulsory","B","the value of b in the switching function (only needed for TYPE=SMAP)");
 }
 
+void SwitchingFunction::setupLepton(const std::string& func) {
+  const lepton::ParsedExpression & pe=LeptonCache::parse(func);
+  lepton_func=func;
+  expression.resize(OpenMP::getNumThreads());
+  for(auto & e : expression) e=pe.createCompiledExpression();
+  lepton_ref.resize(expression.size());
+  for(unsigned t=0; t<lepton_ref.size(); t++) {
+    try {
+      lepton_ref[t]=&const_cast<lepton::CompiledExpression*>(&expression[t])->getVariableReference("x");
+    } catch(const PLMD::lepton::Exception& exc) {
+      try {
+        lepton_ref[t]=&const_cast<lepton::CompiledExpression*>(&expression[t])->getVariableReference("x2");
+        leptonx2=true;
+      } catch(const PLMD::lepton::Exception& exc) {
+// this is necessary since in some cases lepton things a variable is not present even though it is present
+// e.g. func=0*x
+        lepton_ref[t]=nullptr;
+      }
+    }
+  }
+  std::string arg="x";
+  if(leptonx2) arg="x2";
+  const lepton::ParsedExpression & ped=LeptonCache::differentiate(func,arg);
+  expression_deriv.resize(OpenMP::getNumThreads());
+  for(auto & e : expression_deriv) e=ped.createCompiledExpression();
+  lepton_ref_deriv.resize(expression_deriv.size());
+  for(unsigned t=0; t<lepton_ref_deriv.size(); t++) {
+    try {
+      lepton_ref_deriv[t]=&const_cast<lepton::CompiledExpression*>(&expression_deriv[t])->getVariableReference(arg);
+    } catch(const PLMD::lepton::Exception& exc) {
+// this is necessary since in some cases lepton things a variable is not present even though it is present
+// e.g. func=3*x
+      lepton_ref_deriv[t]=nullptr;
+    }
+  }
+}
+
 void SwitchingFunction::set(const std::string & definition,std::string& errormsg) {
   vector<string> data=Tools::getWords(definition);
   if( data.size()<1 ) {
@@ -213,6 +263,11 @@ void SwitchingFunction::set(const std::string & definition,std::string& errormsg
   bool dontstretch=false;
   Tools::parseFlag(data,"NOSTRETCH",dontstretch); // this is ignored now
   if(dontstretch) dostretch=false;
+  bool dotabulate=false;
+  Tools::parseFlag(data,"TABULATE",dotabulate);
+  double tabulate_error=1e-6;
+  present=Tools::findKeyword(data,"TABULATE_ERROR");
+  if(present && !Tools::parse(data,"TABULATE_ERROR",tabulate_error)) errormsg="could not parse TABULATE_ERROR";
   double r0;
   if(name=="CUBIC") {
     r0 = dmax - d0;
@@ -233,6 +288,26 @@ void SwitchingFunction::set(const std::string & definition,std::string& errormsg
     if(present && !Tools::parse(data,"MM",mm)) errormsg="could not parse MM";
     if(mm==0) mm=2*nn;
     fastrational=(nn%2==0 && mm%2==0 && d0==0.0);
+    bool dojit=false;
+    Tools::parseFlag(data,"JIT",dojit);
+    if(dojit) {
+// evaluate the rational through lepton, which compiles it to native code
+// when plumed is built with the bundled asmjit backend. Notice that, unlike
+// do_rational, the compiled expression is singular at rdist=1, so the
+// special limit at that point is not reproduced
+      std::string snn,smm;
+      Tools::convert(nn,snn);
+      Tools::convert(mm,smm);
+      type=leptontype;
+      fastrational=false;
+      if(nn%2==0 && mm%2==0 && d0==0.0) {
+        Tools::convert(nn/2,snn);
+        Tools::convert(mm/2,smm);
+        setupLepton("(1-x2^"+snn+")/(1-x2^"+smm+")");
+      } else {
+        setupLepton("(1-x^"+snn+")/(1-x^"+smm+")");
+      }
+    }
   } else if(name=="SMAP") {
     type=smap;
     present=Tools::findKeyword(data,"A");
@@ -263,43 +338,11 @@ void SwitchingFunction::set(const std::string & definition,std::string& errormsg
     type=leptontype;
     std::string func;
     Tools::parse(data,"FUNC",func);
-    lepton::ParsedExpression pe=lepton::Parser::parse(func).optimize(lepton::Constants());
-    lepton_func=func;
-    expression.resize(OpenMP::getNumThreads());
-    for(auto & e : expression) e=pe.createCompiledExpression();
-    lepton_ref.resize(expression.size());
-    for(unsigned t=0; t<lepton_ref.size(); t++) {
-      try {
-        lepton_ref[t]=&const_cast<lepton::CompiledExpression*>(&expression[t])->getVariableReference("x");
-      } catch(const PLMD::lepton::Exception& exc) {
-        try {
-          lepton_ref[t]=&const_cast<lepton::CompiledExpression*>(&expression[t])->getVariableReference("x2");
-          leptonx2=true;
-        } catch(const PLMD::lepton::Exception& exc) {
-// this is necessary since in some cases lepton things a variable is not present even though it is present
-// e.g. func=0*x
-          lepton_ref[t]=nullptr;
-        }
-      }
-    }
-    std::string arg="x";
-    if(leptonx2) arg="x2";
-    lepton::ParsedExpression ped=lepton::Parser::parse(func).differentiate(arg).optimize(lepton::Constants());
-    expression_deriv.resize(OpenMP::getNumThreads());
-    for(auto & e : expression_deriv) e=ped.createCompiledExpression();
-    lepton_ref_deriv.resize(expression_deriv.size());
-    for(unsigned t=0; t<lepton_ref_deriv.size(); t++) {
-      try {
-        lepton_ref_deriv[t]=&const_cast<lepton::CompiledExpression*>(&expression_deriv[t])->getVariableReference(arg);
-      } catch(const PLMD::lepton::Exception& exc) {
-// this is necessary since in some cases lepton things a variable is not present even though it is present
-// e.g. func=3*x
-        lepton_ref_deriv[t]=nullptr;
-      }
-    }
-
+    setupLepton(func);
   }
   else errormsg="cannot understand switching function type '"+name+"'";
+  fastgaussian=(type==gaussian && d0==0.0);
+  fastsmap=(type==smap && d0==0.0 && a%2==0);
   if( !data.empty() ) {
     errormsg="found the following rogue keywords in switching function input : ";
     for(unsigned i=0; i<data.size(); ++i) errormsg = errormsg + data[i] + " ";
@@ -314,6 +357,14 @@ void SwitchingFunction::set(const std::string & definition,std::string& errormsg
   }
   plumed_assert(!(leptonx2 && d0!=0.0)) << "You cannot use lepton x2 optimization with d0!=0.0 (d0=" << d0 <<")\n"
                                         << "Please rewrite your function using x as a variable";
+
+// the table is built last, so that it samples the final function,
+// stretching included
+  if(dotabulate && errormsg.length()==0) {
+    if(tabulate_error<=0.0) errormsg="TABULATE_ERROR should be positive";
+    else if(dmax==std::numeric_limits<double>::max()) errormsg="TABULATE requires D_MAX, since the table must cover the whole range of the function";
+    else setupTable(tabulate_error);
+  }
 }
 
 std::string SwitchingFunction::description() const {
@@ -353,6 +404,7 @@ std::string SwitchingFunction::description() const {
     ostr<<" func="<<lepton_func;
 
   }
+  if(tabulated) ostr<<".  Evaluated through a table with "<<table_n<<" intervals";
   return ostr.str();
 }
 
@@ -381,8 +433,62 @@ double SwitchingFunction::do_rational(double rdist,double&dfunc,int nn,int mm)co
   return result;
 }
 
+double SwitchingFunction::tableValue(double distance2,double&dfunc)const {
+  double z=distance2*table_invdz;
+  unsigned i=static_cast<unsigned>(z);
+  if(i>=table_n) i=table_n-1;
+  const double t=z-i;
+  const double* p=&table[2*i];
+// the stored derivatives are with respect to the squared distance, so
+// they are scaled by the spacing to become derivatives in t
+  const double y0=p[0], m0=p[1]*table_dz;
+  const double y1=p[2], m1=p[3]*table_dz;
+  const double t2=t*t, t3=t2*t;
+  const double result=(2.0*t3-3.0*t2+1.0)*y0+(t3-2.0*t2+t)*m0+(3.0*t2-2.0*t3)*y1+(t3-t2)*m1;
+  const double dsdt=(6.0*t2-6.0*t)*y0+(3.0*t2-4.0*t+1.0)*m0+(6.0*t-6.0*t2)*y1+(3.0*t2-2.0*t)*m1;
+// this is 2 ds/d(r^2), which equals (1/r) ds/dr
+  dfunc=2.0*dsdt*table_invdz;
+  return result;
+}
+
+void SwitchingFunction::setupTable(double max_error) {
+  double dfunc;
+  for(unsigned n=128;; n*=2) {
+    table_n=n;
+    table_dz=dmax_2/n;
+    table_invdz=1.0/table_dz;
+    table.resize(2*(n+1));
+    for(unsigned i=0; i<=n; i++) {
+// notice that tabulated is still false here, so this samples the exact function
+      table[2*i]=calculateSqr(i*table_dz,dfunc);
+// calculateSqr sets dfunc to 2 ds/d(r^2)
+      table[2*i+1]=0.5*dfunc;
+    }
+// measure the error at the midpoints of the intervals, where the error
+// of the cubic Hermite interpolation is largest
+    double err=0.0;
+    for(unsigned i=0; i<n; i++) {
+      const double z=(i+0.5)*table_dz;
+      const double exact=calculateSqr(z,dfunc);
+      double dapprox;
+      const double approx=tableValue(z,dapprox);
+      err=std::max(err,std::fabs(approx-exact));
+    }
+    if(err<=max_error) break;
+    plumed_massert(n<(1<<20),"could not tabulate the switching function to the requested accuracy; consider a larger TABULATE_ERROR");
+  }
+  tabulated=true;
+}
+
 double SwitchingFunction::calculateSqr(double distance2,double&dfunc)const {
-  if(fastrational) {
+  if(tabulated) {
+    if(distance2>dmax_2) {
+      dfunc=0.0;
+      return 0.0;
+    }
+// stretch and shift are already included in the tabulated values
+    return tableValue(distance2,dfunc);
+  } else if(fastrational) {
     if(distance2>dmax_2) {
       dfunc=0.0;
       return 0.0;
@@ -409,6 +515,33 @@ double SwitchingFunction::calculateSqr(double distance2,double&dfunc)const {
     dfunc=expression_deriv[t].evaluate();
 // chain rule:
     dfunc*=2*invr0_2;
+// stretch:
+    result=result*stretch+shift;
+    dfunc*=stretch;
+    return result;
+  } else if(fastgaussian) {
+    if(distance2>dmax_2) {
+      dfunc=0.0;
+      return 0.0;
+    }
+    const double rdist_2 = distance2*invr0_2;
+    double result=FastMath::exp(-0.5*rdist_2);
+// this is 2 ds/d(r^2), which equals (1/r) ds/dr
+    dfunc=-invr0_2*result;
+// stretch:
+    result=result*stretch+shift;
+    dfunc*=stretch;
+    return result;
+  } else if(fastsmap) {
+    if(distance2>dmax_2) {
+      dfunc=0.0;
+      return 0.0;
+    }
+    const double rdist_2 = distance2*invr0_2;
+    const double sx=c*Tools::fastpow( rdist_2, a/2 );
+    double result=pow( 1.0 + sx, d );
+// written with sx/rdist_2 expanded so that the rdist_2=0 limit is finite
+    dfunc=-b*invr0_2*c*Tools::fastpow( rdist_2, a/2-1 )*result/(1.0+sx);
 // stretch:
     result=result*stretch+shift;
     dfunc*=stretch;
@@ -425,9 +558,9 @@ double SwitchingFunction::calculate(double distance,double&dfunc)const {
     dfunc=0.0;
     return 0.0;
   }
-// in this case, the lepton object stores only the calculateSqr function
-// so we have to implement calculate in terms of calculateSqr
-  if(leptonx2) {
+// in these cases the function is only available as a function of the
+// squared distance, so we have to implement calculate in terms of calculateSqr
+  if(leptonx2 || tabulated) {
     return calculateSqr(distance*distance,dfunc);
   }
   const double rdist = (distance-d0)*invr0;
@@ -444,7 +577,7 @@ double SwitchingFunction::calculate(double distance,double&dfunc)const {
     } else if(type==rational) {
       result=do_rational(rdist,dfunc,nn,mm);
     } else if(type==exponential) {
-      result=exp(-rdist);
+      result=FastMath::exp(-rdist);
       dfunc=-result;
     } else if(type==nativeq) {
       double rdist2 = beta*(distance - lambda * ref);
@@ -453,7 +586,7 @@ double SwitchingFunction::calculate(double distance,double&dfunc)const {
       result=1./(1.+exprdist);
       dfunc=-1.0/(exprmdist+1.0)/(1.+exprdist);
     } else if(type==gaussian) {
-      result=exp(-0.5*rdist*rdist);
+      result=FastMath::exp(-0.5*rdist*rdist);
       dfunc=-rdist*result;
     } else if(type==cubic) {
       double tmp1=rdist-1, tmp2=(1+2*rdist);
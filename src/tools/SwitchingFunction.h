@@ -73,6 +73,10 @@ class SwitchingFunction {
 /// Low-level tool to compute rational functions.
 /// It is separated since it is called both by calculate() and calculateSqr()
   double do_rational(double rdist,double&dfunc,int nn,int mm)const;
+/// Setup the lepton expressions (and their derivatives) for func.
+/// When plumed is compiled with the bundled asmjit backend this produces
+/// a function compiled to native code, with no dispatch in the inner loop
+  void setupLepton(const std::string& func);
 /// Function for lepton;
   std::string lepton_func;
 /// Lepton expression.
@@ -85,8 +89,30 @@ class SwitchingFunction {
   std::vector<double*> lepton_ref_deriv;
 /// Set to true for fast rational functions (depending on x**2 only)
   bool fastrational=false;
+/// Set to true for gaussian/smap functions that can be computed from x**2
+/// without taking the square root (d0 must be zero, and for smap a must be even)
+  bool fastgaussian=false;
+  bool fastsmap=false;
 /// Set to true if lepton only uses x2
   bool leptonx2=false;
+/// Set to true when the function is evaluated through the table below
+  bool tabulated=false;
+/// Tabulated values and derivatives of the function, sampled on a grid
+/// uniform in the squared distance so that the lookup needs no square
+/// root for any underlying type. Entry 2*i holds s at node i, entry
+/// 2*i+1 holds ds/d(r^2) there, and the function is reconstructed by
+/// cubic Hermite interpolation between the nodes
+  std::vector<double> table;
+/// Number of intervals of the table
+  unsigned table_n=0;
+/// Spacing of the table in the squared distance, and its inverse
+  double table_dz=0.0;
+  double table_invdz=0.0;
+/// Build the table, doubling the number of intervals until the
+/// interpolation error at the midpoints is at most max_error
+  void setupTable(double max_error);
+/// Evaluate the table at a squared distance; dfunc is set as in calculateSqr()
+  double tableValue(double distance2,double&dfunc)const;
 public:
   static void registerKeywords( Keywords& keys );
 /// Set a "rational" switching function.
@@ -108,7 +134,9 @@ public:
 /// df will be set to the \f$ \frac{1}{\sqrt{x}}\frac{ds}{d\sqrt{x}}= 2 \frac{ds}{dx}\f$
 /// (same as calculate()).
 /// The advantage is that in some case the expensive square root can be avoided
-/// (namely for rational functions, if nn and mm are even and d0 is zero)
+/// (namely for rational functions if nn and mm are even and d0 is zero, for
+/// gaussian functions if d0 is zero, and for smap functions if d0 is zero and
+/// a is even)
   double calculateSqr(double distance2,double&dfunc)const;
 /// Returns d0
   double get_d0() const;
@@ -0,0 +1,59 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2011-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_TargetClones_h
+#define __PLUMED_tools_TargetClones_h
+
+/*
+Macro marking a hot loop kernel for function multi-versioning.
+
+When the toolchain supports it the compiler emits one clone of the function
+per listed instruction set in addition to the baseline one, and the dynamic
+loader selects the best clone for the executing CPU when the library is
+loaded (GNU ifunc resolution). In this way a single shipped kernel library,
+compiled for the lowest common denominator of a heterogeneous fleet, still
+exploits AVX2 and AVX-512 units where they exist.
+
+Apply this only to self-contained, loop-heavy free functions: every call to
+a multi-versioned function goes through one extra indirection, which is
+negligible for a kernel working on a block of data and is not for a small
+accessor. The attribute also prevents inlining of the kernel into its
+callers.
+
+Floating-point contraction is disabled in the marked kernels: the AVX2 and
+AVX-512 clones would otherwise fuse multiply-add chains that the baseline
+clone cannot, and the same input would then produce results differing in
+the last ulp depending on the executing CPU. The wider vectors are kept,
+the fused instructions are given up, and every clone rounds identically.
+
+On compilers or platforms without support (clang, non-ELF systems, non-x86
+CPUs) the macro expands to nothing and the usual single version is built.
+Define __PLUMED_DISABLE_TARGET_CLONES to force the single-version build.
+*/
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER) \
+  && defined(__x86_64__) && defined(__ELF__) && __GNUC__>=6 \
+  && !defined(__PLUMED_DISABLE_TARGET_CLONES)
+#define PLUMED_TARGET_CLONES __attribute__((target_clones("default","avx2","avx512f"),optimize("fp-contract=off")))
+#else
+#define PLUMED_TARGET_CLONES
+#endif
+
+#endif
@@ -438,6 +438,42 @@ double matmul(const VectorGeneric<n>&a,const TensorGeneric<n,m>&b,const VectorGe
   return matmul(matmul(a,b),c);
 }
 
+/// fused version of matmul(a,b)+matmul(c,d): both products are accumulated
+/// on the same output so that no intermediate tensor is materialized
+template<unsigned n,unsigned m,unsigned l>
+TensorGeneric<n,l> matmulAdd(const TensorGeneric<n,m>&a,const TensorGeneric<m,l>&b,const TensorGeneric<n,m>&c,const TensorGeneric<m,l>&d) {
+  TensorGeneric<n,l> t;
+  for(unsigned i=0; i<n; i++) for(unsigned j=0; j<l; j++) for(unsigned k=0; k<m; k++) {
+        t(i,j)+=a(i,k)*b(k,j)+c(i,k)*d(k,j);
+      }
+  return t;
+}
+
+/// fused version of matmul(a,b)+matmul(c,d) for matrix-vector products
+template<unsigned n,unsigned m>
+VectorGeneric<n> matmulAdd(const TensorGeneric<n,m>&a,const VectorGeneric<m>&b,const TensorGeneric<n,m>&c,const VectorGeneric<m>&d) {
+  VectorGeneric<n> t;
+  for(unsigned i=0; i<n; i++) for(unsigned j=0; j<m; j++) t(i)+=a(i,j)*b(j)+c(i,j)*d(j);
+  return t;
+}
+
+/// fused version of matmul(a,b)+matmul(c,d) for vector-matrix products
+template<unsigned n,unsigned m>
+VectorGeneric<n> matmulAdd(const VectorGeneric<m>&a,const TensorGeneric<m,n>&b,const VectorGeneric<m>&c,const TensorGeneric<m,n>&d) {
+  VectorGeneric<n> t;
+  for(unsigned i=0; i<n; i++) for(unsigned j=0; j<m; j++) t(i)+=a(j)*b(j,i)+c(j)*d(j,i);
+  return t;
+}
+
+/// fused version of u-matmul(a,b): the product is subtracted from a copy of
+/// u in place so that no intermediate vector is materialized
+template<unsigned n,unsigned m>
+VectorGeneric<n> subMatmul(const VectorGeneric<n>&u,const TensorGeneric<n,m>&a,const VectorGeneric<m>&b) {
+  VectorGeneric<n> t(u);
+  for(unsigned i=0; i<n; i++) for(unsigned j=0; j<m; j++) t(i)-=a(i,j)*b(j);
+  return t;
+}
+
 inline
 double determinant(const TensorGeneric<3,3>&t) {
   return t.determinant();
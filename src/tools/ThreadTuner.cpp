@@ -0,0 +1,59 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#include "ThreadTuner.h"
+
+namespace PLMD {
+
+ThreadTuner::ThreadTuner():
+  done(false),
+  best(1),
+  calls(0)
+{
+}
+
+unsigned ThreadTuner::getNumThreads( unsigned maxthreads ) {
+  if( maxthreads<=1 ) return 1;
+  if( times.size()!=maxthreads+1 ) {
+// first call, or the maximum team size changed: restart the calibration
+    times.assign( maxthreads+1, 0.0 );
+    calls=0; done=false; best=1;
+  }
+  if( !done && calls>=nrepeats*maxthreads ) {
+    best=1;
+    for(unsigned n=2; n<=maxthreads; ++n) if( times[n]<times[best] ) best=n;
+    done=true;
+  }
+  if( done ) return best;
+  return calls/nrepeats + 1;
+}
+
+void ThreadTuner::start() {
+  t0=std::chrono::high_resolution_clock::now();
+}
+
+void ThreadTuner::stop( unsigned nt ) {
+  if( done || nt>=times.size() ) return;
+  times[nt]+=std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-t0).count();
+  ++calls;
+}
+
+}
@@ -0,0 +1,66 @@
+/* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+   Copyright (c) 2012-2020 The plumed team
+   (see the PEOPLE file at the root of the distribution for a list of names)
+
+   See http://www.plumed.org for more information.
+
+   This file is part of plumed, version 2.
+
+   plumed is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   plumed is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with plumed.  If not, see <http://www.gnu.org/licenses/>.
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+#ifndef __PLUMED_tools_ThreadTuner_h
+#define __PLUMED_tools_ThreadTuner_h
+
+#include <vector>
+#include <chrono>
+
+namespace PLMD {
+
+/**
+\ingroup TOOLBOX
+Small helper that calibrates the OpenMP team size for a parallel region at runtime.
+
+The fixed cache-line heuristic in OpenMP::getGoodNumThreads knows nothing about
+the actual cost of a kernel, so cheap actions can end up oversubscribed while
+expensive ones are undersubscribed.  An instance of this class is embedded next
+to a parallel region: during the first calls it cycles a few times through all
+the possible team sizes, timing the region for each of them, and afterwards it
+settles on the fastest one.  The calibration is restarted automatically whenever
+the maximum team size changes (e.g. because the task count dropped).  The model
+assumes the per-call workload is roughly stationary, which is the case for the
+task loops it is used on.
+*/
+class ThreadTuner {
+/// how many times each candidate team size is measured before deciding
+  static const unsigned nrepeats=3;
+  bool done;
+  unsigned best;
+  unsigned calls;
+  std::chrono::high_resolution_clock::time_point t0;
+/// accumulated region time for each team size (entry 0 is unused)
+  std::vector<double> times;
+public:
+  ThreadTuner();
+/// Number of threads to be used for the next execution of the region.
+/// maxthreads is the upper bound coming from the usual heuristics
+  unsigned getNumThreads( unsigned maxthreads );
+/// To be called just before entering the parallel region
+  void start();
+/// To be called just after leaving the region, with the team size actually used
+  void stop( unsigned nt );
+};
+
+}
+
+#endif
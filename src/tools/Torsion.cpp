@@ -21,8 +21,10 @@
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 #include "Torsion.h"
 #include "Tensor.h"
+#include "FastMath.h"
 
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 
 namespace PLMD {
@@ -50,17 +52,19 @@ double Torsion::compute(const Vector& v1,const Vector& v2,const Vector& v3,Vecto
   const Tensor db_dv2(dcrossDv2(v3,v2));
   const double cosangle=dotProduct(a,b);
   const Vector dcosangle_dv1=matmul(b,da_dv1);
-  const Vector dcosangle_dv2=matmul(b,da_dv2) + matmul(a,db_dv2);
+  const Vector dcosangle_dv2=matmulAdd(b,da_dv2,a,db_dv2);
   const Vector dcosangle_dv3=matmul(a,db_dv3);
 
   const Vector cab(crossProduct(a,b));
-  const Tensor dcab_dv1(matmul(dcrossDv1(a,b),da_dv1));
-  const Tensor dcab_dv2(matmul(dcrossDv1(a,b),da_dv2) + matmul(dcrossDv2(a,b),db_dv2));
-  const Tensor dcab_dv3(matmul(dcrossDv2(a,b),db_dv3));
+  const Tensor dcab_da(dcrossDv1(a,b));
+  const Tensor dcab_db(dcrossDv2(a,b));
+  const Tensor dcab_dv1(matmul(dcab_da,da_dv1));
+  const Tensor dcab_dv2(matmulAdd(dcab_da,da_dv2,dcab_db,db_dv2));
+  const Tensor dcab_dv3(matmul(dcab_db,db_dv3));
 
   const double sinangle=dotProduct(cab,nv2);
   const Vector dsinangle_dv1=matmul(nv2,dcab_dv1);
-  const Vector dsinangle_dv2=matmul(nv2,dcab_dv2)+matmul(cab,dnv2_v2);
+  const Vector dsinangle_dv2=matmulAdd(nv2,dcab_dv2,cab,dnv2_v2);
   const Vector dsinangle_dv3=matmul(nv2,dcab_dv3);
 
   const double torsion=std::atan2(-sinangle,cosangle);
@@ -74,6 +78,40 @@ double Torsion::compute(const Vector& v1,const Vector& v2,const Vector& v3,Vecto
   return torsion;
 }
 
+void Torsion::compute(unsigned n,const Vector* v1,const Vector* v2,const Vector* v3,double* angles,Vector* d1,Vector* d2,Vector* d3)const {
+// the same quantities as in the scalar compute(), written with
+// A=v1 x v2 and B=v2 x v3: cos = A.B and sin = |v2| (v1.B), since
+// (A x B).v2 = (v1.(v2 x v3)) |v2|^2. The gradients of sin and cos are
+// then plain cross products, with no tensor intermediates
+  constexpr unsigned bs=32;
+  double msin[bs], mcos[bs];
+  for(unsigned start=0; start<n; start+=bs) {
+    const unsigned nb=std::min(bs,n-start);
+    for(unsigned j=0; j<nb; j++) {
+      const unsigned i=start+j;
+      const Vector A(crossProduct(v1[i],v2[i]));
+      const Vector B(crossProduct(v2[i],v3[i]));
+      const double G=v2[i].modulo();
+      const double v1B=dotProduct(v1[i],B);
+      const double sinangle=G*v1B;
+      const double cosangle=dotProduct(A,B);
+      const double invR2=1.0/(cosangle*cosangle+sinangle*sinangle);
+      const Vector dsin1(G*B);
+      const Vector dcos1(crossProduct(v2[i],B));
+      const Vector dsin3(G*A);
+      const Vector dcos3(crossProduct(A,v2[i]));
+      const Vector dsin2(v2[i]*(v1B/G)+G*crossProduct(v3[i],v1[i]));
+      const Vector dcos2(crossProduct(B,v1[i])+crossProduct(v3[i],A));
+      d1[i]=( -dsin1*cosangle + sinangle*dcos1 )*invR2;
+      d2[i]=( -dsin2*cosangle + sinangle*dcos2 )*invR2;
+      d3[i]=( -dsin3*cosangle + sinangle*dcos3 )*invR2;
+      msin[j]=-sinangle; mcos[j]=cosangle;
+    }
+// the angles of the whole block are recovered in one go
+    FastMath::atan2(msin,mcos,angles+start,nb);
+  }
+}
+
 }
 
 
@@ -46,6 +46,14 @@ public:
   double compute(const Vector& v1,const Vector& v2,const Vector& v3)const;
 /// This is the version which also computes the derivatives wrt the arguments.
   double compute(const Vector& v1,const Vector& v2,const Vector& v3,Vector& d1,Vector& d2,Vector& d3)const;
+/// Batch version: compute n torsions in one call, the i-th built from
+/// v1[i], v2[i] and v3[i], storing the angle in angles[i] and the
+/// derivatives in d1[i], d2[i] and d3[i]. It returns the same angles and
+/// derivatives as compute() up to roundoff, but the geometry is evaluated
+/// with two cross products per torsion instead of the tensor chain rule,
+/// and the final arctangents are taken on a block, so the loop is much
+/// cheaper when many dihedrals are needed at once (backbone chains)
+  void compute(unsigned n,const Vector* v1,const Vector* v2,const Vector* v3,double* angles,Vector* d1,Vector* d2,Vector* d3)const;
 };
 
 }
@@ -124,6 +124,12 @@ class Center:
   std::vector<double> weights;
   std::vector<Tensor> dcenter_sin;
   std::vector<Tensor> dcenter_cos;
+/// Normalized weights of a static group, cached between steps together
+/// with the derivatives, which for the non-phases path are just the
+/// normalized weights times the identity
+  std::vector<double> norm_weights;
+  double cached_mass;
+  bool cache_valid;
   bool weight_mass;
   bool nopbc;
   bool first;
@@ -148,6 +154,8 @@ void Center::registerKeywords(Keywords& keys) {
 Center::Center(const ActionOptions&ao):
   Action(ao),
   ActionWithVirtualAtom(ao),
+  cached_mass(0.0),
+  cache_valid(false),
   weight_mass(false),
   nopbc(false),
   first(true),
@@ -215,7 +223,6 @@ void Center::calculate() {
     first=false;
   }
 
-  vector<Tensor> deriv(getNumberOfAtoms());
   for(unsigned i=0; i<getNumberOfAtoms(); i++) mass+=getMass(i);
   if( plumed.getAtoms().chargesWereSet() ) {
     double charge(0.0);
@@ -228,6 +235,10 @@ void Center::calculate() {
   for(unsigned i=0; i<weights.size(); i++) wtot+=weights[i];
 
   if(dophases) {
+    // the phases derivatives depend on the positions, so the cached
+    // derivatives of the plain path must not be reused after this step
+    cache_valid=false;
+    vector<Tensor> deriv(getNumberOfAtoms());
     dcenter_sin.resize(getNumberOfAtoms());
     dcenter_cos.resize(getNumberOfAtoms());
     Vector center_sin;
@@ -288,16 +299,25 @@ void Center::calculate() {
 // scaled to real
     setPosition(matmul(c,box2pi));
   } else {
-    for(unsigned i=0; i<getNumberOfAtoms(); i++) {
-      double w=0;
-      if(weight_mass) w=getMass(i)/mass;
-      else w=weights[i]/wtot;
-      pos+=w*getPosition(i);
-      deriv[i]=w*Tensor::identity();
+    // for a static group the normalized weights and the derivatives
+    // (weight times identity) do not change between steps: they are
+    // computed the first time, kept, and rebuilt only if the total mass
+    // changes, so the per step cost reduces to the weighted position sum
+    if( !cache_valid || (weight_mass && mass!=cached_mass) ) {
+      norm_weights.resize(getNumberOfAtoms());
+      vector<Tensor> deriv(getNumberOfAtoms());
+      for(unsigned i=0; i<getNumberOfAtoms(); i++) {
+        if(weight_mass) norm_weights[i]=getMass(i)/mass;
+        else norm_weights[i]=weights[i]/wtot;
+        deriv[i]=norm_weights[i]*Tensor::identity();
+      }
+      setAtomsDerivatives(deriv);
+      cached_mass=mass;
+      cache_valid=true;
     }
+    for(unsigned i=0; i<getNumberOfAtoms(); i++) pos+=norm_weights[i]*getPosition(i);
     setPosition(pos);
     setMass(mass);
-    setAtomsDerivatives(deriv);
   }
 }
 
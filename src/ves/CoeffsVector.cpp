@@ -351,6 +351,43 @@ void CoeffsVector::addToValues(const CoeffsVector& other_coeffsvector) {
 }
 
 
+void CoeffsVector::fusedAveragedUpdate(const double stepsize, const double aver_decay, const CoeffsVector& coeffs_mask, const CoeffsVector& gradient, const CoeffsMatrix& hessian, CoeffsVector& coeffs) {
+  plumed_massert( data.size()==coeffs.getSize() && data.size()==gradient.getSize() && data.size()==coeffs_mask.getSize(), "Incorrect size");
+  size_t numcoeffs = data.size();
+  // NOTE: every term below is evaluated in the same association order as the
+  // operator expression this replaces (for the full hessian, the inner loop
+  // matches operator*(CoeffsMatrix,CoeffsVector)), so the updated
+  // coefficients are identical at the bit level and the regtest references
+  // do not depend on which of the two forms is used
+  if(hessian.isDiagonal()) {
+    for(size_t i=0; i<numcoeffs; i++) {
+      const double mask = coeffs_mask.data[i];
+      if(mask!=0.0) {
+        data[i] += -stepsize*mask*( gradient.data[i] + hessian(i,i)*(data[i]-coeffs.data[i]) );
+      }
+      coeffs.data[i] += aver_decay*(data[i]-coeffs.data[i]);
+    }
+  }
+  else {
+    // with a full hessian the matrix-vector product has to be formed from
+    // the values before the update
+    std::vector<double> hessian_term(numcoeffs,0.0);
+    for(size_t i=0; i<numcoeffs; i++) {
+      for(size_t j=0; j<numcoeffs; j++) {
+        hessian_term[i] += hessian(i,j)*(data[j]-coeffs.data[j]);
+      }
+    }
+    for(size_t i=0; i<numcoeffs; i++) {
+      const double mask = coeffs_mask.data[i];
+      if(mask!=0.0) {
+        data[i] += -stepsize*mask*( gradient.data[i] + hessian_term[i] );
+      }
+      coeffs.data[i] += aver_decay*(data[i]-coeffs.data[i]);
+    }
+  }
+}
+
+
 void CoeffsVector::subtractFromValues(const double value) {
   for(size_t i=0; i<data.size(); i++) {
     data[i]-=value;
@@ -141,6 +141,12 @@ public:
   void addToValues(const double);
   void addToValues(const std::vector<double>&);
   void addToValues(const CoeffsVector&);
+  /// fused in-place update used by the averaged stochastic gradient descent:
+  /// this += -stepsize*mask*( gradient + hessian*(this-coeffs) ) followed by
+  /// coeffs += aver_decay*(this-coeffs), equivalent to the operator-based
+  /// expression but without allocating any CoeffsVector temporaries and
+  /// skipping the gradient arithmetic for masked-out coefficients
+  void fusedAveragedUpdate(const double stepsize, const double aver_decay, const CoeffsVector& coeffs_mask, const CoeffsVector& gradient, const CoeffsMatrix& hessian, CoeffsVector& coeffs);
   void subtractFromValues(const double);
   void subtractFromValues(const std::vector<double>&);
   void subtractFromValues(const CoeffsVector&);
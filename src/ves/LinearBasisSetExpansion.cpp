@@ -398,27 +398,51 @@ double LinearBasisSetExpansion::getBiasAndForces(const std::vector<double>& args
     stride=comm_in->Get_size();
     rank=comm_in->Get_rank();
   }
-  // loop over coeffs
+  // loop over coeffs: the coefficients are flattened in column-major order,
+  // so they come in contiguous runs that share the outer indices and only
+  // differ in the first one; processing one run at a time keeps the inner
+  // loop branch free on contiguous arrays and avoids decoding the full
+  // multi-index for every coefficient
   double bias=0.0;
-  for(size_t i=rank; i<coeffs_pntr_in->numberOfCoeffs(); i+=stride) {
-    std::vector<unsigned int> indices=coeffs_pntr_in->getIndices(i);
-    double coeff = coeffs_pntr_in->getValue(i);
-    double bf_curr=1.0;
-    for(unsigned int k=0; k<nargs; k++) {
-      bf_curr*=bf_values[k][indices[k]];
+  const size_t nbf0=bf_values[0].size();
+  const size_t nruns=coeffs_pntr_in->numberOfCoeffs()/nbf0;
+  const double* v0=bf_values[0].data();
+  const double* d0=bf_derivs[0].data();
+  std::vector<unsigned int> outer_indices(nargs,0);
+  std::vector<double> outer_derivs(nargs,0.0);
+  for(size_t run=0; run<nruns; run++) {
+    // decode the outer indices of this run and form the products of the
+    // basis values (and derivatives) over the outer dimensions
+    size_t kk=run;
+    double outer_value=1.0;
+    for(unsigned int k=1; k<nargs; k++) {
+      const size_t nk=bf_values[k].size();
+      outer_indices[k]=kk%nk; kk/=nk;
+      outer_value*=bf_values[k][outer_indices[k]];
     }
-    bias+=coeff*bf_curr;
-    coeffsderivs_values[i] = bf_curr;
-    for(unsigned int k=0; k<nargs; k++) {
-      double der = 1.0;
-      for(unsigned int l=0; l<nargs; l++) {
-        if(l!=k) {der*=bf_values[l][indices[l]];}
-        else {der*=bf_derivs[l][indices[l]];}
+    for(unsigned int k=1; k<nargs; k++) {
+      double der=bf_derivs[k][outer_indices[k]];
+      for(unsigned int l=1; l<nargs; l++) {
+        if(l!=k) {der*=bf_values[l][outer_indices[l]];}
       }
-      forces[k]-=coeff*der;
-      // maybe faster but dangerous
-      // forces[k]-=coeff*bf_curr*(bf_derivs[k][indices[k]]/bf_values[k][indices[k]]);
+      outer_derivs[k]=der;
     }
+    //
+    // the ranks stride over single coefficients, not over runs: the code
+    // downstream (e.g. addToSampledAverages) only reads the entries of
+    // coeffsderivs_values owned by the rank and relies on this ownership
+    const size_t base=run*nbf0;
+    double sum_v=0.0;
+    double sum_d=0.0;
+    for(size_t j=(stride-base%stride+rank)%stride; j<nbf0; j+=stride) {
+      const double coeff=coeffs_pntr_in->getValue(base+j);
+      coeffsderivs_values[base+j]=outer_value*v0[j];
+      sum_v+=coeff*v0[j];
+      sum_d+=coeff*d0[j];
+    }
+    bias+=outer_value*sum_v;
+    forces[0]-=outer_value*sum_d;
+    for(unsigned int k=1; k<nargs; k++) {forces[k]-=outer_derivs[k]*sum_v;}
   }
   //
   if(comm_in!=NULL) {
@@ -453,14 +477,22 @@ void LinearBasisSetExpansion::getBasisSetValues(const std::vector<double>& args_
     stride=comm_in->Get_size();
     rank=comm_in->Get_rank();
   }
-  // loop over basis set
-  for(size_t i=rank; i<coeffs_pntr_in->numberOfCoeffs(); i+=stride) {
-    std::vector<unsigned int> indices=coeffs_pntr_in->getIndices(i);
-    double bf_curr=1.0;
-    for(unsigned int k=0; k<nargs; k++) {
-      bf_curr*=bf_values[k][indices[k]];
+  // loop over basis set, one contiguous column-major run at a time as in
+  // getBiasAndForces above
+  const size_t nbf0=bf_values[0].size();
+  const size_t nruns=coeffs_pntr_in->numberOfCoeffs()/nbf0;
+  const double* v0=bf_values[0].data();
+  for(size_t run=rank; run<nruns; run+=stride) {
+    size_t kk=run;
+    double outer_value=1.0;
+    for(unsigned int k=1; k<nargs; k++) {
+      const size_t nk=bf_values[k].size();
+      outer_value*=bf_values[k][kk%nk]; kk/=nk;
+    }
+    const size_t base=run*nbf0;
+    for(size_t j=0; j<nbf0; j++) {
+      basisset_values[base+j]=outer_value*v0[j];
     }
-    basisset_values[i] = bf_curr;
   }
   //
   if(comm_in!=NULL) {
@@ -295,9 +295,11 @@ void Opt_BachAveragedSGD::coeffsUpdate(const unsigned int c_id) {
   }
   //
   double aver_decay = getAverDecay();
-  AuxCoeffs(c_id) += - StepSize(c_id)*CoeffsMask(c_id) * ( Gradient(c_id) + Hessian(c_id)*(AuxCoeffs(c_id)-Coeffs(c_id)) );
-  //AuxCoeffs() = AuxCoeffs() - StepSize() * ( Gradient() + Hessian()*(AuxCoeffs()-Coeffs()) );
-  Coeffs(c_id) += aver_decay * ( AuxCoeffs(c_id)-Coeffs(c_id) );
+  // fused equivalent of
+  //  AuxCoeffs(c_id) += - StepSize(c_id)*CoeffsMask(c_id) * ( Gradient(c_id) + Hessian(c_id)*(AuxCoeffs(c_id)-Coeffs(c_id)) );
+  //  Coeffs(c_id) += aver_decay * ( AuxCoeffs(c_id)-Coeffs(c_id) );
+  // that avoids the CoeffsVector temporaries of the operator expressions
+  AuxCoeffs(c_id).fusedAveragedUpdate(StepSize(c_id),aver_decay,CoeffsMask(c_id),Gradient(c_id),Hessian(c_id),Coeffs(c_id));
 }
 
 
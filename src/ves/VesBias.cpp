@@ -81,7 +81,8 @@ VesBias::VesBias(const ActionOptions&ao):
   bias_cutoff_value_(0.0),
   bias_current_max_value(0.0),
   bias_cutoff_swfunc_pntr_(NULL),
-  calc_reweightfactor_(false)
+  calc_reweightfactor_(false),
+  walker_comms_setup_(false)
 {
   log.printf("  VES bias, please read and cite ");
   log << plumed.cite("Valsson and Parrinello, Phys. Rev. Lett. 113, 090601 (2014)");
@@ -471,8 +472,11 @@ void VesBias::multiSimSumAverages(const unsigned int c_id, const double walker_w
   }
   //
   if(comm.Get_rank()==0) {
-    multi_sim_comm.Sum(sampled_averages[c_id]);
-    multi_sim_comm.Sum(sampled_cross_averages[c_id]);
+    if(multi_sim_comm.Get_size()>1) {
+      if(!walker_comms_setup_) {setupWalkerComms();}
+      multiSimSumHierarchical(sampled_averages[c_id]);
+      multiSimSumHierarchical(sampled_cross_averages[c_id]);
+    }
     double norm_weights = walker_weight;
     multi_sim_comm.Sum(norm_weights);
     if(norm_weights>0.0) {norm_weights=1.0/norm_weights;}
@@ -488,6 +492,31 @@ void VesBias::multiSimSumAverages(const unsigned int c_id, const double walker_w
 }
 
 
+void VesBias::setupWalkerComms() {
+  // group the walkers that run on the same node so that only one copy of
+  // the coefficient-sized buffers per node travels over the network. This
+  // is collective over the walkers, like the sums it replaces
+  multi_sim_comm.SplitByNode(multi_sim_comm.Get_rank(),walkers_node_comm_);
+  int color = (walkers_node_comm_.Get_rank()==0) ? 0 : 1;
+  multi_sim_comm.Split(color,multi_sim_comm.Get_rank(),walkers_inter_comm_);
+  walker_comms_setup_=true;
+}
+
+
+void VesBias::multiSimSumHierarchical(std::vector<double>& buffer) {
+  // two-level equivalent of multi_sim_comm.Sum(buffer): reduce within each
+  // node first, reduce one copy per node across the nodes, and broadcast
+  // the result back within each node.  When all the walkers share one node
+  // (or every walker has a node of its own) one of the two levels is over
+  // the full set and the other is trivial, so the result is the same as
+  // that of the flat sum; only with several walkers on each of several
+  // nodes can the grouping change the rounding of the combined averages
+  walkers_node_comm_.Sum(buffer);
+  if(walkers_node_comm_.Get_rank()==0) {walkers_inter_comm_.Sum(buffer);}
+  walkers_node_comm_.Bcast(buffer,0);
+}
+
+
 void VesBias::addToSampledAverages(const std::vector<double>& values, const unsigned int c_id) {
   /*
   use the following online equation to calculate the average and covariance
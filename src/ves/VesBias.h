@@ -29,6 +29,7 @@
 #include "core/ActionWithValue.h"
 #include "core/ActionWithArguments.h"
 #include "bias/Bias.h"
+#include "tools/Communicator.h"
 
 #include <vector>
 #include <string>
@@ -118,10 +119,18 @@ private:
   std::vector< std::vector<std::string> > projection_args_;
   //
   bool calc_reweightfactor_;
+  //
+  // communicators for the hierarchical multiple-walker reduction, set up
+  // at the first use
+  bool walker_comms_setup_;
+  Communicator walkers_node_comm_;
+  Communicator walkers_inter_comm_;
 private:
   void initializeCoeffs(CoeffsVector*);
   std::vector<double> computeCovarianceFromAverages(const unsigned int) const;
   void multiSimSumAverages(const unsigned int, const double walker_weight=1.0);
+  void setupWalkerComms();
+  void multiSimSumHierarchical(std::vector<double>&);
 protected:
   //
   void checkThatTemperatureIsGiven();
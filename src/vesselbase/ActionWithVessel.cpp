@@ -29,6 +29,7 @@
 #include "FunctionVessel.h"
 #include "StoreDataVessel.h"
 #include "tools/OpenMP.h"
+#include "tools/Numa.h"
 #include "tools/Stopwatch.h"
 
 using namespace std;
@@ -210,23 +211,32 @@ void ActionWithVessel::needsDerivatives() {
 }
 
 void ActionWithVessel::lockContributors() {
-  nactive_tasks = 0;
+  // Single pass: count the active tasks and check whether the active set is
+  // the same as at the previous lock.  Actions whose neighbor-list-driven
+  // task set is stable between strides then skip the rebuild below
+  unsigned n=0; bool unchanged=true;
   for(unsigned i=0; i<fullTaskList.size(); ++i) {
-    if( taskFlags[i]>0 ) nactive_tasks++;
-  }
-
-  unsigned n=0;
-  partialTaskList.resize( nactive_tasks );
-  indexOfTaskInFullList.resize( nactive_tasks );
-  for(unsigned i=0; i<fullTaskList.size(); ++i) {
-    // Deactivate sets inactive tasks to number not equal to zero
     if( taskFlags[i]>0 ) {
-      partialTaskList[n] = fullTaskList[i];
-      indexOfTaskInFullList[n]=i;
+      if( n>=indexOfTaskInFullList.size() || indexOfTaskInFullList[n]!=i ) unchanged=false;
       n++;
     }
   }
-  plumed_dbg_assert( n==nactive_tasks );
+  nactive_tasks = n;
+
+  if( !unchanged || n!=indexOfTaskInFullList.size() ) {
+    n=0;
+    partialTaskList.resize( nactive_tasks );
+    indexOfTaskInFullList.resize( nactive_tasks );
+    for(unsigned i=0; i<fullTaskList.size(); ++i) {
+      // Deactivate sets inactive tasks to number not equal to zero
+      if( taskFlags[i]>0 ) {
+        partialTaskList[n] = fullTaskList[i];
+        indexOfTaskInFullList[n]=i;
+        n++;
+      }
+    }
+    plumed_dbg_assert( n==nactive_tasks );
+  }
   for(unsigned i=0; i<functions.size(); ++i) {
     BridgeVessel* bb = dynamic_cast<BridgeVessel*>( functions[i].get() );
     if( bb ) bb->copyTaskFlags();
@@ -237,8 +247,16 @@ void ActionWithVessel::lockContributors() {
 }
 
 void ActionWithVessel::deactivateAllTasks() {
+  if( contributorsAreUnlocked ) {
+    // flags may have been marked since the last lock, so the record of which
+    // entries are nonzero cannot be trusted and everything must be wiped
+    taskFlags.assign(taskFlags.size(),0);
+  } else {
+    // every marking phase ends in lockContributors, so the entries that are
+    // nonzero now are exactly those recorded in the compact list there
+    for(unsigned i=0; i<nactive_tasks; ++i) taskFlags[ indexOfTaskInFullList[i] ]=0;
+  }
   contributorsAreUnlocked=true; nactive_tasks = 0;
-  taskFlags.assign(taskFlags.size(),0);
 }
 
 bool ActionWithVessel::taskIsCurrentlyActive( const unsigned& index ) const {
@@ -252,7 +270,7 @@ void ActionWithVessel::doJobsRequiredBeforeTaskList() {
 
 unsigned ActionWithVessel::getSizeOfBuffer( unsigned& bufsize ) {
   for(unsigned i=0; i<functions.size(); ++i) functions[i]->setBufferStart( bufsize );
-  if( buffer.size()!=bufsize ) buffer.resize( bufsize );
+  if( buffer.size()!=bufsize ) Numa::interleavedResize( buffer, bufsize );
   if( mydata ) {
     unsigned dsize=mydata->getSizeOfDerivativeList();
     if( der_list.size()!=dsize ) der_list.resize( dsize );
@@ -274,6 +292,12 @@ void ActionWithVessel::runAllTasks() {
   // Get number of threads for OpenMP
   unsigned nt=OpenMP::getNumThreads();
   if( nt*stride*2>nactive_tasks || !threadSafe()) nt=1;
+  // after a few calibration steps the measured loop time replaces the
+  // task-count heuristic above when picking the team size
+  nt=threadtuner.getNumThreads( nt );
+  // tasks handed out in chunks so that the dynamic scheduler is consulted
+  // a bounded number of times per thread
+  unsigned chunk=nactive_tasks/(8*nt*stride); if( chunk<1 ) chunk=1;
 
   // Get size for buffer
   unsigned bsize=0, bufsize=getSizeOfBuffer( bsize );
@@ -282,16 +306,26 @@ void ActionWithVessel::runAllTasks() {
   // Switch off calculation of derivatives in main loop
   if( dertime_can_be_off ) dertime=false;
 
+  // Make sure the persistent per-thread buffers are available: the outer
+  // vector is only resized the first time (or when the number of threads grows)
+  if( nt>1 && omp_buffers.size()<nt ) omp_buffers.resize( nt );
+
   if(timers) stopwatch.start("2 Loop over tasks");
+  threadtuner.start();
   #pragma omp parallel num_threads(nt)
   {
-    std::vector<double> omp_buffer;
-    if( nt>1 ) omp_buffer.resize( bufsize, 0.0 );
-    MultiValue myvals( getNumberOfQuantities(), getNumberOfDerivatives() );
-    MultiValue bvals( getNumberOfQuantities(), getNumberOfDerivatives() );
+    const unsigned t=OpenMP::getThreadNum();
+    // the runtime may hand out fewer threads than were requested, so all the
+    // bookkeeping below is done with the actual team size
+    const unsigned nteam=OpenMP::getTeamSize();
+    // each thread zeroes its own arena, which keeps the pages local to it
+    if( nt>1 ) omp_buffers[t].assign( bufsize, 0.0 );
+    TemporaryMultiValue tmvals( getNumberOfQuantities(), getNumberOfDerivatives() );
+    TemporaryMultiValue tbvals( getNumberOfQuantities(), getNumberOfDerivatives() );
+    MultiValue& myvals=*tmvals; MultiValue& bvals=*tbvals;
     myvals.clearAll(); bvals.clearAll();
 
-    #pragma omp for nowait schedule(dynamic)
+    #pragma omp for nowait schedule(dynamic,chunk)
     for(unsigned i=rank; i<nactive_tasks; i+=stride) {
       // Calculate the stuff in the loop for this action
       performTask( indexOfTaskInFullList[i], partialTaskList[i], myvals );
@@ -309,7 +343,7 @@ void ActionWithVessel::runAllTasks() {
       // If the contribution of this quantity is very small at neighbour list time ignore it
       // until next neighbour list time
       if( nt>1 ) {
-        calculateAllVessels( indexOfTaskInFullList[i], myvals, bvals, omp_buffer, der_list );
+        calculateAllVessels( indexOfTaskInFullList[i], myvals, bvals, omp_buffers[t], der_list );
       } else {
         calculateAllVessels( indexOfTaskInFullList[i], myvals, bvals, buffer, der_list );
       }
@@ -317,9 +351,22 @@ void ActionWithVessel::runAllTasks() {
       // Clear the value
       myvals.clearAll();
     }
-    #pragma omp critical
-    if(nt>1) for(unsigned i=0; i<bufsize; ++i) buffer[i]+=omp_buffer[i];
+    // Merge the per-thread buffers pairwise, so that the number of sequential
+    // rounds grows with the logarithm of the number of threads rather than
+    // linearly as with a critical section.  Only the buffers of the actual
+    // team are merged: the slots beyond it were not zeroed this round and
+    // hold stale data from earlier calls
+    for(unsigned half=1; half<nteam; half*=2) {
+      #pragma omp barrier
+      if( t%(2*half)==0 && t+half<nteam ) {
+        const std::vector<double> & other( omp_buffers[t+half] );
+        std::vector<double> & mine( omp_buffers[t] );
+        for(unsigned i=0; i<bufsize; ++i) mine[i]+=other[i];
+      }
+    }
   }
+  if( nt>1 ) for(unsigned i=0; i<bufsize; ++i) buffer[i]+=omp_buffers[0][i];
+  threadtuner.stop(nt);
   if(timers) stopwatch.stop("2 Loop over tasks");
   // Turn back on derivative calculation
   dertime=true;
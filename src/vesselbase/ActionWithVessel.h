@@ -27,6 +27,7 @@
 #include "tools/Exception.h"
 #include "tools/DynamicList.h"
 #include "tools/MultiValue.h"
+#include "tools/ThreadTuner.h"
 #include <vector>
 #include "tools/ForwardDecl.h"
 
@@ -85,6 +86,11 @@ private:
   std::vector<unsigned> der_list;
 /// The buffer that we use (we keep a copy here to avoid resizing)
   std::vector<double> buffer;
+/// Persistent per-thread reduction buffers (allocated once and reused at
+/// every step, merged with a tree reduction at the end of the task loop)
+  std::vector<std::vector<double> > omp_buffers;
+/// Calibrates the OpenMP team size for the task loop during the first steps
+  ThreadTuner threadtuner;
 /// Do we want to output information on the timings of different parts of the calculation
   bool timers;
   ForwardDecl<Stopwatch> stopwatch_fwd;
@@ -127,8 +133,6 @@ protected:
   void calculateAllVessels( const unsigned& taskCode, MultiValue& myvals, MultiValue& bvals, std::vector<double>& buffer, std::vector<unsigned>& der_list );
 /// Retrieve the forces from all the vessels (used in apply)
   bool getForcesFromVessels( std::vector<double>& forcesToApply );
-/// Is the calculation being done in serial
-  bool serialCalculation() const;
 /// Are we using low memory
   bool usingLowMem() const ;
 /// Set that we are using low memory
@@ -143,6 +147,8 @@ public:
   static void registerKeywords(Keywords& keys);
   explicit ActionWithVessel(const ActionOptions&ao);
   ~ActionWithVessel();
+/// Is the calculation being done in serial
+  bool serialCalculation() const;
   void lockContributors();
 /// Get the number of tasks that are currently active
   unsigned getCurrentNumberOfActiveTasks() const ;
@@ -25,6 +25,8 @@
 namespace PLMD {
 namespace vesselbase {
 
+thread_local const std::vector<double>* AveragingVessel::readredirect=nullptr;
+
 void AveragingVessel::registerKeywords( Keywords& keys ) {
   Vessel::registerKeywords( keys );
 }
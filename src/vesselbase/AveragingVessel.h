@@ -35,6 +35,11 @@ private:
   bool unormalised;
 /// The data that is being averaged
   std::vector<double> data;
+/// When this is set in a thread, all the reads done by that thread are
+/// served from the pointed snapshot instead of the live data. It is used
+/// to let a background thread write a grid to file while the calculation
+/// thread continues to accumulate
+  static thread_local const std::vector<double>* readredirect;
 protected:
 /// Set the size of the data vector
   void setDataSize( const unsigned& size );
@@ -62,6 +67,14 @@ public:
 /// Functions for dealing with normalisation constant
   void setNorm( const double& snorm );
   double getNorm() const ;
+/// Return a copy of the accumulated data (normalisation constant included)
+  std::vector<double> snapshotData() const { return data; }
+/// Redirect all the reads done by the calling thread to the given
+/// snapshot, or back to the live data when a null pointer is passed.
+/// The redirection applies to every vessel read from that thread, so a
+/// background thread using it should only read the vessel whose
+/// snapshot it holds
+  static void redirectReads( const std::vector<double>* snapshot );
   bool applyForce(  std::vector<double>& forces ) override { return false; }
 };
 
@@ -79,9 +92,10 @@ void AveragingVessel::addDataElement( const unsigned& myelem, const double& valu
 
 inline
 double AveragingVessel::getDataElement( const unsigned& myelem ) const {
-  plumed_dbg_assert( myelem<data.size()-1 );
-  if( unormalised ) return data[1+myelem];
-  return data[1+myelem] / data[0];
+  const std::vector<double>& d( readredirect ? *readredirect : data );
+  plumed_dbg_assert( myelem<d.size()-1 );
+  if( unormalised ) return d[1+myelem];
+  return d[1+myelem] / d[0];
 }
 
 inline
@@ -92,8 +106,14 @@ void AveragingVessel::setNorm( const double& snorm ) {
 
 inline
 double AveragingVessel::getNorm() const {
-  plumed_dbg_assert( data.size()>0 );
-  return data[0];
+  const std::vector<double>& d( readredirect ? *readredirect : data );
+  plumed_dbg_assert( d.size()>0 );
+  return d[0];
+}
+
+inline
+void AveragingVessel::redirectReads( const std::vector<double>* snapshot ) {
+  readredirect=snapshot;
 }
 
 }
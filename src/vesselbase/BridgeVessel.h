@@ -77,6 +77,10 @@ public:
   void copyTaskFlags();
 /// Return a tempory multi value - we do this so as to avoid vector resizing
   MultiValue& getTemporyMultiValue();
+/// Whether the output action may steal the storage of the input MultiValue
+/// rather than copying it.  The same input is handed in turn to every vessel
+/// of the underlying action, so this is only safe for the last one
+  bool canRecycleInputValues() const;
 };
 
 inline
@@ -84,6 +88,12 @@ ActionWithVessel* BridgeVessel::getOutputAction() {
   return myOutputAction;
 }
 
+inline
+bool BridgeVessel::canRecycleInputValues() const {
+  ActionWithVessel* base=getAction();
+  return base->getPntrToVessel( base->getNumberOfVessels()-1 )==this;
+}
+
 }
 }
 #endif
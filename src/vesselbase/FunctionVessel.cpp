@@ -67,8 +67,10 @@ void FunctionVessel::calculate( const unsigned& current, MultiValue& myvals, std
   if( usetol && contr<getTolerance() ) return;
   buffer[bufstart] += contr;
 
-  if( diffweight ) myvals.chainRule( 0, 0, 1, 0, f, bufstart, buffer );
-  if( getAction()->derivativesAreRequired() && fabs(dval)>0.0 ) myvals.chainRule( mycomp, 0, 1, 0, weight*dval, bufstart, buffer );
+  bool diffval=getAction()->derivativesAreRequired() && fabs(dval)>0.0;
+  if( diffweight && diffval ) myvals.chainRule2( 0, mycomp, 0, 1, 0, f, weight*dval, bufstart, buffer );
+  else if( diffweight ) myvals.chainRule( 0, 0, 1, 0, f, bufstart, buffer );
+  else if( diffval ) myvals.chainRule( mycomp, 0, 1, 0, weight*dval, bufstart, buffer );
 
   return;
 }
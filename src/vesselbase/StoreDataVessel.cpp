@@ -58,6 +58,11 @@ void StoreDataVessel::resize() {
   plumed_dbg_assert( vecsize>0 );
   resizeBuffer( getNumberOfStoredValues()*vecsize*nspace );
   local_buffer.resize( getNumberOfStoredValues()*vecsize*nspace );
+  // Select the storage layout: with nspace equal to one the values are
+  // already contiguous in local_buffer, otherwise they are gathered into
+  // a compact mirror in finish() (see header)
+  if( nspace>1 ) compact_values.resize( getNumberOfStoredValues()*vecsize );
+  else compact_values.resize( 0 );
 }
 
 void StoreDataVessel::storeValues( const unsigned& myelem, MultiValue& myvals, std::vector<double>& buffer ) const {
@@ -102,8 +107,8 @@ void StoreDataVessel::storeDerivatives( const unsigned& myelem, MultiValue& myva
 
 void StoreDataVessel::retrieveSequentialValue( const unsigned& jelem, const bool& normed, std::vector<double>& values ) const {
   plumed_dbg_assert( values.size()==vecsize );
-  unsigned ibuf = jelem * vecsize * nspace;
-  for(unsigned i=0; i<vecsize; ++i) { values[i]=local_buffer[ibuf]; ibuf+=nspace; }
+  const double* row = ( nspace==1 ) ? &local_buffer[jelem*vecsize] : &compact_values[jelem*vecsize];
+  std::memcpy( &values[0], row, vecsize*sizeof(double) );
   if( normed && values.size()>2 ) getAction()->normalizeVector( values );
 }
 
@@ -115,7 +120,8 @@ void StoreDataVessel::retrieveValueWithIndex( const unsigned& myelem, const bool
 
 double StoreDataVessel::retrieveWeightWithIndex( const unsigned& myelem ) const {
   plumed_dbg_assert( vecsize>0 );
-  unsigned jelem = getStoreIndex( myelem ); unsigned ibuf = jelem * vecsize * nspace; return local_buffer[ibuf];
+  unsigned jelem = getStoreIndex( myelem );
+  return ( nspace==1 ) ? local_buffer[jelem*vecsize] : compact_values[jelem*vecsize];
 }
 
 void StoreDataVessel::retrieveDerivatives( const unsigned& myelem, const bool& normed, MultiValue& myvals ) {
@@ -158,6 +164,13 @@ void StoreDataVessel::calculate( const unsigned& current, MultiValue& myvals, st
 void StoreDataVessel::finish( const std::vector<double>& buffer ) {
   // Store the buffer locally
   for(unsigned i=0; i<local_buffer.size(); ++i) local_buffer[i]=buffer[bufstart+i];
+  // Gather the values into the compact contiguous mirror.  The rows of
+  // local_buffer all have size vecsize*nspace, so a single strided pass
+  // picks up the value of every component of every element
+  if( nspace>1 ) {
+    unsigned ibuf=0;
+    for(unsigned i=0; i<compact_values.size(); ++i) { compact_values[i]=local_buffer[ibuf]; ibuf+=nspace; }
+  }
 }
 
 
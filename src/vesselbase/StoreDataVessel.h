@@ -56,6 +56,13 @@ private:
   std::vector<unsigned> active_der;
 /// The buffer
   std::vector<double> local_buffer;
+/// The value of every stored element gathered contiguously, one row of
+/// vecsize doubles per element.  When derivatives are stored the values in
+/// local_buffer are strided by nspace, which wastes most of each cache line
+/// in the value-only scans done by the data users, so this mirror is filled
+/// once in finish().  When nspace is one local_buffer already has this
+/// layout and the mirror is left empty
+  std::vector<double> compact_values;
 /// The actions that are going to use the stored data
   std::vector<ActionWithVessel*> userActions;
 /// We create a vector of tempory MultiValues here so as to avoid
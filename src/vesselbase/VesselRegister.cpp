@@ -50,7 +50,9 @@ void VesselRegister::remove(creator_pointer f) {
 void VesselRegister::add(std::string keyword,creator_pointer f,keyword_pointer k,keyword_pointer ik) {
   plumed_massert(m.count(keyword)==0,"keyword has already been registered");
   m.insert(std::pair<std::string,creator_pointer>(keyword,f));
-  k( keywords );   // Store the keywords for all the things
+  // The keyword is reserved lazily, the first time the shared documentation
+  // is requested, so that registration at library load stays cheap
+  reserved.push_back( k );
   // Store a pointer to the function that creates keywords
   // A pointer is stored and not the keywords because all
   // Vessels must be dynamically loaded before the actions.
@@ -73,6 +75,10 @@ std::unique_ptr<Vessel> VesselRegister::create(std::string keyword, const Vessel
 }
 
 Keywords VesselRegister::getKeywords() {
+  if( !reserved.empty() ) {
+    for(unsigned i=0; i<reserved.size(); ++i) reserved[i]( keywords );
+    reserved.clear();
+  }
   return keywords;
 }
 
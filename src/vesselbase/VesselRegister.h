@@ -46,6 +46,10 @@ private:
   std::map<std::string,creator_pointer> m;
 /// Map action to a function which documents the related object
   std::map<std::string,keyword_pointer> mk;
+/// Pointers to the functions that reserve the keywords of the registered
+/// vessels.  They are called the first time the documentation is needed
+/// rather than at registration so that loading the library stays cheap
+  std::vector<keyword_pointer> reserved;
 /// A vector of function pointers - this is used to create the documentation
   Keywords keywords;
 public: